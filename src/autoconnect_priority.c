@@ -0,0 +1,268 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  autoconnect_priority.c
+ *
+ * @brief Choice of the known network to connect to from profile priorities
+ *
+ */
+
+#include <glib.h>
+
+#include "autoconnect_priority.h"
+
+/* "ssid\nsecurity" to priority + 1, so that 0 means not indexed */
+static GHashTable *profile_index = NULL;
+/* Winner of the last decisions and how many in a row it won */
+static gchar *candidate = NULL;
+static guint candidate_scans = 0;
+
+/* Walking the namespace lists directly keeps this O(profiles), unlike
+ * get_next_profile() which looks up its argument at every step */
+static guint get_visible_profile_lists(GSList *lists[2])
+{
+	profile_namespace_t *active = profile_namespace_get_active();
+	profile_namespace_t *device = profile_namespace_get_device();
+
+	lists[0] = active->profiles;
+
+	if (active == device)
+	{
+		return 1;
+	}
+
+	lists[1] = device->profiles;
+	return 2;
+}
+
+static gchar *network_key(const gchar *ssid, const gchar *security)
+{
+	return g_strconcat(ssid, "\n", NULL != security ? security : "", NULL);
+}
+
+/**
+ * Forget the indexed profiles (see header for API details)
+ */
+
+void autoconnect_priority_clear_index(void)
+{
+	if (NULL != profile_index)
+	{
+		g_hash_table_remove_all(profile_index);
+	}
+}
+
+/**
+ * Index the priority of a profile (see header for API details)
+ */
+
+void autoconnect_priority_index(const gchar *ssid, GStrv security,
+                                gint priority)
+{
+	guint i;
+
+	if (NULL == ssid)
+	{
+		return;
+	}
+
+	if (NULL == profile_index)
+	{
+		profile_index = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	}
+
+	if (NULL == security || NULL == security[0])
+	{
+		g_hash_table_replace(profile_index, network_key(ssid, NULL),
+		                     GINT_TO_POINTER(priority + 1));
+		return;
+	}
+
+	for (i = 0; NULL != security[i]; i++)
+	{
+		g_hash_table_replace(profile_index, network_key(ssid, security[i]),
+		                     GINT_TO_POINTER(priority + 1));
+	}
+}
+
+/**
+ * Index the priorities of the visible profiles (see header for API details)
+ */
+
+gboolean autoconnect_priority_index_profiles(void)
+{
+	GSList *lists[2], *iter;
+	guint i, num_lists = get_visible_profile_lists(lists);
+	gboolean ordered = FALSE;
+
+	autoconnect_priority_clear_index();
+
+	for (i = 0; i < num_lists; i++)
+	{
+		for (iter = lists[i]; NULL != iter; iter = iter->next)
+		{
+			wifi_profile_t *profile = iter->data;
+
+			autoconnect_priority_index(profile->ssid, profile->security,
+			                           profile->priority);
+			ordered = ordered || profile->priority > 0;
+		}
+	}
+
+	return ordered;
+}
+
+static gboolean lookup_priority(const autoconnect_network_t *network,
+                                gint *priority)
+{
+	gchar *key;
+	gpointer value = NULL;
+
+	if (NULL == profile_index || NULL == network->ssid)
+	{
+		return FALSE;
+	}
+
+	key = network_key(network->ssid, network->security);
+	value = g_hash_table_lookup(profile_index, key);
+	g_free(key);
+
+	*priority = GPOINTER_TO_INT(value) - 1;
+	return NULL != value;
+}
+
+static void forget_candidate(void)
+{
+	g_free(candidate);
+	candidate = NULL;
+	candidate_scans = 0;
+}
+
+/**
+ * Choose the network to connect to (see header for API details)
+ */
+
+const autoconnect_network_t *autoconnect_priority_select(
+    const autoconnect_network_t *networks, guint count)
+{
+	const autoconnect_network_t *best = NULL, *current = NULL;
+	gint best_priority = 0, current_priority = 0;
+	gchar *key;
+	guint i;
+
+	for (i = 0; i < count; i++)
+	{
+		const autoconnect_network_t *network = &networks[i];
+		gint priority;
+
+		if (!lookup_priority(network, &priority))
+		{
+			continue;
+		}
+
+		if (network->connected)
+		{
+			current = network;
+			current_priority = priority;
+		}
+
+		if (network->strength < AUTOCONNECT_SIGNAL_FLOOR)
+		{
+			continue;
+		}
+
+		if (NULL == best || priority > best_priority ||
+		        (priority == best_priority && network->strength > best->strength))
+		{
+			best = network;
+			best_priority = priority;
+		}
+	}
+
+	if (NULL == best || best == current ||
+	        (NULL != current && current_priority >= best_priority))
+	{
+		forget_candidate();
+		return NULL;
+	}
+
+	/* Nothing to flap from while disconnected */
+	if (NULL == current)
+	{
+		forget_candidate();
+		return best;
+	}
+
+	key = network_key(best->ssid, best->security);
+
+	if (!g_strcmp0(key, candidate))
+	{
+		g_free(key);
+	}
+	else
+	{
+		g_free(candidate);
+		candidate = key;
+		candidate_scans = 0;
+	}
+
+	if (++candidate_scans < AUTOCONNECT_CONFIRM_SCANS)
+	{
+		return NULL;
+	}
+
+	forget_candidate();
+	return best;
+}
+
+/**
+ * Set the priorities from an order (see header for API details)
+ */
+
+void autoconnect_priority_set_order(wifi_profile_t **ordered, guint count)
+{
+	GSList *lists[2], *iter;
+	guint i, num_lists = get_visible_profile_lists(lists);
+
+	for (i = 0; i < num_lists; i++)
+	{
+		for (iter = lists[i]; NULL != iter; iter = iter->next)
+		{
+			((wifi_profile_t *) iter->data)->priority = 0;
+		}
+	}
+
+	for (i = count; i > 0; i--)
+	{
+		ordered[i - 1]->priority = count - i + 1;
+	}
+}
+
+/**
+ * Forget the profiles and decisions (see header for API details)
+ */
+
+void autoconnect_priority_reset(void)
+{
+	if (NULL != profile_index)
+	{
+		g_hash_table_destroy(profile_index);
+		profile_index = NULL;
+	}
+
+	forget_candidate();
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  autoconnect_priority.h
+ *
+ * @brief Header file defining the choice of the known network to connect to
+ *        from the priorities of the profiles
+ *
+ * connman autoconnects to whichever known network it finds first. After each
+ * scan the priorities of the visible profiles are indexed by SSID and
+ * security in one pass over the namespace lists, then each visible network is
+ * looked up once, so a decision costs O(visible networks + profiles). The best network is the one of highest
+ * priority whose signal is above AUTOCONNECT_SIGNAL_FLOOR, the stronger one
+ * among equals. A connected network is only left for a network of higher
+ * priority, and only once that network won AUTOCONNECT_CONFIRM_SCANS
+ * decisions in a row.
+ *
+ */
+
+#ifndef _AUTOCONNECT_PRIORITY_H_
+#define _AUTOCONNECT_PRIORITY_H_
+
+#include <glib.h>
+
+#include "wifi_profile.h"
+
+/* Signal strength (0-100) a network needs to be chosen */
+#define AUTOCONNECT_SIGNAL_FLOOR        30
+/* Decisions in a row a network must win before the connection is moved */
+#define AUTOCONNECT_CONFIRM_SCANS       2
+
+typedef struct autoconnect_network
+{
+	const gchar *ssid;
+	const gchar *security;
+	guint strength;             /* 0-100 */
+	gboolean connected;
+	gpointer data;              /* Caller's network */
+} autoconnect_network_t;
+
+/**
+ * Forget the indexed profiles
+ */
+extern void autoconnect_priority_clear_index(void);
+
+/**
+ * Index the priority of a profile
+ *
+ * @param[IN]  ssid SSID of the profile
+ * @param[IN]  security Security types of the profile, may be NULL
+ * @param[IN]  priority Priority, higher is preferred, 0 if none was set
+ */
+extern void autoconnect_priority_index(const gchar *ssid, GStrv security,
+                                       gint priority);
+
+/**
+ * Index the priorities of the visible profiles, replacing the previous index
+ *
+ * @return TRUE if any visible profile has a priority above 0, i.e. an order
+ *         was set
+ */
+extern gboolean autoconnect_priority_index_profiles(void);
+
+/**
+ * Choose the network to connect to
+ *
+ * @param[IN]  networks Visible networks
+ * @param[IN]  count Number of networks
+ *
+ * @return Network to connect to, NULL to leave the connection alone
+ */
+extern const autoconnect_network_t *autoconnect_priority_select(
+    const autoconnect_network_t *networks, guint count);
+
+/**
+ * Set the priorities of the visible profiles from an order. Visible profiles
+ * which are not listed lose their priority, a profile listed more than once
+ * keeps its first place.
+ *
+ * @param[IN]  ordered Profiles, most preferred first
+ * @param[IN]  count Number of profiles
+ */
+extern void autoconnect_priority_set_order(wifi_profile_t **ordered,
+        guint count);
+
+/**
+ * Forget the indexed profiles and the decisions so far
+ */
+extern void autoconnect_priority_reset(void);
+
+#endif /* _AUTOCONNECT_PRIORITY_H_ */
@@ -0,0 +1,133 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  band_steering.c
+ *
+ * @brief Band and BSS preference of wifi profiles
+ *
+ */
+
+#include <glib.h>
+
+#include "band_steering.h"
+
+/**
+ * Get the band of a channel (see header for API details)
+ */
+
+wifi_band_t wifi_band_from_frequency(gint frequency)
+{
+	if (frequency >= 2400 && frequency < 2500)
+	{
+		return WIFI_BAND_2_4GHZ;
+	}
+
+	/* Channel 2 of 6 GHz at 5935 MHz is the only one below 5950 MHz */
+	if (frequency >= 5935 && frequency <= 7125)
+	{
+		return WIFI_BAND_6GHZ;
+	}
+
+	if (frequency >= 4900 && frequency < 5935)
+	{
+		return WIFI_BAND_5GHZ;
+	}
+
+	return WIFI_BAND_ANY;
+}
+
+const gchar *wifi_band_to_string(wifi_band_t band)
+{
+	switch (band)
+	{
+		case WIFI_BAND_2_4GHZ:
+			return "2.4GHz";
+
+		case WIFI_BAND_5GHZ:
+			return "5GHz";
+
+		case WIFI_BAND_6GHZ:
+			return "6GHz";
+
+		default:
+			return "any";
+	}
+}
+
+/**
+ * Parse a band (see header for API details)
+ */
+
+gboolean wifi_band_from_string(const gchar *str, wifi_band_t *band)
+{
+	wifi_band_t i;
+
+	for (i = WIFI_BAND_ANY; i <= WIFI_BAND_6GHZ; i++)
+	{
+		if (!g_strcmp0(str, wifi_band_to_string(i)))
+		{
+			*band = i;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * Check if a preference steers at all (see header for API details)
+ */
+
+gboolean band_preference_is_set(const band_preference_t *pref)
+{
+	return WIFI_BAND_ANY != pref->band || '\0' != pref->bssid[0];
+}
+
+/**
+ * Score a BSS (see header for API details)
+ */
+
+gint band_preference_score(const band_preference_t *pref, const gchar *bssid,
+                           gint frequency, gint signal)
+{
+	gint floor = 0 != pref->rssi_floor ? pref->rssi_floor :
+	             BAND_STEERING_RSSI_FLOOR;
+	wifi_band_t band = wifi_band_from_frequency(frequency);
+
+	if (pref->required && WIFI_BAND_ANY != pref->band && band != pref->band)
+	{
+		return BAND_STEERING_SCORE_EXCLUDED;
+	}
+
+	/* A required band is used however weak it is */
+	if (signal < floor && !pref->required)
+	{
+		return BAND_STEERING_SCORE_OTHER;
+	}
+
+	if ('\0' != pref->bssid[0] && !g_ascii_strcasecmp(pref->bssid, bssid))
+	{
+		return BAND_STEERING_SCORE_PINNED;
+	}
+
+	if (WIFI_BAND_ANY != pref->band && band == pref->band)
+	{
+		return BAND_STEERING_SCORE_BAND;
+	}
+
+	return BAND_STEERING_SCORE_OTHER;
+}
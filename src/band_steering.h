@@ -0,0 +1,96 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  band_steering.h
+ *
+ * @brief Header file defining the band and BSS preference of a wifi profile
+ *
+ * Each BSS of a network gets a score from the preference of its profile: a
+ * pinned BSS scores highest, then the BSSes of the preferred band, then the
+ * others. A BSS whose signal is below the RSSI floor of the preference scores
+ * as any other BSS, so a weak preferred BSS is given up for a usable one.
+ * With a required band the BSSes of other bands are excluded altogether and
+ * the floor doesn't apply.
+ *
+ */
+
+#ifndef _BAND_STEERING_H_
+#define _BAND_STEERING_H_
+
+#include <glib.h>
+
+/* Default RSSI floor in dBm */
+#define BAND_STEERING_RSSI_FLOOR        -75
+
+#define BAND_STEERING_SCORE_EXCLUDED    -1
+#define BAND_STEERING_SCORE_OTHER       1
+#define BAND_STEERING_SCORE_BAND        2
+#define BAND_STEERING_SCORE_PINNED      3
+
+typedef enum
+{
+	WIFI_BAND_ANY,
+	WIFI_BAND_2_4GHZ,
+	WIFI_BAND_5GHZ,
+	WIFI_BAND_6GHZ,
+} wifi_band_t;
+
+typedef struct band_preference
+{
+	wifi_band_t band;           /* WIFI_BAND_ANY for no preference */
+	gboolean required;          /* Never use the other bands */
+	gchar bssid[18];            /* Upper case pinned BSSID, empty if none */
+	gint rssi_floor;            /* dBm, 0 for BAND_STEERING_RSSI_FLOOR */
+} band_preference_t;
+
+/**
+ * Get the band of a channel
+ *
+ * @param[IN]  frequency Center frequency in MHz
+ *
+ * @return Band, WIFI_BAND_ANY if the frequency isn't in a wifi band
+ */
+extern wifi_band_t wifi_band_from_frequency(gint frequency);
+
+extern const gchar *wifi_band_to_string(wifi_band_t band);
+
+/**
+ * Parse a band, "any", "2.4GHz", "5GHz" or "6GHz"
+ *
+ * @return TRUE if the string names a band
+ */
+extern gboolean wifi_band_from_string(const gchar *str, wifi_band_t *band);
+
+/**
+ * Check if a preference steers the connection at all
+ */
+extern gboolean band_preference_is_set(const band_preference_t *pref);
+
+/**
+ * Score a BSS against a preference
+ *
+ * @param[IN]  pref Preference of the profile of the network
+ * @param[IN]  bssid BSSID of the BSS
+ * @param[IN]  frequency Frequency of the BSS in MHz
+ * @param[IN]  signal Signal of the BSS in dBm
+ *
+ * @return BAND_STEERING_SCORE_*, higher is preferred
+ */
+extern gint band_preference_score(const band_preference_t *pref,
+                                  const gchar *bssid, gint frequency, gint signal);
+
+#endif /* _BAND_STEERING_H_ */
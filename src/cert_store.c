@@ -0,0 +1,765 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  cert_store.c
+ *
+ * @brief Certificate store used by enterprise (802.1X) wifi profiles
+ *
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+#include <openssl/x509v3.h>
+
+#include "cert_store.h"
+
+#define CERT_SUFFIX     ".pem"
+
+G_DEFINE_QUARK(cert-store-error-quark, cert_store_error)
+
+static gchar *store_dir = NULL;
+/* Path -> cert_info_t */
+static GHashTable *cache = NULL;
+
+static void cert_info_free(gpointer data)
+{
+	cert_info_t *info = data;
+
+	sk_X509_pop_free(info->certs, X509_free);
+	g_free(info->name);
+	g_free(info->path);
+	g_free(info->subject);
+	g_free(info->issuer);
+	g_free(info->fingerprint);
+	g_free(info);
+}
+
+static void cache_init(void)
+{
+	if (NULL == cache)
+	{
+		cache = g_hash_table_new_full(g_str_hash, g_str_equal, NULL, cert_info_free);
+	}
+}
+
+/**
+ * Check if a name can be used for a certificate (see header for API details)
+ */
+
+gboolean cert_store_is_valid_name(const gchar *name)
+{
+	const gchar *c;
+
+	if (NULL == name || '\0' == name[0] || '.' == name[0] ||
+	        strlen(name) > CERT_STORE_NAME_MAX)
+	{
+		return FALSE;
+	}
+
+	for (c = name; '\0' != *c; c++)
+	{
+		if (!g_ascii_isalnum(*c) && NULL == strchr(".-_", *c))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gchar *build_cert_path(const gchar *name)
+{
+	gchar *file = g_strconcat(name, CERT_SUFFIX, NULL);
+	gchar *path = g_build_filename(store_dir, file, NULL);
+
+	g_free(file);
+	return path;
+}
+
+/**
+ * @brief Get the name of an imported certificate from its path, NULL if the
+ * file isn't in the store
+ */
+
+static gchar *get_cert_name(const gchar *path)
+{
+	gchar *dir, *base, *name = NULL;
+
+	if (NULL == store_dir)
+	{
+		return NULL;
+	}
+
+	dir = g_path_get_dirname(path);
+	base = g_path_get_basename(path);
+
+	if (!g_strcmp0(dir, store_dir) && g_str_has_suffix(base, CERT_SUFFIX))
+	{
+		name = g_strndup(base, strlen(base) - strlen(CERT_SUFFIX));
+
+		if (!cert_store_is_valid_name(name))
+		{
+			g_free(name);
+			name = NULL;
+		}
+	}
+
+	g_free(base);
+	g_free(dir);
+	return name;
+}
+
+static gint64 asn1_time_to_unix(const ASN1_TIME *time)
+{
+	struct tm tm;
+
+	if (1 != ASN1_TIME_to_tm(time, &tm))
+	{
+		return 0;
+	}
+
+	return timegm(&tm);
+}
+
+static gchar *name_to_string(X509_NAME *name)
+{
+	BIO *bio = BIO_new(BIO_s_mem());
+	gchar *str = NULL;
+	char *data;
+	long len;
+
+	if (NULL == bio)
+	{
+		return NULL;
+	}
+
+	if (X509_NAME_print_ex(bio, name, 0, XN_FLAG_RFC2253) >= 0)
+	{
+		len = BIO_get_mem_data(bio, &data);
+		str = g_strndup(data, len);
+	}
+
+	BIO_free(bio);
+	return str;
+}
+
+static gchar *get_fingerprint(X509 *cert)
+{
+	guchar md[EVP_MAX_MD_SIZE];
+	unsigned int len, n;
+	GString *str;
+
+	if (1 != X509_digest(cert, EVP_sha256(), md, &len))
+	{
+		return NULL;
+	}
+
+	str = g_string_sized_new(len * 3);
+
+	for (n = 0; n < len; n++)
+	{
+		g_string_append_printf(str, n ? ":%02X" : "%02X", md[n]);
+	}
+
+	return g_string_free(str, FALSE);
+}
+
+/**
+ * @brief Parse all certificates of a PEM file, or a single DER encoded one
+ */
+
+static STACK_OF(X509) *parse_certs(const guchar *data, gsize len)
+{
+	STACK_OF(X509) *certs = sk_X509_new_null();
+	const guchar *der = data;
+	BIO *bio;
+	X509 *cert;
+
+	if (NULL == certs)
+	{
+		return NULL;
+	}
+
+	bio = BIO_new_mem_buf(data, len);
+
+	while (NULL != bio && NULL != (cert = PEM_read_bio_X509(bio, NULL, NULL, NULL)))
+	{
+		sk_X509_push(certs, cert);
+	}
+
+	BIO_free(bio);
+
+	if (0 == sk_X509_num(certs))
+	{
+		cert = d2i_X509(NULL, &der, len);
+
+		if (NULL != cert)
+		{
+			sk_X509_push(certs, cert);
+		}
+	}
+
+	/* Reading stops at the end of the file with an error */
+	ERR_clear_error();
+
+	if (0 == sk_X509_num(certs))
+	{
+		sk_X509_free(certs);
+		return NULL;
+	}
+
+	return certs;
+}
+
+static cert_info_t *cert_info_new(const gchar *path, STACK_OF(X509) *certs)
+{
+	cert_info_t *info = g_new0(cert_info_t, 1);
+	X509 *first = sk_X509_value(certs, 0);
+	int n;
+
+	info->path = g_strdup(path);
+	info->name = get_cert_name(path);
+	info->certs = certs;
+	info->count = sk_X509_num(certs);
+	info->subject = name_to_string(X509_get_subject_name(first));
+	info->issuer = name_to_string(X509_get_issuer_name(first));
+	info->fingerprint = get_fingerprint(first);
+	info->is_ca = X509_check_ca(first) > 0;
+	info->not_before = G_MININT64;
+	info->not_after = G_MAXINT64;
+
+	for (n = 0; n < sk_X509_num(certs); n++)
+	{
+		X509 *cert = sk_X509_value(certs, n);
+
+		info->not_before = MAX(info->not_before,
+		                       asn1_time_to_unix(X509_get0_notBefore(cert)));
+		info->not_after = MIN(info->not_after,
+		                      asn1_time_to_unix(X509_get0_notAfter(cert)));
+	}
+
+	return info;
+}
+
+static void set_file_stamp(cert_info_t *info, const GStatBuf *st)
+{
+	info->mtime = (gint64) st->st_mtim.tv_sec * G_GINT64_CONSTANT(1000000000) +
+	              st->st_mtim.tv_nsec;
+	info->size = st->st_size;
+}
+
+static gboolean file_changed(const cert_info_t *info, const GStatBuf *st)
+{
+	return info->mtime != (gint64) st->st_mtim.tv_sec * G_GINT64_CONSTANT(
+	           1000000000) + st->st_mtim.tv_nsec || info->size != st->st_size;
+}
+
+/**
+ * Get the details of any certificate file (see header for API details)
+ */
+
+const cert_info_t *cert_store_lookup_path(const gchar *path, GError **error)
+{
+	cert_info_t *info;
+	STACK_OF(X509) *certs;
+	GStatBuf st;
+	gchar *data;
+	gsize len;
+	GError *read_error = NULL;
+
+	cache_init();
+
+	if (NULL == path || 0 != g_stat(path, &st) || !S_ISREG(st.st_mode))
+	{
+		if (NULL != path)
+		{
+			g_hash_table_remove(cache, path);
+		}
+
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_NOT_FOUND,
+		            "Certificate %s not found", NULL != path ? path : "");
+		return NULL;
+	}
+
+	info = g_hash_table_lookup(cache, path);
+
+	if (NULL != info && !file_changed(info, &st))
+	{
+		return info;
+	}
+
+	g_hash_table_remove(cache, path);
+
+	if (!g_file_get_contents(path, &data, &len, &read_error))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_IO,
+		            "Failed to read %s: %s", path, read_error->message);
+		g_error_free(read_error);
+		return NULL;
+	}
+
+	certs = parse_certs((const guchar *) data, len);
+	g_free(data);
+
+	if (NULL == certs)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_PARSE,
+		            "No certificate found in %s", path);
+		return NULL;
+	}
+
+	info = cert_info_new(path, certs);
+	set_file_stamp(info, &st);
+	g_hash_table_insert(cache, info->path, info);
+
+	return info;
+}
+
+/**
+ * Look up an imported certificate (see header for API details)
+ */
+
+const cert_info_t *cert_store_lookup(const gchar *name)
+{
+	const cert_info_t *info;
+	gchar *path;
+
+	if (NULL == store_dir || !cert_store_is_valid_name(name))
+	{
+		return NULL;
+	}
+
+	path = build_cert_path(name);
+	info = cert_store_lookup_path(path, NULL);
+	g_free(path);
+
+	return info;
+}
+
+/**
+ * Import a certificate (see header for API details)
+ */
+
+const cert_info_t *cert_store_import(const gchar *name, const guchar *data,
+                                     gsize len, GError **error)
+{
+	STACK_OF(X509) *certs;
+	cert_info_t *info = NULL;
+	BIO *bio = NULL;
+	GError *write_error = NULL;
+	GStatBuf st;
+	gchar *path = NULL;
+	char *pem;
+	long pem_len;
+	int n;
+
+	cache_init();
+
+	if (!cert_store_is_valid_name(name))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_INVALID_NAME,
+		            "Invalid certificate name");
+		return NULL;
+	}
+
+	if (NULL == store_dir)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_IO,
+		            "Certificate store not set up");
+		return NULL;
+	}
+
+	certs = parse_certs(data, len);
+
+	if (NULL == certs)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_PARSE,
+		            "No certificate found");
+		return NULL;
+	}
+
+	/* Stored as PEM whatever it came as, wpa_supplicant reads both */
+	bio = BIO_new(BIO_s_mem());
+
+	for (n = 0; NULL != bio && n < sk_X509_num(certs); n++)
+	{
+		if (1 != PEM_write_bio_X509(bio, sk_X509_value(certs, n)))
+		{
+			break;
+		}
+	}
+
+	if (NULL == bio || n != sk_X509_num(certs))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_PARSE,
+		            "Failed to encode certificate");
+		sk_X509_pop_free(certs, X509_free);
+		goto cleanup;
+	}
+
+	path = build_cert_path(name);
+	pem_len = BIO_get_mem_data(bio, &pem);
+
+	if (!g_file_set_contents(path, pem, pem_len, &write_error) ||
+	        0 != g_stat(path, &st))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_IO,
+		            "Failed to write %s: %s", path,
+		            NULL != write_error ? write_error->message : g_strerror(errno));
+		g_clear_error(&write_error);
+		sk_X509_pop_free(certs, X509_free);
+		goto cleanup;
+	}
+
+	/* Already parsed, no need to read it back */
+	g_hash_table_remove(cache, path);
+	info = cert_info_new(path, certs);
+	set_file_stamp(info, &st);
+	g_hash_table_insert(cache, info->path, info);
+
+cleanup:
+	BIO_free(bio);
+	g_free(path);
+	return info;
+}
+
+/**
+ * Remove an imported certificate (see header for API details)
+ */
+
+gboolean cert_store_remove(const gchar *name, GError **error)
+{
+	gchar *path;
+	gboolean ret = TRUE;
+
+	cache_init();
+
+	if (NULL == store_dir || !cert_store_is_valid_name(name))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_INVALID_NAME,
+		            "Invalid certificate name");
+		return FALSE;
+	}
+
+	path = build_cert_path(name);
+	g_hash_table_remove(cache, path);
+
+	if (0 != g_unlink(path))
+	{
+		g_set_error(error, CERT_STORE_ERROR,
+		            ENOENT == errno ? CERT_STORE_ERROR_NOT_FOUND : CERT_STORE_ERROR_IO,
+		            "Failed to remove certificate %s: %s", name, g_strerror(errno));
+		ret = FALSE;
+	}
+
+	g_free(path);
+	return ret;
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(((const cert_info_t *) a)->name,
+	                 ((const cert_info_t *) b)->name);
+}
+
+/**
+ * Get all imported certificates (see header for API details)
+ */
+
+GList *cert_store_get_all(void)
+{
+	GList *certs = NULL;
+	const gchar *file;
+	GDir *dir;
+
+	if (NULL == store_dir || NULL == (dir = g_dir_open(store_dir, 0, NULL)))
+	{
+		return NULL;
+	}
+
+	while (NULL != (file = g_dir_read_name(dir)))
+	{
+		gchar *path = g_build_filename(store_dir, file, NULL);
+		gchar *name = get_cert_name(path);
+		const cert_info_t *info = NULL;
+
+		/* Files which don't parse are skipped, they can still be removed */
+		if (NULL != name)
+		{
+			info = cert_store_lookup_path(path, NULL);
+		}
+
+		if (NULL != info)
+		{
+			certs = g_list_prepend(certs, (gpointer) info);
+		}
+
+		g_free(name);
+		g_free(path);
+	}
+
+	g_dir_close(dir);
+	return g_list_sort(certs, compare_names);
+}
+
+static gint compare_expiry(gconstpointer a, gconstpointer b)
+{
+	gint64 diff = ((const cert_info_t *) a)->not_after -
+	              ((const cert_info_t *) b)->not_after;
+
+	return diff < 0 ? -1 : diff > 0;
+}
+
+/**
+ * Get the certificates expiring soon (see header for API details)
+ */
+
+GList *cert_store_get_expiring(gint64 now, gint64 window)
+{
+	GList *certs = cert_store_get_all();
+	GList *iter = certs;
+
+	while (NULL != iter)
+	{
+		GList *next = iter->next;
+		const cert_info_t *info = iter->data;
+
+		if (info->not_after - now > window)
+		{
+			certs = g_list_delete_link(certs, iter);
+		}
+
+		iter = next;
+	}
+
+	return g_list_sort(certs, compare_expiry);
+}
+
+/**
+ * @brief Check the validity window of a single certificate
+ */
+
+static gboolean check_time(X509 *cert, const gchar *path, gint64 now,
+                           GError **error)
+{
+	gint64 not_before = asn1_time_to_unix(X509_get0_notBefore(cert));
+	gint64 not_after = asn1_time_to_unix(X509_get0_notAfter(cert));
+
+	if (now > not_after)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_EXPIRED,
+		            "Certificate %s has expired", path);
+		return FALSE;
+	}
+
+	if (now < not_before)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_NOT_YET_VALID,
+		            "Certificate %s is not valid yet", path);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * @brief A CA bundle is usable as long as one of its certificates is
+ */
+
+static gboolean check_ca_time(const cert_info_t *ca, gint64 now,
+                              GError **error)
+{
+	STACK_OF(X509) *certs = ca->certs;
+	GError *first_error = NULL;
+	int n;
+
+	for (n = 0; n < sk_X509_num(certs); n++)
+	{
+		if (check_time(sk_X509_value(certs, n), ca->path, now,
+		               NULL == first_error ? &first_error : NULL))
+		{
+			g_clear_error(&first_error);
+			return TRUE;
+		}
+	}
+
+	g_propagate_error(error, first_error);
+	return FALSE;
+}
+
+static gboolean verify_chain(const cert_info_t *ca, const cert_info_t *client,
+                             gint64 now, GError **error)
+{
+	STACK_OF(X509) *client_certs = client->certs;
+	STACK_OF(X509) *untrusted = NULL;
+	X509_STORE *store = X509_STORE_new();
+	X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+	gboolean ret = FALSE;
+	int n;
+
+	if (NULL == store || NULL == ctx)
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_IO,
+		            "Failed to set up certificate verification");
+		goto cleanup;
+	}
+
+	for (n = 0; n < sk_X509_num((STACK_OF(X509) *) ca->certs); n++)
+	{
+		X509_STORE_add_cert(store, sk_X509_value((STACK_OF(X509) *) ca->certs, n));
+	}
+
+	/* Intermediates shipped along with the client certificate */
+	untrusted = sk_X509_new_null();
+
+	for (n = 1; NULL != untrusted && n < sk_X509_num(client_certs); n++)
+	{
+		sk_X509_push(untrusted, sk_X509_value(client_certs, n));
+	}
+
+	if (1 != X509_STORE_CTX_init(ctx, store, sk_X509_value(client_certs, 0),
+	                             untrusted))
+	{
+		g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_IO,
+		            "Failed to set up certificate verification");
+		goto cleanup;
+	}
+
+	/* The CA may be an intermediate one, as with wpa_supplicant */
+	X509_STORE_CTX_set_flags(ctx, X509_V_FLAG_PARTIAL_CHAIN);
+	X509_STORE_CTX_set_time(ctx, 0, (time_t) now);
+
+	if (1 == X509_verify_cert(ctx))
+	{
+		ret = TRUE;
+		goto cleanup;
+	}
+
+	switch (X509_STORE_CTX_get_error(ctx))
+	{
+		case X509_V_ERR_CERT_HAS_EXPIRED:
+			g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_EXPIRED,
+			            "Certificate chain of %s has expired", client->path);
+			break;
+
+		case X509_V_ERR_CERT_NOT_YET_VALID:
+			g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_NOT_YET_VALID,
+			            "Certificate chain of %s is not valid yet", client->path);
+			break;
+
+		default:
+			g_set_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_UNTRUSTED,
+			            "Certificate %s isn't issued by %s: %s", client->path, ca->path,
+			            X509_verify_cert_error_string(X509_STORE_CTX_get_error(ctx)));
+			break;
+	}
+
+cleanup:
+	ERR_clear_error();
+	sk_X509_free(untrusted);
+	X509_STORE_CTX_free(ctx);
+	X509_STORE_free(store);
+	return ret;
+}
+
+/**
+ * Check the certificates of an enterprise profile (see header for API
+ * details)
+ */
+
+gboolean cert_store_validate(const gchar *ca_path, const gchar *client_path,
+                             gint64 now, GError **error)
+{
+	const cert_info_t *ca = NULL, *client = NULL;
+
+	if (NULL != ca_path && '\0' != ca_path[0])
+	{
+		ca = cert_store_lookup_path(ca_path, error);
+
+		if (NULL == ca || !check_ca_time(ca, now, error))
+		{
+			return FALSE;
+		}
+	}
+
+	if (NULL != client_path && '\0' != client_path[0])
+	{
+		client = cert_store_lookup_path(client_path, error);
+
+		if (NULL == client || !check_time(sk_X509_value((STACK_OF(X509) *)
+		                                  client->certs, 0), client->path, now, error))
+		{
+			return FALSE;
+		}
+	}
+
+	if (NULL != ca && NULL != client)
+	{
+		return verify_chain(ca, client, now, error);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Set up the store (see header for API details)
+ */
+
+gboolean cert_store_init(const gchar *dir)
+{
+	GList *certs;
+
+	cert_store_cleanup();
+
+	if (NULL == dir || 0 != g_mkdir_with_parents(dir, 0755))
+	{
+		return FALSE;
+	}
+
+	store_dir = g_strdup(dir);
+
+	/* Parse everything once up front */
+	certs = cert_store_get_all();
+	g_list_free(certs);
+
+	return TRUE;
+}
+
+/**
+ * Drop everything cached (see header for API details)
+ */
+
+void cert_store_cleanup(void)
+{
+	if (NULL != cache)
+	{
+		g_hash_table_destroy(cache);
+		cache = NULL;
+	}
+
+	g_free(store_dir);
+	store_dir = NULL;
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  cert_store.h
+ *
+ * @brief Header file defining the certificate store used by enterprise
+ *        (802.1X) wifi profiles
+ *
+ * Certificates are imported into a folder of their own as PEM files, which
+ * the profiles reference by path. Every certificate file, imported or not, is
+ * parsed once and its details are cached until the file changes. This lets
+ * us check the certificates of a profile before an EAP attempt, instead of
+ * finding out about a missing or expired certificate after it failed.
+ *
+ */
+
+#ifndef _CERT_STORE_H_
+#define _CERT_STORE_H_
+
+#include <glib.h>
+
+#define CERT_STORE_NAME_MAX     64
+
+#define CERT_STORE_ERROR        cert_store_error_quark()
+
+typedef enum
+{
+	CERT_STORE_ERROR_NOT_FOUND,
+	CERT_STORE_ERROR_PARSE,
+	CERT_STORE_ERROR_EXPIRED,
+	CERT_STORE_ERROR_NOT_YET_VALID,
+	CERT_STORE_ERROR_UNTRUSTED,
+	CERT_STORE_ERROR_INVALID_NAME,
+	CERT_STORE_ERROR_IO,
+} cert_store_error_t;
+
+typedef struct cert_info
+{
+	gchar *name;        /* Name in the store, NULL if not imported */
+	gchar *path;
+	gchar *subject;     /* Of the first certificate in the file, RFC 2253 */
+	gchar *issuer;
+	gint64 not_before;  /* Latest start of validity in the file, in seconds
+	                     * since the epoch */
+	gint64 not_after;   /* Earliest expiry in the file */
+	gchar *fingerprint; /* SHA-256 of the first certificate, "AB:CD:..." */
+	gboolean is_ca;
+	guint count;        /* Number of certificates in the file */
+	gpointer certs;     /* STACK_OF(X509) */
+	gint64 mtime;
+	gint64 size;
+} cert_info_t;
+
+extern GQuark cert_store_error_quark(void);
+
+/**
+ * Set up the store and load the certificates imported before. Can be called
+ * again to switch to another folder, which drops everything cached.
+ *
+ * @param[IN]  dir Folder of the imported certificates, created if needed
+ *
+ * @return TRUE if the folder is usable, FALSE otherwise
+ */
+extern gboolean cert_store_init(const gchar *dir);
+
+/**
+ * Drop everything cached
+ */
+extern void cert_store_cleanup(void);
+
+/**
+ * Check if a name can be used for a certificate. It is used as file name, so
+ * only letters, digits and ".-_" are allowed.
+ *
+ * @param[IN]  name Name to check
+ *
+ * @return TRUE if valid, FALSE otherwise
+ */
+extern gboolean cert_store_is_valid_name(const gchar *name);
+
+/**
+ * Import a certificate, or a CA bundle, replacing any with the same name
+ *
+ * @param[IN]  name Name of the certificate
+ * @param[IN]  data PEM or DER encoded certificates
+ * @param[IN]  len Length of data
+ * @param[OUT] error Why the import failed
+ *
+ * @return Details of the imported certificate, owned by the store, NULL on
+ * failure
+ */
+extern const cert_info_t *cert_store_import(const gchar *name,
+        const guchar *data, gsize len, GError **error);
+
+/**
+ * Remove an imported certificate
+ *
+ * @param[IN]  name Name of the certificate
+ * @param[OUT] error Why it couldn't be removed
+ *
+ * @return TRUE if removed, FALSE otherwise
+ */
+extern gboolean cert_store_remove(const gchar *name, GError **error);
+
+/**
+ * Look up an imported certificate
+ *
+ * @param[IN]  name Name of the certificate
+ *
+ * @return Details of the certificate, owned by the store, NULL if there is
+ * none with that name
+ */
+extern const cert_info_t *cert_store_lookup(const gchar *name);
+
+/**
+ * Get the details of any certificate file. The file is only parsed again if
+ * it changed since the last call.
+ *
+ * @param[IN]  path Path of the certificate file
+ * @param[OUT] error Why the file couldn't be parsed
+ *
+ * @return Details of the certificate, owned by the store, NULL on failure
+ */
+extern const cert_info_t *cert_store_lookup_path(const gchar *path,
+        GError **error);
+
+/**
+ * Get all imported certificates, ordered by name
+ *
+ * @return List of const cert_info_t *, free with g_list_free
+ */
+extern GList *cert_store_get_all(void);
+
+/**
+ * Check the certificates of an enterprise profile: they need to exist, be
+ * valid at the given time and the client certificate has to chain up to the
+ * CA certificate. Either path can be NULL.
+ *
+ * @param[IN]  ca_path Path of the CA certificate or bundle
+ * @param[IN]  client_path Path of the client certificate
+ * @param[IN]  now Time to check at, in seconds since the epoch
+ * @param[OUT] error Why the certificates aren't valid
+ *
+ * @return TRUE if valid, FALSE otherwise
+ */
+extern gboolean cert_store_validate(const gchar *ca_path,
+                                    const gchar *client_path, gint64 now, GError **error);
+
+/**
+ * Get the imported certificates which expire within a time window, including
+ * those which have expired already
+ *
+ * @param[IN]  now Current time, in seconds since the epoch
+ * @param[IN]  window Window in seconds
+ *
+ * @return List of const cert_info_t *, ordered by expiry, free with
+ * g_list_free
+ */
+extern GList *cert_store_get_expiring(gint64 now, gint64 window);
+
+#endif /* _CERT_STORE_H_ */
@@ -39,11 +39,13 @@ errorText | Yes | String | Error description
 */
 
 #include <glib.h>
+#include <gio/gio.h>
 #include <stdbool.h>
 #include <time.h>
 #include <string.h>
 #include <pbnjson.h>
 #include <errno.h>
+#include <net/if.h>
 
 #include "common.h"
 #include "connman_manager.h"
@@ -60,10 +62,26 @@ errorText | Yes | String | Error description
 #include "wan_service.h"
 #include "pan_service.h"
 #include "wifi_setting.h"
+#include "gateway_probe.h"
+#include "dns_probe.h"
+#include "network_fingerprint.h"
+#include "runtime_params.h"
+#include "dbus_call.h"
+#include "wired_8021x.h"
+#include "power_save.h"
+#include "nl80211_utils.h"
+#include "p2p_group_cache.h"
+#include "supplicant_p2p.h"
+#include "supplicant_wired.h"
+#include "ipv6_addresses.h"
+#include "ipv6_addresses_rtnl.h"
+#include "self_test.h"
 
 #define COUNTER_ACCURACY    10
 #define COUNTER_PERIOD      1
 #define GETINFO_UPDATE_INTERVAL_SECONDS 1
+/* A cached peer is invited again at most this often (s) */
+#define P2P_REINVOKE_INTERVAL 30
 
 static LSHandle *pLsHandle;
 
@@ -88,7 +106,32 @@ gboolean wired_plugged = FALSE;
 char getinfo_cur_wifi_mac_address[MAC_ADDR_STRING_LEN]={0};
 char getinfo_cur_wired_mac_address[MAC_ADDR_STRING_LEN]={0};
 
+/* Wired 802.1X profile, loaded from its .config file on first use */
+static connection_settings_t *wired_8021x_settings = NULL;
+static gboolean wired_8021x_loaded = FALSE;
+static wired_8021x_state_t wired_8021x_state = WIRED_8021X_STATE_DISABLED;
+
+/* Wifi power save, see setWifiPowerSave. The adaptive mode samples the
+ * totals of the wifi service reported to our counter. */
+static power_save_mode_t power_save_mode = POWER_SAVE_MODE_DEFAULT;
+/* Path of the connected peer whose group is already cached */
+static gchar *p2p_cached_peer_path = NULL;
+static gchar *p2p_invited_address = NULL;
+static gint64 p2p_invited_time = 0;
+/* A request to the supplicant is on its way */
+static gboolean p2p_invoke_pending = FALSE;
+/* The supplicant started our group again, the peer is still to be invited */
+static gboolean p2p_group_restarted = FALSE;
+static power_save_policy_t power_save_policy;
+static connman_counter_data_t wifi_counter_totals;
+/* Set when the cached IPv6 addresses changed since the last status */
+static gboolean ipv6_addresses_changed = FALSE;
+/* Self test started by runSelfTest and the call waiting for its result */
+static self_test_t *running_self_test = NULL;
+static luna_service_request_t *self_test_req = NULL;
+
 static void getinfo_update(void);
+static void schedule_dns_probe(void);
 
 #define IS_WIRED_PLUGGED() g_slist_length(manager->wired_services)
 
@@ -122,6 +165,86 @@ static gboolean set_ethernet_tethering_state(bool state)
 	           connman_manager_find_ethernet_technology(manager), state);
 }
 
+/**
+ * @brief Add the health of the nameservers of a service to its status object
+ */
+
+static void append_dns_health(jvalue_ref *status, GList *health)
+{
+	jvalue_ref servers_j = jarray_create(NULL);
+	GList *iter;
+
+	for (iter = health; NULL != iter; iter = iter->next)
+	{
+		dns_server_health_t *server = iter->data;
+		jvalue_ref server_j = jobject_create();
+
+		jobject_put(server_j, J_CSTR_TO_JVAL("address"),
+		            jstring_create(server->address));
+
+		if (server->latency >= 0)
+		{
+			jobject_put(server_j, J_CSTR_TO_JVAL("latency"),
+			            jnumber_create_i32((gint)(server->latency + 0.5)));
+		}
+
+		jobject_put(server_j, J_CSTR_TO_JVAL("failureRate"),
+		            jnumber_create_f64(server->failure_rate));
+		jobject_put(server_j, J_CSTR_TO_JVAL("probes"),
+		            jnumber_create_i32(server->probes));
+		jarray_append(servers_j, server_j);
+	}
+
+	jobject_put(*status, J_CSTR_TO_JVAL("dnsServers"), servers_j);
+}
+
+/**
+ * @brief Add the IPv6 addresses of an interface to its ipv6 status object,
+ * taken from the cache so no netlink request is made
+ */
+
+static void append_ipv6_addresses(jvalue_ref *ipv6_status, const gchar *iface,
+                                  gboolean prefer_stable)
+{
+	gint64 now = g_get_monotonic_time() / G_USEC_PER_SEC;
+	jvalue_ref addresses_j = jarray_create(NULL);
+	GList *addresses = ipv6_addresses_get(if_nametoindex(iface), prefer_stable);
+	GList *iter;
+
+	for (iter = addresses; NULL != iter; iter = iter->next)
+	{
+		ipv6_address_t *address = iter->data;
+		jvalue_ref address_j = jobject_create();
+		jvalue_ref flags_j = jarray_create(NULL);
+		const gchar **flags = ipv6_address_get_flag_names(address);
+		guint i;
+
+		for (i = 0; NULL != flags[i]; i++)
+		{
+			jarray_append(flags_j, jstring_create(flags[i]));
+		}
+
+		g_free(flags);
+
+		jobject_put(address_j, J_CSTR_TO_JVAL("address"),
+		            jstring_create(address->address));
+		jobject_put(address_j, J_CSTR_TO_JVAL("prefixLength"),
+		            jnumber_create_i32(address->prefix_length));
+		jobject_put(address_j, J_CSTR_TO_JVAL("scope"),
+		            jstring_create(ipv6_address_scope_to_string(address->scope)));
+		jobject_put(address_j, J_CSTR_TO_JVAL("flags"), flags_j);
+		jobject_put(address_j, J_CSTR_TO_JVAL("preferredLifetime"),
+		            jnumber_create_i64(ipv6_address_get_lifetime(address, FALSE, now)));
+		jobject_put(address_j, J_CSTR_TO_JVAL("validLifetime"),
+		            jnumber_create_i64(ipv6_address_get_lifetime(address, TRUE, now)));
+		jarray_append(addresses_j, address_j);
+	}
+
+	g_list_free(addresses);
+
+	jobject_put(*ipv6_status, J_CSTR_TO_JVAL("addresses"), addresses_j);
+}
+
 /**
  * @brief Fill in information about the system's connection status
  *
@@ -200,8 +323,25 @@ static void update_connection_status(connman_service_t *connected_service,
 			            jboolean_create(false));
 		}
 
-		const char *s = connman_service_is_online(connected_service) ? "yes" : "no";
+		/* Without a reachable gateway connman's online state is outdated */
+		const char *s = (connman_service_is_online(connected_service) &&
+		                 connected_service->gateway_state != GATEWAY_PROBE_STATE_UNREACHABLE) ?
+		                "yes" : "no";
 		jobject_put(*status, J_CSTR_TO_JVAL("onInternet"), jstring_create(s));
+		jobject_put(*status, J_CSTR_TO_JVAL("gatewayReachable"),
+		            jstring_create(gateway_probe_state_to_string(connected_service->gateway_state)));
+
+		if (NULL != connected_service->dns_health)
+		{
+			append_dns_health(status, connected_service->dns_health);
+		}
+
+		if (connected_service->has_fingerprint)
+		{
+			gchar *fingerprint = network_fingerprint_to_string(connected_service->fingerprint);
+			jobject_put(*status, J_CSTR_TO_JVAL("fingerprint"), jstring_create(fingerprint));
+			g_free(fingerprint);
+		}
 		jobject_put(*status, J_CSTR_TO_JVAL("checkingInternet"), jboolean_create(connected_service->online_checking));
 
 		if (NULL != connected_service->ipinfo.ipv6.address)
@@ -230,6 +370,23 @@ static void update_connection_status(connman_service_t *connected_service,
 				            jstring_create(connected_service->ipinfo.ipv6.method));
 			}
 
+			gboolean privacy = FALSE, prefer_stable = TRUE;
+
+			if (ipv6_privacy_from_connman(connected_service->ipinfo.ipv6.privacy, &privacy,
+			                              &prefer_stable))
+			{
+				jobject_put(connected_ipv6_status, J_CSTR_TO_JVAL("privacy"),
+				            jboolean_create(privacy));
+				jobject_put(connected_ipv6_status, J_CSTR_TO_JVAL("preferStableAddress"),
+				            jboolean_create(prefer_stable));
+			}
+
+			if (NULL != connected_service->ipinfo.iface)
+			{
+				append_ipv6_addresses(&connected_ipv6_status, connected_service->ipinfo.iface,
+				                      prefer_stable);
+			}
+
 			jobject_put(*status, J_CSTR_TO_JVAL("ipv6"), connected_ipv6_status);
 		}
 
@@ -289,6 +446,34 @@ static void update_connection_status(connman_service_t *connected_service,
 	}
 }
 
+/**
+ * @brief Check if the gateways of all connected wired and wifi services failed
+ * the last reachability probe while no other technology provides a connection
+ */
+
+static gboolean is_gateway_unreachable(void)
+{
+	if (wan_connected || pan_connected)
+	{
+		return FALSE;
+	}
+
+	connman_service_t *connected_wired_service =
+	    connman_manager_get_connected_service(manager->wired_services);
+	connman_service_t *connected_wifi_service =
+	    connman_manager_get_connected_service(manager->wifi_services);
+
+	if (!connected_wired_service && !connected_wifi_service)
+	{
+		return FALSE;
+	}
+
+	return (!connected_wired_service ||
+	        connected_wired_service->gateway_state == GATEWAY_PROBE_STATE_UNREACHABLE) &&
+	       (!connected_wifi_service ||
+	        connected_wifi_service->gateway_state == GATEWAY_PROBE_STATE_UNREACHABLE);
+}
+
 /**
  * @brief Handle the "PropertyChanged" signal for a net.connman.Group dbus object.
  *
@@ -425,6 +610,88 @@ static void append_p2p_connection_status(jvalue_ref *status,
 	}
 }
 
+static void wired_eap_state_cb(gpointer user_data)
+{
+	connectionmanager_send_status_to_subscribers();
+}
+
+/**
+ * @brief Get the wired 802.1X profile, loading it the first time the wired
+ * interface is known. The EAP state of the port is followed while a profile
+ * is set up.
+ *
+ * @return The profile, NULL if none is set up
+ */
+
+static connection_settings_t *get_wired_8021x_settings(void)
+{
+	char mac_address[MAC_ADDR_STRING_LEN] = {0};
+
+	if (wired_8021x_loaded)
+	{
+		return wired_8021x_settings;
+	}
+
+	if (!retrieve_wired_mac_address(mac_address, MAC_ADDR_STRING_LEN))
+	{
+		return NULL;
+	}
+
+	wired_8021x_loaded = TRUE;
+	wired_8021x_settings = connection_settings_new();
+
+	if (!load_wired_network_config(mac_address, wired_8021x_settings))
+	{
+		connection_settings_free(wired_8021x_settings);
+		wired_8021x_settings = NULL;
+		return NULL;
+	}
+
+	supplicant_wired_watch(CONNMAN_WIRED_INTERFACE_NAME, wired_eap_state_cb, NULL);
+	return wired_8021x_settings;
+}
+
+/**
+ * @brief Get the 802.1X authentication state of the wired port, from the
+ * EAP state of the supplicant and the state of the wired service connman
+ * created for it
+ */
+
+static wired_8021x_state_t get_wired_8021x_state(void)
+{
+	connman_service_t *service = NULL;
+
+	if (NULL != manager && NULL != manager->wired_services)
+	{
+		service = manager->wired_services->data;
+	}
+
+	return wired_8021x_get_state(NULL != get_wired_8021x_settings(),
+	                             service ? service->state : NULL, service ? service->error : NULL,
+	                             supplicant_wired_get_state());
+}
+
+/**
+ * @brief Add the 802.1X authentication state to a wired status object
+ */
+
+static void append_wired_8021x_status(jvalue_ref *wired_status)
+{
+	jvalue_ref auth_j = jobject_create();
+	connection_settings_t *settings = get_wired_8021x_settings();
+
+	jobject_put(auth_j, J_CSTR_TO_JVAL("state"),
+	            jstring_create(wired_8021x_state_to_string(get_wired_8021x_state())));
+
+	if (NULL != settings)
+	{
+		jobject_put(auth_j, J_CSTR_TO_JVAL("eapType"),
+		            jstring_create(settings->eap_type));
+	}
+
+	jobject_put(*wired_status, J_CSTR_TO_JVAL("auth8021x"), auth_j);
+}
+
 /**
  * @brief Append the current connection status to a supplied JSON object. The format
  * matches the response format for the com.webos.service.connectionmanager/getstatus method.
@@ -442,7 +709,8 @@ static void append_connection_status(jvalue_ref *reply, bool subscribed,
 
 	jobject_put(*reply, J_CSTR_TO_JVAL("subscribed"), jboolean_create(subscribed));
 	jobject_put(*reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
-	gboolean online = connman_manager_is_manager_online(manager);
+	gboolean online = connman_manager_is_manager_online(manager) &&
+	                  !is_gateway_unreachable();
 	jobject_put(*reply, J_CSTR_TO_JVAL("isInternetConnectionAvailable"),
 	            jboolean_create(online));
 	gboolean offlineMode = !connman_manager_is_manager_available(manager);
@@ -474,6 +742,7 @@ static void append_connection_status(jvalue_ref *reply, bool subscribed,
 		update_connection_status(connected_wired_service, &connected_wired_status);
 		jobject_put(connected_wired_status, J_CSTR_TO_JVAL("plugged"),
 		            jboolean_create(true));
+		append_wired_8021x_status(&connected_wired_status);
 		jobject_put(*reply, J_CSTR_TO_JVAL("wired"), connected_wired_status);
 		j_release(&disconnected_wired_status);
 	}
@@ -481,6 +750,7 @@ static void append_connection_status(jvalue_ref *reply, bool subscribed,
 	{
 		jobject_put(disconnected_wired_status, J_CSTR_TO_JVAL("plugged"),
 		            jboolean_create(wired_plugged ? true : false));
+		append_wired_8021x_status(&disconnected_wired_status);
 		jobject_put(*reply, J_CSTR_TO_JVAL("wired"), disconnected_wired_status);
 		j_release(&connected_wired_status);
 	}
@@ -631,6 +901,243 @@ static gboolean check_service_for_update(connman_service_t *service,
 	return needed;
 }
 
+/**
+ * @brief Find the group a peer is connected in. Only one group exists at a
+ * time, so it is taken when the peer isn't listed in it yet.
+ */
+
+static connman_group_t *find_group_of_peer(connman_service_t *service)
+{
+	GSList *iter;
+
+	for (iter = manager->groups; NULL != iter; iter = iter->next)
+	{
+		connman_group_t *group = (connman_group_t *)(iter->data);
+
+		if (NULL != g_slist_find(group->peer_list, service))
+		{
+			return group;
+		}
+	}
+
+	return (NULL != manager->groups && NULL == manager->groups->next) ?
+	       (connman_group_t *)(manager->groups->data) : NULL;
+}
+
+/**
+ * @brief Record the connect latency of a peer and cache its group if it is
+ * persistent
+ *
+ * @return TRUE once the group of the peer is known
+ */
+
+static gboolean cache_p2p_group(connman_service_t *service)
+{
+	const gchar *address = service->peer.address;
+
+	if (service->connect_time_ms >= 0)
+	{
+		/* Only a connect following our invite skipped negotiation */
+		gboolean cached = (NULL != address && NULL != p2p_invited_address &&
+		                   !g_ascii_strcasecmp(p2p_invited_address, address) &&
+		                   g_get_monotonic_time() - p2p_invited_time <
+		                   P2P_REINVOKE_INTERVAL * G_USEC_PER_SEC);
+
+		p2p_group_cache_record_latency(cached, service->connect_time_ms);
+		WCALOG_INFO(MSGID_CM_P2P_GROUP_CACHE_INFO, 0,
+		            "Connected to peer %s in %" G_GINT64_FORMAT " ms (%s)", address,
+		            service->connect_time_ms, cached ? "cached group" : "negotiated");
+		service->connect_time_ms = -1;
+
+		g_free(p2p_invited_address);
+		p2p_invited_address = NULL;
+	}
+
+	connman_group_t *group = find_group_of_peer(service);
+
+	if (NULL == group)
+	{
+		return FALSE;
+	}
+
+	if (group->is_persistent && NULL != address)
+	{
+		p2p_group_cache_update(address,
+		                       group->is_group_owner ? P2P_GROUP_ROLE_OWNER : P2P_GROUP_ROLE_CLIENT,
+		                       group->freq, group->name, time(NULL));
+		store_wifi_setting(WIFI_P2P_GROUP_CACHE_SETTING, NULL);
+	}
+
+	return TRUE;
+}
+
+static void reinvoke_cached_p2p_peers(void);
+
+static void supplicant_invoke_cb(const GError *error, gpointer user_data)
+{
+	p2p_group_role_t role = GPOINTER_TO_INT(user_data);
+
+	p2p_invoke_pending = FALSE;
+
+	if (NULL != error)
+	{
+		WCALOG_ERROR(MSGID_CM_P2P_GROUP_CACHE_ERROR, 0,
+		             "Failed to re-invoke group for peer %s: %s", p2p_invited_address,
+		             error->message);
+
+		/* The supplicant lost the credentials, negotiate next time */
+		if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND) &&
+		        NULL != p2p_invited_address)
+		{
+			p2p_group_cache_remove(p2p_invited_address);
+			store_wifi_setting(WIFI_P2P_GROUP_CACHE_SETTING, NULL);
+		}
+
+		return;
+	}
+
+	/* The peer is invited once connman lists the group */
+	if (P2P_GROUP_ROLE_OWNER == role)
+	{
+		p2p_group_restarted = TRUE;
+
+		if (NULL != manager && is_wifi_powered())
+		{
+			reinvoke_cached_p2p_peers();
+		}
+	}
+}
+
+/**
+ * @brief Invite a known peer which reappeared into its persistent group, which
+ * skips GO negotiation. While we still own the group it is joined through
+ * connman. Once the group is gone wpa_supplicant re-invokes it from the stored
+ * credentials: a group we owned is started again on its cached channel, the
+ * peer being invited once it is up, a group we were a client of is re-invoked
+ * by inviting the peer.
+ */
+
+static void reinvoke_cached_p2p_peers(void)
+{
+	connman_technology_t *technology = connman_manager_find_wifi_technology(
+	                                       manager);
+	connman_group_t *group = NULL;
+	GSList *iter;
+
+	if (NULL == technology || !technology->persistent_mode || p2p_invoke_pending)
+	{
+		return;
+	}
+
+	for (iter = manager->groups; NULL != iter; iter = iter->next)
+	{
+		connman_group_t *candidate = (connman_group_t *)(iter->data);
+
+		if (candidate->is_group_owner && candidate->is_persistent)
+		{
+			group = candidate;
+			break;
+		}
+	}
+
+	/* Only one group exists at a time, and a peer being connected is left be */
+	if ((NULL == group && NULL != manager->groups) ||
+	        NULL != connman_manager_get_connecting_service(manager->p2p_services))
+	{
+		return;
+	}
+
+	gint64 now = g_get_monotonic_time();
+
+	for (iter = manager->p2p_services; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *)(iter->data);
+		const p2p_cached_group_t *cached = p2p_group_cache_lookup(
+		                                       service->peer.address);
+
+		if (NULL == cached || (NULL != group &&
+		                       (cached->role != P2P_GROUP_ROLE_OWNER ||
+		                        g_strcmp0(cached->group_name, group->name))))
+		{
+			continue;
+		}
+
+		if (!g_strcmp0(p2p_invited_address, cached->peer_address) &&
+		        now - p2p_invited_time < P2P_REINVOKE_INTERVAL * G_USEC_PER_SEC &&
+		        !(NULL != group && p2p_group_restarted))
+		{
+			continue;
+		}
+
+		g_free(p2p_invited_address);
+		p2p_invited_address = g_strdup(cached->peer_address);
+		p2p_invited_time = now;
+
+		if (NULL != group)
+		{
+			WCALOG_INFO(MSGID_CM_P2P_GROUP_CACHE_INFO, 0,
+			            "Re-invoking group %s on %d MHz for peer %s", group->name,
+			            group->freq, cached->peer_address);
+			p2p_group_restarted = FALSE;
+			connman_group_invite_peer(group, service);
+			break;
+		}
+
+		WCALOG_INFO(MSGID_CM_P2P_GROUP_CACHE_INFO, 0,
+		            "Re-invoking stored group %s as %s on %d MHz for peer %s",
+		            cached->group_name, p2p_group_role_to_string(cached->role), cached->freq,
+		            cached->peer_address);
+
+		p2p_invoke_pending = TRUE;
+		supplicant_p2p_invoke_group(CONNMAN_WIFI_INTERFACE_NAME, cached->group_name,
+		                            cached->peer_address, P2P_GROUP_ROLE_OWNER == cached->role, cached->freq,
+		                            supplicant_invoke_cb, GINT_TO_POINTER(cached->role));
+		break;
+	}
+}
+
+/**
+ * @brief Cache the group of a newly connected peer, or re-invoke the group of
+ * a known peer while none is connected. Called when the P2P services or
+ * groups change.
+ */
+
+void connectionmanager_update_p2p_group_cache(void)
+{
+	connman_service_t *service = NULL;
+
+	if (NULL == manager)
+	{
+		return;
+	}
+
+	if (is_wifi_powered())
+	{
+		service = connman_manager_get_connected_service(manager->p2p_services);
+	}
+
+	if (NULL == service)
+	{
+		g_free(p2p_cached_peer_path);
+		p2p_cached_peer_path = NULL;
+
+		if (is_wifi_powered())
+		{
+			reinvoke_cached_p2p_peers();
+		}
+
+		return;
+	}
+
+	if (connman_service_is_connected(service) &&
+	        g_strcmp0(p2p_cached_peer_path, service->path) &&
+	        cache_p2p_group(service))
+	{
+		g_free(p2p_cached_peer_path);
+		p2p_cached_peer_path = g_strdup(service->path);
+	}
+}
+
 /**
  * @brief Check whether a update needs to be send for subscribers of the
  * com.webos.service.connectionmanager/getstatus method.
@@ -700,6 +1207,23 @@ static gboolean check_update_is_needed(void)
 
 	wired_plugged = IS_WIRED_PLUGGED();
 
+	if (ipv6_addresses_changed)
+	{
+		ipv6_addresses_changed = FALSE;
+		needed = TRUE;
+	}
+
+	wired_8021x_state_t old_wired_8021x_state = wired_8021x_state;
+
+	wired_8021x_state = get_wired_8021x_state();
+
+	if (old_wired_8021x_state != wired_8021x_state)
+	{
+		WCALOG_INFO(MSGID_CM_WIRED_8021X_INFO, 0, "Wired 802.1X state: %s",
+		            wired_8021x_state_to_string(wired_8021x_state));
+		needed = TRUE;
+	}
+
 	connman_service_t *connected_p2p_service = NULL;
 
 	if (is_wifi_powered())
@@ -789,7 +1313,7 @@ void connectionmanager_send_status_to_subscribers(void)
 
 		if (connected_wired_service)
 		{
-			// "block_getstatus_response" blocks connectionmanager/getstatus for 1 seconds
+			// "block_getstatus_response" blocks connectionmanager/getstatus for internetStatusTimeout seconds
 			// While getstatus is blocked, "wired_skip" flag will be used to emit the
 			// getstatus response if online_checking status is modified.
 			if (connected_wired_service->online_checking == wired_online_checking_status)
@@ -803,7 +1327,7 @@ void connectionmanager_send_status_to_subscribers(void)
 
 		if (connected_wifi_service)
 		{
-			// "block_getstatus_response" blocks connectionmanager/getstatus for 1 seconds
+			// "block_getstatus_response" blocks connectionmanager/getstatus for internetStatusTimeout seconds
 			// While getstatus is blocked, "wired_skip" flag will be used to emit the
 			// getstatus response if online_checking status is modified.
 			if (connected_wifi_service->online_checking == wifi_online_checking_status)
@@ -925,6 +1449,11 @@ gateway | no | String | IP address of network gateway
 dns<n> | no | String | List of IP Addreses of dns servers for this connection
 method | no | String | How the IP addressed was assigned (e.g. "Manual", "dhcp")
 onInternet | no | String | "yes" or "no" to indicate if the service is "online"
+gatewayReachable | no | String | "yes", "no" or "unknown" to indicate if the gateway answered the last checkinternetstatus probe
+fingerprint | no | String | Fingerprint of the network, used to bind settings with setipv4, setdns and setProxy
+dnsServers | no | Array of Object | Health of the nameservers, probed on connect and every dnsProbeInterval seconds. Each object holds "address", "latency" (moving average of the answer time in ms, absent until the server answered), "failureRate" (moving average of lost queries, 0 to 1) and "probes". A server answering clearly faster than the first one for several probes in a row is moved to the front.
+auth8021x | yes | Object | 802.1X authentication of the wired port. Holds "state", which is "disabled", "unauthenticated", "authenticating", "authenticated", "failed" or "unknown", and "eapType" if a profile is set up with setWired8021x. The state follows the EAP exchange of the supplicant on the wired port, "unknown" means the link is up but no EAP exchange was seen, e.g. on an open port or with a connman which doesn't run EAP on ethernet
+ipv6 | no | Object | IPv6 state of the connection, see "ipv6" State Object
 
 @par "wifi" State Object
 
@@ -942,6 +1471,22 @@ method | no | String | How the IP addressed was assigned (e.g. "Manual", "dhcp")
 ssid | no | String | SSID of the connected service (if known)
 isWakeOnWiFiEnabled | no | Boolean | True if "Wake on WIFI" is enabled
 onInternet | no | String | "yes" or "no" to indicate if the service is "online"
+gatewayReachable | no | String | "yes", "no" or "unknown" to indicate if the gateway answered the last checkinternetstatus probe
+fingerprint | no | String | Fingerprint of the network, used to bind settings with setipv4, setdns and setProxy
+dnsServers | no | Array of Object | Health of the nameservers, see the "wired" object
+ipv6 | no | Object | IPv6 state of the connection, see "ipv6" State Object
+
+@par "ipv6" State Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+ipAddress | yes | String | IPv6 address connman configured
+prefixLength | no | Integer | Prefix length of ipAddress
+gateway | no | String | IPv6 router
+method | no | String | How the address was assigned, e.g. "auto", "manual" or "6to4"
+privacy | no | Boolean | True if temporary addresses (privacy extensions) are used
+preferStableAddress | no | Boolean | True if new connections use the stable address while temporary addresses exist
+addresses | no | Array of Object | All addresses of the interface, in the order they are preferred as source address. Each object holds "address", "prefixLength", "scope" ("global", "site", "link" or "host"), "flags" (e.g. "temporary", "stablePrivacy", "deprecated", "tentative") and "preferredLifetime" and "validLifetime" in seconds, -1 if the address doesn't expire
 
 @par "wifiDirect" State Object
 
@@ -1088,16 +1633,274 @@ static connman_service_t *retrieve_service_by_ssid(gchar *ssid)
 	return NULL;
 }
 
-//->Start of API documentation comment block
 /**
-@page com_webos_connectionmanager com.webos.connectionmanager
-@{
-@section com_webos_connectionmanager_setipv4 setipv4
+ * @brief Find the connected wired or wifi service whose network has the given fingerprint
+ */
 
-Modify the parameters of an IPv4 connection (wired or WIFI)
+static connman_service_t *retrieve_service_by_fingerprint(guint64 fingerprint)
+{
+	connman_service_t *services[] =
+	{
+		connman_manager_get_connected_service(manager->wired_services),
+		connman_manager_get_connected_service(manager->wifi_services),
+	};
+	gsize i;
 
-If an SSID field is not provided in the request, the modifications are
-applied to the wired connection.
+	for (i = 0; i < G_N_ELEMENTS(services); i++)
+	{
+		if (NULL != services[i] && services[i]->has_fingerprint &&
+		        services[i]->fingerprint == fingerprint)
+		{
+			return services[i];
+		}
+	}
+
+	return NULL;
+}
+
+static gboolean strv_equal(GStrv a, GStrv b)
+{
+	guint i;
+
+	for (i = 0; NULL != a && NULL != b && NULL != a[i] && NULL != b[i]; i++)
+	{
+		if (g_strcmp0(a[i], b[i]))
+		{
+			return FALSE;
+		}
+	}
+
+	return (NULL == a || NULL == a[i]) && (NULL == b || NULL == b[i]);
+}
+
+/**
+ * @brief Put back the settings bound settings replaced on a service. A
+ * setting is only put back while it still is what the binding wrote, so
+ * changes made since are kept.
+ */
+
+static void undo_network_binding(connman_service_t *service,
+                                 network_applied_t *applied)
+{
+	network_binding_t *written = &applied->written;
+	network_binding_t *previous = &applied->previous;
+
+	if (NULL != written->ipv4.method && NULL != previous->ipv4.method &&
+	        !g_strcmp0(written->ipv4.method, service->ipinfo.ipv4.method) &&
+	        !g_strcmp0(written->ipv4.address, service->ipinfo.ipv4.address))
+	{
+		connman_service_set_ipv4(service, &previous->ipv4);
+	}
+
+	if (NULL != written->dns && strv_equal(written->dns, service->dns_config))
+	{
+		gchar *none[] = { NULL };
+
+		connman_service_set_nameservers(service, NULL != previous->dns ?
+		                                previous->dns : none);
+	}
+
+	if (NULL != written->proxy.method && NULL != previous->proxy.method &&
+	        !g_strcmp0(written->proxy.method, service->proxyinfo.method) &&
+	        !g_strcmp0(written->proxy.url, service->proxyinfo.url) &&
+	        strv_equal(written->proxy.servers, service->proxyinfo.servers))
+	{
+		connman_service_set_proxy(service, &previous->proxy);
+	}
+
+	network_binding_forget_applied(service->identifier);
+	store_wifi_setting(WIFI_NETWORK_BINDINGS_SETTING, NULL);
+}
+
+/**
+ * @brief Record what a binding is about to write to a service. The settings
+ * it replaces are only taken the first time a setting is written, so they
+ * are the ones from before any binding.
+ */
+
+static void record_network_binding(connman_service_t *service,
+                                   network_binding_t *binding)
+{
+	network_applied_t *applied = network_binding_set_applied(service->identifier,
+	                             service->site);
+
+	if (NULL == applied)
+	{
+		return;
+	}
+
+	if (NULL != binding->ipv4.method && NULL == applied->written.ipv4.method)
+	{
+		const gchar *method = service->ipinfo.ipv4.method;
+
+		/* A manual configuration is kept as is, anything else was dhcp */
+		ipv4info_t dhcp = { .method = "dhcp" };
+
+		network_binding_copy_ipv4(&applied->previous.ipv4, !g_strcmp0(method,
+		                          "manual") ? &service->ipinfo.ipv4 : &dhcp);
+	}
+
+	if (NULL != binding->dns && NULL == applied->written.dns)
+	{
+		applied->previous.dns = g_strdupv(service->dns_config);
+	}
+
+	if (NULL != binding->proxy.method && NULL == applied->written.proxy.method)
+	{
+		/* Without a proxy connman reports none at all */
+		proxyinfo_t direct = { .method = "direct" };
+
+		network_binding_copy_proxy(&applied->previous.proxy,
+		                           NULL != service->proxyinfo.method ? &service->proxyinfo : &direct);
+	}
+
+	applied->written.fingerprint = binding->fingerprint;
+
+	if (NULL != binding->ipv4.method)
+	{
+		network_binding_copy_ipv4(&applied->written.ipv4, &binding->ipv4);
+	}
+
+	if (NULL != binding->dns)
+	{
+		g_strfreev(applied->written.dns);
+		applied->written.dns = g_strdupv(binding->dns);
+	}
+
+	if (NULL != binding->proxy.method)
+	{
+		network_binding_copy_proxy(&applied->written.proxy, &binding->proxy);
+	}
+
+	store_wifi_setting(WIFI_NETWORK_BINDINGS_SETTING, NULL);
+}
+
+/**
+ * @brief Apply the settings bound to the fingerprint of a service. connman
+ * keeps them for every network with the same SSID, so once the service is
+ * on another network, i.e. its SSID or gateway differ, the settings the
+ * binding replaced are put back, as they are once the binding was removed.
+ * Access points of another vendor coming into range change the fingerprint
+ * but not the network, so they are ignored.
+ */
+
+static void apply_network_binding(connman_service_t *service)
+{
+	network_binding_t *binding = network_binding_lookup(service->fingerprint);
+	network_applied_t *applied = network_binding_get_applied_to(
+	                                 service->identifier);
+
+	if (NULL != applied && (applied->site != service->site ||
+	                        NULL == network_binding_lookup(applied->written.fingerprint)))
+	{
+		undo_network_binding(service, applied);
+	}
+
+	if (NULL == binding)
+	{
+		return;
+	}
+
+	record_network_binding(service, binding);
+
+	/* Setting the IPv4 configuration restarts it, so only do it if it differs */
+	if (NULL != binding->ipv4.method &&
+	        (g_strcmp0(binding->ipv4.method, service->ipinfo.ipv4.method) ||
+	         g_strcmp0(binding->ipv4.address, service->ipinfo.ipv4.address)))
+	{
+		connman_service_set_ipv4(service, &binding->ipv4);
+	}
+
+	if (NULL != binding->dns)
+	{
+		connman_service_set_nameservers(service, binding->dns);
+	}
+
+	if (NULL != binding->proxy.method)
+	{
+		connman_service_set_proxy(service, &binding->proxy);
+	}
+}
+
+/**
+ * @brief Compute the fingerprint of a ready service from the hardware address
+ * of its gateway and apply the settings bound to it
+ */
+
+static void update_network_fingerprint(connman_service_t *service,
+                                       const guint8 *gateway_mac)
+{
+	GArray *bss = service->bss;
+
+	const gchar *ssid = connman_service_type_wifi(service) ? service->name : NULL;
+
+	if (!network_fingerprint_compute(ssid, gateway_mac,
+	                                 bss ? (bssinfo_t *) bss->data : NULL, bss ? bss->len : 0,
+	                                 &service->fingerprint) ||
+	        !network_fingerprint_compute_site(ssid, gateway_mac, &service->site))
+	{
+		return;
+	}
+
+	service->has_fingerprint = TRUE;
+	connman_service_set_changed(service, CONNMAN_SERVICE_CHANGE_CATEGORY_GETSTATUS);
+
+	apply_network_binding(service);
+}
+
+/**
+ * @brief Parse the optional "fingerprint" parameter of the set commands
+ *
+ * @return FALSE if the parameter is malformed, TRUE otherwise
+ */
+
+static gboolean get_fingerprint_param(jvalue_ref parsedObj,
+                                      gboolean *has_fingerprint, guint64 *fingerprint)
+{
+	jvalue_ref fingerprintObj = {0};
+	gboolean ret = TRUE;
+
+	*has_fingerprint = jobject_get_exists(parsedObj, J_CSTR_TO_BUF("fingerprint"),
+	                                      &fingerprintObj);
+
+	if (*has_fingerprint)
+	{
+		raw_buffer fingerprint_buf = jstring_get(fingerprintObj);
+		ret = network_fingerprint_from_string(fingerprint_buf.m_str, fingerprint);
+		jstring_free_buffer(fingerprint_buf);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Store the changed bindings and apply them right away if the network
+ * with the given fingerprint is connected
+ */
+
+static void update_network_binding(guint64 fingerprint)
+{
+	store_wifi_setting(WIFI_NETWORK_BINDINGS_SETTING, NULL);
+
+	connman_service_t *service = retrieve_service_by_fingerprint(fingerprint);
+
+	if (NULL != service)
+	{
+		connman_service_get_ipinfo(service);
+		apply_network_binding(service);
+	}
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_setipv4 setipv4
+
+Modify the parameters of an IPv4 connection (wired or WIFI)
+
+If an SSID field is not provided in the request, the modifications are
+applied to the wired connection.
 
 @par Parameters
 
@@ -1108,6 +1911,7 @@ Name | Required | Type | Description
 "netmask" | no | String | If specified, sets a new netmask (only when method is "manual")
 "gateway" | no | String | If specified, sets a new gateway IP address (only when method is "manual")
 "ssid" | no | String | Select the wifi connection to modify. If absent, the wired connection is changed.
+"fingerprint" | no | String | Bind the settings to the network with this fingerprint (see getstatus) instead of changing a connection. They are applied whenever the network is connected.
 
 @par Returns(Call)
 
@@ -1134,10 +1938,10 @@ static bool handle_set_ipv4_command(LSHandle *sh, LSMessage *message,
 	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_5(PROP(method, string), PROP(address,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_6(PROP(method, string), PROP(address,
 	                                     string),
 	                                     PROP(netmask, string), PROP(gateway, string), PROP(ssid,
-	                                             string)) REQUIRED_1(method))), &parsedObj))
+	                                             string), PROP(fingerprint, string)) REQUIRED_1(method))), &parsedObj))
 	{
 		return true;
 	}
@@ -1146,6 +1950,8 @@ static bool handle_set_ipv4_command(LSHandle *sh, LSMessage *message,
 	           gatewayObj = {0};
 	ipv4info_t ipv4 = {0};
 	gchar *ssid = NULL;
+	gboolean has_fingerprint = FALSE;
+	guint64 fingerprint = 0;
 
 	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("method"), &methodObj))
 	{
@@ -1197,6 +2003,34 @@ static bool handle_set_ipv4_command(LSHandle *sh, LSMessage *message,
 		jstring_free_buffer(ssid_buf);
 	}
 
+	if (!get_fingerprint_param(parsedObj, &has_fingerprint, &fingerprint))
+	{
+		goto invalid_params;
+	}
+
+	if (has_fingerprint)
+	{
+		if (!g_strcmp0(ipv4.method, "manual"))
+		{
+			if (ipv4.address == NULL || ipv4.netmask == NULL || ipv4.gateway == NULL)
+			{
+				LSMessageReplyCustomError(sh, message,
+				                          "Address, netmask as well as gateway should be specified for fingerprinted networks",
+				                          WCA_API_ERROR_INVALID_PARAMETERS);
+				goto exit;
+			}
+		}
+		else if (g_strcmp0(ipv4.method, "dhcp"))
+		{
+			goto invalid_params;
+		}
+
+		network_binding_set_ipv4(fingerprint, &ipv4);
+		update_network_binding(fingerprint);
+		LSMessageReplySuccess(sh, message);
+		goto exit;
+	}
+
 	connman_service_t *service = retrieve_service_by_ssid(ssid);
 
 	if (NULL != service)
@@ -1272,6 +2106,43 @@ exit:
 	return true;
 }
 
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_setipv6 setipv6
+
+Modify the parameters of an IPv6 connection (wired or WIFI)
+
+If an SSID field is not provided in the request, the modifications are
+applied to the wired connection.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+"method" | yes | String | "auto", "manual" or "off"
+"address" | no | String | If specified, sets a new IP address (only when method is "manual")
+"prefixLength" | no | Integer | If specified, sets a new prefix length (only when method is "manual")
+"gateway" | no | String | If specified, sets a new gateway IP address (only when method is "manual")
+"ssid" | no | String | Select the wifi connection to modify. If absent, the wired connection is changed.
+"privacy" | no | Boolean | Use temporary addresses (privacy extensions, RFC 4941) along with the stable one. Only applied to networks in range.
+"preferStableAddress" | no | Boolean | With privacy, keep using the stable address for new connections instead of the newest temporary one. Only applied to networks in range.
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when operation was successfull. False otherwise.
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
 static bool handle_set_ipv6_command(LSHandle *sh, LSMessage *message,
                                     void *context)
 {
@@ -1283,18 +2154,21 @@ static bool handle_set_ipv6_command(LSHandle *sh, LSMessage *message,
 	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_5(PROP(method, string), PROP(address,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_7(PROP(method, string), PROP(address,
 	                                     string),
 	                                     PROP(prefixLength, integer), PROP(gateway, string), PROP(ssid,
-	                                             string)) REQUIRED_1(method))), &parsedObj))
+	                                             string), PROP(privacy, boolean),
+	                                     PROP(preferStableAddress, boolean)) REQUIRED_1(method))), &parsedObj))
 	{
 		return true;
 	}
 
 	jvalue_ref ssidObj = {0}, methodObj = {0}, addressObj = {0}, prefixLengthObj = {0},
-	           gatewayObj = {0};
+	           gatewayObj = {0}, privacyObj = {0}, preferStableObj = {0};
 	ipv6info_t ipv6 = {0};
 	gchar *ssid = NULL;
+	gboolean has_privacy, has_prefer_stable;
+	bool privacy = false, prefer_stable = false;
 
 	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("method"), &methodObj))
 	{
@@ -1342,8 +2216,35 @@ static bool handle_set_ipv6_command(LSHandle *sh, LSMessage *message,
 		jstring_free_buffer(ssid_buf);
 	}
 
+	has_privacy = jobject_get_exists(parsedObj, J_CSTR_TO_BUF("privacy"),
+	                                 &privacyObj);
+	has_prefer_stable = jobject_get_exists(parsedObj,
+	                                       J_CSTR_TO_BUF("preferStableAddress"), &preferStableObj);
+
+	if (has_privacy)
+	{
+		jboolean_get(privacyObj, &privacy);
+	}
+
+	if (has_prefer_stable)
+	{
+		jboolean_get(preferStableObj, &prefer_stable);
+	}
+
 	connman_service_t *service = retrieve_service_by_ssid(ssid);
 
+	if (NULL != service && (has_privacy || has_prefer_stable))
+	{
+		gboolean current_privacy = FALSE, current_prefer_stable = TRUE;
+
+		/* Whatever isn't given is kept as it is */
+		ipv6_privacy_from_connman(service->ipinfo.ipv6.privacy, &current_privacy,
+		                          &current_prefer_stable);
+		ipv6.privacy = g_strdup(ipv6_privacy_to_connman(
+		                            has_privacy ? privacy : current_privacy,
+		                            has_prefer_stable ? prefer_stable : current_prefer_stable));
+	}
+
 	if (NULL != service)
 	{
 		if (connman_service_set_ipv6(service, &ipv6))
@@ -1412,6 +2313,7 @@ exit:
 	g_free(ipv6.method);
 	g_free(ipv6.address);
 	g_free(ipv6.gateway);
+	g_free(ipv6.privacy);
 	g_free(ssid);
 	j_release(&parsedObj);
 	return true;
@@ -1434,6 +2336,7 @@ Name | Required | Type | Description
 -----|--------|------|----------
 dns | yes | Array of String | Each string provides the IP address of a dns server
 ssid | no | String | SSID of wifi connection to be modified.
+fingerprint | no | String | Bind the DNS servers to the network with this fingerprint (see getstatus) instead of changing a connection. They are applied whenever the network is connected.
 
 @par Returns(Call)
 
@@ -1460,8 +2363,8 @@ static bool handle_set_dns_command(LSHandle *sh, LSMessage *message,
 	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_2(ARRAY(dns, string), PROP(ssid,
-	                                     string)) REQUIRED_1(dns))), &parsedObj))
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_3(ARRAY(dns, string), PROP(ssid,
+	                                     string), PROP(fingerprint, string)) REQUIRED_1(dns))), &parsedObj))
 	{
 		return true;
 	}
@@ -1469,6 +2372,8 @@ static bool handle_set_dns_command(LSHandle *sh, LSMessage *message,
 	jvalue_ref ssidObj = {0}, dnsObj = {0};
 	GStrv dns = NULL;
 	gchar *ssid = NULL;
+	gboolean has_fingerprint = FALSE;
+	guint64 fingerprint = 0;
 
 	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("dns"), &dnsObj))
 	{
@@ -1497,6 +2402,19 @@ static bool handle_set_dns_command(LSHandle *sh, LSMessage *message,
 		jstring_free_buffer(ssid_buf);
 	}
 
+	if (!get_fingerprint_param(parsedObj, &has_fingerprint, &fingerprint))
+	{
+		goto invalid_params;
+	}
+
+	if (has_fingerprint)
+	{
+		network_binding_set_dns(fingerprint, dns);
+		update_network_binding(fingerprint);
+		LSMessageReplySuccess(sh, message);
+		goto exit;
+	}
+
 	connman_service_t *service = retrieve_service_by_ssid(ssid);
 
 	if (NULL != service)
@@ -1906,9 +2824,6 @@ cleanup:
 	return true;
 }
 
-/* Blocking getstatus response for 1 sec for getting internet status*/
-#define INTERNET_STATUS_TIMEOUT 1
-
 /**
  * @brief Callback called after the delay set for getting internet status
  * for connected services. We have to make sure we send out a new status
@@ -1921,61 +2836,276 @@ static gboolean send_updated_internet_status(gpointer data)
 	return FALSE;
 }
 
-//->Start of API documentation comment block
 /**
-@page com_webos_connectionmanager com.webos.connectionmanager
-@{
-@section com_webos_connectionmanager_checkinternetstatus checkinternetstatus
-
-Triggers online check for all connected interfaces.
+ * @brief Callback called once the gateway probe of a connected service finished.
+ * A dead gateway means the online check can't succeed, so the blocked status
+ * is sent out right away instead of waiting for it.
+ */
+static void gateway_probe_done(gateway_probe_state_t state,
+                               const guint8 *gateway_mac, gpointer user_data)
+{
+	connman_service_t *service = (connman_service_t *) user_data;
 
-@par Parameters
+	service->gateway_probe = NULL;
 
-None
+	if (NULL != gateway_mac && !service->has_fingerprint)
+	{
+		update_network_fingerprint(service, gateway_mac);
+	}
 
-@par Returns(Call)
+	WCALOG_INFO(MSGID_CM_GATEWAY_PROBE_INFO, 0, "Gateway of service %s reachable : %s",
+	            service->path, gateway_probe_state_to_string(state));
 
-Name | Required | Type | Description
------|--------|------|----------
-returnValue | yes | Boolean | True
+	if (service->gateway_state != state)
+	{
+		service->gateway_state = state;
+		connman_service_set_changed(service, CONNMAN_SERVICE_CHANGE_CATEGORY_GETSTATUS);
+	}
 
-@par Returns(Subscription)
+	if (state != GATEWAY_PROBE_STATE_UNREACHABLE)
+	{
+		return;
+	}
 
-Not applicable.
+	if (block_getstatus_response)
+	{
+		g_source_remove(block_getstatus_response);
+		block_getstatus_response = 0;
+	}
 
-@}
-*/
-//->End of API documentation comment block
+	connectionmanager_send_status_to_subscribers();
+}
 
-static bool handle_check_internet_status_command(LSHandle *sh,
-        LSMessage *message, void *context)
+/**
+ * @brief Probe the gateway of a connected service with ARP / NDP
+ */
+static void start_gateway_probe(connman_service_t *service)
 {
-	LSError lserror;
-	LSErrorInit(&lserror);
-	gboolean wired_status = TRUE, wifi_status = TRUE;
-
-	if (block_getstatus_response)
+	if (NULL != service->gateway_probe)
 	{
-		goto exit;
+		return;
 	}
 
-	if (!connman_status_check(manager, sh, message))
-		return true;
+	connman_service_get_ipinfo(service);
 
-	connman_service_t *connected_wired_service =
-	    connman_manager_get_connected_service(manager->wired_services);
+	service->gateway_probe = gateway_probe_start(service->ipinfo.iface,
+	                         service->ipinfo.ipv4.address, service->ipinfo.ipv4.gateway,
+	                         service->ipinfo.ipv6.gateway,
+	                         runtime_param_get(RUNTIME_PARAM_GATEWAY_PROBE_TIMEOUT),
+	                         gateway_probe_done, service);
 
-	if (connected_wired_service)
+	if (NULL == service->gateway_probe)
 	{
-		wired_status = connman_service_set_run_online_check(connected_wired_service,
-		               TRUE);
+		WCALOG_DEBUG("No gateway probe started for service %s", service->path);
 	}
+}
 
-	connman_service_t *connected_wifi_service =
-	    connman_manager_get_connected_service(manager->wifi_services);
-
-	if (connected_wifi_service)
+/**
+ * @brief Callback called once the nameservers of a connected service were
+ * probed. Moves a server to the front once it answered clearly faster than
+ * the first one for a few probes in a row. Static servers stay static in the
+ * new order, the order of the network's servers only holds for this link.
+ */
+static void dns_probe_done(GStrv servers, const gint *latencies,
+                           gpointer user_data)
+{
+	connman_service_t *service = (connman_service_t *) user_data;
+	guint timeout_ms = runtime_param_get(RUNTIME_PARAM_DNS_PROBE_TIMEOUT);
+	GStrv order;
+	gboolean changed;
+	guint i;
+
+	service->dns_probe = NULL;
+
+	for (i = 0; NULL != servers[i]; i++)
+	{
+		dns_server_health_t *health = dns_probe_health_find(service->dns_health,
+		                              servers[i]);
+
+		if (NULL != health)
+		{
+			dns_probe_health_add_sample(health, latencies[i]);
+		}
+	}
+
+	order = dns_probe_health_reorder(service->dns_health, timeout_ms);
+
+	if (NULL == order)
+	{
+		return;
+	}
+
+	if (NULL != service->dns_config && NULL != service->dns_config[0] &&
+	        !service->dns_config_reordered)
+	{
+		for (i = 0; NULL != order[i]; i++)
+		{
+			/* Only the static servers are used while there are any */
+			if (!g_strv_contains((const gchar * const *) service->dns_config, order[i]))
+			{
+				g_strfreev(order);
+				return;
+			}
+		}
+
+		changed = connman_service_set_nameservers(service, order);
+	}
+	else
+	{
+		changed = connman_service_set_reordered_nameservers(service, order);
+	}
+
+	if (changed)
+	{
+		WCALOG_INFO(MSGID_CM_DNS_PROBE_INFO, 0, "Moved nameserver %s of service %s first",
+		            order[0], service->path);
+		service->dns_health = dns_probe_health_sync(service->dns_health, order);
+		connman_service_set_changed(service, CONNMAN_SERVICE_CHANGE_CATEGORY_GETSTATUS);
+	}
+
+	g_strfreev(order);
+}
+
+/**
+ * @brief Probe the nameservers of a connected service
+ */
+static void start_dns_probe(connman_service_t *service)
+{
+	if (NULL != service->dns_probe)
+	{
+		return;
+	}
+
+	connman_service_get_ipinfo(service);
+
+	service->dns_health = dns_probe_health_sync(service->dns_health,
+	                      service->ipinfo.dns);
+	service->dns_probe = dns_probe_start(service->ipinfo.iface,
+	                                     service->ipinfo.dns, DNS_PROBE_PORT,
+	                                     runtime_param_get(RUNTIME_PARAM_DNS_PROBE_TIMEOUT),
+	                                     dns_probe_done, service);
+
+	if (NULL == service->dns_probe)
+	{
+		WCALOG_DEBUG("No DNS probe started for service %s", service->path);
+	}
+}
+
+/**
+ * @brief Probe the nameservers of the connected wired and wifi services
+ * every dnsProbeInterval seconds
+ */
+static gboolean dns_probe_timeout_cb(gpointer user_data)
+{
+	connman_service_t *service;
+
+	if (NULL != manager)
+	{
+		service = connman_manager_get_connected_service(manager->wired_services);
+
+		if (NULL != service)
+		{
+			start_dns_probe(service);
+		}
+
+		service = connman_manager_get_connected_service(manager->wifi_services);
+
+		if (NULL != service)
+		{
+			start_dns_probe(service);
+		}
+	}
+
+	/* Rescheduled each time to pick up changes of the interval */
+	schedule_dns_probe();
+
+	return FALSE;
+}
+
+static void schedule_dns_probe(void)
+{
+	g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_DNS_PROBE_INTERVAL),
+	                      dns_probe_timeout_cb, NULL);
+}
+
+/**
+ * @brief Called when a service reached the ready state to fingerprint its network.
+ * The fingerprint needs the hardware address of the gateway which is taken
+ * from the answer to the gateway probe, so it doesn't delay the connection.
+ */
+void connectionmanager_service_ready(connman_service_t *service)
+{
+	if (NULL == service || (!connman_service_type_wifi(service) &&
+	                        !connman_service_type_ethernet(service)))
+	{
+		return;
+	}
+
+	start_gateway_probe(service);
+	start_dns_probe(service);
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_checkinternetstatus checkinternetstatus
+
+Triggers online check for all connected interfaces.
+
+Before the online check the gateway of each connected interface is probed
+with ARP / NDP. If it doesn't answer within 100 ms the interface is reported
+offline right away.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_check_internet_status_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	LSError lserror;
+	LSErrorInit(&lserror);
+	gboolean wired_status = TRUE, wifi_status = TRUE;
+
+	if (block_getstatus_response)
+	{
+		goto exit;
+	}
+
+	if (!connman_status_check(manager, sh, message))
+		return true;
+
+	connman_service_t *connected_wired_service =
+	    connman_manager_get_connected_service(manager->wired_services);
+
+	if (connected_wired_service)
+	{
+		start_gateway_probe(connected_wired_service);
+		wired_status = connman_service_set_run_online_check(connected_wired_service,
+		               TRUE);
+	}
+
+	connman_service_t *connected_wifi_service =
+	    connman_manager_get_connected_service(manager->wifi_services);
+
+	if (connected_wifi_service)
 	{
+		start_gateway_probe(connected_wifi_service);
 		wifi_status = connman_service_set_run_online_check(connected_wifi_service,
 		              TRUE);
 	}
@@ -1990,8 +3120,10 @@ static bool handle_check_internet_status_command(LSHandle *sh,
 
 	if (wired_status == TRUE || wifi_status == TRUE)
 	{
-		block_getstatus_response = g_timeout_add_seconds(INTERNET_STATUS_TIMEOUT,
-		                           send_updated_internet_status, NULL);
+		/* Block the getstatus response while the internet status is checked */
+		block_getstatus_response = g_timeout_add_seconds(
+		                               runtime_param_get(RUNTIME_PARAM_INTERNET_STATUS_TIMEOUT),
+		                               send_updated_internet_status, NULL);
 	}
 
 	if (!wired_status && !wifi_status)
@@ -2069,6 +3201,12 @@ static void increment_counter_statistics(connman_service_t *service,
 
 	connman_counter_parse_counter_data(home, &counter_data);
 
+	/* Connman only reports the values which changed */
+	if (CONNMAN_SERVICE_TYPE_WIFI == type)
+	{
+		connman_counter_parse_counter_data(home, &wifi_counter_totals);
+	}
+
 	counter_data_new[type].rx_bytes += counter_data.rx_bytes;
 	counter_data_new[type].tx_bytes += counter_data.tx_bytes;
 	counter_data_new[type].rx_packet += counter_data.rx_packet;
@@ -2202,6 +3340,47 @@ static void disable_counter(void)
 
 }
 
+static gboolean apply_wifi_power_save(gboolean enabled)
+{
+	GError *error = NULL;
+
+	if (!nl80211_set_power_save(CONNMAN_WIFI_INTERFACE_NAME, enabled, &error))
+	{
+		WCALOG_ERROR(MSGID_CM_POWER_SAVE_ERROR, 0, "Failed to %s power save: %s",
+		             enabled ? "enable" : "disable", error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	WCALOG_INFO(MSGID_CM_POWER_SAVE_INFO, 0, "Power save %s",
+	            enabled ? "enabled" : "disabled");
+	return TRUE;
+}
+
+static void sample_wifi_power_save(void)
+{
+	if (POWER_SAVE_MODE_ADAPTIVE != power_save_mode)
+	{
+		return;
+	}
+
+	/* Pick up changed runtime parameters */
+	power_save_policy.busy_byte_rate = runtime_param_get(
+	                                       RUNTIME_PARAM_POWER_SAVE_BUSY_BYTE_RATE) * 1000;
+	power_save_policy.busy_packet_rate = runtime_param_get(
+	        RUNTIME_PARAM_POWER_SAVE_BUSY_PACKET_RATE);
+	power_save_policy.idle_hold_ms = runtime_param_get(
+	                                     RUNTIME_PARAM_POWER_SAVE_IDLE_HOLD) * 1000;
+
+	if (power_save_policy_update(&power_save_policy,
+	                             (guint64) wifi_counter_totals.rx_bytes + wifi_counter_totals.tx_bytes,
+	                             (guint64) wifi_counter_totals.rx_packet + wifi_counter_totals.tx_packet,
+	                             g_get_monotonic_time() / 1000))
+	{
+		apply_wifi_power_save(power_save_policy.enabled);
+	}
+}
+
 static gboolean notify_counter_statistics(void)
 {
 	if (counter->timer->timeout == 0)
@@ -2209,9 +3388,19 @@ static gboolean notify_counter_statistics(void)
 		return FALSE;
 	}
 
+	sample_wifi_power_save();
+
 	if (LSSubscriptionGetHandleSubscribersCount(pLsHandle,
 	        LUNA_CATEGORY_ROOT LUNA_METHOD_MONITORACTIVITY) == 0)
 	{
+		/* Adaptive power save keeps the counter running */
+		if (POWER_SAVE_MODE_ADAPTIVE == power_save_mode)
+		{
+			memcpy(counter_data_old, counter_data_new, sizeof(counter_data_old));
+			memset(counter_data_new, 0, sizeof(counter_data_new));
+			return TRUE;
+		}
+
 		disable_counter();
 		return FALSE;
 	}
@@ -2245,6 +3434,24 @@ static gboolean notify_counter_statistics(void)
 	return true;
 }
 
+static gboolean enable_counter(void)
+{
+	if (NULL != counter)
+	{
+		return TRUE;
+	}
+
+	counter = connman_counter_new(notify_counter_statistics);
+
+	if (NULL == counter)
+	{
+		return FALSE;
+	}
+
+	connman_counter_set_registered_callback(counter, counter_registered_callback,
+	                                        NULL);
+	return TRUE;
+}
 
 static bool handle_monitor_activity_command(LSHandle *sh, LSMessage *message,
         void *context)
@@ -2292,19 +3499,11 @@ static bool handle_monitor_activity_command(LSHandle *sh, LSMessage *message,
 		goto cleanup;
 	}
 
-	if (NULL == counter)
+	if (!enable_counter())
 	{
-		counter = connman_counter_new(notify_counter_statistics);
-
-		if (NULL == counter)
-		{
-			LSMessageReplyCustomError(sh, message, "Error in setting counter",
-			                          WCA_API_ERROR_COUNTER);
-			goto cleanup;
-		}
-
-		connman_counter_set_registered_callback(counter, counter_registered_callback,
-		                                        NULL);
+		LSMessageReplyCustomError(sh, message, "Error in setting counter",
+		                          WCA_API_ERROR_COUNTER);
+		goto cleanup;
 	}
 
 	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
@@ -2570,8 +3769,9 @@ static bool handle_set_proxy_command(LSHandle *sh,
 	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_5(PROP(method, string), PROP(url,
-	                                     string), ARRAY(servers, string), ARRAY(excludes, string), PROP(ssid, string)) REQUIRED_1(method))), &parsedObj))
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_6(PROP(method, string), PROP(url,
+	                                     string), ARRAY(servers, string), ARRAY(excludes, string), PROP(ssid, string),
+	                                     PROP(fingerprint, string)) REQUIRED_1(method))), &parsedObj))
 	{
 		return true;
 	}
@@ -2579,6 +3779,8 @@ static bool handle_set_proxy_command(LSHandle *sh,
 	jvalue_ref ssidObj = {0}, methodObj = {0}, urlObj = {0}, serversObj = {0}, excludesObj = {0};
 	proxyinfo_t proxyinfo = {0};
 	gchar *ssid = NULL;
+	gboolean has_fingerprint = FALSE;
+	guint64 fingerprint = 0;
 
 	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("method"), &methodObj))
 	{
@@ -2637,6 +3839,19 @@ static bool handle_set_proxy_command(LSHandle *sh,
 			goto invalid_params;
 	}
 
+	if (!get_fingerprint_param(parsedObj, &has_fingerprint, &fingerprint))
+	{
+		goto invalid_params;
+	}
+
+	if (has_fingerprint)
+	{
+		network_binding_set_proxy(fingerprint, &proxyinfo);
+		update_network_binding(fingerprint);
+		LSMessageReplySuccess(sh, message);
+		goto exit;
+	}
+
 	connman_service_t *service = retrieve_service_by_ssid(ssid);
 
 	if (NULL != service)
@@ -2749,68 +3964,1617 @@ cleanup:
 	return true;
 }
 
-/**
- * @brief com.webos.service.connectionmanager service method table
- */
-
-static LSMethod connectionmanager_methods[] =
+static void add_strv(jvalue_ref *object, const char *key, GStrv strv)
 {
-	{ LUNA_METHOD_GETSTATUS,            handle_get_status_command },
-	{ LUNA_METHOD_GETSTATUS2,           handle_get_status_command },
-	{ LUNA_METHOD_SETIPV4,              handle_set_ipv4_command },
-	{ LUNA_METHOD_SETDNS,               handle_set_dns_command },
-	{ LUNA_METHOD_SETSTATE,             handle_set_state_command },
-	{ LUNA_METHOD_GETINFO,              handle_get_info_command },
-	{ LUNA_METHOD_SETIPV6,              handle_set_ipv6_command },
-	{ LUNA_METHOD_MONITORACTIVITY,      handle_monitor_activity_command },
-	{ LUNA_METHOD_SETTECHNOLOGYSTATE,   handle_set_technology_state_command },
-	{ LUNA_METHOD_SETETHERNETTETHERING, handle_set_ethernet_tethering_command },
-	{ LUNA_METHOD_SETPROXY,             handle_set_proxy_command },
-	{ LUNA_METHOD_FINDPROXYFORURL,      handle_find_proxy_for_url_command },
-	{ },
-};
+	jvalue_ref array = jarray_create(NULL);
+	gsize i;
 
-/**
- *  @brief Initialize the com.webos.service.connectionmanager service and register all provided
- *  service method on the luna service bus.
- *
- *  @param mainloop Reference to the used glib mainloop object
- *  @return 0 if service is initialized successfull. -1 otherwise.
- */
+	for (i = 0; i < g_strv_length(strv); i++)
+	{
+		jarray_append(array, jstring_create(strv[i]));
+	}
 
-int initialize_connectionmanager_ls2_calls(GMainLoop *mainloop,
-        LSHandle **cm_handle)
+	jobject_put(*object, jstring_create(key), array);
+}
+
+static void add_network_binding(jvalue_ref *binding_j,
+                                network_binding_t *binding)
 {
-	LSError lserror;
-	LSErrorInit(&lserror);
-	pLsHandle = NULL;
+	gchar *fingerprint = network_fingerprint_to_string(binding->fingerprint);
+	jobject_put(*binding_j, J_CSTR_TO_JVAL("fingerprint"),
+	            jstring_create(fingerprint));
+	g_free(fingerprint);
 
-	if (!mainloop)
+	if (NULL != binding->ipv4.method)
 	{
-		goto exit;
-	}
+		jvalue_ref ipv4_j = jobject_create();
 
-	if (!LSRegister(CONNECTIONMANAGER_LUNA_SERVICE_NAME, &pLsHandle, &lserror))
-	{
-		WCALOG_ESCAPED_ERRMSG(MSGID_CM_LUNA_BUS_ERROR, lserror.message);
-		goto exit;
+		jobject_put(ipv4_j, J_CSTR_TO_JVAL("method"),
+		            jstring_create(binding->ipv4.method));
+
+		if (NULL != binding->ipv4.address)
+		{
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("address"),
+			            jstring_create(binding->ipv4.address));
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("netmask"),
+			            jstring_create(binding->ipv4.netmask));
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("gateway"),
+			            jstring_create(binding->ipv4.gateway));
+		}
+
+		jobject_put(*binding_j, J_CSTR_TO_JVAL("ipv4"), ipv4_j);
 	}
 
-	if (!LSRegisterCategory(pLsHandle, LUNA_CATEGORY_ROOT,
-	                        connectionmanager_methods,
-	                        NULL, NULL, &lserror))
+	if (NULL != binding->dns)
 	{
-		WCALOG_ESCAPED_ERRMSG(MSGID_CM_METHODS_LUNA_ERROR, lserror.message);
-		goto exit;
+		add_strv(binding_j, "dns", binding->dns);
 	}
 
-	if (!LSGmainAttach(pLsHandle, mainloop, &lserror))
+	if (NULL != binding->proxy.method)
 	{
-		WCALOG_ESCAPED_ERRMSG(MSGID_CM_GLOOP_ATTACH_ERROR, lserror.message);
-		goto exit;
+		jvalue_ref proxy_j = jobject_create();
+
+		jobject_put(proxy_j, J_CSTR_TO_JVAL("method"),
+		            jstring_create(binding->proxy.method));
+
+		if (NULL != binding->proxy.url)
+		{
+			jobject_put(proxy_j, J_CSTR_TO_JVAL("url"),
+			            jstring_create(binding->proxy.url));
+		}
+
+		if (NULL != binding->proxy.servers)
+		{
+			add_strv(&proxy_j, "servers", binding->proxy.servers);
+		}
+
+		if (NULL != binding->proxy.excludes)
+		{
+			add_strv(&proxy_j, "excludes", binding->proxy.excludes);
+		}
+
+		jobject_put(*binding_j, J_CSTR_TO_JVAL("proxy"), proxy_j);
 	}
+}
 
-	*cm_handle = pLsHandle;
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_getnetworkbindings getNetworkBindings
+
+Lists the settings bound to network fingerprints with setipv4, setdns and setProxy.
+Bound settings stay applied while the SSID and gateway of the network stay
+the same, even if access points of another vendor change its fingerprint.
+Once the network differs, only the settings the binding wrote are put back to
+what they were before, and only while nobody changed them since.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+bindings | yes | Array of Object | Each object holds "fingerprint" and the bound "ipv4", "dns" and "proxy" settings
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_network_bindings_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref bindings_j = jarray_create(NULL);
+	GList *bindings = network_binding_get_all();
+	GList *iter;
+
+	for (iter = bindings; iter; iter = iter->next)
+	{
+		jvalue_ref binding_j = jobject_create();
+		add_network_binding(&binding_j, (network_binding_t *) iter->data);
+		jarray_append(bindings_j, binding_j);
+	}
+
+	g_list_free(bindings);
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("bindings"), bindings_j);
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_deletenetworkbinding deleteNetworkBinding
+
+Removes all settings bound to a network fingerprint. Settings already applied
+to the network stay in place until it is connected the next time.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+fingerprint | yes | String | Fingerprint of the network
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the binding was removed. False otherwise.
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_delete_network_binding_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(fingerprint,
+	                                     string)) REQUIRED_1(fingerprint))), &parsedObj))
+	{
+		return true;
+	}
+
+	gboolean has_fingerprint = FALSE;
+	guint64 fingerprint = 0;
+
+	if (!get_fingerprint_param(parsedObj, &has_fingerprint, &fingerprint))
+	{
+		LSMessageReplyErrorInvalidParams(sh, message);
+		goto cleanup;
+	}
+
+	if (!network_binding_remove(fingerprint))
+	{
+		LSMessageReplyCustomError(sh, message, "No settings bound to fingerprint",
+		                          WCA_API_ERROR_NETWORK_BINDING_NOT_FOUND);
+		goto cleanup;
+	}
+
+	store_wifi_setting(WIFI_NETWORK_BINDINGS_SETTING, NULL);
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+static jvalue_ref p2p_latency_to_json(const p2p_connect_latency_t *latency)
+{
+	jvalue_ref latency_j = jobject_create();
+
+	jobject_put(latency_j, J_CSTR_TO_JVAL("count"),
+	            jnumber_create_i32(latency->count));
+
+	if (latency->count > 0)
+	{
+		jobject_put(latency_j, J_CSTR_TO_JVAL("lastMs"),
+		            jnumber_create_i64(latency->last_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("minMs"),
+		            jnumber_create_i64(latency->min_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("maxMs"),
+		            jnumber_create_i64(latency->max_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("averageMs"),
+		            jnumber_create_i64(latency->total_ms / latency->count));
+	}
+
+	return latency_j;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_getp2pgroupcache getP2PGroupCache
+
+Lists the persistent Wi-Fi Direct groups formed with peers before, along with
+the connect latency of peers which connected after being invited into their
+cached group and of all other connects, which went through group negotiation.
+While persistent mode is enabled, a known peer is invited into its group again
+as soon as it reappears and no other group is running. A group we still own is
+joined. Otherwise wpa_supplicant re-invokes the stored group: a group we owned
+is started again on its cached frequency and the peer is invited into it, a
+group we were a client of is re-invoked by inviting the peer.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+groups | yes | Array of Object | Most recently used first. Each object holds "peerAddress", "role" ("owner" or "client"), "frequency" (MHz, 0 if unknown), "groupName" and "lastUsed" (seconds since the epoch)
+latency | yes | Object | Holds "cached" and "negotiated" objects with "count" and, once a peer connected, "lastMs", "minMs", "maxMs" and "averageMs" from association to ready
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_p2p_group_cache_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref groups_j = jarray_create(NULL);
+	jvalue_ref latency_j = jobject_create();
+	const GList *iter;
+
+	for (iter = p2p_group_cache_get_groups(); iter; iter = iter->next)
+	{
+		const p2p_cached_group_t *group = iter->data;
+		jvalue_ref group_j = jobject_create();
+
+		jobject_put(group_j, J_CSTR_TO_JVAL("peerAddress"),
+		            jstring_create(group->peer_address));
+		jobject_put(group_j, J_CSTR_TO_JVAL("role"),
+		            jstring_create(p2p_group_role_to_string(group->role)));
+		jobject_put(group_j, J_CSTR_TO_JVAL("frequency"),
+		            jnumber_create_i32(group->freq));
+		jobject_put(group_j, J_CSTR_TO_JVAL("groupName"),
+		            jstring_create(NULL != group->group_name ? group->group_name : ""));
+		jobject_put(group_j, J_CSTR_TO_JVAL("lastUsed"),
+		            jnumber_create_i64(group->last_used));
+		jarray_append(groups_j, group_j);
+	}
+
+	jobject_put(latency_j, J_CSTR_TO_JVAL("cached"),
+	            p2p_latency_to_json(p2p_group_cache_get_latency(TRUE)));
+	jobject_put(latency_j, J_CSTR_TO_JVAL("negotiated"),
+	            p2p_latency_to_json(p2p_group_cache_get_latency(FALSE)));
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("groups"), groups_j);
+	jobject_put(reply, J_CSTR_TO_JVAL("latency"), latency_j);
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_deletep2pgroupcache deleteP2PGroupCache
+
+Forgets the persistent group formed with a peer, so it isn't invited again
+when it reappears. The credentials stay with the supplicant.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+peerAddress | yes | String | Device address of the peer
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the group was forgotten. False otherwise.
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_delete_p2p_group_cache_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+	jvalue_ref peerAddressObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(peerAddress,
+	                                     string)) REQUIRED_1(peerAddress))), &parsedObj))
+	{
+		return true;
+	}
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("peerAddress"), &peerAddressObj);
+	raw_buffer address_buf = jstring_get(peerAddressObj);
+	gboolean removed = p2p_group_cache_remove(address_buf.m_str);
+	jstring_free_buffer(address_buf);
+
+	if (!removed)
+	{
+		LSMessageReplyCustomError(sh, message, "No group cached for peer",
+		                          WCA_API_ERROR_P2P_GROUP_NOT_CACHED);
+		goto cleanup;
+	}
+
+	store_wifi_setting(WIFI_P2P_GROUP_CACHE_SETTING, NULL);
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_runselftest runSelfTest
+
+Measures the throughput and round trip time actually achieved against an
+endpoint, to tell a slow link from a slow service. The endpoint runs the
+classic test services: the download reads from chargen, the upload writes to
+discard and the latency test sends UDP datagrams to echo. The parts run one
+after the other (latency, download, upload) in a thread of their own, and the
+call is answered once all of them are done. Only one test runs at a time, it is
+stopped when the caller cancels the call or goes away.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+host | yes | String | Address or host name of the endpoint
+interface | no | String | Network interface to test, e.g. "wlan0". The routing decides if absent.
+downloadPort | no | Integer | TCP chargen port, 19 by default, 0 skips the download
+uploadPort | no | Integer | TCP discard port, 9 by default, 0 skips the upload
+latencyPort | no | Integer | UDP echo port, 7 by default, 0 skips the latency test
+duration | no | Integer | Seconds the download and the upload run for each, 1 to 30, 5 by default
+maxBytes | no | Integer | Bytes moved in each direction at most, 64 MiB by default
+latencyProbes | no | Integer | Number of echo probes sent 100 ms apart, 1 to 100, 20 by default
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the test ran. False otherwise.
+download | no | Object | Result of the download, see below
+upload | no | Object | Result of the upload, see below
+latency | no | Object | Holds "sent", "received" and, in ms, "minRtt", "averageRtt", "medianRtt", "maxRtt" and "jitter" (mean difference of consecutive round trips)
+
+@par "download" and "upload" Objects
+
+Name | Required | Type | Description
+-----|--------|------|----------
+bytes | yes | Integer | Bytes moved, for the upload the ones the endpoint acknowledged
+durationMs | yes | Integer | Time the transfer took
+averageKbps | yes | Number | Average throughput in kbit/s
+p10Kbps | yes | Number | 10th percentile of the throughput in 100 ms windows
+medianKbps | yes | Number | Median of the throughput in 100 ms windows
+p90Kbps | yes | Number | 90th percentile of the throughput in 100 ms windows
+samples | yes | Integer | Number of windows
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static jvalue_ref self_test_throughput_to_json(const self_test_throughput_t
+        *throughput)
+{
+	jvalue_ref throughput_j = jobject_create();
+
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("bytes"),
+	            jnumber_create_i64(throughput->bytes));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("durationMs"),
+	            jnumber_create_i64(throughput->duration_ms));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("averageKbps"),
+	            jnumber_create_f64(throughput->average_kbps));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("p10Kbps"),
+	            jnumber_create_f64(throughput->p10_kbps));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("medianKbps"),
+	            jnumber_create_f64(throughput->median_kbps));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("p90Kbps"),
+	            jnumber_create_f64(throughput->p90_kbps));
+	jobject_put(throughput_j, J_CSTR_TO_JVAL("samples"),
+	            jnumber_create_i32(throughput->samples));
+
+	return throughput_j;
+}
+
+static jvalue_ref self_test_latency_to_json(const self_test_latency_t *latency)
+{
+	jvalue_ref latency_j = jobject_create();
+
+	jobject_put(latency_j, J_CSTR_TO_JVAL("sent"), jnumber_create_i32(latency->sent));
+	jobject_put(latency_j, J_CSTR_TO_JVAL("received"),
+	            jnumber_create_i32(latency->received));
+
+	if (latency->received > 0)
+	{
+		jobject_put(latency_j, J_CSTR_TO_JVAL("minRtt"),
+		            jnumber_create_f64(latency->min_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("averageRtt"),
+		            jnumber_create_f64(latency->average_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("medianRtt"),
+		            jnumber_create_f64(latency->median_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("maxRtt"),
+		            jnumber_create_f64(latency->max_ms));
+		jobject_put(latency_j, J_CSTR_TO_JVAL("jitter"),
+		            jnumber_create_f64(latency->jitter_ms));
+	}
+
+	return latency_j;
+}
+
+static void self_test_done(const self_test_result_t *result, gpointer user_data)
+{
+	luna_service_request_t *service_req = user_data;
+
+	running_self_test = NULL;
+	self_test_req = NULL;
+
+	if (NULL != result->error)
+	{
+		WCALOG_INFO(MSGID_CM_SELF_TEST_INFO, 0, "Self test failed: %s", result->error);
+		LSMessageReplyCustomError(service_req->handle, service_req->message,
+		                          result->error, WCA_API_ERROR_SELF_TEST_FAILED);
+		luna_service_request_free(service_req);
+		return;
+	}
+
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jvalue_ref reply = jobject_create();
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+
+	if (result->download.done)
+	{
+		jobject_put(reply, J_CSTR_TO_JVAL("download"),
+		            self_test_throughput_to_json(&result->download));
+	}
+
+	if (result->upload.done)
+	{
+		jobject_put(reply, J_CSTR_TO_JVAL("upload"),
+		            self_test_throughput_to_json(&result->upload));
+	}
+
+	if (result->latency.done)
+	{
+		jobject_put(reply, J_CSTR_TO_JVAL("latency"),
+		            self_test_latency_to_json(&result->latency));
+	}
+
+	WCALOG_INFO(MSGID_CM_SELF_TEST_INFO, 0,
+	            "Self test done: download %.0f kbit/s, upload %.0f kbit/s, rtt %.1f ms",
+	            result->download.average_kbps, result->upload.average_kbps,
+	            result->latency.median_ms);
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(service_req->handle, service_req->message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(service_req->handle, service_req->message,
+	                    jvalue_tostring(reply, response_schema), &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&reply);
+	luna_service_request_free(service_req);
+}
+
+static gboolean get_port_param(jvalue_ref parsedObj, const char *key,
+                               guint16 default_port, guint16 *port)
+{
+	jvalue_ref portObj = {0};
+	int value = default_port;
+
+	if (jobject_get_exists(parsedObj, j_cstr_to_buffer(key), &portObj))
+	{
+		jnumber_get_i32(portObj, &value);
+	}
+
+	if (value < 0 || value > G_MAXUINT16)
+	{
+		return FALSE;
+	}
+
+	*port = value;
+	return TRUE;
+}
+
+static bool handle_run_self_test_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref parsedObj = {0};
+	jvalue_ref hostObj = {0}, interfaceObj = {0}, durationObj = {0},
+	           maxBytesObj = {0}, latencyProbesObj = {0};
+	self_test_params_t params = { 0 };
+	luna_service_request_t *service_req;
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_8(PROP(host, string),
+	                                     PROP(interface, string), PROP(downloadPort, integer),
+	                                     PROP(uploadPort, integer), PROP(latencyPort, integer),
+	                                     PROP(duration, integer), PROP(maxBytes, integer),
+	                                     PROP(latencyProbes, integer)) REQUIRED_1(host))), &parsedObj))
+	{
+		return true;
+	}
+
+	if (NULL != running_self_test)
+	{
+		LSMessageReplyCustomError(sh, message, "A self test is already running",
+		                          WCA_API_ERROR_SELF_TEST_BUSY);
+		goto cleanup;
+	}
+
+	if (!get_port_param(parsedObj, "downloadPort", SELF_TEST_CHARGEN_PORT,
+	                    &params.download_port) ||
+	        !get_port_param(parsedObj, "uploadPort", SELF_TEST_DISCARD_PORT,
+	                        &params.upload_port) ||
+	        !get_port_param(parsedObj, "latencyPort", SELF_TEST_ECHO_PORT,
+	                        &params.latency_port) ||
+	        (0 == params.download_port && 0 == params.upload_port &&
+	         0 == params.latency_port))
+	{
+		goto invalid_params;
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("duration"), &durationObj))
+	{
+		int duration = 0;
+
+		jnumber_get_i32(durationObj, &duration);
+
+		if (duration < 1 || duration > SELF_TEST_MAX_DURATION_MS / 1000)
+		{
+			goto invalid_params;
+		}
+
+		params.duration_ms = duration * 1000;
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("maxBytes"), &maxBytesObj))
+	{
+		gint64 max_bytes = 0;
+
+		jnumber_get_i64(maxBytesObj, &max_bytes);
+
+		if (max_bytes < 1)
+		{
+			goto invalid_params;
+		}
+
+		params.max_bytes = max_bytes;
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("latencyProbes"),
+	                       &latencyProbesObj))
+	{
+		int probes = 0;
+
+		jnumber_get_i32(latencyProbesObj, &probes);
+
+		if (probes < 1 || probes > SELF_TEST_MAX_LATENCY_PROBES)
+		{
+			goto invalid_params;
+		}
+
+		params.latency_probes = probes;
+	}
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("host"), &hostObj);
+	raw_buffer host_buf = jstring_get(hostObj);
+	params.host = g_strdup(host_buf.m_str);
+	jstring_free_buffer(host_buf);
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("interface"), &interfaceObj))
+	{
+		raw_buffer interface_buf = jstring_get(interfaceObj);
+		params.iface = g_strdup(interface_buf.m_str);
+		jstring_free_buffer(interface_buf);
+	}
+
+	service_req = luna_service_request_new(sh, message);
+	running_self_test = self_test_start(&params, self_test_done, service_req);
+
+	if (NULL == running_self_test)
+	{
+		luna_service_request_free(service_req);
+		LSMessageReplyErrorUnknown(sh, message);
+	}
+	else
+	{
+		self_test_req = service_req;
+		WCALOG_INFO(MSGID_CM_SELF_TEST_INFO, 0, "Self test against %s started",
+		            params.host);
+	}
+
+	g_free(params.host);
+	g_free(params.iface);
+	goto cleanup;
+
+invalid_params:
+	LSMessageReplyErrorInvalidParams(sh, message);
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_cancelselftest cancelSelfTest
+
+Stops the running self test. The runSelfTest call is answered with an error
+right away.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when a test was stopped. False otherwise.
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_cancel_self_test_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	if (NULL == running_self_test)
+	{
+		LSMessageReplyCustomError(sh, message, "No self test running",
+		                          WCA_API_ERROR_SELF_TEST_NOT_RUNNING);
+		goto cleanup;
+	}
+
+	self_test_cancel(running_self_test);
+	running_self_test = NULL;
+
+	LSMessageReplyCustomError(self_test_req->handle, self_test_req->message,
+	                          "Self test cancelled", WCA_API_ERROR_SELF_TEST_CANCELLED);
+	luna_service_request_free(self_test_req);
+	self_test_req = NULL;
+
+	WCALOG_INFO(MSGID_CM_SELF_TEST_INFO, 0, "Self test cancelled");
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_getruntimeparameters getRuntimeParameters
+
+Lists the runtime tunable parameters (timers and thresholds) with their
+current values and the latest changes made to them, along with the deadlines
+of the D-Bus calls to connman and how often they were missed.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+parameters | yes | Array of Object | Each object holds "name", "value", "default", "min", "max" and "unit" of a parameter
+changes | yes | Array of Object | Latest changes, oldest first. Each object holds "time" (seconds since the epoch), "name", "oldValue", "newValue" and "source"
+dbusCalls | yes | Array of Object | Each object holds "name", "deadline" (ms), "calls", "timeouts" and "cancelled" of a kind of D-Bus call to connman
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_runtime_parameters_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref parameters_j = jarray_create(NULL);
+	jvalue_ref changes_j = jarray_create(NULL);
+	jvalue_ref dbus_calls_j = jarray_create(NULL);
+	runtime_param_t param;
+	dbus_call_t call;
+	GList *iter;
+
+	for (param = 0; param < RUNTIME_PARAM_LAST; param++)
+	{
+		jvalue_ref param_j = jobject_create();
+		guint default_value, min, max;
+
+		runtime_param_get_limits(param, &default_value, &min, &max);
+
+		jobject_put(param_j, J_CSTR_TO_JVAL("name"),
+		            jstring_create(runtime_param_get_name(param)));
+		jobject_put(param_j, J_CSTR_TO_JVAL("value"),
+		            jnumber_create_i32(runtime_param_get(param)));
+		jobject_put(param_j, J_CSTR_TO_JVAL("default"),
+		            jnumber_create_i32(default_value));
+		jobject_put(param_j, J_CSTR_TO_JVAL("min"), jnumber_create_i32(min));
+		jobject_put(param_j, J_CSTR_TO_JVAL("max"), jnumber_create_i32(max));
+		jobject_put(param_j, J_CSTR_TO_JVAL("unit"),
+		            jstring_create(runtime_param_get_unit(param)));
+
+		jarray_append(parameters_j, param_j);
+	}
+
+	for (iter = runtime_params_get_change_log(); iter; iter = iter->next)
+	{
+		runtime_param_change_t *change = iter->data;
+		jvalue_ref change_j = jobject_create();
+
+		jobject_put(change_j, J_CSTR_TO_JVAL("time"), jnumber_create_i64(change->time));
+		jobject_put(change_j, J_CSTR_TO_JVAL("name"),
+		            jstring_create(runtime_param_get_name(change->param)));
+		jobject_put(change_j, J_CSTR_TO_JVAL("oldValue"),
+		            jnumber_create_i32(change->old_value));
+		jobject_put(change_j, J_CSTR_TO_JVAL("newValue"),
+		            jnumber_create_i32(change->new_value));
+		jobject_put(change_j, J_CSTR_TO_JVAL("source"),
+		            jstring_create(change->source ? change->source : ""));
+
+		jarray_append(changes_j, change_j);
+	}
+
+	for (call = 0; call < DBUS_CALL_LAST; call++)
+	{
+		const dbus_call_stats_t *stats = dbus_call_get_stats(call);
+		jvalue_ref call_j = jobject_create();
+
+		jobject_put(call_j, J_CSTR_TO_JVAL("name"),
+		            jstring_create(dbus_call_get_name(call)));
+		jobject_put(call_j, J_CSTR_TO_JVAL("deadline"),
+		            jnumber_create_i32(dbus_call_get_deadline(call)));
+		jobject_put(call_j, J_CSTR_TO_JVAL("calls"), jnumber_create_i64(stats->calls));
+		jobject_put(call_j, J_CSTR_TO_JVAL("timeouts"),
+		            jnumber_create_i64(stats->timeouts));
+		jobject_put(call_j, J_CSTR_TO_JVAL("cancelled"),
+		            jnumber_create_i64(stats->cancelled));
+
+		jarray_append(dbus_calls_j, call_j);
+	}
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("parameters"), parameters_j);
+	jobject_put(reply, J_CSTR_TO_JVAL("changes"), changes_j);
+	jobject_put(reply, J_CSTR_TO_JVAL("dbusCalls"), dbus_calls_j);
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_setruntimeparameters setRuntimeParameters
+
+Changes runtime tunable parameters. Either all given values are applied or
+none of them. Timers pick up the new values the next time they are started.
+Changes are not written back to the config file, which is re-read on SIGHUP
+or whenever it is modified.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+parameters | yes | Array of Object | Each object holds the "name" (String) and the new "value" (Integer) of a parameter
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when all values were applied. False otherwise.
+errorCode | no | Integer | Error code, e.g. for an unknown parameter or a value out of range
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_runtime_parameters_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+	jvalue_ref parametersObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(OBJARRAY(parameters,
+	                                     OBJSCHEMA_2(PROP(name, string), PROP(value, integer))))
+	                                     REQUIRED_1(parameters))), &parsedObj))
+	{
+		return true;
+	}
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("parameters"), &parametersObj);
+
+	ssize_t i, num_elems = jarray_size(parametersObj);
+	runtime_param_t *params = g_new0(runtime_param_t, num_elems + 1);
+	gint64 *values = g_new0(gint64, num_elems + 1);
+	gchar *source = NULL;
+
+	/* Validate all entries first so that either all or none of them are applied */
+	for (i = 0; i < num_elems; i++)
+	{
+		jvalue_ref paramObj = jarray_get(parametersObj, i);
+		jvalue_ref nameObj = {0}, valueObj = {0};
+		gboolean found;
+
+		if (!jobject_get_exists(paramObj, J_CSTR_TO_BUF("name"), &nameObj) ||
+		        !jobject_get_exists(paramObj, J_CSTR_TO_BUF("value"), &valueObj))
+		{
+			LSMessageReplyErrorInvalidParams(sh, message);
+			goto cleanup;
+		}
+
+		raw_buffer name_buf = jstring_get(nameObj);
+		found = runtime_param_lookup(name_buf.m_str, &params[i]);
+		jstring_free_buffer(name_buf);
+
+		if (!found)
+		{
+			LSMessageReplyCustomError(sh, message, "Unknown parameter",
+			                          WCA_API_ERROR_RUNTIME_PARAM_UNKNOWN);
+			goto cleanup;
+		}
+
+		jnumber_get_i64(valueObj, &values[i]);
+
+		if (!runtime_param_is_valid(params[i], values[i]))
+		{
+			LSMessageReplyCustomError(sh, message, "Parameter value out of range",
+			                          WCA_API_ERROR_RUNTIME_PARAM_OUT_OF_RANGE);
+			goto cleanup;
+		}
+	}
+
+	source = g_strdup_printf("luna:%s", LSMessageGetSenderServiceName(message) ?
+	                         LSMessageGetSenderServiceName(message) : LSMessageGetSender(message));
+
+	for (i = 0; i < num_elems; i++)
+	{
+		runtime_param_set(params[i], values[i], source);
+	}
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_free(source);
+	g_free(params);
+	g_free(values);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_setwired8021x setWired8021x
+
+Sets up 802.1X authentication of the wired port, replacing any profile set up
+before. The profile is stored as a connman provisioning file bound to the MAC
+address of the wired interface, so connman authenticates the port each time a
+cable is plugged in. This needs a connman whose ethernet plugin runs EAP
+through wpa_supplicant, the stock plugin ignores the EAP entries. Certificates are checked against the certificate store
+(see com.webos.service.wifi/importCertificate) before the profile is stored.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+eapType | yes | String | "tls", "peap" or "ttls"
+identity | yes | String | Identity sent to the authenticator
+caCertFile | no | String | Path of the CA certificate used to check the authentication server
+clientCertFile | no | String | Path of the client certificate, required for "tls"
+privateKeyFile | no | String | Path of the private key of the client certificate, required for "tls"
+privateKeyPassphrase | no | String | Passphrase of the private key
+phase2 | no | String | Inner authentication of "peap" and "ttls", e.g. "MSCHAPV2"
+passphrase | no | String | Password, required for "peap" and "ttls"
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the profile was stored. False otherwise.
+errorCode | no | Integer | Error code, if returnValue is false
+errorText | no | String | Error description, if returnValue is false
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_wired_8021x_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref parsedObj = {0};
+	jvalue_ref value_obj = {0};
+	connection_settings_t *settings = NULL;
+	char mac_address[MAC_ADDR_STRING_LEN] = {0};
+	GError *error = NULL;
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_8(PROP(eapType, string),
+	                                     PROP(identity, string), PROP(caCertFile, string),
+	                                     PROP(clientCertFile, string), PROP(privateKeyFile, string),
+	                                     PROP(privateKeyPassphrase, string), PROP(phase2, string),
+	                                     PROP(passphrase, string)) REQUIRED_1(eapType))), &parsedObj))
+	{
+		return true;
+	}
+
+	settings = connection_settings_new();
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("eapType"), &value_obj))
+	{
+		raw_buffer eap_type_buf = jstring_get(value_obj);
+		settings->eap_type = g_strdup(eap_type_buf.m_str);
+		jstring_free_buffer(eap_type_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("identity"), &value_obj))
+	{
+		raw_buffer identity_buf = jstring_get(value_obj);
+		settings->identity = g_strdup(identity_buf.m_str);
+		jstring_free_buffer(identity_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("caCertFile"), &value_obj))
+	{
+		raw_buffer ca_cert_file_buf = jstring_get(value_obj);
+		settings->ca_cert_file = g_strdup(ca_cert_file_buf.m_str);
+		jstring_free_buffer(ca_cert_file_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("clientCertFile"), &value_obj))
+	{
+		raw_buffer client_cert_file_buf = jstring_get(value_obj);
+		settings->client_cert_file = g_strdup(client_cert_file_buf.m_str);
+		jstring_free_buffer(client_cert_file_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("privateKeyFile"), &value_obj))
+	{
+		raw_buffer private_key_file_buf = jstring_get(value_obj);
+		settings->private_key_file = g_strdup(private_key_file_buf.m_str);
+		jstring_free_buffer(private_key_file_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("privateKeyPassphrase"),
+	                       &value_obj))
+	{
+		raw_buffer private_key_passphrase_buf = jstring_get(value_obj);
+		settings->private_key_passphrase = g_strdup(private_key_passphrase_buf.m_str);
+		jstring_free_buffer(private_key_passphrase_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("phase2"), &value_obj))
+	{
+		raw_buffer phase2_buf = jstring_get(value_obj);
+		settings->phase2 = g_strdup(phase2_buf.m_str);
+		jstring_free_buffer(phase2_buf);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("passphrase"), &value_obj))
+	{
+		raw_buffer passphrase_buf = jstring_get(value_obj);
+		settings->passphrase = g_strdup(passphrase_buf.m_str);
+		jstring_free_buffer(passphrase_buf);
+	}
+
+	if (!wired_8021x_check_settings(settings->eap_type, settings->identity,
+	                                settings->passphrase, settings->client_cert_file,
+	                                settings->private_key_file, &error))
+	{
+		LSMessageReplyCustomError(sh, message, error->message,
+		                          WCA_API_ERROR_WIRED_8021X_INVALID);
+		g_error_free(error);
+		goto cleanup;
+	}
+
+	if (!check_enterprise_certificates(sh, message, settings->ca_cert_file,
+	                                   settings->client_cert_file))
+	{
+		goto cleanup;
+	}
+
+	if (!retrieve_wired_mac_address(mac_address, MAC_ADDR_STRING_LEN))
+	{
+		WCALOG_ERROR(MSGID_CM_WIRED_8021X_ERROR, 0, "No wired interface");
+		LSMessageReplyCustomError(sh, message, "No wired interface",
+		                          WCA_API_ERROR_INTERNAL);
+		goto cleanup;
+	}
+
+	if (!store_wired_network_config(mac_address, settings))
+	{
+		WCALOG_ERROR(MSGID_CM_WIRED_8021X_ERROR, 0,
+		             "Failed to store the wired 802.1X profile of %s", mac_address);
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (NULL != wired_8021x_settings)
+	{
+		connection_settings_free(wired_8021x_settings);
+	}
+
+	/* Secrets stay in the .config file only */
+	g_free(settings->private_key_passphrase);
+	settings->private_key_passphrase = NULL;
+	g_free(settings->passphrase);
+	settings->passphrase = NULL;
+
+	wired_8021x_settings = settings;
+	wired_8021x_loaded = TRUE;
+	settings = NULL;
+
+	supplicant_wired_watch(CONNMAN_WIRED_INTERFACE_NAME, wired_eap_state_cb, NULL);
+
+	LSMessageReplySuccess(sh, message);
+	connectionmanager_send_status_to_subscribers();
+
+cleanup:
+
+	if (NULL != settings)
+	{
+		connection_settings_free(settings);
+	}
+
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_deletewired8021x deleteWired8021x
+
+Removes the 802.1X profile of the wired port set up with setWired8021x.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the profile was removed. False otherwise.
+errorCode | no | Integer | Error code, if returnValue is false
+errorText | no | String | Error description, if returnValue is false
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_delete_wired_8021x_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref parsedObj = {0};
+	char mac_address[MAC_ADDR_STRING_LEN] = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	if (NULL == get_wired_8021x_settings() ||
+	        !retrieve_wired_mac_address(mac_address, MAC_ADDR_STRING_LEN) ||
+	        !remove_wired_network_config(mac_address))
+	{
+		LSMessageReplyCustomError(sh, message, "No wired 802.1X profile",
+		                          WCA_API_ERROR_WIRED_8021X_NOT_CONFIGURED);
+		goto cleanup;
+	}
+
+	connection_settings_free(wired_8021x_settings);
+	wired_8021x_settings = NULL;
+	supplicant_wired_unwatch();
+
+	LSMessageReplySuccess(sh, message);
+	connectionmanager_send_status_to_subscribers();
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_setwifipowersave setWifiPowerSave
+
+Sets how the power save state of the wifi interface is managed.
+
+In the "adaptive" mode power save is disabled as soon as the wifi link
+carries at least powerSaveBusyByteRate kB/s or powerSaveBusyPacketRate
+packets/s, and enabled again once the link stayed below both for
+powerSaveIdleHold seconds (see getRuntimeParameters). The rates are sampled
+every second from the connman counters.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+mode | yes | String | "on" or "off" to keep power save enabled or disabled, "adaptive" to follow the traffic, "default" to enable it and leave it to the driver
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the mode was applied. False otherwise.
+errorCode | no | Integer | Error code, if returnValue is false
+errorText | no | String | Error description, if returnValue is false
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_wifi_power_save_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+	jvalue_ref mode_obj = {0};
+	power_save_mode_t mode;
+	gboolean enabled;
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(mode, string))
+	                                     REQUIRED_1(mode))), &parsedObj))
+	{
+		return true;
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("mode"), &mode_obj))
+	{
+		raw_buffer mode_buf = jstring_get(mode_obj);
+		mode = power_save_mode_from_string(mode_buf.m_str);
+		jstring_free_buffer(mode_buf);
+	}
+	else
+	{
+		mode = POWER_SAVE_MODE_LAST;
+	}
+
+	if (POWER_SAVE_MODE_LAST == mode)
+	{
+		LSMessageReplyCustomError(sh, message, "Invalid power save mode",
+		                          WCA_API_ERROR_POWER_SAVE_INVALID_MODE);
+		goto cleanup;
+	}
+
+	if (POWER_SAVE_MODE_ADAPTIVE == mode && !enable_counter())
+	{
+		LSMessageReplyCustomError(sh, message, "Error in setting counter",
+		                          WCA_API_ERROR_COUNTER);
+		goto cleanup;
+	}
+
+	/* Adaptive starts out saving power until the link gets busy */
+	enabled = POWER_SAVE_MODE_OFF != mode;
+
+	if (!apply_wifi_power_save(enabled))
+	{
+		LSMessageReplyCustomError(sh, message, "Failed to set power save",
+		                          WCA_API_ERROR_POWER_SAVE_FAILED);
+		goto cleanup;
+	}
+
+	if (POWER_SAVE_MODE_ADAPTIVE == mode && POWER_SAVE_MODE_ADAPTIVE != power_save_mode)
+	{
+		power_save_policy_init(&power_save_policy,
+		                       runtime_param_get(RUNTIME_PARAM_POWER_SAVE_BUSY_BYTE_RATE) * 1000,
+		                       runtime_param_get(RUNTIME_PARAM_POWER_SAVE_BUSY_PACKET_RATE),
+		                       runtime_param_get(RUNTIME_PARAM_POWER_SAVE_IDLE_HOLD) * 1000);
+	}
+
+	power_save_policy.enabled = enabled;
+	power_save_mode = mode;
+
+	WCALOG_INFO(MSGID_CM_POWER_SAVE_INFO, 0, "Power save mode %s",
+	            power_save_mode_to_string(mode));
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_connectionmanager com.webos.connectionmanager
+@{
+@section com_webos_connectionmanager_getwifipowersave getWifiPowerSave
+
+Gets the wifi power save mode set with setWifiPowerSave and what the
+adaptive mode measured.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+mode | yes | String | "default", "on", "off" or "adaptive"
+powerSave | no | Boolean | Power save state last set, not present in the "default" mode
+byteRate | no | Integer | Bytes/s of the wifi link in the last sample, "adaptive" mode only
+packetRate | no | Integer | Packets/s of the wifi link in the last sample, "adaptive" mode only
+transitions | no | Object | Times the "adaptive" mode "enabled" and "disabled" power save since it was set
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_wifi_power_save_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY),
+	                             &parsedObj))
+	{
+		return true;
+	}
+
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jvalue_ref reply = jobject_create();
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("mode"),
+	            jstring_create(power_save_mode_to_string(power_save_mode)));
+
+	if (POWER_SAVE_MODE_DEFAULT != power_save_mode)
+	{
+		jobject_put(reply, J_CSTR_TO_JVAL("powerSave"),
+		            jboolean_create(power_save_policy.enabled));
+	}
+
+	if (POWER_SAVE_MODE_ADAPTIVE == power_save_mode)
+	{
+		jvalue_ref transitions_j = jobject_create();
+
+		jobject_put(reply, J_CSTR_TO_JVAL("byteRate"),
+		            jnumber_create_i64(power_save_policy.byte_rate));
+		jobject_put(reply, J_CSTR_TO_JVAL("packetRate"),
+		            jnumber_create_i64(power_save_policy.packet_rate));
+
+		jobject_put(transitions_j, J_CSTR_TO_JVAL("enabled"),
+		            jnumber_create_i64(power_save_policy.enable_count));
+		jobject_put(transitions_j, J_CSTR_TO_JVAL("disabled"),
+		            jnumber_create_i64(power_save_policy.disable_count));
+		jobject_put(reply, J_CSTR_TO_JVAL("transitions"), transitions_j);
+	}
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ * @brief com.webos.service.connectionmanager service method table
+ */
+
+static LSMethod connectionmanager_methods[] =
+{
+	{ LUNA_METHOD_GETSTATUS,            handle_get_status_command },
+	{ LUNA_METHOD_GETSTATUS2,           handle_get_status_command },
+	{ LUNA_METHOD_SETIPV4,              handle_set_ipv4_command },
+	{ LUNA_METHOD_SETDNS,               handle_set_dns_command },
+	{ LUNA_METHOD_SETSTATE,             handle_set_state_command },
+	{ LUNA_METHOD_GETINFO,              handle_get_info_command },
+	{ LUNA_METHOD_SETIPV6,              handle_set_ipv6_command },
+	{ LUNA_METHOD_MONITORACTIVITY,      handle_monitor_activity_command },
+	{ LUNA_METHOD_SETTECHNOLOGYSTATE,   handle_set_technology_state_command },
+	{ LUNA_METHOD_SETETHERNETTETHERING, handle_set_ethernet_tethering_command },
+	{ LUNA_METHOD_SETPROXY,             handle_set_proxy_command },
+	{ LUNA_METHOD_FINDPROXYFORURL,      handle_find_proxy_for_url_command },
+	{ LUNA_METHOD_GETNETWORKBINDINGS,   handle_get_network_bindings_command },
+	{ LUNA_METHOD_DELETENETWORKBINDING, handle_delete_network_binding_command },
+	{ LUNA_METHOD_GETRUNTIMEPARAMETERS, handle_get_runtime_parameters_command },
+	{ LUNA_METHOD_SETRUNTIMEPARAMETERS, handle_set_runtime_parameters_command },
+	{ LUNA_METHOD_SETWIRED8021X,        handle_set_wired_8021x_command },
+	{ LUNA_METHOD_DELETEWIRED8021X,     handle_delete_wired_8021x_command },
+	{ LUNA_METHOD_SETWIFIPOWERSAVE,     handle_set_wifi_power_save_command },
+	{ LUNA_METHOD_GETWIFIPOWERSAVE,     handle_get_wifi_power_save_command },
+	{ LUNA_METHOD_GETP2PGROUPCACHE,     handle_get_p2p_group_cache_command },
+	{ LUNA_METHOD_DELETEP2PGROUPCACHE,  handle_delete_p2p_group_cache_command },
+	{ LUNA_METHOD_RUNSELFTEST,          handle_run_self_test_command },
+	{ LUNA_METHOD_CANCELSELFTEST,       handle_cancel_self_test_command },
+	{ },
+};
+
+/**
+ *  @brief Called by the IPv6 address cache whenever an address was added or removed
+ */
+
+static void ipv6_addresses_changed_cb(gpointer user_data)
+{
+	ipv6_addresses_changed = TRUE;
+	connectionmanager_send_status_to_subscribers();
+}
+
+/**
+ *  @brief Called by luna when a caller cancels a call or goes away. Stops the
+ *  pending D-Bus calls made for it and the self test it waits for.
+ */
+
+static void handle_luna_call_cancel(LSHandle *sh, LSMessage *message,
+                                    void *ctx)
+{
+	const char *token = LSMessageGetUniqueToken(message);
+
+	dbus_call_scope_cancel(token);
+
+	if (NULL == running_self_test ||
+	        g_strcmp0(LSMessageGetUniqueToken(self_test_req->message), token))
+	{
+		return;
+	}
+
+	self_test_cancel(running_self_test);
+	running_self_test = NULL;
+	luna_service_request_free(self_test_req);
+	self_test_req = NULL;
+
+	WCALOG_INFO(MSGID_CM_SELF_TEST_INFO, 0,
+	            "Self test cancelled, its caller went away");
+}
+
+/**
+ *  @brief Initialize the com.webos.service.connectionmanager service and register all provided
+ *  service method on the luna service bus.
+ *
+ *  @param mainloop Reference to the used glib mainloop object
+ *  @return 0 if service is initialized successfull. -1 otherwise.
+ */
+
+int initialize_connectionmanager_ls2_calls(GMainLoop *mainloop,
+        LSHandle **cm_handle)
+{
+	LSError lserror;
+	LSErrorInit(&lserror);
+	pLsHandle = NULL;
+
+	if (!mainloop)
+	{
+		goto exit;
+	}
+
+	if (!LSRegister(CONNECTIONMANAGER_LUNA_SERVICE_NAME, &pLsHandle, &lserror))
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_CM_LUNA_BUS_ERROR, lserror.message);
+		goto exit;
+	}
+
+	if (!LSRegisterCategory(pLsHandle, LUNA_CATEGORY_ROOT,
+	                        connectionmanager_methods,
+	                        NULL, NULL, &lserror))
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_CM_METHODS_LUNA_ERROR, lserror.message);
+		goto exit;
+	}
+
+	if (!LSSubscriptionSetCancelFunction(pLsHandle, handle_luna_call_cancel, NULL,
+	                                     &lserror))
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_CM_LUNA_BUS_ERROR, lserror.message);
+		goto exit;
+	}
+
+	if (!LSGmainAttach(pLsHandle, mainloop, &lserror))
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_CM_GLOOP_ATTACH_ERROR, lserror.message);
+		goto exit;
+	}
+
+	*cm_handle = pLsHandle;
+
+	load_wifi_setting(WIFI_NETWORK_BINDINGS_SETTING, NULL);
+	load_wifi_setting(WIFI_P2P_GROUP_CACHE_SETTING, NULL);
+	load_wifi_setting(WIFI_DNS_REORDER_SETTING, NULL);
+	schedule_dns_probe();
+
+	GError *error = NULL;
+
+	if (!ipv6_addresses_rtnl_start(ipv6_addresses_changed_cb, NULL, &error))
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_CM_IPV6_ADDRESSES_ERROR, error->message);
+		g_error_free(error);
+	}
 
 	return 0;
 
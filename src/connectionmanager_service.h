@@ -24,6 +24,8 @@
 
 #include <luna-service2/lunaservice.h>
 
+#include "connman_service.h"
+
 #define CONNECTIONMANAGER_LUNA_SERVICE_NAME "com.webos.service.connectionmanager"
 
 #define LUNA_CATEGORY_ROOT                 "/"
@@ -46,6 +48,18 @@
 #define LUNA_METHOD_SETETHERNETTETHERING  "setEthernetTethering"
 #define LUNA_METHOD_SETPROXY              "setProxy"
 #define LUNA_METHOD_FINDPROXYFORURL       "findProxyForURL"
+#define LUNA_METHOD_GETNETWORKBINDINGS    "getNetworkBindings"
+#define LUNA_METHOD_DELETENETWORKBINDING  "deleteNetworkBinding"
+#define LUNA_METHOD_GETRUNTIMEPARAMETERS  "getRuntimeParameters"
+#define LUNA_METHOD_SETRUNTIMEPARAMETERS  "setRuntimeParameters"
+#define LUNA_METHOD_SETWIRED8021X         "setWired8021x"
+#define LUNA_METHOD_DELETEWIRED8021X      "deleteWired8021x"
+#define LUNA_METHOD_SETWIFIPOWERSAVE      "setWifiPowerSave"
+#define LUNA_METHOD_GETWIFIPOWERSAVE      "getWifiPowerSave"
+#define LUNA_METHOD_GETP2PGROUPCACHE      "getP2PGroupCache"
+#define LUNA_METHOD_DELETEP2PGROUPCACHE   "deleteP2PGroupCache"
+#define LUNA_METHOD_RUNSELFTEST           "runSelfTest"
+#define LUNA_METHOD_CANCELSELFTEST        "cancelSelfTest"
 
 enum ipadress_type
 {
@@ -58,5 +72,7 @@ extern void connectionmanager_send_status_to_subscribers(void);
 extern int initialize_connectionmanager_ls2_calls(GMainLoop *mainloop,
         LSHandle **cm_handle);
 extern void send_getinfo_to_subscribers(void);
+extern void connectionmanager_service_ready(connman_service_t *service);
+extern void connectionmanager_update_p2p_group_cache(void);
 
 #endif /* _CONNECTIONMANAGER_SERVICE_H_ */
@@ -23,6 +23,7 @@
 
 #include "connman_group.h"
 #include "connman_manager.h"
+#include "dbus_call.h"
 #include "logging.h"
 #include "common.h"
 
@@ -43,10 +44,12 @@ gboolean connman_group_set_tethering(connman_group_t *group, gboolean enable)
 
 	GError *error = NULL;
 
+	dbus_call_begin(group->remote, DBUS_CALL_STATE_CHANGE);
 	connman_interface_group_call_set_property_sync(group->remote,
 	        "Tethering",
 	        g_variant_new_variant(g_variant_new_boolean(enable)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_STATE_CHANGE, error);
 
 	if (error)
 	{
@@ -75,7 +78,9 @@ gboolean connman_group_disconnect(connman_group_t *group)
 
 	GError *error = NULL;
 
+	dbus_call_begin(group->remote, DBUS_CALL_CONTROL);
 	connman_interface_group_call_disconnect_sync(group->remote, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -105,8 +110,10 @@ gboolean connman_group_invite_peer(connman_group_t *group,
 
 	GError *error = NULL;
 
+	dbus_call_begin(group->remote, DBUS_CALL_CONTROL);
 	connman_interface_group_call_invite_sync(group->remote, service->path, NULL,
 	        &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -186,8 +193,10 @@ gboolean connman_group_get_local_address(connman_group_t *group)
 	GVariant *properties;
 	gsize i;
 
+	dbus_call_begin(group->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_group_call_get_properties_sync(group->remote, &properties,
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -0,0 +1,370 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  connman_liveness.c
+ *
+ * @brief Detects a stalled connman or a diverged service model and escalates
+ * the recovery
+ *
+ * Name owner changes only tell if connman went away. If connman hangs or
+ * some signals get lost, the model of the adapter silently diverges. Each
+ * failed check escalates the recovery one level further, from a resync of
+ * the services over registering the agent again to a full reattach. A
+ * failure after a reattach starts over with a resync, and each reattach
+ * doubles the check interval so a wedged connman isn't torn down again
+ * every interval. A healthy check resets the escalation and the interval.
+ */
+
+#include <gio/gio.h>
+
+#include "connman_liveness.h"
+#include "runtime_params.h"
+
+/* 64 bit FNV-1a */
+#define FNV_OFFSET_BASIS    G_GUINT64_CONSTANT(0xcbf29ce484222325)
+#define FNV_PRIME           G_GUINT64_CONSTANT(0x100000001b3)
+
+/* The check interval doubles with each reattach, up to 16 times */
+#define MAX_BACKOFF         4
+
+struct connman_liveness
+{
+	connman_liveness_ops_t ops;
+	gpointer user_data;
+	gboolean running;
+	guint tick_source;
+	guint deadline_source;
+	GCancellable *cancellable; /* Set while a check is running */
+	guint check_count;
+	gboolean divergence_suspected;
+	connman_liveness_level_t level;
+	guint backoff;             /* Interval shift, one more per reattach */
+	connman_liveness_stats_t stats;
+};
+
+static void arm_tick(connman_liveness_t *liveness);
+
+static void finish_check(connman_liveness_t *liveness)
+{
+	if (liveness->deadline_source > 0)
+	{
+		g_source_remove(liveness->deadline_source);
+		liveness->deadline_source = 0;
+	}
+
+	g_clear_object(&liveness->cancellable);
+}
+
+static void healthy(connman_liveness_t *liveness)
+{
+	liveness->level = CONNMAN_LIVENESS_LEVEL_NONE;
+	liveness->backoff = 0;
+}
+
+/**
+ * @brief Try the next recovery level, starting over with a resync after a
+ * reattach. The prober must not be touched after calling the recover
+ * operation, which may stop and restart it.
+ */
+
+static void failure(connman_liveness_t *liveness)
+{
+	if (liveness->level < CONNMAN_LIVENESS_LEVEL_REATTACH)
+	{
+		liveness->level++;
+	}
+	else
+	{
+		liveness->level = CONNMAN_LIVENESS_LEVEL_RESYNC;
+	}
+
+	if (liveness->level == CONNMAN_LIVENESS_LEVEL_REATTACH &&
+	        liveness->backoff < MAX_BACKOFF)
+	{
+		liveness->backoff++;
+	}
+
+	liveness->stats.recoveries[liveness->level]++;
+	liveness->ops.recover(liveness, liveness->level, liveness->user_data);
+}
+
+static gboolean deadline_cb(gpointer user_data)
+{
+	connman_liveness_t *liveness = user_data;
+	GCancellable *cancellable = liveness->cancellable;
+
+	/* A late answer must not be taken for the one of the next check */
+	liveness->deadline_source = 0;
+	liveness->cancellable = NULL;
+
+	g_cancellable_cancel(cancellable);
+	g_object_unref(cancellable);
+
+	liveness->stats.stalls++;
+	failure(liveness);
+
+	return FALSE;
+}
+
+static gboolean tick_cb(gpointer user_data)
+{
+	connman_liveness_t *liveness = user_data;
+
+	liveness->tick_source = 0;
+
+	connman_liveness_check_now(liveness);
+
+	/* A reattach might have restarted the prober already */
+	if (liveness->running && 0 == liveness->tick_source)
+	{
+		arm_tick(liveness);
+	}
+
+	return FALSE;
+}
+
+static void arm_tick(connman_liveness_t *liveness)
+{
+	guint interval = runtime_param_get(RUNTIME_PARAM_CONNMAN_PROBE_INTERVAL);
+
+	liveness->tick_source = g_timeout_add(interval << liveness->backoff, tick_cb,
+	                                      liveness);
+}
+
+/**
+ * Create a prober (see header for API details)
+ */
+
+connman_liveness_t *connman_liveness_new(const connman_liveness_ops_t *ops,
+        gpointer user_data)
+{
+	connman_liveness_t *liveness = g_new0(connman_liveness_t, 1);
+
+	liveness->ops = *ops;
+	liveness->user_data = user_data;
+
+	return liveness;
+}
+
+/**
+ * Stop and free a prober (see header for API details)
+ */
+
+void connman_liveness_free(connman_liveness_t *liveness)
+{
+	if (NULL == liveness)
+	{
+		return;
+	}
+
+	connman_liveness_stop(liveness);
+	g_free(liveness);
+}
+
+/**
+ * Check connman periodically (see header for API details)
+ */
+
+void connman_liveness_start(connman_liveness_t *liveness)
+{
+	if (liveness->running)
+	{
+		return;
+	}
+
+	liveness->running = TRUE;
+	arm_tick(liveness);
+}
+
+/**
+ * Stop checking connman (see header for API details)
+ */
+
+void connman_liveness_stop(connman_liveness_t *liveness)
+{
+	liveness->running = FALSE;
+
+	if (liveness->tick_source > 0)
+	{
+		g_source_remove(liveness->tick_source);
+		liveness->tick_source = 0;
+	}
+
+	if (NULL != liveness->cancellable)
+	{
+		g_cancellable_cancel(liveness->cancellable);
+		finish_check(liveness);
+	}
+}
+
+/**
+ * Start a check right away (see header for API details)
+ */
+
+void connman_liveness_check_now(connman_liveness_t *liveness)
+{
+	GCancellable *cancellable;
+
+	if (NULL != liveness->cancellable)
+	{
+		return;
+	}
+
+	liveness->stats.checks++;
+	liveness->cancellable = cancellable = g_cancellable_new();
+	liveness->deadline_source = g_timeout_add(runtime_param_get(
+	                                RUNTIME_PARAM_CONNMAN_PROBE_DEADLINE), deadline_cb, liveness);
+
+	/* The operation may report back right away */
+	if (liveness->divergence_suspected ||
+	        ++liveness->check_count % CONNMAN_LIVENESS_SAMPLE_EVERY == 0)
+	{
+		liveness->ops.sample(liveness, cancellable, liveness->user_data);
+	}
+	else
+	{
+		liveness->ops.probe(liveness, cancellable, liveness->user_data);
+	}
+}
+
+/**
+ * Report the result of a probe (see header for API details)
+ */
+
+void connman_liveness_probe_done(connman_liveness_t *liveness,
+                                 GCancellable *cancellable, gboolean success)
+{
+	if (NULL == cancellable || cancellable != liveness->cancellable)
+	{
+		return;
+	}
+
+	finish_check(liveness);
+
+	if (!success)
+	{
+		liveness->stats.stalls++;
+		failure(liveness);
+		return;
+	}
+
+	healthy(liveness);
+}
+
+/**
+ * Report the result of a sample (see header for API details)
+ */
+
+void connman_liveness_sample_done(connman_liveness_t *liveness,
+                                  GCancellable *cancellable, gboolean success, guint64 connman_hash,
+                                  guint64 model_hash)
+{
+	if (NULL == cancellable || cancellable != liveness->cancellable)
+	{
+		return;
+	}
+
+	finish_check(liveness);
+
+	if (!success)
+	{
+		liveness->stats.stalls++;
+		failure(liveness);
+		return;
+	}
+
+	if (connman_hash != model_hash)
+	{
+		if (!liveness->divergence_suspected)
+		{
+			/* Sample again with the next check */
+			liveness->divergence_suspected = TRUE;
+			return;
+		}
+
+		liveness->divergence_suspected = FALSE;
+		liveness->stats.divergences++;
+		failure(liveness);
+		return;
+	}
+
+	liveness->divergence_suspected = FALSE;
+	healthy(liveness);
+}
+
+/**
+ * Add a service path to a hash (see header for API details)
+ */
+
+guint64 connman_liveness_hash_add(guint64 hash, const gchar *path)
+{
+	guint64 path_hash = FNV_OFFSET_BASIS;
+
+	for (; NULL != path && *path; path++)
+	{
+		path_hash ^= (guint8) *path;
+		path_hash *= FNV_PRIME;
+	}
+
+	/* Adding keeps the hash independent of the order */
+	return hash + path_hash;
+}
+
+/**
+ * Get the current escalation level (see header for API details)
+ */
+
+connman_liveness_level_t connman_liveness_get_level(connman_liveness_t
+        *liveness)
+{
+	return liveness->level;
+}
+
+/**
+ * Get the counters of a prober (see header for API details)
+ */
+
+const connman_liveness_stats_t *connman_liveness_get_stats(
+    connman_liveness_t *liveness)
+{
+	return &liveness->stats;
+}
+
+/**
+ * Convert an escalation level to a string (see header for API details)
+ */
+
+const gchar *connman_liveness_level_to_string(connman_liveness_level_t level)
+{
+	switch (level)
+	{
+		case CONNMAN_LIVENESS_LEVEL_NONE:
+			return "none";
+
+		case CONNMAN_LIVENESS_LEVEL_RESYNC:
+			return "resync";
+
+		case CONNMAN_LIVENESS_LEVEL_AGENT:
+			return "agent";
+
+		case CONNMAN_LIVENESS_LEVEL_REATTACH:
+			return "reattach";
+
+		default:
+			return "unknown";
+	}
+}
@@ -0,0 +1,180 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  connman_liveness.h
+ *
+ * @brief Header file defining the connman liveness prober, which detects a
+ *        stalled connman or a service model diverging from connman's one and
+ *        escalates the recovery step by step
+ *
+ */
+
+#ifndef _CONNMAN_LIVENESS_H_
+#define _CONNMAN_LIVENESS_H_
+
+#include <gio/gio.h>
+
+/**
+ * Every n-th check compares the service model with connman instead of only
+ * probing if connman answers
+ */
+#define CONNMAN_LIVENESS_SAMPLE_EVERY   6
+
+typedef enum
+{
+	CONNMAN_LIVENESS_LEVEL_NONE = 0,
+	CONNMAN_LIVENESS_LEVEL_RESYNC,   /* Re-read the services from connman */
+	CONNMAN_LIVENESS_LEVEL_AGENT,    /* Register the agent again */
+	CONNMAN_LIVENESS_LEVEL_REATTACH, /* Drop everything and start over as if connman restarted */
+	CONNMAN_LIVENESS_LEVEL_LAST,
+} connman_liveness_level_t;
+
+typedef struct connman_liveness connman_liveness_t;
+
+/**
+ * Operations the prober uses to talk to connman. probe and sample start an
+ * asynchronous call and report its result with connman_liveness_probe_done /
+ * connman_liveness_sample_done, passing the cancellable they were given.
+ * The cancellable is cancelled once the deadline has passed.
+ */
+typedef struct connman_liveness_ops
+{
+	void (*probe)(connman_liveness_t *liveness, GCancellable *cancellable,
+	              gpointer user_data);
+	void (*sample)(connman_liveness_t *liveness, GCancellable *cancellable,
+	               gpointer user_data);
+	void (*recover)(connman_liveness_t *liveness, connman_liveness_level_t level,
+	                gpointer user_data);
+} connman_liveness_ops_t;
+
+typedef struct connman_liveness_stats
+{
+	guint checks;
+	guint stalls;
+	guint divergences;
+	guint recoveries[CONNMAN_LIVENESS_LEVEL_LAST];
+} connman_liveness_stats_t;
+
+/**
+ * Create a prober. It doesn't check anything before it is started.
+ *
+ * @param[IN]  ops Operations to talk to connman
+ * @param[IN]  user_data User data passed to the operations
+ *
+ * @return New prober, free with connman_liveness_free
+ */
+extern connman_liveness_t *connman_liveness_new(const connman_liveness_ops_t
+        *ops, gpointer user_data);
+
+/**
+ * Stop and free a prober
+ *
+ * @param[IN]  liveness Prober
+ */
+extern void connman_liveness_free(connman_liveness_t *liveness);
+
+/**
+ * Check connman periodically, every connmanProbeInterval ms. Each check has
+ * to be answered within connmanProbeDeadline ms. Each reattach doubles the
+ * interval, up to 16 times, until a check is healthy again.
+ *
+ * @param[IN]  liveness Prober
+ */
+extern void connman_liveness_start(connman_liveness_t *liveness);
+
+/**
+ * Stop checking connman and cancel a running check. The escalation level and
+ * the interval are kept, the counters too.
+ *
+ * @param[IN]  liveness Prober
+ */
+extern void connman_liveness_stop(connman_liveness_t *liveness);
+
+/**
+ * Start a check right away unless one is running already
+ *
+ * @param[IN]  liveness Prober
+ */
+extern void connman_liveness_check_now(connman_liveness_t *liveness);
+
+/**
+ * Report the result of a probe
+ *
+ * @param[IN]  liveness Prober
+ * @param[IN]  cancellable Cancellable the probe was started with
+ * @param[IN]  success TRUE if connman answered
+ */
+extern void connman_liveness_probe_done(connman_liveness_t *liveness,
+                                        GCancellable *cancellable, gboolean success);
+
+/**
+ * Report the result of a sample. A divergence has to show up in two samples
+ * in a row before it counts, as signals may still have been on their way.
+ *
+ * @param[IN]  liveness Prober
+ * @param[IN]  cancellable Cancellable the sample was started with
+ * @param[IN]  success TRUE if connman answered
+ * @param[IN]  connman_hash Hash of the service paths connman reported
+ * @param[IN]  model_hash Hash of the service paths of our model
+ */
+extern void connman_liveness_sample_done(connman_liveness_t *liveness,
+        GCancellable *cancellable, gboolean success, guint64 connman_hash,
+        guint64 model_hash);
+
+/**
+ * Add a service path to a hash. The order the paths are added in doesn't
+ * matter. Start with a hash of 0.
+ *
+ * @param[IN]  hash Hash so far
+ * @param[IN]  path Object path of the service
+ *
+ * @return New hash
+ */
+extern guint64 connman_liveness_hash_add(guint64 hash, const gchar *path);
+
+/**
+ * Get the current escalation level, i.e. the last recovery which was tried
+ * since connman was last found healthy
+ *
+ * @param[IN]  liveness Prober
+ *
+ * @return Escalation level
+ */
+extern connman_liveness_level_t connman_liveness_get_level(
+    connman_liveness_t *liveness);
+
+/**
+ * Get the counters of a prober
+ *
+ * @param[IN]  liveness Prober
+ *
+ * @return Counters owned by the prober
+ */
+extern const connman_liveness_stats_t *connman_liveness_get_stats(
+    connman_liveness_t *liveness);
+
+/**
+ * Convert an escalation level to a string for logging
+ *
+ * @param[IN]  level Escalation level
+ *
+ * @return "none", "resync", "agent" or "reattach"
+ */
+extern const gchar *connman_liveness_level_to_string(connman_liveness_level_t
+        level);
+
+#endif /* _CONNMAN_LIVENESS_H_ */
@@ -22,6 +22,8 @@
  */
 
 #include "connman_manager.h"
+#include "connman_liveness.h"
+#include "dbus_call.h"
 #include "logging.h"
 #include "connectionmanager_service.h"
 #include "utils.h"
@@ -48,8 +50,10 @@ GVariant *connman_manager_get_properties(connman_manager_t *manager)
 	GError *error = NULL;
 	GVariant *ret;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_manager_call_get_properties_sync(manager->remote,
 	        &ret, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -665,8 +669,10 @@ static gboolean connman_manager_add_services(connman_manager_t *manager)
 	GVariant *services;
 	gsize i;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_manager_call_get_services_sync(manager->remote,
 	        &services, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -723,8 +729,10 @@ gboolean connman_manager_change_saved_passphrase(connman_manager_t *manager,
 	g_variant_builder_unref(key_b);
 
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_manager_call_change_saved_service_sync(manager->remote,
 	        service->identifier, key_v, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -758,8 +766,10 @@ static gboolean connman_manager_add_technologies(connman_manager_t *manager)
 	GVariant *technologies;
 	gsize i;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_manager_call_get_technologies_sync(manager->remote,
 	        &technologies, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -836,8 +846,10 @@ gboolean connman_manager_populate_group_peers(connman_manager_t *manager,
 	GVariant *peers = NULL;
 	gsize i, j;
 
+	dbus_call_begin(group->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_group_call_get_peers_sync(group->remote, &peers, NULL,
 	        &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -931,8 +943,10 @@ static gboolean connman_manager_add_groups(connman_manager_t *manager)
 	GVariant *groups;
 	gsize i;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_manager_call_get_groups_sync(manager->remote,
 	        &groups, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -986,8 +1000,10 @@ connman_group_t *connman_manager_create_group(connman_manager_t *manager,
 	GError *error = NULL;
 	gchar *group_path = NULL;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
 	connman_interface_manager_call_create_group_sync(manager->remote,
 	        ssid, passphrase, &group_path, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1020,7 +1036,9 @@ guint connman_manager_get_sta_count(connman_manager_t *manager)
 	GError *error = NULL;
 	guint sta_count = 0;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_manager_call_get_sta_count_sync(manager->remote, &sta_count, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -1102,10 +1120,12 @@ gboolean connman_manager_set_offlinemode(connman_manager_t *manager,
 
 	GError *error = NULL;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_STATE_CHANGE);
 	connman_interface_manager_call_set_property_sync(manager->remote,
 	        "OfflineMode",
 	        g_variant_new_variant(g_variant_new_boolean(state)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_STATE_CHANGE, error);
 
 	if (error)
 	{
@@ -1133,10 +1153,12 @@ gboolean connman_manager_set_wol_wowl_mode(connman_manager_t *manager, gboolean
 
 	GError *error = NULL;
 
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_manager_call_set_property_sync(manager->remote,
 			"WOLWOWLMode",
 			g_variant_new_variant(g_variant_new_boolean(state)),
 			NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -1775,8 +1797,10 @@ gboolean connman_manager_register_agent(connman_manager_t *manager,
 		return FALSE;
 	}
 
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
 	connman_interface_manager_call_register_agent_sync(manager->remote,
 	        path, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1798,15 +1822,17 @@ gboolean connman_manager_register_agent(connman_manager_t *manager,
 gboolean connman_manager_unregister_agent(connman_manager_t *manager,
         const gchar *path)
 {
-	GError *error;
+	GError *error = NULL;
 
 	if (NULL == manager)
 	{
 		return FALSE;
 	}
 
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
 	connman_interface_manager_call_unregister_agent_sync(manager->remote,
 	        path, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1818,6 +1844,251 @@ gboolean connman_manager_unregister_agent(connman_manager_t *manager,
 	return TRUE;
 }
 
+static void reregister_agent_register_cb(GObject *source_object,
+        GAsyncResult *res, gpointer user_data)
+{
+	GError *error = NULL;
+
+	connman_interface_manager_call_register_agent_finish(
+	    CONNMAN_INTERFACE_MANAGER(source_object), res, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
+
+	if (error)
+	{
+		WCALOG_DEBUG("%s", error->message);
+		g_error_free(error);
+		return;
+	}
+
+	WCALOG_DEBUG("Registered agent again with connman");
+}
+
+static void reregister_agent_unregister_cb(GObject *source_object,
+        GAsyncResult *res, gpointer user_data)
+{
+	gchar *path = user_data;
+	GError *error = NULL;
+
+	connman_interface_manager_call_unregister_agent_finish(
+	    CONNMAN_INTERFACE_MANAGER(source_object), res, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
+
+	if (error)
+	{
+		gboolean cancelled = g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+
+		/* The agent is likely not registered anymore, which is fine */
+		WCALOG_DEBUG("%s", error->message);
+		g_error_free(error);
+
+		if (cancelled)
+		{
+			g_free(path);
+			return;
+		}
+	}
+
+	/* The manager may be gone already, but the proxy is still referenced */
+	dbus_call_begin(source_object, DBUS_CALL_CONTROL);
+	connman_interface_manager_call_register_agent(
+	    CONNMAN_INTERFACE_MANAGER(source_object), path, NULL,
+	    reregister_agent_register_cb, NULL);
+
+	g_free(path);
+}
+
+/**
+ * Unregister the agent and register it again without blocking
+ * (see header for API details)
+ **/
+
+void connman_manager_reregister_agent(connman_manager_t *manager,
+                                      const gchar *path)
+{
+	if (NULL == manager || NULL == path)
+	{
+		return;
+	}
+
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
+	connman_interface_manager_call_unregister_agent(manager->remote, path,
+	        manager->cancellable, reregister_agent_unregister_cb, g_strdup(path));
+}
+
+/**
+ * Append the paths of all services in the list which aren't in the given
+ * GetServices result
+ */
+
+static void append_stale_services(GPtrArray *stale, GSList *service_list,
+                                  GHashTable *known_paths)
+{
+	GSList *iter;
+
+	for (iter = service_list; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *)(iter->data);
+
+		if (!g_hash_table_contains(known_paths, service->path))
+		{
+			g_ptr_array_add(stale, g_strdup(service->path));
+		}
+	}
+}
+
+static void resync_services_cb(GObject *source_object, GAsyncResult *res,
+                               gpointer user_data)
+{
+	connman_manager_t *manager = user_data;
+	GError *error = NULL;
+	GVariant *services = NULL;
+	GHashTable *known_paths;
+	GPtrArray *stale;
+	gchar **services_removed;
+	unsigned char service_type = 0;
+	gsize i;
+
+	connman_interface_manager_call_get_services_finish(
+	    CONNMAN_INTERFACE_MANAGER(source_object), &services, res, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
+
+	if (error)
+	{
+		/* When cancelled the manager was freed already */
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			WCALOG_ESCAPED_ERRMSG(MSGID_MANAGER_GET_SERVICES_ERROR, error->message);
+		}
+
+		g_error_free(error);
+		return;
+	}
+
+	known_paths = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	for (i = 0; i < g_variant_n_children(services); i++)
+	{
+		GVariant *service_v = g_variant_get_child_value(services, i);
+		GVariant *path_v = g_variant_get_child_value(service_v, 0);
+
+		g_hash_table_add(known_paths, g_variant_dup_string(path_v, NULL));
+
+		g_variant_unref(path_v);
+		g_variant_unref(service_v);
+	}
+
+	stale = g_ptr_array_new();
+	append_stale_services(stale, manager->wifi_services, known_paths);
+	append_stale_services(stale, manager->wired_services, known_paths);
+	append_stale_services(stale, manager->p2p_services, known_paths);
+	append_stale_services(stale, manager->cellular_services, known_paths);
+	append_stale_services(stale, manager->bluetooth_services, known_paths);
+	g_ptr_array_add(stale, NULL);
+	services_removed = (gchar **) g_ptr_array_free(stale, FALSE);
+
+	WCALOG_DEBUG("Resync: %d services, %d stale", (int) g_variant_n_children(services),
+	             (int) g_strv_length(services_removed));
+
+	/* Same as if connman had sent a services changed signal with everything */
+	if (connman_update_callbacks->services_changed)
+	{
+		connman_update_callbacks->services_changed(services, services_removed);
+	}
+
+	gboolean update_status = connman_manager_update_services(manager, services,
+	                         &service_type, FALSE);
+	gboolean remove_status = connman_manager_remove_old_services(manager,
+	                         services_removed, &service_type);
+
+	if (update_status == TRUE || remove_status == TRUE)
+	{
+		if (NULL != manager->handle_services_change_fn)
+		{
+			(manager->handle_services_change_fn)(manager, service_type);
+		}
+	}
+
+	g_strfreev(services_removed);
+	g_hash_table_destroy(known_paths);
+	g_variant_unref(services);
+}
+
+/**
+ * Fetch all services from connman and bring the model in line without
+ * blocking (see header for API details)
+ **/
+
+void connman_manager_resync_services(connman_manager_t *manager)
+{
+	if (NULL == manager)
+	{
+		return;
+	}
+
+	dbus_call_begin(manager->remote, DBUS_CALL_PROPERTY_READ);
+	connman_interface_manager_call_get_services(manager->remote,
+	        manager->cancellable, resync_services_cb, manager);
+}
+
+/**
+ * Hash the paths of the manager's wifi services (see header for API details)
+ **/
+
+guint64 connman_manager_hash_wifi_services(connman_manager_t *manager)
+{
+	guint64 hash = 0;
+	GSList *iter;
+
+	if (NULL == manager)
+	{
+		return 0;
+	}
+
+	for (iter = manager->wifi_services; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *)(iter->data);
+		hash = connman_liveness_hash_add(hash, service->path);
+	}
+
+	return hash;
+}
+
+/**
+ * Hash the paths of the wifi services in a GetServices result
+ * (see header for API details)
+ **/
+
+guint64 connman_manager_hash_wifi_services_variant(GVariant *services)
+{
+	guint64 hash = 0;
+	gsize i;
+
+	if (NULL == services)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < g_variant_n_children(services); i++)
+	{
+		GVariant *service_v = g_variant_get_child_value(services, i);
+		GVariant *path_v = g_variant_get_child_value(service_v, 0);
+		GVariant *properties = g_variant_get_child_value(service_v, 1);
+		const gchar *type = NULL;
+
+		if (g_variant_lookup(properties, "Type", "&s", &type) &&
+		        !g_strcmp0(type, "wifi") && service_on_configured_iface(service_v))
+		{
+			hash = connman_liveness_hash_add(hash, g_variant_get_string(path_v, NULL));
+		}
+
+		g_variant_unref(properties);
+		g_variant_unref(path_v);
+		g_variant_unref(service_v);
+	}
+
+	return hash;
+}
+
 
 /**
  * Register a counter instance on the specified dbus path with the manager
@@ -1834,8 +2105,10 @@ gboolean connman_manager_register_counter(connman_manager_t *manager,
 		return FALSE;
 	}
 
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
 	connman_interface_manager_call_register_counter_sync(manager->remote,
 	        path, accuracy, period, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1860,8 +2133,10 @@ gboolean connman_manager_unregister_counter(connman_manager_t *manager,
 		return FALSE;
 	}
 
+	dbus_call_begin(manager->remote, DBUS_CALL_CONTROL);
 	connman_interface_manager_call_unregister_counter_sync(manager->remote,
 	        path, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1889,6 +2164,7 @@ connman_manager_t *connman_manager_new(void)
 	}
 
 	manager->technologies = NULL;
+	manager->cancellable = g_cancellable_new();
 
 	manager->remote = connman_interface_manager_proxy_new_for_bus_sync(
 	                      G_BUS_TYPE_SYSTEM,
@@ -1901,6 +2177,7 @@ connman_manager_t *connman_manager_new(void)
 	{
 		WCALOG_ESCAPED_ERRMSG(MSGID_MANAGER_INIT_ERROR, error->message);
 		g_error_free(error);
+		g_object_unref(manager->cancellable);
 		g_free(manager);
 		return NULL;
 	}
@@ -1978,6 +2255,10 @@ void connman_manager_free(connman_manager_t *manager)
 	connman_manager_free_technologies(manager);
 	connman_manager_free_groups(manager);
 
+	/* Pending asynchronous calls must not touch the freed manager */
+	g_cancellable_cancel(manager->cancellable);
+	g_object_unref(manager->cancellable);
+
 	g_object_unref(manager->remote);
 
 	g_free(manager->state);
@@ -72,6 +72,7 @@ typedef struct connman_manager
 	GSList  *groups;
 	gboolean offline;
 	gboolean wol_wowl;
+	GCancellable *cancellable; /* Cancels asynchronous calls when the manager is freed */
 	connman_property_changed_cb handle_property_change_fn;
 	connman_services_changed_cb handle_services_change_fn;
 	connman_groups_changed_cb   handle_groups_change_fn;
@@ -238,6 +239,45 @@ extern gboolean connman_manager_register_agent(connman_manager_t *manager,
 extern gboolean connman_manager_unregister_agent(connman_manager_t *manager,
         const gchar *path);
 
+/**
+ * Unregister the agent on the specified dbus path and register it again
+ * without blocking. Errors of the unregistration are ignored, as the agent
+ * may not be registered anymore.
+ *
+ * @param[IN] manager A manager instance
+ * @param[IN] path DBus object path where the agent is available
+ **/
+extern void connman_manager_reregister_agent(connman_manager_t *manager,
+        const gchar *path);
+
+/**
+ * Fetch all services from connman without blocking, update the known ones,
+ * add the missing ones and drop the ones connman doesn't know anymore. The
+ * services changed callback is called if anything changed.
+ *
+ * @param[IN] manager A manager instance
+ **/
+extern void connman_manager_resync_services(connman_manager_t *manager);
+
+/**
+ * Hash the object paths of the manager's wifi services
+ *
+ * @param[IN] manager A manager instance
+ *
+ * @return Hash, see connman_liveness_hash_add
+ **/
+extern guint64 connman_manager_hash_wifi_services(connman_manager_t *manager);
+
+/**
+ * Hash the object paths of the wifi services in a GetServices result the
+ * same way the manager would add them to its wifi service list
+ *
+ * @param[IN] services Result of the GetServices call
+ *
+ * @return Hash, see connman_liveness_hash_add
+ **/
+extern guint64 connman_manager_hash_wifi_services_variant(GVariant *services);
+
 /**
  * Register a counter instance on the specified dbus path with the manager
  *
@@ -23,14 +23,21 @@
 
 #include "connman_service.h"
 #include "connman_manager.h"
+#include "dbus_call.h"
 #include "utils.h"
 #include "logging.h"
 #include "common.h"
 #include "connectionmanager_service.h"
+#include "wifi_setting.h"
 
 /* gdbus default timeout is 25 seconds */
 #define DBUS_CALL_TIMEOUT   (60 * 1000)
 
+/* Identifiers of the services whose "Nameservers.Configuration" holds the
+ * reordered servers of the network. Kept in luna-prefs, so the order is
+ * dropped again after a restart of the adapter or a power loss. */
+static GSList *reordered_services = NULL;
+
 /**
  * Check if the type of the service is wifi (see header for API details)
  */
@@ -90,10 +97,12 @@ gboolean connman_service_set_hostroutes(connman_service_t *service,
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "HostRoutes.Configuration",
 	        g_variant_new_variant(g_variant_new_strv((const gchar * const *)hostroutes,
 	                              g_strv_length(hostroutes))), NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -228,7 +237,7 @@ gboolean connman_service_is_changed(connman_service_t *service,
 /**
  * Asynchronous connect callback for a remote "connect" call
  */
-static void connect_callback(GDBusConnection *connection, GAsyncResult *res,
+static void connect_callback(GObject *source_object, GAsyncResult *res,
                              gpointer user_data)
 {
 	GError *error = NULL;
@@ -237,9 +246,16 @@ static void connect_callback(GDBusConnection *connection, GAsyncResult *res,
 	connman_service_connect_cb cb = cbd->cb;
 	gboolean ret = FALSE;
 
+	ret = connman_interface_service_call_connect_finish(
+	          CONNMAN_INTERFACE_SERVICE(source_object), res, &error);
+	dbus_call_end(DBUS_CALL_CONNECT, error);
+
 	if (NULL == service->cancellable ||
 	        g_cancellable_is_cancelled(service->cancellable))
 	{
+		ret = FALSE;
+		g_clear_error(&error);
+
 		if (service->cancellable != NULL)
 		{
 			g_object_unref(service->cancellable);
@@ -252,12 +268,15 @@ static void connect_callback(GDBusConnection *connection, GAsyncResult *res,
 		}
 
 		g_free(cbd);
+
+		if (service->free_pending)
+		{
+			connman_service_free(service, NULL);
+		}
+
 		return;
 	}
 
-	ret = connman_interface_service_call_connect_finish(service->remote, res,
-	        &error);
-
 	if (error)
 	{
 		WCALOG_ESCAPED_ERRMSG(MSGID_SERVICE_CONNECT_ERROR, error->message);
@@ -287,7 +306,8 @@ static void connect_callback(GDBusConnection *connection, GAsyncResult *res,
  */
 
 gboolean connman_service_connect(connman_service_t *service,
-                                 connman_service_connect_cb cb, gpointer user_data)
+                                 GCancellable *cancellable, connman_service_connect_cb cb,
+                                 gpointer user_data)
 {
 	struct cb_data *cbd;
 
@@ -299,8 +319,10 @@ gboolean connman_service_connect(connman_service_t *service,
 	service->disconnecting = FALSE;
 	cbd = cb_data_new(cb, user_data);
 	cbd->user = service;
-	service->cancellable = g_cancellable_new();
+	service->cancellable = (NULL != cancellable) ? g_object_ref(cancellable) :
+	                       g_cancellable_new();
 
+	dbus_call_begin(service->remote, DBUS_CALL_CONNECT);
 	connman_interface_service_call_connect(service->remote, service->cancellable,
 	                                       (GAsyncReadyCallback) connect_callback, cbd);
 	return TRUE;
@@ -321,7 +343,9 @@ gboolean connman_service_disconnect(connman_service_t *service)
 	GError *error = NULL;
 
 	service->disconnecting = TRUE;
+	dbus_call_begin(service->remote, DBUS_CALL_CONTROL);
 	connman_interface_service_call_disconnect_sync(service->remote, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -347,7 +371,9 @@ gboolean connman_service_remove(connman_service_t *service)
 	GError *error = NULL;
 
 	service->disconnecting = TRUE;
+	dbus_call_begin(service->remote, DBUS_CALL_CONTROL);
 	connman_interface_service_call_remove_sync(service->remote, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -399,13 +425,21 @@ gboolean connman_service_set_ipv6(connman_service_t *service, ipv6info_t *ipv6)
 		                      g_variant_new_string(ipv6->gateway));
 	}
 
+	if (NULL != ipv6->privacy)
+	{
+		g_variant_builder_add(ipv6_b, "{sv}", "Privacy",
+		                      g_variant_new_string(ipv6->privacy));
+	}
+
 	ipv6_v = g_variant_builder_end(ipv6_b);
 	g_variant_builder_unref(ipv6_b);
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "IPv6.Configuration", g_variant_new_variant(ipv6_v), NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -462,8 +496,10 @@ gboolean connman_service_set_ipv4(connman_service_t *service, ipv4info_t *ipv4)
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "IPv4.Configuration", g_variant_new_variant(ipv4_v), NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 	g_variant_unref(ipv4_v);
 
 	if (error)
@@ -518,8 +554,10 @@ gboolean connman_service_set_proxy(connman_service_t *service, proxyinfo_t *prox
 	proxyinfo_v = g_variant_builder_end(proxyinfo_b);
 	g_variant_builder_unref(proxyinfo_b);
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 		        "Proxy.Configuration", g_variant_new_variant(proxyinfo_v), NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	g_variant_unref(proxyinfo_v);
 
@@ -534,11 +572,8 @@ gboolean connman_service_set_proxy(connman_service_t *service, proxyinfo_t *prox
 	return TRUE;
 }
 
-/**
- * Sets nameservers for the connman service (see header for API details)
- */
-
-gboolean connman_service_set_nameservers(connman_service_t *service, GStrv dns)
+static gboolean set_nameservers_configuration(connman_service_t *service,
+        GStrv dns)
 {
 	if (NULL == service || NULL == dns)
 	{
@@ -547,10 +582,12 @@ gboolean connman_service_set_nameservers(connman_service_t *service, GStrv dns)
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "Nameservers.Configuration",
 	        g_variant_new_variant(g_variant_new_strv((const gchar * const *)dns,
 	                              g_strv_length(dns))), NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -559,9 +596,110 @@ gboolean connman_service_set_nameservers(connman_service_t *service, GStrv dns)
 		return FALSE;
 	}
 
+	g_strfreev(service->dns_config);
+	service->dns_config = g_strdupv(dns);
+
 	return TRUE;
 }
 
+/**
+ *  @brief Add or remove the service from the services with reordered
+ *  nameservers, storing the list when it changed
+ */
+
+static void set_reordered_service(const gchar *identifier, gboolean reordered)
+{
+	GSList *entry = g_slist_find_custom(reordered_services, identifier,
+	                                    (GCompareFunc) g_strcmp0);
+
+	if (reordered && NULL == entry)
+	{
+		reordered_services = g_slist_prepend(reordered_services,
+		                                     g_strdup(identifier));
+	}
+	else if (!reordered && NULL != entry)
+	{
+		g_free(entry->data);
+		reordered_services = g_slist_delete_link(reordered_services, entry);
+	}
+	else
+	{
+		return;
+	}
+
+	store_wifi_setting(WIFI_DNS_REORDER_SETTING, NULL);
+}
+
+/**
+ * Sets nameservers for the connman service (see header for API details)
+ */
+
+gboolean connman_service_set_nameservers(connman_service_t *service, GStrv dns)
+{
+	if (!set_nameservers_configuration(service, dns))
+	{
+		return FALSE;
+	}
+
+	service->dns_config_reordered = FALSE;
+	set_reordered_service(service->identifier, FALSE);
+	return TRUE;
+}
+
+/**
+ * Sets the nameservers of the network in a different order (see header for
+ * API details)
+ */
+
+gboolean connman_service_set_reordered_nameservers(connman_service_t *service,
+        GStrv dns)
+{
+	if (!set_nameservers_configuration(service, dns))
+	{
+		return FALSE;
+	}
+
+	service->dns_config_reordered = TRUE;
+	set_reordered_service(service->identifier, TRUE);
+	return TRUE;
+}
+
+/**
+ * Get the services with reordered nameservers (see header for API details)
+ */
+
+GStrv connman_service_dup_reordered_nameservers(void)
+{
+	GStrv identifiers = g_new0(gchar *, g_slist_length(reordered_services) + 1);
+	GSList *iter;
+	guint i = 0;
+
+	for (iter = reordered_services; NULL != iter; iter = iter->next)
+	{
+		identifiers[i++] = g_strdup(iter->data);
+	}
+
+	return identifiers;
+}
+
+/**
+ * Load the services with reordered nameservers (see header for API details)
+ */
+
+void connman_service_load_reordered_nameservers(GStrv identifiers)
+{
+	guint i;
+
+	g_slist_free_full(reordered_services, g_free);
+	reordered_services = NULL;
+
+	for (i = 0; NULL != identifiers && NULL != identifiers[i]; i++)
+	{
+		reordered_services = g_slist_prepend(reordered_services,
+		                                     g_strdup(identifiers[i]));
+	}
+}
+
 /**
  * Set auto-connect property for the given service (see header for API details)
  */
@@ -576,10 +714,12 @@ gboolean connman_service_set_autoconnect(connman_service_t *service,
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "AutoConnect",
 	        g_variant_new_variant(g_variant_new_boolean(value)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -601,10 +741,12 @@ gboolean connman_service_set_run_online_check(connman_service_t *service,
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "RunOnlineCheck",
 	        g_variant_new_variant(g_variant_new_boolean(value)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -626,10 +768,12 @@ gboolean connman_service_set_passphrase(connman_service_t *service,
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_service_call_set_property_sync(service->remote,
 	        "Passphrase",
 	        g_variant_new_variant(g_variant_new_string(passphrase)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -691,8 +835,10 @@ gboolean connman_service_get_ipinfo(connman_service_t *service)
 	GVariant *properties;
 	gsize i;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_service_call_get_properties_sync(service->remote, &properties,
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -800,6 +946,18 @@ gboolean connman_service_get_ipinfo(connman_service_t *service)
 					g_variant_unref(gatewayva);
 				}
 
+				if (!g_strcmp0(ikey, "Privacy"))
+				{
+					GVariant *privacyv = g_variant_get_child_value(ipv6, 1);
+					GVariant *privacyva = g_variant_get_variant(privacyv);
+
+					g_free(service->ipinfo.ipv6.privacy);
+					service->ipinfo.ipv6.privacy = g_variant_dup_string(privacyva, NULL);
+
+					g_variant_unref(privacyv);
+					g_variant_unref(privacyva);
+				}
+
 				g_variant_unref(ipv6);
 				g_variant_unref(ikey_v);
 			}
@@ -889,6 +1047,18 @@ gboolean connman_service_get_ipinfo(connman_service_t *service)
 			g_variant_unref(va);
 		}
 
+		if (!g_strcmp0(key, "Nameservers.Configuration"))
+		{
+			GVariant *v = g_variant_get_child_value(property, 1);
+			GVariant *va = g_variant_get_child_value(v, 0);
+
+			g_strfreev(service->dns_config);
+			service->dns_config = g_variant_dup_strv(va, NULL);
+
+			g_variant_unref(v);
+			g_variant_unref(va);
+		}
+
 		if (!g_strcmp0(key, "HostRoutes"))
 		{
 			GVariant *v = g_variant_get_child_value(property, 1);
@@ -927,8 +1097,10 @@ gboolean connman_service_get_proxyinfo(connman_service_t *service)
 	GVariant *properties;
 	gsize i;
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_service_call_get_properties_sync(service->remote, &properties,
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -1048,9 +1220,66 @@ static void connman_service_advance_state(connman_service_t *service,
 	if (g_strcmp0(service->state, new_state) != 0)
 	{
 		WCALOG_DEBUG("Service %s State changed to %s", service->path, new_state);
+		int old_state = connman_service_get_state(service->state);
 		g_free(service->state);
 		service->state = g_strdup(new_state);
 
+		int state = connman_service_get_state(new_state);
+
+		/* A probe result is only valid for the link it was taken on */
+		if (state != CONNMAN_SERVICE_STATE_READY && state != CONNMAN_SERVICE_STATE_ONLINE)
+		{
+			gateway_probe_cancel(service->gateway_probe);
+			service->gateway_probe = NULL;
+			service->gateway_state = GATEWAY_PROBE_STATE_UNKNOWN;
+
+			dns_probe_cancel(service->dns_probe);
+			service->dns_probe = NULL;
+			dns_probe_health_free(service->dns_health);
+			service->dns_health = NULL;
+
+			/* The order was only meant for this link, the network's
+			 * servers may differ next time */
+			if (service->dns_config_reordered)
+			{
+				gchar *none[] = { NULL };
+
+				connman_service_set_nameservers(service, none);
+			}
+		}
+
+		if (state == CONNMAN_SERVICE_STATE_ASSOCIATION ||
+		        state == CONNMAN_SERVICE_STATE_CONFIGURATION)
+		{
+			/* Not when going through configuration again while connected */
+			if (0 == service->connect_started &&
+			        old_state != CONNMAN_SERVICE_STATE_READY &&
+			        old_state != CONNMAN_SERVICE_STATE_ONLINE)
+			{
+				service->connect_started = g_get_monotonic_time();
+			}
+		}
+		else
+		{
+			if ((state == CONNMAN_SERVICE_STATE_READY ||
+			        state == CONNMAN_SERVICE_STATE_ONLINE) && 0 != service->connect_started)
+			{
+				service->connect_time_ms = (g_get_monotonic_time() -
+				                            service->connect_started) / 1000;
+			}
+
+			service->connect_started = 0;
+		}
+
+		/* Keep the fingerprint while bound settings are being applied, which
+		 * sends the service through configuration again */
+		if (state == CONNMAN_SERVICE_STATE_IDLE ||
+		        state == CONNMAN_SERVICE_STATE_DISCONNECT ||
+		        state == CONNMAN_SERVICE_STATE_FAILURE)
+		{
+			service->has_fingerprint = FALSE;
+		}
+
 		connman_service_set_changed(service,
 		                            CONNMAN_SERVICE_CHANGE_CATEGORY_GETSTATUS |
 		                            CONNMAN_SERVICE_CHANGE_CATEGORY_FINDNETWORKS);
@@ -1059,6 +1288,11 @@ static void connman_service_advance_state(connman_service_t *service,
 		{
 			(service->handle_property_change_fn)((gpointer) service, "State", v);
 		}
+
+		if (state == CONNMAN_SERVICE_STATE_READY && !service->has_fingerprint)
+		{
+			connectionmanager_service_ready(service);
+		}
 	}
 }
 
@@ -1248,7 +1482,9 @@ gboolean connman_service_reject_peer(connman_service_t *service)
 
 	GError *error = NULL;
 
+	dbus_call_begin(service->remote, DBUS_CALL_CONTROL);
 	connman_interface_service_call_reject_peer_sync(service->remote, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -1287,8 +1523,10 @@ GVariant *connman_service_fetch_properties(connman_service_t *service)
 		return NULL;
 	}
 
+	dbus_call_begin(service->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_service_call_get_properties_sync(service->remote, &properties,
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -1572,6 +1810,8 @@ connman_service_t *connman_service_new(GVariant *variant)
 		return NULL;
 	}
 
+	service->connect_time_ms = -1;
+
 	GVariant *service_v = g_variant_get_child_value(variant, 0);
 	service->path = g_variant_dup_string(service_v, NULL);
 	service->identifier = strip_prefix(service->path, "/net/connman/service/");
@@ -1608,6 +1848,17 @@ connman_service_t *connman_service_new(GVariant *variant)
 
 	g_variant_unref(properties);
 
+	/* Left behind by an earlier run, connman would keep the servers of the
+	 * network as static ones otherwise */
+	if (NULL != g_slist_find_custom(reordered_services, service->identifier,
+	                                (GCompareFunc) g_strcmp0))
+	{
+		gchar *none[] = { NULL };
+
+		WCALOG_DEBUG("Dropping reordered nameservers of service %s", service->path);
+		connman_service_set_nameservers(service, none);
+	}
+
 	WCALOG_DEBUG("connman_service_new name %s, path %s", service->name, service->path);
 
 	return service;
@@ -1626,6 +1877,7 @@ void connman_service_free(gpointer data, gpointer user_data)
 
 	if (NULL != service->cancellable)
 	{
+		service->free_pending = TRUE;
 		g_cancellable_cancel(service->cancellable);
 		/* The cancel callback will free service. */
 		return;
@@ -1665,7 +1917,9 @@ void connman_service_free(gpointer data, gpointer user_data)
 	g_free(service->ipinfo.ipv6.method);
 	g_free(service->ipinfo.ipv6.address);
 	g_free(service->ipinfo.ipv6.gateway);
+	g_free(service->ipinfo.ipv6.privacy);
 	g_strfreev(service->ipinfo.dns);
+	g_strfreev(service->dns_config);
 
 	g_free(service->proxyinfo.method);
 	g_free(service->proxyinfo.url);
@@ -1689,6 +1943,14 @@ void connman_service_free(gpointer data, gpointer user_data)
 	service->ssid = NULL;
 	service->ssid_len = 0;
 
+	gateway_probe_cancel(service->gateway_probe);
+	service->gateway_probe = NULL;
+
+	dns_probe_cancel(service->dns_probe);
+	service->dns_probe = NULL;
+	dns_probe_health_free(service->dns_health);
+	service->dns_health = NULL;
+
 	if (service->sighandler_id)
 	{
 		g_signal_handler_disconnect(G_OBJECT(service->remote), service->sighandler_id);
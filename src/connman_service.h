@@ -25,6 +25,8 @@
 #define CONNMAN_SERVICE_H_
 
 #include "connman_common.h"
+#include "gateway_probe.h"
+#include "dns_probe.h"
 
 typedef void (*connman_p2p_request_cb)(gpointer, const int, const gchar *,
                                        const gchar *, const gchar *);
@@ -45,7 +47,8 @@ typedef struct ipv4info
 /**
  * IPv6 information structure for the service
  *
- * Includes method (auto/manual), ip address, prefix length and gateway address
+ * Includes method (auto/manual), ip address, prefix length, gateway address
+ * and the privacy extensions setting ("disabled", "enabled" or "prefered")
  */
 typedef struct ipv6info
 {
@@ -53,6 +56,7 @@ typedef struct ipv6info
 	gchar *address;
 	gint prefix_length;
 	gchar *gateway;
+	gchar *privacy;
 } ipv6info_t;
 
 /**
@@ -165,6 +169,34 @@ typedef struct connman_service
 	gchar *ssid; /* Wifi service ssid, can be null for hidden networks */
 	gsize ssid_len;
 	GCancellable *cancellable;
+	gboolean free_pending; /* Free once the pending connect call returns */
+
+	/* Result of the last gateway reachability probe, reset when the link goes down */
+	gateway_probe_state_t gateway_state;
+	gateway_probe_t *gateway_probe;
+
+	/* Fingerprint of the network, computed once the service is ready, and
+	 * its site, i.e. SSID and gateway only */
+	guint64 fingerprint;
+	guint64 site;
+	gboolean has_fingerprint;
+
+	/* Health of the nameservers (dns_server_health_t), reset when the link
+	 * goes down */
+	GList *dns_health;
+	dns_probe_t *dns_probe;
+	/* "Nameservers.Configuration", empty unless static servers are set */
+	GStrv dns_config;
+	/* The DNS probe wrote the reordered servers of the network into
+	 * dns_config, they are dropped again when the link goes down or, when
+	 * the adapter did not see that, once the service shows up again */
+	gboolean dns_config_reordered;
+
+	/* Monotonic time in us the service entered association, 0 while not
+	 * connecting */
+	gint64 connect_started;
+	/* Time from association to ready of the last connect in ms, -1 if unknown */
+	gint64 connect_time_ms;
 } connman_service_t;
 
 /**
@@ -274,6 +306,8 @@ extern int connman_service_get_state(const gchar *state);
  * Connect to a remote connman service
  *
  * @param[IN]  service A service instance (to connect)
+ * @param[IN]  cancellable Cancels the connect call, e.g. when the luna request
+ *             has gone away. May be NULL.
  * @param[IN]  cb Callback called when connect call returns
  * @param[IN]  user_data User data (if any) to pass with the callback function
  *             See "connman_service_connect_cb" function pointer above
@@ -281,7 +315,8 @@ extern int connman_service_get_state(const gchar *state);
  * @return FALSE if the connect call failed , TRUE otherwise
  */
 extern gboolean connman_service_connect(connman_service_t *service,
-                                        connman_service_connect_cb cb, gpointer user_data);
+                                        GCancellable *cancellable, connman_service_connect_cb cb,
+                                        gpointer user_data);
 
 /**
  * Disconnect from a remote connman service
@@ -344,7 +379,8 @@ extern gboolean connman_service_set_proxy(connman_service_t *service,
         proxyinfo_t *proxyinfo);
 
 /**
- * @brief  Sets nameservers for the connman service
+ * @brief  Sets nameservers for the connman service. They stay configured
+ * until set again, unless connman_service_set_reordered_nameservers was used.
  *
  * @param[IN]  service A service instance
  * @param[IN]  dns DNS server list
@@ -354,6 +390,36 @@ extern gboolean connman_service_set_proxy(connman_service_t *service,
 extern gboolean connman_service_set_nameservers(connman_service_t *service,
         GStrv dns);
 
+/**
+ * @brief  Sets the nameservers of the network in a different order. Unlike
+ * connman_service_set_nameservers the order only holds until the link goes
+ * down, then the nameservers of the network are used again.
+ *
+ * @param[IN]  service A service instance
+ * @param[IN]  dns DNS server list
+ *
+ * @return FALSE if the call to set "Nameservers.Configuration" property failed, TRUE otherwise
+ */
+extern gboolean connman_service_set_reordered_nameservers(
+    connman_service_t *service, GStrv dns);
+
+/**
+ * @brief  Gets the identifiers of the services whose nameservers were set
+ * with connman_service_set_reordered_nameservers and not dropped again yet
+ *
+ * @return Newly allocated list of service identifiers, free with g_strfreev
+ */
+extern GStrv connman_service_dup_reordered_nameservers(void);
+
+/**
+ * @brief  Loads the stored services with reordered nameservers. Their
+ * nameservers are dropped as soon as the services are created, as the link
+ * they were meant for is gone after a restart.
+ *
+ * @param[IN]  identifiers Service identifiers
+ */
+extern void connman_service_load_reordered_nameservers(GStrv identifiers);
+
 /**
  * Set the "autoconnect" flag for a service
  *
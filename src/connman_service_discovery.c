@@ -23,6 +23,7 @@
 
 #include "connman_service_discovery.h"
 #include "connman_manager.h"
+#include "dbus_call.h"
 #include "common.h"
 
 #include "logging.h"
@@ -106,9 +107,11 @@ gboolean connman_service_discovery_request(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_request_discover_upn_pservice_sync(sd,
 			        address,
 			        version, description, NULL, NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		case CONNMAN_SERVICE_TYPE_BONJOUR:
@@ -117,9 +120,11 @@ gboolean connman_service_discovery_request(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_request_discover_bonjour_service_sync(
 			    sd, address,
 			    query, NULL, NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		default:
@@ -157,8 +162,10 @@ gboolean connman_service_discovery_register(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_register_upn_pservice_sync(sd,
 			        description, NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		case CONNMAN_SERVICE_TYPE_BONJOUR:
@@ -167,8 +174,10 @@ gboolean connman_service_discovery_register(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_register_bonjour_service_sync(sd,
 			        query, response, NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		default:
@@ -203,8 +212,10 @@ gboolean connman_service_discovery_remove(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_remove_upn_pservice_sync(sd,
 			        description, NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		case CONNMAN_SERVICE_TYPE_BONJOUR:
@@ -213,8 +224,10 @@ gboolean connman_service_discovery_remove(const connman_service_type type,
 				return FALSE;
 			}
 
+			dbus_call_begin(sd, DBUS_CALL_CONTROL);
 			connman_interface_service_discovery_call_remove_bonjour_service_sync(sd, query,
 			        NULL, &error);
+			dbus_call_end(DBUS_CALL_CONTROL, error);
 			break;
 
 		default:
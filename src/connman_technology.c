@@ -23,6 +23,7 @@
 
 #include "connman_technology.h"
 #include "connman_manager.h"
+#include "dbus_call.h"
 #include "logging.h"
 
 /**
@@ -45,10 +46,12 @@ gboolean connman_technology_set_powered(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_STATE_CHANGE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "Powered",
 	        g_variant_new_variant(g_variant_new_boolean(state)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_STATE_CHANGE, error);
 
 	if (error)
 	{
@@ -86,10 +89,12 @@ extern gboolean connman_technology_set_tethering(connman_technology_t
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_STATE_CHANGE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "Tethering",
 	        g_variant_new_variant(g_variant_new_boolean(state)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_STATE_CHANGE, error);
 
 	if (error)
 	{
@@ -117,10 +122,12 @@ extern gboolean connman_technology_set_tethering_identifier(
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "TetheringIdentifier",
 	        g_variant_new_variant(g_variant_new_string(tethering_identifier)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -149,10 +156,12 @@ extern gboolean connman_technology_set_tethering_passphrase(
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "TetheringPassphrase",
 	        g_variant_new_variant(g_variant_new_string(tethering_passphrase)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -167,6 +176,172 @@ extern gboolean connman_technology_set_tethering_passphrase(
 	return TRUE;
 }
 
+/**
+ * Set the frequency used for tethering (see header for API details)
+ */
+
+gboolean connman_technology_set_tethering_freq(connman_technology_t *technology,
+        gint32 tethering_freq)
+{
+	if (NULL == technology)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
+	connman_interface_technology_call_set_property_sync(technology->remote,
+	        "TetheringFreq",
+	        g_variant_new_variant(g_variant_new_int32(tethering_freq)),
+	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_TETHERING_FREQ_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	technology->tethering_freq = tethering_freq;
+	return TRUE;
+}
+
+/**
+ * Set the security used in tethering (see header for API details)
+ */
+
+gboolean connman_technology_set_tethering_security(connman_technology_t *technology,
+        const gchar *tethering_security)
+{
+	if (NULL == technology)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
+	connman_interface_technology_call_set_property_sync(technology->remote,
+	        "TetheringSecurity",
+	        g_variant_new_variant(g_variant_new_string(tethering_security)),
+	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_TETHERING_SECURITY_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	g_free(technology->tethering_security);
+	technology->tethering_security = g_strdup(tethering_security);
+	return TRUE;
+}
+
+/**
+ * Set if the tethering ssid is hidden (see header for API details)
+ */
+
+gboolean connman_technology_set_tethering_hidden(connman_technology_t *technology,
+        gboolean tethering_hidden)
+{
+	if (NULL == technology)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
+	connman_interface_technology_call_set_property_sync(technology->remote,
+	        "TetheringHidden",
+	        g_variant_new_variant(g_variant_new_boolean(tethering_hidden)),
+	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_TETHERING_HIDDEN_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	technology->tethering_hidden = tethering_hidden;
+	return TRUE;
+}
+
+/**
+ * Set the maximum number of tethering stations (see header for API details)
+ */
+
+gboolean connman_technology_set_tethering_max_stations(connman_technology_t *technology,
+        guint32 tethering_max_stations)
+{
+	if (NULL == technology)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
+	connman_interface_technology_call_set_property_sync(technology->remote,
+	        "TetheringMaxStations",
+	        g_variant_new_variant(g_variant_new_uint32(tethering_max_stations)),
+	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_TETHERING_MAX_STATIONS_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	technology->tethering_max_stations = tethering_max_stations;
+	return TRUE;
+}
+
+/**
+ * Set the regulatory country (see header for API details)
+ */
+
+gboolean connman_technology_set_country_code(connman_technology_t *technology,
+        const gchar *country_code)
+{
+	if (NULL == technology || NULL == country_code)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
+	connman_interface_technology_call_set_property_sync(technology->remote,
+	        "CountryCode", g_variant_new_variant(g_variant_new_string(country_code)),
+	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_COUNTRY_CODE_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	g_free(technology->country_code);
+	technology->country_code = g_strdup(country_code);
+	return TRUE;
+}
+
 /**
  * Cancel any active P2P connection (see header for API details)
  */
@@ -180,8 +355,10 @@ gboolean connman_technology_cancel_p2p(connman_technology_t *technology)
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_CONTROL);
 	connman_interface_technology_call_cancel_p2_p_sync(technology->remote, NULL,
 	        &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -206,8 +383,10 @@ gboolean connman_technology_cancel_wps(connman_technology_t *technology)
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_CONTROL);
 	connman_interface_technology_call_cancel_wps_sync(technology->remote, NULL,
 	        &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -233,8 +412,10 @@ gboolean connman_technology_start_wps(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_CONTROL);
 	connman_interface_technology_call_start_wps_sync(technology->remote,
 	        pin, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -260,10 +441,12 @@ gboolean connman_technology_delete_profile(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "RemovePersistentInfo",
 	        g_variant_new_variant(g_variant_new_string(address)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -289,10 +472,12 @@ gboolean connman_technology_set_multi_channel_mode(connman_technology_t
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "MultiChannelSchedMode",
 	        g_variant_new_variant(g_variant_new_uint32(mode)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -318,10 +503,12 @@ gboolean connman_technology_set_p2p(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_STATE_CHANGE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "P2P",
 	        g_variant_new_variant(g_variant_new_boolean(state)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_STATE_CHANGE, error);
 
 	if (error)
 	{
@@ -348,10 +535,12 @@ gboolean connman_technology_set_p2p_identifier(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "P2PIdentifier",
 	        g_variant_new_variant(g_variant_new_string(device_name)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -380,10 +569,12 @@ gboolean connman_technology_set_wfd(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "WFD",
 	        g_variant_new_variant(g_variant_new_boolean(state)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -410,10 +601,12 @@ gboolean connman_technology_set_wfd_devtype(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "WFDDevType",
 	        g_variant_new_variant(g_variant_new_uint16(devtype)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -440,6 +633,7 @@ static void connman_technology_scan_callback(GObject *source_object,
 
 	/* Print eror if any, no functional purpose */
 	connman_interface_technology_call_scan_finish(proxy, res, &error);
+	dbus_call_end(DBUS_CALL_SCAN, error);
 
 	if (error)
 	{
@@ -478,6 +672,7 @@ gboolean connman_technology_scan_network(connman_technology_t *technology,
 	}
 
 	technology->calls_pending += 1;
+	dbus_call_begin(technology->remote, DBUS_CALL_SCAN);
 	connman_interface_technology_call_scan(technology->remote,
 	                                       NULL, connman_technology_scan_callback,
 	                                       (gpointer)technology);
@@ -495,8 +690,10 @@ gboolean connman_technology_remove_saved_profiles(connman_technology_t
 		return FALSE;
 	}
 
+	dbus_call_begin(technology->remote, DBUS_CALL_CONTROL);
 	connman_interface_technology_call_remove_saved_services_sync(technology->remote,
 	        exception, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
 
 	if (error)
 	{
@@ -528,10 +725,12 @@ gboolean connman_technology_set_listen_params(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "P2PListenParams",
 	        g_variant_new_variant(listen_params_v),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -553,10 +752,12 @@ gboolean connman_technology_set_listen_channel(connman_technology_t *technology,
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 	        "P2PListenChannel",
 	        g_variant_new_variant(g_variant_new_uint32(listen_channel)),
 	        NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 
 	if (error)
 	{
@@ -576,10 +777,12 @@ gboolean connman_technology_set_go_intent(connman_technology_t *technology, cons
 
 	GError *error = NULL;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_WRITE);
 	connman_interface_technology_call_set_property_sync(technology->remote,
 			"P2PGOIntent",
 			g_variant_new_variant(g_variant_new_uint32(go_intent)),
 			NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_WRITE, error);
 	if (error)
 	{
 		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_SET_GO_INTENT_ERROR, error->message);
@@ -679,6 +882,23 @@ static void set_property_value(connman_technology_t *technology,
 		g_free(technology->tethering_passphrase);
 		technology->tethering_passphrase = g_variant_dup_string(val, NULL);
 	}
+	else if (!g_strcmp0(key, "TetheringFreq"))
+	{
+		technology->tethering_freq = g_variant_get_int32(val);
+	}
+	else if (!g_strcmp0(key, "TetheringSecurity"))
+	{
+		g_free(technology->tethering_security);
+		technology->tethering_security = g_variant_dup_string(val, NULL);
+	}
+	else if (!g_strcmp0(key, "TetheringHidden"))
+	{
+		technology->tethering_hidden = g_variant_get_boolean(val);
+	}
+	else if (!g_strcmp0(key, "TetheringMaxStations"))
+	{
+		technology->tethering_max_stations = g_variant_get_uint32(val);
+	}
 	else if (!g_strcmp0(key, "CountryCode"))
 	{
 		g_free(technology->country_code);
@@ -734,8 +954,10 @@ static GVariant* connman_technology_get_properties(connman_technology_t *technol
 	GVariant *properties;
 	gsize i;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_technology_call_get_properties_sync(technology->remote,
 	        &properties, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -797,8 +1019,10 @@ gboolean connman_technology_get_interface_properties(connman_technology_t
 	GVariant *properties;
 	gsize i;
 
+	dbus_call_begin(technology->remote, DBUS_CALL_PROPERTY_READ);
 	connman_interface_technology_call_get_interface_properties_sync(
 	    technology->remote, interface, &properties, NULL, &error);
+	dbus_call_end(DBUS_CALL_PROPERTY_READ, error);
 
 	if (error)
 	{
@@ -866,7 +1090,7 @@ void connman_technology_register_property_changed_cb(connman_technology_t
  * Register a handler for the technology's "TetheringStaAuthorized" signal.
  */
 void connman_technology_register_sta_authorized_cb(connman_technology_t
-        *technology, connman_common_cb cb, gpointer user_data)
+        *technology, connman_station_cb cb, gpointer user_data)
 {
 	if (!cb || !technology)
 	{
@@ -878,13 +1102,13 @@ void connman_technology_register_sta_authorized_cb(connman_technology_t
 }
 
 static void tethering_sta_authorized_cb(ConnmanInterfaceTechnology *proxy,
-                                        gpointer user_data)
+                                        const gchar *address, gpointer user_data)
 {
 	connman_technology_t *technology = user_data;
 
 	if (technology->handle_sta_authorized_fn)
 	{
-		technology->handle_sta_authorized_fn(technology->sta_authorized_data);
+		technology->handle_sta_authorized_fn(technology->sta_authorized_data, address);
 	}
 }
 
@@ -892,7 +1116,7 @@ static void tethering_sta_authorized_cb(ConnmanInterfaceTechnology *proxy,
  * Register a handler for the technology's "TetheringStaUnauthorized" signal.
  */
 void connman_technology_register_sta_deauthorized_cb(connman_technology_t
-        *technology, connman_common_cb cb, gpointer user_data)
+        *technology, connman_station_cb cb, gpointer user_data)
 {
 	if (!cb || !technology)
 	{
@@ -904,16 +1128,47 @@ void connman_technology_register_sta_deauthorized_cb(connman_technology_t
 }
 
 static void tethering_sta_deunauthorized_cb(ConnmanInterfaceTechnology *proxy,
-        gpointer user_data)
+        const gchar *address, gpointer user_data)
 {
 	connman_technology_t *technology = user_data;
 
 	if (technology->handle_sta_deauthorized_fn)
 	{
-		technology->handle_sta_deauthorized_fn(technology->sta_deauthorized_data);
+		technology->handle_sta_deauthorized_fn(technology->sta_deauthorized_data,
+		                                       address);
 	}
 }
 
+/**
+ * Disconnect a station from the tethering access point (see header for API details)
+ */
+
+gboolean connman_technology_disconnect_station(connman_technology_t *technology,
+        const gchar *address)
+{
+	if (NULL == technology || NULL == address)
+	{
+		return FALSE;
+	}
+
+	GError *error = NULL;
+
+	dbus_call_begin(technology->remote, DBUS_CALL_CONTROL);
+	connman_interface_technology_call_disconnect_station_sync(technology->remote,
+	        address, NULL, &error);
+	dbus_call_end(DBUS_CALL_CONTROL, error);
+
+	if (error)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_TECHNOLOGY_DISCONNECT_STATION_ERROR,
+		                      error->message);
+		g_error_free(error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
 /**
  * Create a new technology instance and set its properties (see header for API details)
  */
@@ -1035,6 +1290,7 @@ void connman_technology_free(connman_technology_t *technology)
 	g_free(technology->diagnostic_info);
 	g_free(technology->tethering_identifier);
 	g_free(technology->tethering_passphrase);
+	g_free(technology->tethering_security);
 
 	g_object_unref(technology->remote);
 	technology->remote = NULL;
@@ -48,6 +48,10 @@ typedef struct connman_technology
 	gchar *diagnostic_info;
 	gchar *tethering_identifier;
 	gchar *tethering_passphrase;
+	gint32 tethering_freq;
+	gchar *tethering_security;
+	gboolean tethering_hidden;
+	guint32 tethering_max_stations;
 	gboolean powered;
 	gboolean connected;
 	gboolean tethering;
@@ -64,10 +68,10 @@ typedef struct connman_technology
 	gulong property_changed_sighandler;
 	connman_property_changed_cb handle_property_changed_fn;
 	gulong sta_authorized_sighandler;
-	connman_common_cb handle_sta_authorized_fn;
+	connman_station_cb handle_sta_authorized_fn;
 	gpointer sta_authorized_data;
 	gulong sta_deauthorized_sighandler;
-	connman_common_cb handle_sta_deauthorized_fn;
+	connman_station_cb handle_sta_deauthorized_fn;
 	gpointer sta_deauthorized_data;
 	connman_common_cb handle_after_scan_fn;
 	gpointer after_scan_data;
@@ -136,6 +140,61 @@ extern gboolean connman_technology_set_tethering_identifier(
 extern gboolean connman_technology_set_tethering_passphrase(
     connman_technology_t *technology, const gchar *tethering_passphrase);
 
+/**
+ * Set the frequency of the access point used in tethering
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  tethering_freq Frequency in MHz
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_set_tethering_freq(
+    connman_technology_t *technology, gint32 tethering_freq);
+
+/**
+ * Set the security of the access point used in tethering
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  tethering_security One of "none", "psk", "sae" or "psk-sae"
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_set_tethering_security(
+    connman_technology_t *technology, const gchar *tethering_security);
+
+/**
+ * Set if the ssid of the access point used in tethering is hidden
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  tethering_hidden TRUE to hide the ssid, FALSE to broadcast it
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_set_tethering_hidden(
+    connman_technology_t *technology, gboolean tethering_hidden);
+
+/**
+ * Set the maximum number of stations the access point used in tethering accepts
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  tethering_max_stations Maximum number of stations, 0 for the driver default
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_set_tethering_max_stations(
+    connman_technology_t *technology, guint32 tethering_max_stations);
+
+/**
+ * Set the country whose regulatory rules the wifi radio follows
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  country_code ISO 3166 alpha2 code, "00" for the world domain
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_set_country_code(connman_technology_t
+        *technology, const gchar *country_code);
+
 /**
  * Enable/disable wifi-direct technology
  *
@@ -341,7 +400,7 @@ extern void connman_technology_register_property_changed_cb(
  * @param[IN] user_data User data passed with the callback when called.
  */
 extern void connman_technology_register_sta_authorized_cb(
-    connman_technology_t *technology, connman_common_cb cb, gpointer user_data);
+    connman_technology_t *technology, connman_station_cb cb, gpointer user_data);
 
 /**
  * @brief Register a handler for the technology's "TetheringStaDeauthorized" signal.
@@ -351,7 +410,18 @@ extern void connman_technology_register_sta_authorized_cb(
  * @param[IN] user_data User data passed with the callback when called.
  */
 extern void connman_technology_register_sta_deauthorized_cb(
-    connman_technology_t *technology, connman_common_cb cb, gpointer user_data);
+    connman_technology_t *technology, connman_station_cb cb, gpointer user_data);
+
+/**
+ * Disconnect a station from the tethering access point of the given technology
+ *
+ * @param[IN]  technology A technology instance
+ * @param[IN]  address MAC address of the station
+ *
+ * @return FALSE for any error, TRUE otherwise
+ */
+extern gboolean connman_technology_disconnect_station(
+    connman_technology_t *technology, const gchar *address);
 
 /**
  * Fetch all the properties for a technology instance and save the new values
@@ -0,0 +1,249 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  dbus_call.c
+ *
+ * @brief Deadlines and cancellation of the D-Bus calls to connman
+ *
+ * Without a deadline a synchronous call blocks the main loop for the D-Bus
+ * default of 25 seconds if connman is slow. Each kind of call gets a
+ * deadline of its own instead, e.g. reading properties is expected to be
+ * fast while powering a device may take a while.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "dbus_call.h"
+
+typedef struct dbus_call_info
+{
+	const gchar *name;
+	gint deadline; /* ms */
+} dbus_call_info_t;
+
+static const dbus_call_info_t call_infos[DBUS_CALL_LAST] =
+{
+	[DBUS_CALL_PROPERTY_READ]  = { "propertyRead",    500 },
+	[DBUS_CALL_PROPERTY_WRITE] = { "propertyWrite",  2000 },
+	/* connman answers once the device is up, which takes up to 10 seconds */
+	[DBUS_CALL_STATE_CHANGE]   = { "stateChange",   10000 },
+	[DBUS_CALL_CONTROL]        = { "control",        5000 },
+	[DBUS_CALL_SCAN]           = { "scan",          15000 },
+	/* connman answers once the service is ready, including DHCP */
+	[DBUS_CALL_CONNECT]        = { "connect",       25000 },
+};
+
+static dbus_call_stats_t call_stats[DBUS_CALL_LAST];
+
+static dbus_call_timeout_cb timeout_cb = NULL;
+static gpointer timeout_cb_data = NULL;
+
+/* Scope -> GSList of GCancellable */
+static GHashTable *scopes = NULL;
+
+/**
+ * Get the deadline of a kind of call (see header for API details)
+ */
+
+gint dbus_call_get_deadline(dbus_call_t call)
+{
+	g_return_val_if_fail(call < DBUS_CALL_LAST, -1);
+
+	return call_infos[call].deadline;
+}
+
+/**
+ * Get the name of a kind of call (see header for API details)
+ */
+
+const gchar *dbus_call_get_name(dbus_call_t call)
+{
+	g_return_val_if_fail(call < DBUS_CALL_LAST, NULL);
+
+	return call_infos[call].name;
+}
+
+/**
+ * Prepare a proxy for a call (see header for API details)
+ */
+
+void dbus_call_begin(gpointer proxy, dbus_call_t call)
+{
+	g_return_if_fail(call < DBUS_CALL_LAST);
+
+	call_stats[call].calls++;
+
+	if (NULL != proxy)
+	{
+		g_dbus_proxy_set_default_timeout(G_DBUS_PROXY(proxy),
+		                                 call_infos[call].deadline);
+	}
+}
+
+/**
+ * Account for the result of a call (see header for API details)
+ */
+
+gboolean dbus_call_end(dbus_call_t call, const GError *error)
+{
+	g_return_val_if_fail(call < DBUS_CALL_LAST, FALSE);
+
+	if (NULL == error)
+	{
+		return FALSE;
+	}
+
+	if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+	{
+		call_stats[call].cancelled++;
+		return FALSE;
+	}
+
+	if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT))
+	{
+		return FALSE;
+	}
+
+	call_stats[call].timeouts++;
+
+	if (NULL != timeout_cb)
+	{
+		timeout_cb(call, &call_stats[call], timeout_cb_data);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Get the counters of a kind of call (see header for API details)
+ */
+
+const dbus_call_stats_t *dbus_call_get_stats(dbus_call_t call)
+{
+	g_return_val_if_fail(call < DBUS_CALL_LAST, NULL);
+
+	return &call_stats[call];
+}
+
+/**
+ * Reset the counters of all kinds of calls (see header for API details)
+ */
+
+void dbus_call_reset_stats(void)
+{
+	memset(call_stats, 0, sizeof(call_stats));
+}
+
+/**
+ * Set the timeout callback (see header for API details)
+ */
+
+void dbus_call_set_timeout_callback(dbus_call_timeout_cb cb,
+                                    gpointer user_data)
+{
+	timeout_cb = cb;
+	timeout_cb_data = user_data;
+}
+
+/**
+ * Add a cancellable to a scope (see header for API details)
+ */
+
+void dbus_call_scope_add(const gchar *scope, GCancellable *cancellable)
+{
+	GSList *cancellables;
+
+	if (NULL == scope || NULL == cancellable)
+	{
+		return;
+	}
+
+	if (NULL == scopes)
+	{
+		scopes = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	}
+
+	cancellables = g_hash_table_lookup(scopes, scope);
+	cancellables = g_slist_prepend(cancellables, g_object_ref(cancellable));
+	g_hash_table_insert(scopes, g_strdup(scope), cancellables);
+}
+
+/**
+ * Remove a cancellable from a scope (see header for API details)
+ */
+
+void dbus_call_scope_remove(const gchar *scope, GCancellable *cancellable)
+{
+	GSList *cancellables, *link;
+
+	if (NULL == scopes || NULL == scope || NULL == cancellable)
+	{
+		return;
+	}
+
+	cancellables = g_hash_table_lookup(scopes, scope);
+	link = g_slist_find(cancellables, cancellable);
+
+	if (NULL == link)
+	{
+		return;
+	}
+
+	cancellables = g_slist_delete_link(cancellables, link);
+	g_object_unref(cancellable);
+
+	if (NULL == cancellables)
+	{
+		g_hash_table_remove(scopes, scope);
+	}
+	else
+	{
+		g_hash_table_insert(scopes, g_strdup(scope), cancellables);
+	}
+}
+
+/**
+ * Cancel all cancellables of a scope (see header for API details)
+ */
+
+void dbus_call_scope_cancel(const gchar *scope)
+{
+	GSList *cancellables, *iter;
+
+	if (NULL == scopes || NULL == scope)
+	{
+		return;
+	}
+
+	cancellables = g_hash_table_lookup(scopes, scope);
+
+	if (NULL == cancellables)
+	{
+		return;
+	}
+
+	/* Cancelling runs callbacks, which may touch the scope again */
+	g_hash_table_remove(scopes, scope);
+
+	for (iter = cancellables; NULL != iter; iter = iter->next)
+	{
+		g_cancellable_cancel(iter->data);
+	}
+
+	g_slist_free_full(cancellables, g_object_unref);
+}
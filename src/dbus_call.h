@@ -0,0 +1,144 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  dbus_call.h
+ *
+ * @brief Header file defining the deadlines of the D-Bus calls to connman,
+ *        their timeout counters and the cancellation of calls whose luna
+ *        request has gone away
+ *
+ */
+
+#ifndef _DBUS_CALL_H_
+#define _DBUS_CALL_H_
+
+#include <gio/gio.h>
+
+/**
+ * Kind of a D-Bus call. Each kind has its own deadline and counters.
+ */
+typedef enum
+{
+	DBUS_CALL_PROPERTY_READ = 0, /* GetProperties, GetServices, ... */
+	DBUS_CALL_PROPERTY_WRITE,    /* SetProperty of plain settings */
+	DBUS_CALL_STATE_CHANGE,      /* SetProperty which powers or reconfigures a device */
+	DBUS_CALL_CONTROL,           /* Disconnect, Remove, agent and counter registration, ... */
+	DBUS_CALL_SCAN,
+	DBUS_CALL_CONNECT,
+	DBUS_CALL_LAST,
+} dbus_call_t;
+
+typedef struct dbus_call_stats
+{
+	guint calls;
+	guint timeouts;
+	guint cancelled;
+} dbus_call_stats_t;
+
+/**
+ * Callback called whenever a call missed its deadline
+ */
+typedef void (*dbus_call_timeout_cb)(dbus_call_t call,
+                                     const dbus_call_stats_t *stats, gpointer user_data);
+
+/**
+ * Get the deadline of a kind of call
+ *
+ * @param[IN]  call Kind of call
+ *
+ * @return Deadline in ms
+ */
+extern gint dbus_call_get_deadline(dbus_call_t call);
+
+/**
+ * Get the name of a kind of call for logging and the luna API
+ *
+ * @param[IN]  call Kind of call
+ *
+ * @return Name of the kind of call
+ */
+extern const gchar *dbus_call_get_name(dbus_call_t call);
+
+/**
+ * Prepare a proxy for a call. Generated proxy calls use the default timeout
+ * of the proxy, so it is set to the deadline of the kind of call. Has to be
+ * called right before each synchronous or asynchronous call.
+ *
+ * @param[IN]  proxy GDBusProxy the call is made on
+ * @param[IN]  call Kind of call
+ */
+extern void dbus_call_begin(gpointer proxy, dbus_call_t call);
+
+/**
+ * Account for the result of a call
+ *
+ * @param[IN]  call Kind of call
+ * @param[IN]  error Error the call returned, NULL on success
+ *
+ * @return TRUE if the call missed its deadline, FALSE otherwise
+ */
+extern gboolean dbus_call_end(dbus_call_t call, const GError *error);
+
+/**
+ * Get the counters of a kind of call
+ *
+ * @param[IN]  call Kind of call
+ *
+ * @return Counters owned by the module
+ */
+extern const dbus_call_stats_t *dbus_call_get_stats(dbus_call_t call);
+
+/**
+ * Reset the counters of all kinds of calls
+ */
+extern void dbus_call_reset_stats(void);
+
+/**
+ * Set the callback called whenever a call missed its deadline
+ *
+ * @param[IN]  cb Callback, NULL to unset it
+ * @param[IN]  user_data User data passed to cb
+ */
+extern void dbus_call_set_timeout_callback(dbus_call_timeout_cb cb,
+        gpointer user_data);
+
+/**
+ * Add a cancellable to a scope, e.g. the unique token of a luna message.
+ * The cancellable is cancelled when the scope is cancelled.
+ *
+ * @param[IN]  scope Scope
+ * @param[IN]  cancellable Cancellable to add, referenced until it is removed
+ */
+extern void dbus_call_scope_add(const gchar *scope, GCancellable *cancellable);
+
+/**
+ * Remove a cancellable from a scope without cancelling it
+ *
+ * @param[IN]  scope Scope
+ * @param[IN]  cancellable Cancellable to remove
+ */
+extern void dbus_call_scope_remove(const gchar *scope,
+                                   GCancellable *cancellable);
+
+/**
+ * Cancel all cancellables of a scope and forget about the scope
+ *
+ * @param[IN]  scope Scope
+ */
+extern void dbus_call_scope_cancel(const gchar *scope);
+
+#endif /* _DBUS_CALL_H_ */
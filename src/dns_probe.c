@@ -0,0 +1,550 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  dns_probe.c
+ *
+ * @brief Measures the answer time of the nameservers of a link, so a slow or
+ *        dead first server doesn't make every lookup wait for the resolver
+ *        timeout before it falls back to the next one.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include "dns_probe.h"
+
+#define DNS_HEADER_LEN      12
+#define DNS_FLAG_QR         0x80    /* in the third byte of the header */
+#define DNS_FLAG_RD         0x01
+#define DNS_RCODE_MASK      0x0f    /* in the fourth byte of the header */
+#define DNS_RCODE_SERVFAIL  2
+#define DNS_RCODE_REFUSED   5
+#define DNS_TYPE_NS         2
+#define DNS_CLASS_IN        1
+
+typedef struct dns_probe_query
+{
+	dns_probe_t *probe;
+	int fd;
+	guint watch;
+	guint16 id;
+} dns_probe_query_t;
+
+struct dns_probe
+{
+	GStrv servers;
+	gint *latencies;
+	dns_probe_query_t *queries;
+	guint count;
+	guint pending;
+	gint64 start;
+	guint timeout;
+	dns_probe_cb cb;
+	gpointer user_data;
+};
+
+/**
+ * Build the probe query (see header for API details)
+ */
+
+gsize dns_probe_build_query(guint8 *buf, guint16 id)
+{
+	memset(buf, 0, DNS_PROBE_QUERY_LEN);
+
+	buf[0] = id >> 8;
+	buf[1] = id & 0xff;
+	/* Ask for recursion, so a forwarder answers from its cache as well */
+	buf[2] = DNS_FLAG_RD;
+	/* One question */
+	buf[5] = 1;
+
+	/* The root name is a single empty label, buf[12] */
+	buf[14] = DNS_TYPE_NS;
+	buf[16] = DNS_CLASS_IN;
+
+	return DNS_PROBE_QUERY_LEN;
+}
+
+/**
+ * Check for an answer to the probe query (see header for API details)
+ */
+
+gboolean dns_probe_is_answer(const guint8 *buf, gsize len, guint16 id)
+{
+	guint rcode;
+
+	if (len < DNS_HEADER_LEN)
+	{
+		return FALSE;
+	}
+
+	if (((buf[0] << 8) | buf[1]) != id || !(buf[2] & DNS_FLAG_QR))
+	{
+		return FALSE;
+	}
+
+	/* A server which can't resolve doesn't help the resolver either */
+	rcode = buf[3] & DNS_RCODE_MASK;
+
+	return rcode != DNS_RCODE_SERVFAIL && rcode != DNS_RCODE_REFUSED;
+}
+
+static void probe_free(dns_probe_t *probe)
+{
+	guint i;
+
+	for (i = 0; i < probe->count; i++)
+	{
+		if (probe->queries[i].watch)
+		{
+			g_source_remove(probe->queries[i].watch);
+		}
+
+		if (probe->queries[i].fd >= 0)
+		{
+			close(probe->queries[i].fd);
+		}
+	}
+
+	if (probe->timeout)
+	{
+		g_source_remove(probe->timeout);
+	}
+
+	g_strfreev(probe->servers);
+	g_free(probe->latencies);
+	g_free(probe->queries);
+	g_free(probe);
+}
+
+static void probe_finish(dns_probe_t *probe)
+{
+	/* The callback may start a new probe, so this one is gone before calling it */
+	dns_probe_cb cb = probe->cb;
+	gpointer user_data = probe->user_data;
+	GStrv servers = probe->servers;
+	gint *latencies = probe->latencies;
+
+	probe->servers = NULL;
+	probe->latencies = NULL;
+	probe_free(probe);
+
+	cb(servers, latencies, user_data);
+
+	g_strfreev(servers);
+	g_free(latencies);
+}
+
+static gboolean probe_timeout_cb(gpointer user_data)
+{
+	dns_probe_t *probe = user_data;
+
+	probe->timeout = 0;
+	probe_finish(probe);
+
+	return FALSE;
+}
+
+static gboolean answer_cb(GIOChannel *channel, GIOCondition cond,
+                          gpointer user_data)
+{
+	dns_probe_query_t *query = user_data;
+	dns_probe_t *probe = query->probe;
+	guint8 buf[512];
+	ssize_t len;
+
+	if (cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP))
+	{
+		/* e.g. port unreachable, the server counts as lost */
+		query->watch = 0;
+		return FALSE;
+	}
+
+	while ((len = recv(query->fd, buf, sizeof(buf), 0)) > 0)
+	{
+		if (!dns_probe_is_answer(buf, len, query->id))
+		{
+			continue;
+		}
+
+		probe->latencies[query - probe->queries] =
+		    (g_get_monotonic_time() - probe->start) / 1000;
+		query->watch = 0;
+
+		if (0 == --probe->pending)
+		{
+			probe_finish(probe);
+		}
+
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+static guint add_fd_watch(int fd, GIOFunc func, gpointer user_data)
+{
+	GIOChannel *channel = g_io_channel_unix_new(fd);
+	guint watch = g_io_add_watch(channel, G_IO_IN | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+	                             func, user_data);
+
+	/* The watch holds its own reference, the fd is closed by probe_free */
+	g_io_channel_unref(channel);
+
+	return watch;
+}
+
+static gboolean send_query(dns_probe_query_t *query, const gchar *iface,
+                           const gchar *server, guint16 port)
+{
+	struct sockaddr_storage addr;
+	struct sockaddr_in *sin = (struct sockaddr_in *) &addr;
+	struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &addr;
+	socklen_t addr_len;
+	guint8 buf[DNS_PROBE_QUERY_LEN];
+	gsize len;
+
+	memset(&addr, 0, sizeof(addr));
+
+	if (inet_pton(AF_INET, server, &sin->sin_addr) == 1)
+	{
+		sin->sin_family = AF_INET;
+		sin->sin_port = htons(port);
+		addr_len = sizeof(struct sockaddr_in);
+	}
+	else if (inet_pton(AF_INET6, server, &sin6->sin6_addr) == 1)
+	{
+		sin6->sin6_family = AF_INET6;
+		sin6->sin6_port = htons(port);
+		addr_len = sizeof(struct sockaddr_in6);
+	}
+	else
+	{
+		return FALSE;
+	}
+
+	query->fd = socket(addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+	                   0);
+
+	if (query->fd < 0)
+	{
+		return FALSE;
+	}
+
+	/* A connected socket only receives datagrams from the server */
+	if ((NULL != iface && setsockopt(query->fd, SOL_SOCKET, SO_BINDTODEVICE, iface,
+	                                 strlen(iface) + 1) < 0) ||
+	        connect(query->fd, (struct sockaddr *) &addr, addr_len) < 0)
+	{
+		return FALSE;
+	}
+
+	query->id = g_random_int_range(0, G_MAXUINT16 + 1);
+	len = dns_probe_build_query(buf, query->id);
+
+	if (send(query->fd, buf, len, 0) < 0)
+	{
+		return FALSE;
+	}
+
+	query->watch = add_fd_watch(query->fd, answer_cb, query);
+	return TRUE;
+}
+
+/**
+ * Start probing nameservers (see header for API details)
+ */
+
+dns_probe_t *dns_probe_start(const gchar *iface, GStrv servers,
+                             guint16 port, guint timeout_ms, dns_probe_cb cb, gpointer user_data)
+{
+	dns_probe_t *probe;
+	guint i;
+
+	if (NULL == servers || NULL == servers[0] || NULL == cb)
+	{
+		return NULL;
+	}
+
+	probe = g_new0(dns_probe_t, 1);
+	probe->servers = g_strdupv(servers);
+	probe->count = g_strv_length(servers);
+	probe->latencies = g_new(gint, probe->count);
+	probe->queries = g_new0(dns_probe_query_t, probe->count);
+	probe->cb = cb;
+	probe->user_data = user_data;
+	probe->start = g_get_monotonic_time();
+
+	for (i = 0; i < probe->count; i++)
+	{
+		probe->latencies[i] = -1;
+		probe->queries[i].probe = probe;
+		probe->queries[i].fd = -1;
+
+		/* A failing socket only loses the query to its server */
+		if (send_query(&probe->queries[i], iface, servers[i], port))
+		{
+			probe->pending++;
+		}
+		else if (probe->queries[i].fd >= 0)
+		{
+			close(probe->queries[i].fd);
+			probe->queries[i].fd = -1;
+		}
+	}
+
+	if (0 == probe->pending)
+	{
+		probe_free(probe);
+		return NULL;
+	}
+
+	probe->timeout = g_timeout_add(timeout_ms, probe_timeout_cb, probe);
+
+	return probe;
+}
+
+/**
+ * Cancel a running probe (see header for API details)
+ */
+
+void dns_probe_cancel(dns_probe_t *probe)
+{
+	if (NULL == probe)
+	{
+		return;
+	}
+
+	probe_free(probe);
+}
+
+static void health_free(dns_server_health_t *health)
+{
+	g_free(health->address);
+	g_free(health);
+}
+
+/**
+ * Find the health of a server (see header for API details)
+ */
+
+dns_server_health_t *dns_probe_health_find(GList *health, const gchar *address)
+{
+	GList *iter;
+
+	for (iter = health; NULL != iter; iter = iter->next)
+	{
+		dns_server_health_t *server = iter->data;
+
+		if (!g_strcmp0(server->address, address))
+		{
+			return server;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Match the health of the servers to the current nameservers (see header
+ * for API details)
+ */
+
+GList *dns_probe_health_sync(GList *health, GStrv servers)
+{
+	GList *synced = NULL;
+	guint i;
+
+	for (i = 0; NULL != servers && NULL != servers[i]; i++)
+	{
+		dns_server_health_t *server = dns_probe_health_find(health, servers[i]);
+
+		if (NULL != dns_probe_health_find(synced, servers[i]))
+		{
+			continue;
+		}
+
+		if (NULL != server)
+		{
+			health = g_list_remove(health, server);
+		}
+		else
+		{
+			server = g_new0(dns_server_health_t, 1);
+			server->address = g_strdup(servers[i]);
+			server->latency = -1;
+		}
+
+		synced = g_list_append(synced, server);
+	}
+
+	dns_probe_health_free(health);
+
+	return synced;
+}
+
+/**
+ * Add the result of a probe to the moving averages (see header for API
+ * details)
+ */
+
+void dns_probe_health_add_sample(dns_server_health_t *health, gint latency_ms)
+{
+	gboolean lost = latency_ms < 0;
+
+	health->probes++;
+
+	if (lost)
+	{
+		health->failures++;
+	}
+
+	/* Start from the first sample instead of pulling it towards 0 */
+	if (1 == health->probes)
+	{
+		health->failure_rate = lost ? 1.0 : 0.0;
+	}
+	else
+	{
+		health->failure_rate += DNS_PROBE_EWMA_WEIGHT * ((lost ? 1.0 : 0.0) -
+		                        health->failure_rate);
+	}
+
+	if (lost)
+	{
+		return;
+	}
+
+	if (health->latency < 0)
+	{
+		health->latency = latency_ms;
+	}
+	else
+	{
+		health->latency += DNS_PROBE_EWMA_WEIGHT * (latency_ms - health->latency);
+	}
+}
+
+/**
+ * Get the expected lookup time with the server first (see header for API
+ * details)
+ */
+
+gdouble dns_probe_health_score(const dns_server_health_t *health,
+                               guint timeout_ms)
+{
+	/* A server which never answered is as good as a dead one */
+	gdouble latency = health->latency < 0 ? timeout_ms : health->latency;
+
+	return (1.0 - health->failure_rate) * latency + health->failure_rate *
+	       timeout_ms;
+}
+
+/**
+ * Update the reorder counters and check for a better first server (see
+ * header for API details)
+ */
+
+GStrv dns_probe_health_reorder(GList *health, guint timeout_ms)
+{
+	dns_server_health_t *first, *best = NULL;
+	gdouble first_score, best_score = 0;
+	GList *iter;
+	GStrv order;
+	guint i = 0;
+
+	if (NULL == health || NULL == health->next)
+	{
+		return NULL;
+	}
+
+	first = health->data;
+	first_score = dns_probe_health_score(first, timeout_ms);
+
+	for (iter = health->next; NULL != iter; iter = iter->next)
+	{
+		dns_server_health_t *server = iter->data;
+		gdouble score = dns_probe_health_score(server, timeout_ms);
+
+		/* Only servers which answered can be better */
+		if (server->latency >= 0 && (NULL == best || score < best_score))
+		{
+			best = server;
+			best_score = score;
+		}
+	}
+
+	/* Only the leading candidate keeps counting, so a change needs the same
+	 * server to win every time */
+	for (iter = health->next; NULL != iter; iter = iter->next)
+	{
+		dns_server_health_t *server = iter->data;
+
+		if (server != best)
+		{
+			server->better_rounds = 0;
+		}
+	}
+
+	if (NULL == best || best_score > first_score * DNS_PROBE_REORDER_RATIO ||
+	        first_score - best_score < DNS_PROBE_REORDER_MIN_MS)
+	{
+		if (NULL != best)
+		{
+			best->better_rounds = 0;
+		}
+
+		return NULL;
+	}
+
+	if (++best->better_rounds < DNS_PROBE_REORDER_ROUNDS)
+	{
+		return NULL;
+	}
+
+	best->better_rounds = 0;
+
+	/* The best server goes first, the others keep their order */
+	order = g_new0(gchar *, g_list_length(health) + 1);
+	order[i++] = g_strdup(best->address);
+
+	for (iter = health; NULL != iter; iter = iter->next)
+	{
+		dns_server_health_t *server = iter->data;
+
+		if (server != best)
+		{
+			order[i++] = g_strdup(server->address);
+		}
+	}
+
+	return order;
+}
+
+/**
+ * Free a list of dns_server_health_t (see header for API details)
+ */
+
+void dns_probe_health_free(GList *health)
+{
+	g_list_free_full(health, (GDestroyNotify) health_free);
+}
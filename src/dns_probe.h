@@ -0,0 +1,200 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  dns_probe.h
+ *
+ * @brief Header file defining the DNS server probe, which measures how fast
+ *        the nameservers of a link answer and keeps the fastest one first
+ *
+ * Each probe sends a query for the root name servers (". IN NS") to every
+ * nameserver. Every recursive resolver has them cached, so the answer time
+ * is the round trip to the server and not the time it takes to resolve a
+ * name. The answer times and lost queries are smoothed into an exponentially
+ * weighted moving average (EWMA) per server.
+ *
+ */
+
+#ifndef _DNS_PROBE_H_
+#define _DNS_PROBE_H_
+
+#include <glib.h>
+
+/**
+ * Default time (in ms) a server has to answer within, see the dnsProbeTimeout
+ * runtime parameter
+ */
+#define DNS_PROBE_TIMEOUT_MS            1000
+
+/**
+ * Default time (in s) between two probes of a connected service, see the
+ * dnsProbeInterval runtime parameter
+ */
+#define DNS_PROBE_INTERVAL              60
+
+#define DNS_PROBE_PORT                  53
+
+/**
+ * Weight of a new sample in the moving averages
+ */
+#define DNS_PROBE_EWMA_WEIGHT           0.3
+
+/**
+ * A server is moved to the front once it scored better than the first server
+ * by DNS_PROBE_REORDER_RATIO and DNS_PROBE_REORDER_MIN_MS in this many probes
+ * in a row
+ */
+#define DNS_PROBE_REORDER_ROUNDS        3
+#define DNS_PROBE_REORDER_RATIO         0.8
+#define DNS_PROBE_REORDER_MIN_MS        5.0
+
+/**
+ * Length of the probe query: header, root name, type and class
+ */
+#define DNS_PROBE_QUERY_LEN             17
+
+typedef struct dns_server_health
+{
+	gchar *address;
+	gdouble latency;        /* EWMA of the answer time in ms, < 0 until the
+	                         * first answer */
+	gdouble failure_rate;   /* EWMA of the lost queries, 0 to 1 */
+	guint probes;
+	guint failures;
+	guint better_rounds;    /* Probes in a row the server scored clearly better
+	                         * than the first server */
+} dns_server_health_t;
+
+typedef struct dns_probe dns_probe_t;
+
+/**
+ * Callback called once all servers answered or the timeout expired. The
+ * probe is freed before the callback is called. latencies holds the answer
+ * time in ms of each server, in the order of servers, or -1 if a server
+ * didn't answer.
+ */
+typedef void (*dns_probe_cb)(GStrv servers, const gint *latencies,
+                             gpointer user_data);
+
+/**
+ * Start probing nameservers on the main loop
+ *
+ * @param[IN]  iface Name of the network interface to send the queries on.
+ *                   May be NULL to let the routing decide.
+ * @param[IN]  servers IPv4 or IPv6 addresses of the nameservers
+ * @param[IN]  port UDP port of the nameservers, DNS_PROBE_PORT
+ * @param[IN]  timeout_ms Timeout in ms
+ * @param[IN]  cb Callback called with the result
+ * @param[IN]  user_data User data passed to cb
+ *
+ * @return Running probe or NULL if no query could be sent
+ */
+extern dns_probe_t *dns_probe_start(const gchar *iface, GStrv servers,
+                                    guint16 port, guint timeout_ms, dns_probe_cb cb, gpointer user_data);
+
+/**
+ * Stop a running probe without calling its callback and free it
+ *
+ * @param[IN]  probe Probe to cancel
+ */
+extern void dns_probe_cancel(dns_probe_t *probe);
+
+/**
+ * Build the probe query
+ *
+ * @param[OUT] buf Buffer of at least DNS_PROBE_QUERY_LEN bytes
+ * @param[IN]  id Query id
+ *
+ * @return Length of the query
+ */
+extern gsize dns_probe_build_query(guint8 *buf, guint16 id);
+
+/**
+ * Check if a packet answers the probe query. Answers saying the server
+ * failed or refused the query don't count.
+ *
+ * @param[IN]  buf Received packet
+ * @param[IN]  len Length of the packet
+ * @param[IN]  id Id of the query
+ *
+ * @return TRUE if the packet answers the query, FALSE otherwise
+ */
+extern gboolean dns_probe_is_answer(const guint8 *buf, gsize len, guint16 id);
+
+/**
+ * Match the health of the servers to the current nameservers of a link.
+ * Servers which are no longer used are dropped, new ones are added.
+ *
+ * @param[IN]  health List of dns_server_health_t, consumed
+ * @param[IN]  servers Current nameservers
+ *
+ * @return List of dns_server_health_t in the order of servers
+ */
+extern GList *dns_probe_health_sync(GList *health, GStrv servers);
+
+/**
+ * Find the health of a server
+ *
+ * @param[IN]  health List of dns_server_health_t
+ * @param[IN]  address Address of the server
+ *
+ * @return Health of the server or NULL
+ */
+extern dns_server_health_t *dns_probe_health_find(GList *health,
+        const gchar *address);
+
+/**
+ * Add the result of a probe to the moving averages of a server
+ *
+ * @param[IN]  health Health of the server
+ * @param[IN]  latency_ms Answer time in ms, -1 if the server didn't answer
+ */
+extern void dns_probe_health_add_sample(dns_server_health_t *health,
+                                        gint latency_ms);
+
+/**
+ * Get the expected time a lookup takes with the server first: its latency
+ * if it answers and the resolver timeout if it doesn't, weighted by its
+ * failure rate. Lower is better.
+ *
+ * @param[IN]  health Health of the server
+ * @param[IN]  timeout_ms Resolver timeout in ms
+ *
+ * @return Score of the server
+ */
+extern gdouble dns_probe_health_score(const dns_server_health_t *health,
+                                      guint timeout_ms);
+
+/**
+ * Update the reorder counters after a probe and check if another server
+ * should go first
+ *
+ * @param[IN]  health List of dns_server_health_t in the current order
+ * @param[IN]  timeout_ms Resolver timeout in ms
+ *
+ * @return New order of the servers, free with g_strfreev, NULL if the order
+ *         stays
+ */
+extern GStrv dns_probe_health_reorder(GList *health, guint timeout_ms);
+
+/**
+ * Free a list of dns_server_health_t
+ *
+ * @param[IN]  health List to free
+ */
+extern void dns_probe_health_free(GList *health);
+
+#endif /* _DNS_PROBE_H_ */
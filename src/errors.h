@@ -115,6 +115,39 @@
 #define WCA_API_ERROR_WIFI_PASSPHRASE_INVALID  179
 #define WCA_API_ERROR_WIFI_SECURITY_TYPE_INVALID 180
 #define WCA_API_ERROR_SET_TECHNOLOGY_STATE_NOT_SUPPORTED 181
+#define WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_CHANNEL 182
+#define WCA_API_ERROR_TETHERING_CHANNEL_INVALID 183
+#define WCA_API_ERROR_TETHERING_CHANNEL_FAILED 184
+#define WCA_API_ERROR_TETHERING_INVALID_MAC_ADDRESS 185
+#define WCA_API_ERROR_TETHERING_ACCESS_ENTRY_NOT_FOUND 186
+#define WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SETTINGS 187
+#define WCA_API_ERROR_TETHERING_MAX_STATIONS_INVALID 188
+#define WCA_API_ERROR_TETHERING_SETTINGS_FAILED 189
+#define WCA_API_ERROR_NETWORK_BINDING_NOT_FOUND 190
+#define WCA_API_ERROR_RUNTIME_PARAM_UNKNOWN 191
+#define WCA_API_ERROR_RUNTIME_PARAM_OUT_OF_RANGE 192
+#define WCA_API_ERROR_PROFILE_NAMESPACE_INVALID 193
+#define WCA_API_ERROR_PROFILE_NAMESPACE_NOT_FOUND 194
+#define WCA_API_ERROR_PROFILE_NAMESPACE_CONFLICT 195
+#define WCA_API_ERROR_CERTIFICATE_NOT_FOUND 196
+#define WCA_API_ERROR_CERTIFICATE_EXPIRED 197
+#define WCA_API_ERROR_CERTIFICATE_UNTRUSTED 198
+#define WCA_API_ERROR_CERTIFICATE_INVALID 199
+#define WCA_API_ERROR_WIRED_8021X_INVALID 200
+#define WCA_API_ERROR_WIRED_8021X_NOT_CONFIGURED 201
+#define WCA_API_ERROR_WOWLAN_INVALID 202
+#define WCA_API_ERROR_WOWLAN_UNSUPPORTED 203
+#define WCA_API_ERROR_WOWLAN_FAILED 204
+#define WCA_API_ERROR_POWER_SAVE_INVALID_MODE 207
+#define WCA_API_ERROR_POWER_SAVE_FAILED 208
+#define WCA_API_ERROR_P2P_GROUP_NOT_CACHED 209
+#define WCA_API_ERROR_PASSPOINT_INVALID 210
+#define WCA_API_ERROR_PASSPOINT_NOT_FOUND 211
+#define WCA_API_ERROR_BAND_PREFERENCE_INVALID 212
+#define WCA_API_ERROR_SELF_TEST_BUSY 213
+#define WCA_API_ERROR_SELF_TEST_NOT_RUNNING 214
+#define WCA_API_ERROR_SELF_TEST_CANCELLED 215
+#define WCA_API_ERROR_SELF_TEST_FAILED 216
 
 #define WCA_API_ERROR_PROXY_FIND_PROXY_FOR_URL_ERROR    205
 #define WCA_API_ERROR_FAILED_TO_SET_GO_INTENT           206
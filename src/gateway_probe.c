@@ -0,0 +1,547 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  gateway_probe.c
+ *
+ * @brief Checks if the gateway of a link is still reachable by resolving it
+ *        with ARP (IPv4) or NDP (IPv6). This takes a few ms on a working link
+ *        compared to the seconds the online check needs.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <net/if.h>
+#include <net/if_arp.h>
+#include <netinet/icmp6.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+
+#include "gateway_probe.h"
+
+#define HW_ADDR_LEN     6
+
+struct gateway_probe
+{
+	int arp_fd;
+	int ndp_fd;
+	guint arp_watch;
+	guint ndp_watch;
+	guint timeout;
+	struct in_addr ipv4_gateway;
+	struct in6_addr ipv6_gateway;
+	gateway_probe_cb cb;
+	gpointer user_data;
+};
+
+/**
+ * Build a broadcast ARP request (see header for API details)
+ */
+
+gsize gateway_probe_build_arp_request(guint8 *buf, const guint8 *src_mac,
+                                      const struct in_addr *src, const struct in_addr *target)
+{
+	struct arphdr *hdr = (struct arphdr *) buf;
+	guint8 *addrs = buf + sizeof(struct arphdr);
+
+	hdr->ar_hrd = htons(ARPHRD_ETHER);
+	hdr->ar_pro = htons(ETH_P_IP);
+	hdr->ar_hln = HW_ADDR_LEN;
+	hdr->ar_pln = sizeof(struct in_addr);
+	hdr->ar_op = htons(ARPOP_REQUEST);
+
+	/* sender hw, sender ip, target hw, target ip */
+	memcpy(addrs, src_mac, HW_ADDR_LEN);
+	memcpy(addrs + 6, &src->s_addr, 4);
+	memset(addrs + 10, 0, HW_ADDR_LEN);
+	memcpy(addrs + 16, &target->s_addr, 4);
+
+	return GATEWAY_PROBE_ARP_LEN;
+}
+
+/**
+ * Check for an ARP reply from target (see header for API details)
+ */
+
+gboolean gateway_probe_is_arp_reply(const guint8 *buf, gsize len,
+                                    const struct in_addr *target)
+{
+	const struct arphdr *hdr = (const struct arphdr *) buf;
+
+	if (len < GATEWAY_PROBE_ARP_LEN)
+	{
+		return FALSE;
+	}
+
+	if (ntohs(hdr->ar_hrd) != ARPHRD_ETHER || ntohs(hdr->ar_pro) != ETH_P_IP ||
+	        hdr->ar_hln != HW_ADDR_LEN || hdr->ar_pln != sizeof(struct in_addr) ||
+	        ntohs(hdr->ar_op) != ARPOP_REPLY)
+	{
+		return FALSE;
+	}
+
+	/* Sender ip of the reply has to be the gateway */
+	return memcmp(buf + sizeof(struct arphdr) + 6, &target->s_addr, 4) == 0;
+}
+
+/**
+ * Get the sender hardware address of an ARP packet (see header for API details)
+ */
+
+const guint8 *gateway_probe_get_arp_sender(const guint8 *buf)
+{
+	return buf + sizeof(struct arphdr);
+}
+
+/**
+ * Get the solicited-node multicast address (see header for API details)
+ */
+
+void gateway_probe_solicited_node(const struct in6_addr *target,
+                                  struct in6_addr *dst)
+{
+	/* ff02::1:ff00:0/104 with the lower 24 bits of the target */
+	memset(dst, 0, sizeof(struct in6_addr));
+	dst->s6_addr[0] = 0xff;
+	dst->s6_addr[1] = 0x02;
+	dst->s6_addr[11] = 0x01;
+	dst->s6_addr[12] = 0xff;
+	memcpy(&dst->s6_addr[13], &target->s6_addr[13], 3);
+}
+
+/**
+ * Build a neighbor solicitation (see header for API details)
+ */
+
+gsize gateway_probe_build_neighbor_solicit(guint8 *buf, const guint8 *src_mac,
+        const struct in6_addr *target)
+{
+	struct nd_neighbor_solicit *ns = (struct nd_neighbor_solicit *) buf;
+
+	memset(ns, 0, sizeof(struct nd_neighbor_solicit));
+	ns->nd_ns_type = ND_NEIGHBOR_SOLICIT;
+	ns->nd_ns_code = 0;
+	ns->nd_ns_target = *target;
+
+	if (NULL == src_mac)
+	{
+		return sizeof(struct nd_neighbor_solicit);
+	}
+
+	struct nd_opt_hdr *opt = (struct nd_opt_hdr *)(buf + sizeof(
+	                             struct nd_neighbor_solicit));
+	opt->nd_opt_type = ND_OPT_SOURCE_LINKADDR;
+	/* option length is in units of 8 bytes */
+	opt->nd_opt_len = 1;
+	memcpy((guint8 *) opt + sizeof(struct nd_opt_hdr), src_mac, HW_ADDR_LEN);
+
+	return GATEWAY_PROBE_NS_LEN;
+}
+
+/**
+ * Check for a neighbor advertisement for target (see header for API details)
+ */
+
+gboolean gateway_probe_is_neighbor_advert(const guint8 *buf, gsize len,
+        const struct in6_addr *target)
+{
+	const struct nd_neighbor_advert *na = (const struct nd_neighbor_advert *) buf;
+
+	if (len < sizeof(struct nd_neighbor_advert))
+	{
+		return FALSE;
+	}
+
+	if (na->nd_na_type != ND_NEIGHBOR_ADVERT || na->nd_na_code != 0)
+	{
+		return FALSE;
+	}
+
+	return memcmp(&na->nd_na_target, target, sizeof(struct in6_addr)) == 0;
+}
+
+/**
+ * Get the target link-layer address of a neighbor advertisement (see header for API details)
+ */
+
+const guint8 *gateway_probe_get_target_link_address(const guint8 *buf,
+        gsize len)
+{
+	gsize offset = sizeof(struct nd_neighbor_advert);
+
+	while (offset + sizeof(struct nd_opt_hdr) <= len)
+	{
+		const struct nd_opt_hdr *opt = (const struct nd_opt_hdr *)(buf + offset);
+		gsize opt_len = opt->nd_opt_len * 8;
+
+		if (0 == opt_len || offset + opt_len > len)
+		{
+			break;
+		}
+
+		if (opt->nd_opt_type == ND_OPT_TARGET_LINKADDR &&
+		        opt_len >= sizeof(struct nd_opt_hdr) + HW_ADDR_LEN)
+		{
+			return buf + offset + sizeof(struct nd_opt_hdr);
+		}
+
+		offset += opt_len;
+	}
+
+	return NULL;
+}
+
+/**
+ * Convert a probe state to a string (see header for API details)
+ */
+
+const gchar *gateway_probe_state_to_string(gateway_probe_state_t state)
+{
+	switch (state)
+	{
+		case GATEWAY_PROBE_STATE_REACHABLE:
+			return "yes";
+
+		case GATEWAY_PROBE_STATE_UNREACHABLE:
+			return "no";
+
+		default:
+			return "unknown";
+	}
+}
+
+static void probe_free(gateway_probe_t *probe)
+{
+	if (probe->arp_watch)
+	{
+		g_source_remove(probe->arp_watch);
+	}
+
+	if (probe->ndp_watch)
+	{
+		g_source_remove(probe->ndp_watch);
+	}
+
+	if (probe->timeout)
+	{
+		g_source_remove(probe->timeout);
+	}
+
+	if (probe->arp_fd >= 0)
+	{
+		close(probe->arp_fd);
+	}
+
+	if (probe->ndp_fd >= 0)
+	{
+		close(probe->ndp_fd);
+	}
+
+	g_free(probe);
+}
+
+static void probe_finish(gateway_probe_t *probe, gateway_probe_state_t state,
+                         const guint8 *gateway_mac)
+{
+	/* The callback may start a new probe, so this one is gone before calling it */
+	gateway_probe_cb cb = probe->cb;
+	gpointer user_data = probe->user_data;
+	guint8 mac[HW_ADDR_LEN];
+
+	if (NULL != gateway_mac)
+	{
+		memcpy(mac, gateway_mac, HW_ADDR_LEN);
+	}
+
+	probe_free(probe);
+	cb(state, gateway_mac ? mac : NULL, user_data);
+}
+
+static gboolean probe_timeout_cb(gpointer user_data)
+{
+	gateway_probe_t *probe = user_data;
+
+	probe->timeout = 0;
+	probe_finish(probe, GATEWAY_PROBE_STATE_UNREACHABLE, NULL);
+
+	return FALSE;
+}
+
+static gboolean arp_data_cb(GIOChannel *channel, GIOCondition cond,
+                            gpointer user_data)
+{
+	gateway_probe_t *probe = user_data;
+	guint8 buf[128];
+	ssize_t len;
+
+	if (cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP))
+	{
+		probe->arp_watch = 0;
+		return FALSE;
+	}
+
+	while ((len = recv(probe->arp_fd, buf, sizeof(buf), 0)) > 0)
+	{
+		if (gateway_probe_is_arp_reply(buf, len, &probe->ipv4_gateway))
+		{
+			probe->arp_watch = 0;
+			probe_finish(probe, GATEWAY_PROBE_STATE_REACHABLE,
+			             gateway_probe_get_arp_sender(buf));
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gboolean ndp_data_cb(GIOChannel *channel, GIOCondition cond,
+                            gpointer user_data)
+{
+	gateway_probe_t *probe = user_data;
+	guint8 buf[256];
+	ssize_t len;
+
+	if (cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP))
+	{
+		probe->ndp_watch = 0;
+		return FALSE;
+	}
+
+	while ((len = recv(probe->ndp_fd, buf, sizeof(buf), 0)) > 0)
+	{
+		if (gateway_probe_is_neighbor_advert(buf, len, &probe->ipv6_gateway))
+		{
+			probe->ndp_watch = 0;
+			probe_finish(probe, GATEWAY_PROBE_STATE_REACHABLE,
+			             gateway_probe_get_target_link_address(buf, len));
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static guint add_fd_watch(int fd, GIOFunc func, gpointer user_data)
+{
+	GIOChannel *channel = g_io_channel_unix_new(fd);
+	guint watch = g_io_add_watch(channel, G_IO_IN | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+	                             func, user_data);
+
+	/* The watch holds its own reference, the fd is closed by probe_free */
+	g_io_channel_unref(channel);
+
+	return watch;
+}
+
+static gboolean get_hw_address(int fd, const gchar *iface, guint8 *mac)
+{
+	struct ifreq ifr;
+
+	memset(&ifr, 0, sizeof(ifr));
+	g_strlcpy(ifr.ifr_name, iface, sizeof(ifr.ifr_name));
+
+	if (ioctl(fd, SIOCGIFHWADDR, &ifr) < 0)
+	{
+		return FALSE;
+	}
+
+	memcpy(mac, ifr.ifr_hwaddr.sa_data, HW_ADDR_LEN);
+	return TRUE;
+}
+
+static gboolean send_arp_request(gateway_probe_t *probe, unsigned int ifindex,
+                                 const gchar *iface, const gchar *ipv4_address)
+{
+	struct sockaddr_ll sll;
+	struct in_addr src = { 0 };
+	guint8 mac[HW_ADDR_LEN];
+	guint8 buf[GATEWAY_PROBE_ARP_LEN];
+	gsize len;
+
+	/* Without a local address an ARP probe (sender 0.0.0.0) is sent */
+	if (NULL != ipv4_address)
+	{
+		inet_pton(AF_INET, ipv4_address, &src);
+	}
+
+	probe->arp_fd = socket(AF_PACKET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+	                       htons(ETH_P_ARP));
+
+	if (probe->arp_fd < 0)
+	{
+		return FALSE;
+	}
+
+	memset(&sll, 0, sizeof(sll));
+	sll.sll_family = AF_PACKET;
+	sll.sll_protocol = htons(ETH_P_ARP);
+	sll.sll_ifindex = ifindex;
+
+	if (bind(probe->arp_fd, (struct sockaddr *) &sll, sizeof(sll)) < 0 ||
+	        !get_hw_address(probe->arp_fd, iface, mac))
+	{
+		return FALSE;
+	}
+
+	len = gateway_probe_build_arp_request(buf, mac, &src, &probe->ipv4_gateway);
+
+	sll.sll_halen = HW_ADDR_LEN;
+	memset(sll.sll_addr, 0xff, HW_ADDR_LEN);
+
+	if (sendto(probe->arp_fd, buf, len, 0, (struct sockaddr *) &sll,
+	           sizeof(sll)) < 0)
+	{
+		return FALSE;
+	}
+
+	probe->arp_watch = add_fd_watch(probe->arp_fd, arp_data_cb, probe);
+	return TRUE;
+}
+
+static gboolean send_neighbor_solicit(gateway_probe_t *probe,
+                                      unsigned int ifindex, const gchar *iface)
+{
+	struct sockaddr_in6 dst;
+	struct icmp6_filter filter;
+	guint8 mac[HW_ADDR_LEN];
+	guint8 buf[GATEWAY_PROBE_NS_LEN];
+	int hops = 255;
+	gsize len;
+
+	probe->ndp_fd = socket(AF_INET6, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+	                       IPPROTO_ICMPV6);
+
+	if (probe->ndp_fd < 0)
+	{
+		return FALSE;
+	}
+
+	ICMP6_FILTER_SETBLOCKALL(&filter);
+	ICMP6_FILTER_SETPASS(ND_NEIGHBOR_ADVERT, &filter);
+
+	/* Neighbor discovery messages are dropped unless the hop limit is 255 */
+	if (setsockopt(probe->ndp_fd, SOL_SOCKET, SO_BINDTODEVICE, iface,
+	               strlen(iface) + 1) < 0 ||
+	        setsockopt(probe->ndp_fd, IPPROTO_ICMPV6, ICMP6_FILTER, &filter,
+	                   sizeof(filter)) < 0 ||
+	        setsockopt(probe->ndp_fd, IPPROTO_IPV6, IPV6_MULTICAST_HOPS, &hops,
+	                   sizeof(hops)) < 0)
+	{
+		return FALSE;
+	}
+
+	len = gateway_probe_build_neighbor_solicit(buf,
+	        get_hw_address(probe->ndp_fd, iface, mac) ? mac : NULL,
+	        &probe->ipv6_gateway);
+
+	memset(&dst, 0, sizeof(dst));
+	dst.sin6_family = AF_INET6;
+	dst.sin6_scope_id = ifindex;
+	gateway_probe_solicited_node(&probe->ipv6_gateway, &dst.sin6_addr);
+
+	if (sendto(probe->ndp_fd, buf, len, 0, (struct sockaddr *) &dst,
+	           sizeof(dst)) < 0)
+	{
+		return FALSE;
+	}
+
+	probe->ndp_watch = add_fd_watch(probe->ndp_fd, ndp_data_cb, probe);
+	return TRUE;
+}
+
+/**
+ * Start probing the gateways of a link (see header for API details)
+ */
+
+gateway_probe_t *gateway_probe_start(const gchar *iface,
+                                     const gchar *ipv4_address, const gchar *ipv4_gateway,
+                                     const gchar *ipv6_gateway, guint timeout_ms,
+                                     gateway_probe_cb cb, gpointer user_data)
+{
+	unsigned int ifindex;
+
+	if (NULL == iface || NULL == cb)
+	{
+		return NULL;
+	}
+
+	ifindex = if_nametoindex(iface);
+
+	if (0 == ifindex)
+	{
+		return NULL;
+	}
+
+	gateway_probe_t *probe = g_new0(gateway_probe_t, 1);
+	probe->arp_fd = -1;
+	probe->ndp_fd = -1;
+	probe->cb = cb;
+	probe->user_data = user_data;
+
+	/* A failing socket only disables the probe for its protocol */
+	if (NULL != ipv4_gateway &&
+	        inet_pton(AF_INET, ipv4_gateway, &probe->ipv4_gateway) == 1 &&
+	        probe->ipv4_gateway.s_addr != INADDR_ANY)
+	{
+		if (!send_arp_request(probe, ifindex, iface, ipv4_address) &&
+		        probe->arp_fd >= 0)
+		{
+			close(probe->arp_fd);
+			probe->arp_fd = -1;
+		}
+	}
+
+	if (NULL != ipv6_gateway &&
+	        inet_pton(AF_INET6, ipv6_gateway, &probe->ipv6_gateway) == 1 &&
+	        !IN6_IS_ADDR_UNSPECIFIED(&probe->ipv6_gateway))
+	{
+		if (!send_neighbor_solicit(probe, ifindex, iface) && probe->ndp_fd >= 0)
+		{
+			close(probe->ndp_fd);
+			probe->ndp_fd = -1;
+		}
+	}
+
+	if (!probe->arp_watch && !probe->ndp_watch)
+	{
+		probe_free(probe);
+		return NULL;
+	}
+
+	probe->timeout = g_timeout_add(timeout_ms, probe_timeout_cb, probe);
+
+	return probe;
+}
+
+/**
+ * Cancel a running probe (see header for API details)
+ */
+
+void gateway_probe_cancel(gateway_probe_t *probe)
+{
+	if (NULL == probe)
+	{
+		return;
+	}
+
+	probe_free(probe);
+}
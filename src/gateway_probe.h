@@ -0,0 +1,184 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  gateway_probe.h
+ *
+ * @brief Header file defining the gateway reachability probe, which checks if
+ *        the IPv4 gateway (ARP) and IPv6 router (NDP) of a link still answer
+ *
+ */
+
+#ifndef _GATEWAY_PROBE_H_
+#define _GATEWAY_PROBE_H_
+
+#include <glib.h>
+#include <netinet/in.h>
+
+/**
+ * Default time (in ms) the gateway has to answer within before it is considered
+ * unreachable, see the gatewayProbeTimeout runtime parameter
+ */
+#define GATEWAY_PROBE_TIMEOUT_MS        100
+
+/**
+ * Length of an ARP packet for IPv4 over ethernet
+ */
+#define GATEWAY_PROBE_ARP_LEN           28
+
+/**
+ * Length of a neighbor solicitation including the source link-layer address option
+ */
+#define GATEWAY_PROBE_NS_LEN            32
+
+typedef enum
+{
+	GATEWAY_PROBE_STATE_UNKNOWN = 0,
+	GATEWAY_PROBE_STATE_REACHABLE,
+	GATEWAY_PROBE_STATE_UNREACHABLE,
+} gateway_probe_state_t;
+
+typedef struct gateway_probe gateway_probe_t;
+
+/**
+ * Callback called once a probe has finished. The probe is freed before the
+ * callback is called. gateway_mac holds the hardware address of the gateway
+ * (6 bytes) if it answered with one, NULL otherwise.
+ */
+typedef void (*gateway_probe_cb)(gateway_probe_state_t state,
+                                 const guint8 *gateway_mac, gpointer user_data);
+
+/**
+ * Start probing the gateways of a link on the main loop. An ARP request is
+ * sent to the IPv4 gateway and a neighbor solicitation to the IPv6 router.
+ * The gateway is reachable as soon as one of them answers and unreachable if
+ * none of them answered within the timeout.
+ *
+ * @param[IN]  iface Name of the network interface
+ * @param[IN]  ipv4_address Local IPv4 address. May be NULL.
+ * @param[IN]  ipv4_gateway IPv4 gateway to probe. May be NULL.
+ * @param[IN]  ipv6_gateway IPv6 router to probe. May be NULL.
+ * @param[IN]  timeout_ms Timeout in ms
+ * @param[IN]  cb Callback called with the result
+ * @param[IN]  user_data User data passed to cb
+ *
+ * @return Running probe or NULL if there was nothing to probe or the probe
+ *         sockets couldn't be set up
+ */
+extern gateway_probe_t *gateway_probe_start(const gchar *iface,
+        const gchar *ipv4_address, const gchar *ipv4_gateway,
+        const gchar *ipv6_gateway, guint timeout_ms,
+        gateway_probe_cb cb, gpointer user_data);
+
+/**
+ * Stop a running probe without calling its callback and free it
+ *
+ * @param[IN]  probe Probe to cancel
+ */
+extern void gateway_probe_cancel(gateway_probe_t *probe);
+
+/**
+ * Convert a probe state to the string reported over the luna API
+ *
+ * @param[IN]  state Probe state
+ *
+ * @return "yes", "no" or "unknown"
+ */
+extern const gchar *gateway_probe_state_to_string(gateway_probe_state_t state);
+
+/**
+ * Build a broadcast ARP request asking for the hardware address of target
+ *
+ * @param[OUT] buf Buffer of at least GATEWAY_PROBE_ARP_LEN bytes
+ * @param[IN]  src_mac Hardware address of the local interface
+ * @param[IN]  src Local IPv4 address
+ * @param[IN]  target IPv4 address to resolve
+ *
+ * @return Length of the packet
+ */
+extern gsize gateway_probe_build_arp_request(guint8 *buf,
+        const guint8 *src_mac, const struct in_addr *src,
+        const struct in_addr *target);
+
+/**
+ * Check if a packet is an ARP reply sent by target
+ *
+ * @param[IN]  buf Received packet
+ * @param[IN]  len Length of the packet
+ * @param[IN]  target IPv4 address the request was sent for
+ *
+ * @return TRUE if the packet answers our request, FALSE otherwise
+ */
+extern gboolean gateway_probe_is_arp_reply(const guint8 *buf, gsize len,
+        const struct in_addr *target);
+
+/**
+ * Get the sender hardware address of an ARP packet
+ *
+ * @param[IN]  buf ARP packet of at least GATEWAY_PROBE_ARP_LEN bytes
+ *
+ * @return Pointer to the hardware address within buf
+ */
+extern const guint8 *gateway_probe_get_arp_sender(const guint8 *buf);
+
+/**
+ * Get the solicited-node multicast address for an IPv6 address
+ *
+ * @param[IN]  target IPv6 address
+ * @param[OUT] dst Solicited-node multicast address
+ */
+extern void gateway_probe_solicited_node(const struct in6_addr *target,
+        struct in6_addr *dst);
+
+/**
+ * Build a neighbor solicitation for target. The ICMPv6 checksum is left to
+ * the kernel.
+ *
+ * @param[OUT] buf Buffer of at least GATEWAY_PROBE_NS_LEN bytes
+ * @param[IN]  src_mac Hardware address of the local interface. May be NULL
+ *                     to leave out the source link-layer address option.
+ * @param[IN]  target IPv6 address to resolve
+ *
+ * @return Length of the packet
+ */
+extern gsize gateway_probe_build_neighbor_solicit(guint8 *buf,
+        const guint8 *src_mac, const struct in6_addr *target);
+
+/**
+ * Check if an ICMPv6 packet is a neighbor advertisement for target
+ *
+ * @param[IN]  buf Received ICMPv6 packet
+ * @param[IN]  len Length of the packet
+ * @param[IN]  target IPv6 address the solicitation was sent for
+ *
+ * @return TRUE if the packet answers our solicitation, FALSE otherwise
+ */
+extern gboolean gateway_probe_is_neighbor_advert(const guint8 *buf, gsize len,
+        const struct in6_addr *target);
+
+/**
+ * Get the target link-layer address option of a neighbor advertisement
+ *
+ * @param[IN]  buf Received neighbor advertisement
+ * @param[IN]  len Length of the packet
+ *
+ * @return Pointer to the hardware address within buf or NULL if the
+ *         advertisement doesn't carry one
+ */
+extern const guint8 *gateway_probe_get_target_link_address(const guint8 *buf,
+        gsize len);
+
+#endif /* _GATEWAY_PROBE_H_ */
@@ -0,0 +1,424 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  ipv6_addresses.c
+ *
+ * @brief Cache of the IPv6 addresses assigned to the network interfaces
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_addr.h>
+
+#include "ipv6_addresses.h"
+
+#ifndef IFA_F_STABLE_PRIVACY
+#define IFA_F_STABLE_PRIVACY    0x800
+#endif
+
+#define LIFETIME_INFINITE       0xffffffffU
+
+/* Flags which make an address unusable as source address */
+#define UNUSABLE_FLAGS          (IFA_F_TENTATIVE | IFA_F_DADFAILED)
+
+typedef struct flag_name
+{
+	guint32 flag;
+	const gchar *name;
+} flag_name_t;
+
+static const flag_name_t flag_names[] =
+{
+	{ IFA_F_TEMPORARY,       "temporary" },
+	{ IFA_F_STABLE_PRIVACY,  "stablePrivacy" },
+	{ IFA_F_PERMANENT,       "permanent" },
+	{ IFA_F_MANAGETEMPADDR,  "manageTempAddr" },
+	{ IFA_F_DEPRECATED,      "deprecated" },
+	{ IFA_F_TENTATIVE,       "tentative" },
+	{ IFA_F_OPTIMISTIC,      "optimistic" },
+	{ IFA_F_DADFAILED,       "dadFailed" },
+};
+
+typedef struct sort_context
+{
+	gboolean prefer_stable;
+	gint64 now;
+} sort_context_t;
+
+/* ifindex -> GList of ipv6_address_t */
+static GHashTable *interfaces = NULL;
+
+static void address_list_free(gpointer data)
+{
+	g_list_free_full(data, g_free);
+}
+
+static GHashTable *get_interfaces(void)
+{
+	if (NULL == interfaces)
+	{
+		interfaces = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+		                                   address_list_free);
+	}
+
+	return interfaces;
+}
+
+static GList *find_address(GList *addresses, const gchar *address)
+{
+	GList *iter;
+
+	for (iter = addresses; NULL != iter; iter = iter->next)
+	{
+		if (!g_strcmp0(((ipv6_address_t *) iter->data)->address, address))
+		{
+			return iter;
+		}
+	}
+
+	return NULL;
+}
+
+static gboolean parse_address_message(const struct nlmsghdr *nlh, gint64 now)
+{
+	const struct ifaddrmsg *ifa = NLMSG_DATA(nlh);
+	const struct rtattr *rta;
+	const struct ifa_cacheinfo *cacheinfo = NULL;
+	const void *addr = NULL;
+	guint32 flags;
+	gint attr_len;
+	gchar address[INET6_ADDRSTRLEN];
+	GList *addresses, *link;
+	ipv6_address_t *entry;
+	gboolean changed = FALSE;
+
+	if (nlh->nlmsg_len < NLMSG_LENGTH(sizeof(*ifa)) || AF_INET6 != ifa->ifa_family)
+	{
+		return FALSE;
+	}
+
+	flags = ifa->ifa_flags;
+	attr_len = nlh->nlmsg_len - NLMSG_LENGTH(sizeof(*ifa));
+
+	for (rta = IFA_RTA(ifa); RTA_OK(rta, attr_len); rta = RTA_NEXT(rta, attr_len))
+	{
+		switch (rta->rta_type)
+		{
+			case IFA_ADDRESS:
+				/* IFA_LOCAL wins for point to point links */
+				if (NULL == addr && RTA_PAYLOAD(rta) >= 16)
+				{
+					addr = RTA_DATA(rta);
+				}
+
+				break;
+
+			case IFA_LOCAL:
+				if (RTA_PAYLOAD(rta) >= 16)
+				{
+					addr = RTA_DATA(rta);
+				}
+
+				break;
+
+			case IFA_CACHEINFO:
+				if (RTA_PAYLOAD(rta) >= sizeof(*cacheinfo))
+				{
+					cacheinfo = RTA_DATA(rta);
+				}
+
+				break;
+
+			case IFA_FLAGS:
+				/* The full set of flags, ifa_flags only has the lower 8 */
+				if (RTA_PAYLOAD(rta) >= sizeof(guint32))
+				{
+					memcpy(&flags, RTA_DATA(rta), sizeof(guint32));
+				}
+
+				break;
+		}
+	}
+
+	if (NULL == addr || NULL == inet_ntop(AF_INET6, addr, address, sizeof(address)))
+	{
+		return FALSE;
+	}
+
+	addresses = g_hash_table_lookup(get_interfaces(), GINT_TO_POINTER(ifa->ifa_index));
+	link = find_address(addresses, address);
+
+	if (RTM_DELADDR == nlh->nlmsg_type)
+	{
+		if (NULL == link)
+		{
+			return FALSE;
+		}
+
+		g_free(link->data);
+		addresses = g_list_delete_link(addresses, link);
+		changed = TRUE;
+	}
+	else
+	{
+		if (NULL != link)
+		{
+			entry = link->data;
+			changed = entry->flags != flags || entry->prefix_length != ifa->ifa_prefixlen ||
+			          entry->scope != ifa->ifa_scope;
+		}
+		else
+		{
+			entry = g_new0(ipv6_address_t, 1);
+			entry->ifindex = ifa->ifa_index;
+			g_strlcpy(entry->address, address, sizeof(entry->address));
+			addresses = g_list_prepend(addresses, entry);
+			changed = TRUE;
+		}
+
+		entry->prefix_length = ifa->ifa_prefixlen;
+		entry->scope = ifa->ifa_scope;
+		entry->flags = flags;
+		entry->preferred_lifetime = NULL != cacheinfo ? cacheinfo->ifa_prefered :
+		                            LIFETIME_INFINITE;
+		entry->valid_lifetime = NULL != cacheinfo ? cacheinfo->ifa_valid :
+		                        LIFETIME_INFINITE;
+		entry->updated = now;
+	}
+
+	/* The table owns the list, steal it so replacing doesn't free it */
+	g_hash_table_steal(interfaces, GINT_TO_POINTER(ifa->ifa_index));
+
+	if (NULL != addresses)
+	{
+		g_hash_table_insert(interfaces, GINT_TO_POINTER(ifa->ifa_index), addresses);
+	}
+
+	return changed;
+}
+
+/**
+ * Update the cache from rtnetlink messages (see header for API details)
+ */
+
+gboolean ipv6_addresses_parse(const guint8 *buf, gsize len, gint64 now)
+{
+	const struct nlmsghdr *nlh;
+	gboolean changed = FALSE;
+	int remaining = len;
+
+	for (nlh = (const struct nlmsghdr *) buf; NLMSG_OK(nlh, remaining);
+	        nlh = NLMSG_NEXT(nlh, remaining))
+	{
+		if ((RTM_NEWADDR == nlh->nlmsg_type || RTM_DELADDR == nlh->nlmsg_type) &&
+		        parse_address_message(nlh, now))
+		{
+			changed = TRUE;
+		}
+	}
+
+	return changed;
+}
+
+/**
+ * Get the remaining lifetime of an address (see header for API details)
+ */
+
+gint64 ipv6_address_get_lifetime(const ipv6_address_t *address, gboolean valid,
+                                 gint64 now)
+{
+	guint32 lifetime = valid ? address->valid_lifetime : address->preferred_lifetime;
+	gint64 left;
+
+	if (LIFETIME_INFINITE == lifetime)
+	{
+		return IPV6_ADDRESS_LIFETIME_INFINITE;
+	}
+
+	left = (gint64) lifetime - (now - address->updated);
+
+	return left > 0 ? left : 0;
+}
+
+static gboolean is_deprecated(const ipv6_address_t *address, gint64 now)
+{
+	return (address->flags & IFA_F_DEPRECATED) ||
+	       0 == ipv6_address_get_lifetime(address, FALSE, now);
+}
+
+static gint compare_preference(gconstpointer a, gconstpointer b,
+                               gpointer user_data)
+{
+	const ipv6_address_t *address_a = a, *address_b = b;
+	const sort_context_t *context = user_data;
+	gboolean usable_a = !(address_a->flags & UNUSABLE_FLAGS);
+	gboolean usable_b = !(address_b->flags & UNUSABLE_FLAGS);
+	gboolean deprecated_a = is_deprecated(address_a, context->now);
+	gboolean deprecated_b = is_deprecated(address_b, context->now);
+	gboolean temporary_a = !!(address_a->flags & IFA_F_TEMPORARY);
+	gboolean temporary_b = !!(address_b->flags & IFA_F_TEMPORARY);
+	guint32 lifetime_a, lifetime_b;
+
+	if (usable_a != usable_b)
+	{
+		return usable_a ? -1 : 1;
+	}
+
+	if (deprecated_a != deprecated_b)
+	{
+		return deprecated_a ? 1 : -1;
+	}
+
+	/* RT_SCOPE_UNIVERSE is 0, smaller scopes have larger values */
+	if (address_a->scope != address_b->scope)
+	{
+		return address_a->scope < address_b->scope ? -1 : 1;
+	}
+
+	if (temporary_a != temporary_b)
+	{
+		return temporary_a == context->prefer_stable ? 1 : -1;
+	}
+
+	/* Infinite maps to the largest value */
+	lifetime_a = (guint32) ipv6_address_get_lifetime(address_a, FALSE, context->now);
+	lifetime_b = (guint32) ipv6_address_get_lifetime(address_b, FALSE, context->now);
+
+	if (lifetime_a != lifetime_b)
+	{
+		return lifetime_a > lifetime_b ? -1 : 1;
+	}
+
+	return g_strcmp0(address_a->address, address_b->address);
+}
+
+/**
+ * Get the addresses of an interface (see header for API details)
+ */
+
+GList *ipv6_addresses_get(gint ifindex, gboolean prefer_stable)
+{
+	sort_context_t context = { prefer_stable, g_get_monotonic_time() / G_USEC_PER_SEC };
+	GList *addresses;
+
+	addresses = g_list_copy(g_hash_table_lookup(get_interfaces(),
+	                        GINT_TO_POINTER(ifindex)));
+
+	return g_list_sort_with_data(addresses, compare_preference, &context);
+}
+
+/**
+ * Get the names of the flags of an address (see header for API details)
+ */
+
+const gchar **ipv6_address_get_flag_names(const ipv6_address_t *address)
+{
+	const gchar **names = g_new0(const gchar *, G_N_ELEMENTS(flag_names) + 1);
+	guint i, n = 0;
+
+	for (i = 0; i < G_N_ELEMENTS(flag_names); i++)
+	{
+		if (address->flags & flag_names[i].flag)
+		{
+			names[n++] = flag_names[i].name;
+		}
+	}
+
+	return names;
+}
+
+const gchar *ipv6_address_scope_to_string(guint8 scope)
+{
+	switch (scope)
+	{
+		case RT_SCOPE_UNIVERSE:
+			return "global";
+
+		case RT_SCOPE_SITE:
+			return "site";
+
+		case RT_SCOPE_LINK:
+			return "link";
+
+		case RT_SCOPE_HOST:
+			return "host";
+
+		default:
+			return "unknown";
+	}
+}
+
+/**
+ * Map the privacy setting to connman (see header for API details)
+ */
+
+const gchar *ipv6_privacy_to_connman(gboolean privacy, gboolean prefer_stable)
+{
+	if (!privacy)
+	{
+		return "disabled";
+	}
+
+	/* Sic, that is how connman spells it */
+	return prefer_stable ? "enabled" : "prefered";
+}
+
+/**
+ * Map connman's privacy setting (see header for API details)
+ */
+
+gboolean ipv6_privacy_from_connman(const gchar *value, gboolean *privacy,
+                                   gboolean *prefer_stable)
+{
+	if (!g_strcmp0(value, "disabled"))
+	{
+		*privacy = FALSE;
+		*prefer_stable = TRUE;
+	}
+	else if (!g_strcmp0(value, "enabled"))
+	{
+		*privacy = TRUE;
+		*prefer_stable = TRUE;
+	}
+	else if (!g_strcmp0(value, "prefered") || !g_strcmp0(value, "preferred"))
+	{
+		*privacy = TRUE;
+		*prefer_stable = FALSE;
+	}
+	else
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Drop all addresses (see header for API details)
+ */
+
+void ipv6_addresses_reset(void)
+{
+	if (NULL != interfaces)
+	{
+		g_hash_table_remove_all(interfaces);
+	}
+}
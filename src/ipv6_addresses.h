@@ -0,0 +1,128 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  ipv6_addresses.h
+ *
+ * @brief Header file defining the cache of the IPv6 addresses assigned to the
+ *        network interfaces, and the order they are preferred in as source
+ *        address
+ *
+ * The cache is filled from the RTM_NEWADDR and RTM_DELADDR messages of
+ * rtnetlink (see ipv6_addresses_rtnl.h), so building a status doesn't need to
+ * ask the kernel. Lifetimes are stored with the time they were reported at and
+ * counted down when they are read.
+ *
+ */
+
+#ifndef _IPV6_ADDRESSES_H_
+#define _IPV6_ADDRESSES_H_
+
+#include <glib.h>
+
+/**
+ * Lifetime of an address which doesn't expire
+ */
+#define IPV6_ADDRESS_LIFETIME_INFINITE  -1
+
+typedef struct ipv6_address
+{
+	gint ifindex;
+	gchar address[46];              /* INET6_ADDRSTRLEN */
+	guint8 prefix_length;
+	guint8 scope;                   /* RT_SCOPE_* */
+	guint32 flags;                  /* IFA_F_* */
+	guint32 preferred_lifetime;     /* Seconds when reported, 0xffffffff for infinite */
+	guint32 valid_lifetime;
+	gint64 updated;                 /* Monotonic time in seconds of the last report */
+} ipv6_address_t;
+
+/**
+ * Update the cache from a buffer of rtnetlink messages
+ *
+ * Messages other than RTM_NEWADDR and RTM_DELADDR for AF_INET6 are skipped.
+ *
+ * @param[IN]  buf Messages as read from the socket
+ * @param[IN]  len Length of buf
+ * @param[IN]  now Monotonic time in seconds
+ *
+ * @return TRUE if an address was added or removed, or its flags changed. A
+ *         refresh of the lifetimes alone doesn't count as a change.
+ */
+extern gboolean ipv6_addresses_parse(const guint8 *buf, gsize len, gint64 now);
+
+/**
+ * Get the addresses of an interface in the order they are preferred as
+ * source address for a new connection: usable before tentative or deprecated
+ * ones, wider scopes first, then stable or temporary addresses first as asked
+ * for, then the one which stays preferred for longer
+ *
+ * @param[IN]  ifindex Index of the interface
+ * @param[IN]  prefer_stable TRUE to prefer stable over temporary addresses
+ *
+ * @return List of ipv6_address_t owned by the module, free the list with
+ *         g_list_free
+ */
+extern GList *ipv6_addresses_get(gint ifindex, gboolean prefer_stable);
+
+/**
+ * Get the remaining lifetime of an address
+ *
+ * @param[IN]  address Address
+ * @param[IN]  valid TRUE for the valid lifetime, FALSE for the preferred one
+ * @param[IN]  now Monotonic time in seconds
+ *
+ * @return Seconds left, IPV6_ADDRESS_LIFETIME_INFINITE if it doesn't expire
+ */
+extern gint64 ipv6_address_get_lifetime(const ipv6_address_t *address,
+                                        gboolean valid, gint64 now);
+
+/**
+ * Get the names of the flags of an address, e.g. "temporary" or "deprecated"
+ *
+ * @return NULL terminated array of static strings, free it with g_free
+ */
+extern const gchar **ipv6_address_get_flag_names(const ipv6_address_t *address);
+
+extern const gchar *ipv6_address_scope_to_string(guint8 scope);
+
+/**
+ * Map the privacy setting of the luna API to connman's
+ * IPv6.Configuration.Privacy
+ *
+ * @param[IN]  privacy TRUE to use temporary addresses
+ * @param[IN]  prefer_stable TRUE to keep using the stable address for new
+ *             connections while temporary addresses are used
+ *
+ * @return "disabled", "enabled" or "prefered"
+ */
+extern const gchar *ipv6_privacy_to_connman(gboolean privacy,
+        gboolean prefer_stable);
+
+/**
+ * Map connman's IPv6.Privacy to the privacy setting of the luna API
+ *
+ * @return FALSE if the value is unknown
+ */
+extern gboolean ipv6_privacy_from_connman(const gchar *value,
+        gboolean *privacy, gboolean *prefer_stable);
+
+/**
+ * Drop all addresses
+ */
+extern void ipv6_addresses_reset(void);
+
+#endif /* _IPV6_ADDRESSES_H_ */
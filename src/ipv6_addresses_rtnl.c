@@ -0,0 +1,172 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  ipv6_addresses_rtnl.c
+ *
+ * @brief Updates the IPv6 address cache from rtnetlink
+ *
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include "ipv6_addresses.h"
+#include "ipv6_addresses_rtnl.h"
+
+#define RTNL_RECV_SIZE          32768
+
+static int rtnl_fd = -1;
+static guint rtnl_watch = 0;
+static guint32 rtnl_seq = 0;
+static ipv6_addresses_changed_cb changed_callback = NULL;
+static gpointer changed_data = NULL;
+
+static gboolean request_dump(void)
+{
+	struct
+	{
+		struct nlmsghdr nlh;
+		struct ifaddrmsg ifa;
+	} req;
+
+	memset(&req, 0, sizeof(req));
+	req.nlh.nlmsg_len = NLMSG_LENGTH(sizeof(req.ifa));
+	req.nlh.nlmsg_type = RTM_GETADDR;
+	req.nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+	req.nlh.nlmsg_seq = ++rtnl_seq;
+	req.ifa.ifa_family = AF_INET6;
+
+	return send(rtnl_fd, &req, req.nlh.nlmsg_len, 0) >= 0;
+}
+
+static gboolean rtnl_cb(GIOChannel *channel, GIOCondition cond,
+                        gpointer user_data)
+{
+	static guint8 buf[RTNL_RECV_SIZE];
+	gint64 now = g_get_monotonic_time() / G_USEC_PER_SEC;
+	gboolean changed = FALSE;
+	ssize_t len;
+
+	if (cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP))
+	{
+		rtnl_watch = 0;
+		return FALSE;
+	}
+
+	while ((len = recv(rtnl_fd, buf, sizeof(buf), 0)) > 0)
+	{
+		if (ipv6_addresses_parse(buf, len, now))
+		{
+			changed = TRUE;
+		}
+	}
+
+	/* Events were dropped, the cache can't be trusted anymore */
+	if (len < 0 && ENOBUFS == errno)
+	{
+		ipv6_addresses_reset();
+		request_dump();
+		changed = TRUE;
+	}
+
+	if (changed && NULL != changed_callback)
+	{
+		changed_callback(changed_data);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Start keeping the cache up to date (see header for API details)
+ */
+
+gboolean ipv6_addresses_rtnl_start(ipv6_addresses_changed_cb changed_cb,
+                                   gpointer user_data, GError **error)
+{
+	struct sockaddr_nl addr;
+	GIOChannel *channel;
+
+	if (rtnl_fd >= 0)
+	{
+		return TRUE;
+	}
+
+	rtnl_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+	                 NETLINK_ROUTE);
+
+	if (rtnl_fd < 0)
+	{
+		g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno),
+		            "Failed to open rtnetlink socket: %s", strerror(errno));
+		return FALSE;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_IPV6_IFADDR;
+
+	if (bind(rtnl_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0 ||
+	        !request_dump())
+	{
+		g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno),
+		            "Failed to set up rtnetlink socket: %s", strerror(errno));
+		close(rtnl_fd);
+		rtnl_fd = -1;
+		return FALSE;
+	}
+
+	changed_callback = changed_cb;
+	changed_data = user_data;
+
+	channel = g_io_channel_unix_new(rtnl_fd);
+	rtnl_watch = g_io_add_watch(channel, G_IO_IN | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+	                            rtnl_cb, NULL);
+	/* The watch holds its own reference, the fd is closed by ipv6_addresses_rtnl_stop */
+	g_io_channel_unref(channel);
+
+	return TRUE;
+}
+
+/**
+ * Stop updating the cache (see header for API details)
+ */
+
+void ipv6_addresses_rtnl_stop(void)
+{
+	if (rtnl_watch)
+	{
+		g_source_remove(rtnl_watch);
+		rtnl_watch = 0;
+	}
+
+	if (rtnl_fd >= 0)
+	{
+		close(rtnl_fd);
+		rtnl_fd = -1;
+	}
+
+	changed_callback = NULL;
+	changed_data = NULL;
+	ipv6_addresses_reset();
+}
@@ -0,0 +1,56 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  ipv6_addresses_rtnl.h
+ *
+ * @brief Header file defining how the IPv6 address cache is kept up to date
+ *        from rtnetlink
+ *
+ * The addresses are dumped once at start, after that the cache is updated
+ * from the address events of the kernel. If events were lost because the
+ * socket buffer overflowed, the cache is dropped and dumped again.
+ *
+ */
+
+#ifndef _IPV6_ADDRESSES_RTNL_H_
+#define _IPV6_ADDRESSES_RTNL_H_
+
+#include <glib.h>
+
+/**
+ * Called after an address was added or removed, or its flags changed
+ */
+typedef void (*ipv6_addresses_changed_cb)(gpointer user_data);
+
+/**
+ * Start keeping the cache up to date
+ *
+ * @param[IN]  changed_cb Called when the addresses changed
+ * @param[IN]  user_data Passed to changed_cb
+ * @param[OUT] error Why the rtnetlink socket couldn't be set up
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean ipv6_addresses_rtnl_start(ipv6_addresses_changed_cb changed_cb,
+        gpointer user_data, GError **error);
+
+/**
+ * Stop updating the cache and drop it
+ */
+extern void ipv6_addresses_rtnl_stop(void);
+
+#endif /* _IPV6_ADDRESSES_RTNL_H_ */
@@ -33,6 +33,8 @@
 #define PROPS_5(p1, p2, p3, p4, p5)             ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "}"
 #define PROPS_6(p1, p2, p3, p4, p5, p6)         ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "}"
 #define PROPS_7(p1, p2, p3, p4, p5, p6, p7)     ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "," p7 "}"
+#define PROPS_8(p1, p2, p3, p4, p5, p6, p7, p8) ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "," p7 "," p8 "}"
+#define PROPS_9(p1, p2, p3, p4, p5, p6, p7, p8, p9) ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "," p7 "," p8 "," p9 "}"
 #define REQUIRED_1(p1)                          ",\"required\":[\"" #p1 "\"]"
 #define REQUIRED_2(p1, p2)                      ",\"required\":[\"" #p1 "\",\"" #p2 "\"]"
 #define REQUIRED_4(p1, p2, p3, p4)          ",\"required\":[\"" #p1 "\",\"" #p2 "\",\"" #p3 "\",\"" #p4 "\"]"
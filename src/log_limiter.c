@@ -0,0 +1,196 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  log_limiter.c
+ *
+ * @brief Token bucket rate limiter for log messages
+ *
+ */
+
+#include <glib.h>
+
+#include "log_limiter.h"
+
+typedef struct bucket
+{
+	gboolean own_budget;
+	guint rate;
+	guint burst;
+	guint64 tokens;         /* In thousandths of a message */
+	gint64 last_ms;
+	guint dropped;
+} bucket_t;
+
+static GHashTable *buckets = NULL;
+static guint default_rate = LOG_LIMITER_RATE;
+static guint default_burst = LOG_LIMITER_BURST;
+
+static bucket_t *get_bucket(const gchar *id, gint64 now_ms)
+{
+	bucket_t *bucket;
+
+	if (NULL == buckets)
+	{
+		buckets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	}
+
+	bucket = g_hash_table_lookup(buckets, id);
+
+	if (NULL != bucket || g_hash_table_size(buckets) >= LOG_LIMITER_MAX_IDS)
+	{
+		return bucket;
+	}
+
+	bucket = g_new0(bucket_t, 1);
+	bucket->rate = default_rate;
+	bucket->burst = default_burst;
+	bucket->tokens = (guint64) default_burst * 1000;
+	bucket->last_ms = now_ms;
+	g_hash_table_insert(buckets, g_strdup(id), bucket);
+
+	return bucket;
+}
+
+/**
+ * Set the default budget (see header for API details)
+ */
+
+void log_limiter_set_default_budget(guint rate, guint burst)
+{
+	GHashTableIter iter;
+	bucket_t *bucket;
+
+	default_rate = rate;
+	default_burst = burst;
+
+	if (NULL == buckets)
+	{
+		return;
+	}
+
+	g_hash_table_iter_init(&iter, buckets);
+
+	while (g_hash_table_iter_next(&iter, NULL, (gpointer *) &bucket))
+	{
+		if (!bucket->own_budget)
+		{
+			bucket->rate = rate;
+			bucket->burst = burst;
+			bucket->tokens = MIN(bucket->tokens, (guint64) burst * 1000);
+		}
+	}
+}
+
+/**
+ * Give an id its own budget (see header for API details)
+ */
+
+void log_limiter_set_budget(const gchar *id, guint rate, guint burst)
+{
+	bucket_t *bucket = get_bucket(id, 0);
+
+	if (NULL == bucket)
+	{
+		return;
+	}
+
+	bucket->own_budget = TRUE;
+	bucket->rate = rate;
+	bucket->burst = burst;
+	bucket->tokens = (guint64) burst * 1000;
+}
+
+/**
+ * Check if a message may be logged (see header for API details)
+ */
+
+gboolean log_limiter_allow(const gchar *id, gint64 now_ms)
+{
+	bucket_t *bucket;
+
+	if (0 == default_rate || NULL == id)
+	{
+		return TRUE;
+	}
+
+	bucket = get_bucket(id, now_ms);
+
+	if (NULL == bucket || 0 == bucket->rate)
+	{
+		return TRUE;
+	}
+
+	if (now_ms > bucket->last_ms)
+	{
+		bucket->tokens = MIN(bucket->tokens + (guint64)(now_ms - bucket->last_ms) *
+		                     bucket->rate, (guint64) bucket->burst * 1000);
+	}
+
+	bucket->last_ms = now_ms;
+
+	if (bucket->tokens < 1000)
+	{
+		bucket->dropped++;
+		return FALSE;
+	}
+
+	bucket->tokens -= 1000;
+	return TRUE;
+}
+
+/**
+ * Report the dropped messages (see header for API details)
+ */
+
+void log_limiter_flush(log_limiter_dropped_cb cb, gpointer user_data)
+{
+	GHashTableIter iter;
+	const gchar *id;
+	bucket_t *bucket;
+
+	if (NULL == buckets)
+	{
+		return;
+	}
+
+	g_hash_table_iter_init(&iter, buckets);
+
+	while (g_hash_table_iter_next(&iter, (gpointer *) &id, (gpointer *) &bucket))
+	{
+		if (bucket->dropped)
+		{
+			cb(id, bucket->dropped, user_data);
+			bucket->dropped = 0;
+		}
+	}
+}
+
+/**
+ * Forget all ids (see header for API details)
+ */
+
+void log_limiter_reset(void)
+{
+	if (NULL != buckets)
+	{
+		g_hash_table_destroy(buckets);
+		buckets = NULL;
+	}
+
+	default_rate = LOG_LIMITER_RATE;
+	default_burst = LOG_LIMITER_BURST;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  log_limiter.h
+ *
+ * @brief Header file defining the log rate limiter used by WCALOG_INFO and
+ *        WCALOG_DEBUG
+ *
+ * Every message id (the format string for debug messages) has a token
+ * bucket: it refills with rate tokens per second up to burst tokens and each
+ * message takes one. Messages finding the bucket empty are dropped and
+ * counted, the counts are reported with log_limiter_flush.
+ *
+ */
+
+#ifndef _LOG_LIMITER_H_
+#define _LOG_LIMITER_H_
+
+#include <glib.h>
+
+/**
+ * Default budget of a message id, see the logRateLimit and logRateBurst
+ * runtime parameters
+ */
+#define LOG_LIMITER_RATE                10      /* messages/s */
+#define LOG_LIMITER_BURST               20
+
+/**
+ * Default time (in s) between two summaries of the dropped messages, see the
+ * logSummaryInterval runtime parameter
+ */
+#define LOG_LIMITER_SUMMARY_INTERVAL    60
+
+/**
+ * Ids beyond this many aren't limited, to bound the memory used
+ */
+#define LOG_LIMITER_MAX_IDS             256
+
+/**
+ * Callback called by log_limiter_flush for each id with dropped messages
+ */
+typedef void (*log_limiter_dropped_cb)(const gchar *id, guint count,
+                                       gpointer user_data);
+
+/**
+ * Set the budget of the ids without their own budget
+ *
+ * @param[IN]  rate Messages per second, 0 lifts the limits of all ids
+ * @param[IN]  burst Messages which may be logged at once
+ */
+extern void log_limiter_set_default_budget(guint rate, guint burst);
+
+/**
+ * Give an id its own budget
+ *
+ * @param[IN]  id Message id
+ * @param[IN]  rate Messages per second, 0 to never limit the id
+ * @param[IN]  burst Messages which may be logged at once
+ */
+extern void log_limiter_set_budget(const gchar *id, guint rate, guint burst);
+
+/**
+ * Check if a message may be logged and take a token if so
+ *
+ * @param[IN]  id Message id
+ * @param[IN]  now_ms Monotonic time in ms
+ *
+ * @return TRUE if the message may be logged, FALSE if it is dropped
+ */
+extern gboolean log_limiter_allow(const gchar *id, gint64 now_ms);
+
+/**
+ * Report and reset the counts of dropped messages
+ *
+ * @param[IN]  cb Callback called for each id with dropped messages
+ * @param[IN]  user_data User data passed to cb
+ */
+extern void log_limiter_flush(log_limiter_dropped_cb cb, gpointer user_data);
+
+/**
+ * Forget all ids and budgets
+ */
+extern void log_limiter_reset(void);
+
+#endif /* _LOG_LIMITER_H_ */
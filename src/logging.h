@@ -17,8 +17,11 @@
 #ifndef __LOGGING_H__
 #define __LOGGING_H__
 
+#include <glib.h>
 #include <PmLogLib.h>
 
+#include "log_limiter.h"
+
 extern PmLogContext gLogContext;
 
 /* Logging for webos-connman-adapter context ********
@@ -28,7 +31,22 @@ extern PmLogContext gLogContext;
  * ... - key-value pairs and free text. key-value pairs are formed using PMLOGKS or PMLOGKFV
  * e.g.)
  * WCALOG_CRITICAL(msgid, 2, PMLOGKS("key1", "value1"), PMLOGKFV("key2", "%d", value2), "free text message");
+ *
+ * Info and debug messages are rate limited per msgid (per format string for
+ * debug messages), see log_limiter.h. Warnings and errors are never dropped.
  **********************************************/
+
+/* Check the level first so disabled messages don't use up the budget */
+static inline gboolean wcalog_allowed(int level, const gchar *id)
+{
+	int context_level = kPmLogLevel_Debug;
+
+	(void) PmLogGetContextLevel(gLogContext, &context_level);
+
+	return level <= context_level &&
+	       log_limiter_allow(id, g_get_monotonic_time() / 1000);
+}
+
 #define WCALOG_CRITICAL(msgid, kvcount, ...) \
         PmLogCritical(gLogContext, msgid, kvcount, ##__VA_ARGS__)
 
@@ -39,10 +57,16 @@ extern PmLogContext gLogContext;
         PmLogWarning(gLogContext, msgid, kvcount, ##__VA_ARGS__)
 
 #define WCALOG_INFO(msgid, kvcount, ...) \
-        PmLogInfo(gLogContext, msgid, kvcount, ##__VA_ARGS__)
+    do { \
+    if (wcalog_allowed(kPmLogLevel_Info, msgid)) \
+        PmLogInfo(gLogContext, msgid, kvcount, ##__VA_ARGS__); \
+    } while(0)
 
-#define WCALOG_DEBUG(...) \
-        PmLogDebug(gLogContext, ##__VA_ARGS__)
+#define WCALOG_DEBUG(fmt, ...) \
+    do { \
+    if (wcalog_allowed(kPmLogLevel_Debug, fmt)) \
+        PmLogDebug(gLogContext, fmt, ##__VA_ARGS__); \
+    } while(0)
 
 #define WCALOG_ESCAPED_ERRMSG(msgid, errmsg) \
     do { \
@@ -72,6 +96,10 @@ extern PmLogContext gLogContext;
 /** main.c */
 #define MSGID_WCA_STARTING                              "WCA_STARTING"
 #define MSGID_WCA_SUPPORT_FAIL                          "WCA_SUPPORT_FAIL"
+#define MSGID_RUNTIME_PARAM_CHANGED                     "RUNTIME_PARAM_CHANGED"
+#define MSGID_RUNTIME_PARAMS_LOAD_ERROR                 "RUNTIME_PARAMS_LOAD_ERR"
+#define MSGID_DBUS_CALL_TIMEOUT                         "DBUS_CALL_TIMEOUT"
+#define MSGID_LOG_DROPPED                               "LOG_DROPPED"
 
 /** connman_agent.c */
 #define MSGID_AGENT_INIT_ERROR                          "AGENT_INIT_ERR"
@@ -136,6 +164,12 @@ extern PmLogContext gLogContext;
 #define MSGID_TECHNOLOGY_SET_TETHERING_ERROR            "TECH_SET_TETHERING_ERR"
 #define MSGID_TECHNOLOGY_SET_TETHERING_IDENTIFIER_ERROR "TECH_SET_TETHERING_IDENTI_ERR"
 #define MSGID_TECHNOLOGY_SET_TETHERING_PASSPHRASE_ERROR "TECH_SET_TETHERING_PASSPH_ERR"
+#define MSGID_TECHNOLOGY_SET_TETHERING_FREQ_ERROR       "TECH_SET_TETHERING_FREQ_ERR"
+#define MSGID_TECHNOLOGY_SET_TETHERING_SECURITY_ERROR   "TECH_SET_TETHERING_SECURITY_ERR"
+#define MSGID_TECHNOLOGY_SET_TETHERING_HIDDEN_ERROR     "TECH_SET_TETHERING_HIDDEN_ERR"
+#define MSGID_TECHNOLOGY_SET_TETHERING_MAX_STATIONS_ERROR "TECH_SET_TETHERING_MAX_STA_ERR"
+#define MSGID_TECHNOLOGY_SET_COUNTRY_CODE_ERROR         "TECH_SET_COUNTRY_CODE_ERR"
+#define MSGID_TECHNOLOGY_DISCONNECT_STATION_ERROR       "TECH_DISCONNECT_STATION_ERR"
 #define MSGID_TECHNOLOGY_CANCEL_P2P_ERROR               "TECH_CANCEL_P2P_ERR"
 #define MSGID_TECHNOLOGY_CANCEL_WPS_ERROR               "TECH_CANCEL_WPS_ERR"
 #define MSGID_TECHNOLOGY_START_WPS_ERROR                "TECH_START_WPS_ERR"
@@ -170,6 +204,16 @@ extern PmLogContext gLogContext;
 #define MSGID_CONNECTION_INFO                           "CONNECTION_INFO"
 #define MSGID_CM_ONLINE_CHECK_INFO                      "CM_RUN_ONLINE_CHECK_INFO"
 #define MSGID_CM_GET_MAC_INFO                           "CM_GET_MAC_INFO"
+#define MSGID_CM_GATEWAY_PROBE_INFO                     "CM_GATEWAY_PROBE_INFO"
+#define MSGID_CM_DNS_PROBE_INFO                         "CM_DNS_PROBE_INFO"
+#define MSGID_CM_WIRED_8021X_INFO                       "CM_WIRED_8021X_INFO"
+#define MSGID_CM_WIRED_8021X_ERROR                      "CM_WIRED_8021X_ERR"
+#define MSGID_CM_POWER_SAVE_INFO                        "CM_POWER_SAVE_INFO"
+#define MSGID_CM_POWER_SAVE_ERROR                       "CM_POWER_SAVE_ERR"
+#define MSGID_CM_P2P_GROUP_CACHE_INFO                   "CM_P2P_GROUP_CACHE_INFO"
+#define MSGID_CM_P2P_GROUP_CACHE_ERROR                  "CM_P2P_GROUP_CACHE_ERR"
+#define MSGID_CM_IPV6_ADDRESSES_ERROR                   "CM_IPV6_ADDRESSES_ERR"
+#define MSGID_CM_SELF_TEST_INFO                         "CM_SELF_TEST_INFO"
 
 /** wifi_service.c */
 #define MSGID_WIFI_CONNECT_HIDDEN_SERVICE               "WIFI_CONNECT_HIDDEN_SERVICE"
@@ -185,6 +229,17 @@ extern PmLogContext gLogContext;
 #define MSGID_WIFI_SERVICE_NOT_EXIST                    "WIFI_SERVICE_NOT_EXIST"
 #define MSGID_WIFI_CONFIG_INOTIFY_WATCH_ERR             "WIFI_CONFIG_INOTIFY_WATCH_ERR"
 #define MSGID_WIFI_SUBSCRIPTIONCANCEL_LUNA_ERROR        "WIFI_SUBSCRIPTIONCANCEL_LUNA_ERROR"
+#define MSGID_CONNMAN_LIVENESS_RECOVERY                 "CONNMAN_LIVENESS_RECOVERY"
+#define MSGID_WIFI_CERT_STORE_ERROR                     "WIFI_CERT_STORE_ERR"
+#define MSGID_WIFI_CERT_INVALID                         "WIFI_CERT_INVALID"
+#define MSGID_WIFI_CERT_EXPIRING                        "WIFI_CERT_EXPIRING"
+#define MSGID_WIFI_WOWLAN_ERROR                         "WIFI_WOWLAN_ERR"
+#define MSGID_WIFI_WOWLAN_INFO                          "WIFI_WOWLAN_INFO"
+#define MSGID_WIFI_PASSPOINT_ERROR                      "WIFI_PASSPOINT_ERR"
+#define MSGID_WIFI_PASSPOINT_INFO                       "WIFI_PASSPOINT_INFO"
+#define MSGID_WIFI_BAND_STEERING_ERROR                  "WIFI_BAND_STEERING_ERR"
+#define MSGID_WIFI_BAND_STEERING_INFO                   "WIFI_BAND_STEERING_INFO"
+#define MSGID_WIFI_AUTOCONNECT_PRIORITY_INFO            "WIFI_AUTOCONN_PRIO_INFO"
 
 /** Wifi Scan errors */
 #define MSGID_WIFI_SCAN_CALLBACK_NOT_RUNNING            "WIFI_SCAN_CALLBACK_NOT_RUNNING"
@@ -193,6 +248,7 @@ extern PmLogContext gLogContext;
 #define MSGID_WIFI_SCAN_START_ALREADY_STARTED           "WIFI_SCAN_START_ALREADY_STARTED"
 #define MSGID_WIFI_SCAN_STOP_ALREADY_STOPPED            "WIFI_SCAN_STOP_ALREADY_STOPPED"
 #define MSGID_WIFI_SCAN_REMOVE_INVERVAL_NOT_FOUND       "WIFI_SCAN_REMOVE_INVERVAL_NOT_FOUND"
+#define MSGID_WIFI_SCAN_RESULTS_ERROR                   "WIFI_SCAN_RESULTS_ERR"
 
 /** wifi_p2p_service.c */
 #define MSGID_P2P_CONNECT_PEER                          "P2P_CONNECT_PEER"
@@ -210,12 +266,20 @@ extern PmLogContext gLogContext;
 
 /** wifi_tethering_service. */
 #define MSGID_TETHERING_METHODS_LUNA_ERROR              "TETHERING_METHODS_LUNA_ERR"
+#define MSGID_TETHERING_STATION_REJECTED                "TETHERING_STA_REJECTED"
 
 /** wifi_setting.c */
 #define MSGID_SETTING_LPAPP_GET_ERROR                   "SETTING_LPAPP_GET_ERR"
 #define MSGID_SETTING_LPAPP_COPY_ERROR                  "SETTING_LPAPP_COPY_ERR"
 #define MSGID_SETTING_LPAPP_REMOVE_ERROR                "SETTING_LPAPP_REMOVE_ERR"
 #define MSGID_SETTING_LPAPP_SET_ERROR                   "SETTING_LPAPP_SET_ERR"
+#define MSGID_SETTING_PROFILE_DECRYPT_ERROR             "SETTING_PROFILE_DECRYPT_ERR"
+#define MSGID_SETTING_PROFILE_ENCRYPT_ERROR             "SETTING_PROFILE_ENCRYPT_ERR"
+#define MSGID_SETTING_PROFILE_MIGRATION                 "SETTING_PROFILE_MIGRATION"
+#define MSGID_SETTING_NAMESPACE_CONFIG_ERROR            "SETTING_NAMESPACE_CONFIG_ERR"
+
+/** wifi_profile.c */
+#define MSGID_WIFI_PROFILE_NAMESPACE                    "WIFI_PROFILE_NAMESPACE"
 
 /** pan_service.c */
 #define MSGID_PAN_LUNA_BUS_ERROR                       "PAN_LUNA_BUS_ERR"
@@ -224,10 +288,12 @@ extern PmLogContext gLogContext;
 #define MSGID_PAN_CONNECT_SERVICE_ERROR                "PAN_CONNECT_SERVICE_ERROR"
 #define MSGID_PAN_SKIPPING_FETCH_PROPERTIES            "PAN_SKIPPING_FETCH_PROPERTIES"
 #define MSGID_PAN_SERVICE_NOT_EXIST                    "PAN_SERVICE_NOT_EXIST"
+#define MSGID_PAN_RECONNECT_INFO                       "PAN_RECONNECT_INFO"
 
 /** country_code.c */
 #define MSGID_COUNTRY_CODE_INFO                         "COUNTRY_CODE_INFO"
 #define MSGID_COUNTRY_CODE_FAILED                       "COUNTRY_CODE_FAILED"
+#define MSGID_COUNTRY_CODE_INFERRED                     "COUNTRY_CODE_INFERRED"
 
 /** nyx.c */
 #define MSGID_NYX_INIT_ERROR                            "NYX_INIT_ERROR"
@@ -239,6 +305,8 @@ extern PmLogContext gLogContext;
 #define MSGID_WAN_CONNECT_INFO                          "WAN_CONNECT_INFO"
 #define MSGID_WAN_DISCONNECT_INFO                       "WAN_DISCONNECT_INFO"
 #define MSGID_WAN_SET_HOSTROUTE_ERROR                   "WAN_SET_HOSTROUTE_ERR"
+#define MSGID_WAN_FAILOVER_INFO                         "WAN_FAILOVER_INFO"
+#define MSGID_WAN_FAILOVER_ERROR                        "WAN_FAILOVER_ERR"
 
 /** json_utils.c **/
 #define MSGID_JSON_KEY_NULL                             "JSON_KEY_NULL"
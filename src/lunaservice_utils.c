@@ -24,6 +24,7 @@
 #include "lunaservice_utils.h"
 #include "logging.h"
 #include "errors.h"
+#include "dbus_call.h"
 
 luna_service_request_t *luna_service_request_new(LSHandle *handle,
         LSMessage *message)
@@ -33,8 +34,10 @@ luna_service_request_t *luna_service_request_new(LSHandle *handle,
 	req = g_new0(luna_service_request_t, 1);
 	req->handle = handle;
 	req->message = message;
+	req->cancellable = g_cancellable_new();
 
 	LSMessageRef(message);
+	dbus_call_scope_add(LSMessageGetUniqueToken(message), req->cancellable);
 
 	return req;
 }
@@ -43,9 +46,13 @@ void luna_service_request_free(luna_service_request_t *service_req)
 {
 	if (service_req->message)
 	{
+		dbus_call_scope_remove(LSMessageGetUniqueToken(service_req->message),
+		                       service_req->cancellable);
 		LSMessageUnref(service_req->message);
 	}
 
+	g_object_unref(service_req->cancellable);
+
 	g_free(service_req);
 }
 
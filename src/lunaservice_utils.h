@@ -25,6 +25,7 @@
 #ifndef __LUNASERVICE_UTILS_H__
 #define __LUNASERVICE_UTILS_H__
 
+#include <gio/gio.h>
 #include <luna-service2/lunaservice.h>
 #include "json_utils.h"
 
@@ -33,6 +34,8 @@ typedef struct luna_service_request
 	LSHandle *handle;
 	LSMessage *message;
 	void *user_data;
+	/* Cancelled when the caller cancels the call or leaves the bus */
+	GCancellable *cancellable;
 } luna_service_request_t;
 
 extern luna_service_request_t *luna_service_request_new(LSHandle *handle,
@@ -39,6 +39,8 @@
 #include "wan_service.h"
 #include "pan_service.h"
 #include "connectionmanager_service.h"
+#include "runtime_params.h"
+#include "dbus_call.h"
 #include "nyx.h"
 
 static GMainLoop *mainloop = NULL;
@@ -52,12 +54,104 @@ PmLogContext gLogContext;
 
 static const char *const kLogContextName = "webos-connman-adapter";
 
+/**
+ * Budgets of messages logged on every service or property change, which
+ * flood the log during scan storms and flapping links
+ */
+static const struct
+{
+	const gchar *msgid;
+	guint rate;
+	guint burst;
+} log_budgets[] =
+{
+	{ MSGID_CONNECTION_INFO, 2, 5 },
+	{ MSGID_WIFI_SKIPPING_FETCH_PROPERTIES, 1, 5 },
+	{ "SSID_CONVERSION", 2, 10 },
+};
+
 void
 term_handler(int signal)
 {
 	g_main_loop_quit(mainloop);
 }
 
+static void
+runtime_param_changed(const runtime_param_change_t *change, gpointer user_data)
+{
+	if (RUNTIME_PARAM_LOG_RATE_LIMIT == change->param ||
+	        RUNTIME_PARAM_LOG_RATE_BURST == change->param)
+	{
+		log_limiter_set_default_budget(runtime_param_get(RUNTIME_PARAM_LOG_RATE_LIMIT),
+		                               runtime_param_get(RUNTIME_PARAM_LOG_RATE_BURST));
+	}
+
+	WCALOG_INFO(MSGID_RUNTIME_PARAM_CHANGED, 4,
+	            PMLOGKS("Name", runtime_param_get_name(change->param)),
+	            PMLOGKFV("Old", "%u", change->old_value),
+	            PMLOGKFV("New", "%u", change->new_value),
+	            PMLOGKS("Source", change->source), "");
+}
+
+static void
+log_dropped(const gchar *id, guint count, gpointer user_data)
+{
+	WCALOG_WARNING(MSGID_LOG_DROPPED, 0, "Suppressed %u messages for %s", count,
+	               id);
+}
+
+static gboolean
+log_summary_timeout(gpointer user_data)
+{
+	log_limiter_flush(log_dropped, NULL);
+
+	/* Pick up a changed interval */
+	g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_LOG_SUMMARY_INTERVAL),
+	                      log_summary_timeout, NULL);
+	return FALSE;
+}
+
+static void
+init_log_limiter(void)
+{
+	guint i;
+
+	log_limiter_set_default_budget(runtime_param_get(RUNTIME_PARAM_LOG_RATE_LIMIT),
+	                               runtime_param_get(RUNTIME_PARAM_LOG_RATE_BURST));
+
+	for (i = 0; i < G_N_ELEMENTS(log_budgets); i++)
+	{
+		log_limiter_set_budget(log_budgets[i].msgid, log_budgets[i].rate,
+		                       log_budgets[i].burst);
+	}
+
+	g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_LOG_SUMMARY_INTERVAL),
+	                      log_summary_timeout, NULL);
+}
+
+static void
+runtime_params_reloaded(const gchar *pathname, const GError *error,
+                        gpointer user_data)
+{
+	/* The config file is optional */
+	if (NULL != error && !g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+	{
+		WCALOG_ERROR(MSGID_RUNTIME_PARAMS_LOAD_ERROR, 2, PMLOGKS("File", pathname),
+		             PMLOGKS(ERRTEXT, error->message), "");
+	}
+}
+
+static void
+dbus_call_timed_out(dbus_call_t call, const dbus_call_stats_t *stats,
+                    gpointer user_data)
+{
+	WCALOG_WARNING(MSGID_DBUS_CALL_TIMEOUT, 4,
+	               PMLOGKS("Call", dbus_call_get_name(call)),
+	               PMLOGKFV("Deadline", "%d", dbus_call_get_deadline(call)),
+	               PMLOGKFV("Timeouts", "%u", stats->timeouts),
+	               PMLOGKFV("Calls", "%u", stats->calls), "");
+}
+
 int
 main(int argc, char **argv)
 {
@@ -71,6 +165,19 @@ main(int argc, char **argv)
 
 	WCALOG_DEBUG("Starting webos-connman-adapter");
 
+	GError *error = NULL;
+
+	runtime_params_set_changed_callback(runtime_param_changed, NULL);
+	runtime_params_load_file(RUNTIME_PARAMS_CONFIG_FILE, &error);
+	runtime_params_reloaded(RUNTIME_PARAMS_CONFIG_FILE, error, NULL);
+	g_clear_error(&error);
+
+	runtime_params_watch(RUNTIME_PARAMS_CONFIG_FILE, runtime_params_reloaded, NULL);
+
+	init_log_limiter();
+
+	dbus_call_set_timeout_callback(dbus_call_timed_out, NULL);
+
 	if (!init_nyx())
 	{
 		WCALOG_ERROR(MSGID_WIFI_SRVC_REGISTER_FAIL, 0,
@@ -124,6 +231,8 @@ main(int argc, char **argv)
 
 	remove_config_inotify_watch();
 
+	runtime_params_unwatch();
+
 	g_main_loop_unref(mainloop);
 
 	release_nyx();
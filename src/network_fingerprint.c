@@ -0,0 +1,473 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  network_fingerprint.c
+ *
+ * @brief Computes network fingerprints and keeps the settings bound to them
+ *
+ * Bindings are kept in a hash table keyed by the fingerprint, so finding the
+ * settings of a network which just got ready takes a single lookup.
+ */
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "network_fingerprint.h"
+
+#define HW_ADDR_LEN                 6
+#define FINGERPRINT_HEX_LEN         16
+
+/* 64 bit FNV-1a */
+#define FNV_OFFSET_BASIS            G_GUINT64_CONSTANT(0xcbf29ce484222325)
+#define FNV_PRIME                   G_GUINT64_CONSTANT(0x100000001b3)
+
+/* Set in the first octet of addresses which don't carry a vendor OUI */
+#define LOCALLY_ADMINISTERED_BIT    0x02
+
+static GHashTable *binding_table = NULL;
+static GHashTable *applied_table = NULL;
+
+static void clear_ipv4(ipv4info_t *ipv4)
+{
+	g_free(ipv4->method);
+	g_free(ipv4->address);
+	g_free(ipv4->netmask);
+	g_free(ipv4->gateway);
+	memset(ipv4, 0, sizeof(*ipv4));
+}
+
+static void clear_proxy(proxyinfo_t *proxy)
+{
+	g_free(proxy->method);
+	g_free(proxy->url);
+	g_strfreev(proxy->servers);
+	g_strfreev(proxy->excludes);
+	memset(proxy, 0, sizeof(*proxy));
+}
+
+static void clear_binding(network_binding_t *binding)
+{
+	clear_ipv4(&binding->ipv4);
+	g_strfreev(binding->dns);
+	binding->dns = NULL;
+	clear_proxy(&binding->proxy);
+}
+
+static void binding_free(gpointer data)
+{
+	clear_binding(data);
+	g_free(data);
+}
+
+static void applied_free(gpointer data)
+{
+	network_applied_t *applied = data;
+
+	clear_binding(&applied->written);
+	clear_binding(&applied->previous);
+	g_free(applied);
+}
+
+static GHashTable *get_binding_table(void)
+{
+	if (NULL == binding_table)
+	{
+		/* The key is owned by the binding */
+		binding_table = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+		                                      binding_free);
+	}
+
+	return binding_table;
+}
+
+static GHashTable *get_applied_table(void)
+{
+	if (NULL == applied_table)
+	{
+		applied_table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+		                                      applied_free);
+	}
+
+	return applied_table;
+}
+
+static guint64 fnv_hash(guint64 hash, const guint8 *data, gsize len)
+{
+	gsize n;
+
+	for (n = 0; n < len; n++)
+	{
+		hash ^= data[n];
+		hash *= FNV_PRIME;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Parse the OUI from the first three octets of a BSSID
+ */
+
+static gboolean parse_oui(const gchar *bssid, guint32 *oui)
+{
+	guint32 value = 0;
+	gsize n;
+
+	for (n = 0; n < 3; n++)
+	{
+		gint high = g_ascii_xdigit_value(bssid[n * 3]);
+		gint low = high < 0 ? -1 : g_ascii_xdigit_value(bssid[n * 3 + 1]);
+
+		if (high < 0 || low < 0)
+		{
+			return FALSE;
+		}
+
+		value = (value << 8) | (high << 4) | low;
+	}
+
+	/* Virtual BSSIDs of multi SSID access points are often locally administered */
+	if ((value >> 16) & LOCALLY_ADMINISTERED_BIT)
+	{
+		return FALSE;
+	}
+
+	*oui = value;
+	return TRUE;
+}
+
+static gint compare_oui(gconstpointer a, gconstpointer b)
+{
+	guint32 oui_a = *(const guint32 *) a;
+	guint32 oui_b = *(const guint32 *) b;
+
+	return (oui_a > oui_b) - (oui_a < oui_b);
+}
+
+/**
+ * Compute the site of a network (see header for API details)
+ */
+
+gboolean network_fingerprint_compute_site(const gchar *ssid,
+        const guint8 *gateway_mac, guint64 *site)
+{
+	guint64 hash = FNV_OFFSET_BASIS;
+
+	if (NULL == gateway_mac || NULL == site)
+	{
+		return FALSE;
+	}
+
+	if (NULL != ssid)
+	{
+		hash = fnv_hash(hash, (const guint8 *) ssid, strlen(ssid));
+	}
+
+	/* Separates the SSID from the binary part */
+	hash = fnv_hash(hash, (const guint8 *) "", 1);
+	*site = fnv_hash(hash, gateway_mac, HW_ADDR_LEN);
+	return TRUE;
+}
+
+/**
+ * Compute the fingerprint of a network (see header for API details)
+ */
+
+gboolean network_fingerprint_compute(const gchar *ssid,
+                                     const guint8 *gateway_mac, const bssinfo_t *bss, guint num_bss,
+                                     guint64 *fingerprint)
+{
+	guint64 hash;
+	guint32 *ouis;
+	guint num_ouis = 0;
+	guint n;
+
+	/* The fingerprint extends the site with the access point vendors */
+	if (NULL == fingerprint ||
+	        !network_fingerprint_compute_site(ssid, gateway_mac, &hash))
+	{
+		return FALSE;
+	}
+
+	if (NULL == bss)
+	{
+		num_bss = 0;
+	}
+
+	ouis = g_new(guint32, num_bss + 1);
+
+	for (n = 0; n < num_bss; n++)
+	{
+		if (parse_oui(bss[n].bssid, &ouis[num_ouis]))
+		{
+			num_ouis++;
+		}
+	}
+
+	qsort(ouis, num_ouis, sizeof(guint32), compare_oui);
+
+	for (n = 0; n < num_ouis; n++)
+	{
+		if (n > 0 && ouis[n] == ouis[n - 1])
+		{
+			continue;
+		}
+
+		guint8 octets[3] = { ouis[n] >> 16, ouis[n] >> 8, ouis[n] };
+		hash = fnv_hash(hash, octets, sizeof(octets));
+	}
+
+	g_free(ouis);
+
+	*fingerprint = hash;
+	return TRUE;
+}
+
+/**
+ * Convert a fingerprint to a string (see header for API details)
+ */
+
+gchar *network_fingerprint_to_string(guint64 fingerprint)
+{
+	return g_strdup_printf("%016" G_GINT64_MODIFIER "x", fingerprint);
+}
+
+/**
+ * Parse a fingerprint string (see header for API details)
+ */
+
+gboolean network_fingerprint_from_string(const gchar *str,
+        guint64 *fingerprint)
+{
+	guint64 value = 0;
+	gsize n;
+
+	if (NULL == str || NULL == fingerprint || strlen(str) != FINGERPRINT_HEX_LEN)
+	{
+		return FALSE;
+	}
+
+	for (n = 0; n < FINGERPRINT_HEX_LEN; n++)
+	{
+		gint digit = g_ascii_xdigit_value(str[n]);
+
+		if (digit < 0)
+		{
+			return FALSE;
+		}
+
+		value = (value << 4) | digit;
+	}
+
+	*fingerprint = value;
+	return TRUE;
+}
+
+/**
+ * Look up the settings bound to a fingerprint (see header for API details)
+ */
+
+network_binding_t *network_binding_lookup(guint64 fingerprint)
+{
+	return g_hash_table_lookup(get_binding_table(), &fingerprint);
+}
+
+static network_binding_t *get_or_create_binding(guint64 fingerprint)
+{
+	network_binding_t *binding = network_binding_lookup(fingerprint);
+
+	if (NULL == binding)
+	{
+		binding = g_new0(network_binding_t, 1);
+		binding->fingerprint = fingerprint;
+		g_hash_table_insert(get_binding_table(), &binding->fingerprint, binding);
+	}
+
+	return binding;
+}
+
+/**
+ * Bind IPv4 settings to a fingerprint (see header for API details)
+ */
+
+void network_binding_set_ipv4(guint64 fingerprint, const ipv4info_t *ipv4)
+{
+	network_binding_copy_ipv4(&get_or_create_binding(fingerprint)->ipv4, ipv4);
+}
+
+/**
+ * Bind DNS servers to a fingerprint (see header for API details)
+ */
+
+void network_binding_set_dns(guint64 fingerprint, GStrv dns)
+{
+	network_binding_t *binding = get_or_create_binding(fingerprint);
+
+	g_strfreev(binding->dns);
+	binding->dns = g_strdupv(dns);
+}
+
+/**
+ * Bind proxy settings to a fingerprint (see header for API details)
+ */
+
+void network_binding_set_proxy(guint64 fingerprint, const proxyinfo_t *proxy)
+{
+	network_binding_copy_proxy(&get_or_create_binding(fingerprint)->proxy,
+	                           proxy);
+}
+
+/**
+ * Remove the settings bound to a fingerprint (see header for API details)
+ */
+
+gboolean network_binding_remove(guint64 fingerprint)
+{
+	return g_hash_table_remove(get_binding_table(), &fingerprint);
+}
+
+/**
+ * Remove all bindings (see header for API details)
+ */
+
+void network_binding_clear(void)
+{
+	g_hash_table_remove_all(get_binding_table());
+	g_hash_table_remove_all(get_applied_table());
+}
+
+/**
+ * Get all bindings (see header for API details)
+ */
+
+GList *network_binding_get_all(void)
+{
+	return g_hash_table_get_values(get_binding_table());
+}
+
+/**
+ * Copy IPv4 settings (see header for API details)
+ */
+
+void network_binding_copy_ipv4(ipv4info_t *dest, const ipv4info_t *src)
+{
+	ipv4info_t copy =
+	{
+		.method = g_strdup(src->method),
+		.address = g_strdup(src->address),
+		.netmask = g_strdup(src->netmask),
+		.gateway = g_strdup(src->gateway),
+	};
+
+	clear_ipv4(dest);
+	*dest = copy;
+}
+
+/**
+ * Copy proxy settings (see header for API details)
+ */
+
+void network_binding_copy_proxy(proxyinfo_t *dest, const proxyinfo_t *src)
+{
+	proxyinfo_t copy =
+	{
+		.method = g_strdup(src->method),
+		.url = g_strdup(src->url),
+		.servers = g_strdupv(src->servers),
+		.excludes = g_strdupv(src->excludes),
+	};
+
+	clear_proxy(dest);
+	*dest = copy;
+}
+
+/**
+ * Remember that bound settings are applied to a service (see header for API
+ * details)
+ */
+
+network_applied_t *network_binding_set_applied(const gchar *identifier,
+        guint64 site)
+{
+	network_applied_t *applied;
+
+	if (NULL == identifier)
+	{
+		return NULL;
+	}
+
+	applied = network_binding_get_applied_to(identifier);
+
+	if (NULL == applied)
+	{
+		applied = g_new0(network_applied_t, 1);
+		g_hash_table_insert(get_applied_table(), g_strdup(identifier), applied);
+	}
+
+	applied->site = site;
+	return applied;
+}
+
+/**
+ * Get the record of the applied settings (see header for API details)
+ */
+
+network_applied_t *network_binding_get_applied_to(const gchar *identifier)
+{
+	if (NULL == identifier)
+	{
+		return NULL;
+	}
+
+	return g_hash_table_lookup(get_applied_table(), identifier);
+}
+
+/**
+ * Forget the applied settings (see header for API details)
+ */
+
+void network_binding_forget_applied(const gchar *identifier)
+{
+	if (NULL != identifier)
+	{
+		g_hash_table_remove(get_applied_table(), identifier);
+	}
+}
+
+/**
+ * Check if bound settings are applied to a service (see header for API details)
+ */
+
+gboolean network_binding_is_applied(const gchar *identifier)
+{
+	if (NULL == identifier)
+	{
+		return FALSE;
+	}
+
+	return g_hash_table_contains(get_applied_table(), identifier);
+}
+
+/**
+ * Get all services bound settings are applied to (see header for API details)
+ */
+
+GList *network_binding_get_applied(void)
+{
+	return g_hash_table_get_keys(get_applied_table());
+}
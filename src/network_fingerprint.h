@@ -0,0 +1,226 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  network_fingerprint.h
+ *
+ * @brief Header file defining network fingerprints, which tell apart networks
+ *        sharing the same SSID, and the IP / DNS / proxy settings bound to them
+ *
+ */
+
+#ifndef _NETWORK_FINGERPRINT_H_
+#define _NETWORK_FINGERPRINT_H_
+
+#include <glib.h>
+
+#include "connman_service.h"
+
+/**
+ * Settings bound to a network fingerprint. Settings which aren't bound have
+ * their method (ipv4, proxy) or list (dns) set to NULL.
+ */
+typedef struct network_binding
+{
+	guint64 fingerprint;
+	ipv4info_t ipv4;
+	GStrv dns;
+	proxyinfo_t proxy;
+} network_binding_t;
+
+/**
+ * Bound settings applied to a service: the settings the binding wrote and
+ * the ones they replaced, so they can be put back once the service is on
+ * another network. Only settings set in written have a previous value.
+ */
+typedef struct network_applied
+{
+	guint64 site;               /* Site of the network they were applied on */
+	network_binding_t written;  /* fingerprint is the one of the binding */
+	network_binding_t previous;
+} network_applied_t;
+
+/**
+ * Compute the fingerprint of a network from its SSID, the hardware address of
+ * its gateway and the set of vendor OUIs of its access points. The order of
+ * the BSS entries doesn't matter.
+ *
+ * @param[IN]  ssid SSID of the network, NULL for wired networks
+ * @param[IN]  gateway_mac Hardware address of the gateway (6 bytes)
+ * @param[IN]  bss Array of BSS entries of the network. May be NULL.
+ * @param[IN]  num_bss Number of entries in bss
+ * @param[OUT] fingerprint Computed fingerprint
+ *
+ * @return FALSE if gateway_mac is NULL, TRUE otherwise
+ */
+extern gboolean network_fingerprint_compute(const gchar *ssid,
+        const guint8 *gateway_mac, const bssinfo_t *bss, guint num_bss,
+        guint64 *fingerprint);
+
+/**
+ * Compute the site of a network from its SSID and the hardware address of
+ * its gateway only. Unlike the fingerprint it doesn't change when access
+ * points of another vendor come into range.
+ *
+ * @param[IN]  ssid SSID of the network, NULL for wired networks
+ * @param[IN]  gateway_mac Hardware address of the gateway (6 bytes)
+ * @param[OUT] site Computed site
+ *
+ * @return FALSE if gateway_mac is NULL, TRUE otherwise
+ */
+extern gboolean network_fingerprint_compute_site(const gchar *ssid,
+        const guint8 *gateway_mac, guint64 *site);
+
+/**
+ * Convert a fingerprint to the hex string used over the luna API
+ *
+ * @param[IN]  fingerprint Fingerprint to convert
+ *
+ * @return Newly allocated string, free with g_free
+ */
+extern gchar *network_fingerprint_to_string(guint64 fingerprint);
+
+/**
+ * Parse a fingerprint created by network_fingerprint_to_string
+ *
+ * @param[IN]  str String to parse
+ * @param[OUT] fingerprint Parsed fingerprint
+ *
+ * @return FALSE if the string is malformed, TRUE otherwise
+ */
+extern gboolean network_fingerprint_from_string(const gchar *str,
+        guint64 *fingerprint);
+
+/**
+ * Look up the settings bound to a fingerprint
+ *
+ * @param[IN]  fingerprint Fingerprint of the network
+ *
+ * @return Bound settings or NULL if nothing is bound to the fingerprint
+ */
+extern network_binding_t *network_binding_lookup(guint64 fingerprint);
+
+/**
+ * Bind IPv4 settings to a fingerprint, replacing the ones bound before
+ *
+ * @param[IN]  fingerprint Fingerprint of the network
+ * @param[IN]  ipv4 IPv4 settings to copy
+ */
+extern void network_binding_set_ipv4(guint64 fingerprint,
+                                     const ipv4info_t *ipv4);
+
+/**
+ * Bind a list of DNS servers to a fingerprint, replacing the one bound before
+ *
+ * @param[IN]  fingerprint Fingerprint of the network
+ * @param[IN]  dns DNS servers to copy
+ */
+extern void network_binding_set_dns(guint64 fingerprint, GStrv dns);
+
+/**
+ * Bind proxy settings to a fingerprint, replacing the ones bound before
+ *
+ * @param[IN]  fingerprint Fingerprint of the network
+ * @param[IN]  proxy Proxy settings to copy
+ */
+extern void network_binding_set_proxy(guint64 fingerprint,
+                                      const proxyinfo_t *proxy);
+
+/**
+ * Remove all settings bound to a fingerprint
+ *
+ * @param[IN]  fingerprint Fingerprint of the network
+ *
+ * @return FALSE if nothing was bound to the fingerprint, TRUE otherwise
+ */
+extern gboolean network_binding_remove(guint64 fingerprint);
+
+/**
+ * Remove all bindings and forget all services they were applied to
+ */
+extern void network_binding_clear(void);
+
+/**
+ * Get all bindings
+ *
+ * @return List of network_binding_t, free with g_list_free
+ */
+extern GList *network_binding_get_all(void);
+
+/**
+ * Copy IPv4 settings, replacing the ones in dest
+ *
+ * @param[IN]  dest Settings to replace
+ * @param[IN]  src Settings to copy
+ */
+extern void network_binding_copy_ipv4(ipv4info_t *dest, const ipv4info_t *src);
+
+/**
+ * Copy proxy settings, replacing the ones in dest
+ *
+ * @param[IN]  dest Settings to replace
+ * @param[IN]  src Settings to copy
+ */
+extern void network_binding_copy_proxy(proxyinfo_t *dest,
+                                       const proxyinfo_t *src);
+
+/**
+ * Remember that bound settings are applied to a service. The caller fills
+ * in what was written and replaced.
+ *
+ * @param[IN]  identifier Identifier of the service
+ * @param[IN]  site Site of the network they are applied on
+ *
+ * @return Record of the applied settings, the existing one if settings were
+ *         applied before, owned by the module. NULL if identifier is NULL.
+ */
+extern network_applied_t *network_binding_set_applied(const gchar *identifier,
+        guint64 site);
+
+/**
+ * Get the record of the bound settings applied to a service
+ *
+ * @param[IN]  identifier Identifier of the service
+ *
+ * @return Record owned by the module, NULL if no bound settings are applied
+ */
+extern network_applied_t *network_binding_get_applied_to(
+    const gchar *identifier);
+
+/**
+ * Forget the bound settings applied to a service, once they were undone
+ *
+ * @param[IN]  identifier Identifier of the service
+ */
+extern void network_binding_forget_applied(const gchar *identifier);
+
+/**
+ * Check if bound settings are applied to a service
+ *
+ * @param[IN]  identifier Identifier of the service
+ *
+ * @return TRUE if bound settings are applied, FALSE otherwise
+ */
+extern gboolean network_binding_is_applied(const gchar *identifier);
+
+/**
+ * Get the identifiers of all services bound settings are applied to
+ *
+ * @return List of identifiers owned by the module, free with g_list_free
+ */
+extern GList *network_binding_get_applied(void);
+
+#endif /* _NETWORK_FINGERPRINT_H_ */
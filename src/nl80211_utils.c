@@ -0,0 +1,611 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  nl80211_utils.c
+ *
+ * @brief Helpers to talk nl80211 over a generic netlink socket
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <net/if.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+
+#include "nl80211_utils.h"
+
+#define NL_RECV_SIZE            32768
+#define NL_TIMEOUT_S            1
+#define MAX_GROUPS              16
+
+G_DEFINE_QUARK(nl80211-utils-error-quark, nl80211_utils_error)
+
+typedef struct group
+{
+	gchar name[GENL_NAMSIZ];
+	guint32 id;
+} group_t;
+
+static guint32 nl_seq = 0;
+static guint16 nl80211_family = 0;
+static group_t nl80211_groups[MAX_GROUPS];
+static guint nl80211_num_groups = 0;
+
+/**
+ * Append an attribute (see header for API details)
+ */
+
+void genl_put_attr(genl_buf_t *buf, guint16 type, const void *data, gsize len)
+{
+	struct nlattr *attr;
+
+	if (buf->overflow || buf->len + NLA_HDRLEN + NLA_ALIGN(len) > buf->size)
+	{
+		buf->overflow = TRUE;
+		return;
+	}
+
+	attr = (struct nlattr *)(buf->data + buf->len);
+	attr->nla_type = type;
+	attr->nla_len = NLA_HDRLEN + len;
+	memset(buf->data + buf->len + NLA_HDRLEN, 0, NLA_ALIGN(len));
+
+	if (len)
+	{
+		memcpy(buf->data + buf->len + NLA_HDRLEN, data, len);
+	}
+
+	buf->len += NLA_HDRLEN + NLA_ALIGN(len);
+}
+
+void genl_put_u32(genl_buf_t *buf, guint16 type, guint32 value)
+{
+	genl_put_attr(buf, type, &value, sizeof(value));
+}
+
+/**
+ * Start a nested attribute (see header for API details)
+ */
+
+gsize genl_nest_start(genl_buf_t *buf, guint16 type)
+{
+	gsize start = buf->len;
+
+	genl_put_attr(buf, type | NLA_F_NESTED, NULL, 0);
+
+	return start;
+}
+
+void genl_nest_end(genl_buf_t *buf, gsize start)
+{
+	if (!buf->overflow)
+	{
+		((struct nlattr *)(buf->data + start))->nla_len = buf->len - start;
+	}
+}
+
+/**
+ * Get the next attribute (see header for API details)
+ */
+
+const struct nlattr *genl_next_attr(const guint8 **pos, const guint8 *end)
+{
+	const struct nlattr *attr = (const struct nlattr *) *pos;
+
+	if (end - *pos < NLA_HDRLEN || attr->nla_len < NLA_HDRLEN ||
+	        attr->nla_len > end - *pos)
+	{
+		return NULL;
+	}
+
+	*pos += MIN((gsize) NLA_ALIGN(attr->nla_len), (gsize)(end - *pos));
+
+	return attr;
+}
+
+guint16 genl_attr_type(const struct nlattr *attr)
+{
+	return attr->nla_type & NLA_TYPE_MASK;
+}
+
+const guint8 *genl_attr_data(const struct nlattr *attr)
+{
+	return (const guint8 *) attr + NLA_HDRLEN;
+}
+
+gsize genl_attr_len(const struct nlattr *attr)
+{
+	return attr->nla_len - NLA_HDRLEN;
+}
+
+/**
+ * Get the payload of an attribute as u32 (see header for API details)
+ */
+
+guint32 genl_attr_u32(const struct nlattr *attr)
+{
+	guint32 value = 0;
+
+	if (genl_attr_len(attr) >= sizeof(value))
+	{
+		memcpy(&value, genl_attr_data(attr), sizeof(value));
+	}
+
+	return value;
+}
+
+static void msg_init(genl_buf_t *msg, guint8 *data, guint16 family,
+                     guint8 cmd, guint16 flags)
+{
+	struct nlmsghdr *hdr = (struct nlmsghdr *) data;
+	struct genlmsghdr *genl = NLMSG_DATA(hdr);
+
+	memset(data, 0, NLMSG_LENGTH(GENL_HDRLEN));
+	hdr->nlmsg_type = family;
+	/* Dumps end with NLMSG_DONE, everything else is acked */
+	hdr->nlmsg_flags = NLM_F_REQUEST | (flags & NLM_F_DUMP ? flags : flags | NLM_F_ACK);
+	hdr->nlmsg_seq = ++nl_seq;
+	genl->cmd = cmd;
+	genl->version = 1;
+
+	msg->data = data;
+	msg->size = NL80211_UTILS_MSG_SIZE;
+	msg->len = NLMSG_LENGTH(GENL_HDRLEN);
+	msg->overflow = FALSE;
+}
+
+/**
+ * Start an nl80211 request (see header for API details)
+ */
+
+void nl80211_msg_init(genl_buf_t *msg, guint8 *data, guint8 cmd,
+                      guint16 flags)
+{
+	msg_init(msg, data, nl80211_family, cmd, flags);
+}
+
+/**
+ * Send a request (see header for API details)
+ */
+
+gboolean nl80211_request(int fd, genl_buf_t *msg, nl80211_answer_cb cb,
+                         gpointer user_data, GError **error)
+{
+	struct nlmsghdr *request = (struct nlmsghdr *) msg->data;
+	guint32 buf[NL_RECV_SIZE / sizeof(guint32)];
+
+	if (msg->overflow)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "Netlink request too large");
+		return FALSE;
+	}
+
+	request->nlmsg_len = msg->len;
+
+	if (send(fd, msg->data, msg->len, 0) < 0)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "Failed to send netlink request: %s", strerror(errno));
+		return FALSE;
+	}
+
+	while (TRUE)
+	{
+		ssize_t len = recv(fd, buf, sizeof(buf), 0);
+		struct nlmsghdr *hdr;
+
+		if (len < 0)
+		{
+			g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+			            "No answer from the kernel: %s", strerror(errno));
+			return FALSE;
+		}
+
+		for (hdr = (struct nlmsghdr *) buf; NLMSG_OK(hdr, len);
+		        hdr = NLMSG_NEXT(hdr, len))
+		{
+			if (hdr->nlmsg_seq != request->nlmsg_seq)
+			{
+				continue;
+			}
+
+			if (NLMSG_DONE == hdr->nlmsg_type)
+			{
+				return TRUE;
+			}
+
+			if (NLMSG_ERROR == hdr->nlmsg_type)
+			{
+				const struct nlmsgerr *err = NLMSG_DATA(hdr);
+
+				if (0 == err->error)
+				{
+					return TRUE;
+				}
+
+				g_set_error(error, NL80211_UTILS_ERROR,
+				            -EOPNOTSUPP == err->error ? NL80211_UTILS_ERROR_UNSUPPORTED :
+				            NL80211_UTILS_ERROR_FAILED,
+				            "Kernel refused the request: %s", strerror(-err->error));
+				return FALSE;
+			}
+
+			if (NULL != cb && hdr->nlmsg_len >= NLMSG_LENGTH(GENL_HDRLEN))
+			{
+				cb((const guint8 *) NLMSG_DATA(hdr) + GENL_HDRLEN,
+				   hdr->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN), user_data);
+			}
+		}
+	}
+}
+
+static void add_group(const struct nlattr *group)
+{
+	const guint8 *pos = genl_attr_data(group);
+	const guint8 *end = pos + genl_attr_len(group);
+	const struct nlattr *field;
+	group_t *entry;
+
+	if (nl80211_num_groups == MAX_GROUPS)
+	{
+		return;
+	}
+
+	entry = &nl80211_groups[nl80211_num_groups];
+	memset(entry, 0, sizeof(group_t));
+
+	while (NULL != (field = genl_next_attr(&pos, end)))
+	{
+		if (CTRL_ATTR_MCAST_GRP_NAME == genl_attr_type(field))
+		{
+			g_strlcpy(entry->name, (const gchar *) genl_attr_data(field),
+			          MIN(sizeof(entry->name), genl_attr_len(field)));
+		}
+		else if (CTRL_ATTR_MCAST_GRP_ID == genl_attr_type(field))
+		{
+			entry->id = genl_attr_u32(field);
+		}
+	}
+
+	if (entry->id)
+	{
+		nl80211_num_groups++;
+	}
+}
+
+static void family_cb(const guint8 *attrs, gsize len, gpointer user_data)
+{
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		if (CTRL_ATTR_FAMILY_ID == genl_attr_type(attr) && genl_attr_len(attr) >= 2)
+		{
+			memcpy(&nl80211_family, genl_attr_data(attr), sizeof(nl80211_family));
+		}
+		else if (CTRL_ATTR_MCAST_GROUPS == genl_attr_type(attr))
+		{
+			const guint8 *group_pos = genl_attr_data(attr);
+			const guint8 *groups_end = group_pos + genl_attr_len(attr);
+			const struct nlattr *group;
+
+			while (NULL != (group = genl_next_attr(&group_pos, groups_end)))
+			{
+				add_group(group);
+			}
+		}
+	}
+}
+
+/* Look up the nl80211 family and its multicast groups once */
+static gboolean resolve_family(int fd, GError **error)
+{
+	guint8 data[NL80211_UTILS_MSG_SIZE];
+	genl_buf_t msg;
+
+	if (nl80211_family)
+	{
+		return TRUE;
+	}
+
+	nl80211_num_groups = 0;
+
+	msg_init(&msg, data, GENL_ID_CTRL, CTRL_CMD_GETFAMILY, 0);
+	genl_put_attr(&msg, CTRL_ATTR_FAMILY_NAME, NL80211_GENL_NAME,
+	              sizeof(NL80211_GENL_NAME));
+
+	/* The controller answers ENOENT for families the kernel lacks */
+	if (!nl80211_request(fd, &msg, family_cb, NULL, NULL) || 0 == nl80211_family)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_UNSUPPORTED,
+		            "No nl80211 in the kernel");
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Open a socket (see header for API details)
+ */
+
+int nl80211_open(GError **error)
+{
+	struct sockaddr_nl addr;
+	struct timeval timeout = { NL_TIMEOUT_S, 0 };
+	int fd;
+
+	fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_GENERIC);
+
+	if (fd < 0)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "Failed to open netlink socket: %s", strerror(errno));
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+
+	if (bind(fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "Failed to bind netlink socket: %s", strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	/* Don't hang the main loop, or a suspend, if the kernel doesn't answer */
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	if (!resolve_family(fd, error))
+	{
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/**
+ * Get the id of a multicast group (see header for API details)
+ */
+
+guint32 nl80211_get_group(const gchar *name)
+{
+	guint i;
+
+	for (i = 0; i < nl80211_num_groups; i++)
+	{
+		if (!g_strcmp0(nl80211_groups[i].name, name))
+		{
+			return nl80211_groups[i].id;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * Get the index of a network interface (see header for API details)
+ */
+
+gboolean nl80211_get_ifindex(const gchar *iface, guint32 *ifindex,
+                             GError **error)
+{
+	*ifindex = if_nametoindex(iface);
+
+	if (0 == *ifindex)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "No interface %s", iface);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Set the power save state of an interface (see header for API details)
+ */
+
+gboolean nl80211_set_power_save(const gchar *iface, gboolean enabled,
+                                GError **error)
+{
+	guint8 data[NL80211_UTILS_MSG_SIZE];
+	guint32 ifindex;
+	genl_buf_t msg;
+	gboolean ret;
+	int fd;
+
+	if (!nl80211_get_ifindex(iface, &ifindex, error))
+	{
+		return FALSE;
+	}
+
+	fd = nl80211_open(error);
+
+	if (fd < 0)
+	{
+		return FALSE;
+	}
+
+	nl80211_msg_init(&msg, data, NL80211_CMD_SET_POWER_SAVE, 0);
+	genl_put_u32(&msg, NL80211_ATTR_IFINDEX, ifindex);
+	genl_put_u32(&msg, NL80211_ATTR_PS_STATE,
+	             enabled ? NL80211_PS_ENABLED : NL80211_PS_DISABLED);
+
+	ret = nl80211_request(fd, &msg, NULL, NULL, error);
+
+	close(fd);
+	return ret;
+}
+
+typedef struct scan_dump
+{
+	nl80211_bss_cb cb;
+	gpointer user_data;
+} scan_dump_t;
+
+static void scan_dump_cb(const guint8 *attrs, gsize len, gpointer user_data)
+{
+	scan_dump_t *dump = user_data;
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		if (NL80211_ATTR_BSS == genl_attr_type(attr))
+		{
+			dump->cb(genl_attr_data(attr), genl_attr_len(attr), dump->user_data);
+		}
+	}
+}
+
+/**
+ * Dump the results of the last scan (see header for API details)
+ */
+
+gboolean nl80211_dump_scan(const gchar *iface, nl80211_bss_cb cb,
+                           gpointer user_data, GError **error)
+{
+	guint8 data[NL80211_UTILS_MSG_SIZE];
+	scan_dump_t dump = { cb, user_data };
+	guint32 ifindex;
+	genl_buf_t msg;
+	gboolean ret;
+	int fd;
+
+	if (!nl80211_get_ifindex(iface, &ifindex, error))
+	{
+		return FALSE;
+	}
+
+	fd = nl80211_open(error);
+
+	if (fd < 0)
+	{
+		return FALSE;
+	}
+
+	nl80211_msg_init(&msg, data, NL80211_CMD_GET_SCAN, NLM_F_DUMP);
+	genl_put_u32(&msg, NL80211_ATTR_IFINDEX, ifindex);
+
+	ret = nl80211_request(fd, &msg, scan_dump_cb, &dump, error);
+	close(fd);
+
+	return ret;
+}
+
+/**
+ * Check if a BSS of a scan dump is the associated one (see header for API
+ * details)
+ */
+
+gboolean nl80211_bss_get_associated(const guint8 *attrs, gsize len,
+                                    gchar bssid[18], gint *frequency)
+{
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+	const guint8 *address = NULL;
+	guint32 freq = 0;
+	gboolean associated = FALSE;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		switch (genl_attr_type(attr))
+		{
+			case NL80211_BSS_BSSID:
+				if (genl_attr_len(attr) >= 6)
+				{
+					address = genl_attr_data(attr);
+				}
+
+				break;
+
+			case NL80211_BSS_FREQUENCY:
+				freq = genl_attr_u32(attr);
+				break;
+
+			case NL80211_BSS_STATUS:
+				associated = NL80211_BSS_STATUS_ASSOCIATED == genl_attr_u32(attr);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (!associated || NULL == address)
+	{
+		return FALSE;
+	}
+
+	g_snprintf(bssid, 18, "%02X:%02X:%02X:%02X:%02X:%02X", address[0],
+	           address[1], address[2], address[3], address[4], address[5]);
+	*frequency = freq;
+	return TRUE;
+}
+
+typedef struct associated_bss
+{
+	gchar *bssid;
+	gint *frequency;
+	gboolean found;
+} associated_bss_t;
+
+static void associated_bss_cb(const guint8 *attrs, gsize len,
+                              gpointer user_data)
+{
+	associated_bss_t *result = user_data;
+
+	if (nl80211_bss_get_associated(attrs, len, result->bssid, result->frequency))
+	{
+		result->found = TRUE;
+	}
+}
+
+/**
+ * Get the BSS an interface is associated with (see header for API details)
+ */
+
+gboolean nl80211_get_associated_bss(const gchar *iface, gchar bssid[18],
+                                    gint *frequency, GError **error)
+{
+	associated_bss_t result = { bssid, frequency, FALSE };
+
+	if (!nl80211_dump_scan(iface, associated_bss_cb, &result, error))
+	{
+		return FALSE;
+	}
+
+	if (!result.found)
+	{
+		g_set_error(error, NL80211_UTILS_ERROR, NL80211_UTILS_ERROR_FAILED,
+		            "%s is not associated", iface);
+		return FALSE;
+	}
+
+	return TRUE;
+}
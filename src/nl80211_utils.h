@@ -0,0 +1,230 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  nl80211_utils.h
+ *
+ * @brief Header file defining helpers to talk nl80211 over a generic netlink
+ *        socket
+ *
+ * Messages are built in a caller supplied buffer with the genl_put_* helpers
+ * and sent with nl80211_request, which blocks for at most a second waiting
+ * for the kernel to answer.
+ *
+ */
+
+#ifndef _NL80211_UTILS_H_
+#define _NL80211_UTILS_H_
+
+#include <glib.h>
+#include <linux/netlink.h>
+
+#define NL80211_UTILS_MSG_SIZE      8192
+
+#define NL80211_UTILS_ERROR         nl80211_utils_error_quark()
+
+typedef enum
+{
+	NL80211_UTILS_ERROR_UNSUPPORTED,    /* The kernel or driver doesn't support it */
+	NL80211_UTILS_ERROR_FAILED,
+} nl80211_utils_error_t;
+
+/**
+ * Buffer a netlink message or attribute is written to. Writes past the end
+ * set overflow instead.
+ */
+typedef struct genl_buf
+{
+	guint8 *data;
+	gsize size;
+	gsize len;
+	gboolean overflow;
+} genl_buf_t;
+
+/**
+ * Called for each answer to a request with the attributes of the answer
+ */
+typedef void (*nl80211_answer_cb)(const guint8 *attrs, gsize len,
+                                  gpointer user_data);
+
+/**
+ * Called for each BSS of a scan dump with the NL80211_BSS_* attributes of
+ * the BSS
+ */
+typedef void (*nl80211_bss_cb)(const guint8 *attrs, gsize len,
+                               gpointer user_data);
+
+extern GQuark nl80211_utils_error_quark(void);
+
+/**
+ * Append an attribute
+ *
+ * @param[IN]  buf Buffer
+ * @param[IN]  type Attribute type
+ * @param[IN]  data Payload, may be NULL for flags
+ * @param[IN]  len Length of the payload
+ */
+extern void genl_put_attr(genl_buf_t *buf, guint16 type, const void *data,
+                          gsize len);
+
+extern void genl_put_u32(genl_buf_t *buf, guint16 type, guint32 value);
+
+/**
+ * Start a nested attribute
+ *
+ * @param[IN]  buf Buffer
+ * @param[IN]  type Attribute type
+ *
+ * @return Offset of the attribute, to pass to genl_nest_end
+ */
+extern gsize genl_nest_start(genl_buf_t *buf, guint16 type);
+
+extern void genl_nest_end(genl_buf_t *buf, gsize start);
+
+/**
+ * Get the next attribute of a stream of attributes
+ *
+ * @param[IN]  pos Position in the stream, moved past the attribute
+ * @param[IN]  end End of the stream
+ *
+ * @return Attribute, NULL at the end of the stream or if it is truncated
+ */
+extern const struct nlattr *genl_next_attr(const guint8 **pos,
+        const guint8 *end);
+
+extern guint16 genl_attr_type(const struct nlattr *attr);
+
+extern const guint8 *genl_attr_data(const struct nlattr *attr);
+
+extern gsize genl_attr_len(const struct nlattr *attr);
+
+/**
+ * Get the payload of an attribute as u32
+ *
+ * @return Value, 0 if the payload is too short
+ */
+extern guint32 genl_attr_u32(const struct nlattr *attr);
+
+/**
+ * Open a generic netlink socket and look up the nl80211 family
+ *
+ * @param[OUT] error Why the socket can't be used
+ *
+ * @return Socket, -1 on failure
+ */
+extern int nl80211_open(GError **error);
+
+/**
+ * Get the id of an nl80211 multicast group, e.g. "mlme", after nl80211_open
+ *
+ * @param[IN]  name Name of the group
+ *
+ * @return Id of the group, 0 if unknown
+ */
+extern guint32 nl80211_get_group(const gchar *name);
+
+/**
+ * Start an nl80211 request
+ *
+ * @param[OUT] msg Message
+ * @param[IN]  data Buffer of NL80211_UTILS_MSG_SIZE bytes for the message
+ * @param[IN]  cmd NL80211_CMD_*
+ * @param[IN]  flags NLM_F_DUMP for dumps, 0 otherwise
+ */
+extern void nl80211_msg_init(genl_buf_t *msg, guint8 *data, guint8 cmd,
+                             guint16 flags);
+
+/**
+ * Send a request and wait for the kernel to ack it or end the dump
+ *
+ * @param[IN]  fd Socket from nl80211_open
+ * @param[IN]  msg Message
+ * @param[IN]  cb Callback called for each answer, may be NULL
+ * @param[IN]  user_data User data passed to cb
+ * @param[OUT] error Why the request failed
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean nl80211_request(int fd, genl_buf_t *msg, nl80211_answer_cb cb,
+                                gpointer user_data, GError **error);
+
+/**
+ * Get the index of a network interface
+ *
+ * @param[IN]  iface Name of the interface
+ * @param[OUT] ifindex Index
+ * @param[OUT] error Error if there is no such interface
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean nl80211_get_ifindex(const gchar *iface, guint32 *ifindex,
+                                    GError **error);
+
+/**
+ * Enable or disable power save on a wireless interface
+ *
+ * @param[IN]  iface Name of the interface
+ * @param[IN]  enabled TRUE to let the interface sleep between beacons
+ * @param[OUT] error Why the state can't be set
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean nl80211_set_power_save(const gchar *iface, gboolean enabled,
+                                       GError **error);
+
+/**
+ * Dump the results of the last scan of a wireless interface, information
+ * elements included. The dump is large, so consumers of the same scan should
+ * share one.
+ *
+ * @param[IN]  iface Name of the interface
+ * @param[IN]  cb Callback called for each BSS
+ * @param[IN]  user_data User data passed to cb
+ * @param[OUT] error Why the scan results can't be read
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean nl80211_dump_scan(const gchar *iface, nl80211_bss_cb cb,
+                                  gpointer user_data, GError **error);
+
+/**
+ * Check if a BSS of a scan dump is the one the interface is associated with
+ *
+ * @param[IN]  attrs NL80211_BSS_* attributes of the BSS
+ * @param[IN]  len Length of the attributes
+ * @param[OUT] bssid Upper case BSSID, only set if associated
+ * @param[OUT] frequency Frequency of the BSS in MHz, only set if associated
+ *
+ * @return TRUE if the interface is associated with the BSS, FALSE otherwise
+ */
+extern gboolean nl80211_bss_get_associated(const guint8 *attrs, gsize len,
+        gchar bssid[18], gint *frequency);
+
+/**
+ * Get the BSS a wireless interface is associated with. Runs a scan dump of
+ * its own, use nl80211_bss_get_associated while dumping the scan anyway.
+ *
+ * @param[IN]  iface Name of the interface
+ * @param[OUT] bssid Upper case BSSID
+ * @param[OUT] frequency Frequency of the BSS in MHz
+ * @param[OUT] error Why the BSS can't be told, also if there is none
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean nl80211_get_associated_bss(const gchar *iface,
+        gchar bssid[18], gint *frequency, GError **error);
+
+#endif /* _NL80211_UTILS_H_ */
@@ -0,0 +1,224 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  p2p_group_cache.c
+ *
+ * @brief Cache of persistent P2P groups and their connect latency
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "p2p_group_cache.h"
+
+static GList *groups = NULL;
+static p2p_connect_latency_t latency[2];
+
+static void group_free(gpointer data)
+{
+	p2p_cached_group_t *group = data;
+
+	g_free(group->peer_address);
+	g_free(group->group_name);
+	g_free(group);
+}
+
+static GList *find_group(const gchar *peer_address)
+{
+	GList *iter;
+
+	for (iter = groups; NULL != iter && NULL != peer_address; iter = iter->next)
+	{
+		p2p_cached_group_t *group = iter->data;
+
+		if (!g_ascii_strcasecmp(group->peer_address, peer_address))
+		{
+			return iter;
+		}
+	}
+
+	return NULL;
+}
+
+static gint compare_last_used(gconstpointer a, gconstpointer b)
+{
+	const p2p_cached_group_t *group_a = a, *group_b = b;
+
+	if (group_a->last_used == group_b->last_used)
+	{
+		return 0;
+	}
+
+	return group_a->last_used > group_b->last_used ? -1 : 1;
+}
+
+/**
+ * Add or refresh a group (see header for API details)
+ */
+
+void p2p_group_cache_update(const gchar *peer_address, p2p_group_role_t role,
+                            gint freq, const gchar *group_name, gint64 last_used)
+{
+	GList *link = find_group(peer_address);
+	p2p_cached_group_t *group;
+
+	if (NULL == peer_address)
+	{
+		return;
+	}
+
+	if (NULL != link)
+	{
+		group = link->data;
+		groups = g_list_delete_link(groups, link);
+		g_free(group->group_name);
+	}
+	else
+	{
+		group = g_new0(p2p_cached_group_t, 1);
+		group->peer_address = g_ascii_strup(peer_address, -1);
+	}
+
+	group->role = role;
+	group->freq = freq;
+	group->group_name = g_strdup(group_name);
+	group->last_used = last_used;
+	groups = g_list_insert_sorted(groups, group, compare_last_used);
+
+	if (g_list_length(groups) > P2P_GROUP_CACHE_MAX)
+	{
+		GList *last = g_list_last(groups);
+
+		group_free(last->data);
+		groups = g_list_delete_link(groups, last);
+	}
+}
+
+/**
+ * Look up a group (see header for API details)
+ */
+
+const p2p_cached_group_t *p2p_group_cache_lookup(const gchar *peer_address)
+{
+	GList *link = find_group(peer_address);
+
+	return NULL != link ? link->data : NULL;
+}
+
+/**
+ * Drop a group (see header for API details)
+ */
+
+gboolean p2p_group_cache_remove(const gchar *peer_address)
+{
+	GList *link = find_group(peer_address);
+
+	if (NULL == link)
+	{
+		return FALSE;
+	}
+
+	group_free(link->data);
+	groups = g_list_delete_link(groups, link);
+
+	return TRUE;
+}
+
+/**
+ * Get the cached groups (see header for API details)
+ */
+
+const GList *p2p_group_cache_get_groups(void)
+{
+	return groups;
+}
+
+/**
+ * Record the latency of a connect (see header for API details)
+ */
+
+void p2p_group_cache_record_latency(gboolean cached, gint64 latency_ms)
+{
+	p2p_connect_latency_t *record = &latency[cached ? 1 : 0];
+
+	if (latency_ms < 0)
+	{
+		return;
+	}
+
+	if (0 == record->count || latency_ms < record->min_ms)
+	{
+		record->min_ms = latency_ms;
+	}
+
+	if (latency_ms > record->max_ms)
+	{
+		record->max_ms = latency_ms;
+	}
+
+	record->count++;
+	record->last_ms = latency_ms;
+	record->total_ms += latency_ms;
+}
+
+/**
+ * Get the latency of connects (see header for API details)
+ */
+
+const p2p_connect_latency_t *p2p_group_cache_get_latency(gboolean cached)
+{
+	return &latency[cached ? 1 : 0];
+}
+
+const gchar *p2p_group_role_to_string(p2p_group_role_t role)
+{
+	return P2P_GROUP_ROLE_OWNER == role ? "owner" : "client";
+}
+
+/**
+ * Parse a role (see header for API details)
+ */
+
+gboolean p2p_group_role_from_string(const gchar *str, p2p_group_role_t *role)
+{
+	if (!g_strcmp0(str, "owner"))
+	{
+		*role = P2P_GROUP_ROLE_OWNER;
+	}
+	else if (!g_strcmp0(str, "client"))
+	{
+		*role = P2P_GROUP_ROLE_CLIENT;
+	}
+	else
+	{
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Drop all groups (see header for API details)
+ */
+
+void p2p_group_cache_reset(void)
+{
+	g_list_free_full(groups, group_free);
+	groups = NULL;
+	memset(latency, 0, sizeof(latency));
+}
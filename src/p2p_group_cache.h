@@ -0,0 +1,131 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  p2p_group_cache.h
+ *
+ * @brief Header file defining the cache of persistent P2P groups formed with
+ *        peers before, and the connect latency of cached and negotiated
+ *        connections
+ *
+ * The credentials of a persistent group stay with the supplicant, the cache
+ * only keeps the group name they are stored under.
+ *
+ */
+
+#ifndef _P2P_GROUP_CACHE_H_
+#define _P2P_GROUP_CACHE_H_
+
+#include <glib.h>
+
+/* The least recently used group is dropped beyond this */
+#define P2P_GROUP_CACHE_MAX     16
+
+typedef enum
+{
+	P2P_GROUP_ROLE_CLIENT,
+	P2P_GROUP_ROLE_OWNER,
+} p2p_group_role_t;
+
+typedef struct p2p_cached_group
+{
+	gchar *peer_address;        /* Upper case device address of the peer */
+	p2p_group_role_t role;      /* Own role in the group */
+	gint freq;                  /* Operating channel in MHz, 0 if unknown */
+	gchar *group_name;          /* Name the credentials are stored under */
+	gint64 last_used;           /* Wall clock time in s */
+} p2p_cached_group_t;
+
+typedef struct p2p_connect_latency
+{
+	guint count;
+	gint64 last_ms;
+	gint64 min_ms;
+	gint64 max_ms;
+	gint64 total_ms;
+} p2p_connect_latency_t;
+
+/**
+ * Add or refresh the group formed with a peer
+ *
+ * @param[IN]  peer_address Device address of the peer
+ * @param[IN]  role Own role in the group
+ * @param[IN]  freq Operating channel in MHz, 0 if unknown
+ * @param[IN]  group_name Name of the group
+ * @param[IN]  last_used Wall clock time in s the group was used
+ */
+extern void p2p_group_cache_update(const gchar *peer_address,
+                                   p2p_group_role_t role, gint freq, const gchar *group_name,
+                                   gint64 last_used);
+
+/**
+ * Look up the group formed with a peer
+ *
+ * @param[IN]  peer_address Device address of the peer
+ *
+ * @return The group, NULL if none is cached
+ */
+extern const p2p_cached_group_t *p2p_group_cache_lookup(
+    const gchar *peer_address);
+
+/**
+ * Drop the group formed with a peer
+ *
+ * @param[IN]  peer_address Device address of the peer
+ *
+ * @return TRUE if a group was dropped
+ */
+extern gboolean p2p_group_cache_remove(const gchar *peer_address);
+
+/**
+ * Get the cached groups
+ *
+ * @return List of p2p_cached_group_t, most recently used first, owned by the
+ *         module
+ */
+extern const GList *p2p_group_cache_get_groups(void);
+
+/**
+ * Record the latency of a connect
+ *
+ * @param[IN]  cached TRUE if a cached group was re-invoked, FALSE if the
+ *                    group was negotiated
+ * @param[IN]  latency_ms Time from the start of the connect to ready
+ */
+extern void p2p_group_cache_record_latency(gboolean cached, gint64 latency_ms);
+
+/**
+ * Get the latency of cached or negotiated connects
+ */
+extern const p2p_connect_latency_t *p2p_group_cache_get_latency(
+    gboolean cached);
+
+extern const gchar *p2p_group_role_to_string(p2p_group_role_t role);
+
+/**
+ * Parse a role
+ *
+ * @return TRUE if str is "owner" or "client"
+ */
+extern gboolean p2p_group_role_from_string(const gchar *str,
+        p2p_group_role_t *role);
+
+/**
+ * Drop all groups and latency records
+ */
+extern void p2p_group_cache_reset(void);
+
+#endif /* _P2P_GROUP_CACHE_H_ */
@@ -0,0 +1,212 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  pan_reconnect.c
+ *
+ * @brief Remembered Bluetooth NAPs and their reconnect backoff
+ *
+ */
+
+#include <glib.h>
+
+#include "pan_reconnect.h"
+
+static GList *naps = NULL;
+static guint delay = PAN_RECONNECT_DELAY * 1000;
+static guint max_delay = PAN_RECONNECT_MAX_DELAY * 1000;
+static guint max_attempts = PAN_RECONNECT_MAX_ATTEMPTS;
+static guint jitter = PAN_RECONNECT_JITTER;
+
+static void nap_free(gpointer data)
+{
+	pan_nap_t *nap = data;
+
+	g_free(nap->address);
+	g_free(nap);
+}
+
+static GList *find_nap(const gchar *address)
+{
+	GList *iter;
+
+	for (iter = naps; NULL != iter && NULL != address; iter = iter->next)
+	{
+		pan_nap_t *nap = iter->data;
+
+		if (!g_ascii_strcasecmp(nap->address, address))
+		{
+			return iter;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Set the reconnect policy (see header for API details)
+ */
+
+void pan_reconnect_set_policy(guint delay_ms, guint max_delay_ms,
+                              guint attempts)
+{
+	delay = delay_ms;
+	max_delay = max_delay_ms;
+	max_attempts = attempts;
+}
+
+/**
+ * Set the jitter (see header for API details)
+ */
+
+void pan_reconnect_set_jitter(guint percent)
+{
+	jitter = MIN(percent, 100);
+}
+
+/**
+ * Remember a NAP as connected (see header for API details)
+ */
+
+void pan_reconnect_connected(const gchar *address)
+{
+	GList *link = find_nap(address);
+	pan_nap_t *nap;
+
+	if (NULL == address)
+	{
+		return;
+	}
+
+	if (NULL != link)
+	{
+		nap = link->data;
+		naps = g_list_delete_link(naps, link);
+	}
+	else
+	{
+		nap = g_new0(pan_nap_t, 1);
+		nap->address = g_ascii_strup(address, -1);
+	}
+
+	nap->auto_reconnect = TRUE;
+	nap->attempts = 0;
+	nap->retry_at_ms = -1;
+	naps = g_list_prepend(naps, nap);
+
+	if (g_list_length(naps) > PAN_RECONNECT_MAX_NAPS)
+	{
+		GList *last = g_list_last(naps);
+
+		nap_free(last->data);
+		naps = g_list_delete_link(naps, last);
+	}
+}
+
+/**
+ * Stop reconnecting to a NAP (see header for API details)
+ */
+
+void pan_reconnect_stop(const gchar *address)
+{
+	GList *link = find_nap(address);
+
+	if (NULL != link)
+	{
+		pan_nap_t *nap = link->data;
+
+		nap->auto_reconnect = FALSE;
+		nap->retry_at_ms = -1;
+	}
+}
+
+/**
+ * Schedule the next reconnect (see header for API details)
+ */
+
+gint64 pan_reconnect_schedule(const gchar *address, gint64 now_ms)
+{
+	GList *link = find_nap(address);
+	pan_nap_t *nap;
+	gint64 wait;
+
+	if (NULL == link)
+	{
+		return -1;
+	}
+
+	nap = link->data;
+
+	if (!nap->auto_reconnect || nap->attempts >= max_attempts)
+	{
+		nap->auto_reconnect = FALSE;
+		nap->retry_at_ms = -1;
+		return -1;
+	}
+
+	nap->attempts++;
+	nap->total_attempts++;
+
+	/* Doubles with every attempt */
+	wait = nap->attempts > 20 ? max_delay :
+	       MIN((gint64) delay << (nap->attempts - 1), (gint64) max_delay);
+
+	if (jitter > 0 && wait > 0)
+	{
+		gint64 span = wait * jitter / 100;
+
+		wait += g_random_int_range((gint32) -span, (gint32) span + 1);
+	}
+
+	nap->retry_at_ms = now_ms + wait;
+
+	return wait;
+}
+
+/**
+ * Get a remembered NAP (see header for API details)
+ */
+
+const pan_nap_t *pan_reconnect_get(const gchar *address)
+{
+	GList *link = find_nap(address);
+
+	return NULL != link ? link->data : NULL;
+}
+
+/**
+ * Get the remembered NAPs (see header for API details)
+ */
+
+const GList *pan_reconnect_get_naps(void)
+{
+	return naps;
+}
+
+/**
+ * Forget all NAPs (see header for API details)
+ */
+
+void pan_reconnect_reset(void)
+{
+	g_list_free_full(naps, nap_free);
+	naps = NULL;
+
+	delay = PAN_RECONNECT_DELAY * 1000;
+	max_delay = PAN_RECONNECT_MAX_DELAY * 1000;
+	max_attempts = PAN_RECONNECT_MAX_ATTEMPTS;
+	jitter = PAN_RECONNECT_JITTER;
+}
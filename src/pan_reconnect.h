@@ -0,0 +1,121 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  pan_reconnect.h
+ *
+ * @brief Header file defining the remembered Bluetooth NAPs and the backoff
+ *        used to reconnect to them
+ *
+ * A NAP is remembered once connected. When it is lost, reconnects are
+ * scheduled with a delay doubling with every attempt, randomized by a jitter
+ * so devices losing the same NAP don't retry in lockstep. Reconnecting stops
+ * on an explicit disconnect or after the maximum number of attempts.
+ *
+ */
+
+#ifndef _PAN_RECONNECT_H_
+#define _PAN_RECONNECT_H_
+
+#include <glib.h>
+
+/**
+ * Defaults of the panReconnectDelay (s), panReconnectMaxDelay (s) and
+ * panReconnectMaxAttempts runtime parameters
+ */
+#define PAN_RECONNECT_DELAY         2
+#define PAN_RECONNECT_MAX_DELAY     300
+#define PAN_RECONNECT_MAX_ATTEMPTS  10
+
+/* Jitter in percent of the delay, in both directions */
+#define PAN_RECONNECT_JITTER        20
+
+/* The least recently connected NAP is forgotten beyond this */
+#define PAN_RECONNECT_MAX_NAPS      8
+
+typedef struct pan_nap
+{
+	gchar *address;             /* Upper case */
+	gboolean auto_reconnect;    /* Cleared on explicit disconnect or giving up */
+	guint attempts;             /* Since the NAP was lost */
+	guint total_attempts;
+	gint64 retry_at_ms;         /* -1 if no reconnect is scheduled */
+} pan_nap_t;
+
+/**
+ * Set the reconnect policy
+ *
+ * @param[IN]  delay_ms Delay before the first attempt in ms
+ * @param[IN]  max_delay_ms Longest delay in ms
+ * @param[IN]  max_attempts Attempts before giving up, 0 disables reconnecting
+ */
+extern void pan_reconnect_set_policy(guint delay_ms, guint max_delay_ms,
+                                     guint max_attempts);
+
+/**
+ * Set the jitter
+ *
+ * @param[IN]  percent Jitter in percent of the delay, 0 for exact delays
+ */
+extern void pan_reconnect_set_jitter(guint percent);
+
+/**
+ * Remember a NAP as connected, which ends its reconnects
+ *
+ * @param[IN]  address Bluetooth address of the NAP
+ */
+extern void pan_reconnect_connected(const gchar *address);
+
+/**
+ * Stop reconnecting to a NAP until it is connected again
+ *
+ * @param[IN]  address Bluetooth address of the NAP
+ */
+extern void pan_reconnect_stop(const gchar *address);
+
+/**
+ * Schedule the next reconnect of a lost NAP. Called when the NAP is lost and
+ * after every failed attempt.
+ *
+ * @param[IN]  address Bluetooth address of the NAP
+ * @param[IN]  now_ms Monotonic time in ms
+ *
+ * @return Delay until the attempt in ms, -1 if the NAP isn't reconnected
+ */
+extern gint64 pan_reconnect_schedule(const gchar *address, gint64 now_ms);
+
+/**
+ * Get a remembered NAP
+ *
+ * @param[IN]  address Bluetooth address of the NAP
+ *
+ * @return The NAP, NULL if it isn't remembered
+ */
+extern const pan_nap_t *pan_reconnect_get(const gchar *address);
+
+/**
+ * Get the remembered NAPs
+ *
+ * @return List of pan_nap_t, most recently connected first, owned by the module
+ */
+extern const GList *pan_reconnect_get_naps(void);
+
+/**
+ * Forget all NAPs and restore the default policy
+ */
+extern void pan_reconnect_reset(void);
+
+#endif /* _PAN_RECONNECT_H_ */
@@ -36,6 +36,9 @@
 #include "utils.h"
 #include "errors.h"
 #include "connectionmanager_service.h"
+#include "runtime_params.h"
+#include "dbus_call.h"
+#include "pan_reconnect.h"
 
 //#define NAP_WITHOUT_COLON_ADDRESS_LENGTH 12
 #define PAN_MAC_ADDRESS_LENGTH 17
@@ -44,6 +47,12 @@ static LSHandle *pLsHandle;
 
 luna_service_request_t *current_connect_req;
 
+/* Address of the NAP which was connected when last checked */
+static gchar *pan_connected_address = NULL;
+/* Address of the lost NAP being reconnected */
+static gchar *pan_reconnect_address = NULL;
+static guint pan_reconnect_timeout = 0;
+
 /**
  *  @brief Callback function registered with connman technology whenever any of its properties change
  *
@@ -76,6 +85,7 @@ static void technology_property_changed_callback(gpointer data,
 	{
 		connectionmanager_send_status_to_subscribers();
 		send_pan_connection_status_to_subscribers();
+		check_pan_reconnect();
 	}
 	else if (g_strcmp0(property, "Tethering") == 0)
 	{
@@ -97,6 +107,11 @@ static void service_changed_cb(gpointer user_data, const gchar *name,
                                GVariant *value)
 {
 	connectionmanager_send_status_to_subscribers();
+
+	if (!g_strcmp0(name, "State"))
+	{
+		check_pan_reconnect();
+	}
 }
 
 /**
@@ -290,6 +305,45 @@ void append_nap_info(jvalue_ref *status)
 	jobject_put(*status, J_CSTR_TO_JVAL("nap"), nap_info);
 }
 
+/**
+ * @brief Fill in the remembered NAPs and their reconnect attempts
+ *
+ * @param reply json status object to fill
+ */
+
+static void append_remembered_naps(jvalue_ref *reply)
+{
+	jvalue_ref naps_obj = jarray_create(NULL);
+	gint64 now = g_get_monotonic_time() / 1000;
+	const GList *iter;
+
+	for (iter = pan_reconnect_get_naps(); NULL != iter; iter = iter->next)
+	{
+		const pan_nap_t *nap = iter->data;
+		jvalue_ref nap_obj = jobject_create();
+
+		jobject_put(nap_obj, J_CSTR_TO_JVAL("address"), jstring_create(nap->address));
+		jobject_put(nap_obj, J_CSTR_TO_JVAL("autoReconnect"),
+		            jboolean_create(nap->auto_reconnect));
+		jobject_put(nap_obj, J_CSTR_TO_JVAL("reconnectAttempts"),
+		            jnumber_create_i32(nap->attempts));
+		jobject_put(nap_obj, J_CSTR_TO_JVAL("totalReconnectAttempts"),
+		            jnumber_create_i32(nap->total_attempts));
+
+		if (nap->retry_at_ms >= 0)
+		{
+			jobject_put(nap_obj, J_CSTR_TO_JVAL("retryIn"),
+			            jnumber_create_i64(MAX(nap->retry_at_ms - now + 999, 0) / 1000));
+		}
+
+		jarray_append(naps_obj, nap_obj);
+	}
+
+	jobject_put(*reply, J_CSTR_TO_JVAL("rememberedNaps"), naps_obj);
+	jobject_put(*reply, J_CSTR_TO_JVAL("maxReconnectAttempts"),
+	            jnumber_create_i32(runtime_param_get(RUNTIME_PARAM_PAN_RECONNECT_MAX_ATTEMPTS)));
+}
+
 /**
  * @brief Fill in all status information to be sent with 'getStatus' method
  */
@@ -317,6 +371,8 @@ static void append_pan_status(jvalue_ref *reply)
 	{
 		add_connected_network_status(reply, connected_service);
 	}
+
+	append_remembered_naps(reply);
 }
 
 void send_pan_connection_status_to_subscribers(void)
@@ -381,6 +437,166 @@ static void current_connect_req_free()
 
 }
 
+static connman_service_t *find_nap_service(const gchar *address)
+{
+	GSList *nap;
+
+	for (nap = manager->bluetooth_services; NULL != nap && NULL != address;
+	        nap = nap->next)
+	{
+		connman_service_t *service = (connman_service_t *)(nap->data);
+
+		if (compare_address(service->address, (char *) address))
+		{
+			return service;
+		}
+	}
+
+	return NULL;
+}
+
+static void cancel_pan_reconnect(void)
+{
+	if (pan_reconnect_timeout)
+	{
+		g_source_remove(pan_reconnect_timeout);
+		pan_reconnect_timeout = 0;
+	}
+
+	g_free(pan_reconnect_address);
+	pan_reconnect_address = NULL;
+}
+
+static gboolean pan_reconnect_timeout_cb(gpointer user_data);
+
+/**
+ * Schedule the next reconnect to a lost NAP, or give up once the NAP ran out
+ * of attempts
+ */
+
+static void schedule_pan_reconnect(const gchar *address)
+{
+	gchar *nap_address = g_strdup(address);
+	gint64 wait;
+
+	cancel_pan_reconnect();
+
+	pan_reconnect_set_policy(runtime_param_get(RUNTIME_PARAM_PAN_RECONNECT_DELAY) *
+	                         1000, runtime_param_get(RUNTIME_PARAM_PAN_RECONNECT_MAX_DELAY) * 1000,
+	                         runtime_param_get(RUNTIME_PARAM_PAN_RECONNECT_MAX_ATTEMPTS));
+
+	wait = pan_reconnect_schedule(nap_address, g_get_monotonic_time() / 1000);
+
+	if (wait < 0)
+	{
+		WCALOG_INFO(MSGID_PAN_RECONNECT_INFO, 0, "Not reconnecting to NAP %s",
+		            nap_address);
+		g_free(nap_address);
+	}
+	else
+	{
+		WCALOG_INFO(MSGID_PAN_RECONNECT_INFO, 0,
+		            "Reconnecting to NAP %s in %" G_GINT64_FORMAT " ms (attempt %u)",
+		            nap_address, wait, pan_reconnect_get(nap_address)->attempts);
+		pan_reconnect_address = nap_address;
+		pan_reconnect_timeout = g_timeout_add(wait, pan_reconnect_timeout_cb, NULL);
+	}
+
+	send_pan_connection_status_to_subscribers();
+}
+
+static void pan_reconnect_callback(gboolean success, gpointer user_data)
+{
+	/* Cancelled by the user meanwhile */
+	if (NULL == pan_reconnect_address || pan_reconnect_timeout)
+	{
+		return;
+	}
+
+	if (success)
+	{
+		check_pan_reconnect();
+		return;
+	}
+
+	schedule_pan_reconnect(pan_reconnect_address);
+}
+
+static gboolean pan_reconnect_timeout_cb(gpointer user_data)
+{
+	connman_service_t *service = find_nap_service(pan_reconnect_address);
+
+	pan_reconnect_timeout = 0;
+
+	/* Still out of range counts as a failed attempt */
+	if (NULL == service ||
+	        !connman_service_connect(service, NULL, pan_reconnect_callback, NULL))
+	{
+		schedule_pan_reconnect(pan_reconnect_address);
+	}
+
+	return FALSE;
+}
+
+/**
+ * Remember the connected NAP, and start reconnecting when it was lost without
+ * an explicit disconnect
+ */
+
+void check_pan_reconnect(void)
+{
+	connman_service_t *service;
+	gchar *address;
+
+	if (NULL == manager)
+	{
+		return;
+	}
+
+	/* Switching Bluetooth off isn't a loss */
+	if (!is_bluetooth_powered())
+	{
+		g_free(pan_connected_address);
+		pan_connected_address = NULL;
+		cancel_pan_reconnect();
+		return;
+	}
+
+	service = connman_manager_get_connected_service(manager->bluetooth_services);
+
+	if (NULL != service && connman_service_is_connected(service) &&
+	        NULL != service->address)
+	{
+		if (g_strcmp0(pan_connected_address, service->address))
+		{
+			g_free(pan_connected_address);
+			pan_connected_address = g_strdup(service->address);
+			pan_reconnect_connected(service->address);
+			connman_service_register_property_changed_cb(service, service_changed_cb);
+			send_pan_connection_status_to_subscribers();
+		}
+
+		if (NULL != pan_reconnect_address)
+		{
+			WCALOG_INFO(MSGID_PAN_RECONNECT_INFO, 0, "Reconnected to NAP %s",
+			            service->address);
+			cancel_pan_reconnect();
+		}
+
+		return;
+	}
+
+	if (NULL != pan_connected_address)
+	{
+		WCALOG_INFO(MSGID_PAN_RECONNECT_INFO, 0, "NAP %s lost", pan_connected_address);
+
+		address = pan_connected_address;
+		pan_connected_address = NULL;
+		schedule_pan_reconnect(address);
+		g_free(address);
+	}
+}
+
 /**
  * When the user requests a connection to a network and the connection establishment
  * process fails we don't immediately report this to the user but waiting until the
@@ -478,13 +694,16 @@ static void service_connect_callback(gboolean success, gpointer user_data)
 	 * it's state to failure until we report the failed connection request to the user */
 	if (!success)
 	{
-		g_timeout_add_seconds(2, handle_failed_connection_request, NULL);
+		g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_CONNECT_FAILURE_DELAY),
+		                      handle_failed_connection_request, NULL);
 		return;
 	}
 
 	LSMessageReplySuccess(service_req->handle, service_req->message);
 
 	current_connect_req_free();
+
+	check_pan_reconnect();
 }
 
 /**
@@ -548,10 +767,14 @@ static void connect_pan_with_address(char *address,
 		goto cleanup;
 	}
 
+	/* The user takes over from a pending reconnect */
+	cancel_pan_reconnect();
+
 	service_req->user_data = service;
 	current_connect_req = service_req;
 
-	if (!connman_service_connect(service, service_connect_callback, service_req))
+	if (!connman_service_connect(service, service_req->cancellable,
+	                             service_connect_callback, service_req))
 	{
 		current_connect_req = NULL;
 		LSMessageReplyErrorUnknown(service_req->handle, service_req->message);
@@ -708,6 +931,22 @@ static bool handle_pan_disconnect_command(LSHandle *sh, LSMessage *message,
 	connected_service = connman_manager_get_connected_service(
 	                        manager->bluetooth_services);
 
+	/* An explicit disconnect ends the reconnects to the NAP */
+	pan_reconnect_stop(address);
+
+	if (NULL != pan_reconnect_address && compare_address(pan_reconnect_address,
+	        address))
+	{
+		cancel_pan_reconnect();
+		send_pan_connection_status_to_subscribers();
+
+		if (!connected_service || !compare_address(connected_service->address, address))
+		{
+			LSMessageReplySuccess(sh, message);
+			goto cleanup;
+		}
+	}
+
 	if (!connected_service || !compare_address(connected_service->address, address))
 	{
 		LSMessageReplyCustomError(sh, message, "No service is connected",
@@ -715,6 +954,9 @@ static bool handle_pan_disconnect_command(LSHandle *sh, LSMessage *message,
 		goto cleanup;
 	}
 
+	g_free(pan_connected_address);
+	pan_connected_address = NULL;
+
 	if (!connman_service_disconnect(connected_service))
 	{
 		LSMessageReplyCustomError(sh, message,
@@ -758,6 +1000,21 @@ Name | Required | Type | Description
 returnValue | yes | Boolean | True
 networkInfo | No | Object | A single object describing the current connection
 tetheringEnabled | Yes | Boolean | Indicates if PAN tethering is enabled or not
+rememberedNaps | Yes | Array of Object | NAPs connected before, most recent first. See below
+maxReconnectAttempts | Yes | Number | Reconnect attempts to a lost NAP before giving up
+
+@par "rememberedNaps" Object
+
+A connected NAP which is lost without an explicit disconnect is reconnected
+with a delay doubling with every attempt.
+
+Name | Required | Type | Description
+-----|--------|------|----------
+address | Yes | String | Address of the NAP
+autoReconnect | Yes | Boolean | False after an explicit disconnect or once the attempts ran out
+reconnectAttempts | Yes | Number | Reconnect attempts since the NAP was lost
+totalReconnectAttempts | Yes | Number | Reconnect attempts since the adapter started
+retryIn | No | Number | Seconds until the next reconnect attempt
 
 @par "networkInfo" Object
 
@@ -980,6 +1237,16 @@ static LSMethod pan_methods[] =
 	{},
 };
 
+/**
+ * Cancel the pending connman calls of a luna call the caller has cancelled
+ */
+
+static void handle_luna_call_cancel(LSHandle *sh, LSMessage *message,
+                                    void *ctx)
+{
+	dbus_call_scope_cancel(LSMessageGetUniqueToken(message));
+}
+
 int initialize_pan_ls2_calls(GMainLoop *mainloop, LSHandle **pan_handle)
 {
 	LSError lserror;
@@ -1010,6 +1277,13 @@ int initialize_pan_ls2_calls(GMainLoop *mainloop, LSHandle **pan_handle)
 		goto Exit;
 	}
 
+	if (LSSubscriptionSetCancelFunction(pLsHandle, handle_luna_call_cancel, NULL,
+	                                    &lserror) == false)
+	{
+		WCALOG_ESCAPED_ERRMSG(MSGID_PAN_LUNA_BUS_ERROR, lserror.message);
+		goto Exit;
+	}
+
 	*pan_handle = pLsHandle;
 
 	return 0;
@@ -1063,4 +1337,7 @@ void check_and_initialize_bluetooth_technology(void)
 
 		connman_service_register_property_changed_cb(service, service_changed_cb);
 	}
+
+	/* Remember the connected NAP */
+	check_pan_reconnect();
 }
@@ -44,5 +44,6 @@ extern void send_pan_connection_status_to_subscribers(void);
 extern int initialize_pan_ls2_calls(GMainLoop *mainloop,
                                     LSHandle **pan_handle);
 extern void check_and_initialize_bluetooth_technology(void);
+extern void check_pan_reconnect(void);
 
 #endif /* _PAN_SERVICE_H_ */
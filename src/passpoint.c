@@ -0,0 +1,650 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  passpoint.c
+ *
+ * @brief Hotspot 2.0 (Passpoint) credentials and network matching
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "passpoint.h"
+
+#define IE_SSID                     0
+#define IE_ROAMING_CONSORTIUM       111
+#define IE_VENDOR                   221
+
+/* Vendor specific Hotspot 2.0 indication element of the Wi-Fi Alliance */
+#define HS20_INDICATION_TYPE        0x10
+
+static const guint8 wfa_oui[] = { 0x50, 0x6f, 0x9a };
+
+static GList *credentials = NULL;
+
+/* SSID of a provisioned network -> id of its credential */
+static GHashTable *provisioned = NULL;
+
+/* Keys point into the credentials, rebuilt whenever they change */
+static GHashTable *oi_index = NULL;
+static GHashTable *realm_index = NULL;
+static GHashTable *domain_index = NULL;
+
+static guint ascii_case_hash(gconstpointer key)
+{
+	const gchar *p;
+	guint hash = 5381;
+
+	for (p = key; *p; p++)
+	{
+		hash = (hash << 5) + hash + g_ascii_tolower(*p);
+	}
+
+	return hash;
+}
+
+static gboolean ascii_case_equal(gconstpointer a, gconstpointer b)
+{
+	return !g_ascii_strcasecmp(a, b);
+}
+
+/* Keep the credential with the highest priority for each key */
+static void index_insert(GHashTable *index, const gchar *key,
+                         passpoint_credential_t *credential)
+{
+	passpoint_credential_t *current;
+
+	if (NULL == key)
+	{
+		return;
+	}
+
+	current = g_hash_table_lookup(index, key);
+
+	if (NULL == current || credential->priority > current->priority)
+	{
+		g_hash_table_insert(index, (gpointer) key, credential);
+	}
+}
+
+static void rebuild_index(void)
+{
+	GList *iter;
+
+	if (NULL == oi_index)
+	{
+		oi_index = g_hash_table_new(ascii_case_hash, ascii_case_equal);
+		realm_index = g_hash_table_new(ascii_case_hash, ascii_case_equal);
+		domain_index = g_hash_table_new(ascii_case_hash, ascii_case_equal);
+	}
+
+	g_hash_table_remove_all(oi_index);
+	g_hash_table_remove_all(realm_index);
+	g_hash_table_remove_all(domain_index);
+
+	for (iter = credentials; NULL != iter; iter = iter->next)
+	{
+		passpoint_credential_t *credential = iter->data;
+		gsize i;
+
+		for (i = 0; NULL != credential->roaming_consortiums &&
+		        NULL != credential->roaming_consortiums[i]; i++)
+		{
+			index_insert(oi_index, credential->roaming_consortiums[i], credential);
+		}
+
+		index_insert(realm_index, credential->realm, credential);
+		index_insert(domain_index, credential->domain, credential);
+	}
+}
+
+static GList *find_credential(const gchar *id)
+{
+	GList *iter;
+
+	for (iter = credentials; NULL != iter; iter = iter->next)
+	{
+		if (!g_strcmp0(((passpoint_credential_t *) iter->data)->id, id))
+		{
+			return iter;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Create a credential (see header for API details)
+ */
+
+passpoint_credential_t *passpoint_credential_new(const gchar *id)
+{
+	passpoint_credential_t *credential = g_new0(passpoint_credential_t, 1);
+
+	credential->id = g_strdup(id);
+
+	return credential;
+}
+
+void passpoint_credential_free(passpoint_credential_t *credential)
+{
+	if (NULL == credential)
+	{
+		return;
+	}
+
+	g_free(credential->id);
+	g_free(credential->realm);
+	g_free(credential->domain);
+	g_strfreev(credential->roaming_consortiums);
+	g_free(credential->eap_type);
+	g_free(credential->identity);
+	g_free(credential->passphrase);
+	g_free(credential->ca_cert_file);
+	g_free(credential->client_cert_file);
+	g_free(credential->private_key_file);
+	g_free(credential->private_key_passphrase);
+	g_free(credential->phase2);
+	g_free(credential);
+}
+
+/**
+ * Check an OI (see header for API details)
+ */
+
+gboolean passpoint_oi_is_valid(const gchar *oi)
+{
+	gsize i, len = (NULL != oi) ? strlen(oi) : 0;
+
+	if (len != 6 && len != 10)
+	{
+		return FALSE;
+	}
+
+	for (i = 0; i < len; i++)
+	{
+		if (!g_ascii_isxdigit(oi[i]))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Check a credential (see header for API details)
+ */
+
+gboolean passpoint_credential_is_valid(const passpoint_credential_t
+                                       *credential)
+{
+	gsize i;
+
+	if (NULL == credential || NULL == credential->id ||
+	        NULL == credential->eap_type || NULL == credential->realm ||
+	        !strlen(credential->realm))
+	{
+		return FALSE;
+	}
+
+	for (i = 0; NULL != credential->roaming_consortiums &&
+	        NULL != credential->roaming_consortiums[i]; i++)
+	{
+		if (!passpoint_oi_is_valid(credential->roaming_consortiums[i]))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static void set_ascii_case(gchar **str, gboolean upper)
+{
+	gchar *converted;
+
+	if (NULL == *str)
+	{
+		return;
+	}
+
+	converted = upper ? g_ascii_strup(*str, -1) : g_ascii_strdown(*str, -1);
+	g_free(*str);
+	*str = converted;
+}
+
+/**
+ * Add a credential (see header for API details)
+ */
+
+void passpoint_add_credential(passpoint_credential_t *credential)
+{
+	GList *link = find_credential(credential->id);
+	gsize i;
+
+	if (NULL != link)
+	{
+		passpoint_credential_free(link->data);
+		credentials = g_list_delete_link(credentials, link);
+	}
+
+	for (i = 0; NULL != credential->roaming_consortiums &&
+	        NULL != credential->roaming_consortiums[i]; i++)
+	{
+		set_ascii_case(&credential->roaming_consortiums[i], TRUE);
+	}
+
+	set_ascii_case(&credential->realm, FALSE);
+	set_ascii_case(&credential->domain, FALSE);
+
+	credentials = g_list_append(credentials, credential);
+	rebuild_index();
+}
+
+/**
+ * Remove a credential (see header for API details)
+ */
+
+gboolean passpoint_remove_credential(const gchar *id)
+{
+	GList *link = find_credential(id);
+
+	if (NULL == link)
+	{
+		return FALSE;
+	}
+
+	passpoint_credential_free(link->data);
+	credentials = g_list_delete_link(credentials, link);
+	rebuild_index();
+
+	return TRUE;
+}
+
+const passpoint_credential_t *passpoint_get_credential(const gchar *id)
+{
+	GList *link = find_credential(id);
+
+	return NULL != link ? link->data : NULL;
+}
+
+/**
+ * Get the credentials (see header for API details)
+ */
+
+const GList *passpoint_get_credentials(void)
+{
+	return credentials;
+}
+
+static void consider(const passpoint_credential_t *candidate,
+                     passpoint_match_t match, passpoint_match_t *best_match,
+                     const passpoint_credential_t **best)
+{
+	if (NULL == candidate)
+	{
+		return;
+	}
+
+	if (match > *best_match ||
+	        (match == *best_match && candidate->priority > (*best)->priority))
+	{
+		*best_match = match;
+		*best = candidate;
+	}
+}
+
+/**
+ * Match a network (see header for API details)
+ */
+
+passpoint_match_t passpoint_match(const passpoint_anqp_t *anqp,
+                                  const passpoint_credential_t **credential)
+{
+	passpoint_match_t best_match = PASSPOINT_MATCH_NONE;
+	const passpoint_credential_t *best = NULL;
+	gsize i;
+
+	if (NULL == oi_index || NULL == anqp)
+	{
+		goto out;
+	}
+
+	/* A domain name and each of its parent domains */
+	for (i = 0; NULL != anqp->domains && NULL != anqp->domains[i]; i++)
+	{
+		const gchar *suffix = anqp->domains[i];
+
+		while (NULL != suffix && *suffix)
+		{
+			consider(g_hash_table_lookup(domain_index, suffix), PASSPOINT_MATCH_HOME,
+			         &best_match, &best);
+			suffix = strchr(suffix, '.');
+
+			if (NULL != suffix)
+			{
+				suffix++;
+			}
+		}
+	}
+
+	for (i = 0; NULL != anqp->nai_realms && NULL != anqp->nai_realms[i]; i++)
+	{
+		consider(g_hash_table_lookup(realm_index, anqp->nai_realms[i]),
+		         PASSPOINT_MATCH_ROAMING, &best_match, &best);
+	}
+
+	for (i = 0; NULL != anqp->roaming_consortiums &&
+	        NULL != anqp->roaming_consortiums[i]; i++)
+	{
+		consider(g_hash_table_lookup(oi_index, anqp->roaming_consortiums[i]),
+		         PASSPOINT_MATCH_ROAMING, &best_match, &best);
+	}
+
+out:
+
+	if (NULL != credential)
+	{
+		*credential = best;
+	}
+
+	return best_match;
+}
+
+passpoint_bss_t *passpoint_bss_new(void)
+{
+	return g_new0(passpoint_bss_t, 1);
+}
+
+void passpoint_bss_free(gpointer data)
+{
+	passpoint_bss_t *bss = data;
+
+	if (NULL == bss)
+	{
+		return;
+	}
+
+	g_free(bss->ssid);
+	g_strfreev(bss->anqp.roaming_consortiums);
+	g_strfreev(bss->anqp.nai_realms);
+	g_strfreev(bss->anqp.domains);
+	g_free(bss);
+}
+
+static void add_oi(GPtrArray *ois, const guint8 *oi, gsize len)
+{
+	GString *hex = g_string_sized_new(len * 2);
+	gsize i;
+
+	for (i = 0; i < len; i++)
+	{
+		g_string_append_printf(hex, "%02X", oi[i]);
+	}
+
+	g_ptr_array_add(ois, g_string_free(hex, FALSE));
+}
+
+/*
+ * Roaming Consortium element: number of ANQP OIs, the lengths of OI #1 and #2
+ * in a nibble each, then up to three OIs, OI #3 taking the remaining octets
+ */
+static void parse_roaming_consortium(const guint8 *data, gsize len,
+                                     GPtrArray *ois)
+{
+	gsize len1, len2, pos = 2;
+
+	if (len < 2)
+	{
+		return;
+	}
+
+	len1 = data[1] & 0x0f;
+	len2 = data[1] >> 4;
+
+	if (0 == len1 || pos + len1 > len)
+	{
+		return;
+	}
+
+	add_oi(ois, data + pos, len1);
+	pos += len1;
+
+	if (0 == len2 || pos + len2 > len)
+	{
+		return;
+	}
+
+	add_oi(ois, data + pos, len2);
+	pos += len2;
+
+	if (pos < len)
+	{
+		add_oi(ois, data + pos, len - pos);
+	}
+}
+
+/**
+ * Parse the information elements of a BSS (see header for API details)
+ */
+
+gboolean passpoint_parse_ies(const guint8 *ies, gsize len,
+                             passpoint_bss_t *bss)
+{
+	GPtrArray *ois = g_ptr_array_new();
+	gboolean hs20 = FALSE;
+	gsize pos = 0;
+
+	while (pos + 2 <= len)
+	{
+		guint8 id = ies[pos];
+		gsize elen = ies[pos + 1];
+		const guint8 *data = ies + pos + 2;
+
+		if (pos + 2 + elen > len)
+		{
+			break;
+		}
+
+		switch (id)
+		{
+			case IE_SSID:
+				if (NULL == bss->ssid && elen <= 32)
+				{
+					bss->ssid = g_strndup((const gchar *) data, elen);
+				}
+
+				break;
+
+			case IE_ROAMING_CONSORTIUM:
+				parse_roaming_consortium(data, elen, ois);
+				break;
+
+			case IE_VENDOR:
+				if (elen >= 4 && !memcmp(data, wfa_oui, sizeof(wfa_oui)) &&
+				        HS20_INDICATION_TYPE == data[3])
+				{
+					hs20 = TRUE;
+				}
+
+				break;
+
+			default:
+				break;
+		}
+
+		pos += 2 + elen;
+	}
+
+	if (ois->len > 0)
+	{
+		g_ptr_array_add(ois, NULL);
+		g_strfreev(bss->anqp.roaming_consortiums);
+		bss->anqp.roaming_consortiums = (GStrv) g_ptr_array_free(ois, FALSE);
+	}
+	else
+	{
+		g_ptr_array_free(ois, TRUE);
+	}
+
+	return hs20;
+}
+
+static gint compare_bss(gconstpointer a, gconstpointer b)
+{
+	const passpoint_bss_t *bss_a = a, *bss_b = b;
+
+	if (bss_a->match != bss_b->match)
+	{
+		return bss_a->match > bss_b->match ? -1 : 1;
+	}
+
+	if (bss_a->credential->priority != bss_b->credential->priority)
+	{
+		return bss_a->credential->priority > bss_b->credential->priority ? -1 : 1;
+	}
+
+	return bss_b->signal - bss_a->signal;
+}
+
+/**
+ * Match and order BSSes (see header for API details)
+ */
+
+GList *passpoint_rank(GList *bsses)
+{
+	GList *iter = bsses;
+
+	while (NULL != iter)
+	{
+		GList *next = iter->next;
+		passpoint_bss_t *bss = iter->data;
+
+		bss->match = passpoint_match(&bss->anqp, &bss->credential);
+
+		if (PASSPOINT_MATCH_NONE == bss->match)
+		{
+			passpoint_bss_free(bss);
+			bsses = g_list_delete_link(bsses, iter);
+		}
+
+		iter = next;
+	}
+
+	return g_list_sort(bsses, compare_bss);
+}
+
+const gchar *passpoint_match_to_string(passpoint_match_t match)
+{
+	switch (match)
+	{
+		case PASSPOINT_MATCH_HOME:
+			return "home";
+
+		case PASSPOINT_MATCH_ROAMING:
+			return "roaming";
+
+		default:
+			return "none";
+	}
+}
+
+/**
+ * Remember a provisioned network (see header for API details)
+ */
+
+void passpoint_set_provisioned(const gchar *ssid, const gchar *id)
+{
+	if (NULL == ssid)
+	{
+		return;
+	}
+
+	if (NULL == provisioned)
+	{
+		provisioned = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	}
+
+	if (NULL != id)
+	{
+		g_hash_table_insert(provisioned, g_strdup(ssid), g_strdup(id));
+	}
+	else
+	{
+		g_hash_table_remove(provisioned, ssid);
+	}
+}
+
+/**
+ * Get the credential of a provisioned network (see header for API details)
+ */
+
+const gchar *passpoint_get_provisioned(const gchar *ssid)
+{
+	if (NULL == provisioned || NULL == ssid)
+	{
+		return NULL;
+	}
+
+	return g_hash_table_lookup(provisioned, ssid);
+}
+
+/**
+ * Get the provisioned networks (see header for API details)
+ */
+
+GList *passpoint_get_provisioned_ssids(const gchar *id)
+{
+	GHashTableIter iter;
+	gpointer ssid, network_id;
+	GList *ssids = NULL;
+
+	if (NULL == provisioned)
+	{
+		return NULL;
+	}
+
+	g_hash_table_iter_init(&iter, provisioned);
+
+	while (g_hash_table_iter_next(&iter, &ssid, &network_id))
+	{
+		if (NULL == id || !g_strcmp0(id, network_id))
+		{
+			ssids = g_list_prepend(ssids, ssid);
+		}
+	}
+
+	return ssids;
+}
+
+/**
+ * Drop all credentials (see header for API details)
+ */
+
+void passpoint_reset(void)
+{
+	g_list_free_full(credentials, (GDestroyNotify) passpoint_credential_free);
+	credentials = NULL;
+	rebuild_index();
+
+	if (NULL != provisioned)
+	{
+		g_hash_table_remove_all(provisioned);
+	}
+}
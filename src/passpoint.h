@@ -0,0 +1,191 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  passpoint.h
+ *
+ * @brief Header file defining Hotspot 2.0 (Passpoint) credentials and the
+ *        matching of networks against them
+ *
+ * A network is a home network of a credential if one of its domain names is
+ * the home domain of the credential or a subdomain of it. It is a roaming
+ * network if it advertises one of the roaming consortium OIs or NAI realms of
+ * the credential. The OIs, realms and domains of all credentials are kept in
+ * hash sets, so matching a network costs a few lookups however many
+ * credentials there are.
+ *
+ */
+
+#ifndef _PASSPOINT_H_
+#define _PASSPOINT_H_
+
+#include <glib.h>
+
+typedef enum
+{
+	PASSPOINT_MATCH_NONE,
+	PASSPOINT_MATCH_ROAMING,
+	PASSPOINT_MATCH_HOME,
+} passpoint_match_t;
+
+typedef struct passpoint_credential
+{
+	gchar *id;
+	gchar *realm;                   /* NAI realm, lower case */
+	gchar *domain;                  /* Home domain, lower case, NULL if none */
+	GStrv roaming_consortiums;      /* OIs as upper case hex */
+	gint priority;                  /* Higher is preferred */
+	gchar *eap_type;
+	gchar *identity;
+	gchar *passphrase;
+	gchar *ca_cert_file;
+	gchar *client_cert_file;
+	gchar *private_key_file;
+	gchar *private_key_passphrase;
+	gchar *phase2;
+} passpoint_credential_t;
+
+/**
+ * What a network advertises about the service providers it gives access to
+ */
+typedef struct passpoint_anqp
+{
+	GStrv roaming_consortiums;      /* OIs as hex */
+	GStrv nai_realms;
+	GStrv domains;
+} passpoint_anqp_t;
+
+typedef struct passpoint_bss
+{
+	gchar *ssid;
+	gchar bssid[18];
+	gint frequency;
+	gint signal;                    /* dBm */
+	passpoint_anqp_t anqp;
+
+	/* Filled by passpoint_rank */
+	passpoint_match_t match;
+	const passpoint_credential_t *credential;
+} passpoint_bss_t;
+
+extern passpoint_credential_t *passpoint_credential_new(const gchar *id);
+extern void passpoint_credential_free(passpoint_credential_t *credential);
+
+/**
+ * Check a credential can be matched and connected with
+ *
+ * @return TRUE if it has an EAP type, a realm and a valid OI list
+ */
+extern gboolean passpoint_credential_is_valid(const passpoint_credential_t
+        *credential);
+
+/**
+ * Check a roaming consortium OI, 3 or 5 octets in hex
+ */
+extern gboolean passpoint_oi_is_valid(const gchar *oi);
+
+/**
+ * Add a credential, replacing the one with the same id
+ *
+ * @param[IN]  credential Valid credential, owned by the module afterwards
+ */
+extern void passpoint_add_credential(passpoint_credential_t *credential);
+
+/**
+ * Remove a credential
+ *
+ * @return TRUE if there was a credential with the id
+ */
+extern gboolean passpoint_remove_credential(const gchar *id);
+
+extern const passpoint_credential_t *passpoint_get_credential(const gchar *id);
+
+/**
+ * Get the credentials
+ *
+ * @return List of passpoint_credential_t, owned by the module
+ */
+extern const GList *passpoint_get_credentials(void);
+
+/**
+ * Match what a network advertises against the credentials
+ *
+ * @param[IN]  anqp What the network advertises
+ * @param[OUT] credential Best matching credential, may be NULL
+ *
+ * @return How the network matched, PASSPOINT_MATCH_NONE if it didn't
+ */
+extern passpoint_match_t passpoint_match(const passpoint_anqp_t *anqp,
+        const passpoint_credential_t **credential);
+
+extern passpoint_bss_t *passpoint_bss_new(void);
+extern void passpoint_bss_free(gpointer data);
+
+/**
+ * Read the SSID and roaming consortium OIs from the information elements of a
+ * BSS
+ *
+ * @param[IN]  ies Information elements
+ * @param[IN]  len Length of ies
+ * @param[OUT] bss BSS to fill
+ *
+ * @return TRUE if the BSS indicates Hotspot 2.0 support
+ */
+extern gboolean passpoint_parse_ies(const guint8 *ies, gsize len,
+                                    passpoint_bss_t *bss);
+
+/**
+ * Match BSSes and order them by preference: home networks first, then by the
+ * priority of the credential and the signal strength
+ *
+ * @param[IN]  bsses List of passpoint_bss_t, taken over
+ *
+ * @return List of the matching BSSes, the others are freed
+ */
+extern GList *passpoint_rank(GList *bsses);
+
+extern const gchar *passpoint_match_to_string(passpoint_match_t match);
+
+/**
+ * Remember which credential a network was provisioned with
+ *
+ * @param[IN]  ssid SSID of the network
+ * @param[IN]  id Id of the credential, NULL to forget the network
+ */
+extern void passpoint_set_provisioned(const gchar *ssid, const gchar *id);
+
+/**
+ * Get the id of the credential a network was provisioned with
+ *
+ * @return Id, NULL if the network wasn't provisioned from a credential
+ */
+extern const gchar *passpoint_get_provisioned(const gchar *ssid);
+
+/**
+ * Get the networks provisioned with a credential
+ *
+ * @param[IN]  id Id of the credential, NULL for all networks
+ *
+ * @return List of SSIDs owned by the module, free the list with g_list_free
+ */
+extern GList *passpoint_get_provisioned_ssids(const gchar *id);
+
+/**
+ * Drop all credentials and provisioned networks
+ */
+extern void passpoint_reset(void);
+
+#endif /* _PASSPOINT_H_ */
@@ -0,0 +1,110 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  passpoint_nl80211.c
+ *
+ * @brief Reads Hotspot 2.0 networks from the scan results of cfg80211
+ *
+ */
+
+#include <glib.h>
+#include <linux/nl80211.h>
+
+#include "passpoint.h"
+#include "passpoint_nl80211.h"
+#include "nl80211_utils.h"
+
+/**
+ * Parse a Hotspot 2.0 network of a scan dump (see header for API details)
+ */
+
+passpoint_bss_t *passpoint_nl80211_parse_bss(const guint8 *attrs, gsize len)
+{
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+	passpoint_bss_t *bss = passpoint_bss_new();
+	gboolean hs20 = FALSE;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		const guint8 *value = genl_attr_data(attr);
+
+		switch (genl_attr_type(attr))
+		{
+			case NL80211_BSS_BSSID:
+				if (genl_attr_len(attr) >= 6)
+				{
+					g_snprintf(bss->bssid, sizeof(bss->bssid),
+					           "%02X:%02X:%02X:%02X:%02X:%02X", value[0], value[1], value[2],
+					           value[3], value[4], value[5]);
+				}
+
+				break;
+
+			case NL80211_BSS_FREQUENCY:
+				bss->frequency = genl_attr_u32(attr);
+				break;
+
+			case NL80211_BSS_SIGNAL_MBM:
+				bss->signal = (gint32) genl_attr_u32(attr) / 100;
+				break;
+
+			case NL80211_BSS_INFORMATION_ELEMENTS:
+				hs20 = passpoint_parse_ies(value, genl_attr_len(attr), bss);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (!hs20 || NULL == bss->ssid || !*bss->ssid)
+	{
+		passpoint_bss_free(bss);
+		return NULL;
+	}
+
+	return bss;
+}
+
+static void scan_cb(const guint8 *attrs, gsize len, gpointer user_data)
+{
+	GList **bsses = user_data;
+	passpoint_bss_t *bss = passpoint_nl80211_parse_bss(attrs, len);
+
+	if (NULL != bss)
+	{
+		*bsses = g_list_prepend(*bsses, bss);
+	}
+}
+
+/**
+ * Get the Hotspot 2.0 networks of the last scan (see header for API details)
+ */
+
+GList *passpoint_nl80211_get_bsses(const gchar *iface, GError **error)
+{
+	GList *bsses = NULL;
+
+	if (!nl80211_dump_scan(iface, scan_cb, &bsses, error))
+	{
+		g_list_free_full(bsses, passpoint_bss_free);
+		bsses = NULL;
+	}
+
+	return bsses;
+}
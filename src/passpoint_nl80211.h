@@ -0,0 +1,59 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  passpoint_nl80211.h
+ *
+ * @brief Header file defining how Hotspot 2.0 networks are read from the
+ *        scan results of cfg80211
+ *
+ * Only what beacons and probe responses carry is known this way: the
+ * roaming consortium OIs of the Roaming Consortium element. NAI realms and
+ * domain names need an ANQP query, which connman doesn't pass on.
+ *
+ */
+
+#ifndef _PASSPOINT_NL80211_H_
+#define _PASSPOINT_NL80211_H_
+
+#include <glib.h>
+
+#include "passpoint.h"
+
+/**
+ * Parse a BSS of a scan dump
+ *
+ * @param[IN]  attrs NL80211_BSS_* attributes of the BSS, see nl80211_dump_scan
+ * @param[IN]  len Length of the attributes
+ *
+ * @return Hotspot 2.0 network, free with passpoint_bss_free, NULL if the BSS
+ *         isn't one
+ */
+extern passpoint_bss_t *passpoint_nl80211_parse_bss(const guint8 *attrs,
+        gsize len);
+
+/**
+ * Get the Hotspot 2.0 networks of the last scan. Runs a scan dump of its
+ * own, use passpoint_nl80211_parse_bss while dumping the scan anyway.
+ *
+ * @param[IN]  iface Name of the wireless interface
+ * @param[OUT] error Why the scan results can't be read
+ *
+ * @return List of passpoint_bss_t, NULL on failure or if there are none
+ */
+extern GList *passpoint_nl80211_get_bsses(const gchar *iface, GError **error);
+
+#endif /* _PASSPOINT_NL80211_H_ */
@@ -0,0 +1,134 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  power_save.c
+ *
+ * @brief Wifi power save policy
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "power_save.h"
+
+static const gchar *mode_names[POWER_SAVE_MODE_LAST] =
+{
+	[POWER_SAVE_MODE_DEFAULT] = "default",
+	[POWER_SAVE_MODE_ON] = "on",
+	[POWER_SAVE_MODE_OFF] = "off",
+	[POWER_SAVE_MODE_ADAPTIVE] = "adaptive",
+};
+
+/**
+ * Get the name of a mode (see header for API details)
+ */
+
+const gchar *power_save_mode_to_string(power_save_mode_t mode)
+{
+	return mode < POWER_SAVE_MODE_LAST ? mode_names[mode] : NULL;
+}
+
+/**
+ * Look up a mode by name (see header for API details)
+ */
+
+power_save_mode_t power_save_mode_from_string(const gchar *name)
+{
+	power_save_mode_t mode;
+
+	for (mode = 0; mode < POWER_SAVE_MODE_LAST; mode++)
+	{
+		if (!g_strcmp0(mode_names[mode], name))
+		{
+			return mode;
+		}
+	}
+
+	return POWER_SAVE_MODE_LAST;
+}
+
+/**
+ * Reset a policy (see header for API details)
+ */
+
+void power_save_policy_init(power_save_policy_t *policy,
+                            guint busy_byte_rate, guint busy_packet_rate, guint idle_hold_ms)
+{
+	memset(policy, 0, sizeof(power_save_policy_t));
+
+	policy->busy_byte_rate = busy_byte_rate;
+	policy->busy_packet_rate = busy_packet_rate;
+	policy->idle_hold_ms = idle_hold_ms;
+	policy->enabled = TRUE;
+}
+
+/**
+ * Feed a sample to the policy (see header for API details)
+ */
+
+gboolean power_save_policy_update(power_save_policy_t *policy,
+                                  guint64 bytes, guint64 packets, gint64 now_ms)
+{
+	gint64 elapsed_ms = now_ms - policy->last_time_ms;
+	gboolean busy;
+
+	if (!policy->started || bytes < policy->last_bytes ||
+	        packets < policy->last_packets || elapsed_ms <= 0)
+	{
+		policy->started = TRUE;
+		policy->last_bytes = bytes;
+		policy->last_packets = packets;
+		policy->last_time_ms = now_ms;
+		policy->byte_rate = 0;
+		policy->packet_rate = 0;
+		return FALSE;
+	}
+
+	policy->byte_rate = (bytes - policy->last_bytes) * 1000 / elapsed_ms;
+	policy->packet_rate = (packets - policy->last_packets) * 1000 / elapsed_ms;
+	policy->last_bytes = bytes;
+	policy->last_packets = packets;
+	policy->last_time_ms = now_ms;
+
+	busy = policy->byte_rate >= policy->busy_byte_rate ||
+	       policy->packet_rate >= policy->busy_packet_rate;
+
+	if (busy)
+	{
+		policy->last_busy_ms = now_ms;
+
+		if (policy->enabled)
+		{
+			policy->enabled = FALSE;
+			policy->disable_count++;
+			return TRUE;
+		}
+
+		return FALSE;
+	}
+
+	/* Bursts in a row shouldn't toggle power save every second */
+	if (!policy->enabled && now_ms - policy->last_busy_ms >= policy->idle_hold_ms)
+	{
+		policy->enabled = TRUE;
+		policy->enable_count++;
+		return TRUE;
+	}
+
+	return FALSE;
+}
@@ -0,0 +1,117 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  power_save.h
+ *
+ * @brief Header file defining the wifi power save policy
+ *
+ * Power save lets the wifi radio sleep between beacons, which saves power but
+ * adds latency and limits throughput. In the adaptive mode the policy is fed
+ * the byte and packet totals of the wifi link once a second: power save is
+ * turned off as soon as either rate reaches its busy threshold and turned
+ * back on once the link was idle for the hold time.
+ *
+ */
+
+#ifndef _POWER_SAVE_H_
+#define _POWER_SAVE_H_
+
+#include <glib.h>
+
+/**
+ * Default thresholds, see the powerSaveBusyByteRate, powerSaveBusyPacketRate
+ * and powerSaveIdleHold runtime parameters
+ */
+#define POWER_SAVE_BUSY_BYTE_RATE       128     /* kB/s */
+#define POWER_SAVE_BUSY_PACKET_RATE     100     /* packets/s */
+#define POWER_SAVE_IDLE_HOLD            10      /* s */
+
+typedef enum
+{
+	POWER_SAVE_MODE_DEFAULT = 0,    /* Leave power save to the driver */
+	POWER_SAVE_MODE_ON,
+	POWER_SAVE_MODE_OFF,
+	POWER_SAVE_MODE_ADAPTIVE,
+	POWER_SAVE_MODE_LAST,
+} power_save_mode_t;
+
+typedef struct power_save_policy
+{
+	guint busy_byte_rate;       /* Thresholds in bytes/s and packets/s */
+	guint busy_packet_rate;
+	guint idle_hold_ms;
+
+	gboolean enabled;           /* Power save state the policy asks for */
+	guint64 byte_rate;          /* Rates of the last sample */
+	guint64 packet_rate;
+	guint enable_count;         /* Transitions since power_save_policy_init */
+	guint disable_count;
+
+	gboolean started;           /* Whether there is a previous sample */
+	guint64 last_bytes;
+	guint64 last_packets;
+	gint64 last_time_ms;
+	gint64 last_busy_ms;
+} power_save_policy_t;
+
+/**
+ * Get the name of a mode as used in the luna API
+ *
+ * @param[IN]  mode Mode
+ *
+ * @return "default", "on", "off" or "adaptive"
+ */
+extern const gchar *power_save_mode_to_string(power_save_mode_t mode);
+
+/**
+ * Look up a mode by name
+ *
+ * @param[IN]  name Name of the mode
+ *
+ * @return Mode, POWER_SAVE_MODE_LAST if unknown
+ */
+extern power_save_mode_t power_save_mode_from_string(const gchar *name);
+
+/**
+ * Reset a policy to power save enabled without a previous sample
+ *
+ * @param[OUT] policy Policy
+ * @param[IN]  busy_byte_rate Byte rate in bytes/s at which the link is busy
+ * @param[IN]  busy_packet_rate Packet rate in packets/s at which the link is
+ *                              busy
+ * @param[IN]  idle_hold_ms Time in ms the link has to be idle before power
+ *                          save is enabled again
+ */
+extern void power_save_policy_init(power_save_policy_t *policy,
+                                   guint busy_byte_rate, guint busy_packet_rate, guint idle_hold_ms);
+
+/**
+ * Feed a sample of the link totals to the policy. The first sample, and one
+ * with a total lower than the previous one (e.g. after a reconnect), only
+ * starts a new measurement.
+ *
+ * @param[IN]  policy Policy
+ * @param[IN]  bytes Bytes received and sent so far
+ * @param[IN]  packets Packets received and sent so far
+ * @param[IN]  now_ms Monotonic time of the sample in ms
+ *
+ * @return TRUE if the power save state changed, FALSE otherwise
+ */
+extern gboolean power_save_policy_update(power_save_policy_t *policy,
+        guint64 bytes, guint64 packets, gint64 now_ms);
+
+#endif /* _POWER_SAVE_H_ */
@@ -0,0 +1,332 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  profile_crypto.c
+ *
+ * @brief Encryption of stored wifi profiles
+ *
+ * Profiles are encrypted with AES-256-GCM through the EVP interface, which
+ * picks AES-NI or the ARMv8 crypto extensions where the CPU has them. The
+ * tag lets us tell a tampered or corrupt profile from a valid one instead
+ * of parsing whatever the cipher returns.
+ */
+
+#include <string.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#include <openssl/blowfish.h>
+
+#include "profile_crypto.h"
+
+#define NONCE_LEN       12
+#define TAG_LEN         16
+#define HEADER_LEN      1
+#define KEY_CONTEXT     "webos-connman-adapter profile v2:"
+
+G_DEFINE_QUARK(profile-crypto-error-quark, profile_crypto_error)
+
+/**
+ * Derive the AES key from the key string. The key string used to be the
+ * Blowfish key as is, hashing it gives us the 256 bits AES needs.
+ */
+
+static gboolean derive_key(const gchar *key, guchar out[32])
+{
+	EVP_MD_CTX *ctx = EVP_MD_CTX_new();
+	gboolean ret = FALSE;
+
+	if (NULL == ctx)
+	{
+		return FALSE;
+	}
+
+	if (EVP_DigestInit_ex(ctx, EVP_sha256(), NULL) &&
+	        EVP_DigestUpdate(ctx, KEY_CONTEXT, strlen(KEY_CONTEXT)) &&
+	        EVP_DigestUpdate(ctx, key, strlen(key)) &&
+	        EVP_DigestFinal_ex(ctx, out, NULL))
+	{
+		ret = TRUE;
+	}
+
+	EVP_MD_CTX_free(ctx);
+	return ret;
+}
+
+/**
+ * Check if a blob is in the legacy Blowfish format (see header for API details)
+ */
+
+gboolean profile_crypto_is_legacy(const gchar *blob)
+{
+	return NULL != blob && PROFILE_CRYPTO_PREFIX != blob[0];
+}
+
+/**
+ * Encrypt a profile with AES-256-GCM (see header for API details)
+ */
+
+gchar *profile_crypto_encrypt(const gchar *plaintext, const gchar *key)
+{
+	EVP_CIPHER_CTX *ctx;
+	guchar aes_key[32];
+	guchar *buf;
+	gsize plaintext_len, buf_len;
+	gchar *encoded, *blob = NULL;
+	int len, final_len;
+
+	if (NULL == plaintext || NULL == key)
+	{
+		return NULL;
+	}
+
+	plaintext_len = strlen(plaintext);
+	buf_len = HEADER_LEN + NONCE_LEN + plaintext_len + TAG_LEN;
+	buf = g_malloc(buf_len);
+	buf[0] = PROFILE_CRYPTO_VERSION;
+
+	ctx = EVP_CIPHER_CTX_new();
+
+	if (NULL == ctx || !derive_key(key, aes_key) ||
+	        1 != RAND_bytes(buf + HEADER_LEN, NONCE_LEN))
+	{
+		goto cleanup;
+	}
+
+	if (1 != EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL) ||
+	        1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, NONCE_LEN, NULL) ||
+	        1 != EVP_EncryptInit_ex(ctx, NULL, NULL, aes_key, buf + HEADER_LEN))
+	{
+		goto cleanup;
+	}
+
+	/* The version is authenticated, so it can't be changed to downgrade */
+	if (1 != EVP_EncryptUpdate(ctx, NULL, &len, buf, HEADER_LEN) ||
+	        1 != EVP_EncryptUpdate(ctx, buf + HEADER_LEN + NONCE_LEN, &len,
+	                               (const guchar *) plaintext, plaintext_len) ||
+	        1 != EVP_EncryptFinal_ex(ctx, buf + HEADER_LEN + NONCE_LEN + len,
+	                                 &final_len) ||
+	        1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, TAG_LEN,
+	                                 buf + HEADER_LEN + NONCE_LEN + plaintext_len))
+	{
+		goto cleanup;
+	}
+
+	encoded = g_base64_encode(buf, buf_len);
+	blob = g_strdup_printf("%c%s", PROFILE_CRYPTO_PREFIX, encoded);
+	g_free(encoded);
+
+cleanup:
+	OPENSSL_cleanse(aes_key, sizeof(aes_key));
+	EVP_CIPHER_CTX_free(ctx);
+	g_free(buf);
+	return blob;
+}
+
+static gchar *decrypt_gcm(const gchar *blob, const gchar *key, GError **error)
+{
+	EVP_CIPHER_CTX *ctx = NULL;
+	guchar aes_key[32];
+	guchar *buf;
+	gsize buf_len, ciphertext_len;
+	gchar *plaintext = NULL;
+	int len, final_len;
+
+	buf = g_base64_decode(blob + 1, &buf_len);
+
+	if (buf_len < HEADER_LEN + NONCE_LEN + TAG_LEN)
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_FORMAT,
+		            "Profile too short (%" G_GSIZE_FORMAT " bytes)", buf_len);
+		g_free(buf);
+		return NULL;
+	}
+
+	if (PROFILE_CRYPTO_VERSION != buf[0])
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_VERSION,
+		            "Unsupported profile version %u", buf[0]);
+		g_free(buf);
+		return NULL;
+	}
+
+	ciphertext_len = buf_len - HEADER_LEN - NONCE_LEN - TAG_LEN;
+	plaintext = g_malloc(ciphertext_len + 1);
+	ctx = EVP_CIPHER_CTX_new();
+
+	if (NULL == ctx || !derive_key(key, aes_key))
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_INTERNAL,
+		            "Failed to set up the cipher");
+		goto error;
+	}
+
+	if (1 != EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), NULL, NULL, NULL) ||
+	        1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_IVLEN, NONCE_LEN, NULL) ||
+	        1 != EVP_DecryptInit_ex(ctx, NULL, NULL, aes_key, buf + HEADER_LEN) ||
+	        1 != EVP_DecryptUpdate(ctx, NULL, &len, buf, HEADER_LEN) ||
+	        1 != EVP_DecryptUpdate(ctx, (guchar *) plaintext, &len,
+	                               buf + HEADER_LEN + NONCE_LEN, ciphertext_len) ||
+	        1 != EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, TAG_LEN,
+	                                 buf + buf_len - TAG_LEN))
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_INTERNAL,
+		            "Failed to decrypt profile");
+		goto error;
+	}
+
+	/* Fails if the tag doesn't match */
+	if (1 != EVP_DecryptFinal_ex(ctx, (guchar *) plaintext + len, &final_len))
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_AUTH,
+		            "Profile was tampered with or is corrupt");
+		goto error;
+	}
+
+	plaintext[ciphertext_len] = '\0';
+
+	if (strlen(plaintext) != ciphertext_len)
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_FORMAT,
+		            "Profile contains a NUL character");
+		goto error;
+	}
+
+	OPENSSL_cleanse(aes_key, sizeof(aes_key));
+	EVP_CIPHER_CTX_free(ctx);
+	g_free(buf);
+	return plaintext;
+
+error:
+	OPENSSL_cleanse(aes_key, sizeof(aes_key));
+	EVP_CIPHER_CTX_free(ctx);
+	g_free(buf);
+	g_free(plaintext);
+	return NULL;
+}
+
+static gchar *decrypt_legacy(const gchar *blob, const gchar *key,
+                             GError **error)
+{
+	BF_KEY bf_key;
+	guchar ivec[8] = { 0 };
+	guchar *ciphertext;
+	gchar *plaintext;
+	gsize len, n;
+	int num = 0;
+
+	ciphertext = g_base64_decode(blob, &len);
+
+	if (0 == len)
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_FORMAT,
+		            "Profile is empty or not base64");
+		g_free(ciphertext);
+		return NULL;
+	}
+
+	plaintext = g_malloc(len + 1);
+
+	BF_set_key(&bf_key, strlen(key), (const guchar *) key);
+	BF_cfb64_encrypt(ciphertext, (guchar *) plaintext, len, &bf_key, ivec, &num,
+	                 BF_DECRYPT);
+	plaintext[len] = '\0';
+	g_free(ciphertext);
+
+	/*
+	 * There is nothing to authenticate the legacy format with, so at least
+	 * don't hand on anything which can't be a profile.
+	 */
+	for (n = 0; n < len; n++)
+	{
+		guchar c = plaintext[n];
+
+		if (c < 0x20 && '\t' != c && '\n' != c && '\r' != c)
+		{
+			break;
+		}
+	}
+
+	if (n != len || !g_utf8_validate(plaintext, len, NULL))
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_LEGACY,
+		            "Legacy profile doesn't decrypt to text");
+		g_free(plaintext);
+		return NULL;
+	}
+
+	return plaintext;
+}
+
+/**
+ * Decrypt a profile (see header for API details)
+ */
+
+gchar *profile_crypto_decrypt(const gchar *blob, const gchar *key,
+                              gboolean *legacy, GError **error)
+{
+	gboolean is_legacy = profile_crypto_is_legacy(blob);
+
+	if (NULL != legacy)
+	{
+		*legacy = is_legacy;
+	}
+
+	if (NULL == blob || NULL == key)
+	{
+		g_set_error(error, PROFILE_CRYPTO_ERROR, PROFILE_CRYPTO_ERROR_FORMAT,
+		            "No profile");
+		return NULL;
+	}
+
+	if (is_legacy)
+	{
+		return decrypt_legacy(blob, key, error);
+	}
+
+	return decrypt_gcm(blob, key, error);
+}
+
+/**
+ * Encrypt a profile in the legacy format (see header for API details)
+ */
+
+gchar *profile_crypto_encrypt_legacy(const gchar *plaintext, const gchar *key)
+{
+	BF_KEY bf_key;
+	guchar ivec[8] = { 0 };
+	guchar *ciphertext;
+	gchar *blob;
+	gsize len;
+	int num = 0;
+
+	if (NULL == plaintext || NULL == key)
+	{
+		return NULL;
+	}
+
+	len = strlen(plaintext);
+	ciphertext = g_malloc(len + 1);
+
+	BF_set_key(&bf_key, strlen(key), (const guchar *) key);
+	BF_cfb64_encrypt((const guchar *) plaintext, ciphertext, len, &bf_key, ivec,
+	                 &num, BF_ENCRYPT);
+
+	blob = g_base64_encode(ciphertext, len);
+	g_free(ciphertext);
+
+	return blob;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  profile_crypto.h
+ *
+ * @brief Header file defining the encryption of stored wifi profiles
+ *
+ * Profiles are stored as "$" followed by the base64 encoding of a version
+ * byte, a 12 byte nonce, the AES-256-GCM ciphertext and the 16 byte tag.
+ * The version byte is authenticated as well. Profiles stored by older
+ * versions are plain base64 of the Blowfish CFB64 ciphertext, which never
+ * contains a "$".
+ *
+ */
+
+#ifndef _PROFILE_CRYPTO_H_
+#define _PROFILE_CRYPTO_H_
+
+#include <glib.h>
+
+#define PROFILE_CRYPTO_PREFIX       '$'
+#define PROFILE_CRYPTO_VERSION      2
+
+#define PROFILE_CRYPTO_ERROR        profile_crypto_error_quark()
+
+typedef enum
+{
+	PROFILE_CRYPTO_ERROR_FORMAT,      /* Not base64 or too short */
+	PROFILE_CRYPTO_ERROR_VERSION,     /* Written by a newer version */
+	PROFILE_CRYPTO_ERROR_AUTH,        /* Tampered with or corrupt */
+	PROFILE_CRYPTO_ERROR_LEGACY,      /* Legacy blob which doesn't decrypt to text */
+	PROFILE_CRYPTO_ERROR_INTERNAL,
+} profile_crypto_error_t;
+
+extern GQuark profile_crypto_error_quark(void);
+
+/**
+ * Encrypt a profile with AES-256-GCM
+ *
+ * @param[IN]  plaintext Profile as string
+ * @param[IN]  key Key the AES key is derived from
+ *
+ * @return Newly allocated blob, NULL on failure
+ */
+extern gchar *profile_crypto_encrypt(const gchar *plaintext, const gchar *key);
+
+/**
+ * Decrypt a profile, either from the current or the legacy format
+ *
+ * @param[IN]  blob Blob as returned by profile_crypto_encrypt
+ * @param[IN]  key Key the blob was encrypted with
+ * @param[OUT] legacy Set to TRUE if the blob is in the legacy format and
+ *                    should be encrypted again. May be NULL.
+ * @param[OUT] error Set if the blob couldn't be decrypted or was tampered with
+ *
+ * @return Newly allocated profile string, NULL on failure
+ */
+extern gchar *profile_crypto_decrypt(const gchar *blob, const gchar *key,
+                                     gboolean *legacy, GError **error);
+
+/**
+ * Check if a blob is in the legacy Blowfish format
+ *
+ * @param[IN]  blob Encrypted profile
+ *
+ * @return TRUE for the legacy format, FALSE otherwise
+ */
+extern gboolean profile_crypto_is_legacy(const gchar *blob);
+
+/**
+ * Encrypt a profile in the legacy Blowfish format. Only kept to test the
+ * migration and to compare the throughput.
+ *
+ * @param[IN]  plaintext Profile as string
+ * @param[IN]  key Key
+ *
+ * @return Newly allocated blob, NULL on failure
+ */
+extern gchar *profile_crypto_encrypt_legacy(const gchar *plaintext,
+        const gchar *key);
+
+#endif /* _PROFILE_CRYPTO_H_ */
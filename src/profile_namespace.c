@@ -0,0 +1,401 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  profile_namespace.c
+ *
+ * @brief Profile namespaces for devices shared by several users
+ *
+ */
+
+#include <string.h>
+
+#include "profile_namespace.h"
+
+/* Name -> profile_namespace_t */
+static GHashTable *namespaces = NULL;
+static profile_namespace_t *device_ns = NULL;
+static profile_namespace_t *active_ns = NULL;
+
+static void namespace_free(gpointer data)
+{
+	profile_namespace_t *ns = data;
+
+	g_slist_free(ns->profiles);
+	g_free(ns->name);
+	g_free(ns);
+}
+
+static void namespaces_init(void)
+{
+	if (NULL != namespaces)
+	{
+		return;
+	}
+
+	namespaces = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+	                                   namespace_free);
+	device_ns = g_new0(profile_namespace_t, 1);
+	device_ns->name = g_strdup(PROFILE_NAMESPACE_DEVICE);
+	g_hash_table_insert(namespaces, device_ns->name, device_ns);
+	active_ns = device_ns;
+}
+
+/**
+ * Check if a name can be used for a namespace (see header for API details)
+ */
+
+gboolean profile_namespace_is_valid_name(const gchar *name)
+{
+	const gchar *c;
+
+	if (NULL == name || '\0' == name[0] || '.' == name[0] ||
+	        strlen(name) > PROFILE_NAMESPACE_NAME_MAX)
+	{
+		return FALSE;
+	}
+
+	for (c = name; '\0' != *c; c++)
+	{
+		if (!g_ascii_isalnum(*c) && NULL == strchr(".-_@", *c))
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Look up a namespace (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_lookup(const gchar *name)
+{
+	namespaces_init();
+
+	if (NULL == name)
+	{
+		return NULL;
+	}
+
+	return g_hash_table_lookup(namespaces, name);
+}
+
+/**
+ * Look up a namespace and create it if needed (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_ensure(const gchar *name)
+{
+	profile_namespace_t *ns;
+
+	if (!profile_namespace_is_valid_name(name))
+	{
+		return NULL;
+	}
+
+	ns = profile_namespace_lookup(name);
+
+	if (NULL == ns)
+	{
+		ns = g_new0(profile_namespace_t, 1);
+		ns->name = g_strdup(name);
+		g_hash_table_insert(namespaces, ns->name, ns);
+	}
+
+	return ns;
+}
+
+/**
+ * Remove an empty namespace (see header for API details)
+ */
+
+gboolean profile_namespace_remove(profile_namespace_t *ns)
+{
+	namespaces_init();
+
+	if (NULL == ns || ns == device_ns || NULL != ns->profiles)
+	{
+		return FALSE;
+	}
+
+	if (ns == active_ns)
+	{
+		active_ns = device_ns;
+	}
+
+	return g_hash_table_remove(namespaces, ns->name);
+}
+
+/**
+ * Get the device namespace (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_get_device(void)
+{
+	namespaces_init();
+
+	return device_ns;
+}
+
+/**
+ * Get the active namespace (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_get_active(void)
+{
+	namespaces_init();
+
+	return active_ns;
+}
+
+/**
+ * Make a namespace the active one (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_set_active(profile_namespace_t *ns)
+{
+	profile_namespace_t *previous;
+
+	namespaces_init();
+
+	previous = active_ns;
+
+	if (NULL != ns)
+	{
+		active_ns = ns;
+	}
+
+	return previous;
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b)
+{
+	return g_strcmp0(((const profile_namespace_t *) a)->name,
+	                 ((const profile_namespace_t *) b)->name);
+}
+
+/**
+ * Get all namespaces (see header for API details)
+ */
+
+GList *profile_namespace_get_all(void)
+{
+	namespaces_init();
+
+	return g_list_sort(g_hash_table_get_values(namespaces), compare_names);
+}
+
+/**
+ * Get the namespace a profile belongs to (see header for API details)
+ */
+
+profile_namespace_t *profile_namespace_find(gpointer profile)
+{
+	GHashTableIter iter;
+	gpointer value;
+
+	namespaces_init();
+
+	/* Most lookups are for visible profiles */
+	if (NULL != g_slist_find(active_ns->profiles, profile))
+	{
+		return active_ns;
+	}
+
+	g_hash_table_iter_init(&iter, namespaces);
+
+	while (g_hash_table_iter_next(&iter, NULL, &value))
+	{
+		profile_namespace_t *ns = value;
+
+		if (NULL != g_slist_find(ns->profiles, profile))
+		{
+			return ns;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Iterate the visible profiles (see header for API details)
+ */
+
+gpointer profile_namespace_next_visible(gpointer profile)
+{
+	GSList *node;
+
+	namespaces_init();
+
+	if (NULL == profile)
+	{
+		node = active_ns->profiles;
+
+		if (NULL == node && active_ns != device_ns)
+		{
+			node = device_ns->profiles;
+		}
+
+		return NULL != node ? node->data : NULL;
+	}
+
+	node = g_slist_find(active_ns->profiles, profile);
+
+	if (NULL != node)
+	{
+		if (NULL != node->next)
+		{
+			return node->next->data;
+		}
+
+		if (active_ns != device_ns && NULL != device_ns->profiles)
+		{
+			return device_ns->profiles->data;
+		}
+
+		return NULL;
+	}
+
+	if (active_ns == device_ns)
+	{
+		return NULL;
+	}
+
+	node = g_slist_find(device_ns->profiles, profile);
+
+	if (NULL != node && NULL != node->next)
+	{
+		return node->next->data;
+	}
+
+	return NULL;
+}
+
+static GHashTable *collect_keys(profile_namespace_t *ns,
+                                profile_namespace_key_cb key_cb)
+{
+	GHashTable *keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+	                   NULL);
+	GSList *iter;
+
+	/* The files of the device namespace are never moved */
+	if (NULL == ns || ns == device_ns)
+	{
+		return keys;
+	}
+
+	for (iter = ns->profiles; NULL != iter; iter = iter->next)
+	{
+		gchar *key = key_cb(iter->data);
+
+		if (NULL != key)
+		{
+			g_hash_table_add(keys, key);
+		}
+	}
+
+	return keys;
+}
+
+/**
+ * Work out which .config files differ between namespaces (see header for
+ * API details)
+ */
+
+void profile_namespace_diff(profile_namespace_t *from, profile_namespace_t *to,
+                            profile_namespace_key_cb key_cb, GSList **stash, GSList **restore,
+                            GSList **both)
+{
+	GHashTable *from_keys, *to_keys, *device_keys;
+	GHashTableIter iter;
+	gpointer key;
+	GSList *iter_profile;
+
+	namespaces_init();
+
+	*stash = *restore = *both = NULL;
+
+	if (from == to)
+	{
+		return;
+	}
+
+	from_keys = collect_keys(from, key_cb);
+	to_keys = collect_keys(to, key_cb);
+	device_keys = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+
+	for (iter_profile = device_ns->profiles; NULL != iter_profile;
+	        iter_profile = iter_profile->next)
+	{
+		gchar *device_key = key_cb(iter_profile->data);
+
+		if (NULL != device_key)
+		{
+			g_hash_table_add(device_keys, device_key);
+		}
+	}
+
+	g_hash_table_iter_init(&iter, from_keys);
+
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+	{
+		if (g_hash_table_contains(device_keys, key))
+		{
+			continue;
+		}
+
+		if (g_hash_table_contains(to_keys, key))
+		{
+			*both = g_slist_prepend(*both, g_strdup(key));
+		}
+		else
+		{
+			*stash = g_slist_prepend(*stash, g_strdup(key));
+		}
+	}
+
+	g_hash_table_iter_init(&iter, to_keys);
+
+	while (g_hash_table_iter_next(&iter, &key, NULL))
+	{
+		if (!g_hash_table_contains(device_keys, key) &&
+		        !g_hash_table_contains(from_keys, key))
+		{
+			*restore = g_slist_prepend(*restore, g_strdup(key));
+		}
+	}
+
+	g_hash_table_destroy(device_keys);
+	g_hash_table_destroy(to_keys);
+	g_hash_table_destroy(from_keys);
+}
+
+/**
+ * Remove all namespaces (see header for API details)
+ */
+
+void profile_namespace_reset(void)
+{
+	if (NULL != namespaces)
+	{
+		g_hash_table_destroy(namespaces);
+		namespaces = NULL;
+	}
+
+	namespaces_init();
+}
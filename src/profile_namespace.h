@@ -0,0 +1,163 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  profile_namespace.h
+ *
+ * @brief Header file defining profile namespaces, which give each user or
+ *        account of a shared device its own set of wifi profiles
+ *
+ * Profiles of the shared "device" namespace are visible to everyone. The
+ * profiles of the active namespace are visible in addition, in front of the
+ * shared ones. All namespaces stay loaded, so switching the active namespace
+ * only swaps a pointer.
+ *
+ */
+
+#ifndef _PROFILE_NAMESPACE_H_
+#define _PROFILE_NAMESPACE_H_
+
+#include <glib.h>
+
+#define PROFILE_NAMESPACE_DEVICE        "device"
+#define PROFILE_NAMESPACE_NAME_MAX      64
+
+typedef struct profile_namespace
+{
+	gchar *name;
+	GSList *profiles; /* Ordered by priority, owned by the caller */
+} profile_namespace_t;
+
+/**
+ * Return a newly allocated key identifying the connman .config file of a
+ * profile, NULL if the profile has none
+ */
+typedef gchar *(*profile_namespace_key_cb)(gpointer profile);
+
+/**
+ * Check if a name can be used for a namespace. It is also used as directory
+ * name, so only letters, digits and ".-_@" are allowed.
+ *
+ * @param[IN]  name Name to check
+ *
+ * @return TRUE if valid, FALSE otherwise
+ */
+extern gboolean profile_namespace_is_valid_name(const gchar *name);
+
+/**
+ * Look up a namespace
+ *
+ * @param[IN]  name Name of the namespace
+ *
+ * @return Namespace, NULL if there is none with that name
+ */
+extern profile_namespace_t *profile_namespace_lookup(const gchar *name);
+
+/**
+ * Look up a namespace and create it if needed
+ *
+ * @param[IN]  name Name of the namespace, must be valid
+ *
+ * @return Namespace, NULL if the name isn't valid
+ */
+extern profile_namespace_t *profile_namespace_ensure(const gchar *name);
+
+/**
+ * Remove an empty namespace. The device namespace can't be removed. If the
+ * active namespace is removed, the device namespace becomes active.
+ *
+ * @param[IN]  ns Namespace to remove
+ *
+ * @return TRUE if removed, FALSE otherwise
+ */
+extern gboolean profile_namespace_remove(profile_namespace_t *ns);
+
+/**
+ * Get the shared device namespace, which always exists
+ *
+ * @return Device namespace
+ */
+extern profile_namespace_t *profile_namespace_get_device(void);
+
+/**
+ * Get the active namespace
+ *
+ * @return Active namespace, the device namespace if no user is active
+ */
+extern profile_namespace_t *profile_namespace_get_active(void);
+
+/**
+ * Make a namespace the active one
+ *
+ * @param[IN]  ns Namespace to activate
+ *
+ * @return Previously active namespace
+ */
+extern profile_namespace_t *profile_namespace_set_active(
+    profile_namespace_t *ns);
+
+/**
+ * Get all namespaces, ordered by name
+ *
+ * @return List of namespaces, free with g_list_free
+ */
+extern GList *profile_namespace_get_all(void);
+
+/**
+ * Get the namespace a profile belongs to
+ *
+ * @param[IN]  profile Profile to look for
+ *
+ * @return Namespace, NULL if the profile doesn't belong to any
+ */
+extern profile_namespace_t *profile_namespace_find(gpointer profile);
+
+/**
+ * Iterate the visible profiles: those of the active namespace first, then
+ * those of the device namespace.
+ *
+ * @param[IN]  profile Current profile, NULL to get the first one
+ *
+ * @return Next visible profile, NULL at the end
+ */
+extern gpointer profile_namespace_next_visible(gpointer profile);
+
+/**
+ * Work out which connman .config files need to change when switching from
+ * one namespace to another. Files of the device namespace stay where they
+ * are, as they are visible before and after the switch.
+ *
+ * @param[IN]  from Namespace which is active now
+ * @param[IN]  to Namespace which becomes active
+ * @param[IN]  key_cb Callback returning the .config file key of a profile
+ * @param[OUT] stash Keys only used by from, to be moved out of the way
+ * @param[OUT] restore Keys only used by to, to be moved into place
+ * @param[OUT] both Keys used by both, whose files may differ
+ *
+ * The returned lists contain newly allocated strings, free them with
+ * g_slist_free_full(list, g_free).
+ */
+extern void profile_namespace_diff(profile_namespace_t *from,
+                                   profile_namespace_t *to, profile_namespace_key_cb key_cb,
+                                   GSList **stash, GSList **restore, GSList **both);
+
+/**
+ * Remove all namespaces and start over with an active device namespace. The
+ * profiles aren't freed.
+ */
+extern void profile_namespace_reset(void);
+
+#endif /* _PROFILE_NAMESPACE_H_ */
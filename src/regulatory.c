@@ -0,0 +1,244 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  regulatory.c
+ *
+ * @brief Inference of the regulatory domain from country elements
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "regulatory.h"
+
+#define IE_COUNTRY      7
+
+/* Radio of each BSS of the current scan and the country it voted for */
+static GHashTable *ballots = NULL;
+static gchar candidate[3];
+/* Country last returned to be applied */
+static gchar proposal[3];
+static guint fallback_scans = 0;
+static regulatory_status_t status = { REGULATORY_WORLD };
+
+static gboolean country_is_valid(const gchar *country)
+{
+	if (NULL == country || !g_ascii_isalpha(country[0]) ||
+	        !g_ascii_isalpha(country[1]) || '\0' != country[2])
+	{
+		return FALSE;
+	}
+
+	/* Some access points advertise a placeholder rather than a country */
+	return g_ascii_strcasecmp(country, "XX") && g_ascii_strcasecmp(country, "ZZ");
+}
+
+/**
+ * Read the country code of a BSS (see header for API details)
+ */
+
+gboolean regulatory_parse_country_ie(const guint8 *ies, gsize len,
+                                     gchar country[3])
+{
+	gsize pos = 0;
+
+	while (pos + 2 <= len)
+	{
+		guint8 id = ies[pos];
+		gsize elen = ies[pos + 1];
+
+		if (pos + 2 + elen > len)
+		{
+			break;
+		}
+
+		/* Two letters, then the environment: ' ', 'I', 'O' or 'X' */
+		if (IE_COUNTRY == id && elen >= 3)
+		{
+			country[0] = g_ascii_toupper(ies[pos + 2]);
+			country[1] = g_ascii_toupper(ies[pos + 3]);
+			country[2] = '\0';
+
+			return country_is_valid(country);
+		}
+
+		pos += 2 + elen;
+	}
+
+	return FALSE;
+}
+
+/**
+ * Add a BSS to the vote (see header for API details)
+ */
+
+void regulatory_add_bss(const gchar *bssid, const gchar *country)
+{
+	if (NULL == bssid || strlen(bssid) < 17 || !country_is_valid(country))
+	{
+		return;
+	}
+
+	if (NULL == ballots)
+	{
+		ballots = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+	}
+
+	/* The BSSes of a radio differ in the locally administered bit of the first
+	 * octet or in the last octet, so the four octets between tell the radio */
+	g_hash_table_replace(ballots, g_ascii_strup(bssid + 3, 11),
+	                     g_ascii_strup(country, -1));
+}
+
+static void count_ballot(gpointer key, gpointer value, gpointer user_data)
+{
+	GHashTable *tally = user_data;
+	guint votes = GPOINTER_TO_UINT(g_hash_table_lookup(tally, value));
+
+	g_hash_table_replace(tally, value, GUINT_TO_POINTER(votes + 1));
+}
+
+/**
+ * Count the vote of the current scan (see header for API details)
+ */
+
+const gchar *regulatory_end_scan(void)
+{
+	GHashTable *tally = g_hash_table_new(g_str_hash, g_str_equal);
+	GHashTableIter iter;
+	gpointer key, value;
+	const gchar *winner = NULL;
+	guint winner_votes = 0;
+	const gchar *apply = NULL;
+
+	status.votes = 0;
+	status.inferred[0] = '\0';
+	status.confidence = 0;
+
+	if (NULL != ballots)
+	{
+		g_hash_table_foreach(ballots, count_ballot, tally);
+		status.votes = g_hash_table_size(ballots);
+	}
+
+	g_hash_table_iter_init(&iter, tally);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		guint votes = GPOINTER_TO_UINT(value);
+
+		/* Ties go to the alphabetically first country, so a scan is counted the
+		 * same whatever the order of the table */
+		if (votes > winner_votes || (votes == winner_votes &&
+		                             strcmp(key, winner) < 0))
+		{
+			winner = key;
+			winner_votes = votes;
+		}
+	}
+
+	if (status.votes < REGULATORY_MIN_VOTES)
+	{
+		/* Not enough evidence either way */
+	}
+	else if (winner_votes * 100 >= REGULATORY_MIN_CONFIDENCE * status.votes)
+	{
+		g_strlcpy(status.inferred, winner, sizeof(status.inferred));
+		status.confidence = winner_votes * 100 / status.votes;
+		fallback_scans = 0;
+
+		if (!strcmp(winner, status.applied))
+		{
+			candidate[0] = '\0';
+			status.confirmations = 0;
+		}
+		else
+		{
+			if (strcmp(winner, candidate))
+			{
+				g_strlcpy(candidate, winner, sizeof(candidate));
+				status.confirmations = 0;
+			}
+
+			/* Proposed again each scan until it is applied */
+			if (++status.confirmations >= REGULATORY_CONFIRM_SCANS)
+			{
+				g_strlcpy(proposal, winner, sizeof(proposal));
+				apply = proposal;
+			}
+		}
+	}
+	else
+	{
+		status.confidence = winner_votes * 100 / status.votes;
+		candidate[0] = '\0';
+		status.confirmations = 0;
+
+		if (strcmp(status.applied, REGULATORY_WORLD) &&
+		        ++fallback_scans >= REGULATORY_FALLBACK_SCANS)
+		{
+			g_strlcpy(proposal, REGULATORY_WORLD, sizeof(proposal));
+			apply = proposal;
+		}
+	}
+
+	g_hash_table_destroy(tally);
+
+	if (NULL != ballots)
+	{
+		g_hash_table_remove_all(ballots);
+	}
+
+	return apply;
+}
+
+/**
+ * Record that a country was applied (see header for API details)
+ */
+
+void regulatory_confirm_applied(const gchar *country)
+{
+	g_strlcpy(status.applied, country, sizeof(status.applied));
+	candidate[0] = '\0';
+	status.confirmations = 0;
+	fallback_scans = 0;
+}
+
+const regulatory_status_t *regulatory_get_status(void)
+{
+	return &status;
+}
+
+/**
+ * Forget the votes (see header for API details)
+ */
+
+void regulatory_reset(void)
+{
+	if (NULL != ballots)
+	{
+		g_hash_table_destroy(ballots);
+		ballots = NULL;
+	}
+
+	memset(&status, 0, sizeof(status));
+	g_strlcpy(status.applied, REGULATORY_WORLD, sizeof(status.applied));
+	candidate[0] = '\0';
+	proposal[0] = '\0';
+	fallback_scans = 0;
+}
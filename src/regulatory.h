@@ -0,0 +1,102 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  regulatory.h
+ *
+ * @brief Header file defining the inference of the regulatory domain from the
+ *        country elements (802.11d) the access points around advertise
+ *
+ * Each scan is a vote: every radio advertising a valid country code casts
+ * one vote, however many BSSes it runs, so a single rogue access point with
+ * many virtual BSSes can't outvote the others. A country is proposed once it
+ * gets enough votes with enough confidence, and is to be applied once it won
+ * REGULATORY_CONFIRM_SCANS scans in a row. If the scans keep disagreeing
+ * without a clear winner the world domain is to be applied again, as the safe
+ * fallback. Scans with too few votes change nothing. The caller may not be
+ * able to apply the country, so it is only taken as applied once the caller
+ * confirms it, and proposed again after each scan until then.
+ *
+ */
+
+#ifndef _REGULATORY_H_
+#define _REGULATORY_H_
+
+#include <glib.h>
+
+#define REGULATORY_WORLD                "00"
+
+/* Votes a scan needs to count */
+#define REGULATORY_MIN_VOTES            3
+/* Share of the votes in percent the winner of a scan needs */
+#define REGULATORY_MIN_CONFIDENCE       75
+/* Scans in a row a country must win before it is applied */
+#define REGULATORY_CONFIRM_SCANS        3
+/* Scans in a row without a clear winner before falling back to the world domain */
+#define REGULATORY_FALLBACK_SCANS       5
+
+typedef struct regulatory_status
+{
+	gchar applied[3];           /* Confirmed as applied, REGULATORY_WORLD if none */
+	gchar inferred[3];          /* Winner of the last scan, empty if none */
+	guint confidence;           /* Share of the votes of the winner in percent */
+	guint votes;                /* Radios which voted in the last scan */
+	guint confirmations;        /* Scans in a row the proposed country won */
+} regulatory_status_t;
+
+/**
+ * Read the country code from the information elements of a BSS
+ *
+ * @param[IN]  ies Information elements
+ * @param[IN]  len Length of ies
+ * @param[OUT] country Upper case country code
+ *
+ * @return TRUE if there is a country element with a valid code
+ */
+extern gboolean regulatory_parse_country_ie(const guint8 *ies, gsize len,
+        gchar country[3]);
+
+/**
+ * Add a BSS to the vote of the current scan
+ *
+ * @param[IN]  bssid BSSID of the BSS, "XX:XX:XX:XX:XX:XX"
+ * @param[IN]  country Country code the BSS advertises
+ */
+extern void regulatory_add_bss(const gchar *bssid, const gchar *country);
+
+/**
+ * Count the vote of the current scan and start a new one
+ *
+ * @return Country code to apply, NULL to keep the current one. Call
+ *         regulatory_confirm_applied once it was applied.
+ */
+extern const gchar *regulatory_end_scan(void);
+
+/**
+ * Record that a country returned by regulatory_end_scan was applied
+ *
+ * @param[IN]  country Country code which was applied
+ */
+extern void regulatory_confirm_applied(const gchar *country);
+
+extern const regulatory_status_t *regulatory_get_status(void);
+
+/**
+ * Forget the votes and go back to the world domain
+ */
+extern void regulatory_reset(void);
+
+#endif /* _REGULATORY_H_ */
@@ -0,0 +1,72 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  regulatory_nl80211.c
+ *
+ * @brief Reads the country elements from the scan dumps of cfg80211
+ *
+ */
+
+#include <glib.h>
+#include <linux/nl80211.h>
+
+#include "regulatory.h"
+#include "regulatory_nl80211.h"
+#include "nl80211_utils.h"
+
+/**
+ * Add a BSS of a scan dump to the vote (see header for API details)
+ */
+
+void regulatory_nl80211_add_bss(const guint8 *attrs, gsize len)
+{
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+	gchar bssid[18] = "";
+	gchar country[3];
+	gboolean has_country = FALSE;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		const guint8 *value = genl_attr_data(attr);
+
+		switch (genl_attr_type(attr))
+		{
+			case NL80211_BSS_BSSID:
+				if (genl_attr_len(attr) >= 6)
+				{
+					g_snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
+					           value[0], value[1], value[2], value[3], value[4], value[5]);
+				}
+
+				break;
+
+			case NL80211_BSS_INFORMATION_ELEMENTS:
+				has_country = regulatory_parse_country_ie(value, genl_attr_len(attr),
+				              country);
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (has_country)
+	{
+		regulatory_add_bss(bssid, country);
+	}
+}
@@ -0,0 +1,39 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  regulatory_nl80211.h
+ *
+ * @brief Header file defining how the country elements around are read from
+ *        the scan dumps of cfg80211
+ *
+ */
+
+#ifndef _REGULATORY_NL80211_H_
+#define _REGULATORY_NL80211_H_
+
+#include <glib.h>
+
+/**
+ * Add a BSS of a scan dump to the vote of the regulatory module if it
+ * advertises a country
+ *
+ * @param[IN]  attrs NL80211_BSS_* attributes of the BSS, see nl80211_dump_scan
+ * @param[IN]  len Length of the attributes
+ */
+extern void regulatory_nl80211_add_bss(const guint8 *attrs, gsize len);
+
+#endif /* _REGULATORY_NL80211_H_ */
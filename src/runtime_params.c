@@ -0,0 +1,523 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  runtime_params.c
+ *
+ * @brief Registry of runtime tunable parameters
+ *
+ * Timers and thresholds read their value from here each time they are
+ * armed, so a change takes effect the next time the timer is started.
+ */
+
+#include <glib.h>
+#include <glib-unix.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+
+#include "runtime_params.h"
+#include "gateway_probe.h"
+#include "dns_probe.h"
+#include "power_save.h"
+#include "log_limiter.h"
+#include "wan_failover.h"
+#include "pan_reconnect.h"
+
+typedef struct runtime_param_info
+{
+	const gchar *name;
+	const gchar *unit;
+	guint default_value;
+	guint min;
+	guint max;
+} runtime_param_info_t;
+
+static const runtime_param_info_t param_info[RUNTIME_PARAM_LAST] =
+{
+	[RUNTIME_PARAM_SCAN_MIN_INTERVAL] = { "scanMinInterval", "ms", 1000, 100, 60000 },
+	[RUNTIME_PARAM_SIGNAL_POLL_INTERVAL] = { "signalPollInterval", "s", 3, 1, 60 },
+	[RUNTIME_PARAM_CONNECT_FAILURE_DELAY] = { "connectFailureDelay", "s", 2, 0, 30 },
+	[RUNTIME_PARAM_PROFILE_DELETE_DELAY] = { "profileDeleteDelay", "s", 5, 0, 60 },
+	[RUNTIME_PARAM_INTERNET_STATUS_TIMEOUT] = { "internetStatusTimeout", "s", 1, 1, 30 },
+	[RUNTIME_PARAM_GATEWAY_PROBE_TIMEOUT] = { "gatewayProbeTimeout", "ms", GATEWAY_PROBE_TIMEOUT_MS, 10, 5000 },
+	[RUNTIME_PARAM_CONNMAN_PROBE_INTERVAL] = { "connmanProbeInterval", "ms", 10000, 50, 600000 },
+	[RUNTIME_PARAM_CONNMAN_PROBE_DEADLINE] = { "connmanProbeDeadline", "ms", 2000, 10, 25000 },
+	[RUNTIME_PARAM_CERT_EXPIRY_WARNING] = { "certExpiryWarning", "d", 30, 0, 365 },
+	[RUNTIME_PARAM_DNS_PROBE_INTERVAL] = { "dnsProbeInterval", "s", DNS_PROBE_INTERVAL, 10, 3600 },
+	[RUNTIME_PARAM_DNS_PROBE_TIMEOUT] = { "dnsProbeTimeout", "ms", DNS_PROBE_TIMEOUT_MS, 50, 5000 },
+	[RUNTIME_PARAM_POWER_SAVE_BUSY_BYTE_RATE] = { "powerSaveBusyByteRate", "kB/s", POWER_SAVE_BUSY_BYTE_RATE, 1, 100000 },
+	[RUNTIME_PARAM_POWER_SAVE_BUSY_PACKET_RATE] = { "powerSaveBusyPacketRate", "packets/s", POWER_SAVE_BUSY_PACKET_RATE, 1, 100000 },
+	[RUNTIME_PARAM_POWER_SAVE_IDLE_HOLD] = { "powerSaveIdleHold", "s", POWER_SAVE_IDLE_HOLD, 1, 600 },
+	[RUNTIME_PARAM_LOG_RATE_LIMIT] = { "logRateLimit", "messages/s", LOG_LIMITER_RATE, 0, 1000 },
+	[RUNTIME_PARAM_LOG_RATE_BURST] = { "logRateBurst", "messages", LOG_LIMITER_BURST, 1, 1000 },
+	[RUNTIME_PARAM_LOG_SUMMARY_INTERVAL] = { "logSummaryInterval", "s", LOG_LIMITER_SUMMARY_INTERVAL, 5, 3600 },
+	[RUNTIME_PARAM_WAN_FAILOVER_BACKOFF] = { "wanFailoverBackoff", "s", WAN_FAILOVER_BACKOFF, 1, 3600 },
+	[RUNTIME_PARAM_WAN_FAILOVER_MAX_BACKOFF] = { "wanFailoverMaxBackoff", "s", WAN_FAILOVER_MAX_BACKOFF, 1, 86400 },
+	[RUNTIME_PARAM_PAN_RECONNECT_DELAY] = { "panReconnectDelay", "s", PAN_RECONNECT_DELAY, 1, 600 },
+	[RUNTIME_PARAM_PAN_RECONNECT_MAX_DELAY] = { "panReconnectMaxDelay", "s", PAN_RECONNECT_MAX_DELAY, 1, 3600 },
+	[RUNTIME_PARAM_PAN_RECONNECT_MAX_ATTEMPTS] = { "panReconnectMaxAttempts", "attempts", PAN_RECONNECT_MAX_ATTEMPTS, 0, 1000 },
+};
+
+static guint param_values[RUNTIME_PARAM_LAST];
+static gboolean param_values_initialized = FALSE;
+
+static GQueue change_log = G_QUEUE_INIT;
+
+static runtime_param_changed_cb changed_cb = NULL;
+static gpointer changed_cb_data = NULL;
+
+static gchar *watch_pathname = NULL;
+static gchar *watch_basename = NULL;
+static runtime_params_reloaded_cb reloaded_cb = NULL;
+static gpointer reloaded_cb_data = NULL;
+static GIOChannel *inotify_channel = NULL;
+static guint inotify_watch = 0;
+static guint sighup_watch = 0;
+
+GQuark runtime_params_error_quark(void)
+{
+	return g_quark_from_static_string("runtime-params-error-quark");
+}
+
+static void init_values(void)
+{
+	runtime_param_t param;
+
+	if (param_values_initialized)
+	{
+		return;
+	}
+
+	for (param = 0; param < RUNTIME_PARAM_LAST; param++)
+	{
+		param_values[param] = param_info[param].default_value;
+	}
+
+	param_values_initialized = TRUE;
+}
+
+static void change_free(gpointer data)
+{
+	runtime_param_change_t *change = data;
+
+	g_free(change->source);
+	g_free(change);
+}
+
+/**
+ * Get the current value of a parameter (see header for API details)
+ */
+
+guint runtime_param_get(runtime_param_t param)
+{
+	g_return_val_if_fail(param < RUNTIME_PARAM_LAST, 0);
+
+	init_values();
+	return param_values[param];
+}
+
+/**
+ * Get the name of a parameter (see header for API details)
+ */
+
+const gchar *runtime_param_get_name(runtime_param_t param)
+{
+	g_return_val_if_fail(param < RUNTIME_PARAM_LAST, NULL);
+
+	return param_info[param].name;
+}
+
+/**
+ * Get the unit of a parameter (see header for API details)
+ */
+
+const gchar *runtime_param_get_unit(runtime_param_t param)
+{
+	g_return_val_if_fail(param < RUNTIME_PARAM_LAST, NULL);
+
+	return param_info[param].unit;
+}
+
+/**
+ * Get the default value and valid range of a parameter (see header for API details)
+ */
+
+void runtime_param_get_limits(runtime_param_t param, guint *default_value,
+                              guint *min, guint *max)
+{
+	g_return_if_fail(param < RUNTIME_PARAM_LAST);
+
+	if (NULL != default_value)
+	{
+		*default_value = param_info[param].default_value;
+	}
+
+	if (NULL != min)
+	{
+		*min = param_info[param].min;
+	}
+
+	if (NULL != max)
+	{
+		*max = param_info[param].max;
+	}
+}
+
+/**
+ * Find a parameter by its name (see header for API details)
+ */
+
+gboolean runtime_param_lookup(const gchar *name, runtime_param_t *param)
+{
+	runtime_param_t n;
+
+	for (n = 0; n < RUNTIME_PARAM_LAST; n++)
+	{
+		if (!g_strcmp0(name, param_info[n].name))
+		{
+			*param = n;
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * Check if a value is valid for a parameter (see header for API details)
+ */
+
+gboolean runtime_param_is_valid(runtime_param_t param, gint64 value)
+{
+	if (param >= RUNTIME_PARAM_LAST)
+	{
+		return FALSE;
+	}
+
+	return value >= param_info[param].min && value <= param_info[param].max;
+}
+
+/**
+ * Change the value of a parameter (see header for API details)
+ */
+
+gboolean runtime_param_set(runtime_param_t param, gint64 value,
+                           const gchar *source)
+{
+	runtime_param_change_t *change;
+
+	if (!runtime_param_is_valid(param, value))
+	{
+		return FALSE;
+	}
+
+	init_values();
+
+	if (param_values[param] == value)
+	{
+		return TRUE;
+	}
+
+	change = g_new0(runtime_param_change_t, 1);
+	change->time = g_get_real_time() / G_USEC_PER_SEC;
+	change->param = param;
+	change->old_value = param_values[param];
+	change->new_value = value;
+	change->source = g_strdup(source);
+
+	param_values[param] = value;
+
+	g_queue_push_tail(&change_log, change);
+
+	if (g_queue_get_length(&change_log) > RUNTIME_PARAMS_CHANGE_LOG_LEN)
+	{
+		change_free(g_queue_pop_head(&change_log));
+	}
+
+	if (NULL != changed_cb)
+	{
+		changed_cb(change, changed_cb_data);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Apply the parameters of a config file (see header for API details)
+ */
+
+gboolean runtime_params_load_data(const gchar *data, gsize length,
+                                  const gchar *source, GError **error)
+{
+	GKeyFile *keyfile = g_key_file_new();
+	GError *first_error = NULL;
+	gchar **keys = NULL;
+	gsize n, num_keys = 0;
+
+	if (!g_key_file_load_from_data(keyfile, data, length, G_KEY_FILE_NONE,
+	                               &first_error))
+	{
+		goto exit;
+	}
+
+	keys = g_key_file_get_keys(keyfile, RUNTIME_PARAMS_GROUP, &num_keys, NULL);
+
+	for (n = 0; n < num_keys; n++)
+	{
+		runtime_param_t param;
+		GError *key_error = NULL;
+		gint64 value;
+
+		if (!runtime_param_lookup(keys[n], &param))
+		{
+			if (NULL == first_error)
+			{
+				g_set_error(&first_error, RUNTIME_PARAMS_ERROR,
+				            RUNTIME_PARAMS_ERROR_UNKNOWN_PARAM,
+				            "Unknown parameter %s", keys[n]);
+			}
+
+			continue;
+		}
+
+		value = g_key_file_get_int64(keyfile, RUNTIME_PARAMS_GROUP, keys[n],
+		                             &key_error);
+
+		if (NULL != key_error || !runtime_param_set(param, value, source))
+		{
+			if (NULL == first_error)
+			{
+				g_set_error(&first_error, RUNTIME_PARAMS_ERROR,
+				            RUNTIME_PARAMS_ERROR_INVALID_VALUE,
+				            "Invalid value for %s, must be within %u..%u",
+				            keys[n], param_info[param].min, param_info[param].max);
+			}
+
+			g_clear_error(&key_error);
+		}
+	}
+
+exit:
+	g_strfreev(keys);
+	g_key_file_free(keyfile);
+
+	if (NULL != first_error)
+	{
+		g_propagate_error(error, first_error);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Apply the parameters of a config file (see header for API details)
+ */
+
+gboolean runtime_params_load_file(const gchar *pathname, GError **error)
+{
+	gchar *data = NULL;
+	gsize length = 0;
+	gboolean ret;
+
+	if (!g_file_get_contents(pathname, &data, &length, error))
+	{
+		return FALSE;
+	}
+
+	ret = runtime_params_load_data(data, length, pathname, error);
+	g_free(data);
+
+	return ret;
+}
+
+static void reload(void)
+{
+	GError *error = NULL;
+
+	runtime_params_load_file(watch_pathname, &error);
+
+	if (NULL != reloaded_cb)
+	{
+		reloaded_cb(watch_pathname, error, reloaded_cb_data);
+	}
+
+	g_clear_error(&error);
+}
+
+static gboolean sighup_received(gpointer user_data)
+{
+	reload();
+	return TRUE;
+}
+
+/**
+ * @brief Reload the config file once it has been written or moved into place
+ */
+
+static gboolean inotify_data(GIOChannel *channel, GIOCondition cond,
+                             gpointer user_data)
+{
+	gchar buffer[sizeof(struct inotify_event) + NAME_MAX + 1]
+	__attribute__((aligned(__alignof__(struct inotify_event))));
+	gboolean changed = FALSE;
+	ssize_t len, offset;
+
+	if (cond & (G_IO_NVAL | G_IO_ERR | G_IO_HUP))
+	{
+		inotify_watch = 0;
+		return FALSE;
+	}
+
+	len = read(g_io_channel_unix_get_fd(channel), buffer, sizeof(buffer));
+
+	for (offset = 0; offset + (ssize_t) sizeof(struct inotify_event) <= len;)
+	{
+		struct inotify_event *event = (struct inotify_event *)(buffer + offset);
+
+		if (event->len && !g_strcmp0(event->name, watch_basename))
+		{
+			changed = TRUE;
+		}
+
+		offset += sizeof(struct inotify_event) + event->len;
+	}
+
+	if (changed)
+	{
+		reload();
+	}
+
+	return TRUE;
+}
+
+/**
+ * Reload the config file whenever it changes (see header for API details)
+ */
+
+gboolean runtime_params_watch(const gchar *pathname,
+                              runtime_params_reloaded_cb cb, gpointer user_data)
+{
+	gchar *dirname;
+	int fd;
+
+	runtime_params_unwatch();
+
+	watch_pathname = g_strdup(pathname);
+	watch_basename = g_path_get_basename(pathname);
+	reloaded_cb = cb;
+	reloaded_cb_data = user_data;
+
+	sighup_watch = g_unix_signal_add(SIGHUP, sighup_received, NULL);
+
+	fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+	if (fd < 0)
+	{
+		return FALSE;
+	}
+
+	/* Editors and package managers replace the file, so watch its directory */
+	dirname = g_path_get_dirname(pathname);
+
+	if (inotify_add_watch(fd, dirname, IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+	{
+		g_free(dirname);
+		close(fd);
+		return FALSE;
+	}
+
+	g_free(dirname);
+
+	inotify_channel = g_io_channel_unix_new(fd);
+	g_io_channel_set_close_on_unref(inotify_channel, TRUE);
+
+	inotify_watch = g_io_add_watch(inotify_channel,
+	                               G_IO_IN | G_IO_HUP | G_IO_NVAL | G_IO_ERR,
+	                               inotify_data, NULL);
+
+	return TRUE;
+}
+
+/**
+ * Stop watching the config file (see header for API details)
+ */
+
+void runtime_params_unwatch(void)
+{
+	if (sighup_watch > 0)
+	{
+		g_source_remove(sighup_watch);
+		sighup_watch = 0;
+	}
+
+	if (inotify_watch > 0)
+	{
+		g_source_remove(inotify_watch);
+		inotify_watch = 0;
+	}
+
+	if (NULL != inotify_channel)
+	{
+		g_io_channel_unref(inotify_channel);
+		inotify_channel = NULL;
+	}
+
+	g_free(watch_pathname);
+	watch_pathname = NULL;
+	g_free(watch_basename);
+	watch_basename = NULL;
+	reloaded_cb = NULL;
+	reloaded_cb_data = NULL;
+}
+
+/**
+ * Set the callback for parameter changes (see header for API details)
+ */
+
+void runtime_params_set_changed_callback(runtime_param_changed_cb cb,
+        gpointer user_data)
+{
+	changed_cb = cb;
+	changed_cb_data = user_data;
+}
+
+/**
+ * Get the change log (see header for API details)
+ */
+
+GList *runtime_params_get_change_log(void)
+{
+	return change_log.head;
+}
+
+/**
+ * Restore the default values (see header for API details)
+ */
+
+void runtime_params_reset(void)
+{
+	param_values_initialized = FALSE;
+	init_values();
+
+	while (!g_queue_is_empty(&change_log))
+	{
+		change_free(g_queue_pop_head(&change_log));
+	}
+}
@@ -0,0 +1,240 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  runtime_params.h
+ *
+ * @brief Header file defining the registry of runtime tunable parameters
+ *        (timers and thresholds), which are loaded from a config file and
+ *        can be changed while running
+ *
+ */
+
+#ifndef _RUNTIME_PARAMS_H_
+#define _RUNTIME_PARAMS_H_
+
+#include <glib.h>
+
+/**
+ * Group of the config file holding the parameters
+ */
+#define RUNTIME_PARAMS_GROUP            "Parameters"
+
+/**
+ * Number of changes kept in the change log
+ */
+#define RUNTIME_PARAMS_CHANGE_LOG_LEN   32
+
+#define RUNTIME_PARAMS_ERROR            runtime_params_error_quark()
+
+typedef enum
+{
+	RUNTIME_PARAMS_ERROR_UNKNOWN_PARAM,
+	RUNTIME_PARAMS_ERROR_INVALID_VALUE,
+} runtime_params_error_t;
+
+typedef enum
+{
+	RUNTIME_PARAM_SCAN_MIN_INTERVAL = 0,
+	RUNTIME_PARAM_SIGNAL_POLL_INTERVAL,
+	RUNTIME_PARAM_CONNECT_FAILURE_DELAY,
+	RUNTIME_PARAM_PROFILE_DELETE_DELAY,
+	RUNTIME_PARAM_INTERNET_STATUS_TIMEOUT,
+	RUNTIME_PARAM_GATEWAY_PROBE_TIMEOUT,
+	RUNTIME_PARAM_CONNMAN_PROBE_INTERVAL,
+	RUNTIME_PARAM_CONNMAN_PROBE_DEADLINE,
+	RUNTIME_PARAM_CERT_EXPIRY_WARNING,
+	RUNTIME_PARAM_DNS_PROBE_INTERVAL,
+	RUNTIME_PARAM_DNS_PROBE_TIMEOUT,
+	RUNTIME_PARAM_POWER_SAVE_BUSY_BYTE_RATE,
+	RUNTIME_PARAM_POWER_SAVE_BUSY_PACKET_RATE,
+	RUNTIME_PARAM_POWER_SAVE_IDLE_HOLD,
+	RUNTIME_PARAM_LOG_RATE_LIMIT,
+	RUNTIME_PARAM_LOG_RATE_BURST,
+	RUNTIME_PARAM_LOG_SUMMARY_INTERVAL,
+	RUNTIME_PARAM_WAN_FAILOVER_BACKOFF,
+	RUNTIME_PARAM_WAN_FAILOVER_MAX_BACKOFF,
+	RUNTIME_PARAM_PAN_RECONNECT_DELAY,
+	RUNTIME_PARAM_PAN_RECONNECT_MAX_DELAY,
+	RUNTIME_PARAM_PAN_RECONNECT_MAX_ATTEMPTS,
+	RUNTIME_PARAM_LAST,
+} runtime_param_t;
+
+/**
+ * Entry of the change log
+ */
+typedef struct runtime_param_change
+{
+	gint64 time; /* Wall clock time in seconds */
+	runtime_param_t param;
+	guint old_value;
+	guint new_value;
+	gchar *source; /* Who changed the value, e.g. the config file or a luna caller */
+} runtime_param_change_t;
+
+/**
+ * Callback called whenever the value of a parameter changes
+ */
+typedef void (*runtime_param_changed_cb)(const runtime_param_change_t *change,
+        gpointer user_data);
+
+/**
+ * Callback called after the config file was reloaded. error is set if the
+ * file couldn't be read or had invalid entries.
+ */
+typedef void (*runtime_params_reloaded_cb)(const gchar *pathname,
+        const GError *error, gpointer user_data);
+
+extern GQuark runtime_params_error_quark(void);
+
+/**
+ * Get the current value of a parameter
+ *
+ * @param[IN]  param Parameter
+ *
+ * @return Current value
+ */
+extern guint runtime_param_get(runtime_param_t param);
+
+/**
+ * Get the name of a parameter as used in the config file and luna API
+ *
+ * @param[IN]  param Parameter
+ *
+ * @return Name of the parameter
+ */
+extern const gchar *runtime_param_get_name(runtime_param_t param);
+
+/**
+ * Get the unit of a parameter
+ *
+ * @param[IN]  param Parameter
+ *
+ * @return Unit, e.g. "ms", "s", "d" or "packets/s"
+ */
+extern const gchar *runtime_param_get_unit(runtime_param_t param);
+
+/**
+ * Get the default value and valid range of a parameter
+ *
+ * @param[IN]  param Parameter
+ * @param[OUT] default_value Value used if nothing else was configured. May be NULL.
+ * @param[OUT] min Lowest valid value. May be NULL.
+ * @param[OUT] max Highest valid value. May be NULL.
+ */
+extern void runtime_param_get_limits(runtime_param_t param,
+                                     guint *default_value, guint *min, guint *max);
+
+/**
+ * Find a parameter by its name
+ *
+ * @param[IN]  name Name of the parameter
+ * @param[OUT] param Found parameter
+ *
+ * @return TRUE if the parameter exists, FALSE otherwise
+ */
+extern gboolean runtime_param_lookup(const gchar *name,
+                                     runtime_param_t *param);
+
+/**
+ * Check if a value is within the valid range of a parameter
+ *
+ * @param[IN]  param Parameter
+ * @param[IN]  value Value to check
+ *
+ * @return TRUE if valid, FALSE otherwise
+ */
+extern gboolean runtime_param_is_valid(runtime_param_t param, gint64 value);
+
+/**
+ * Change the value of a parameter. Changes are added to the change log and
+ * reported to the changed callback.
+ *
+ * @param[IN]  param Parameter
+ * @param[IN]  value New value
+ * @param[IN]  source Who changes the value
+ *
+ * @return FALSE if the value is out of range, TRUE otherwise
+ */
+extern gboolean runtime_param_set(runtime_param_t param, gint64 value,
+                                  const gchar *source);
+
+/**
+ * Apply the parameters of a config file in key file format. Parameters the
+ * file doesn't mention keep their value. Valid entries are applied even if
+ * other entries are invalid.
+ *
+ * @param[IN]  data Content of the config file
+ * @param[IN]  length Length of data
+ * @param[IN]  source Who changes the values
+ * @param[OUT] error Set if the data couldn't be parsed or had invalid entries
+ *
+ * @return FALSE if error was set, TRUE otherwise
+ */
+extern gboolean runtime_params_load_data(const gchar *data, gsize length,
+        const gchar *source, GError **error);
+
+/**
+ * Apply the parameters of a config file (see runtime_params_load_data)
+ *
+ * @param[IN]  pathname Path of the config file
+ * @param[OUT] error Set if the file couldn't be read or had invalid entries
+ *
+ * @return FALSE if error was set, TRUE otherwise
+ */
+extern gboolean runtime_params_load_file(const gchar *pathname,
+        GError **error);
+
+/**
+ * Reload the config file whenever it is written or SIGHUP is received
+ *
+ * @param[IN]  pathname Path of the config file. Its directory is watched, so
+ *                      the file doesn't need to exist yet.
+ * @param[IN]  cb Callback called after each reload. May be NULL.
+ * @param[IN]  user_data User data passed to cb
+ *
+ * @return FALSE if the file can't be watched (SIGHUP still works), TRUE otherwise
+ */
+extern gboolean runtime_params_watch(const gchar *pathname,
+                                     runtime_params_reloaded_cb cb, gpointer user_data);
+
+/**
+ * Stop watching the config file
+ */
+extern void runtime_params_unwatch(void);
+
+/**
+ * Set the callback called whenever the value of a parameter changes
+ *
+ * @param[IN]  cb Callback, NULL to unset it
+ * @param[IN]  user_data User data passed to cb
+ */
+extern void runtime_params_set_changed_callback(runtime_param_changed_cb cb,
+        gpointer user_data);
+
+/**
+ * Get the last RUNTIME_PARAMS_CHANGE_LOG_LEN changes
+ *
+ * @return List of runtime_param_change_t owned by the module, oldest first
+ */
+extern GList *runtime_params_get_change_log(void);
+
+/**
+ * Restore the default values of all parameters and clear the change log
+ */
+extern void runtime_params_reset(void);
+
+#endif /* _RUNTIME_PARAMS_H_ */
@@ -0,0 +1,598 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  self_test.c
+ *
+ * @brief Link self test measuring throughput and round trip time
+ *
+ */
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <arpa/inet.h>
+#include <linux/sockios.h>
+
+#include "self_test.h"
+
+#define BUF_SIZE                65536
+/* Longest a blocking wait goes without checking for a cancel (ms) */
+#define CANCEL_SLICE_MS         100
+#define LATENCY_MAGIC           0x53545354  /* "STST" */
+
+struct self_test
+{
+	self_test_params_t params;
+	self_test_cb cb;
+	gpointer user_data;
+	GMainContext *context;
+	gint cancelled;
+	self_test_result_t result;
+};
+
+/* Throughput sampling state, bytes are counted cumulatively */
+typedef struct sampler
+{
+	GArray *samples;
+	gint64 start;
+	gint64 window_start;
+	guint64 window_start_bytes;
+} sampler_t;
+
+static gboolean is_cancelled(self_test_t *test)
+{
+	return g_atomic_int_get(&test->cancelled);
+}
+
+static void set_error(self_test_t *test, const gchar *format, ...)
+{
+	va_list args;
+
+	if (NULL != test->result.error)
+	{
+		return;
+	}
+
+	va_start(args, format);
+	test->result.error = g_strdup_vprintf(format, args);
+	va_end(args);
+}
+
+static gint64 ms_until(gint64 deadline)
+{
+	gint64 left = deadline - g_get_monotonic_time();
+
+	return left > 0 ? (left + 999) / 1000 : 0;
+}
+
+/**
+ * Wait until fd is ready or the deadline (monotonic time) passed, in slices
+ * short enough to notice a cancel. With a negative fd it just sleeps.
+ *
+ * @return 1 if ready, 0 if the deadline passed, -1 if cancelled or failed
+ */
+
+static gint wait_fd(self_test_t *test, int fd, short events, gint64 deadline)
+{
+	struct pollfd pfd;
+	gint64 left;
+	int ret;
+
+	while (!is_cancelled(test))
+	{
+		left = ms_until(deadline);
+
+		if (0 == left)
+		{
+			return 0;
+		}
+
+		pfd.fd = fd;
+		pfd.events = events;
+		pfd.revents = 0;
+		ret = poll(&pfd, 1, MIN(left, CANCEL_SLICE_MS));
+
+		if (ret > 0)
+		{
+			return 1;
+		}
+
+		if (ret < 0 && EINTR != errno)
+		{
+			return -1;
+		}
+	}
+
+	return -1;
+}
+
+static int connect_endpoint(self_test_t *test, int type, guint16 port)
+{
+	struct addrinfo hints, *res = NULL, *ai;
+	gchar service[6];
+	int fd = -1, err = 0, ret;
+	socklen_t err_len;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = type;
+	hints.ai_flags = AI_NUMERICSERV;
+	g_snprintf(service, sizeof(service), "%u", port);
+
+	ret = getaddrinfo(test->params.host, service, &hints, &res);
+
+	if (0 != ret)
+	{
+		set_error(test, "Can't resolve %s: %s", test->params.host, gai_strerror(ret));
+		return -1;
+	}
+
+	for (ai = res; NULL != ai && fd < 0 && !is_cancelled(test); ai = ai->ai_next)
+	{
+		fd = socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+		            ai->ai_protocol);
+
+		if (fd < 0)
+		{
+			err = errno;
+			continue;
+		}
+
+		if ((NULL != test->params.iface &&
+		        setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, test->params.iface,
+		                   strlen(test->params.iface) + 1) < 0) ||
+		        (connect(fd, ai->ai_addr, ai->ai_addrlen) < 0 && EINPROGRESS != errno))
+		{
+			err = errno;
+			close(fd);
+			fd = -1;
+			continue;
+		}
+
+		if (SOCK_STREAM != type)
+		{
+			break;
+		}
+
+		err_len = sizeof(err);
+		ret = wait_fd(test, fd, POLLOUT,
+		              g_get_monotonic_time() + SELF_TEST_CONNECT_TIMEOUT_MS * 1000);
+
+		if (ret <= 0 || getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) < 0 ||
+		        0 != err)
+		{
+			err = 0 == ret ? ETIMEDOUT : err;
+			close(fd);
+			fd = -1;
+		}
+	}
+
+	freeaddrinfo(res);
+
+	if (fd < 0 && !is_cancelled(test))
+	{
+		set_error(test, "Can't connect to %s port %u: %s", test->params.host, port,
+		          strerror(err));
+	}
+
+	return fd;
+}
+
+static void sampler_init(sampler_t *sampler)
+{
+	sampler->samples = g_array_new(FALSE, FALSE, sizeof(gdouble));
+	sampler->start = g_get_monotonic_time();
+	sampler->window_start = sampler->start;
+	sampler->window_start_bytes = 0;
+}
+
+static gint64 sampler_window_end(const sampler_t *sampler)
+{
+	return sampler->window_start + SELF_TEST_SAMPLE_MS * 1000;
+}
+
+/**
+ * Close the current window once it is over, including windows nothing was
+ * moved in
+ */
+
+static void sampler_update(sampler_t *sampler, guint64 bytes)
+{
+	gint64 now = g_get_monotonic_time();
+	gint64 elapsed = now - sampler->window_start;
+	gdouble kbps;
+
+	if (elapsed < SELF_TEST_SAMPLE_MS * 1000)
+	{
+		return;
+	}
+
+	kbps = (bytes - sampler->window_start_bytes) * 8.0 * 1000 / elapsed;
+	g_array_append_val(sampler->samples, kbps);
+	sampler->window_start = now;
+	sampler->window_start_bytes = bytes;
+}
+
+static void sampler_finish(sampler_t *sampler, guint64 bytes,
+                           self_test_throughput_t *throughput)
+{
+	gint64 duration = g_get_monotonic_time() - sampler->start;
+	gdouble *samples;
+	guint n;
+
+	throughput->done = TRUE;
+	throughput->bytes = bytes;
+	throughput->duration_ms = duration / 1000;
+	throughput->average_kbps = duration > 0 ? bytes * 8.0 * 1000 / duration : 0;
+
+	/* Too short for a single window */
+	if (0 == sampler->samples->len)
+	{
+		g_array_append_val(sampler->samples, throughput->average_kbps);
+	}
+
+	samples = (gdouble *) sampler->samples->data;
+	n = sampler->samples->len;
+	throughput->samples = n;
+	throughput->p10_kbps = self_test_percentile(samples, n, 10);
+	throughput->median_kbps = self_test_percentile(samples, n, 50);
+	throughput->p90_kbps = self_test_percentile(samples, n, 90);
+
+	g_array_free(sampler->samples, TRUE);
+	sampler->samples = NULL;
+}
+
+/**
+ * Bytes the endpoint acknowledged, the ones still queued for sending don't
+ * count
+ */
+
+static guint64 get_acked_bytes(int fd, guint64 sent)
+{
+	int unsent = 0;
+
+	if (ioctl(fd, SIOCOUTQ, &unsent) < 0 || unsent < 0)
+	{
+		return sent;
+	}
+
+	return sent - MIN((guint64) unsent, sent);
+}
+
+static void run_throughput(self_test_t *test, guint8 *buf, gboolean upload)
+{
+	self_test_throughput_t *throughput = upload ? &test->result.upload :
+	                                     &test->result.download;
+	guint16 port = upload ? test->params.upload_port : test->params.download_port;
+	guint64 moved = 0, counted = 0;
+	gint64 deadline;
+	sampler_t sampler;
+	ssize_t len;
+	gint ready;
+	int fd;
+
+	fd = connect_endpoint(test, SOCK_STREAM, port);
+
+	if (fd < 0)
+	{
+		return;
+	}
+
+	sampler_init(&sampler);
+	deadline = sampler.start + test->params.duration_ms * 1000;
+
+	while (moved < test->params.max_bytes && g_get_monotonic_time() < deadline)
+	{
+		ready = wait_fd(test, fd, upload ? POLLOUT : POLLIN,
+		                MIN(deadline, sampler_window_end(&sampler)));
+
+		if (ready < 0)
+		{
+			break;
+		}
+
+		if (ready > 0)
+		{
+			gsize size = MIN(BUF_SIZE, test->params.max_bytes - moved);
+
+			len = upload ? send(fd, buf, size, MSG_NOSIGNAL) : recv(fd, buf, size, 0);
+
+			if (0 == len)
+			{
+				/* chargen doesn't end by itself, the endpoint went away */
+				set_error(test, "Connection closed by %s", test->params.host);
+				break;
+			}
+
+			if (len < 0 && EAGAIN != errno && EINTR != errno)
+			{
+				set_error(test, "%s failed: %s", upload ? "Upload" : "Download",
+				          strerror(errno));
+				break;
+			}
+
+			moved += MAX(len, 0);
+		}
+
+		counted = upload ? get_acked_bytes(fd, moved) : moved;
+		sampler_update(&sampler, counted);
+	}
+
+	if (!is_cancelled(test))
+	{
+		counted = upload ? get_acked_bytes(fd, moved) : moved;
+		sampler_finish(&sampler, counted, throughput);
+	}
+	else
+	{
+		g_array_free(sampler.samples, TRUE);
+	}
+
+	close(fd);
+}
+
+static void run_latency(self_test_t *test)
+{
+	self_test_latency_t *latency = &test->result.latency;
+	gdouble *rtts;
+	guint32 probe[2], answer[2];
+	gint64 sent_at, deadline;
+	guint i, received = 0;
+	ssize_t len;
+	int fd;
+
+	fd = connect_endpoint(test, SOCK_DGRAM, test->params.latency_port);
+
+	if (fd < 0)
+	{
+		return;
+	}
+
+	rtts = g_new0(gdouble, test->params.latency_probes);
+
+	for (i = 0; i < test->params.latency_probes && !is_cancelled(test); i++)
+	{
+		probe[0] = htonl(LATENCY_MAGIC);
+		probe[1] = htonl(i);
+		sent_at = g_get_monotonic_time();
+
+		if (send(fd, probe, sizeof(probe), 0) < 0)
+		{
+			set_error(test, "Latency probe failed: %s", strerror(errno));
+			break;
+		}
+
+		latency->sent++;
+		deadline = sent_at + SELF_TEST_LATENCY_TIMEOUT_MS * 1000;
+
+		/* Late answers to earlier probes are dropped */
+		while (wait_fd(test, fd, POLLIN, deadline) > 0)
+		{
+			len = recv(fd, answer, sizeof(answer), 0);
+
+			if (sizeof(answer) == len && !memcmp(answer, probe, sizeof(probe)))
+			{
+				rtts[received++] = (g_get_monotonic_time() - sent_at) / 1000.0;
+				break;
+			}
+
+			/* The echo port answered with ICMP port unreachable */
+			if (len < 0 && ECONNREFUSED == errno)
+			{
+				set_error(test, "Echo refused by %s", test->params.host);
+				break;
+			}
+		}
+
+		if (NULL != test->result.error)
+		{
+			break;
+		}
+
+		wait_fd(test, -1, 0, sent_at + SELF_TEST_LATENCY_INTERVAL_MS * 1000);
+	}
+
+	if (!is_cancelled(test))
+	{
+		latency->done = TRUE;
+		latency->received = received;
+		latency->jitter_ms = self_test_jitter(rtts, received);
+
+		for (i = 0; i < received; i++)
+		{
+			latency->average_ms += rtts[i] / received;
+		}
+
+		latency->median_ms = self_test_percentile(rtts, received, 50);
+		latency->min_ms = received > 0 ? rtts[0] : 0;
+		latency->max_ms = received > 0 ? rtts[received - 1] : 0;
+	}
+
+	g_free(rtts);
+	close(fd);
+}
+
+static gboolean finish_cb(gpointer user_data)
+{
+	self_test_t *test = user_data;
+
+	if (!is_cancelled(test) && NULL != test->cb)
+	{
+		test->cb(&test->result, test->user_data);
+	}
+
+	g_main_context_unref(test->context);
+	g_free(test->params.host);
+	g_free(test->params.iface);
+	g_free(test->result.error);
+	g_free(test);
+
+	return FALSE;
+}
+
+static gpointer self_test_thread(gpointer user_data)
+{
+	self_test_t *test = user_data;
+	guint8 *buf = g_malloc0(BUF_SIZE);
+	GSource *source;
+
+	/* Latency first, while the link is idle */
+	if (0 != test->params.latency_port)
+	{
+		run_latency(test);
+	}
+
+	if (0 != test->params.download_port && NULL == test->result.error)
+	{
+		run_throughput(test, buf, FALSE);
+	}
+
+	if (0 != test->params.upload_port && NULL == test->result.error)
+	{
+		run_throughput(test, buf, TRUE);
+	}
+
+	g_free(buf);
+
+	/* Hand the result to the main loop, g_main_context_invoke could run it in
+	 * this thread if the context happens to be free */
+	source = g_idle_source_new();
+	g_source_set_callback(source, finish_cb, test, NULL);
+	g_source_attach(source, test->context);
+	g_source_unref(source);
+
+	return NULL;
+}
+
+/**
+ * Start a self test (see header for API details)
+ */
+
+self_test_t *self_test_start(const self_test_params_t *params, self_test_cb cb,
+                             gpointer user_data)
+{
+	self_test_t *test;
+	GThread *thread;
+
+	if (NULL == params || NULL == params->host)
+	{
+		return NULL;
+	}
+
+	test = g_new0(self_test_t, 1);
+	test->params = *params;
+	test->params.host = g_strdup(params->host);
+	test->params.iface = g_strdup(params->iface);
+	test->params.duration_ms = CLAMP(params->duration_ms ? params->duration_ms :
+	                                 SELF_TEST_DURATION_MS, 1, SELF_TEST_MAX_DURATION_MS);
+	test->params.max_bytes = params->max_bytes ? params->max_bytes :
+	                         SELF_TEST_MAX_BYTES;
+	test->params.latency_probes = CLAMP(params->latency_probes ?
+	                                    params->latency_probes : SELF_TEST_LATENCY_PROBES, 1,
+	                                    SELF_TEST_MAX_LATENCY_PROBES);
+	test->cb = cb;
+	test->user_data = user_data;
+	test->context = g_main_context_ref_thread_default();
+
+	thread = g_thread_try_new("self-test", self_test_thread, test, NULL);
+
+	if (NULL == thread)
+	{
+		g_main_context_unref(test->context);
+		g_free(test->params.host);
+		g_free(test->params.iface);
+		g_free(test);
+		return NULL;
+	}
+
+	/* The thread ends by itself, nobody joins it */
+	g_thread_unref(thread);
+
+	return test;
+}
+
+/**
+ * Cancel a running test (see header for API details)
+ */
+
+void self_test_cancel(self_test_t *test)
+{
+	if (NULL != test)
+	{
+		g_atomic_int_set(&test->cancelled, TRUE);
+	}
+}
+
+static gint compare_double(gconstpointer a, gconstpointer b)
+{
+	gdouble value_a = *(const gdouble *) a, value_b = *(const gdouble *) b;
+
+	return value_a < value_b ? -1 : value_a > value_b ? 1 : 0;
+}
+
+/**
+ * Get a percentile of samples (see header for API details)
+ */
+
+gdouble self_test_percentile(gdouble *samples, guint n, gdouble percentile)
+{
+	gdouble position = percentile / 100.0 * n;
+	gint rank = (gint) position;
+
+	if (0 == n)
+	{
+		return 0;
+	}
+
+	qsort(samples, n, sizeof(gdouble), compare_double);
+
+	/* The smallest sample with at least percentile % of them at or below it */
+	if (rank < position)
+	{
+		rank++;
+	}
+
+	return samples[CLAMP(rank - 1, 0, (gint) n - 1)];
+}
+
+/**
+ * Get the jitter of round trip times (see header for API details)
+ */
+
+gdouble self_test_jitter(const gdouble *rtts, guint n)
+{
+	gdouble sum = 0;
+	guint i;
+
+	if (n < 2)
+	{
+		return 0;
+	}
+
+	for (i = 1; i < n; i++)
+	{
+		sum += ABS(rtts[i] - rtts[i - 1]);
+	}
+
+	return sum / (n - 1);
+}
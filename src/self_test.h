@@ -0,0 +1,167 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  self_test.h
+ *
+ * @brief Header file defining the link self test, which measures the
+ *        throughput and round trip time actually achieved against an endpoint
+ *
+ * The endpoint runs the classic inetd test services: the download reads from
+ * chargen (RFC 864), the upload writes to discard (RFC 863) and the latency
+ * test sends UDP datagrams to echo (RFC 862). The test runs in a thread of
+ * its own with blocking calls cut into short slices, so it never stalls the
+ * main loop and a cancel is noticed quickly. Throughput is sampled in fixed
+ * windows to give percentiles next to the average.
+ *
+ */
+
+#ifndef _SELF_TEST_H_
+#define _SELF_TEST_H_
+
+#include <glib.h>
+
+#define SELF_TEST_CHARGEN_PORT          19
+#define SELF_TEST_DISCARD_PORT          9
+#define SELF_TEST_ECHO_PORT             7
+
+/**
+ * Default and largest time (in ms) the download and the upload run for each
+ */
+#define SELF_TEST_DURATION_MS           5000
+#define SELF_TEST_MAX_DURATION_MS       30000
+
+/**
+ * Default amount of data (in bytes) moved in each direction at most
+ */
+#define SELF_TEST_MAX_BYTES             (64 * 1024 * 1024)
+
+/**
+ * Length (in ms) of a throughput sample window
+ */
+#define SELF_TEST_SAMPLE_MS             100
+
+/**
+ * Default and largest number of latency probes, and the time (in ms) between
+ * two of them and a probe is waited for
+ */
+#define SELF_TEST_LATENCY_PROBES        20
+#define SELF_TEST_MAX_LATENCY_PROBES    100
+#define SELF_TEST_LATENCY_INTERVAL_MS   100
+#define SELF_TEST_LATENCY_TIMEOUT_MS    1000
+
+/**
+ * Time (in ms) to connect to the endpoint within
+ */
+#define SELF_TEST_CONNECT_TIMEOUT_MS    3000
+
+typedef struct self_test_params
+{
+	gchar *host;                    /* Address or name of the endpoint */
+	gchar *iface;                   /* Interface to test, NULL to let the routing decide */
+	guint16 download_port;          /* 0 skips the download */
+	guint16 upload_port;            /* 0 skips the upload */
+	guint16 latency_port;           /* 0 skips the latency test */
+	guint duration_ms;
+	guint64 max_bytes;
+	guint latency_probes;
+} self_test_params_t;
+
+typedef struct self_test_throughput
+{
+	gboolean done;                  /* FALSE if this part didn't run */
+	guint64 bytes;
+	gint64 duration_ms;
+	gdouble average_kbps;
+	gdouble p10_kbps;
+	gdouble median_kbps;
+	gdouble p90_kbps;
+	guint samples;
+} self_test_throughput_t;
+
+typedef struct self_test_latency
+{
+	gboolean done;
+	guint sent;
+	guint received;
+	gdouble min_ms;
+	gdouble average_ms;
+	gdouble median_ms;
+	gdouble max_ms;
+	gdouble jitter_ms;              /* Mean difference of consecutive round trips */
+} self_test_latency_t;
+
+typedef struct self_test_result
+{
+	self_test_throughput_t download;
+	self_test_throughput_t upload;
+	self_test_latency_t latency;
+	gchar *error;                   /* Why the test stopped early, NULL if it didn't */
+} self_test_result_t;
+
+typedef struct self_test self_test_t;
+
+/**
+ * Callback called on the main loop the test was started from once it
+ * finished. The test is freed after the callback returns.
+ */
+typedef void (*self_test_cb)(const self_test_result_t *result,
+                             gpointer user_data);
+
+/**
+ * Start a self test
+ *
+ * @param[IN]  params What to test, copied
+ * @param[IN]  cb Callback called with the result
+ * @param[IN]  user_data User data passed to cb
+ *
+ * @return Running test or NULL if the thread couldn't be started
+ */
+extern self_test_t *self_test_start(const self_test_params_t *params,
+                                    self_test_cb cb, gpointer user_data);
+
+/**
+ * Stop a running test without calling its callback. The test stops within a
+ * fraction of a second and is freed then, it must not be used afterwards.
+ *
+ * @param[IN]  test Test to cancel
+ */
+extern void self_test_cancel(self_test_t *test);
+
+/**
+ * Get a percentile of samples (nearest rank)
+ *
+ * @param[IN]  samples Samples, sorted in place
+ * @param[IN]  n Number of samples
+ * @param[IN]  percentile Percentile, 0 to 100
+ *
+ * @return The percentile, 0 if there are no samples
+ */
+extern gdouble self_test_percentile(gdouble *samples, guint n,
+                                    gdouble percentile);
+
+/**
+ * Get the jitter of round trip times as the mean difference of consecutive
+ * round trips (the IPDV of RFC 3393, without smoothing)
+ *
+ * @param[IN]  rtts Round trip times in the order they were measured
+ * @param[IN]  n Number of round trip times
+ *
+ * @return Jitter, 0 with fewer than two round trips
+ */
+extern gdouble self_test_jitter(const gdouble *rtts, guint n);
+
+#endif /* _SELF_TEST_H_ */
@@ -0,0 +1,358 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_p2p.c
+ *
+ * @brief Persistent P2P group requests to wpa_supplicant
+ *
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+
+#include "supplicant_p2p.h"
+#include "dbus_call.h"
+
+#define SUPPLICANT_SERVICE          "fi.w1.wpa_supplicant1"
+#define SUPPLICANT_PATH             "/fi/w1/wpa_supplicant1"
+#define SUPPLICANT_P2P_INTERFACE    "fi.w1.wpa_supplicant1.Interface.P2PDevice"
+#define SUPPLICANT_GROUP_INTERFACE  "fi.w1.wpa_supplicant1.PersistentGroup"
+#define DBUS_PROPERTIES_INTERFACE   "org.freedesktop.DBus.Properties"
+
+typedef struct invoke_request
+{
+	GDBusConnection *connection;
+	gchar *iface;
+	gchar *group_name;
+	gchar *peer_address;
+	gboolean group_owner;
+	gint freq;
+	gchar *iface_path;
+	gchar *group_path;
+	GVariant *groups;           /* Object paths of the stored groups */
+	gsize next_group;
+	supplicant_p2p_invoke_cb cb;
+	gpointer user_data;
+} invoke_request_t;
+
+static gint get_timeout(void)
+{
+	return dbus_call_get_deadline(DBUS_CALL_CONTROL);
+}
+
+static void finish_request(invoke_request_t *request, GError *error)
+{
+	if (NULL != request->cb)
+	{
+		request->cb(error, request->user_data);
+	}
+
+	if (NULL != error)
+	{
+		g_error_free(error);
+	}
+
+	if (NULL != request->connection)
+	{
+		g_object_unref(request->connection);
+	}
+
+	if (NULL != request->groups)
+	{
+		g_variant_unref(request->groups);
+	}
+
+	g_free(request->iface);
+	g_free(request->group_name);
+	g_free(request->peer_address);
+	g_free(request->iface_path);
+	g_free(request->group_path);
+	g_free(request);
+}
+
+static void get_property(invoke_request_t *request, const gchar *path,
+                         const gchar *interface, const gchar *name, GAsyncReadyCallback cb)
+{
+	g_dbus_connection_call(request->connection, SUPPLICANT_SERVICE, path,
+	                       DBUS_PROPERTIES_INTERFACE, "Get", g_variant_new("(ss)", interface, name),
+	                       G_VARIANT_TYPE("(v)"), G_DBUS_CALL_FLAGS_NONE, get_timeout(), NULL, cb,
+	                       request);
+}
+
+static GVariant *get_property_finish(GObject *source_object, GAsyncResult *res,
+                                     GError **error)
+{
+	GVariant *result, *value = NULL;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+	                                       error);
+
+	if (NULL != result)
+	{
+		g_variant_get(result, "(v)", &value);
+		g_variant_unref(result);
+	}
+
+	return value;
+}
+
+/* The SSID is given as in wpa_supplicant.conf, i.e. quoted */
+static gboolean is_group_named(GVariant *properties, const gchar *name)
+{
+	const gchar *ssid = NULL;
+	gsize len;
+
+	if (!g_variant_lookup(properties, "ssid", "&s", &ssid))
+	{
+		return FALSE;
+	}
+
+	len = strlen(ssid);
+
+	if (len >= 2 && '"' == ssid[0] && '"' == ssid[len - 1])
+	{
+		return strlen(name) == len - 2 && !strncmp(ssid + 1, name, len - 2);
+	}
+
+	return !g_strcmp0(ssid, name);
+}
+
+/* Peers are named after their device address without colons */
+static gchar *build_peer_path(const gchar *iface_path, const gchar *address,
+                              GError **error)
+{
+	GString *path = g_string_new(iface_path);
+	guint digits = 0;
+
+	g_string_append(path, "/Peers/");
+
+	for (; '\0' != *address; address++)
+	{
+		if (g_ascii_isxdigit(*address))
+		{
+			g_string_append_c(path, g_ascii_tolower(*address));
+			digits++;
+		}
+		else if (':' != *address)
+		{
+			break;
+		}
+	}
+
+	if ('\0' != *address || 12 != digits)
+	{
+		g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		            "Invalid peer address");
+		g_string_free(path, TRUE);
+		return NULL;
+	}
+
+	return g_string_free(path, FALSE);
+}
+
+static void request_cb(GObject *source_object, GAsyncResult *res,
+                       gpointer user_data)
+{
+	invoke_request_t *request = user_data;
+	GError *error = NULL;
+	GVariant *result;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+	                                       &error);
+
+	if (NULL != result)
+	{
+		g_variant_unref(result);
+	}
+
+	finish_request(request, error);
+}
+
+/**
+ * @brief Start the stored group as its owner on the cached channel, or
+ * invite the peer into it when we were a client
+ */
+
+static void send_request(invoke_request_t *request)
+{
+	GVariantBuilder args;
+	GError *error = NULL;
+	gchar *peer_path;
+
+	g_variant_builder_init(&args, G_VARIANT_TYPE("a{sv}"));
+	g_variant_builder_add(&args, "{sv}", "persistent_group_object",
+	                      g_variant_new_object_path(request->group_path));
+
+	if (request->group_owner)
+	{
+		if (request->freq > 0)
+		{
+			g_variant_builder_add(&args, "{sv}", "frequency",
+			                      g_variant_new_int32(request->freq));
+		}
+
+		g_dbus_connection_call(request->connection, SUPPLICANT_SERVICE,
+		                       request->iface_path, SUPPLICANT_P2P_INTERFACE, "GroupAdd",
+		                       g_variant_new("(a{sv})", &args), NULL, G_DBUS_CALL_FLAGS_NONE,
+		                       get_timeout(), NULL, request_cb, request);
+		return;
+	}
+
+	peer_path = build_peer_path(request->iface_path, request->peer_address,
+	                            &error);
+
+	if (NULL == peer_path)
+	{
+		g_variant_builder_clear(&args);
+		finish_request(request, error);
+		return;
+	}
+
+	g_variant_builder_add(&args, "{sv}", "peer",
+	                      g_variant_new_object_path(peer_path));
+	g_free(peer_path);
+
+	g_dbus_connection_call(request->connection, SUPPLICANT_SERVICE,
+	                       request->iface_path, SUPPLICANT_P2P_INTERFACE, "Invite",
+	                       g_variant_new("(a{sv})", &args), NULL, G_DBUS_CALL_FLAGS_NONE,
+	                       get_timeout(), NULL, request_cb, request);
+}
+
+static void check_next_group(invoke_request_t *request);
+
+static void group_properties_cb(GObject *source_object, GAsyncResult *res,
+                                gpointer user_data)
+{
+	invoke_request_t *request = user_data;
+	GVariant *properties = get_property_finish(source_object, res, NULL);
+	gboolean found = FALSE;
+
+	if (NULL != properties)
+	{
+		found = is_group_named(properties, request->group_name);
+		g_variant_unref(properties);
+	}
+
+	if (!found)
+	{
+		check_next_group(request);
+		return;
+	}
+
+	g_variant_get_child(request->groups, request->next_group - 1, "o",
+	                    &request->group_path);
+	send_request(request);
+}
+
+/* The stored groups are looked at one after the other */
+static void check_next_group(invoke_request_t *request)
+{
+	const gchar *path;
+
+	if (request->next_group >= g_variant_n_children(request->groups))
+	{
+		finish_request(request, g_error_new(G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+		                                    "No persistent group %s", request->group_name));
+		return;
+	}
+
+	g_variant_get_child(request->groups, request->next_group++, "&o", &path);
+	get_property(request, path, SUPPLICANT_GROUP_INTERFACE, "Properties",
+	             group_properties_cb);
+}
+
+static void persistent_groups_cb(GObject *source_object, GAsyncResult *res,
+                                 gpointer user_data)
+{
+	invoke_request_t *request = user_data;
+	GError *error = NULL;
+
+	request->groups = get_property_finish(source_object, res, &error);
+
+	if (NULL == request->groups)
+	{
+		finish_request(request, error);
+		return;
+	}
+
+	check_next_group(request);
+}
+
+static void get_interface_cb(GObject *source_object, GAsyncResult *res,
+                             gpointer user_data)
+{
+	invoke_request_t *request = user_data;
+	GError *error = NULL;
+	GVariant *result;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+	                                       &error);
+
+	if (NULL == result)
+	{
+		finish_request(request, error);
+		return;
+	}
+
+	g_variant_get(result, "(o)", &request->iface_path);
+	g_variant_unref(result);
+
+	get_property(request, request->iface_path, SUPPLICANT_P2P_INTERFACE,
+	             "PersistentGroups", persistent_groups_cb);
+}
+
+static void bus_cb(GObject *source_object, GAsyncResult *res,
+                   gpointer user_data)
+{
+	invoke_request_t *request = user_data;
+	GError *error = NULL;
+
+	request->connection = g_bus_get_finish(res, &error);
+
+	if (NULL == request->connection)
+	{
+		finish_request(request, error);
+		return;
+	}
+
+	g_dbus_connection_call(request->connection, SUPPLICANT_SERVICE,
+	                       SUPPLICANT_PATH, SUPPLICANT_SERVICE, "GetInterface",
+	                       g_variant_new("(s)", request->iface), G_VARIANT_TYPE("(o)"),
+	                       G_DBUS_CALL_FLAGS_NONE, get_timeout(), NULL, get_interface_cb, request);
+}
+
+/**
+ * Ask wpa_supplicant to re-invoke a persistent group (see header for API
+ * details)
+ */
+
+void supplicant_p2p_invoke_group(const gchar *iface, const gchar *group_name,
+                                 const gchar *peer_address, gboolean group_owner, gint freq,
+                                 supplicant_p2p_invoke_cb cb, gpointer user_data)
+{
+	invoke_request_t *request = g_new0(invoke_request_t, 1);
+
+	request->iface = g_strdup(iface);
+	request->group_name = g_strdup(group_name);
+	request->peer_address = g_strdup(peer_address);
+	request->group_owner = group_owner;
+	request->freq = freq;
+	request->cb = cb;
+	request->user_data = user_data;
+
+	g_bus_get(G_BUS_TYPE_SYSTEM, NULL, bus_cb, request);
+}
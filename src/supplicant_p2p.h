@@ -0,0 +1,66 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_p2p.h
+ *
+ * @brief Header file defining how wpa_supplicant is asked to re-invoke a
+ *        persistent P2P group
+ *
+ * connman can only invite a peer into a group which is running. To bring a
+ * persistent group back once it was torn down, the request goes straight to
+ * the P2PDevice D-Bus interface of wpa_supplicant, which keeps the
+ * credentials of the group. If we owned the group it is started again on
+ * its cached channel and the peer can be invited into it through connman.
+ * If we were a client, the peer is invited into the stored group, so GO
+ * negotiation is skipped, and the group is started when the peer accepts.
+ * All calls are asynchronous.
+ *
+ */
+
+#ifndef _SUPPLICANT_P2P_H_
+#define _SUPPLICANT_P2P_H_
+
+#include <glib.h>
+
+/**
+ * Called once a re-invocation was requested or failed
+ *
+ * @param[IN]  error Why the request failed, G_IO_ERROR_NOT_FOUND if the
+ *                   supplicant doesn't know the group, NULL on success
+ * @param[IN]  user_data User data given with the request
+ */
+typedef void (*supplicant_p2p_invoke_cb)(const GError *error,
+        gpointer user_data);
+
+/**
+ * Ask wpa_supplicant to re-invoke a stored persistent group: start it as its
+ * owner, or invite the peer into it when we were a client
+ *
+ * @param[IN]  iface Name of the wireless interface
+ * @param[IN]  group_name SSID of the persistent group
+ * @param[IN]  peer_address Device address of the peer
+ * @param[IN]  group_owner TRUE if we owned the group
+ * @param[IN]  freq Operating channel of the group in MHz, 0 to let the
+ *                  supplicant pick one. Only used when we owned the group.
+ * @param[IN]  cb Callback called with the result
+ * @param[IN]  user_data User data passed to the callback
+ */
+extern void supplicant_p2p_invoke_group(const gchar *iface,
+                                        const gchar *group_name, const gchar *peer_address, gboolean group_owner,
+                                        gint freq, supplicant_p2p_invoke_cb cb, gpointer user_data);
+
+#endif /* _SUPPLICANT_P2P_H_ */
@@ -0,0 +1,77 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_roam.c
+ *
+ * @brief Roam requests to wpa_supplicant
+ *
+ */
+
+#include <gio/gio.h>
+
+#include "supplicant_roam.h"
+#include "dbus_call.h"
+
+#define SUPPLICANT_SERVICE          "fi.w1.wpa_supplicant1"
+#define SUPPLICANT_PATH             "/fi/w1/wpa_supplicant1"
+#define SUPPLICANT_INTERFACE        "fi.w1.wpa_supplicant1.Interface"
+
+/**
+ * Ask wpa_supplicant to roam (see header for API details)
+ */
+
+gboolean supplicant_roam(const gchar *iface, const gchar *bssid,
+                         GError **error)
+{
+	GDBusConnection *connection;
+	GVariant *result;
+	gchar *path = NULL;
+	gint timeout = dbus_call_get_deadline(DBUS_CALL_CONTROL);
+
+	connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, error);
+
+	if (NULL == connection)
+	{
+		return FALSE;
+	}
+
+	result = g_dbus_connection_call_sync(connection, SUPPLICANT_SERVICE,
+	                                     SUPPLICANT_PATH, SUPPLICANT_SERVICE, "GetInterface",
+	                                     g_variant_new("(s)", iface), G_VARIANT_TYPE("(o)"),
+	                                     G_DBUS_CALL_FLAGS_NONE, timeout, NULL, error);
+
+	if (NULL != result)
+	{
+		g_variant_get(result, "(o)", &path);
+		g_variant_unref(result);
+
+		result = g_dbus_connection_call_sync(connection, SUPPLICANT_SERVICE, path,
+		                                     SUPPLICANT_INTERFACE, "Roam", g_variant_new("(s)", bssid), NULL,
+		                                     G_DBUS_CALL_FLAGS_NONE, timeout, NULL, error);
+		g_free(path);
+	}
+
+	g_object_unref(connection);
+
+	if (NULL == result)
+	{
+		return FALSE;
+	}
+
+	g_variant_unref(result);
+	return TRUE;
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_roam.h
+ *
+ * @brief Header file defining how wpa_supplicant is asked to roam to another
+ *        BSS of the network it is connected to
+ *
+ * connman doesn't pass BSSID hints on, so the request goes straight to the
+ * D-Bus interface of wpa_supplicant. The supplicant stays in charge of the
+ * connection: it may roam back on its own later.
+ *
+ */
+
+#ifndef _SUPPLICANT_ROAM_H_
+#define _SUPPLICANT_ROAM_H_
+
+#include <glib.h>
+
+/**
+ * Ask wpa_supplicant to roam to a BSS of the current network
+ *
+ * @param[IN]  iface Name of the wireless interface
+ * @param[IN]  bssid BSSID to roam to
+ * @param[OUT] error Why the request failed
+ *
+ * @return TRUE if the supplicant started to roam, FALSE otherwise
+ */
+extern gboolean supplicant_roam(const gchar *iface, const gchar *bssid,
+                                GError **error);
+
+#endif /* _SUPPLICANT_ROAM_H_ */
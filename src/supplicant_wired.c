@@ -0,0 +1,293 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_wired.c
+ *
+ * @brief EAP state of the wired interface as reported by wpa_supplicant
+ *
+ */
+
+#include <gio/gio.h>
+
+#include "supplicant_wired.h"
+#include "dbus_call.h"
+
+#define SUPPLICANT_SERVICE          "fi.w1.wpa_supplicant1"
+#define SUPPLICANT_PATH             "/fi/w1/wpa_supplicant1"
+#define SUPPLICANT_INTERFACE        "fi.w1.wpa_supplicant1.Interface"
+#define DBUS_PROPERTIES_INTERFACE   "org.freedesktop.DBus.Properties"
+
+static gchar *watched_iface = NULL;
+static supplicant_wired_cb watch_cb = NULL;
+static gpointer watch_user_data = NULL;
+static GCancellable *cancellable = NULL;
+static GDBusConnection *connection = NULL;
+static guint subscriptions[3];
+static gchar *iface_path = NULL;
+static gchar *eap_state = NULL;
+
+static void set_state(const gchar *state)
+{
+	if (!g_strcmp0(eap_state, state))
+	{
+		return;
+	}
+
+	g_free(eap_state);
+	eap_state = g_strdup(state);
+
+	if (NULL != watch_cb)
+	{
+		watch_cb(watch_user_data);
+	}
+}
+
+static void set_iface_path(const gchar *path)
+{
+	g_free(iface_path);
+	iface_path = g_strdup(path);
+}
+
+static void state_cb(GObject *source_object, GAsyncResult *res,
+                     gpointer user_data)
+{
+	GVariant *result, *value;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+	                                       NULL);
+
+	if (NULL == result)
+	{
+		return;
+	}
+
+	g_variant_get(result, "(v)", &value);
+
+	if (g_variant_is_of_type(value, G_VARIANT_TYPE_STRING))
+	{
+		set_state(g_variant_get_string(value, NULL));
+	}
+
+	g_variant_unref(value);
+	g_variant_unref(result);
+}
+
+static void get_interface_cb(GObject *source_object, GAsyncResult *res,
+                             gpointer user_data)
+{
+	GVariant *result;
+	const gchar *path;
+
+	result = g_dbus_connection_call_finish(G_DBUS_CONNECTION(source_object), res,
+	                                       NULL);
+
+	/* No supplicant interface runs on the port yet */
+	if (NULL == result)
+	{
+		return;
+	}
+
+	g_variant_get(result, "(&o)", &path);
+	set_iface_path(path);
+	g_variant_unref(result);
+
+	g_dbus_connection_call(connection, SUPPLICANT_SERVICE, iface_path,
+	                       DBUS_PROPERTIES_INTERFACE, "Get", g_variant_new("(ss)", SUPPLICANT_INTERFACE,
+	                               "State"), G_VARIANT_TYPE("(v)"), G_DBUS_CALL_FLAGS_NONE,
+	                       dbus_call_get_deadline(DBUS_CALL_PROPERTY_READ), cancellable, state_cb, NULL);
+}
+
+static void interface_added_cb(GDBusConnection *conn, const gchar *sender,
+                               const gchar *path, const gchar *interface, const gchar *signal,
+                               GVariant *parameters, gpointer user_data)
+{
+	const gchar *added_path, *ifname = NULL, *state = NULL;
+	GVariant *properties;
+
+	g_variant_get(parameters, "(&o@a{sv})", &added_path, &properties);
+
+	if (g_variant_lookup(properties, "Ifname", "&s", &ifname) &&
+	        !g_strcmp0(ifname, watched_iface))
+	{
+		set_iface_path(added_path);
+
+		if (g_variant_lookup(properties, "State", "&s", &state))
+		{
+			set_state(state);
+		}
+	}
+
+	g_variant_unref(properties);
+}
+
+static void interface_removed_cb(GDBusConnection *conn, const gchar *sender,
+                                 const gchar *path, const gchar *interface, const gchar *signal,
+                                 GVariant *parameters, gpointer user_data)
+{
+	const gchar *removed_path;
+
+	g_variant_get(parameters, "(&o)", &removed_path);
+
+	if (!g_strcmp0(removed_path, iface_path))
+	{
+		set_iface_path(NULL);
+		set_state(NULL);
+	}
+}
+
+/* Both the properties and the EAP events of all interfaces come here */
+static void interface_signal_cb(GDBusConnection *conn, const gchar *sender,
+                                const gchar *path, const gchar *interface, const gchar *signal,
+                                GVariant *parameters, gpointer user_data)
+{
+	const gchar *state = NULL, *status, *parameter;
+	GVariant *properties;
+
+	if (NULL == iface_path || g_strcmp0(path, iface_path))
+	{
+		return;
+	}
+
+	if (!g_strcmp0(signal, "EAP"))
+	{
+		g_variant_get(parameters, "(&s&s)", &status, &parameter);
+
+		/* The supplicant state doesn't change when the authenticator rejects us */
+		if (!g_strcmp0(status, "completion") && !g_strcmp0(parameter, "failure"))
+		{
+			set_state("failed");
+		}
+
+		return;
+	}
+
+	if (g_strcmp0(signal, "PropertiesChanged"))
+	{
+		return;
+	}
+
+	g_variant_get(parameters, "(@a{sv})", &properties);
+
+	if (g_variant_lookup(properties, "State", "&s", &state))
+	{
+		set_state(state);
+	}
+
+	g_variant_unref(properties);
+}
+
+static void bus_cb(GObject *source_object, GAsyncResult *res,
+                   gpointer user_data)
+{
+	GDBusConnection *bus = g_bus_get_finish(res, NULL);
+
+	if (NULL == bus)
+	{
+		return;
+	}
+
+	/* Unwatched meanwhile */
+	if (NULL == watched_iface)
+	{
+		g_object_unref(bus);
+		return;
+	}
+
+	connection = bus;
+
+	subscriptions[0] = g_dbus_connection_signal_subscribe(connection,
+	                   SUPPLICANT_SERVICE, SUPPLICANT_SERVICE, "InterfaceAdded", SUPPLICANT_PATH,
+	                   NULL, G_DBUS_SIGNAL_FLAGS_NONE, interface_added_cb, NULL, NULL);
+	subscriptions[1] = g_dbus_connection_signal_subscribe(connection,
+	                   SUPPLICANT_SERVICE, SUPPLICANT_SERVICE, "InterfaceRemoved", SUPPLICANT_PATH,
+	                   NULL, G_DBUS_SIGNAL_FLAGS_NONE, interface_removed_cb, NULL, NULL);
+	subscriptions[2] = g_dbus_connection_signal_subscribe(connection,
+	                   SUPPLICANT_SERVICE, SUPPLICANT_INTERFACE, NULL, NULL, NULL,
+	                   G_DBUS_SIGNAL_FLAGS_NONE, interface_signal_cb, NULL, NULL);
+
+	g_dbus_connection_call(connection, SUPPLICANT_SERVICE, SUPPLICANT_PATH,
+	                       SUPPLICANT_SERVICE, "GetInterface", g_variant_new("(s)", watched_iface),
+	                       G_VARIANT_TYPE("(o)"), G_DBUS_CALL_FLAGS_NONE,
+	                       dbus_call_get_deadline(DBUS_CALL_PROPERTY_READ), cancellable,
+	                       get_interface_cb, NULL);
+}
+
+/**
+ * Start following the EAP state of a wired interface (see header for API
+ * details)
+ */
+
+void supplicant_wired_watch(const gchar *iface, supplicant_wired_cb cb,
+                            gpointer user_data)
+{
+	if (!g_strcmp0(watched_iface, iface))
+	{
+		return;
+	}
+
+	supplicant_wired_unwatch();
+
+	watched_iface = g_strdup(iface);
+	watch_cb = cb;
+	watch_user_data = user_data;
+	cancellable = g_cancellable_new();
+
+	g_bus_get(G_BUS_TYPE_SYSTEM, cancellable, bus_cb, NULL);
+}
+
+/**
+ * Stop following the EAP state (see header for API details)
+ */
+
+void supplicant_wired_unwatch(void)
+{
+	guint i;
+
+	if (NULL != cancellable)
+	{
+		g_cancellable_cancel(cancellable);
+		g_clear_object(&cancellable);
+	}
+
+	if (NULL != connection)
+	{
+		for (i = 0; i < G_N_ELEMENTS(subscriptions); i++)
+		{
+			g_dbus_connection_signal_unsubscribe(connection, subscriptions[i]);
+			subscriptions[i] = 0;
+		}
+
+		g_clear_object(&connection);
+	}
+
+	g_free(watched_iface);
+	watched_iface = NULL;
+	watch_cb = NULL;
+	watch_user_data = NULL;
+	set_iface_path(NULL);
+	g_free(eap_state);
+	eap_state = NULL;
+}
+
+/**
+ * Get the EAP state of the watched interface (see header for API details)
+ */
+
+const gchar *supplicant_wired_get_state(void)
+{
+	return eap_state;
+}
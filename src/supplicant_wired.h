@@ -0,0 +1,67 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  supplicant_wired.h
+ *
+ * @brief Header file defining how the EAP state of the wired interface is
+ *        followed on the D-Bus interface of wpa_supplicant
+ *
+ * connman's state of a wired service only tells the link is up. Whether an
+ * 802.1X exchange took place, and how it ended, is only known to the
+ * wpa_supplicant interface which runs EAP on the wired port. Without such an
+ * interface, e.g. with a connman whose ethernet plugin doesn't run EAP, the
+ * state stays unknown.
+ *
+ */
+
+#ifndef _SUPPLICANT_WIRED_H_
+#define _SUPPLICANT_WIRED_H_
+
+#include <glib.h>
+
+/**
+ * Called whenever the EAP state of the watched interface changed
+ */
+typedef void (*supplicant_wired_cb)(gpointer user_data);
+
+/**
+ * Start following the EAP state of a wired interface, unless it is followed
+ * already. The state is looked up asynchronously and updated from the
+ * signals of the supplicant.
+ *
+ * @param[IN]  iface Name of the wired interface
+ * @param[IN]  cb Callback called when the state changed
+ * @param[IN]  user_data User data passed to the callback
+ */
+extern void supplicant_wired_watch(const gchar *iface, supplicant_wired_cb cb,
+                                   gpointer user_data);
+
+/**
+ * Stop following the EAP state and forget it
+ */
+extern void supplicant_wired_unwatch(void);
+
+/**
+ * Get the EAP state of the watched interface
+ *
+ * @return State of the wpa_supplicant interface, e.g. "authenticating" or
+ *         "completed", "failed" if the last EAP exchange failed, NULL if no
+ *         supplicant interface runs on the wired port
+ */
+extern const gchar *supplicant_wired_get_state(void);
+
+#endif /* _SUPPLICANT_WIRED_H_ */
@@ -0,0 +1,295 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wan_failover.c
+ *
+ * @brief Preference order and health of the cellular contexts
+ *
+ */
+
+#include <glib.h>
+
+#include "wan_failover.h"
+
+static GPtrArray *contexts = NULL;
+static guint backoff = WAN_FAILOVER_BACKOFF * 1000;
+static guint max_backoff = WAN_FAILOVER_MAX_BACKOFF * 1000;
+
+static void health_free(gpointer data)
+{
+	wan_context_health_t *health = data;
+
+	if (NULL != health)
+	{
+		g_free(health->name);
+		g_free(health);
+	}
+}
+
+static gint find_in(GPtrArray *array, const gchar *name)
+{
+	guint i;
+
+	for (i = 0; NULL != array && NULL != name && i < array->len; i++)
+	{
+		wan_context_health_t *health = g_ptr_array_index(array, i);
+
+		if (NULL != health && !g_strcmp0(health->name, name))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static gint find_context(const gchar *name)
+{
+	return find_in(contexts, name);
+}
+
+/**
+ * Set the preference list (see header for API details)
+ */
+
+void wan_failover_set_preferences(const gchar *const *names)
+{
+	GPtrArray *new_contexts = g_ptr_array_new_with_free_func(health_free);
+	guint i;
+
+	for (i = 0; NULL != names && NULL != names[i]; i++)
+	{
+		wan_context_health_t *health;
+		gint index = find_context(names[i]);
+
+		if (find_in(new_contexts, names[i]) >= 0)
+		{
+			continue;
+		}
+
+		if (index >= 0)
+		{
+			health = g_ptr_array_index(contexts, index);
+			g_ptr_array_index(contexts, index) = NULL;
+		}
+		else
+		{
+			health = g_new0(wan_context_health_t, 1);
+			health->name = g_strdup(names[i]);
+			health->time_to_ip_ms = -1;
+		}
+
+		g_ptr_array_add(new_contexts, health);
+	}
+
+	/* Entries moved to the new list were replaced with NULL */
+	if (NULL != contexts)
+	{
+		g_ptr_array_free(contexts, TRUE);
+	}
+
+	contexts = new_contexts;
+}
+
+/**
+ * Get the contexts (see header for API details)
+ */
+
+const GPtrArray *wan_failover_get_contexts(void)
+{
+	if (NULL == contexts)
+	{
+		contexts = g_ptr_array_new_with_free_func(health_free);
+	}
+
+	return contexts;
+}
+
+/**
+ * Get the health of a context (see header for API details)
+ */
+
+const wan_context_health_t *wan_failover_get_health(const gchar *name)
+{
+	gint index = find_context(name);
+
+	return index >= 0 ? g_ptr_array_index(contexts, index) : NULL;
+}
+
+/**
+ * Set the backoff times (see header for API details)
+ */
+
+void wan_failover_set_backoff(guint backoff_ms, guint max_backoff_ms)
+{
+	backoff = backoff_ms;
+	max_backoff = max_backoff_ms;
+}
+
+/**
+ * Record the start of a connect attempt (see header for API details)
+ */
+
+void wan_failover_attempt(const gchar *name, gint64 now_ms)
+{
+	wan_context_health_t *health = (wan_context_health_t *)
+	                               wan_failover_get_health(name);
+
+	if (NULL != health)
+	{
+		health->attempting = TRUE;
+		health->attempt_started_ms = now_ms;
+	}
+}
+
+/**
+ * Record a successful connect (see header for API details)
+ */
+
+void wan_failover_succeeded(const gchar *name, gint64 now_ms)
+{
+	wan_context_health_t *health = (wan_context_health_t *)
+	                               wan_failover_get_health(name);
+
+	if (NULL == health)
+	{
+		return;
+	}
+
+	if (health->attempting)
+	{
+		health->time_to_ip_ms = now_ms - health->attempt_started_ms;
+	}
+
+	health->attempting = FALSE;
+	health->failures = 0;
+	health->connects++;
+	health->retry_after_ms = 0;
+}
+
+/**
+ * Record a failure (see header for API details)
+ */
+
+void wan_failover_failed(const gchar *name, gint64 now_ms)
+{
+	wan_context_health_t *health = (wan_context_health_t *)
+	                               wan_failover_get_health(name);
+	guint64 delay;
+
+	if (NULL == health)
+	{
+		return;
+	}
+
+	health->attempting = FALSE;
+	health->failures++;
+	health->total_failures++;
+
+	/* Doubles with every failure in a row */
+	delay = health->failures > 20 ? max_backoff :
+	        MIN((guint64) backoff << (health->failures - 1), (guint64) max_backoff);
+	health->retry_after_ms = now_ms + delay;
+}
+
+/* Number of contexts preferred over active, -1 if active isn't managed */
+static gint candidates(const gchar *active)
+{
+	guint i;
+
+	if (NULL == contexts)
+	{
+		return 0;
+	}
+
+	for (i = 0; i < contexts->len; i++)
+	{
+		if (((wan_context_health_t *) g_ptr_array_index(contexts, i))->attempting)
+		{
+			return 0;
+		}
+	}
+
+	if (NULL == active)
+	{
+		return contexts->len;
+	}
+
+	return find_context(active);
+}
+
+/**
+ * Pick the context to connect next (see header for API details)
+ */
+
+const gchar *wan_failover_next(const gchar *active, gint64 now_ms)
+{
+	gint count = candidates(active);
+	gint i;
+
+	for (i = 0; i < count; i++)
+	{
+		wan_context_health_t *health = g_ptr_array_index(contexts, i);
+
+		if (health->retry_after_ms <= now_ms)
+		{
+			return health->name;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Get the time until a context may be picked (see header for API details)
+ */
+
+gint64 wan_failover_next_retry(const gchar *active, gint64 now_ms)
+{
+	gint count = candidates(active);
+	gint64 next = -1;
+	gint i;
+
+	for (i = 0; i < count; i++)
+	{
+		wan_context_health_t *health = g_ptr_array_index(contexts, i);
+		gint64 delay = MAX(health->retry_after_ms - now_ms, 0);
+
+		if (next < 0 || delay < next)
+		{
+			next = delay;
+		}
+	}
+
+	return next;
+}
+
+/**
+ * Forget the preference list (see header for API details)
+ */
+
+void wan_failover_reset(void)
+{
+	if (NULL != contexts)
+	{
+		g_ptr_array_free(contexts, TRUE);
+		contexts = NULL;
+	}
+
+	backoff = WAN_FAILOVER_BACKOFF * 1000;
+	max_backoff = WAN_FAILOVER_MAX_BACKOFF * 1000;
+}
@@ -0,0 +1,130 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wan_failover.h
+ *
+ * @brief Header file defining the preference order of the cellular contexts
+ *        and the health tracking used to fail over between them
+ *
+ * Only contexts in the preference list are managed. A context which fails to
+ * connect or drops is held back for a backoff time, doubling with every
+ * failure in a row. While a less preferred context is active, a more
+ * preferred one is tried again as soon as its backoff expired, so the
+ * preferred context is returned to once it recovers.
+ *
+ */
+
+#ifndef _WAN_FAILOVER_H_
+#define _WAN_FAILOVER_H_
+
+#include <glib.h>
+
+/**
+ * Default backoff (in s) after the first failure and the longest backoff,
+ * see the wanFailoverBackoff and wanFailoverMaxBackoff runtime parameters
+ */
+#define WAN_FAILOVER_BACKOFF        10
+#define WAN_FAILOVER_MAX_BACKOFF    600
+
+typedef struct wan_context_health
+{
+	gchar *name;
+	guint failures;             /* Failures in a row */
+	guint total_failures;
+	guint connects;
+	gint64 time_to_ip_ms;       /* Of the last successful connect, -1 if none */
+	gboolean attempting;
+	gint64 attempt_started_ms;
+	gint64 retry_after_ms;      /* Held back until then */
+} wan_context_health_t;
+
+/**
+ * Set the preference list. The health of contexts which stay in the list is
+ * kept.
+ *
+ * @param[IN]  names Names of the contexts, most preferred first, NULL
+ *                   terminated. NULL or empty to disable failover.
+ */
+extern void wan_failover_set_preferences(const gchar *const *names);
+
+/**
+ * Get the contexts in preference order
+ *
+ * @return Array of wan_context_health_t, owned by the module
+ */
+extern const GPtrArray *wan_failover_get_contexts(void);
+
+/**
+ * Get the health of a context in the preference list
+ *
+ * @param[IN]  name Name of the context
+ *
+ * @return Health, NULL if the context isn't in the list
+ */
+extern const wan_context_health_t *wan_failover_get_health(const gchar *name);
+
+/**
+ * Set the backoff times
+ *
+ * @param[IN]  backoff_ms Backoff after the first failure in ms
+ * @param[IN]  max_backoff_ms Longest backoff in ms
+ */
+extern void wan_failover_set_backoff(guint backoff_ms, guint max_backoff_ms);
+
+/**
+ * Record the start of a connect attempt
+ */
+extern void wan_failover_attempt(const gchar *name, gint64 now_ms);
+
+/**
+ * Record a successful connect, which ends the backoff of the context
+ */
+extern void wan_failover_succeeded(const gchar *name, gint64 now_ms);
+
+/**
+ * Record a failed connect or a drop of the context
+ */
+extern void wan_failover_failed(const gchar *name, gint64 now_ms);
+
+/**
+ * Pick the context to connect next
+ *
+ * @param[IN]  active Name of the connected context, NULL if none
+ * @param[IN]  now_ms Monotonic time in ms
+ *
+ * @return Name of the most preferred context before active whose backoff
+ *         expired. NULL if there is none, while an attempt is running or if
+ *         active isn't in the preference list.
+ */
+extern const gchar *wan_failover_next(const gchar *active, gint64 now_ms);
+
+/**
+ * Get the time until wan_failover_next may pick a context
+ *
+ * @param[IN]  active Name of the connected context, NULL if none
+ * @param[IN]  now_ms Monotonic time in ms
+ *
+ * @return Time in ms, -1 if no context will be picked without other events
+ */
+extern gint64 wan_failover_next_retry(const gchar *active, gint64 now_ms);
+
+/**
+ * Forget the preference list and restore the default backoff
+ */
+extern void wan_failover_reset(void);
+
+#endif /* _WAN_FAILOVER_H_ */
@@ -34,16 +34,47 @@
 #include "connectionmanager_service.h"
 #include "logging.h"
 #include "errors.h"
+#include "dbus_call.h"
+#include "wan_failover.h"
+#include "wifi_setting.h"
+#include "runtime_params.h"
 
 static LSHandle *pLsHandle;
 
 extern connman_manager_t *manager;
 extern connman_agent_t *agent;
 
+/* Context which was connected when last checked */
+static gchar *failover_active = NULL;
+/* Context which dropped, set while failing over from it */
+static gchar *failover_lost = NULL;
+static guint failover_timeout = 0;
+
+/* Last switch between contexts, reported in getStatus */
+static struct
+{
+	gchar *from;
+	gchar *to;
+	const gchar *reason;
+	gint64 time;
+} failover_event;
+
+typedef struct failover_attempt
+{
+	gchar *name;
+	gchar *from;
+	const gchar *reason;
+} failover_attempt_t;
+
 static void service_changed_cb(gpointer user_data, const gchar *name,
                                GVariant *value)
 {
 	connectionmanager_send_status_to_subscribers();
+
+	if (!g_strcmp0(name, "State"))
+	{
+		check_wan_failover();
+	}
 }
 
 static void retrieve_wan_context(jvalue_ref context_obj,
@@ -158,6 +189,77 @@ static void append_context(jvalue_ref contexts_obj, connman_service_t *service)
 	jarray_append(contexts_obj, context_obj);
 }
 
+static gint64 failover_now(void)
+{
+	return g_get_monotonic_time() / 1000;
+}
+
+static void append_failover_status(jvalue_ref reply_obj)
+{
+	const GPtrArray *contexts = wan_failover_get_contexts();
+	jvalue_ref failover_obj, contexts_obj;
+	gint64 now = failover_now();
+	guint i;
+
+	if (0 == contexts->len)
+	{
+		return;
+	}
+
+	failover_obj = jobject_create();
+	contexts_obj = jarray_create(NULL);
+
+	for (i = 0; i < contexts->len; i++)
+	{
+		const wan_context_health_t *health = g_ptr_array_index(contexts, i);
+		jvalue_ref context_obj = jobject_create();
+
+		jobject_put(context_obj, J_CSTR_TO_JVAL("name"), jstring_create(health->name));
+		jobject_put(context_obj, J_CSTR_TO_JVAL("failures"),
+		            jnumber_create_i32(health->failures));
+		jobject_put(context_obj, J_CSTR_TO_JVAL("totalFailures"),
+		            jnumber_create_i32(health->total_failures));
+		jobject_put(context_obj, J_CSTR_TO_JVAL("connects"),
+		            jnumber_create_i32(health->connects));
+
+		if (health->time_to_ip_ms >= 0)
+		{
+			jobject_put(context_obj, J_CSTR_TO_JVAL("timeToIp"),
+			            jnumber_create_i64(health->time_to_ip_ms));
+		}
+
+		if (health->retry_after_ms > now)
+		{
+			jobject_put(context_obj, J_CSTR_TO_JVAL("retryIn"),
+			            jnumber_create_i64((health->retry_after_ms - now + 999) / 1000));
+		}
+
+		jarray_append(contexts_obj, context_obj);
+	}
+
+	jobject_put(failover_obj, J_CSTR_TO_JVAL("contexts"), contexts_obj);
+
+	if (NULL != failover_event.to)
+	{
+		jvalue_ref event_obj = jobject_create();
+
+		if (NULL != failover_event.from)
+		{
+			jobject_put(event_obj, J_CSTR_TO_JVAL("from"),
+			            jstring_create(failover_event.from));
+		}
+
+		jobject_put(event_obj, J_CSTR_TO_JVAL("to"), jstring_create(failover_event.to));
+		jobject_put(event_obj, J_CSTR_TO_JVAL("reason"),
+		            jstring_create(failover_event.reason));
+		jobject_put(event_obj, J_CSTR_TO_JVAL("time"),
+		            jnumber_create_i64(failover_event.time));
+		jobject_put(failover_obj, J_CSTR_TO_JVAL("lastEvent"), event_obj);
+	}
+
+	jobject_put(reply_obj, J_CSTR_TO_JVAL("failover"), failover_obj);
+}
+
 void append_wan_status(jvalue_ref reply_obj)
 {
 	GSList *iter;
@@ -198,6 +300,8 @@ void append_wan_status(jvalue_ref reply_obj)
 	jobject_put(reply_obj, J_CSTR_TO_JVAL("connected"), jboolean_create(connected));
 	jobject_put(reply_obj, J_CSTR_TO_JVAL("connectedContexts"),
 	            connected_contexts_obj);
+
+	append_failover_status(reply_obj);
 }
 
 void send_wan_connection_status_to_subscribers()
@@ -281,6 +385,269 @@ void send_wan_contexts_update_to_subscribers()
 	j_release(&reply_obj);
 }
 
+static connman_service_t *find_cellular_service(const gchar *name)
+{
+	GSList *iter;
+
+	for (iter = manager->cellular_services; NULL != iter && NULL != name;
+	        iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *) iter->data;
+
+		if (g_strcmp0(service->name, name) == 0)
+		{
+			return service;
+		}
+	}
+
+	return NULL;
+}
+
+/* Most preferred connected context, first connected one if none is managed */
+static connman_service_t *get_active_context(void)
+{
+	connman_service_t *active = NULL;
+	gint active_index = G_MAXINT;
+	const GPtrArray *contexts = wan_failover_get_contexts();
+	GSList *iter;
+
+	for (iter = manager->cellular_services; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *) iter->data;
+		gint index = G_MAXINT - 1;
+		guint i;
+
+		if (!connman_service_is_connected(service))
+		{
+			continue;
+		}
+
+		for (i = 0; i < contexts->len; i++)
+		{
+			if (!g_strcmp0(((wan_context_health_t *) g_ptr_array_index(contexts,
+			                i))->name, service->name))
+			{
+				index = i;
+				break;
+			}
+		}
+
+		if (index < active_index)
+		{
+			active = service;
+			active_index = index;
+		}
+	}
+
+	return active;
+}
+
+static void set_failover_event(const gchar *from, const gchar *to,
+                               const gchar *reason)
+{
+	WCALOG_INFO(MSGID_WAN_FAILOVER_INFO, 0, "Switched from context %s to %s (%s)",
+	            NULL != from ? from : "none", to, reason);
+
+	g_free(failover_event.from);
+	g_free(failover_event.to);
+	failover_event.from = g_strdup(from);
+	failover_event.to = g_strdup(to);
+	failover_event.reason = reason;
+	failover_event.time = time(NULL);
+
+	send_wan_connection_status_to_subscribers();
+	connectionmanager_send_status_to_subscribers();
+}
+
+static void set_failover_active(const gchar *name)
+{
+	g_free(failover_active);
+	failover_active = g_strdup(name);
+}
+
+static void clear_failover_lost(void)
+{
+	g_free(failover_lost);
+	failover_lost = NULL;
+}
+
+static gboolean failover_timeout_cb(gpointer user_data)
+{
+	failover_timeout = 0;
+	check_wan_failover();
+
+	return FALSE;
+}
+
+static void failover_connect_callback(gboolean success, gpointer user_data)
+{
+	failover_attempt_t *attempt = user_data;
+	connman_service_t *service = find_cellular_service(attempt->name);
+
+	if (success && NULL != service)
+	{
+		wan_failover_succeeded(attempt->name, failover_now());
+		connman_service_register_property_changed_cb(service, service_changed_cb);
+
+		/* Set before the old context goes down so it isn't taken as lost */
+		set_failover_active(attempt->name);
+		clear_failover_lost();
+		set_failover_event(attempt->from, attempt->name, attempt->reason);
+
+		/* Leave the less preferred context once the preferred one is back */
+		service = find_cellular_service(attempt->from);
+
+		if (NULL != service && connman_service_is_connected(service))
+		{
+			WCALOG_INFO(MSGID_WAN_DISCONNECT_INFO, 0,
+			            "Disconnecting from cellular service %s", service->name);
+			connman_service_disconnect(service);
+		}
+	}
+	else
+	{
+		WCALOG_ERROR(MSGID_WAN_FAILOVER_ERROR, 0, "Failed to connect context %s",
+		             attempt->name);
+		wan_failover_failed(attempt->name, failover_now());
+		send_wan_connection_status_to_subscribers();
+	}
+
+	g_free(attempt->name);
+	g_free(attempt->from);
+	g_free(attempt);
+
+	check_wan_failover();
+}
+
+static gboolean start_failover_attempt(connman_service_t *service,
+                                       connman_service_t *active)
+{
+	failover_attempt_t *attempt = g_new0(failover_attempt_t, 1);
+
+	attempt->name = g_strdup(service->name);
+
+	if (NULL != active)
+	{
+		attempt->from = g_strdup(active->name);
+		attempt->reason = "returnToPreferred";
+	}
+	else
+	{
+		attempt->from = g_strdup(failover_lost);
+		attempt->reason = "failover";
+	}
+
+	WCALOG_INFO(MSGID_WAN_CONNECT_INFO, 0, "Connecting to cellular service %s (%s)",
+	            service->name, attempt->reason);
+
+	wan_failover_attempt(service->name, failover_now());
+
+	if (!connman_service_connect(service, NULL, failover_connect_callback, attempt))
+	{
+		wan_failover_failed(service->name, failover_now());
+		g_free(attempt->name);
+		g_free(attempt->from);
+		g_free(attempt);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Check the connected context against the preference list and fail over or
+ * return to a more preferred context
+ */
+
+void check_wan_failover(void)
+{
+	connman_service_t *active, *service;
+	const gchar *next;
+	gint64 now = failover_now();
+	gint64 delay;
+
+	if (failover_timeout)
+	{
+		g_source_remove(failover_timeout);
+		failover_timeout = 0;
+	}
+
+	if (NULL == manager)
+	{
+		return;
+	}
+
+	/* Switching WAN off isn't a failure */
+	if (!is_cellular_powered())
+	{
+		set_failover_active(NULL);
+		clear_failover_lost();
+		return;
+	}
+
+	wan_failover_set_backoff(runtime_param_get(RUNTIME_PARAM_WAN_FAILOVER_BACKOFF) *
+	                         1000, runtime_param_get(RUNTIME_PARAM_WAN_FAILOVER_MAX_BACKOFF) * 1000);
+
+	active = get_active_context();
+
+	if (NULL != failover_active && (NULL == active ||
+	                                g_strcmp0(active->name, failover_active)))
+	{
+		service = find_cellular_service(failover_active);
+
+		if (NULL == service || !connman_service_is_connected(service))
+		{
+			WCALOG_INFO(MSGID_WAN_FAILOVER_INFO, 0, "Context %s lost", failover_active);
+			wan_failover_failed(failover_active, now);
+			g_free(failover_lost);
+			failover_lost = failover_active;
+			failover_active = NULL;
+
+			if (NULL != active)
+			{
+				set_failover_event(failover_lost, active->name, "failover");
+			}
+		}
+	}
+
+	if (NULL != active)
+	{
+		set_failover_active(active->name);
+		clear_failover_lost();
+	}
+	else if (NULL == failover_lost)
+	{
+		/* Nothing was lost, connecting is left to the apps */
+		return;
+	}
+
+	if (0 == wan_failover_get_contexts()->len)
+	{
+		return;
+	}
+
+	while (NULL != (next = wan_failover_next(NULL != active ? active->name : NULL,
+	                       now)))
+	{
+		service = find_cellular_service(next);
+
+		if (NULL != service && start_failover_attempt(service, active))
+		{
+			return;
+		}
+
+		/* Not available, hold it back like a failed connect */
+		wan_failover_failed(next, now);
+	}
+
+	delay = wan_failover_next_retry(NULL != active ? active->name : NULL, now);
+
+	if (delay >= 0)
+	{
+		failover_timeout = g_timeout_add(MAX(delay, 1), failover_timeout_cb, NULL);
+	}
+}
+
 static void service_connect_callback(gboolean success, gpointer user_data)
 {
 	luna_service_request_t *service_req = user_data;
@@ -288,14 +655,17 @@ static void service_connect_callback(gboolean success, gpointer user_data)
 
 	if (!success)
 	{
+		wan_failover_failed(service->name, failover_now());
 		LSMessageReplyCustomError(service_req->handle, service_req->message,
 		                          "Failed to connect cellular service", WCA_API_ERROR_FAILED_TO_CONNECT);
 		goto cleanup;
 	}
 
+	wan_failover_succeeded(service->name, failover_now());
 	LSMessageReplySuccess(service_req->handle, service_req->message);
 
 	connman_service_register_property_changed_cb(service, service_changed_cb);
+	check_wan_failover();
 
 cleanup:
 	luna_service_request_free(service_req);
@@ -336,8 +706,10 @@ static void connect_wan_service(const char *name,
 	}
 
 	service_req->user_data = service;
+	wan_failover_attempt(service->name, failover_now());
 
-	if (!connman_service_connect(service, service_connect_callback, service_req))
+	if (!connman_service_connect(service, service_req->cancellable,
+	                             service_connect_callback, service_req))
 	{
 		LSMessageReplyErrorUnknown(service_req->handle, service_req->message);
 		goto cleanup;
@@ -384,6 +756,14 @@ static void disconnect_wan_service(const char *name, LSHandle *handle,
 		return;
 	}
 
+	/* Disconnected on request, not lost */
+	if (!g_strcmp0(failover_active, service->name))
+	{
+		set_failover_active(NULL);
+	}
+
+	clear_failover_lost();
+
 	if (!connman_service_disconnect(service))
 	{
 		LSMessageReplyErrorUnknown(handle, message);
@@ -410,6 +790,7 @@ static void technology_property_changed_callback(gpointer data,
 	{
 		send_wan_connection_status_to_subscribers();
 		connectionmanager_send_status_to_subscribers();
+		check_wan_failover();
 	}
 }
 
@@ -896,6 +1277,84 @@ cleanup:
 	return true;
 }
 
+/**
+ * @brief  Set the preference order of the contexts. When the connected context
+ *         drops the next healthy context in the list is connected, and the
+ *         most preferred context is returned to once it recovers. Failing
+ *         contexts are held back for a backoff time which doubles with every
+ *         failure in a row. Only contexts in the list are managed, an empty
+ *         list disables the failover.
+ *
+ * @param contexts Names of the contexts, most preferred first
+ */
+
+static bool handle_set_context_preferences_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	if (!connman_status_check(manager, sh, message))
+	{
+		return true;
+	}
+
+	if (!cellular_technology_status_check(sh, message))
+	{
+		return true;
+	}
+
+	// To prevent memory leaks, schema should be checked before the variables will be initialized.
+	jvalue_ref parsed_obj = 0;
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(ARRAY(contexts, string))
+	                                     REQUIRED_1(contexts))), &parsed_obj))
+	{
+		return true;
+	}
+
+	GStrv names = NULL;
+	jvalue_ref contexts_obj = 0;
+
+	if (jobject_get_exists(parsed_obj, J_CSTR_TO_BUF("contexts"), &contexts_obj))
+	{
+		int i, contexts_arrsize = jarray_size(contexts_obj);
+		names = (GStrv) g_new0(gchar *, contexts_arrsize + 1);
+
+		for (i = 0; i < contexts_arrsize; i++)
+		{
+			raw_buffer name_buf = jstring_get(jarray_get(contexts_obj, i));
+			names[i] = g_strdup(name_buf.m_str);
+			jstring_free_buffer(name_buf);
+
+			if (strlen(names[i]) == 0)
+			{
+				LSMessageReplyErrorInvalidParams(sh, message);
+				goto cleanup;
+			}
+		}
+	}
+
+	wan_failover_set_preferences((const gchar * const *) names);
+	store_wifi_setting(WIFI_WAN_PREFERENCES_SETTING, NULL);
+
+	WCALOG_INFO(MSGID_WAN_FAILOVER_INFO, 0, "Context preferences set to %u contexts",
+	            wan_failover_get_contexts()->len);
+
+	LSMessageReplySuccess(sh, message);
+
+	send_wan_connection_status_to_subscribers();
+	check_wan_failover();
+
+cleanup:
+
+	if (!jis_null(parsed_obj))
+	{
+		j_release(&parsed_obj);
+	}
+
+	g_strfreev(names);
+
+	return true;
+}
+
 static LSMethod wan_methods[] =
 {
 	{ LUNA_METHOD_WAN_CONNECT,       handle_wan_connect_command },
@@ -904,9 +1363,20 @@ static LSMethod wan_methods[] =
 	{ LUNA_METHOD_WAN_GETCONTEXTS,   handle_wan_get_contexts_command },
 	{ LUNA_METHOD_WAN_GETCONTEXT,    handle_wan_get_context_command },
 	{ LUNA_METHOD_WAN_SETHOSTROUTES, handle_set_hostroutes_command },
+	{ LUNA_METHOD_WAN_SETCONTEXTPREFERENCES, handle_set_context_preferences_command },
 	{ },
 };
 
+/**
+ * Cancel the pending connman calls of a luna call the caller has cancelled
+ */
+
+static void handle_luna_call_cancel(LSHandle *sh, LSMessage *message,
+                                    void *ctx)
+{
+	dbus_call_scope_cancel(LSMessageGetUniqueToken(message));
+}
+
 int initialize_wan_ls2_calls(GMainLoop *mainloop, LSHandle **wan_handle)
 {
 	LSError lserror;
@@ -940,6 +1410,16 @@ int initialize_wan_ls2_calls(GMainLoop *mainloop, LSHandle **wan_handle)
 		goto Exit;
 	}
 
+	if (LSSubscriptionSetCancelFunction(pLsHandle, handle_luna_call_cancel, NULL,
+	                                    &lserror) == false)
+	{
+		WCALOG_ERROR(MSGID_WAN_SRVC_REGISTER_FAIL, 0,
+		             "LSSubscriptionSetCancelFunction() returned error");
+		goto Exit;
+	}
+
+	load_wifi_setting(WIFI_WAN_PREFERENCES_SETTING, NULL);
+
 	*wan_handle = pLsHandle;
 
 	return 0;
@@ -993,4 +1473,7 @@ void check_and_initialize_cellular_technology(void)
 
 		connman_service_register_property_changed_cb(service, service_changed_cb);
 	}
+
+	/* Learn the connected context */
+	check_wan_failover();
 }
@@ -29,11 +29,13 @@
 #define LUNA_METHOD_WAN_GETCONTEXTS   "getContexts"
 #define LUNA_METHOD_WAN_GETCONTEXT    "getContext"
 #define LUNA_METHOD_WAN_SETHOSTROUTES "setHostRoutes"
+#define LUNA_METHOD_WAN_SETCONTEXTPREFERENCES "setContextPreferences"
 
 extern void check_and_initialize_cellular_technology(void);
 extern void send_wan_connection_status_to_subscribers(void);
 extern void send_wan_contexts_update_to_subscribers(void);
 extern void append_wan_status(jvalue_ref reply_obj);
+extern void check_wan_failover(void);
 extern int initialize_wan_ls2_calls(GMainLoop *mainloop, LSHandle **wan_handle);
 
 #endif /* _WAN_SERVICE_H_ */
@@ -27,23 +27,20 @@
 #include "wifi_setting.h"
 #include "logging.h"
 
-static GSList *wifi_profile_list = NULL;
 static guint gprofile_id = 777; //! First assigned profile ID
 
 extern gboolean remove_network_config(const char *ssid, const char *security);
 
 /**
- * @brief Search all wifi profiles to match the given profile Id.
+ * @brief Search all visible wifi profiles to match the given profile Id.
  */
 
 wifi_profile_t *get_profile_by_id(guint profile_id)
 {
-	GSList *iter;
+	wifi_profile_t *profile = NULL;
 
-	for (iter = wifi_profile_list; NULL != iter; iter = iter->next)
+	while (NULL != (profile = get_next_profile(profile)))
 	{
-		wifi_profile_t *profile = (wifi_profile_t *)(iter->data);
-
 		if (profile->profile_id == profile_id)
 		{
 			return profile;
@@ -64,12 +61,10 @@ wifi_profile_t *get_profile_by_ssid(gchar *ssid)
 		return NULL;
 	}
 
-	GSList *iter;
+	wifi_profile_t *profile = NULL;
 
-	for (iter = wifi_profile_list; NULL != iter; iter = iter->next)
+	while (NULL != (profile = get_next_profile(profile)))
 	{
-		wifi_profile_t *profile = (wifi_profile_t *)(iter->data);
-
 		if (!g_strcmp0(profile->ssid, ssid))
 		{
 			return profile;
@@ -79,6 +74,30 @@ wifi_profile_t *get_profile_by_ssid(gchar *ssid)
 	return NULL;
 }
 
+static gboolean profile_matches(wifi_profile_t *profile, gchar *ssid,
+                                gchar *security)
+{
+	int n = 0;
+
+	if (g_strcmp0(profile->ssid, ssid))
+	{
+		return FALSE;
+	}
+
+	if (profile->security == NULL)
+	{
+		return TRUE;
+	}
+
+	for (n = 0; n < g_strv_length(profile->security); n++)
+		if (!g_strcmp0(profile->security[n], security))
+		{
+			return TRUE;
+		}
+
+	return FALSE;
+}
+
 /**
  * @brief Lookup wifi profile with given ssid and security
  */
@@ -90,27 +109,40 @@ wifi_profile_t *get_profile_by_ssid_security(gchar *ssid,  gchar *security)
 		return NULL;
 	}
 
+	wifi_profile_t *profile = NULL;
+
+	while (NULL != (profile = get_next_profile(profile)))
+	{
+		if (profile_matches(profile, ssid, security))
+		{
+			return profile;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * @brief Lookup wifi profile with given ssid and security in the given namespace
+ * only, whether it is visible or not
+ */
+
+wifi_profile_t *get_profile_by_ssid_security_in_namespace(
+    const gchar *namespace_name, gchar *ssid, gchar *security)
+{
+	profile_namespace_t *ns = profile_namespace_lookup(namespace_name);
 	GSList *iter;
-	int n = 0;
 
-	for (iter = wifi_profile_list; NULL != iter; iter = iter->next)
+	if (NULL == ns || NULL == ssid)
 	{
-		wifi_profile_t *profile = (wifi_profile_t *)(iter->data);
+		return NULL;
+	}
 
-		if (!g_strcmp0(profile->ssid, ssid))
+	for (iter = ns->profiles; NULL != iter; iter = iter->next)
+	{
+		if (profile_matches(iter->data, ssid, security))
 		{
-			if (profile->security != NULL)
-			{
-				for (n = 0; n < g_strv_length(profile->security); n++)
-					if (!g_strcmp0(profile->security[n], security))
-					{
-						return profile;
-					}
-			}
-			else
-			{
-				return profile;
-			}
+			return iter->data;
 		}
 	}
 
@@ -118,7 +150,7 @@ wifi_profile_t *get_profile_by_ssid_security(gchar *ssid,  gchar *security)
 }
 
 /**
- * @brief Create a new profile
+ * @brief Create a new profile in the active namespace
  *
  * For open networks we only need to add its ssid and generate a profile ID
  * However more fields to be added when supporting secured wifi networks.
@@ -126,12 +158,25 @@ wifi_profile_t *get_profile_by_ssid_security(gchar *ssid,  gchar *security)
 wifi_profile_t *create_new_profile(gchar *ssid, GStrv security, gboolean hidden,
                                    gboolean configured)
 {
-	if (NULL == ssid)
+	return create_new_profile_in_namespace(ssid, security, hidden, configured,
+	                                       profile_namespace_get_active()->name);
+}
+
+/**
+ * @brief Create a new profile in the given namespace, creating the namespace
+ * if needed
+ */
+wifi_profile_t *create_new_profile_in_namespace(gchar *ssid, GStrv security,
+        gboolean hidden, gboolean configured, const gchar *namespace_name)
+{
+	profile_namespace_t *ns = profile_namespace_ensure(namespace_name);
+
+	if (NULL == ssid || NULL == ns)
 	{
 		return NULL;
 	}
 
-	WCALOG_DEBUG("Create profile %s", ssid);
+	WCALOG_DEBUG("Create profile %s in namespace %s", ssid, ns->name);
 
 	wifi_profile_t *new_profile = g_new0(wifi_profile_t, 1);
 
@@ -158,7 +203,7 @@ wifi_profile_t *create_new_profile(gchar *ssid, GStrv security, gboolean hidden,
 		new_profile->security[num_elems] = NULL;
 	}
 
-	wifi_profile_list = g_slist_append(wifi_profile_list, (gpointer)new_profile);
+	ns->profiles = g_slist_append(ns->profiles, (gpointer)new_profile);
 	/* Store wifi profiles */
 	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
 
@@ -177,19 +222,25 @@ void delete_profile(wifi_profile_t *profile)
 	}
 
 	/* Delete the link from the list */
-	GSList *node = g_slist_find(wifi_profile_list, profile);
+	profile_namespace_t *ns = profile_namespace_find(profile);
 
-	if (NULL != node)
+	if (NULL != ns)
 	{
-		wifi_profile_list = g_slist_delete_link(wifi_profile_list,
-		                                        g_slist_find(wifi_profile_list, profile));
+		ns->profiles = g_slist_remove(ns->profiles, profile);
 	}
 
 	WCALOG_DEBUG("Delete profile %s", profile->ssid);
 
 	if (profile->configured)
 	{
-		remove_network_config(profile->ssid, profile->security[0]);
+		if (NULL == ns || profile_namespace_is_visible(ns))
+		{
+			remove_network_config(profile->ssid, profile->security[0]);
+		}
+		else
+		{
+			remove_stashed_network_config(ns->name, profile->ssid, profile->security[0]);
+		}
 	}
 
 	g_free(profile->ssid);
@@ -200,17 +251,16 @@ void delete_profile(wifi_profile_t *profile)
 }
 
 /**
- * @brief Delete all profiles but not the one specified with the supplied ID
+ * @brief Delete all visible profiles but not the one specified with the supplied ID
  * @param id ID of the profile not to delete
  */
 void delete_all_profiles_except_one(guint id)
 {
 	GSList *iter, *delete_profiles = NULL;
+	wifi_profile_t *profile = NULL;
 
-	for (iter = wifi_profile_list; NULL != iter; iter = iter->next)
+	while (NULL != (profile = get_next_profile(profile)))
 	{
-		wifi_profile_t *profile = (wifi_profile_t *)(iter->data);
-
 		if (profile->profile_id != id)
 		{
 			delete_profiles = g_slist_prepend(delete_profiles, (gpointer) profile);
@@ -227,46 +277,26 @@ void delete_all_profiles_except_one(guint id)
 }
 
 /**
- * @brief Return TRUE if profile list is empty
+ * @brief Return TRUE if there are no visible profiles
  */
 
 gboolean profile_list_is_empty(void)
 {
-	return (0 == g_slist_length(wifi_profile_list));
+	return (NULL == get_next_profile(NULL));
 }
 
 /**
- * @brief Traverse the profile list and get the one after the supplied profile
+ * @brief Traverse the visible profiles and get the one after the supplied profile
  */
 
 wifi_profile_t *get_next_profile(wifi_profile_t *curr_profile)
 {
 	// Return first profile (if present), if NULL argument is passed
-	if (NULL == curr_profile)
-	{
-		if (NULL != wifi_profile_list)
-		{
-			return (wifi_profile_t *)(wifi_profile_list->data);
-		}
-		else
-		{
-			return NULL;
-		}
-	}
-
-	GSList *node = g_slist_find(wifi_profile_list, curr_profile);
-
-	if (node != NULL && node->next != NULL)
-	{
-		wifi_profile_t *profile = (wifi_profile_t *)(node->next->data);
-		return profile;
-	}
-
-	return NULL;
+	return (wifi_profile_t *) profile_namespace_next_visible(curr_profile);
 }
 
 /**
- * @brief Move the supplied profile to top of the list
+ * @brief Move the supplied profile to top of the list of its namespace
  * This is useful to prioritize a profile to be the first one in the list
  */
 
@@ -277,26 +307,159 @@ void move_profile_to_head(wifi_profile_t *profile)
 		return;
 	}
 
-	GSList *node = g_slist_find(wifi_profile_list, profile);
+	profile_namespace_t *ns = profile_namespace_find(profile);
 
-	if (NULL != node)
+	if (NULL != ns)
 	{
 		/* If the given profile is already the head, return */
-		if (node == wifi_profile_list)
+		if (ns->profiles->data == profile)
 		{
 			return;
 		}
 
 		/* Delete the link from the list */
-		wifi_profile_list = g_slist_delete_link(wifi_profile_list,
-		                                        g_slist_find(wifi_profile_list, profile));
+		ns->profiles = g_slist_remove(ns->profiles, profile);
 		/* Then add it to start of the list */
-		wifi_profile_list = g_slist_prepend(wifi_profile_list, profile);
+		ns->profiles = g_slist_prepend(ns->profiles, profile);
 	}
 
 	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
 }
 
+/**
+ * @brief Check if the profiles of a namespace are visible, i.e. it is the
+ * active or the device namespace
+ */
+
+gboolean profile_namespace_is_visible(profile_namespace_t *ns)
+{
+	return ns == profile_namespace_get_active() ||
+	       ns == profile_namespace_get_device();
+}
+
+static gchar *profile_config_key(gpointer data)
+{
+	wifi_profile_t *profile = data;
+
+	if (!profile->configured || NULL == profile->security)
+	{
+		return NULL;
+	}
+
+	return build_config_name(profile->ssid, profile->security[0]);
+}
+
+/**
+ * @brief Make a namespace the active one, creating it if needed
+ *
+ * All namespaces are loaded, so this only swaps the visible profiles and the
+ * connman .config files which differ between the two namespaces.
+ */
+
+gboolean set_active_profile_namespace(const gchar *namespace_name)
+{
+	profile_namespace_t *from = profile_namespace_get_active();
+	profile_namespace_t *to = profile_namespace_ensure(namespace_name);
+	GSList *stash, *restore, *both;
+
+	if (NULL == to)
+	{
+		return FALSE;
+	}
+
+	if (from == to)
+	{
+		return TRUE;
+	}
+
+	profile_namespace_diff(from, to, profile_config_key, &stash, &restore, &both);
+	swap_network_configs(from->name, to->name, stash, restore, both);
+
+	WCALOG_INFO(MSGID_WIFI_PROFILE_NAMESPACE, 2, PMLOGKS("From", from->name),
+	            PMLOGKS("To", to->name), "stashed %u, restored %u, swapped %u",
+	            g_slist_length(stash), g_slist_length(restore), g_slist_length(both));
+
+	g_slist_free_full(stash, g_free);
+	g_slist_free_full(restore, g_free);
+	g_slist_free_full(both, g_free);
+
+	profile_namespace_set_active(to);
+	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+
+	return TRUE;
+}
+
+/**
+ * @brief Delete a namespace and all of its profiles. If it is the active
+ * namespace, the device namespace becomes active first.
+ */
+
+gboolean delete_profile_namespace(const gchar *namespace_name)
+{
+	profile_namespace_t *ns = profile_namespace_lookup(namespace_name);
+
+	if (NULL == ns || ns == profile_namespace_get_device())
+	{
+		return FALSE;
+	}
+
+	if (ns == profile_namespace_get_active())
+	{
+		set_active_profile_namespace(PROFILE_NAMESPACE_DEVICE);
+	}
+
+	while (NULL != ns->profiles)
+	{
+		delete_profile(ns->profiles->data);
+	}
+
+	profile_namespace_remove(ns);
+	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+
+	return TRUE;
+}
+
+/**
+ * @brief Move a profile to another namespace, e.g. to share it with all users
+ * through the device namespace
+ */
+
+gboolean move_profile_to_namespace(wifi_profile_t *profile,
+                                   const gchar *namespace_name)
+{
+	profile_namespace_t *from = profile_namespace_find(profile);
+	profile_namespace_t *to = profile_namespace_ensure(namespace_name);
+
+	if (NULL == from || NULL == to)
+	{
+		return FALSE;
+	}
+
+	if (from == to)
+	{
+		return TRUE;
+	}
+
+	if (NULL != get_profile_by_ssid_security_in_namespace(to->name, profile->ssid,
+	        NULL != profile->security ? profile->security[0] : NULL))
+	{
+		return FALSE;
+	}
+
+	if (profile->configured && NULL != profile->security)
+	{
+		move_network_config(profile->ssid, profile->security[0],
+		                    profile_namespace_is_visible(from) ? NULL : from->name,
+		                    profile_namespace_is_visible(to) ? NULL : to->name);
+	}
+
+	from->profiles = g_slist_remove(from->profiles, profile);
+	to->profiles = g_slist_prepend(to->profiles, profile);
+	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+
+	return TRUE;
+}
+
 /**
  * @brief Load the stored wifi profiles (from luna-prefs)
  */
@@ -306,5 +469,3 @@ void init_wifi_profile_list(void)
 	load_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
 	return;
 }
-
-
@@ -25,6 +25,9 @@
 
 #include <glib-object.h>
 
+#include "profile_namespace.h"
+#include "band_steering.h"
+
 typedef struct wifi_profile
 {
 	guint profile_id;
@@ -32,6 +35,8 @@ typedef struct wifi_profile
 	gboolean hidden;
 	GStrv security;
 	gboolean configured;
+	band_preference_t band_preference;
+	gint priority;              /* Autoconnect priority, higher is preferred, 0 if none */
 } wifi_profile_t;
 
 extern void init_wifi_profile_list(void);
@@ -46,5 +51,15 @@ extern void delete_all_profiles_except_one(guint id);
 extern gboolean profile_list_is_empty(void);
 extern wifi_profile_t *get_next_profile(wifi_profile_t *curr_profile);
 extern void move_profile_to_head(wifi_profile_t *new_head);
+extern wifi_profile_t *get_profile_by_ssid_security_in_namespace(
+    const gchar *namespace_name, gchar *ssid, gchar *security);
+extern wifi_profile_t *create_new_profile_in_namespace(gchar *ssid,
+        GStrv security, gboolean hidden, gboolean configured,
+        const gchar *namespace_name);
+extern gboolean profile_namespace_is_visible(profile_namespace_t *ns);
+extern gboolean set_active_profile_namespace(const gchar *namespace_name);
+extern gboolean delete_profile_namespace(const gchar *namespace_name);
+extern gboolean move_profile_to_namespace(wifi_profile_t *profile,
+        const gchar *namespace_name);
 
 #endif /* _WIFI_PROFILE_H_ */
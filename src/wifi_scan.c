@@ -24,8 +24,7 @@
 #include "wifi_scan.h"
 #include "logging.h"
 #include "utils.h"
-
-#define MIN_SCAN_INTERVAL 1000
+#include "runtime_params.h"
 
 typedef struct scan_subscriber_data
 {
@@ -270,7 +269,8 @@ gboolean wifi_scan_add_interval(const char* source, guint interval_ms)
 		                                         scan_timeout_cb, NULL, NULL);
 	}
 
-	if (scan_time == 0 || cur_time > scan_time + MIN_SCAN_INTERVAL)
+	if (scan_time == 0 ||
+	        cur_time > scan_time + runtime_param_get(RUNTIME_PARAM_SCAN_MIN_INTERVAL))
 	{
 		return wifi_scan_now();
 	}
@@ -41,6 +41,7 @@ errorText | Yes | String | Error description
 #include <glib.h>
 #include <stdbool.h>
 #include <string.h>
+#include <netinet/in.h>
 #include <pbnjson.h>
 
 #include <wca-support.h>
@@ -51,6 +52,7 @@ errorText | Yes | String | Error description
 #include "wifi_scan.h"
 #include "connman_manager.h"
 #include "connman_agent.h"
+#include "connman_liveness.h"
 #include "lunaservice_utils.h"
 #include "utils.h"
 #include "common.h"
@@ -61,6 +63,19 @@ errorText | Yes | String | Error description
 #include "pan_service.h"
 #include "errors.h"
 #include "nyx.h"
+#include "runtime_params.h"
+#include "cert_store.h"
+#include "dbus_call.h"
+#include "wowlan.h"
+#include "wowlan_nl80211.h"
+#include "passpoint.h"
+#include "passpoint_nl80211.h"
+#include "regulatory.h"
+#include "regulatory_nl80211.h"
+#include "nl80211_utils.h"
+#include "supplicant_roam.h"
+#include "autoconnect_priority.h"
+#include "wifi_tethering_acl.h"
 
 /* Range for converting signal strength to signal bars */
 #define MID_SIGNAL_RANGE_LOW    55
@@ -75,11 +90,23 @@ static LSHandle *pLsHandle;
 
 connman_manager_t *manager = NULL;
 connman_agent_t *agent = NULL;
+static connman_liveness_t *liveness = NULL;
+static guint liveness_reattach_source = 0;
 
 /* Default scan interval. Used if no interval specified. */
 static gint findnetworks_default_scan_interval = WIFI_DEFAULT_SCAN_INTERVAL;
 
 static guint signal_polling_timeout_source = 0;
+static guint signal_polling_interval = 0;
+
+/* Imported certificates are checked for expiry once a day */
+#define CERT_EXPIRY_CHECK_INTERVAL  (24 * 60 * 60)
+#define CERT_DAY                    (24 * 60 * 60)
+
+/* Signals of the sleep daemon around a suspend */
+#define POWER_SIGNAL_CATEGORY           "/com/palm/power"
+#define POWER_SIGNAL_PREPARE_SUSPEND    "prepareSuspend"
+#define POWER_SIGNAL_RESUME             "resume"
 
 static char* wifi_getstatus_prev_response = NULL;
 
@@ -93,6 +120,46 @@ typedef struct current_service_data
 
 static gboolean check_wifi_services_for_updates(void);
 
+/* Scan results are dumped once per scan, at most this often (s) */
+#define SCAN_RESULTS_INTERVAL 10
+
+static void read_scan_results(void);
+
+static gint64 scan_results_last_read = 0;
+
+/* Ranked passpoint_bss_t of the last scan */
+static GList *passpoint_matches = NULL;
+
+/* Country last applied by the inference */
+static gchar *regulatory_applied_code = NULL;
+
+/* No roam for this long after a roam (s) */
+#define BAND_STEERING_HOLDOFF 30
+
+static void check_band_steering(void);
+
+static gint64 band_steering_last_roam = 0;
+/* Service disconnected for want of a BSS in its required band */
+static gchar *band_steering_parked_path = NULL;
+
+/* The associated BSS is looked up again after this long (s) */
+#define ASSOCIATED_BSS_REFRESH 10
+
+/* BSS the connected service is associated with, taken from the scan results
+ * or looked up by check_band_steering() so that building the status doesn't
+ * query nl80211 */
+static gchar *associated_bss_path = NULL;
+static gchar associated_bssid[18];
+static gint associated_frequency = 0;
+static gint64 associated_bss_time = 0;
+
+/* Connections requested over luna are left alone for this long (s) */
+#define AUTOCONNECT_USER_HOLDOFF 300
+
+static void check_autoconnect_priority(void);
+
+static gint64 autoconnect_user_connect_time = G_MININT64 / 2;
+
 connection_settings_t *connection_settings_new(void)
 {
 	connection_settings_t *settings = NULL;
@@ -102,7 +169,7 @@ connection_settings_t *connection_settings_new(void)
 	return settings;
 }
 
-static void connection_settings_free(connection_settings_t *settings)
+void connection_settings_free(connection_settings_t *settings)
 {
 	g_free(settings->passkey);
 	g_free(settings->ssid);
@@ -277,6 +344,17 @@ static void add_connected_network_status(jvalue_ref *reply,
 	jobject_put(network_info, J_CSTR_TO_JVAL("signalLevel"),
 	            jnumber_create_i32(connected_service->strength));
 
+	if (!g_strcmp0(associated_bss_path, connected_service->path))
+	{
+		jobject_put(network_info, J_CSTR_TO_JVAL("bssid"),
+		            jstring_create(associated_bssid));
+		jobject_put(network_info, J_CSTR_TO_JVAL("frequency"),
+		            jnumber_create_i32(associated_frequency));
+		jobject_put(network_info, J_CSTR_TO_JVAL("band"),
+		            jstring_create(wifi_band_to_string(wifi_band_from_frequency(
+		                               associated_frequency))));
+	}
+
 	jobject_put(*reply,  J_CSTR_TO_JVAL("networkInfo"), network_info);
 
 	/* Fill in ip information only for a service which is online (fully connected) */
@@ -627,7 +705,8 @@ static void handle_failed_connection_request(gpointer user_data)
 		// so in case the connection fails, we should delete the profile and the corresponding config file
 		// Give it 2 sec for service to auto-connect
 		char* service_name = g_strdup(service->path);
-		g_timeout_add_seconds(5, delete_profile_if_not_connected, service_name);
+		g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_PROFILE_DELETE_DELAY),
+		                      delete_profile_if_not_connected, service_name);
 	}
 
 #ifndef ENABLE_SINGLE_PROFILE
@@ -1219,7 +1298,8 @@ static void service_connect_callback(gboolean success, gpointer user_data)
 	 * it's state to failure until we report the failed connection request to the user */
 	if (!success)
 	{
-		g_timeout_add_seconds(2, handle_failed_connection_request, NULL);
+		g_timeout_add_seconds(runtime_param_get(RUNTIME_PARAM_CONNECT_FAILURE_DELAY),
+		                      handle_failed_connection_request, NULL);
 		return;
 	}
 
@@ -1268,7 +1348,8 @@ void connect_after_scan_cb(gpointer user_data)
 		goto error;
 	}
 
-	if (!connman_service_connect(service, service_connect_callback, NULL))
+	if (!connman_service_connect(service, current_connect_req->cancellable,
+	                             service_connect_callback, NULL))
 	{
 		LSMessageReplyErrorUnknown(current_connect_req->handle,
 		                           current_connect_req->message);
@@ -1285,6 +1366,66 @@ cleanup:
 	current_connect_req_free();
 }
 
+/**
+ *  @brief Reply with the luna error matching a certificate store error
+ */
+
+static void reply_cert_store_error(LSHandle *sh, LSMessage *message,
+                                   const GError *error)
+{
+	int code;
+
+	switch (error->code)
+	{
+		case CERT_STORE_ERROR_NOT_FOUND:
+			code = WCA_API_ERROR_CERTIFICATE_NOT_FOUND;
+			break;
+
+		case CERT_STORE_ERROR_EXPIRED:
+		case CERT_STORE_ERROR_NOT_YET_VALID:
+			code = WCA_API_ERROR_CERTIFICATE_EXPIRED;
+			break;
+
+		case CERT_STORE_ERROR_UNTRUSTED:
+			code = WCA_API_ERROR_CERTIFICATE_UNTRUSTED;
+			break;
+
+		case CERT_STORE_ERROR_PARSE:
+		case CERT_STORE_ERROR_INVALID_NAME:
+			code = WCA_API_ERROR_CERTIFICATE_INVALID;
+			break;
+
+		default:
+			LSMessageReplyErrorUnknown(sh, message);
+			return;
+	}
+
+	LSMessageReplyCustomError(sh, message, error->message, code);
+}
+
+/**
+ *  @brief Check the certificates of an enterprise network before connecting,
+ *  so a missing or expired one is reported right away instead of after a
+ *  failed EAP attempt (see header for API details)
+ */
+
+gboolean check_enterprise_certificates(LSHandle *sh,
+        LSMessage *message, const gchar *ca_cert_file, const gchar *client_cert_file)
+{
+	GError *error = NULL;
+
+	if (cert_store_validate(ca_cert_file, client_cert_file,
+	                        g_get_real_time() / G_USEC_PER_SEC, &error))
+	{
+		return TRUE;
+	}
+
+	WCALOG_ERROR(MSGID_WIFI_CERT_INVALID, 0, "%s", error->message);
+	reply_cert_store_error(sh, message, error);
+	g_error_free(error);
+	return FALSE;
+}
+
 /**
  *  @brief Connect to a access point with the given ssid
  *
@@ -1320,7 +1461,7 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 	gboolean found_service = FALSE;
 	connection_settings_t *settings = NULL;
 	connman_service_t *service = NULL;
-	bool hidden = false, store_profile = false;
+	bool hidden = false, store_profile = false, has_security = false;
 	gchar *security = NULL;
 	connman_technology_t *wifi_tech = connman_manager_find_wifi_technology(manager);
 
@@ -1350,7 +1491,10 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 		jboolean_get(store_profile_obj, &store_profile);
 	}
 
-	if (jobject_get_exists(req_object, J_CSTR_TO_BUF("security"), &security_obj))
+	has_security = jobject_get_exists(req_object, J_CSTR_TO_BUF("security"),
+	                                  &security_obj);
+
+	if (has_security)
 	{
 		if (jobject_get_exists(security_obj, J_CSTR_TO_BUF("securityType"), &type_obj))
 		{
@@ -1458,6 +1602,26 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 	}
 
 
+	/* Connecting with a stored enterprise profile, its .config has the certificates */
+	if (!has_security && NULL != profile &&
+	        !g_strcmp0(security, WIFI_ENTERPRISE_SECURITY_TYPE))
+	{
+		gchar *ca_cert_file = NULL, *client_cert_file = NULL;
+		gboolean valid;
+
+		get_network_config_cert_files(ssid, security, &ca_cert_file,
+		                              &client_cert_file);
+		valid = check_enterprise_certificates(service_req->handle,
+		                                      service_req->message, ca_cert_file, client_cert_file);
+		g_free(client_cert_file);
+		g_free(ca_cert_file);
+
+		if (!valid)
+		{
+			goto cleanup;
+		}
+	}
+
 	if (jobject_get_exists(req_object, J_CSTR_TO_BUF("security"), &security_obj))
 	{
 		settings = connection_settings_new();
@@ -1578,6 +1742,12 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 				                          "This option is not implemented", WCA_API_ERROR_NOT_IMPLEMENTED);
 				goto cleanup;
 			}
+
+			if (!check_enterprise_certificates(service_req->handle, service_req->message,
+			                                   settings->ca_cert_file, settings->client_cert_file))
+			{
+				goto cleanup;
+			}
 		}
 		else if (jobject_get_exists(security_obj, J_CSTR_TO_BUF("wps"), &wps_obj))
 		{
@@ -1674,6 +1844,7 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 	service_req->user_data = service_data;
 
 	current_connect_req = service_req;
+	autoconnect_user_connect_time = g_get_monotonic_time();
 
 	/* If we're going to connect to a hidden network and a scan is already running we
 	 * have to wait until the scan has finished as connman needs to issue another one
@@ -1683,8 +1854,8 @@ static void connect_wifi_with_ssid(const char *ssid, wifi_profile_t *profile,
 	{
 		wifi_scan_execute_when_scan_done(connect_after_scan_cb, NULL);
 	}
-	else if (!connman_service_connect(service, service_connect_callback,
-	                                  service_req))
+	else if (!connman_service_connect(service, service_req->cancellable,
+	                                  service_connect_callback, service_req))
 	{
 		current_connect_req = NULL;
 		LSMessageReplyErrorUnknown(service_req->handle, service_req->message);
@@ -1786,6 +1957,10 @@ static void manager_services_changed_callback(gpointer data,
 		/* We processed the update for the changed wifi networks so mark them as unchanged
 		 * again */
 		mark_all_wifi_services_as_unchanged();
+
+		read_scan_results();
+		check_band_steering();
+		check_autoconnect_priority();
 	}
 
 	if (service_type & ETHERNET_SERVICES_CHANGED)
@@ -1798,14 +1973,36 @@ static void manager_services_changed_callback(gpointer data,
 		connectionmanager_send_status_to_subscribers();
 		send_wan_connection_status_to_subscribers();
 		send_wan_contexts_update_to_subscribers();
+		check_wan_failover();
+	}
+
+	if (service_type & P2P_SERVICES_CHANGED)
+	{
+		connectionmanager_send_status_to_subscribers();
+		connectionmanager_update_p2p_group_cache();
 	}
 
 	if (service_type & BLUETOOTH_SERVICES_CHANGED)
 	{
 		connectionmanager_send_status_to_subscribers();
+		check_pan_reconnect();
 	}
 }
 
+/**
+ *  @brief Callback function registered with connman manager whenever a P2P
+ *  group is added or removed
+ *
+ *  @param data
+ *  @param added
+ */
+
+static void manager_groups_changed_callback(gpointer data, gboolean added)
+{
+	/* The group of a peer may show up after the peer is connected */
+	connectionmanager_update_p2p_group_cache();
+}
+
 void send_getnetworks_status_to_subscribers()
 {
 	jvalue_ref getNetworks_reply = jobject_create();
@@ -2151,6 +2348,17 @@ static gboolean signal_polling_cb(gpointer user_data)
 		}
 	}
 
+	guint interval = runtime_param_get(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL);
+
+	/* Re-arm the timer if the polling interval was changed meanwhile */
+	if (interval != signal_polling_interval)
+	{
+		signal_polling_interval = interval;
+		signal_polling_timeout_source = g_timeout_add_seconds(interval,
+		                                signal_polling_cb, NULL);
+		return FALSE;
+	}
+
 	return TRUE;
 }
 
@@ -2171,8 +2379,9 @@ static void start_signal_polling()
 
 	if (!wifi_technology->diagnostic_info && 0 == signal_polling_timeout_source)
 	{
-		signal_polling_timeout_source = g_timeout_add_seconds(3, signal_polling_cb,
-		                                NULL);
+		signal_polling_interval = runtime_param_get(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL);
+		signal_polling_timeout_source = g_timeout_add_seconds(signal_polling_interval,
+		                                signal_polling_cb, NULL);
 	}
 }
 
@@ -3066,6 +3275,9 @@ ssid | Yes | String | SSID of AP
 connectState | Yes | String | One of {notAssociated, associating, associated, ipConfigured, ipFailed}
 signalBars | Yes | Integer | Coarse indication of signal strength (1..3)
 signalLevel | Yes | Integer | Absolute indication of signal strength
+bssid | No | String | BSSID of the access point, absent until associated
+frequency | No | Integer | Frequency of the access point in MHz, absent until associated
+band | No | String | Band of the access point, "2.4GHz", "5GHz" or "6GHz", absent until associated
 ipInfo | Yes | Object | See below
 
 @par "ipInfo" Object
@@ -3167,6 +3379,33 @@ static void add_wifi_profile(jvalue_ref *profile_j, wifi_profile_t *profile)
 		jobject_put(profile_details_j, J_CSTR_TO_JVAL("security"), security);
 	}
 
+	if (0 != profile->priority)
+	{
+		jobject_put(profile_details_j, J_CSTR_TO_JVAL("priority"),
+		            jnumber_create_i32(profile->priority));
+	}
+
+	if (band_preference_is_set(&profile->band_preference))
+	{
+		const band_preference_t *pref = &profile->band_preference;
+		jvalue_ref band_j = jobject_create();
+
+		jobject_put(band_j, J_CSTR_TO_JVAL("band"),
+		            jstring_create(wifi_band_to_string(pref->band)));
+		jobject_put(band_j, J_CSTR_TO_JVAL("required"),
+		            jboolean_create(pref->required));
+		jobject_put(band_j, J_CSTR_TO_JVAL("rssiFloor"),
+		            jnumber_create_i32(0 != pref->rssi_floor ? pref->rssi_floor :
+		                               BAND_STEERING_RSSI_FLOOR));
+
+		if ('\0' != pref->bssid[0])
+		{
+			jobject_put(band_j, J_CSTR_TO_JVAL("bssid"), jstring_create(pref->bssid));
+		}
+
+		jobject_put(profile_details_j, J_CSTR_TO_JVAL("bandPreference"), band_j);
+	}
+
 	jobject_put(*profile_j, J_CSTR_TO_JVAL("wifiProfile"), profile_details_j);
 }
 
@@ -3199,7 +3438,8 @@ static void add_wifi_profile_list(jvalue_ref *reply)
 @{
 @section com_webos_wifi_getprofilelist getprofilelist
 
-Lists all the stored wifi profiles on the system.
+Lists all the stored wifi profiles on the system, which are visible in the
+active profile namespace (see setProfileNamespace).
 
 @Note If the wifi AP is an open network with no security, it
       won't list the "security" field.
@@ -3491,57 +3731,91 @@ cleanup:
 }
 
 
-gint generate_new_wpspin(void)
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_setprofilenamespace setProfileNamespace
+
+Makes a profile namespace the active one, creating it if needed. Each user or
+account of a shared device gets a namespace of its own. Only the profiles of
+the active namespace and those of the shared "device" namespace are visible,
+e.g. in getprofilelist, and new profiles are created in the active namespace.
+
+Switching namespaces doesn't reload the stored profiles. Only the connman
+.config files which differ between the two namespaces are replaced.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+namespace | yes | String | User or account ID, or "device" to only use the shared profiles. Letters, digits and ".-_@" only, at most 64 characters.
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_profile_namespace_command(LSHandle *sh,
+        LSMessage *message, void *context)
 {
-	FILE *f = fopen("/dev/urandom", "rb");
+	jvalue_ref parsedObj = {0};
 
-	if (f == NULL)
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(namespace,
+	                                     string)) REQUIRED_1(namespace))), &parsedObj))
 	{
-		return -1;
+		return true;
 	}
 
-	//Generate 7 random digits
-	gint pin = 0;
-	int count = 0;
+	jvalue_ref namespaceObj = {0};
+	gchar *namespace_name = NULL;
 
-	do
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("namespace"), &namespaceObj))
 	{
-		count = fread(&pin, sizeof(pin), 1, f);
+		raw_buffer namespace_buf = jstring_get(namespaceObj);
+		namespace_name = g_strdup(namespace_buf.m_str);
+		jstring_free_buffer(namespace_buf);
 	}
-	while(count == -1 || pin < 0);
-
-	pin %= 10000000;
-	pin *= 10;
-
-	fclose(f);
-
-	// Append checksum digit in the end
 
-	unsigned int tmppin =  pin / 10;
-	unsigned int accum = 0;
+	if (!profile_namespace_is_valid_name(namespace_name))
+	{
+		LSMessageReplyCustomError(sh, message, "Invalid namespace",
+		                          WCA_API_ERROR_PROFILE_NAMESPACE_INVALID);
+		goto cleanup;
+	}
 
-	while (tmppin)
+	if (!set_active_profile_namespace(namespace_name))
 	{
-		accum += 3 * (tmppin % 10);
-		tmppin /= 10;
-		accum += tmppin % 10;
-		tmppin /= 10;
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
 	}
 
-	pin += ((10 - accum % 10) % 10);
+	LSMessageReplySuccess(sh, message);
+	send_getnetworks_status_to_subscribers();
 
-	return pin;
+cleanup:
+	g_free(namespace_name);
+	j_release(&parsedObj);
+	return true;
 }
 
-
-
 //->Start of API documentation comment block
 /**
 @page com_webos_wifi com.webos.wifi
 @{
-@section com_webos_wifi_createwpspin createwpspin
+@section com_webos_wifi_getprofilenamespaces getProfileNamespaces
 
-Generates an 8 digit random wps pin
+Lists the profile namespaces and which one is active.
 
 @par Parameters
 
@@ -3552,7 +3826,16 @@ None
 Name | Required | Type | Description
 -----|--------|------|----------
 returnValue | yes | Boolean | True
-wpspin | yes | String | 8 digit random wps pin number
+activeNamespace | yes | String | Name of the active namespace
+namespaces | yes | Array of Object | Array of namespace objects
+
+@par "namespace" Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+name | yes | String | Name of the namespace
+profileCount | yes | Integer | Number of profiles in the namespace
+visible | yes | Boolean | True for the active and the device namespace
 
 @par Returns(Subscription)
 
@@ -3562,25 +3845,42 @@ Not applicable.
 */
 //->End of API documentation comment block
 
-static bool handle_create_wpspin_command(LSHandle *sh, LSMessage *message,
-        void *context)
+static bool handle_get_profile_namespaces_command(LSHandle *sh,
+        LSMessage *message, void *context)
 {
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer("{}"), &parsedObj))
+	{
+		return true;
+	}
+
 	jvalue_ref reply = jobject_create();
+	jvalue_ref namespaces_j = jarray_create(NULL);
+	GList *namespaces = profile_namespace_get_all();
+	GList *iter;
 	LSError lserror;
 	LSErrorInit(&lserror);
 
-	gint wpspin = generate_new_wpspin();
-
-	if (wpspin < 0)
+	for (iter = namespaces; NULL != iter; iter = iter->next)
 	{
-		goto error;
+		profile_namespace_t *ns = iter->data;
+		jvalue_ref namespace_j = jobject_create();
+
+		jobject_put(namespace_j, J_CSTR_TO_JVAL("name"), jstring_create(ns->name));
+		jobject_put(namespace_j, J_CSTR_TO_JVAL("profileCount"),
+		            jnumber_create_i32(g_slist_length(ns->profiles)));
+		jobject_put(namespace_j, J_CSTR_TO_JVAL("visible"),
+		            jboolean_create(profile_namespace_is_visible(ns)));
+		jarray_append(namespaces_j, namespace_j);
 	}
 
-	char wpspin_str[9];
-	snprintf(wpspin_str, 9, "%08i", wpspin);
+	g_list_free(namespaces);
 
 	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
-	jobject_put(reply, J_CSTR_TO_JVAL("wpspin"), jstring_create(wpspin_str));
+	jobject_put(reply, J_CSTR_TO_JVAL("activeNamespace"),
+	            jstring_create(profile_namespace_get_active()->name));
+	jobject_put(reply, J_CSTR_TO_JVAL("namespaces"), namespaces_j);
 
 	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
 	                              DOMOPT_NOOPT, NULL);
@@ -3599,42 +3899,34 @@ static bool handle_create_wpspin_command(LSHandle *sh, LSMessage *message,
 	}
 
 	jschema_release(&response_schema);
-	goto cleanup;
-error:
-	LSMessageReplyCustomError(sh, message, "Error in generating wps pin",
-	                          WCA_API_ERROR_WPS_PIN);
-cleanup:
-
-	if (LSErrorIsSet(&lserror))
-	{
-		LSErrorPrint(&lserror, stderr);
-		LSErrorFree(&lserror);
-	}
 
+cleanup:
 	j_release(&reply);
+	j_release(&parsedObj);
 	return true;
 }
 
 //->Start of API documentation comment block
 /**
-@page com_webos_wifi com.webos.wifi/p2p
+@page com_webos_wifi com.webos.wifi
 @{
-@section com_webos_wifi_startwps startwps
+@section com_webos_wifi_deleteprofilenamespace deleteProfileNamespace
 
-Start WPS authentication process. If no wpsPin argument is supplied
-the WPS-PBC method will be used, else it will be WPS-PIN method.
+Deletes a profile namespace along with all of its profiles, e.g. when a user
+account is removed. If the namespace is active, the "device" namespace
+becomes active. The "device" namespace can't be deleted.
 
 @par Parameters
 
 Name | Required | Type | Description
 -----|--------|------|----------
-wpsPin | No | String | Pin for WPS-PIN mode
+namespace | yes | String | Name of the namespace
 
-@par Returns(Call) for all forms
+@par Returns(Call)
 
 Name | Required | Type | Description
 -----|--------|------|----------
-returnValue | Yes | Boolean | True
+returnValue | yes | Boolean | True
 
 @par Returns(Subscription)
 
@@ -3644,77 +3936,73 @@ Not applicable.
 */
 //->End of API documentation comment block
 
-static bool handle_start_wps_command(LSHandle *sh, LSMessage *message,
-                                     void *context)
+static bool handle_delete_profile_namespace_command(LSHandle *sh,
+        LSMessage *message, void *context)
 {
-	if (!connman_status_check(manager, sh, message))
-	{
-		return true;
-	}
-
-	if (!wifi_technology_status_check(sh, message))
-	{
-		return true;
-	}
-
-	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
+
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(wpsPin, string)))), &parsedObj))
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(namespace,
+	                                     string)) REQUIRED_1(namespace))), &parsedObj))
 	{
 		return true;
 	}
 
-	jvalue_ref wpsPinObj = NULL;
-	char *wpspin = NULL;
+	jvalue_ref namespaceObj = {0};
+	gchar *namespace_name = NULL;
 
-	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("wpsPin"), &wpsPinObj))
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("namespace"), &namespaceObj))
 	{
-		raw_buffer address_buf = jstring_get(wpsPinObj);
-		wpspin = g_strdup(address_buf.m_str);
-		jstring_free_buffer(address_buf);
+		raw_buffer namespace_buf = jstring_get(namespaceObj);
+		namespace_name = g_strdup(namespace_buf.m_str);
+		jstring_free_buffer(namespace_buf);
 	}
-	else
+
+	if (!g_strcmp0(namespace_name, PROFILE_NAMESPACE_DEVICE))
 	{
-		wpspin = g_strdup("");
+		LSMessageReplyCustomError(sh, message, "The device namespace can't be deleted",
+		                          WCA_API_ERROR_PROFILE_NAMESPACE_CONFLICT);
+		goto cleanup;
 	}
 
-	if (!connman_technology_start_wps(connman_manager_find_wifi_technology(manager),
-	                                  wpspin))
+	if (NULL == profile_namespace_lookup(namespace_name))
 	{
-		LSMessageReplyErrorUnknown(sh, message);
+		LSMessageReplyCustomError(sh, message, "Namespace not found",
+		                          WCA_API_ERROR_PROFILE_NAMESPACE_NOT_FOUND);
 		goto cleanup;
 	}
 
+	delete_profile_namespace(namespace_name);
 	LSMessageReplySuccess(sh, message);
+	send_getnetworks_status_to_subscribers();
+
 cleanup:
-	g_free(wpspin);
+	g_free(namespace_name);
 	j_release(&parsedObj);
 	return true;
 }
 
-
-
 //->Start of API documentation comment block
 /**
 @page com_webos_wifi com.webos.wifi
 @{
-@section com_webos_wifi_cancelwps cancelwps
+@section com_webos_wifi_moveprofiletonamespace moveProfileToNamespace
 
-Cancel any ongoing WPS connection.
+Moves a visible profile to another namespace, e.g. to "device" to share it
+with all users of the device. The namespace is created if needed.
 
 @par Parameters
 
 Name | Required | Type | Description
 -----|--------|------|----------
-None
+profileId | yes | Integer | ID of the profile to move
+namespace | yes | String | Name of the namespace to move the profile to
 
-@par Returns(Call) for all forms
+@par Returns(Call)
 
 Name | Required | Type | Description
 -----|--------|------|----------
-returnValue | Yes | Boolean | True
-
+returnValue | yes | Boolean | True
 
 @par Returns(Subscription)
 
@@ -3724,15 +4012,2325 @@ Not applicable.
 */
 //->End of API documentation comment block
 
-static bool handle_cancel_wps_command(LSHandle *sh, LSMessage *message,
-                                      void *context)
+static bool handle_move_profile_to_namespace_command(LSHandle *sh,
+        LSMessage *message, void *context)
 {
-	if (!connman_status_check(manager, sh, message))
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_2(PROP(profileId, integer),
+	                                     PROP(namespace, string)) REQUIRED_2(profileId, namespace))),
+	                             &parsedObj))
 	{
 		return true;
 	}
 
-	if (!wifi_technology_status_check(sh, message))
+	jvalue_ref profileIdObj = {0}, namespaceObj = {0};
+	int profile_id = 0;
+	gchar *namespace_name = NULL;
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("profileId"), &profileIdObj))
+	{
+		jnumber_get_i32(profileIdObj, &profile_id);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("namespace"), &namespaceObj))
+	{
+		raw_buffer namespace_buf = jstring_get(namespaceObj);
+		namespace_name = g_strdup(namespace_buf.m_str);
+		jstring_free_buffer(namespace_buf);
+	}
+
+	if (!profile_namespace_is_valid_name(namespace_name))
+	{
+		LSMessageReplyCustomError(sh, message, "Invalid namespace",
+		                          WCA_API_ERROR_PROFILE_NAMESPACE_INVALID);
+		goto cleanup;
+	}
+
+	wifi_profile_t *profile = get_profile_by_id(profile_id);
+
+	if (NULL == profile)
+	{
+		LSMessageReplyCustomError(sh, message, "Profile not found",
+		                          WCA_API_ERROR_PROFILE_NOT_FOUND);
+		goto cleanup;
+	}
+
+	if (!move_profile_to_namespace(profile, namespace_name))
+	{
+		LSMessageReplyCustomError(sh, message,
+		                          "Namespace already has a profile for this network",
+		                          WCA_API_ERROR_PROFILE_NAMESPACE_CONFLICT);
+		goto cleanup;
+	}
+
+	LSMessageReplySuccess(sh, message);
+	send_getnetworks_status_to_subscribers();
+
+cleanup:
+	g_free(namespace_name);
+	j_release(&parsedObj);
+	return true;
+}
+
+static jvalue_ref cert_info_to_json(const cert_info_t *info, gint64 now)
+{
+	gint64 window = (gint64) runtime_param_get(RUNTIME_PARAM_CERT_EXPIRY_WARNING) *
+	                CERT_DAY;
+	jvalue_ref cert_j = jobject_create();
+
+	jobject_put(cert_j, J_CSTR_TO_JVAL("name"), jstring_create(info->name));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("path"), jstring_create(info->path));
+
+	if (NULL != info->subject)
+	{
+		jobject_put(cert_j, J_CSTR_TO_JVAL("subject"), jstring_create(info->subject));
+	}
+
+	if (NULL != info->issuer)
+	{
+		jobject_put(cert_j, J_CSTR_TO_JVAL("issuer"), jstring_create(info->issuer));
+	}
+
+	if (NULL != info->fingerprint)
+	{
+		jobject_put(cert_j, J_CSTR_TO_JVAL("fingerprint"),
+		            jstring_create(info->fingerprint));
+	}
+
+	jobject_put(cert_j, J_CSTR_TO_JVAL("notBefore"),
+	            jnumber_create_i64(info->not_before));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("notAfter"),
+	            jnumber_create_i64(info->not_after));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("isCA"), jboolean_create(info->is_ca));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("count"), jnumber_create_i32(info->count));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("expired"),
+	            jboolean_create(now > info->not_after));
+	jobject_put(cert_j, J_CSTR_TO_JVAL("expiring"),
+	            jboolean_create(info->not_after - now <= window));
+
+	return cert_j;
+}
+
+static void reply_with_object(LSHandle *sh, LSMessage *message,
+                              jvalue_ref reply)
+{
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		return;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_importcertificate importCertificate
+
+Imports a certificate, or a bundle of CA certificates, for use with enterprise
+(802.1X) networks. The certificate is stored as PEM and its path is returned,
+to be used as "caCertFile" or "clientCertFile" when connecting. A certificate
+with the same name is replaced, e.g. by a renewed one.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+name | yes | String | Name of the certificate. Letters, digits and ".-_" only, at most 64 characters.
+pem | no | String | PEM encoded certificates
+path | no | String | Path of a PEM or DER encoded certificate file to import instead
+
+Either "pem" or "path" is required.
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+certificate | yes | Object | Certificate object as in getCertificates
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_import_certificate_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_3(PROP(name, string),
+	                                     PROP(pem, string), PROP(path, string)) REQUIRED_1(name))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref nameObj = {0}, pemObj = {0}, pathObj = {0};
+	gchar *name = NULL, *data = NULL;
+	gsize len = 0;
+	const cert_info_t *info;
+	GError *error = NULL;
+	bool has_pem, has_path;
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("name"), &nameObj))
+	{
+		raw_buffer name_buf = jstring_get(nameObj);
+		name = g_strdup(name_buf.m_str);
+		jstring_free_buffer(name_buf);
+	}
+
+	has_pem = jobject_get_exists(parsedObj, J_CSTR_TO_BUF("pem"), &pemObj);
+	has_path = jobject_get_exists(parsedObj, J_CSTR_TO_BUF("path"), &pathObj);
+
+	if (has_pem == has_path)
+	{
+		LSMessageReplyErrorInvalidParams(sh, message);
+		goto cleanup;
+	}
+
+	if (!cert_store_is_valid_name(name))
+	{
+		LSMessageReplyCustomError(sh, message, "Invalid certificate name",
+		                          WCA_API_ERROR_CERTIFICATE_INVALID);
+		goto cleanup;
+	}
+
+	if (has_pem)
+	{
+		raw_buffer pem_buf = jstring_get(pemObj);
+		data = g_strdup(pem_buf.m_str);
+		len = pem_buf.m_len;
+		jstring_free_buffer(pem_buf);
+	}
+	else
+	{
+		raw_buffer path_buf = jstring_get(pathObj);
+		gchar *path = g_strdup(path_buf.m_str);
+		jstring_free_buffer(path_buf);
+
+		if (!g_file_get_contents(path, &data, &len, NULL))
+		{
+			LSMessageReplyCustomError(sh, message, "Certificate file not found",
+			                          WCA_API_ERROR_CERTIFICATE_NOT_FOUND);
+			g_free(path);
+			goto cleanup;
+		}
+
+		g_free(path);
+	}
+
+	info = cert_store_import(name, (const guchar *) data, len, &error);
+
+	if (NULL == info)
+	{
+		WCALOG_ERROR(MSGID_WIFI_CERT_STORE_ERROR, 0, "%s", error->message);
+		reply_cert_store_error(sh, message, error);
+		g_error_free(error);
+		goto cleanup;
+	}
+
+	jvalue_ref reply = jobject_create();
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("certificate"), cert_info_to_json(info,
+	            g_get_real_time() / G_USEC_PER_SEC));
+	reply_with_object(sh, message, reply);
+	j_release(&reply);
+
+cleanup:
+	g_free(data);
+	g_free(name);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_getcertificates getCertificates
+
+Lists the imported certificates. Certificates are flagged as expiring within
+the number of days set with the "certExpiryWarning" runtime parameter.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+certificates | yes | Array of Object | Array of certificate objects, ordered by name
+
+@par "certificate" Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+name | yes | String | Name of the certificate
+path | yes | String | Path to use as "caCertFile" or "clientCertFile"
+subject | yes | String | Subject of the (first) certificate, RFC 2253
+issuer | yes | String | Issuer of the (first) certificate, RFC 2253
+fingerprint | yes | String | SHA-256 fingerprint of the (first) certificate
+notBefore | yes | Integer | Start of validity, in seconds since the epoch
+notAfter | yes | Integer | End of validity, in seconds since the epoch. For a bundle, the earliest one.
+isCA | yes | Boolean | True for CA certificates
+count | yes | Integer | Number of certificates in the file
+expired | yes | Boolean | True if expired
+expiring | yes | Boolean | True if expired or expiring soon
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_certificates_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer("{}"), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref certs_j = jarray_create(NULL);
+	GList *certs = cert_store_get_all();
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+	GList *iter;
+
+	for (iter = certs; NULL != iter; iter = iter->next)
+	{
+		jarray_append(certs_j, cert_info_to_json(iter->data, now));
+	}
+
+	g_list_free(certs);
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("certificates"), certs_j);
+	reply_with_object(sh, message, reply);
+
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_deletecertificate deleteCertificate
+
+Deletes an imported certificate. Profiles still referring to it fail to
+connect with a "certificate not found" error.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+name | yes | String | Name of the certificate
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_delete_certificate_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(name,
+	                                     string)) REQUIRED_1(name))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref nameObj = {0};
+	gchar *name = NULL;
+	GError *error = NULL;
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("name"), &nameObj))
+	{
+		raw_buffer name_buf = jstring_get(nameObj);
+		name = g_strdup(name_buf.m_str);
+		jstring_free_buffer(name_buf);
+	}
+
+	if (!cert_store_remove(name, &error))
+	{
+		reply_cert_store_error(sh, message, error);
+		g_error_free(error);
+		goto cleanup;
+	}
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_free(name);
+	j_release(&parsedObj);
+	return true;
+}
+
+static void reply_wowlan_error(LSHandle *sh, LSMessage *message,
+                               const GError *error)
+{
+	int code;
+
+	switch (error->code)
+	{
+		case WOWLAN_ERROR_INVALID:
+			code = WCA_API_ERROR_WOWLAN_INVALID;
+			break;
+
+		case WOWLAN_ERROR_UNSUPPORTED:
+			code = WCA_API_ERROR_WOWLAN_UNSUPPORTED;
+			break;
+
+		default:
+			code = WCA_API_ERROR_WOWLAN_FAILED;
+			break;
+	}
+
+	LSMessageReplyCustomError(sh, message, error->message, code);
+}
+
+static jvalue_ref wowlan_triggers_to_json(guint triggers)
+{
+	jvalue_ref triggers_j = jarray_create(NULL);
+	guint trigger;
+
+	for (trigger = 1; trigger <= WOWLAN_TRIGGER_PATTERN; trigger <<= 1)
+	{
+		if (triggers & trigger)
+		{
+			jarray_append(triggers_j, jstring_create(wowlan_trigger_to_string(trigger)));
+		}
+	}
+
+	return triggers_j;
+}
+
+/* Build a pattern from {"pattern", "offset"} or {"protocol", "port"} */
+static wowlan_pattern_t *wowlan_pattern_from_json(jvalue_ref patternObj,
+        GError **error)
+{
+	jvalue_ref hexObj = {0}, offsetObj = {0}, protocolObj = {0}, portObj = {0};
+	wowlan_pattern_t *pattern = NULL;
+
+	if (jobject_get_exists(patternObj, J_CSTR_TO_BUF("pattern"), &hexObj))
+	{
+		int offset = 0;
+
+		if (jobject_get_exists(patternObj, J_CSTR_TO_BUF("offset"), &offsetObj))
+		{
+			jnumber_get_i32(offsetObj, &offset);
+		}
+
+		if (offset < 0)
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+			            "Invalid pattern offset");
+			return NULL;
+		}
+
+		raw_buffer hex_buf = jstring_get(hexObj);
+		pattern = wowlan_pattern_parse(hex_buf.m_str, offset, error);
+		jstring_free_buffer(hex_buf);
+	}
+	else if (jobject_get_exists(patternObj, J_CSTR_TO_BUF("protocol"),
+	                            &protocolObj) &&
+	         jobject_get_exists(patternObj, J_CSTR_TO_BUF("port"), &portObj))
+	{
+		int protocol = -1, port = 0;
+
+		raw_buffer protocol_buf = jstring_get(protocolObj);
+
+		if (!g_strcmp0(protocol_buf.m_str, "udp"))
+		{
+			protocol = IPPROTO_UDP;
+		}
+		else if (!g_strcmp0(protocol_buf.m_str, "tcp"))
+		{
+			protocol = IPPROTO_TCP;
+		}
+
+		jstring_free_buffer(protocol_buf);
+		jnumber_get_i32(portObj, &port);
+
+		if (protocol < 0 || port <= 0 || port > G_MAXUINT16)
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+			            "Invalid protocol or port");
+			return NULL;
+		}
+
+		pattern = wowlan_pattern_new_port(protocol, port);
+	}
+	else
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+		            "A pattern needs \"pattern\" or \"protocol\" and \"port\"");
+	}
+
+	return pattern;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_setwowlan setWowlan
+
+Sets what wakes the system up over wifi while it is suspended
+(Wake-on-WLAN). The configuration is checked against what the wifi driver
+supports, stored, and handed to the driver each time the system suspends.
+While a configuration is set it replaces the Wake-on-WiFi setup of the
+connection manager (WOLWOWLMode). Once it is disabled the driver is cleared
+on the next suspend, unless WOLWOWLMode is on, and then left to WOLWOWLMode.
+Patterns are matched against received frames as 802.3 frames, i.e. after
+the 14 byte ethernet header starting with the destination address.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+triggers | yes | Array of String | Triggers: "any", "disconnect", "magicPacket", "gtkRekeyFailure", "eapIdentityRequest", "fourWayHandshake" or "rfkillRelease". Without triggers and patterns the configuration is disabled.
+patterns | no | Array of Object | Array of pattern objects, packets matching any of them wake the system up
+
+@par "pattern" Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+pattern | no | String | Bytes to match in hex, "??" for bytes which don't matter, e.g. "0800"
+offset | no | Integer | Where the pattern starts in the frame, 0 by default
+protocol | no | String | "udp" or "tcp", to match IPv4 packets to "port" instead of giving "pattern"
+port | no | Integer | Destination port, with "protocol"
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_wowlan_command(LSHandle *sh, LSMessage *message,
+                                      void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_2(ARRAY(triggers, string),
+	                                     OBJARRAY(patterns, OBJSCHEMA_4(PROP(pattern, string),
+	                                             PROP(offset, integer), PROP(protocol, string),
+	                                             PROP(port, integer))))) REQUIRED_1(triggers))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref triggersObj = {0}, patternsObj = {0};
+	wowlan_config_t *config = wowlan_config_new();
+	GError *error = NULL;
+	ssize_t i, num_elems;
+	gchar *config_str;
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("triggers"), &triggersObj);
+	num_elems = jarray_size(triggersObj);
+
+	for (i = 0; i < num_elems; i++)
+	{
+		raw_buffer trigger_buf = jstring_get(jarray_get(triggersObj, i));
+		guint trigger = wowlan_trigger_from_string(trigger_buf.m_str);
+		jstring_free_buffer(trigger_buf);
+
+		/* The pattern trigger is set by giving patterns */
+		if (0 == trigger || WOWLAN_TRIGGER_PATTERN == trigger)
+		{
+			LSMessageReplyCustomError(sh, message, "Unknown trigger",
+			                          WCA_API_ERROR_WOWLAN_INVALID);
+			goto cleanup;
+		}
+
+		config->triggers |= trigger;
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("patterns"), &patternsObj))
+	{
+		num_elems = jarray_size(patternsObj);
+
+		for (i = 0; i < num_elems; i++)
+		{
+			wowlan_pattern_t *pattern = wowlan_pattern_from_json(jarray_get(patternsObj,
+			                            i), &error);
+
+			if (NULL == pattern)
+			{
+				reply_wowlan_error(sh, message, error);
+				g_error_free(error);
+				goto cleanup;
+			}
+
+			wowlan_config_add_pattern(config, pattern);
+		}
+	}
+
+	config_str = wowlan_config_to_string(config);
+
+	if (!wowlan_set_config(CONNMAN_WIFI_INTERFACE_NAME, config, &error))
+	{
+		WCALOG_ERROR(MSGID_WIFI_WOWLAN_ERROR, 0, "Wake-on-WLAN \"%s\" refused: %s",
+		             config_str, error->message);
+		reply_wowlan_error(sh, message, error);
+		g_error_free(error);
+		g_free(config_str);
+		goto cleanup;
+	}
+
+	/* Owned by the wowlan module now */
+	config = NULL;
+
+	WCALOG_INFO(MSGID_WIFI_WOWLAN_INFO, 0, "Wake-on-WLAN set to \"%s\"",
+	            config_str);
+	g_free(config_str);
+
+	store_wifi_setting(WIFI_WOWLAN_SETTING, NULL);
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	wowlan_config_free(config);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_getwowlan getWowlan
+
+Gets the Wake-on-WLAN configuration, what the wifi driver supports and what
+woke the system up last.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+enabled | yes | Boolean | True if Wake-on-WLAN is set up
+triggers | yes | Array of String | Triggers as in setWowlan, with "pattern" if there are patterns
+patterns | yes | Array of Object | Patterns as in setWowlan, all with "pattern" and "offset"
+capabilities | no | Object | Capabilities object, missing if the driver can't be queried
+lastWake | no | Object | Last wake object, missing until the system resumed
+
+@par "capabilities" Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+triggers | yes | Array of String | Supported triggers, with "pattern" if patterns are supported
+gtkRekeyOffload | yes | Boolean | True if the device renews the group key while suspended
+maxPatterns | yes | Integer | Maximum number of patterns
+minPatternLength | yes | Integer | Minimum length of a pattern in bytes
+maxPatternLength | yes | Integer | Maximum length of a pattern in bytes
+maxPatternOffset | yes | Integer | Maximum offset of a pattern
+
+@par "lastWake" Object
+
+Name | Required | Type | Description
+-----|--------|------|----------
+reason | yes | String | Trigger which woke the system up, "notWifi" if it wasn't the wifi
+pattern | no | Integer | Index of the matching pattern, for "pattern"
+time | yes | Integer | Time of the wake-up, in seconds since the epoch
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_wowlan_command(LSHandle *sh, LSMessage *message,
+                                      void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer("{}"), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref patterns_j = jarray_create(NULL);
+	const wowlan_config_t *config = wowlan_get_config();
+	const wowlan_wake_t *wake = wowlan_get_last_wake();
+	wowlan_capabilities_t caps;
+	guint i;
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("enabled"), jboolean_create(NULL != config));
+	jobject_put(reply, J_CSTR_TO_JVAL("triggers"),
+	            wowlan_triggers_to_json(NULL != config ? config->triggers : 0));
+
+	for (i = 0; NULL != config && i < config->patterns->len; i++)
+	{
+		const wowlan_pattern_t *pattern = g_ptr_array_index(config->patterns, i);
+		jvalue_ref pattern_j = jobject_create();
+		gchar *hex = wowlan_pattern_to_string(pattern);
+
+		jobject_put(pattern_j, J_CSTR_TO_JVAL("pattern"), jstring_create(hex));
+		jobject_put(pattern_j, J_CSTR_TO_JVAL("offset"),
+		            jnumber_create_i32(pattern->offset));
+		jarray_append(patterns_j, pattern_j);
+		g_free(hex);
+	}
+
+	jobject_put(reply, J_CSTR_TO_JVAL("patterns"), patterns_j);
+
+	if (wowlan_get_capabilities(CONNMAN_WIFI_INTERFACE_NAME, &caps, NULL))
+	{
+		jvalue_ref caps_j = jobject_create();
+
+		jobject_put(caps_j, J_CSTR_TO_JVAL("triggers"),
+		            wowlan_triggers_to_json(caps.triggers));
+		jobject_put(caps_j, J_CSTR_TO_JVAL("gtkRekeyOffload"),
+		            jboolean_create(caps.gtk_rekey_offload));
+		jobject_put(caps_j, J_CSTR_TO_JVAL("maxPatterns"),
+		            jnumber_create_i32(caps.max_patterns));
+		jobject_put(caps_j, J_CSTR_TO_JVAL("minPatternLength"),
+		            jnumber_create_i32(caps.min_pattern_len));
+		jobject_put(caps_j, J_CSTR_TO_JVAL("maxPatternLength"),
+		            jnumber_create_i32(caps.max_pattern_len));
+		jobject_put(caps_j, J_CSTR_TO_JVAL("maxPatternOffset"),
+		            jnumber_create_i32(caps.max_pattern_offset));
+		jobject_put(reply, J_CSTR_TO_JVAL("capabilities"), caps_j);
+	}
+
+	if (NULL != wake)
+	{
+		jvalue_ref wake_j = jobject_create();
+
+		jobject_put(wake_j, J_CSTR_TO_JVAL("reason"),
+		            jstring_create(wake->trigger ? wowlan_trigger_to_string(wake->trigger) :
+		                           "notWifi"));
+
+		if (wake->pattern >= 0)
+		{
+			jobject_put(wake_j, J_CSTR_TO_JVAL("pattern"),
+			            jnumber_create_i32(wake->pattern));
+		}
+
+		jobject_put(wake_j, J_CSTR_TO_JVAL("time"), jnumber_create_i64(wake->time));
+		jobject_put(reply, J_CSTR_TO_JVAL("lastWake"), wake_j);
+	}
+
+	reply_with_object(sh, message, reply);
+
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ *  @brief Create the connman .config of a Hotspot 2.0 network from the
+ *  credential it matched. Networks the user configured are left alone.
+ */
+
+static void provision_passpoint_network(const passpoint_bss_t *bss)
+{
+	const passpoint_credential_t *credential = bss->credential;
+	const gchar *provisioned_id = passpoint_get_provisioned(bss->ssid);
+
+	if (!g_strcmp0(provisioned_id, credential->id))
+	{
+		return;
+	}
+
+	if (NULL == provisioned_id &&
+	        NULL != get_profile_by_ssid_security(bss->ssid,
+	                WIFI_ENTERPRISE_SECURITY_TYPE))
+	{
+		return;
+	}
+
+	connection_settings_t *settings = connection_settings_new();
+
+	settings->ssid = g_strdup(bss->ssid);
+	settings->eap_type = g_strdup(credential->eap_type);
+	settings->identity = g_strdup(credential->identity);
+	settings->passphrase = g_strdup(credential->passphrase);
+	settings->ca_cert_file = g_strdup(credential->ca_cert_file);
+	settings->client_cert_file = g_strdup(credential->client_cert_file);
+	settings->private_key_file = g_strdup(credential->private_key_file);
+	settings->private_key_passphrase = g_strdup(
+	                                       credential->private_key_passphrase);
+	settings->phase2 = g_strdup(credential->phase2);
+
+	if (store_network_config(settings, WIFI_ENTERPRISE_SECURITY_TYPE))
+	{
+		WCALOG_INFO(MSGID_WIFI_PASSPOINT_INFO, 0,
+		            "Provisioned %s network %s (%s) with credential %s",
+		            passpoint_match_to_string(bss->match), bss->ssid, bss->bssid,
+		            credential->id);
+		passpoint_set_provisioned(bss->ssid, credential->id);
+		store_wifi_setting(WIFI_PASSPOINT_SETTING, NULL);
+	}
+
+	connection_settings_free(settings);
+}
+
+/**
+ *  @brief Match the Hotspot 2.0 networks of a scan against the credentials
+ *  and provision the best network of each SSID
+ *
+ *  @param bsses List of passpoint_bss_t, owned by the function
+ */
+
+static void match_passpoint_networks(GList *bsses)
+{
+	GHashTable *seen;
+	GList *iter;
+
+	g_list_free_full(passpoint_matches, passpoint_bss_free);
+	passpoint_matches = passpoint_rank(bsses);
+	seen = g_hash_table_new(g_str_hash, g_str_equal);
+
+	for (iter = passpoint_matches; NULL != iter; iter = iter->next)
+	{
+		passpoint_bss_t *bss = iter->data;
+
+		if (!g_hash_table_contains(seen, bss->ssid))
+		{
+			g_hash_table_add(seen, bss->ssid);
+			provision_passpoint_network(bss);
+		}
+	}
+
+	g_hash_table_destroy(seen);
+}
+
+/**
+ *  @brief Match the Hotspot 2.0 networks of the last scan right away, without
+ *  waiting for the next scan
+ */
+
+static void check_passpoint_networks(void)
+{
+	GError *error = NULL;
+	GList *bsses = passpoint_nl80211_get_bsses(CONNMAN_WIFI_INTERFACE_NAME,
+	               &error);
+
+	if (NULL != error)
+	{
+		WCALOG_ERROR(MSGID_WIFI_PASSPOINT_ERROR, 0,
+		             "Failed to read the scan results: %s", error->message);
+		g_error_free(error);
+		return;
+	}
+
+	match_passpoint_networks(bsses);
+}
+
+/**
+ *  @brief Remove the networks provisioned with a credential
+ */
+
+static void remove_passpoint_networks(const gchar *id)
+{
+	GList *ssids = passpoint_get_provisioned_ssids(id), *iter;
+
+	for (iter = ssids; NULL != iter; iter = iter->next)
+	{
+		gchar *ssid = g_strdup(iter->data);
+		wifi_profile_t *profile = get_profile_by_ssid_security(ssid,
+		                          WIFI_ENTERPRISE_SECURITY_TYPE);
+
+		if (NULL != profile)
+		{
+			remove_service_or_all_other(ssid, FALSE);
+			delete_profile(profile);
+		}
+
+		passpoint_set_provisioned(ssid, NULL);
+		g_free(ssid);
+	}
+
+	g_list_free(ssids);
+}
+
+static gchar *dup_string_param(jvalue_ref parent, const char *key)
+{
+	jvalue_ref value = {0};
+	gchar *str = NULL;
+
+	if (jobject_get_exists(parent, j_cstr_to_buffer(key), &value))
+	{
+		raw_buffer buf = jstring_get(value);
+		str = g_strdup(buf.m_str);
+		jstring_free_buffer(buf);
+	}
+
+	return str;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_setpasspointcredential setPasspointCredential
+
+Adds a Hotspot 2.0 (Passpoint) credential or replaces the one with the same
+id. After each scan the Hotspot 2.0 networks around are matched against the
+credentials: a network whose domain is the home domain of a credential is a
+home network, one advertising a roaming consortium OI or the NAI realm of a
+credential a roaming network. Home networks are preferred, then the
+credential with the higher priority, then the stronger signal. An enterprise
+profile is created for the best matching network of each SSID, so it is
+connected like any other known network. Networks the user configured are
+left alone.
+
+Only the roaming consortium OIs advertised in beacons and probe responses are
+known from the scan results; NAI realms and domain names are matched once they
+are known from ANQP.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+id | yes | String | Id of the credential
+realm | yes | String | NAI realm of the credential, e.g. "example.com"
+domain | no | String | Home domain of the service provider
+roamingConsortiums | no | Array of String | Roaming consortium OIs of the service provider, 3 or 5 octets in hex
+priority | no | Integer | Credentials with higher priority are preferred, 0 by default
+enterpriseSecurity | yes | Object | EAP settings as in connect: "eapType" ("peap", "ttls" or "tls"), "identity", "passphrase", "caCertFile", "clientCertFile", "privateKeyFile", "privateKeyPassphrase" and "phase2"
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_passpoint_credential_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_6(PROP(id, string),
+	                                     PROP(realm, string), PROP(domain, string),
+	                                     ARRAY(roamingConsortiums, string), PROP(priority, integer),
+	                                     PROP(enterpriseSecurity, object)) REQUIRED_2(id,
+	                                             enterpriseSecurity))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref securityObj = {0}, oisObj = {0}, priorityObj = {0};
+	gchar *id = dup_string_param(parsedObj, "id");
+	passpoint_credential_t *credential = passpoint_credential_new(id);
+
+	g_free(id);
+
+	credential->realm = dup_string_param(parsedObj, "realm");
+	credential->domain = dup_string_param(parsedObj, "domain");
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("roamingConsortiums"),
+	                       &oisObj))
+	{
+		ssize_t i, num_elems = jarray_size(oisObj);
+
+		credential->roaming_consortiums = g_new0(gchar *, num_elems + 1);
+
+		for (i = 0; i < num_elems; i++)
+		{
+			raw_buffer oi_buf = jstring_get(jarray_get(oisObj, i));
+			credential->roaming_consortiums[i] = g_strdup(oi_buf.m_str);
+			jstring_free_buffer(oi_buf);
+		}
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("priority"), &priorityObj))
+	{
+		jnumber_get_i32(priorityObj, &credential->priority);
+	}
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("enterpriseSecurity"),
+	                   &securityObj);
+	credential->eap_type = dup_string_param(securityObj, "eapType");
+	credential->identity = dup_string_param(securityObj, "identity");
+	credential->passphrase = dup_string_param(securityObj, "passphrase");
+	credential->ca_cert_file = dup_string_param(securityObj, "caCertFile");
+	credential->client_cert_file = dup_string_param(securityObj,
+	                               "clientCertFile");
+	credential->private_key_file = dup_string_param(securityObj,
+	                               "privateKeyFile");
+	credential->private_key_passphrase = dup_string_param(securityObj,
+	                                     "privateKeyPassphrase");
+	credential->phase2 = dup_string_param(securityObj, "phase2");
+
+	if (!passpoint_credential_is_valid(credential) ||
+	        (g_strcmp0(credential->eap_type, "peap") &&
+	         g_strcmp0(credential->eap_type, "ttls") &&
+	         g_strcmp0(credential->eap_type, "tls")))
+	{
+		LSMessageReplyCustomError(sh, message,
+		                          "A credential needs a realm, a valid eapType and valid OIs",
+		                          WCA_API_ERROR_PASSPOINT_INVALID);
+		passpoint_credential_free(credential);
+		goto cleanup;
+	}
+
+	if (!check_enterprise_certificates(sh, message, credential->ca_cert_file,
+	                                   credential->client_cert_file))
+	{
+		passpoint_credential_free(credential);
+		goto cleanup;
+	}
+
+	/* Provision the networks again with the new settings */
+	remove_passpoint_networks(credential->id);
+	g_list_free_full(passpoint_matches, passpoint_bss_free);
+	passpoint_matches = NULL;
+
+	WCALOG_INFO(MSGID_WIFI_PASSPOINT_INFO, 0, "Credential %s set for realm %s",
+	            credential->id, credential->realm);
+
+	/* Owned by the passpoint module now */
+	passpoint_add_credential(credential);
+	store_wifi_setting(WIFI_PASSPOINT_SETTING, NULL);
+
+	/* Match the new credential right away */
+	check_passpoint_networks();
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_deletepasspointcredential deletePasspointCredential
+
+Removes a Hotspot 2.0 credential along with the profiles created for the
+networks it matched.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+id | yes | String | Id of the credential
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True, when the credential was removed. False otherwise.
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_delete_passpoint_credential_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(id,
+	                                     string)) REQUIRED_1(id))), &parsedObj))
+	{
+		return true;
+	}
+
+	gchar *id = dup_string_param(parsedObj, "id");
+
+	if (NULL == passpoint_get_credential(id))
+	{
+		LSMessageReplyCustomError(sh, message, "No such credential",
+		                          WCA_API_ERROR_PASSPOINT_NOT_FOUND);
+		goto cleanup;
+	}
+
+	remove_passpoint_networks(id);
+	g_list_free_full(passpoint_matches, passpoint_bss_free);
+	passpoint_matches = NULL;
+
+	passpoint_remove_credential(id);
+	store_wifi_setting(WIFI_PASSPOINT_SETTING, NULL);
+
+	WCALOG_INFO(MSGID_WIFI_PASSPOINT_INFO, 0, "Credential %s deleted", id);
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_free(id);
+	j_release(&parsedObj);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_getpasspointcredentials getPasspointCredentials
+
+Lists the Hotspot 2.0 credentials, without their secrets, and the networks of
+the last scan which matched them.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+credentials | yes | Array of Object | Each object holds "id", "realm", "domain", "roamingConsortiums", "priority", "eapType", "identity" and "networks", the SSIDs provisioned with the credential
+matches | yes | Array of Object | Matching networks, most preferred first. Each object holds "ssid", "bssid", "frequency", "signal" (dBm), "match" ("home" or "roaming") and "credentialId"
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_passpoint_credentials_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer("{}"), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref reply = jobject_create();
+	jvalue_ref credentials_j = jarray_create(NULL);
+	jvalue_ref matches_j = jarray_create(NULL);
+	const GList *iter;
+
+	for (iter = passpoint_get_credentials(); NULL != iter; iter = iter->next)
+	{
+		const passpoint_credential_t *credential = iter->data;
+		jvalue_ref credential_j = jobject_create();
+		jvalue_ref ois_j = jarray_create(NULL);
+		jvalue_ref networks_j = jarray_create(NULL);
+		GList *ssids = passpoint_get_provisioned_ssids(credential->id), *ssid_iter;
+		gsize i;
+
+		jobject_put(credential_j, J_CSTR_TO_JVAL("id"),
+		            jstring_create(credential->id));
+		jobject_put(credential_j, J_CSTR_TO_JVAL("realm"),
+		            jstring_create(credential->realm));
+
+		if (NULL != credential->domain)
+		{
+			jobject_put(credential_j, J_CSTR_TO_JVAL("domain"),
+			            jstring_create(credential->domain));
+		}
+
+		for (i = 0; NULL != credential->roaming_consortiums &&
+		        NULL != credential->roaming_consortiums[i]; i++)
+		{
+			jarray_append(ois_j, jstring_create(credential->roaming_consortiums[i]));
+		}
+
+		jobject_put(credential_j, J_CSTR_TO_JVAL("roamingConsortiums"), ois_j);
+		jobject_put(credential_j, J_CSTR_TO_JVAL("priority"),
+		            jnumber_create_i32(credential->priority));
+		jobject_put(credential_j, J_CSTR_TO_JVAL("eapType"),
+		            jstring_create(credential->eap_type));
+
+		if (NULL != credential->identity)
+		{
+			jobject_put(credential_j, J_CSTR_TO_JVAL("identity"),
+			            jstring_create(credential->identity));
+		}
+
+		for (ssid_iter = ssids; NULL != ssid_iter; ssid_iter = ssid_iter->next)
+		{
+			jarray_append(networks_j, jstring_create(ssid_iter->data));
+		}
+
+		g_list_free(ssids);
+		jobject_put(credential_j, J_CSTR_TO_JVAL("networks"), networks_j);
+		jarray_append(credentials_j, credential_j);
+	}
+
+	for (iter = passpoint_matches; NULL != iter; iter = iter->next)
+	{
+		const passpoint_bss_t *bss = iter->data;
+		jvalue_ref match_j = jobject_create();
+
+		jobject_put(match_j, J_CSTR_TO_JVAL("ssid"), jstring_create(bss->ssid));
+		jobject_put(match_j, J_CSTR_TO_JVAL("bssid"), jstring_create(bss->bssid));
+		jobject_put(match_j, J_CSTR_TO_JVAL("frequency"),
+		            jnumber_create_i32(bss->frequency));
+		jobject_put(match_j, J_CSTR_TO_JVAL("signal"), jnumber_create_i32(bss->signal));
+		jobject_put(match_j, J_CSTR_TO_JVAL("match"),
+		            jstring_create(passpoint_match_to_string(bss->match)));
+		jobject_put(match_j, J_CSTR_TO_JVAL("credentialId"),
+		            jstring_create(bss->credential->id));
+		jarray_append(matches_j, match_j);
+	}
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("credentials"), credentials_j);
+	jobject_put(reply, J_CSTR_TO_JVAL("matches"), matches_j);
+
+	reply_with_object(sh, message, reply);
+
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ *  @brief Check if the country of the radio was configured by other means than
+ *  the inference
+ */
+
+static gboolean regulatory_country_is_external(connman_technology_t
+        *technology)
+{
+	const gchar *country_code = technology->country_code;
+
+	if (NULL == country_code || !*country_code ||
+	        !g_strcmp0(country_code, REGULATORY_WORLD))
+	{
+		return FALSE;
+	}
+
+	return NULL == regulatory_applied_code ||
+	       g_ascii_strcasecmp(country_code, regulatory_applied_code);
+}
+
+/**
+ *  @brief Apply the regulatory domain inferred from the country elements
+ *  counted in the last scan. A country configured by anyone else wins over
+ *  the inference.
+ */
+
+static void apply_regulatory_domain(connman_technology_t *technology)
+{
+	const gchar *country_code;
+	gboolean applied;
+
+	/* Overridden since, so the inference has to apply it again */
+	if (NULL != regulatory_applied_code && (NULL == technology->country_code ||
+	        g_ascii_strcasecmp(technology->country_code, regulatory_applied_code)))
+	{
+		g_free(regulatory_applied_code);
+		regulatory_applied_code = NULL;
+		regulatory_confirm_applied(REGULATORY_WORLD);
+	}
+
+	country_code = regulatory_end_scan();
+
+	if (NULL == country_code || regulatory_country_is_external(technology))
+	{
+		return;
+	}
+
+	WCALOG_INFO(MSGID_COUNTRY_CODE_INFERRED, 0,
+	            "Applying country %s inferred from %u access points",
+	            country_code, regulatory_get_status()->votes);
+
+	applied = connman_technology_set_country_code(technology, country_code);
+
+	/* Otherwise the country is proposed again after the next scan */
+	if (applied)
+	{
+		g_free(regulatory_applied_code);
+		regulatory_applied_code = g_strdup(country_code);
+		regulatory_confirm_applied(country_code);
+	}
+
+	support_configure_country_code_cb(applied, NULL);
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_getregulatorydomain getRegulatoryDomain
+
+Reports the regulatory domain of the wifi radio and the one inferred from the
+country elements (802.11d) of the access points around.
+
+Each scan is a vote in which every access point radio advertising a country
+counts once. A country is applied once it won three scans in a row with at
+least 75% of the votes, and the world domain "00" once five scans disagreed
+without a clear winner. A country configured by other means is never
+overridden.
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+countryCode | yes | String | Country the radio follows, "00" for the world domain
+inferred | yes | Boolean | True if countryCode was applied by the inference
+inferredCountryCode | no | String | Winner of the last scan, absent if no country had enough votes
+confidence | yes | Integer | Share of the votes of inferredCountryCode in percent
+votes | yes | Integer | Number of access point radios which voted in the last scan
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_get_regulatory_domain_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer("{}"), &parsedObj))
+	{
+		return true;
+	}
+
+	connman_technology_t *technology = connman_manager_find_wifi_technology(
+	                                       manager);
+	const regulatory_status_t *status = regulatory_get_status();
+	const gchar *country_code = REGULATORY_WORLD;
+	jvalue_ref reply = jobject_create();
+
+	if (NULL != technology && NULL != technology->country_code &&
+	        *technology->country_code)
+	{
+		country_code = technology->country_code;
+	}
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("countryCode"),
+	            jstring_create(country_code));
+	jobject_put(reply, J_CSTR_TO_JVAL("inferred"),
+	            jboolean_create(!g_strcmp0(country_code, regulatory_applied_code)));
+
+	if (*status->inferred)
+	{
+		jobject_put(reply, J_CSTR_TO_JVAL("inferredCountryCode"),
+		            jstring_create(status->inferred));
+	}
+
+	jobject_put(reply, J_CSTR_TO_JVAL("confidence"),
+	            jnumber_create_i32(status->confidence));
+	jobject_put(reply, J_CSTR_TO_JVAL("votes"), jnumber_create_i32(status->votes));
+
+	reply_with_object(sh, message, reply);
+
+	j_release(&reply);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ *  @brief Get the profile of a wifi service
+ */
+
+static wifi_profile_t *get_service_profile(connman_service_t *service)
+{
+	if (NULL == service || NULL == service->name || NULL == service->security)
+	{
+		return NULL;
+	}
+
+	return get_profile_by_ssid_security(service->name, service->security[0]);
+}
+
+/**
+ *  @brief Get the best scoring BSS of a service for the band preference of
+ *  its profile
+ */
+
+static bssinfo_t *get_preferred_bss(connman_service_t *service,
+                                    const band_preference_t *pref, gint *score)
+{
+	bssinfo_t *best = NULL;
+	guint i;
+
+	*score = BAND_STEERING_SCORE_EXCLUDED;
+
+	for (i = 0; NULL != service->bss && i < service->bss->len; i++)
+	{
+		bssinfo_t *bss = &g_array_index(service->bss, bssinfo_t, i);
+		gint bss_score = band_preference_score(pref, bss->bssid, bss->frequency,
+		                                       bss->signal);
+
+		if (bss_score > *score || (bss_score == *score && NULL != best &&
+		                           bss->signal > best->signal))
+		{
+			best = bss;
+			*score = bss_score;
+		}
+	}
+
+	return BAND_STEERING_SCORE_EXCLUDED != *score ? best : NULL;
+}
+
+/**
+ *  @brief Connect the network disconnected for want of a BSS in its required
+ *  band again once the band is around
+ */
+
+static void reconnect_band_steering_parked_service(void)
+{
+	connman_service_t *service = connman_manager_find_service_by_path(
+	                                 manager->wifi_services, band_steering_parked_path);
+	wifi_profile_t *profile = get_service_profile(service);
+	gint score;
+
+	if (NULL == profile ||
+	        NULL == get_preferred_bss(service, &profile->band_preference, &score))
+	{
+		return;
+	}
+
+	WCALOG_INFO(MSGID_WIFI_BAND_STEERING_INFO, 0,
+	            "Reconnecting %s, its required band is available again", service->name);
+
+	g_free(band_steering_parked_path);
+	band_steering_parked_path = NULL;
+	connman_service_connect(service, NULL, NULL, NULL);
+}
+
+/**
+ *  @brief Look up the BSS the connected service is associated with, unless
+ *  it was looked up recently. Status subscribers are updated when it changed.
+ */
+
+/**
+ *  @brief Remember the BSS the connected service is associated with. Status
+ *  subscribers are updated when it changed.
+ */
+
+static void set_associated_bss(connman_service_t *service,
+                               const gchar *bssid, gint frequency)
+{
+	gboolean changed = g_strcmp0(associated_bss_path, service->path) ||
+	                   g_ascii_strcasecmp(associated_bssid, bssid) ||
+	                   associated_frequency != frequency;
+
+	g_free(associated_bss_path);
+	associated_bss_path = g_strdup(service->path);
+	g_strlcpy(associated_bssid, bssid, sizeof(associated_bssid));
+	associated_frequency = frequency;
+	associated_bss_time = g_get_monotonic_time();
+
+	if (changed)
+	{
+		wifi_send_status_to_subscribers();
+	}
+}
+
+static gboolean update_associated_bss(connman_service_t *service,
+                                      GError **error)
+{
+	gint64 now = g_get_monotonic_time();
+	gchar bssid[18];
+	gint frequency = 0;
+
+	if (!g_strcmp0(associated_bss_path, service->path) &&
+	        now - associated_bss_time < ASSOCIATED_BSS_REFRESH * G_USEC_PER_SEC)
+	{
+		return TRUE;
+	}
+
+	if (!nl80211_get_associated_bss(CONNMAN_WIFI_INTERFACE_NAME, bssid, &frequency,
+	                                error))
+	{
+		g_free(associated_bss_path);
+		associated_bss_path = NULL;
+		return FALSE;
+	}
+
+	set_associated_bss(service, bssid, frequency);
+	return TRUE;
+}
+
+typedef struct scan_results
+{
+	gboolean regulatory;
+	gboolean passpoint;
+	GList *passpoint_bsses;
+	gboolean associated;
+	gchar bssid[18];
+	gint frequency;
+} scan_results_t;
+
+static void scan_results_bss_cb(const guint8 *attrs, gsize len,
+                                gpointer user_data)
+{
+	scan_results_t *results = user_data;
+
+	if (results->regulatory)
+	{
+		regulatory_nl80211_add_bss(attrs, len);
+	}
+
+	if (results->passpoint)
+	{
+		passpoint_bss_t *bss = passpoint_nl80211_parse_bss(attrs, len);
+
+		if (NULL != bss)
+		{
+			results->passpoint_bsses = g_list_prepend(results->passpoint_bsses, bss);
+		}
+	}
+
+	if (nl80211_bss_get_associated(attrs, len, results->bssid,
+	                               &results->frequency))
+	{
+		results->associated = TRUE;
+	}
+}
+
+/**
+ *  @brief Dump the results of the last scan once and hand them to the
+ *  regulatory domain inference, the Hotspot 2.0 matching and the lookup of
+ *  the associated BSS
+ */
+
+static void read_scan_results(void)
+{
+	connman_technology_t *technology = connman_manager_find_wifi_technology(
+	                                       manager);
+	connman_service_t *service = connman_manager_get_connected_service(
+	                                 manager->wifi_services);
+	gint64 now = g_get_monotonic_time();
+	scan_results_t results = { 0 };
+	GError *error = NULL;
+
+	if (NULL == passpoint_get_credentials())
+	{
+		g_list_free_full(passpoint_matches, passpoint_bss_free);
+		passpoint_matches = NULL;
+	}
+
+	/* Services change several times per scan, dump each scan once */
+	if (scan_results_last_read > 0 &&
+	        now - scan_results_last_read < SCAN_RESULTS_INTERVAL * G_USEC_PER_SEC)
+	{
+		return;
+	}
+
+	results.regulatory = NULL != technology && technology->powered;
+	results.passpoint = NULL != passpoint_get_credentials();
+
+	if (!results.regulatory && !results.passpoint && NULL == service)
+	{
+		return;
+	}
+
+	scan_results_last_read = now;
+
+	if (!nl80211_dump_scan(CONNMAN_WIFI_INTERFACE_NAME, scan_results_bss_cb,
+	                       &results, &error))
+	{
+		WCALOG_ERROR(MSGID_WIFI_SCAN_RESULTS_ERROR, 0,
+		             "Failed to read the scan results: %s", error->message);
+		g_error_free(error);
+		g_list_free_full(results.passpoint_bsses, passpoint_bss_free);
+		return;
+	}
+
+	if (results.passpoint)
+	{
+		match_passpoint_networks(results.passpoint_bsses);
+	}
+
+	if (results.regulatory)
+	{
+		apply_regulatory_domain(technology);
+	}
+
+	if (NULL != service && results.associated)
+	{
+		set_associated_bss(service, results.bssid, results.frequency);
+	}
+}
+
+/**
+ *  @brief Steer the connection to the BSS the band preference of the
+ *  profile asks for. The supplicant is asked to roam when a better scoring
+ *  BSS of the network is around. Without any BSS in a required band the
+ *  network is disconnected, until the band is around again.
+ */
+
+static void check_band_steering(void)
+{
+	connman_service_t *service = connman_manager_get_connected_service(
+	                                 manager->wifi_services);
+	wifi_profile_t *profile = get_service_profile(service);
+	gint64 now = g_get_monotonic_time();
+	gchar bssid[18];
+	gint frequency = 0, best_score, current_score = BAND_STEERING_SCORE_OTHER;
+	const bssinfo_t *best;
+	GError *error = NULL;
+	guint i;
+
+	if (NULL == service)
+	{
+		g_free(associated_bss_path);
+		associated_bss_path = NULL;
+
+		if (NULL != band_steering_parked_path)
+		{
+			reconnect_band_steering_parked_service();
+		}
+
+		return;
+	}
+
+	g_free(band_steering_parked_path);
+	band_steering_parked_path = NULL;
+
+	if (!update_associated_bss(service, &error))
+	{
+		WCALOG_DEBUG("No associated BSS: %s", error->message);
+		g_error_free(error);
+		return;
+	}
+
+	/* Give the supplicant time to settle after each roam */
+	if (NULL == profile || !band_preference_is_set(&profile->band_preference) ||
+	        now - band_steering_last_roam < BAND_STEERING_HOLDOFF * G_USEC_PER_SEC)
+	{
+		return;
+	}
+
+	g_strlcpy(bssid, associated_bssid, sizeof(bssid));
+	frequency = associated_frequency;
+
+	best = get_preferred_bss(service, &profile->band_preference, &best_score);
+
+	for (i = 0; NULL != service->bss && i < service->bss->len; i++)
+	{
+		bssinfo_t *bss = &g_array_index(service->bss, bssinfo_t, i);
+
+		if (!g_ascii_strcasecmp(bss->bssid, bssid))
+		{
+			current_score = band_preference_score(&profile->band_preference, bss->bssid,
+			                                      bss->frequency, bss->signal);
+		}
+	}
+
+	if (NULL == best)
+	{
+		if (BAND_STEERING_SCORE_EXCLUDED == band_preference_score(
+		            &profile->band_preference, bssid, frequency, 0))
+		{
+			WCALOG_INFO(MSGID_WIFI_BAND_STEERING_INFO, 0,
+			            "No BSS of %s in the required band %s, disconnecting", service->name,
+			            wifi_band_to_string(profile->band_preference.band));
+			band_steering_parked_path = g_strdup(service->path);
+			connman_service_disconnect(service);
+		}
+
+		return;
+	}
+
+	if (best_score <= current_score || !g_ascii_strcasecmp(best->bssid, bssid))
+	{
+		return;
+	}
+
+	band_steering_last_roam = now;
+	/* Look the BSS up again once the roam is done */
+	associated_bss_time = 0;
+
+	WCALOG_INFO(MSGID_WIFI_BAND_STEERING_INFO, 0,
+	            "Roaming %s from %s (%d MHz) to %s (%d MHz, %d dBm)", service->name, bssid,
+	            frequency, best->bssid, best->frequency, best->signal);
+
+	if (!supplicant_roam(CONNMAN_WIFI_INTERFACE_NAME, best->bssid, &error))
+	{
+		WCALOG_ERROR(MSGID_WIFI_BAND_STEERING_ERROR, 0, "Failed to roam: %s",
+		             error->message);
+		g_error_free(error);
+	}
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_setbandpreference setBandPreference
+
+Sets the band and BSS the connection to the network of a profile is steered
+to. After each scan the BSS the radio is associated with is compared with the
+other BSSes of the network: a pinned BSS is preferred over the BSSes of the
+preferred band, which are preferred over the others. A BSS whose signal is
+below the RSSI floor counts as any other BSS, so a weak preferred BSS is
+given up for a usable one. When a better BSS is around, wpa_supplicant is
+asked to roam to it.
+
+With a required band the other bands are never used: without a BSS in the
+band the network is disconnected, and connected again once the band is
+around.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+profileId | yes | Integer | Id of the profile
+band | no | String | "any", "2.4GHz", "5GHz" or "6GHz", "any" by default
+required | no | Boolean | True to never use other bands, false by default
+bssid | no | String | BSSID to pin the connection to, "" or absent for none
+rssiFloor | no | Integer | Signal in dBm below which the preferred band and BSS are given up, -75 by default
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True on success, false otherwise
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_band_preference_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_5(PROP(profileId, integer),
+	                                     PROP(band, string), PROP(required, boolean), PROP(bssid, string),
+	                                     PROP(rssiFloor, integer)) REQUIRED_1(profileId))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref profileIdObj = {0}, requiredObj = {0}, floorObj = {0};
+	band_preference_t pref = { WIFI_BAND_ANY };
+	gchar *band = dup_string_param(parsedObj, "band");
+	gchar *bssid = dup_string_param(parsedObj, "bssid");
+	int profile_id = 0;
+	bool required = false;
+	guint64 mac;
+	wifi_profile_t *profile;
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("profileId"), &profileIdObj);
+	jnumber_get_i32(profileIdObj, &profile_id);
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("required"), &requiredObj))
+	{
+		jboolean_get(requiredObj, &required);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("rssiFloor"), &floorObj))
+	{
+		jnumber_get_i32(floorObj, &pref.rssi_floor);
+	}
+
+	profile = get_profile_by_id(profile_id);
+
+	if (NULL == profile)
+	{
+		LSMessageReplyCustomError(sh, message, "Profile not found",
+		                          WCA_API_ERROR_PROFILE_NOT_FOUND);
+		goto cleanup;
+	}
+
+	if ((NULL != band && !wifi_band_from_string(band, &pref.band)) ||
+	        (NULL != bssid && *bssid && !tethering_acl_parse_address(bssid, &mac)) ||
+	        (required && WIFI_BAND_ANY == pref.band) || pref.rssi_floor > 0)
+	{
+		LSMessageReplyCustomError(sh, message, "Invalid band preference",
+		                          WCA_API_ERROR_BAND_PREFERENCE_INVALID);
+		goto cleanup;
+	}
+
+	pref.required = required ? TRUE : FALSE;
+
+	if (NULL != bssid)
+	{
+		gchar *upper = g_ascii_strup(bssid, -1);
+		g_strlcpy(pref.bssid, upper, sizeof(pref.bssid));
+		g_free(upper);
+	}
+
+	profile->band_preference = pref;
+	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+
+	WCALOG_INFO(MSGID_WIFI_BAND_STEERING_INFO, 0,
+	            "Band preference of %s: %s%s, BSSID %s", profile->ssid,
+	            wifi_band_to_string(pref.band), pref.required ? " required" : "",
+	            *pref.bssid ? pref.bssid : "any");
+
+	/* Apply it right away */
+	band_steering_last_roam = 0;
+	check_band_steering();
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_free(band);
+	g_free(bssid);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ *  @brief Connect to the visible known network of highest priority. connman
+ *  autoconnects to whichever known network it finds first, so it is given a
+ *  targeted connect when another network should be used. A network the user
+ *  connected to is left alone for a while. Nothing is done unless an order
+ *  was set, and networks connman wouldn't autoconnect, which failed or
+ *  which band steering disconnected are never chosen.
+ */
+
+static void check_autoconnect_priority(void)
+{
+	const autoconnect_network_t *best;
+	GArray *networks;
+	GSList *iter;
+
+	if (NULL != current_connect_req ||
+	        NULL != connman_manager_get_connecting_service(manager->wifi_services) ||
+	        g_get_monotonic_time() - autoconnect_user_connect_time <
+	        AUTOCONNECT_USER_HOLDOFF * G_USEC_PER_SEC)
+	{
+		return;
+	}
+
+	if (!autoconnect_priority_index_profiles())
+	{
+		return;
+	}
+
+	networks = g_array_new(FALSE, FALSE, sizeof(autoconnect_network_t));
+
+	for (iter = manager->wifi_services; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = iter->data;
+		autoconnect_network_t network = { 0 };
+
+		if (NULL == service->name || NULL == service->security)
+		{
+			continue;
+		}
+
+		network.connected = connman_service_is_connected(service);
+
+		if (!network.connected && (!service->auto_connect ||
+		                           !g_strcmp0(service->path, band_steering_parked_path) ||
+		                           CONNMAN_SERVICE_STATE_FAILURE == connman_service_get_state(
+		                               service->state)))
+		{
+			continue;
+		}
+
+		network.ssid = service->name;
+		network.security = service->security[0];
+		network.strength = service->strength;
+		network.data = service;
+		g_array_append_val(networks, network);
+	}
+
+	best = autoconnect_priority_select((autoconnect_network_t *) networks->data,
+	                                   networks->len);
+
+	if (NULL != best)
+	{
+		connman_service_t *service = best->data;
+
+		WCALOG_INFO(MSGID_WIFI_AUTOCONNECT_PRIORITY_INFO, 0,
+		            "Connecting %s, the known network of highest priority", service->name);
+		connman_service_connect(service, NULL, NULL, NULL);
+	}
+
+	g_array_free(networks, TRUE);
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_setprofileorder setProfileOrder
+
+Sets the order in which known networks are preferred. After each scan the
+visible known network of highest priority whose signal strength is at least
+30 is connected. A connection is only moved to a network of higher priority,
+and only when that network was the best one after two scans in a row. For
+five minutes after a connect request the connection is left alone. Networks
+with autoconnect disabled, in the failure state or disconnected by band
+steering are not connected. Until an order is set connman's own autoconnect
+is left alone.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+profileIds | yes | Array of Integer | Ids of the profiles, most preferred first. Profiles not listed lose their priority.
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True on success, false otherwise
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_set_profile_order_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref parsedObj = {0};
+
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(ARRAY(profileIds,
+	                                     integer)) REQUIRED_1(profileIds))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref idsObj = {0};
+	wifi_profile_t *profile = NULL;
+	GPtrArray *ordered = g_ptr_array_new();
+	ssize_t i, num_elems;
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("profileIds"), &idsObj);
+	num_elems = jarray_size(idsObj);
+
+	for (i = 0; i < num_elems; i++)
+	{
+		int profile_id = 0;
+
+		jnumber_get_i32(jarray_get(idsObj, i), &profile_id);
+		profile = get_profile_by_id(profile_id);
+
+		if (NULL == profile)
+		{
+			LSMessageReplyCustomError(sh, message, "Profile not found",
+			                          WCA_API_ERROR_PROFILE_NOT_FOUND);
+			goto cleanup;
+		}
+
+		g_ptr_array_add(ordered, profile);
+	}
+
+	autoconnect_priority_set_order((wifi_profile_t **) ordered->pdata,
+	                               ordered->len);
+	store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_ptr_array_free(ordered, TRUE);
+	j_release(&parsedObj);
+	return true;
+}
+
+/**
+ *  @brief Hand the Wake-on-WLAN configuration to the driver when the system
+ *  is about to suspend and record what woke it up on resume
+ */
+
+static bool power_signal_cb(LSHandle *sh, LSMessage *message, void *context)
+{
+	const char *method = LSMessageGetMethod(message);
+	GError *error = NULL;
+
+	if (!g_strcmp0(method, POWER_SIGNAL_PREPARE_SUSPEND))
+	{
+		/* Without a configuration of ours WOLWOWLMode owns the driver's setup */
+		if (NULL == wowlan_get_config() && NULL != manager && manager->wol_wowl)
+		{
+			return true;
+		}
+
+		if (!wowlan_suspend(CONNMAN_WIFI_INTERFACE_NAME, &error))
+		{
+			WCALOG_ERROR(MSGID_WIFI_WOWLAN_ERROR, 0,
+			             "Failed to set up Wake-on-WLAN for suspend: %s", error->message);
+			g_error_free(error);
+		}
+	}
+	else if (!g_strcmp0(method, POWER_SIGNAL_RESUME))
+	{
+		const wowlan_wake_t *wake;
+
+		wowlan_resume();
+		wake = wowlan_get_last_wake();
+
+		WCALOG_INFO(MSGID_WIFI_WOWLAN_INFO, 0, "Resumed, woken up by %s",
+		            wake->trigger ? wowlan_trigger_to_string(wake->trigger) : "no wifi trigger");
+	}
+
+	return true;
+}
+
+static void watch_power_signals(LSHandle *handle)
+{
+	if (!LSCall(handle, "palm://com.palm.bus/signal/addmatch",
+	            "{\"category\":\"" POWER_SIGNAL_CATEGORY "\",\"method\":\""
+	            POWER_SIGNAL_PREPARE_SUSPEND "\"}", power_signal_cb, NULL, NULL, NULL) ||
+	        !LSCall(handle, "palm://com.palm.bus/signal/addmatch",
+	                "{\"category\":\"" POWER_SIGNAL_CATEGORY "\",\"method\":\""
+	                POWER_SIGNAL_RESUME "\"}", power_signal_cb, NULL, NULL, NULL))
+	{
+		WCALOG_DEBUG("Failed to watch the suspend and resume signals");
+	}
+}
+
+/**
+ *  @brief Warn about imported certificates which have expired or are about
+ *  to, while there is still time to renew them
+ */
+
+static gboolean check_certificate_expiry(gpointer user_data)
+{
+	gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+	gint64 window = (gint64) runtime_param_get(RUNTIME_PARAM_CERT_EXPIRY_WARNING) *
+	                CERT_DAY;
+	GList *expiring = cert_store_get_expiring(now, window);
+	GList *iter;
+
+	for (iter = expiring; NULL != iter; iter = iter->next)
+	{
+		const cert_info_t *info = iter->data;
+
+		if (now > info->not_after)
+		{
+			WCALOG_WARNING(MSGID_WIFI_CERT_EXPIRING, 0,
+			               "Certificate %s (%s) has expired", info->name, info->subject);
+		}
+		else
+		{
+			WCALOG_WARNING(MSGID_WIFI_CERT_EXPIRING, 0,
+			               "Certificate %s (%s) expires in %" G_GINT64_FORMAT " days",
+			               info->name, info->subject, (info->not_after - now) / CERT_DAY);
+		}
+	}
+
+	g_list_free(expiring);
+	return TRUE;
+}
+
+
+gint generate_new_wpspin(void)
+{
+	FILE *f = fopen("/dev/urandom", "rb");
+
+	if (f == NULL)
+	{
+		return -1;
+	}
+
+	//Generate 7 random digits
+	gint pin = 0;
+	int count = 0;
+
+	do
+	{
+		count = fread(&pin, sizeof(pin), 1, f);
+	}
+	while(count == -1 || pin < 0);
+
+	pin %= 10000000;
+	pin *= 10;
+
+	fclose(f);
+
+	// Append checksum digit in the end
+
+	unsigned int tmppin =  pin / 10;
+	unsigned int accum = 0;
+
+	while (tmppin)
+	{
+		accum += 3 * (tmppin % 10);
+		tmppin /= 10;
+		accum += tmppin % 10;
+		tmppin /= 10;
+	}
+
+	pin += ((10 - accum % 10) % 10);
+
+	return pin;
+}
+
+
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_createwpspin createwpspin
+
+Generates an 8 digit random wps pin
+
+@par Parameters
+
+None
+
+@par Returns(Call)
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | yes | Boolean | True
+wpspin | yes | String | 8 digit random wps pin number
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_create_wpspin_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	jvalue_ref reply = jobject_create();
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	gint wpspin = generate_new_wpspin();
+
+	if (wpspin < 0)
+	{
+		goto error;
+	}
+
+	char wpspin_str[9];
+	snprintf(wpspin_str, 9, "%08i", wpspin);
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("wpspin"), jstring_create(wpspin_str));
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+	goto cleanup;
+error:
+	LSMessageReplyCustomError(sh, message, "Error in generating wps pin",
+	                          WCA_API_ERROR_WPS_PIN);
+cleanup:
+
+	if (LSErrorIsSet(&lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	j_release(&reply);
+	return true;
+}
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi/p2p
+@{
+@section com_webos_wifi_startwps startwps
+
+Start WPS authentication process. If no wpsPin argument is supplied
+the WPS-PBC method will be used, else it will be WPS-PIN method.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+wpsPin | No | String | Pin for WPS-PIN mode
+
+@par Returns(Call) for all forms
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | Yes | Boolean | True
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_start_wps_command(LSHandle *sh, LSMessage *message,
+                                     void *context)
+{
+	if (!connman_status_check(manager, sh, message))
+	{
+		return true;
+	}
+
+	if (!wifi_technology_status_check(sh, message))
+	{
+		return true;
+	}
+
+	// To prevent memory leaks, schema should be checked before the variables will be initialized.
+	jvalue_ref parsedObj = {0};
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_1(PROP(wpsPin, string)))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref wpsPinObj = NULL;
+	char *wpspin = NULL;
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("wpsPin"), &wpsPinObj))
+	{
+		raw_buffer address_buf = jstring_get(wpsPinObj);
+		wpspin = g_strdup(address_buf.m_str);
+		jstring_free_buffer(address_buf);
+	}
+	else
+	{
+		wpspin = g_strdup("");
+	}
+
+	if (!connman_technology_start_wps(connman_manager_find_wifi_technology(manager),
+	                                  wpspin))
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	LSMessageReplySuccess(sh, message);
+cleanup:
+	g_free(wpspin);
+	j_release(&parsedObj);
+	return true;
+}
+
+
+
+//->Start of API documentation comment block
+/**
+@page com_webos_wifi com.webos.wifi
+@{
+@section com_webos_wifi_cancelwps cancelwps
+
+Cancel any ongoing WPS connection.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+None
+
+@par Returns(Call) for all forms
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | Yes | Boolean | True
+
+
+@par Returns(Subscription)
+
+Not applicable.
+
+@}
+*/
+//->End of API documentation comment block
+
+static bool handle_cancel_wps_command(LSHandle *sh, LSMessage *message,
+                                      void *context)
+{
+	if (!connman_status_check(manager, sh, message))
+	{
+		return true;
+	}
+
+	if (!wifi_technology_status_check(sh, message))
 	{
 		return true;
 	}
@@ -4039,6 +6637,8 @@ static void handle_luna_subscription_cancel(LSHandle *sh, LSMessage *message, vo
 	const char *category = LSMessageGetCategory(message);
 	const char *method = LSMessageGetMethod(message);
 
+	dbus_call_scope_cancel(LSMessageGetUniqueToken(message));
+
 	// check for findnetworks
 	if (!g_strcmp0(category, LUNA_CATEGORY_ROOT) &&
 	    !g_strcmp0(method, LUNA_METHOD_FINDNETWORKS))
@@ -4157,11 +6757,174 @@ static void agent_registered_callback(gpointer user_data)
 	}
 }
 
+static void liveness_probe_cb(GObject *source_object, GAsyncResult *res,
+                              gpointer user_data)
+{
+	GCancellable *cancellable = user_data;
+	GError *error = NULL;
+	GVariant *properties = NULL;
+
+	connman_interface_manager_call_get_properties_finish(
+	    CONNMAN_INTERFACE_MANAGER(source_object), &properties, res, &error);
+
+	if (error)
+	{
+		/* Cancelled calls were already accounted for by the prober */
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			connman_liveness_probe_done(liveness, cancellable, FALSE);
+		}
+
+		g_error_free(error);
+	}
+	else
+	{
+		g_variant_unref(properties);
+		connman_liveness_probe_done(liveness, cancellable, TRUE);
+	}
+
+	g_object_unref(cancellable);
+}
+
+static void liveness_probe(connman_liveness_t *liveness,
+                           GCancellable *cancellable, gpointer user_data)
+{
+	if (NULL == manager)
+	{
+		connman_liveness_probe_done(liveness, cancellable, FALSE);
+		return;
+	}
+
+	connman_interface_manager_call_get_properties(manager->remote, cancellable,
+	        liveness_probe_cb, g_object_ref(cancellable));
+}
+
+static void liveness_sample_cb(GObject *source_object, GAsyncResult *res,
+                               gpointer user_data)
+{
+	GCancellable *cancellable = user_data;
+	GError *error = NULL;
+	GVariant *services = NULL;
+
+	connman_interface_manager_call_get_services_finish(
+	    CONNMAN_INTERFACE_MANAGER(source_object), &services, res, &error);
+
+	if (error)
+	{
+		if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+		{
+			connman_liveness_sample_done(liveness, cancellable, FALSE, 0, 0);
+		}
+
+		g_error_free(error);
+	}
+	else
+	{
+		connman_liveness_sample_done(liveness, cancellable, TRUE,
+		                             connman_manager_hash_wifi_services_variant(services),
+		                             connman_manager_hash_wifi_services(manager));
+		g_variant_unref(services);
+	}
+
+	g_object_unref(cancellable);
+}
+
+static void liveness_sample(connman_liveness_t *liveness,
+                            GCancellable *cancellable, gpointer user_data)
+{
+	if (NULL == manager)
+	{
+		connman_liveness_sample_done(liveness, cancellable, FALSE, 0, 0);
+		return;
+	}
+
+	connman_interface_manager_call_get_services(manager->remote, cancellable,
+	        liveness_sample_cb, g_object_ref(cancellable));
+}
+
+static void connman_service_started(GDBusConnection *conn, const gchar *name,
+                                    const gchar *name_owner, gpointer user_data);
+static void connman_service_stopped(GDBusConnection *conn, const gchar *name,
+                                    const gchar *name_owner, gpointer user_data);
+
+/**
+ *  @brief Start over as if connman had restarted. Runs from the main loop
+ *  rather than from the failed check, the prober stays stopped meanwhile.
+ */
+
+static gboolean liveness_reattach_cb(gpointer user_data)
+{
+	liveness_reattach_source = 0;
+
+	connman_service_stopped(NULL, "net.connman", NULL, NULL);
+	connman_service_started(NULL, "net.connman", NULL, NULL);
+
+	return FALSE;
+}
+
+static void liveness_recover(connman_liveness_t *liveness,
+                             connman_liveness_level_t level, gpointer user_data)
+{
+	const connman_liveness_stats_t *stats = connman_liveness_get_stats(liveness);
+
+	WCALOG_INFO(MSGID_CONNMAN_LIVENESS_RECOVERY, 0,
+	            "Connman check failed, recovering with %s (checks %u, stalls %u, divergences %u)",
+	            connman_liveness_level_to_string(level), stats->checks, stats->stalls,
+	            stats->divergences);
+
+	switch (level)
+	{
+		case CONNMAN_LIVENESS_LEVEL_RESYNC:
+			connman_manager_resync_services(manager);
+			break;
+
+		case CONNMAN_LIVENESS_LEVEL_AGENT:
+			if (NULL != agent)
+			{
+				connman_manager_reregister_agent(manager, connman_agent_get_path(agent));
+			}
+
+			break;
+
+		case CONNMAN_LIVENESS_LEVEL_REATTACH:
+			connman_liveness_stop(liveness);
+
+			if (0 == liveness_reattach_source)
+			{
+				liveness_reattach_source = g_idle_add(liveness_reattach_cb, NULL);
+			}
+
+			break;
+
+		default:
+			break;
+	}
+}
+
+static const connman_liveness_ops_t liveness_ops =
+{
+	.probe = liveness_probe,
+	.sample = liveness_sample,
+	.recover = liveness_recover,
+};
+
 static void connman_service_stopped(GDBusConnection *conn, const gchar *name,
                                     const gchar *name_owner, gpointer user_data)
 {
 	WCALOG_DEBUG("connman service disappeared from the bus");
 
+	if (NULL != liveness)
+	{
+		connman_liveness_stop(liveness);
+	}
+
+	/* A pending reattach is moot, connman is set up again once it's back */
+	if (liveness_reattach_source > 0)
+	{
+		g_source_remove(liveness_reattach_source);
+		liveness_reattach_source = 0;
+	}
+
 	/* if scan is still scheduled abort it */
 	wifi_scan_stop();
 
@@ -4229,6 +6992,8 @@ static void connman_service_started(GDBusConnection *conn, const gchar *name,
 	        manager_services_changed_callback);
 	connman_manager_register_technologies_changed_cb(manager,
 	        manager_technologies_changed_callback);
+	connman_manager_register_groups_changed_cb(manager,
+	        manager_groups_changed_callback);
 
 	check_and_initialize_wifi_technology();
 	check_and_initialize_ethernet_technology();
@@ -4236,6 +7001,14 @@ static void connman_service_started(GDBusConnection *conn, const gchar *name,
 	check_and_initialize_bluetooth_technology();
 
 	connectionmanager_send_status_to_subscribers();
+
+	/* Name owner changes don't tell if connman hangs or signals got lost */
+	if (NULL == liveness)
+	{
+		liveness = connman_liveness_new(&liveness_ops, NULL);
+	}
+
+	connman_liveness_start(liveness);
 }
 
 /**
@@ -4283,6 +7056,21 @@ static LSMethod wifi_methods[] =
 	{ LUNA_METHOD_GET_MCHANNSCHED_MODE, handle_get_multichannel_sched_mode_command },
 	{ LUNA_METHOD_GET_WIFI_DIAGNOSTICS, handle_get_wifi_diagnostics_command },
 	{ LUNA_METHOD_SET_PASSTHROUGH_PARAMS, handle_set_passthrough_params_command },
+	{ LUNA_METHOD_SETPROFILENAMESPACE, handle_set_profile_namespace_command },
+	{ LUNA_METHOD_GETPROFILENAMESPACES, handle_get_profile_namespaces_command },
+	{ LUNA_METHOD_DELETEPROFILENAMESPACE, handle_delete_profile_namespace_command },
+	{ LUNA_METHOD_MOVEPROFILETONAMESPACE, handle_move_profile_to_namespace_command },
+	{ LUNA_METHOD_IMPORTCERTIFICATE, handle_import_certificate_command },
+	{ LUNA_METHOD_GETCERTIFICATES, handle_get_certificates_command },
+	{ LUNA_METHOD_DELETECERTIFICATE, handle_delete_certificate_command },
+	{ LUNA_METHOD_SETWOWLAN, handle_set_wowlan_command },
+	{ LUNA_METHOD_GETWOWLAN, handle_get_wowlan_command },
+	{ LUNA_METHOD_SETPASSPOINTCREDENTIAL, handle_set_passpoint_credential_command },
+	{ LUNA_METHOD_DELETEPASSPOINTCREDENTIAL, handle_delete_passpoint_credential_command },
+	{ LUNA_METHOD_GETPASSPOINTCREDENTIALS, handle_get_passpoint_credentials_command },
+	{ LUNA_METHOD_GETREGULATORYDOMAIN, handle_get_regulatory_domain_command },
+	{ LUNA_METHOD_SETBANDPREFERENCE, handle_set_band_preference_command },
+	{ LUNA_METHOD_SETPROFILEORDER, handle_set_profile_order_command },
 	{ },
 };
 
@@ -4293,6 +7081,7 @@ static LSMethod wifi_methods[] =
 
 int initialize_wifi_ls2_calls(GMainLoop *mainloop , LSHandle **wifi_handle)
 {
+	GError *error = NULL;
 	LSError lserror;
 	LSErrorInit(&lserror);
 	pLsHandle       = NULL;
@@ -4337,6 +7126,29 @@ int initialize_wifi_ls2_calls(GMainLoop *mainloop , LSHandle **wifi_handle)
 
 	init_wifi_profile_list();
 
+	if (!cert_store_init(CERT_STORE_DIR))
+	{
+		WCALOG_ERROR(MSGID_WIFI_CERT_STORE_ERROR, 0,
+		             "Failed to set up the certificate store in %s", CERT_STORE_DIR);
+	}
+
+	check_certificate_expiry(NULL);
+	g_timeout_add_seconds(CERT_EXPIRY_CHECK_INTERVAL, check_certificate_expiry,
+	                      NULL);
+
+	wowlan_init(&wowlan_nl80211_driver);
+	load_wifi_setting(WIFI_WOWLAN_SETTING, NULL);
+	load_wifi_setting(WIFI_PASSPOINT_SETTING, NULL);
+
+	if (!wowlan_nl80211_watch_start(&error))
+	{
+		WCALOG_ERROR(MSGID_WIFI_WOWLAN_ERROR, 0,
+		             "Wake-on-WLAN wake-ups won't be reported: %s", error->message);
+		g_error_free(error);
+	}
+
+	watch_power_signals(pLsHandle);
+
 	*wifi_handle = pLsHandle;
 
 	return 0;
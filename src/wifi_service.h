@@ -51,6 +51,21 @@
 #define LUNA_METHOD_GET_MCHANNSCHED_MODE    "getmultichannelschedmode"
 #define LUNA_METHOD_GET_WIFI_DIAGNOSTICS    "getwifidiagnostics"
 #define LUNA_METHOD_SET_PASSTHROUGH_PARAMS  "setPassthroughParams"
+#define LUNA_METHOD_SETPROFILENAMESPACE     "setProfileNamespace"
+#define LUNA_METHOD_GETPROFILENAMESPACES    "getProfileNamespaces"
+#define LUNA_METHOD_DELETEPROFILENAMESPACE  "deleteProfileNamespace"
+#define LUNA_METHOD_MOVEPROFILETONAMESPACE  "moveProfileToNamespace"
+#define LUNA_METHOD_IMPORTCERTIFICATE       "importCertificate"
+#define LUNA_METHOD_GETCERTIFICATES         "getCertificates"
+#define LUNA_METHOD_DELETECERTIFICATE       "deleteCertificate"
+#define LUNA_METHOD_SETWOWLAN               "setWowlan"
+#define LUNA_METHOD_GETWOWLAN               "getWowlan"
+#define LUNA_METHOD_SETPASSPOINTCREDENTIAL "setPasspointCredential"
+#define LUNA_METHOD_DELETEPASSPOINTCREDENTIAL "deletePasspointCredential"
+#define LUNA_METHOD_GETPASSPOINTCREDENTIALS "getPasspointCredentials"
+#define LUNA_METHOD_GETREGULATORYDOMAIN     "getRegulatoryDomain"
+#define LUNA_METHOD_SETBANDPREFERENCE       "setBandPreference"
+#define LUNA_METHOD_SETPROFILEORDER         "setProfileOrder"
 
 
 #define WIFI_ENTERPRISE_SECURITY_TYPE       "ieee8021x"
@@ -76,6 +91,21 @@ typedef struct connection_settings
 extern int initialize_wifi_ls2_calls(GMainLoop *mainloop,
                                      LSHandle **wifi_handle);
 extern connection_settings_t *connection_settings_new(void);
+extern void connection_settings_free(connection_settings_t *settings);
+
+/**
+ * Check the certificates of an enterprise profile against the certificate
+ * store and reply to the message with an error if they aren't valid
+ *
+ * @param[IN]  sh Luna service handle
+ * @param[IN]  message Message to reply to on failure
+ * @param[IN]  ca_cert_file Path of the CA certificate, can be NULL
+ * @param[IN]  client_cert_file Path of the client certificate, can be NULL
+ *
+ * @return TRUE if valid, FALSE if an error reply was sent
+ */
+extern gboolean check_enterprise_certificates(LSHandle *sh,
+        LSMessage *message, const gchar *ca_cert_file, const gchar *client_cert_file);
 extern GVariant *agent_request_input_callback(GVariant *fields, gpointer data);
 extern gint generate_new_wpspin(void);
 extern void wifi_service_local_has_changed();
@@ -23,16 +23,27 @@
 
 #include <glib.h>
 #include <glib/gstdio.h>
-#include <openssl/blowfish.h>
 #include <lunaprefs.h>
 #include <pbnjson.h>
 #include <sys/inotify.h>
 
 #include "wifi_setting.h"
 #include "wifi_profile.h"
+#include "wifi_tethering_acl.h"
+#include "wired_8021x.h"
+#include "wowlan.h"
+#include "wan_failover.h"
+#include "p2p_group_cache.h"
+#include "passpoint.h"
+#include "network_fingerprint.h"
+#include "connman_service.h"
+#include "profile_crypto.h"
 #include "connman_common.h"
 #include "logging.h"
 
+/* Group of the wired 802.1X profile in its .config file */
+#define WIRED_CONFIG_GROUP  "service_ethernet"
+
 /**
  * WiFi setting keys used to identify settings stored in luna-prefs database.
  * THE SEQUENCE MUST MATCH THE VALUES OF WIFI SETTINGS DEFINED IN wifi_setting.h
@@ -43,126 +54,83 @@ static const char *SettingKey[] =
 
 	"profileList", /**< Setting key for profile list */
 
-	"Last-DO-NOT-USE" /**< Marker used to indicate the end of setting keys */
-};
-
-/**
- * @brief Encrypt the given input using the supplied key
- * The encrypt /decrypt functions are useful for storing wifi profiles
- * which may contain secret passwords / passphrases
- */
-
-static char *wifi_setting_encrypt(const char *input_str, const char *key)
-{
-	BF_KEY *pBfKey = g_new0(BF_KEY, 1);
-	gchar *b64str = NULL;
-	char *result = NULL;
-	long len;
-	char *output_str = NULL;
-	unsigned char ivec[8] = {0};
-	int num = 0;
-
-	if (pBfKey == NULL)
-	{
-		goto Exit;
-	}
+	"tetheringAccessLists", /**< Setting key for tethering station access lists */
 
-	if (!input_str || !key || !strlen(input_str) || !strlen(key))
-	{
-		goto Exit;
-	}
+	"networkBindings", /**< Setting key for settings bound to network fingerprints */
 
-	BF_set_key(pBfKey, strlen(key), (const unsigned char *)(key));
+	"wowlan", /**< Setting key for the Wake-on-WLAN configuration */
 
-	len = strlen(input_str);
+	"wanPreferences", /**< Setting key for the cellular context preference list */
 
-	output_str = g_new0(char, len + 1);
+	"p2pGroupCache", /**< Setting key for the cache of persistent P2P groups */
 
-	if (!output_str)
-	{
-		goto Exit;
-	}
+	"passpointCredentials", /**< Setting key for the Hotspot 2.0 credentials */
 
-	memset(output_str, 0, len + 1);
+	"dnsReorderedServices", /**< Setting key for the services with reordered nameservers */
 
-	BF_cfb64_encrypt((const unsigned char *)(input_str),
-	                 (unsigned char *)(output_str),
-	                 len, pBfKey, ivec, &num, BF_ENCRYPT);
+	"Last-DO-NOT-USE" /**< Marker used to indicate the end of setting keys */
+};
 
-	b64str = g_base64_encode((const guchar *)(output_str), len);
+static gchar *dup_json_string(jvalue_ref parent, const char *key)
+{
+	jvalue_ref value = {0};
+	gchar *str = NULL;
 
-	if (b64str)
+	if (jobject_get_exists(parent, j_cstr_to_buffer(key), &value) &&
+	        jis_string(value))
 	{
-		result = strdup(b64str);
-		g_free(b64str);
+		raw_buffer buf = jstring_get(value);
+		str = g_strdup(buf.m_str);
+		jstring_free_buffer(buf);
 	}
 
-Exit:
-	g_free(output_str);
-	g_free(pBfKey);
-	return result;
+	return str;
 }
 
-/**
- * @brief Decrypt the given input using the supplied key
- * The encrypt /decrypt functions are useful for storing wifi profiles
- * which may contain secret passwords / passphrases
- */
-
-
-static char *wifi_setting_decrypt(const char *input_str, const char *key)
+static void populate_band_preference(jvalue_ref bandObj,
+                                     band_preference_t *pref)
 {
-	BF_KEY *pBfKey = g_new0(BF_KEY, 1);
-	char *result = NULL;
-	long len = 0;
-	guchar *b64str = NULL;
-	char *output_str = NULL;
-	unsigned char ivec[8] = {0};
-	int num = 0;
+	jvalue_ref requiredObj = {0}, floorObj = {0};
+	gchar *band = dup_json_string(bandObj, "band");
+	gchar *bssid = dup_json_string(bandObj, "bssid");
+	bool required = false;
 
-	if (pBfKey == NULL)
+	if (!wifi_band_from_string(band, &pref->band))
 	{
-		goto Exit;
+		pref->band = WIFI_BAND_ANY;
 	}
 
-	if (!input_str || !key || !strlen(input_str) || !strlen(key))
+	if (jobject_get_exists(bandObj, J_CSTR_TO_BUF("required"), &requiredObj))
 	{
-		goto Exit;
+		jboolean_get(requiredObj, &required);
 	}
 
-	BF_set_key(pBfKey, strlen(key), (const unsigned char *)key);
+	pref->required = required ? TRUE : FALSE;
 
-
-	b64str = g_base64_decode((const gchar *)(input_str), (gsize *)(&len));
-
-	if (b64str)
+	if (jobject_get_exists(bandObj, J_CSTR_TO_BUF("rssiFloor"), &floorObj))
 	{
-		output_str = g_new0(char, len + 1);
-
-		if (!output_str)
-		{
-			g_free(b64str);
-			goto Exit;
-		}
-
-		memset(output_str, 0, len + 1);
-
-		BF_cfb64_encrypt((const unsigned char *)(b64str), (unsigned char *)(output_str),
-		                 len, pBfKey, ivec, &num, BF_DECRYPT);
-
-		result = strdup(output_str);
+		jnumber_get_i32(floorObj, &pref->rssi_floor);
+	}
 
-		g_free(output_str);
-		g_free(b64str);
+	if (NULL != bssid)
+	{
+		g_strlcpy(pref->bssid, bssid, sizeof(pref->bssid));
 	}
 
-Exit:
-	g_free(pBfKey);
-	return result;
+	g_free(band);
+	g_free(bssid);
 }
 
+/**
+ * @brief Create a profile from its stored, encrypted form
+ *
+ * A profile which fails to decrypt is skipped with an error instead of
+ * parsing whatever the cipher returned. needs_migration is set if the
+ * profile was stored in the legacy format and needs to be stored again.
+ */
 
-static gboolean populate_wifi_profile(jvalue_ref profileObj)
+static gboolean populate_wifi_profile(jvalue_ref profileObj,
+                                      gboolean *needs_migration)
 {
 	gboolean ret = FALSE;
 	jvalue_ref wifiProfileObj, ssidObj, securityListObj, hiddenObj, configuredObj;
@@ -173,9 +141,29 @@ static gboolean populate_wifi_profile(jvalue_ref profileObj)
 		raw_buffer enc_profile_buf = jstring_get(wifiProfileObj);
 		gchar *enc_profile = g_strdup(enc_profile_buf.m_str);
 		jstring_free_buffer(enc_profile_buf);
-		gchar *dec_profile = wifi_setting_decrypt(enc_profile, WIFI_LUNA_PREFS_ID);
+		gboolean legacy = FALSE;
+		GError *error = NULL;
+		gchar *dec_profile = profile_crypto_decrypt(enc_profile, WIFI_LUNA_PREFS_ID,
+		                     &legacy, &error);
 
 		jvalue_ref parsedObj = {0};
+
+		if (NULL == dec_profile)
+		{
+			WCALOG_ERROR(MSGID_SETTING_PROFILE_DECRYPT_ERROR, 1, PMLOGKS("Error",
+			             error->message), "Skipping stored profile");
+			g_error_free(error);
+
+			/* Don't give up on the remaining profiles because of this one */
+			ret = TRUE;
+			goto Exit;
+		}
+
+		if (legacy)
+		{
+			*needs_migration = TRUE;
+		}
+
 		jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
 		                           NULL);
 
@@ -212,6 +200,7 @@ static gboolean populate_wifi_profile(jvalue_ref profileObj)
 
 		bool hidden = false;
 		bool configured = false;
+		gchar *namespace_name = dup_json_string(parsedObj, "namespace");
 
 		if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("security"), &securityListObj))
 		{
@@ -240,15 +229,44 @@ static gboolean populate_wifi_profile(jvalue_ref profileObj)
 			jboolean_get(configuredObj, &configured);
 		}
 
+		// Profiles stored before namespaces existed are shared by everyone
+		if (!profile_namespace_is_valid_name(namespace_name))
+		{
+			g_free(namespace_name);
+			namespace_name = g_strdup(PROFILE_NAMESPACE_DEVICE);
+		}
+
 		// Converting bool to gboolean as create_new_profile expects gboolean
-		if ((security != NULL &&
-		        NULL == get_profile_by_ssid_security(ssid, security[0])) ||
-		        ((security == NULL && NULL == get_profile_by_ssid(ssid))))
+		if (NULL == get_profile_by_ssid_security_in_namespace(namespace_name, ssid,
+		        security != NULL ? security[0] : NULL))
 		{
-			create_new_profile(ssid, security, hidden ? TRUE : FALSE,
-			                   configured ? TRUE : FALSE);
+			wifi_profile_t *profile = create_new_profile_in_namespace(ssid, security,
+			                          hidden ? TRUE : FALSE, configured ? TRUE : FALSE, namespace_name);
+			jvalue_ref bandObj = {0}, priorityObj = {0};
+			gboolean preferences = FALSE;
+
+			if (NULL != profile &&
+			        jobject_get_exists(parsedObj, J_CSTR_TO_BUF("bandPreference"), &bandObj))
+			{
+				populate_band_preference(bandObj, &profile->band_preference);
+				preferences = TRUE;
+			}
+
+			if (NULL != profile &&
+			        jobject_get_exists(parsedObj, J_CSTR_TO_BUF("priority"), &priorityObj))
+			{
+				jnumber_get_i32(priorityObj, &profile->priority);
+				preferences = TRUE;
+			}
+
+			/* Creating the profile stored it without its preferences */
+			if (preferences)
+			{
+				store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+			}
 		}
 
+		g_free(namespace_name);
 		g_strfreev(security);
 		g_free(ssid);
 Exit:
@@ -260,12 +278,245 @@ Exit:
 	return ret;
 }
 
+static GStrv dup_json_strv(jvalue_ref parent, const char *key)
+{
+	jvalue_ref array = {0};
+	GStrv strv = NULL;
+
+	if (jobject_get_exists(parent, j_cstr_to_buffer(key), &array) &&
+	        jis_array(array))
+	{
+		ssize_t i, num_elems = jarray_size(array);
+		strv = g_new0(gchar *, num_elems + 1);
+
+		for (i = 0; i < num_elems; i++)
+		{
+			raw_buffer buf = jstring_get(jarray_get(array, i));
+			strv[i] = g_strdup(buf.m_str);
+			jstring_free_buffer(buf);
+		}
+	}
+
+	return strv;
+}
+
+/**
+ * @brief Restore the settings bound to a network fingerprint from their json object
+ */
+
+static gboolean populate_network_binding(jvalue_ref bindingObj)
+{
+	jvalue_ref ipv4Obj = {0}, proxyObj = {0};
+	guint64 fingerprint;
+	gchar *fingerprint_str = dup_json_string(bindingObj, "fingerprint");
+	gboolean valid = network_fingerprint_from_string(fingerprint_str, &fingerprint);
+
+	g_free(fingerprint_str);
+
+	if (!valid)
+	{
+		return FALSE;
+	}
+
+	if (jobject_get_exists(bindingObj, J_CSTR_TO_BUF("ipv4"), &ipv4Obj))
+	{
+		ipv4info_t ipv4 =
+		{
+			.method = dup_json_string(ipv4Obj, "method"),
+			.address = dup_json_string(ipv4Obj, "address"),
+			.netmask = dup_json_string(ipv4Obj, "netmask"),
+			.gateway = dup_json_string(ipv4Obj, "gateway"),
+		};
+
+		network_binding_set_ipv4(fingerprint, &ipv4);
+		g_free(ipv4.method);
+		g_free(ipv4.address);
+		g_free(ipv4.netmask);
+		g_free(ipv4.gateway);
+	}
+
+	GStrv dns = dup_json_strv(bindingObj, "dns");
+
+	if (NULL != dns)
+	{
+		network_binding_set_dns(fingerprint, dns);
+		g_strfreev(dns);
+	}
+
+	if (jobject_get_exists(bindingObj, J_CSTR_TO_BUF("proxy"), &proxyObj))
+	{
+		proxyinfo_t proxy =
+		{
+			.method = dup_json_string(proxyObj, "method"),
+			.url = dup_json_string(proxyObj, "url"),
+			.servers = dup_json_strv(proxyObj, "servers"),
+			.excludes = dup_json_strv(proxyObj, "excludes"),
+		};
+
+		network_binding_set_proxy(fingerprint, &proxy);
+		g_free(proxy.method);
+		g_free(proxy.url);
+		g_strfreev(proxy.servers);
+		g_strfreev(proxy.excludes);
+	}
+
+	return TRUE;
+}
+
+/**
+ * @brief Fill the empty settings of an applied binding from their json object
+ */
+
+static void parse_applied_settings(jvalue_ref settingsObj,
+                                   network_binding_t *settings)
+{
+	jvalue_ref ipv4Obj = {0}, proxyObj = {0};
+
+	if (jobject_get_exists(settingsObj, J_CSTR_TO_BUF("ipv4"), &ipv4Obj))
+	{
+		settings->ipv4.method = dup_json_string(ipv4Obj, "method");
+		settings->ipv4.address = dup_json_string(ipv4Obj, "address");
+		settings->ipv4.netmask = dup_json_string(ipv4Obj, "netmask");
+		settings->ipv4.gateway = dup_json_string(ipv4Obj, "gateway");
+	}
+
+	settings->dns = dup_json_strv(settingsObj, "dns");
+
+	if (jobject_get_exists(settingsObj, J_CSTR_TO_BUF("proxy"), &proxyObj))
+	{
+		settings->proxy.method = dup_json_string(proxyObj, "method");
+		settings->proxy.url = dup_json_string(proxyObj, "url");
+		settings->proxy.servers = dup_json_strv(proxyObj, "servers");
+		settings->proxy.excludes = dup_json_strv(proxyObj, "excludes");
+	}
+}
+
+/**
+ * @brief Restore the record of the bound settings applied to a service from
+ * its json object
+ */
+
+static gboolean populate_applied_binding(jvalue_ref appliedObj)
+{
+	jvalue_ref writtenObj = {0}, previousObj = {0};
+	gchar *identifier = dup_json_string(appliedObj, "identifier");
+	gchar *site_str = dup_json_string(appliedObj, "site");
+	gchar *fingerprint_str = NULL;
+	network_applied_t *applied;
+	guint64 site;
+	gboolean valid = NULL != identifier &&
+	                 network_fingerprint_from_string(site_str, &site) &&
+	                 jobject_get_exists(appliedObj, J_CSTR_TO_BUF("written"), &writtenObj) &&
+	                 jobject_get_exists(appliedObj, J_CSTR_TO_BUF("previous"), &previousObj);
+
+	if (valid)
+	{
+		applied = network_binding_set_applied(identifier, site);
+		fingerprint_str = dup_json_string(writtenObj, "fingerprint");
+		network_fingerprint_from_string(fingerprint_str,
+		                                &applied->written.fingerprint);
+		parse_applied_settings(writtenObj, &applied->written);
+		parse_applied_settings(previousObj, &applied->previous);
+	}
+
+	g_free(fingerprint_str);
+	g_free(site_str);
+	g_free(identifier);
+	return valid;
+}
+
+/**
+ * @brief Restore a cached P2P group from its json object
+ */
+
+static gboolean populate_p2p_group(jvalue_ref groupObj)
+{
+	jvalue_ref freqObj = {0}, lastUsedObj = {0};
+	p2p_group_role_t role;
+	gint freq = 0;
+	gint64 last_used = 0;
+	gchar *role_str = dup_json_string(groupObj, "role");
+	gchar *peer_address = dup_json_string(groupObj, "peerAddress");
+	gchar *group_name = dup_json_string(groupObj, "groupName");
+	gboolean valid = p2p_group_role_from_string(role_str, &role) &&
+	                 NULL != peer_address;
+
+	if (jobject_get_exists(groupObj, J_CSTR_TO_BUF("freq"), &freqObj))
+	{
+		jnumber_get_i32(freqObj, &freq);
+	}
+
+	if (jobject_get_exists(groupObj, J_CSTR_TO_BUF("lastUsed"), &lastUsedObj))
+	{
+		jnumber_get_i64(lastUsedObj, &last_used);
+	}
+
+	if (valid)
+	{
+		p2p_group_cache_update(peer_address, role, freq, group_name, last_used);
+	}
+
+	g_free(role_str);
+	g_free(peer_address);
+	g_free(group_name);
+
+	return valid;
+}
+
+/**
+ * @brief Restore a Hotspot 2.0 credential from its json object
+ */
+
+static gboolean populate_passpoint_credential(jvalue_ref credentialObj)
+{
+	jvalue_ref priorityObj = {0};
+	gchar *id = dup_json_string(credentialObj, "id");
+	passpoint_credential_t *credential = passpoint_credential_new(id);
+
+	g_free(id);
+
+	credential->realm = dup_json_string(credentialObj, "realm");
+	credential->domain = dup_json_string(credentialObj, "domain");
+	credential->roaming_consortiums = dup_json_strv(credentialObj,
+	                                  "roamingConsortiums");
+	credential->eap_type = dup_json_string(credentialObj, "eapType");
+	credential->identity = dup_json_string(credentialObj, "identity");
+	credential->passphrase = dup_json_string(credentialObj, "passphrase");
+	credential->ca_cert_file = dup_json_string(credentialObj, "caCertFile");
+	credential->client_cert_file = dup_json_string(credentialObj,
+	                               "clientCertFile");
+	credential->private_key_file = dup_json_string(credentialObj,
+	                               "privateKeyFile");
+	credential->private_key_passphrase = dup_json_string(credentialObj,
+	                                     "privateKeyPassphrase");
+	credential->phase2 = dup_json_string(credentialObj, "phase2");
+
+	if (jobject_get_exists(credentialObj, J_CSTR_TO_BUF("priority"), &priorityObj))
+	{
+		jnumber_get_i32(priorityObj, &credential->priority);
+	}
+
+	if (!passpoint_credential_is_valid(credential))
+	{
+		passpoint_credential_free(credential);
+		return FALSE;
+	}
+
+	passpoint_add_credential(credential);
+	return TRUE;
+}
+
 /**
  * @brief Get the values of given settings from luna-prefs
  *
  * The param data can be supplied for copying the values of settings
- * (Not required for WIFI_PROFILELIST_SETTING since this function
- * will update the wifi profile list itself
+ * (Not required for WIFI_PROFILELIST_SETTING, WIFI_TETHERING_ACL_SETTING,
+ * WIFI_NETWORK_BINDINGS_SETTING, WIFI_WOWLAN_SETTING,
+ * WIFI_WAN_PREFERENCES_SETTING, WIFI_P2P_GROUP_CACHE_SETTING,
+ * WIFI_PASSPOINT_SETTING and WIFI_DNS_REORDER_SETTING since this function
+ * will update the wifi profile list, tethering access lists, network bindings,
+ * Wake-on-WLAN configuration, cellular context preferences, P2P group cache,
+ * Hotspot 2.0 credentials and services with reordered nameservers itself
  */
 
 gboolean load_wifi_setting(wifi_setting_type_t setting, void *data)
@@ -320,6 +571,16 @@ gboolean load_wifi_setting(wifi_setting_type_t setting, void *data)
 			}
 
 			jvalue_ref profileListObj = {0};
+			gchar *active_namespace = dup_json_string(parsedObj, "activeNamespace");
+
+			// The .config files in connman's folder are those of the namespace
+			// which was active when the profiles were last stored
+			if (profile_namespace_is_valid_name(active_namespace))
+			{
+				profile_namespace_set_active(profile_namespace_ensure(active_namespace));
+			}
+
+			g_free(active_namespace);
 
 			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("profileList"),
 			                       &profileListObj))
@@ -330,114 +591,665 @@ gboolean load_wifi_setting(wifi_setting_type_t setting, void *data)
 				}
 
 				ssize_t i, num_elems = jarray_size(profileListObj);
+				gboolean needs_migration = FALSE;
 
 				for (i = 0; i < num_elems; i++)
 				{
 					jvalue_ref profileObj = jarray_get(profileListObj, i);
 
 					// Parse json strings to create profiles and append them to profile list
-					if (populate_wifi_profile(profileObj) == FALSE)
+					if (populate_wifi_profile(profileObj, &needs_migration) == FALSE)
 					{
 						goto Exit_Case;
 					}
 				}
 
 				ret = TRUE;
+
+				// Store profiles from older versions again in the current format
+				if (needs_migration)
+				{
+					WCALOG_INFO(MSGID_SETTING_PROFILE_MIGRATION, 0,
+					            "Migrating stored profiles to the current format");
+					store_wifi_setting(WIFI_PROFILELIST_SETTING, NULL);
+				}
 			}
 
 Exit_Case:
 			j_release(&parsedObj);
+			break;
 		}
 
-		default:
-			break;
-	}
+		case WIFI_TETHERING_ACL_SETTING:
+		{
+			jvalue_ref allowListObj = {0}, denyListObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
 
-Exit:
-	g_free(setting_value);
-	return ret;
-}
+			if (!input_schema)
+			{
+				goto Exit;
+			}
 
-static void add_wifi_profile(jvalue_ref *profile_j, wifi_profile_t *profile)
-{
-	jobject_put(*profile_j, J_CSTR_TO_JVAL("ssid"), jstring_create(profile->ssid));
-	jobject_put(*profile_j, J_CSTR_TO_JVAL("profileId"),
-	            jnumber_create_i32(profile->profile_id));
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
 
-	if (profile->hidden)
-	{
-		jobject_put(*profile_j, J_CSTR_TO_JVAL("wasCreatedWithJoinOther"),
-		            jboolean_create(profile->hidden));
-	}
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
 
-	if (profile->configured)
-	{
-		jobject_put(*profile_j, J_CSTR_TO_JVAL("configured"),
-		            jboolean_create(profile->configured));
-	}
+			ret = TRUE;
 
-	if (profile->security != NULL)
-	{
-		jvalue_ref security_list = jarray_create(NULL);
-		gsize i;
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("allowList"), &allowListObj))
+			{
+				raw_buffer allow_buf = jstring_get(allowListObj);
+				ret = tethering_acl_deserialize(TETHERING_ACL_ALLOW, allow_buf.m_str) && ret;
+				jstring_free_buffer(allow_buf);
+			}
 
-		for (i = 0; i < g_strv_length(profile->security); i++)
-		{
-			jarray_append(security_list, jstring_create(profile->security[i]));
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("denyList"), &denyListObj))
+			{
+				raw_buffer deny_buf = jstring_get(denyListObj);
+				ret = tethering_acl_deserialize(TETHERING_ACL_DENY, deny_buf.m_str) && ret;
+				jstring_free_buffer(deny_buf);
+			}
+
+			j_release(&parsedObj);
+			break;
 		}
 
-		jobject_put(*profile_j, J_CSTR_TO_JVAL("security"), security_list);
-	}
-}
+		case WIFI_NETWORK_BINDINGS_SETTING:
+		{
+			jvalue_ref bindingsObj = {0}, appliedObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
 
-static gchar *add_wifi_profile_list(void)
-{
-	if (profile_list_is_empty())
-	{
-		return NULL;
-	}
+			if (!input_schema)
+			{
+				goto Exit;
+			}
 
-	gchar *profile_list_str = NULL;
-	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
-	                              DOMOPT_NOOPT, NULL);
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
 
-	if (response_schema)
-	{
-		jvalue_ref profilelist_j = jobject_create();
-		jvalue_ref profilelist_arr_j = jarray_create(NULL);
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
 
-		wifi_profile_t *profile = get_next_profile(NULL);
+			ret = TRUE;
 
-		while (NULL != profile)
-		{
-			jvalue_ref profileinfo_j = jobject_create();
-			jvalue_ref profile_j = jobject_create();
-			add_wifi_profile(&profile_j, profile);
-			const gchar *profile_str = jvalue_tostring(profile_j, response_schema);
-			gchar *enc_profile_str = wifi_setting_encrypt(profile_str, WIFI_LUNA_PREFS_ID);
-			j_release(&profile_j);
-			jobject_put(profileinfo_j, J_CSTR_TO_JVAL("wifiProfile"),
-			            jstring_create(enc_profile_str));
-			jarray_append(profilelist_arr_j, profileinfo_j);
-			profile = get_next_profile(profile);
-			g_free(enc_profile_str);
-		}
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("bindings"), &bindingsObj) &&
+			        jis_array(bindingsObj))
+			{
+				ssize_t i, num_elems = jarray_size(bindingsObj);
 
-		jobject_put(profilelist_j, J_CSTR_TO_JVAL("profileList"), profilelist_arr_j);
-		profile_list_str = g_strdup(jvalue_tostring(profilelist_j, response_schema));
-		jschema_release(&response_schema);
-		j_release(&profilelist_j);
-	}
+				for (i = 0; i < num_elems; i++)
+				{
+					ret = populate_network_binding(jarray_get(bindingsObj, i)) && ret;
+				}
+			}
 
-	return profile_list_str;
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("applied"), &appliedObj) &&
+			        jis_array(appliedObj))
+			{
+				ssize_t i, num_elems = jarray_size(appliedObj);
+
+				/* Plain identifiers of older versions don't say what to put back */
+				for (i = 0; i < num_elems; i++)
+				{
+					jvalue_ref elemObj = jarray_get(appliedObj, i);
+
+					if (jis_object(elemObj))
+					{
+						ret = populate_applied_binding(elemObj) && ret;
+					}
+				}
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		case WIFI_WOWLAN_SETTING:
+		{
+			jvalue_ref configObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
+
+			if (!input_schema)
+			{
+				goto Exit;
+			}
+
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
+
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
+
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("config"), &configObj))
+			{
+				raw_buffer config_buf = jstring_get(configObj);
+				wowlan_config_t *config = wowlan_config_from_string(config_buf.m_str, NULL);
+				jstring_free_buffer(config_buf);
+
+				/* Checked against the driver on suspend */
+				if (NULL != config)
+				{
+					wowlan_load_config(config);
+					ret = TRUE;
+				}
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		case WIFI_WAN_PREFERENCES_SETTING:
+		{
+			jvalue_ref contextsObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
+
+			if (!input_schema)
+			{
+				goto Exit;
+			}
+
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
+
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
+
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("contexts"), &contextsObj) &&
+			        jis_array(contextsObj))
+			{
+				ssize_t i, num_elems = jarray_size(contextsObj);
+				gchar **names = g_new0(gchar *, num_elems + 1);
+
+				for (i = 0; i < num_elems; i++)
+				{
+					raw_buffer name_buf = jstring_get(jarray_get(contextsObj, i));
+					names[i] = g_strdup(name_buf.m_str);
+					jstring_free_buffer(name_buf);
+				}
+
+				wan_failover_set_preferences((const gchar * const *) names);
+				g_strfreev(names);
+				ret = TRUE;
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		case WIFI_P2P_GROUP_CACHE_SETTING:
+		{
+			jvalue_ref groupsObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
+
+			if (!input_schema)
+			{
+				goto Exit;
+			}
+
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
+
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
+
+			ret = TRUE;
+
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("groups"), &groupsObj) &&
+			        jis_array(groupsObj))
+			{
+				ssize_t i, num_elems = jarray_size(groupsObj);
+
+				for (i = 0; i < num_elems; i++)
+				{
+					ret = populate_p2p_group(jarray_get(groupsObj, i)) && ret;
+				}
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		case WIFI_PASSPOINT_SETTING:
+		{
+			jvalue_ref credentialsObj = {0}, networksObj = {0};
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
+
+			if (!input_schema)
+			{
+				goto Exit;
+			}
+
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+
+			if (jis_null(parsedObj))
+			{
+				jschema_release(&input_schema);
+				goto Exit;
+			}
+
+			gchar *enc_credentials = dup_json_string(parsedObj, "credentials");
+			gchar *dec_credentials = NULL;
+			GError *error = NULL;
+
+			j_release(&parsedObj);
+
+			if (NULL != enc_credentials)
+			{
+				dec_credentials = profile_crypto_decrypt(enc_credentials, WIFI_LUNA_PREFS_ID,
+				                  NULL, &error);
+				g_free(enc_credentials);
+			}
+
+			if (NULL == dec_credentials)
+			{
+				if (NULL != error)
+				{
+					WCALOG_ERROR(MSGID_SETTING_PROFILE_DECRYPT_ERROR, 1, PMLOGKS("Error",
+					             error->message), "Skipping stored Hotspot 2.0 credentials");
+					g_error_free(error);
+				}
+
+				jschema_release(&input_schema);
+				goto Exit;
+			}
+
+			parsedObj = jdom_parse(j_cstr_to_buffer(dec_credentials), DOMOPT_NOOPT,
+			                       &schemaInfo);
+			jschema_release(&input_schema);
+			g_free(dec_credentials);
+
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
+
+			ret = TRUE;
+
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("credentials"),
+			                       &credentialsObj) && jis_array(credentialsObj))
+			{
+				ssize_t i, num_elems = jarray_size(credentialsObj);
+
+				for (i = 0; i < num_elems; i++)
+				{
+					ret = populate_passpoint_credential(jarray_get(credentialsObj, i)) && ret;
+				}
+			}
+
+			if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("networks"), &networksObj) &&
+			        jis_array(networksObj))
+			{
+				ssize_t i, num_elems = jarray_size(networksObj);
+
+				for (i = 0; i < num_elems; i++)
+				{
+					jvalue_ref networkObj = jarray_get(networksObj, i);
+					gchar *ssid = dup_json_string(networkObj, "ssid");
+					gchar *id = dup_json_string(networkObj, "credentialId");
+
+					passpoint_set_provisioned(ssid, id);
+					g_free(ssid);
+					g_free(id);
+				}
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		case WIFI_DNS_REORDER_SETTING:
+		{
+			jschema_ref input_schema = jschema_parse(j_cstr_to_buffer("{}"), DOMOPT_NOOPT,
+			                           NULL);
+
+			if (!input_schema)
+			{
+				goto Exit;
+			}
+
+			JSchemaInfo schemaInfo;
+			jschema_info_init(&schemaInfo, input_schema, NULL, NULL);
+			jvalue_ref parsedObj = jdom_parse(j_cstr_to_buffer(setting_value),
+			                                  DOMOPT_NOOPT, &schemaInfo);
+			jschema_release(&input_schema);
+
+			if (jis_null(parsedObj))
+			{
+				goto Exit;
+			}
+
+			GStrv identifiers = dup_json_strv(parsedObj, "services");
+
+			if (NULL != identifiers)
+			{
+				connman_service_load_reordered_nameservers(identifiers);
+				g_strfreev(identifiers);
+				ret = TRUE;
+			}
+
+			j_release(&parsedObj);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+Exit:
+	g_free(setting_value);
+	return ret;
+}
+
+static void add_wifi_profile(jvalue_ref *profile_j, wifi_profile_t *profile,
+                             const gchar *namespace_name)
+{
+	jobject_put(*profile_j, J_CSTR_TO_JVAL("ssid"), jstring_create(profile->ssid));
+	jobject_put(*profile_j, J_CSTR_TO_JVAL("profileId"),
+	            jnumber_create_i32(profile->profile_id));
+
+	if (profile->hidden)
+	{
+		jobject_put(*profile_j, J_CSTR_TO_JVAL("wasCreatedWithJoinOther"),
+		            jboolean_create(profile->hidden));
+	}
+
+	if (profile->configured)
+	{
+		jobject_put(*profile_j, J_CSTR_TO_JVAL("configured"),
+		            jboolean_create(profile->configured));
+	}
+
+	if (profile->security != NULL)
+	{
+		jvalue_ref security_list = jarray_create(NULL);
+		gsize i;
+
+		for (i = 0; i < g_strv_length(profile->security); i++)
+		{
+			jarray_append(security_list, jstring_create(profile->security[i]));
+		}
+
+		jobject_put(*profile_j, J_CSTR_TO_JVAL("security"), security_list);
+	}
+
+	if (0 != profile->priority)
+	{
+		jobject_put(*profile_j, J_CSTR_TO_JVAL("priority"),
+		            jnumber_create_i32(profile->priority));
+	}
+
+	if (band_preference_is_set(&profile->band_preference))
+	{
+		const band_preference_t *pref = &profile->band_preference;
+		jvalue_ref band_j = jobject_create();
+
+		jobject_put(band_j, J_CSTR_TO_JVAL("band"),
+		            jstring_create(wifi_band_to_string(pref->band)));
+		jobject_put(band_j, J_CSTR_TO_JVAL("required"),
+		            jboolean_create(pref->required));
+		jobject_put(band_j, J_CSTR_TO_JVAL("rssiFloor"),
+		            jnumber_create_i32(pref->rssi_floor));
+
+		if ('\0' != pref->bssid[0])
+		{
+			jobject_put(band_j, J_CSTR_TO_JVAL("bssid"), jstring_create(pref->bssid));
+		}
+
+		jobject_put(*profile_j, J_CSTR_TO_JVAL("bandPreference"), band_j);
+	}
+
+	jobject_put(*profile_j, J_CSTR_TO_JVAL("namespace"),
+	            jstring_create(namespace_name));
+}
+
+static gboolean all_namespaces_empty(GList *namespaces)
+{
+	GList *iter;
+
+	for (iter = namespaces; NULL != iter; iter = iter->next)
+	{
+		if (NULL != ((profile_namespace_t *) iter->data)->profiles)
+		{
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+static gchar *add_wifi_profile_list(void)
+{
+	GList *namespaces = profile_namespace_get_all();
+	profile_namespace_t *active = profile_namespace_get_active();
+
+	// Keep a user namespace active across restarts even if it has no profiles
+	if (all_namespaces_empty(namespaces) &&
+	        active == profile_namespace_get_device())
+	{
+		g_list_free(namespaces);
+		return NULL;
+	}
+
+	gchar *profile_list_str = NULL;
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (response_schema)
+	{
+		jvalue_ref profilelist_j = jobject_create();
+		jvalue_ref profilelist_arr_j = jarray_create(NULL);
+		GList *ns_iter;
+		GSList *iter;
+
+		for (ns_iter = namespaces; NULL != ns_iter; ns_iter = ns_iter->next)
+		{
+			profile_namespace_t *ns = ns_iter->data;
+
+			for (iter = ns->profiles; NULL != iter; iter = iter->next)
+			{
+				wifi_profile_t *profile = iter->data;
+				jvalue_ref profileinfo_j = jobject_create();
+				jvalue_ref profile_j = jobject_create();
+				add_wifi_profile(&profile_j, profile, ns->name);
+				const gchar *profile_str = jvalue_tostring(profile_j, response_schema);
+				gchar *enc_profile_str = profile_crypto_encrypt(profile_str,
+				                         WIFI_LUNA_PREFS_ID);
+				j_release(&profile_j);
+
+				if (NULL != enc_profile_str)
+				{
+					jobject_put(profileinfo_j, J_CSTR_TO_JVAL("wifiProfile"),
+					            jstring_create(enc_profile_str));
+					jarray_append(profilelist_arr_j, profileinfo_j);
+				}
+				else
+				{
+					WCALOG_ERROR(MSGID_SETTING_PROFILE_ENCRYPT_ERROR, 0,
+					             "Failed to encrypt profile");
+					j_release(&profileinfo_j);
+				}
+
+				g_free(enc_profile_str);
+			}
+		}
+
+		jobject_put(profilelist_j, J_CSTR_TO_JVAL("profileList"), profilelist_arr_j);
+		jobject_put(profilelist_j, J_CSTR_TO_JVAL("activeNamespace"),
+		            jstring_create(active->name));
+		profile_list_str = g_strdup(jvalue_tostring(profilelist_j, response_schema));
+		jschema_release(&response_schema);
+		j_release(&profilelist_j);
+	}
+
+	g_list_free(namespaces);
+	return profile_list_str;
+}
+
+static void put_json_strv(jvalue_ref *parent, const char *key, GStrv strv)
+{
+	jvalue_ref array = jarray_create(NULL);
+	gsize i;
+
+	for (i = 0; i < g_strv_length(strv); i++)
+	{
+		jarray_append(array, jstring_create(strv[i]));
+	}
+
+	jobject_put(*parent, jstring_create(key), array);
+}
+
+static void add_network_binding(jvalue_ref *binding_j,
+                                network_binding_t *binding)
+{
+	gchar *fingerprint = network_fingerprint_to_string(binding->fingerprint);
+	jobject_put(*binding_j, J_CSTR_TO_JVAL("fingerprint"),
+	            jstring_create(fingerprint));
+	g_free(fingerprint);
+
+	if (NULL != binding->ipv4.method)
+	{
+		jvalue_ref ipv4_j = jobject_create();
+
+		jobject_put(ipv4_j, J_CSTR_TO_JVAL("method"),
+		            jstring_create(binding->ipv4.method));
+
+		if (NULL != binding->ipv4.address)
+		{
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("address"),
+			            jstring_create(binding->ipv4.address));
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("netmask"),
+			            jstring_create(binding->ipv4.netmask));
+			jobject_put(ipv4_j, J_CSTR_TO_JVAL("gateway"),
+			            jstring_create(binding->ipv4.gateway));
+		}
+
+		jobject_put(*binding_j, J_CSTR_TO_JVAL("ipv4"), ipv4_j);
+	}
+
+	if (NULL != binding->dns)
+	{
+		put_json_strv(binding_j, "dns", binding->dns);
+	}
+
+	if (NULL != binding->proxy.method)
+	{
+		jvalue_ref proxy_j = jobject_create();
+
+		jobject_put(proxy_j, J_CSTR_TO_JVAL("method"),
+		            jstring_create(binding->proxy.method));
+
+		if (NULL != binding->proxy.url)
+		{
+			jobject_put(proxy_j, J_CSTR_TO_JVAL("url"),
+			            jstring_create(binding->proxy.url));
+		}
+
+		if (NULL != binding->proxy.servers)
+		{
+			put_json_strv(&proxy_j, "servers", binding->proxy.servers);
+		}
+
+		if (NULL != binding->proxy.excludes)
+		{
+			put_json_strv(&proxy_j, "excludes", binding->proxy.excludes);
+		}
+
+		jobject_put(*binding_j, J_CSTR_TO_JVAL("proxy"), proxy_j);
+	}
+}
+
+static jvalue_ref passpoint_credential_to_json(const passpoint_credential_t
+        *credential)
+{
+	jvalue_ref credential_j = jobject_create();
+	const struct
+	{
+		const char *key;
+		const gchar *value;
+	} strings[] =
+	{
+		{ "id", credential->id },
+		{ "realm", credential->realm },
+		{ "domain", credential->domain },
+		{ "eapType", credential->eap_type },
+		{ "identity", credential->identity },
+		{ "passphrase", credential->passphrase },
+		{ "caCertFile", credential->ca_cert_file },
+		{ "clientCertFile", credential->client_cert_file },
+		{ "privateKeyFile", credential->private_key_file },
+		{ "privateKeyPassphrase", credential->private_key_passphrase },
+		{ "phase2", credential->phase2 },
+	};
+	gsize i;
+
+	for (i = 0; i < G_N_ELEMENTS(strings); i++)
+	{
+		if (NULL != strings[i].value)
+		{
+			jobject_put(credential_j, jstring_create(strings[i].key),
+			            jstring_create(strings[i].value));
+		}
+	}
+
+	if (NULL != credential->roaming_consortiums)
+	{
+		put_json_strv(&credential_j, "roamingConsortiums",
+		              credential->roaming_consortiums);
+	}
+
+	jobject_put(credential_j, J_CSTR_TO_JVAL("priority"),
+	            jnumber_create_i32(credential->priority));
+
+	return credential_j;
 }
 
 /**
  * @brief Set the values of given settings in luna-prefs
  *
  * The param data can be supplied for providing the values of settings
- * (Not required for WIFI_PROFILELIST_SETTING since this function
- * will fetch from wifi profile list itself
+ * (Not required for WIFI_PROFILELIST_SETTING, WIFI_TETHERING_ACL_SETTING,
+ * WIFI_NETWORK_BINDINGS_SETTING, WIFI_WOWLAN_SETTING,
+ * WIFI_WAN_PREFERENCES_SETTING, WIFI_P2P_GROUP_CACHE_SETTING,
+ * WIFI_PASSPOINT_SETTING and WIFI_DNS_REORDER_SETTING since this function
+ * will fetch from wifi profile list, tethering access lists, network bindings,
+ * Wake-on-WLAN configuration, cellular context preferences, P2P group cache,
+ * Hotspot 2.0 credentials and services with reordered nameservers itself
  */
 
 gboolean store_wifi_setting(wifi_setting_type_t setting, void *data)
@@ -462,23 +1274,367 @@ gboolean store_wifi_setting(wifi_setting_type_t setting, void *data)
 			/* Convert list of profiles to json string for storing */
 			lpErr = LPAppRemoveValue(handle, SettingKey[setting]);
 
-			if (lpErr && (lpErr != LP_ERR_NO_SUCH_KEY))
+			if (lpErr && (lpErr != LP_ERR_NO_SUCH_KEY))
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_REMOVE_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			char *profile_list_str = add_wifi_profile_list();
+
+			if (NULL == profile_list_str)
+			{
+				WCALOG_DEBUG("No wifi profiles found");
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting], profile_list_str);
+			g_free(profile_list_str);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_TETHERING_ACL_SETTING:
+		{
+			/* Both lists are stored as strings of 12 hex digits per station */
+			jvalue_ref acl_j = jobject_create();
+			gchar *allow_str = tethering_acl_serialize(TETHERING_ACL_ALLOW);
+			gchar *deny_str = tethering_acl_serialize(TETHERING_ACL_DENY);
+
+			jobject_put(acl_j, J_CSTR_TO_JVAL("allowList"), jstring_create(allow_str));
+			jobject_put(acl_j, J_CSTR_TO_JVAL("denyList"), jstring_create(deny_str));
+			g_free(allow_str);
+			g_free(deny_str);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&acl_j);
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(acl_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&acl_j);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_NETWORK_BINDINGS_SETTING:
+		{
+			jvalue_ref settings_j = jobject_create();
+			jvalue_ref bindings_j = jarray_create(NULL);
+			jvalue_ref applied_j = jarray_create(NULL);
+			GList *list, *iter;
+
+			list = network_binding_get_all();
+
+			for (iter = list; iter; iter = iter->next)
+			{
+				jvalue_ref binding_j = jobject_create();
+				add_network_binding(&binding_j, (network_binding_t *) iter->data);
+				jarray_append(bindings_j, binding_j);
+			}
+
+			g_list_free(list);
+
+			list = network_binding_get_applied();
+
+			for (iter = list; iter; iter = iter->next)
+			{
+				network_applied_t *applied = network_binding_get_applied_to(iter->data);
+				jvalue_ref record_j = jobject_create();
+				jvalue_ref written_j = jobject_create();
+				jvalue_ref previous_j = jobject_create();
+				gchar *site = network_fingerprint_to_string(applied->site);
+
+				jobject_put(record_j, J_CSTR_TO_JVAL("identifier"),
+				            jstring_create((const char *) iter->data));
+				jobject_put(record_j, J_CSTR_TO_JVAL("site"), jstring_create(site));
+				add_network_binding(&written_j, &applied->written);
+				add_network_binding(&previous_j, &applied->previous);
+				jobject_put(record_j, J_CSTR_TO_JVAL("written"), written_j);
+				jobject_put(record_j, J_CSTR_TO_JVAL("previous"), previous_j);
+				jarray_append(applied_j, record_j);
+				g_free(site);
+			}
+
+			g_list_free(list);
+
+			jobject_put(settings_j, J_CSTR_TO_JVAL("bindings"), bindings_j);
+			jobject_put(settings_j, J_CSTR_TO_JVAL("applied"), applied_j);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&settings_j);
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(settings_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&settings_j);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_WOWLAN_SETTING:
+		{
+			const wowlan_config_t *config = wowlan_get_config();
+			gchar *config_str = NULL != config ? wowlan_config_to_string(config) :
+			                    g_strdup("");
+			jvalue_ref wowlan_j = jobject_create();
+
+			jobject_put(wowlan_j, J_CSTR_TO_JVAL("config"), jstring_create(config_str));
+			g_free(config_str);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&wowlan_j);
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(wowlan_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&wowlan_j);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_WAN_PREFERENCES_SETTING:
+		{
+			const GPtrArray *contexts = wan_failover_get_contexts();
+			jvalue_ref preferences_j = jobject_create();
+			jvalue_ref contexts_j = jarray_create(NULL);
+			guint i;
+
+			for (i = 0; i < contexts->len; i++)
+			{
+				const wan_context_health_t *health = g_ptr_array_index(contexts, i);
+				jarray_append(contexts_j, jstring_create(health->name));
+			}
+
+			jobject_put(preferences_j, J_CSTR_TO_JVAL("contexts"), contexts_j);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&preferences_j);
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(preferences_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&preferences_j);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_P2P_GROUP_CACHE_SETTING:
+		{
+			jvalue_ref cache_j = jobject_create();
+			jvalue_ref groups_j = jarray_create(NULL);
+			const GList *iter;
+
+			for (iter = p2p_group_cache_get_groups(); iter; iter = iter->next)
+			{
+				const p2p_cached_group_t *group = iter->data;
+				jvalue_ref group_j = jobject_create();
+
+				jobject_put(group_j, J_CSTR_TO_JVAL("peerAddress"),
+				            jstring_create(group->peer_address));
+				jobject_put(group_j, J_CSTR_TO_JVAL("role"),
+				            jstring_create(p2p_group_role_to_string(group->role)));
+				jobject_put(group_j, J_CSTR_TO_JVAL("freq"), jnumber_create_i32(group->freq));
+				jobject_put(group_j, J_CSTR_TO_JVAL("lastUsed"),
+				            jnumber_create_i64(group->last_used));
+
+				if (NULL != group->group_name)
+				{
+					jobject_put(group_j, J_CSTR_TO_JVAL("groupName"),
+					            jstring_create(group->group_name));
+				}
+
+				jarray_append(groups_j, group_j);
+			}
+
+			jobject_put(cache_j, J_CSTR_TO_JVAL("groups"), groups_j);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&cache_j);
+				goto Exit;
+			}
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(cache_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&cache_j);
+
+			if (lpErr)
+			{
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
+				             SettingKey[setting]), "");
+				goto Exit;
+			}
+
+			ret = TRUE;
+			break;
+		}
+
+		case WIFI_PASSPOINT_SETTING:
+		{
+			jvalue_ref credentials_j = jobject_create();
+			jvalue_ref credentials_arr_j = jarray_create(NULL);
+			const GList *iter;
+
+			for (iter = passpoint_get_credentials(); iter; iter = iter->next)
+			{
+				jarray_append(credentials_arr_j,
+				              passpoint_credential_to_json(iter->data));
+			}
+
+			jobject_put(credentials_j, J_CSTR_TO_JVAL("credentials"), credentials_arr_j);
+
+			jvalue_ref networks_j = jarray_create(NULL);
+			GList *ssids = passpoint_get_provisioned_ssids(NULL), *ssid_iter;
+
+			for (ssid_iter = ssids; ssid_iter; ssid_iter = ssid_iter->next)
+			{
+				jvalue_ref network_j = jobject_create();
+
+				jobject_put(network_j, J_CSTR_TO_JVAL("ssid"),
+				            jstring_create(ssid_iter->data));
+				jobject_put(network_j, J_CSTR_TO_JVAL("credentialId"),
+				            jstring_create(passpoint_get_provisioned(ssid_iter->data)));
+				jarray_append(networks_j, network_j);
+			}
+
+			g_list_free(ssids);
+			jobject_put(credentials_j, J_CSTR_TO_JVAL("networks"), networks_j);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
+			{
+				j_release(&credentials_j);
+				goto Exit;
+			}
+
+			/* The credentials hold passwords, so they are stored encrypted like
+			 * the profiles */
+			gchar *enc_credentials = profile_crypto_encrypt(jvalue_tostring(
+			                             credentials_j, response_schema), WIFI_LUNA_PREFS_ID);
+			j_release(&credentials_j);
+
+			if (NULL == enc_credentials)
+			{
+				WCALOG_ERROR(MSGID_SETTING_PROFILE_ENCRYPT_ERROR, 0,
+				             "Failed to encrypt Hotspot 2.0 credentials");
+				jschema_release(&response_schema);
+				goto Exit;
+			}
+
+			jvalue_ref setting_j = jobject_create();
+			jobject_put(setting_j, J_CSTR_TO_JVAL("credentials"),
+			            jstring_create(enc_credentials));
+			g_free(enc_credentials);
+
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(setting_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&setting_j);
+
+			if (lpErr)
 			{
-				WCALOG_ERROR(MSGID_SETTING_LPAPP_REMOVE_ERROR, 1, PMLOGKS("Key",
+				WCALOG_ERROR(MSGID_SETTING_LPAPP_SET_ERROR, 1, PMLOGKS("Key",
 				             SettingKey[setting]), "");
 				goto Exit;
 			}
 
-			char *profile_list_str = add_wifi_profile_list();
+			ret = TRUE;
+			break;
+		}
 
-			if (NULL == profile_list_str)
+		case WIFI_DNS_REORDER_SETTING:
+		{
+			jvalue_ref reorder_j = jobject_create();
+			GStrv identifiers = connman_service_dup_reordered_nameservers();
+
+			put_json_strv(&reorder_j, "services", identifiers);
+			g_strfreev(identifiers);
+
+			jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+			                              DOMOPT_NOOPT, NULL);
+
+			if (!response_schema)
 			{
-				WCALOG_DEBUG("No wifi profiles found");
+				j_release(&reorder_j);
 				goto Exit;
 			}
 
-			lpErr = LPAppSetValue(handle, SettingKey[setting], profile_list_str);
-			g_free(profile_list_str);
+			lpErr = LPAppSetValue(handle, SettingKey[setting],
+			                      jvalue_tostring(reorder_j, response_schema));
+			jschema_release(&response_schema);
+			j_release(&reorder_j);
 
 			if (lpErr)
 			{
@@ -544,27 +1700,40 @@ static GKeyFile *load_config(const char *pathname)
 	return keyfile;
 }
 
+gchar *build_config_name(const char *ssid, const char *security)
+{
+	return g_strdup_printf("wifi_%s_%s.config", ssid, security);
+}
+
 static gchar *build_config_path(const char *ssid, const char *security)
 {
 	return g_strdup_printf("%s/wifi_%s_%s.config", CONNMAN_SAVED_PROFILE_CONFIG_DIR,
 	                       ssid, security);
 }
 
+/**
+ * @brief Build the path of a .config file of a namespace which isn't visible.
+ * Connman doesn't see these files, they are moved back into its folder when
+ * the namespace becomes active again.
+ */
 
-gboolean store_enterprise_network_config_entries(GKeyFile *keyfile,
-        const gchar *config_group, connection_settings_t *settings)
+static gchar *build_stashed_config_path(const gchar *namespace_name,
+                                        const gchar *name)
 {
-	if (settings->eap_type != NULL)
-	{
-		g_key_file_set_string(keyfile, config_group, "Type", "wifi");
-		g_key_file_set_string(keyfile, config_group, "Name", settings->ssid);
-		g_key_file_set_string(keyfile, config_group, "Security", "ieee8021x");
-		g_key_file_set_string(keyfile, config_group, "EAP", settings->eap_type);
-	}
-	else
-	{
-		return FALSE;
-	}
+	return g_strdup_printf("%s/%s/%s", PROFILE_NAMESPACE_DIR, namespace_name,
+	                       name);
+}
+
+
+/**
+ * @brief Store the EAP entries shared by enterprise wifi and wired 802.1X
+ * .config files
+ */
+
+static void store_eap_config_entries(GKeyFile *keyfile,
+                                     const gchar *config_group, connection_settings_t *settings)
+{
+	g_key_file_set_string(keyfile, config_group, "EAP", settings->eap_type);
 
 	if (settings->identity != NULL && strlen(settings->identity) > 0)
 	{
@@ -636,6 +1805,23 @@ gboolean store_enterprise_network_config_entries(GKeyFile *keyfile,
 	{
 		g_key_file_remove_key(keyfile, config_group, "Passphrase", NULL);
 	}
+}
+
+gboolean store_enterprise_network_config_entries(GKeyFile *keyfile,
+        const gchar *config_group, connection_settings_t *settings)
+{
+	if (settings->eap_type != NULL)
+	{
+		g_key_file_set_string(keyfile, config_group, "Type", "wifi");
+		g_key_file_set_string(keyfile, config_group, "Name", settings->ssid);
+		g_key_file_set_string(keyfile, config_group, "Security", "ieee8021x");
+	}
+	else
+	{
+		return FALSE;
+	}
+
+	store_eap_config_entries(keyfile, config_group, settings);
 
 	return TRUE;
 }
@@ -736,6 +1922,197 @@ gboolean remove_network_config(const char *ssid, const char *security)
 	return ret;
 }
 
+/**
+ * @brief Move a file, also across file systems
+ */
+
+static gboolean move_file(const gchar *oldpath, const gchar *newpath)
+{
+	gchar *contents = NULL;
+	gsize length = 0;
+	gboolean ret;
+
+	if (g_rename(oldpath, newpath) == 0)
+	{
+		return TRUE;
+	}
+
+	if (!g_file_get_contents(oldpath, &contents, &length, NULL))
+	{
+		return FALSE;
+	}
+
+	ret = g_file_set_contents(newpath, contents, length, NULL) &&
+	      g_unlink(oldpath) == 0;
+	g_free(contents);
+
+	return ret;
+}
+
+static gboolean ensure_stash_dir(const gchar *namespace_name)
+{
+	gchar *dir = g_strdup_printf("%s/%s", PROFILE_NAMESPACE_DIR, namespace_name);
+	gboolean ret = (g_mkdir_with_parents(dir, 0700) == 0);
+
+	g_free(dir);
+	return ret;
+}
+
+/**
+ * @brief Swap the .config files of two namespaces when the active namespace
+ * changes from from_namespace to to_namespace
+ *
+ * Files only used by from_namespace are moved out of connman's folder, files
+ * only used by to_namespace are moved back in. Files used by both are only
+ * touched if their contents differ, so connman doesn't reload them for no
+ * reason.
+ */
+
+void swap_network_configs(const gchar *from_namespace, const gchar *to_namespace,
+                          GSList *stash, GSList *restore, GSList *both)
+{
+	GSList *iter;
+
+	if (!ensure_stash_dir(from_namespace) || !ensure_stash_dir(to_namespace))
+	{
+		WCALOG_ERROR(MSGID_SETTING_NAMESPACE_CONFIG_ERROR, 0,
+		             "Failed to create folder %s", PROFILE_NAMESPACE_DIR);
+		return;
+	}
+
+	for (iter = stash; NULL != iter; iter = iter->next)
+	{
+		gchar *live = g_strdup_printf("%s/%s", CONNMAN_SAVED_PROFILE_CONFIG_DIR,
+		                              (gchar *) iter->data);
+		gchar *stashed = build_stashed_config_path(from_namespace, iter->data);
+
+		if (g_file_test(live, G_FILE_TEST_EXISTS) && !move_file(live, stashed))
+		{
+			WCALOG_ERROR(MSGID_SETTING_NAMESPACE_CONFIG_ERROR, 1,
+			             PMLOGKS("File", live), "Failed to stash");
+		}
+
+		g_free(stashed);
+		g_free(live);
+	}
+
+	for (iter = restore; NULL != iter; iter = iter->next)
+	{
+		gchar *live = g_strdup_printf("%s/%s", CONNMAN_SAVED_PROFILE_CONFIG_DIR,
+		                              (gchar *) iter->data);
+		gchar *stashed = build_stashed_config_path(to_namespace, iter->data);
+
+		if (g_file_test(stashed, G_FILE_TEST_EXISTS) && !move_file(stashed, live))
+		{
+			WCALOG_ERROR(MSGID_SETTING_NAMESPACE_CONFIG_ERROR, 1,
+			             PMLOGKS("File", stashed), "Failed to restore");
+		}
+
+		g_free(stashed);
+		g_free(live);
+	}
+
+	for (iter = both; NULL != iter; iter = iter->next)
+	{
+		gchar *live = g_strdup_printf("%s/%s", CONNMAN_SAVED_PROFILE_CONFIG_DIR,
+		                              (gchar *) iter->data);
+		gchar *stashed_from = build_stashed_config_path(from_namespace, iter->data);
+		gchar *stashed_to = build_stashed_config_path(to_namespace, iter->data);
+		gchar *live_contents = NULL, *to_contents = NULL;
+		gsize live_length = 0, to_length = 0;
+
+		g_file_get_contents(live, &live_contents, &live_length, NULL);
+		g_file_get_contents(stashed_to, &to_contents, &to_length, NULL);
+
+		if (NULL == to_contents)
+		{
+			/* Keep using the live file, but keep a copy for from_namespace */
+			if (NULL != live_contents)
+			{
+				g_file_set_contents(stashed_from, live_contents, live_length, NULL);
+			}
+		}
+		else if (NULL != live_contents && live_length == to_length &&
+		         memcmp(live_contents, to_contents, live_length) == 0)
+		{
+			/* Same contents, so leave connman's file alone */
+			g_file_set_contents(stashed_from, live_contents, live_length, NULL);
+			g_unlink(stashed_to);
+		}
+		else
+		{
+			if (NULL != live_contents)
+			{
+				move_file(live, stashed_from);
+			}
+
+			move_file(stashed_to, live);
+		}
+
+		g_free(to_contents);
+		g_free(live_contents);
+		g_free(stashed_to);
+		g_free(stashed_from);
+		g_free(live);
+	}
+}
+
+/**
+ * @brief Move the .config file of a profile moving between namespaces. A NULL
+ * namespace stands for connman's folder, i.e. a visible namespace.
+ */
+
+gboolean move_network_config(const char *ssid, const char *security,
+                             const gchar *from_namespace, const gchar *to_namespace)
+{
+	gchar *name, *oldpath, *newpath;
+	gboolean ret = TRUE;
+
+	if (NULL == from_namespace && NULL == to_namespace)
+	{
+		return TRUE;
+	}
+
+	if (NULL != to_namespace && !ensure_stash_dir(to_namespace))
+	{
+		return FALSE;
+	}
+
+	name = build_config_name(ssid, security);
+	oldpath = (NULL == from_namespace) ? build_config_path(ssid, security) :
+	          build_stashed_config_path(from_namespace, name);
+	newpath = (NULL == to_namespace) ? build_config_path(ssid, security) :
+	          build_stashed_config_path(to_namespace, name);
+
+	if (g_file_test(oldpath, G_FILE_TEST_EXISTS))
+	{
+		ret = move_file(oldpath, newpath);
+	}
+
+	g_free(newpath);
+	g_free(oldpath);
+	g_free(name);
+
+	return ret;
+}
+
+/**
+ * @brief Remove the .config file of a profile of a namespace which isn't visible
+ */
+
+gboolean remove_stashed_network_config(const gchar *namespace_name,
+                                       const char *ssid, const char *security)
+{
+	gchar *name = build_config_name(ssid, security);
+	gchar *pathname = build_stashed_config_path(namespace_name, name);
+	gboolean ret = (g_unlink(pathname) == 0);
+
+	g_free(pathname);
+	g_free(name);
+
+	return ret;
+}
+
 gboolean change_network_passphrase(const char *ssid, const char *security,
                                    const char *passphrase)
 {
@@ -943,6 +2320,159 @@ gboolean change_network_remove_entry(const char *ssid, const char *security,
 
 }
 
+/**
+ * @brief Get the certificate files an enterprise .config file refers to. Either
+ * is set to NULL if the file has none.
+ */
+
+gboolean get_network_config_cert_files(const char *ssid, const char *security,
+                                       gchar **ca_cert_file, gchar **client_cert_file)
+{
+	gchar *pathname = NULL, *config_group = NULL;
+	GKeyFile *keyfile = NULL;
+
+	*ca_cert_file = NULL;
+	*client_cert_file = NULL;
+
+	if (NULL == ssid || NULL == security)
+	{
+		return FALSE;
+	}
+
+	pathname = build_config_path(ssid, security);
+	keyfile = load_config(pathname);
+	g_free(pathname);
+
+	if (keyfile == NULL)
+	{
+		return FALSE;
+	}
+
+	config_group = g_strdup_printf("service_%s", ssid);
+
+	*ca_cert_file = g_key_file_get_string(keyfile, config_group, "CACertFile",
+	                                      NULL);
+	*client_cert_file = g_key_file_get_string(keyfile, config_group,
+	                    "ClientCertFile", NULL);
+
+	g_free(config_group);
+	g_key_file_free(keyfile);
+	return TRUE;
+}
+
+static gchar *build_wired_config_path(const char *mac)
+{
+	gchar *name = wired_8021x_config_name(mac);
+	gchar *pathname = NULL;
+
+	if (NULL != name)
+	{
+		pathname = g_strdup_printf("%s/%s", CONNMAN_SAVED_PROFILE_CONFIG_DIR, name);
+		g_free(name);
+	}
+
+	return pathname;
+}
+
+/**
+ * @brief Store the 802.1X settings of a wired interface as a connman
+ * provisioning file, bound to the MAC address of the interface
+ */
+
+gboolean store_wired_network_config(const char *mac,
+                                    connection_settings_t *settings)
+{
+	gchar *pathname = NULL;
+	GKeyFile *keyfile = NULL;
+	gboolean ret;
+
+	if (NULL == settings->eap_type)
+	{
+		return FALSE;
+	}
+
+	pathname = build_wired_config_path(mac);
+
+	if (pathname == NULL)
+	{
+		return FALSE;
+	}
+
+	keyfile = g_key_file_new();
+
+	g_key_file_set_string(keyfile, WIRED_CONFIG_GROUP, "Type", "ethernet");
+	g_key_file_set_string(keyfile, WIRED_CONFIG_GROUP, "MAC", mac);
+	store_eap_config_entries(keyfile, WIRED_CONFIG_GROUP, settings);
+
+	ret = store_config(keyfile, pathname);
+
+	g_key_file_free(keyfile);
+	g_free(pathname);
+	return ret;
+}
+
+/**
+ * @brief Load the 802.1X settings of a wired interface into settings
+ *
+ * @return TRUE if the interface has a wired 802.1X profile, FALSE otherwise
+ */
+
+gboolean load_wired_network_config(const char *mac,
+                                   connection_settings_t *settings)
+{
+	gchar *pathname = build_wired_config_path(mac);
+	GKeyFile *keyfile = NULL;
+
+	if (pathname == NULL)
+	{
+		return FALSE;
+	}
+
+	keyfile = load_config(pathname);
+	g_free(pathname);
+
+	if (keyfile == NULL)
+	{
+		return FALSE;
+	}
+
+	settings->eap_type = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP, "EAP",
+	                     NULL);
+	settings->identity = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP,
+	                     "Identity", NULL);
+	settings->ca_cert_file = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP,
+	                         "CACertFile", NULL);
+	settings->client_cert_file = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP,
+	                             "ClientCertFile", NULL);
+	settings->private_key_file = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP,
+	                             "PrivateKeyFile", NULL);
+	settings->phase2 = g_key_file_get_string(keyfile, WIRED_CONFIG_GROUP, "Phase2",
+	                   NULL);
+
+	g_key_file_free(keyfile);
+	return NULL != settings->eap_type;
+}
+
+/**
+ * @brief Remove the 802.1X profile of a wired interface
+ */
+
+gboolean remove_wired_network_config(const char *mac)
+{
+	gchar *pathname = build_wired_config_path(mac);
+	gboolean ret;
+
+	if (pathname == NULL)
+	{
+		return FALSE;
+	}
+
+	ret = (g_unlink(pathname) == 0);
+
+	g_free(pathname);
+	return ret;
+}
+
 /**
  * @brief For a given .config file, check if there is a profile present, if not create it
  */
@@ -31,6 +31,13 @@ typedef enum
 {
 	WIFI_NULL_SETTING,
 	WIFI_PROFILELIST_SETTING,
+	WIFI_TETHERING_ACL_SETTING,
+	WIFI_NETWORK_BINDINGS_SETTING,
+	WIFI_WOWLAN_SETTING,
+	WIFI_WAN_PREFERENCES_SETTING,
+	WIFI_P2P_GROUP_CACHE_SETTING,
+	WIFI_PASSPOINT_SETTING,
+	WIFI_DNS_REORDER_SETTING,
 	WIFI_LAST_SETTING,
 } wifi_setting_type_t;
 
@@ -48,7 +55,21 @@ extern gboolean change_network_ipv4(const char *ssid, const char *security,
 extern gboolean change_network_ipv6(const char *ssid, const char *security,
                                     const char *address, const char *prefixLen, const char *gateway);
 extern gboolean change_network_remove_entry(const char *ssid, const char *security, const char *key);
+extern gboolean get_network_config_cert_files(const char *ssid,
+        const char *security, gchar **ca_cert_file, gchar **client_cert_file);
+extern gboolean store_wired_network_config(const char *mac,
+        connection_settings_t *settings);
+extern gboolean load_wired_network_config(const char *mac,
+        connection_settings_t *settings);
+extern gboolean remove_wired_network_config(const char *mac);
 extern void remove_config_inotify_watch(void);
+extern gchar *build_config_name(const char *ssid, const char *security);
+extern void swap_network_configs(const gchar *from_namespace,
+                                 const gchar *to_namespace, GSList *stash, GSList *restore, GSList *both);
+extern gboolean move_network_config(const char *ssid, const char *security,
+                                    const gchar *from_namespace, const gchar *to_namespace);
+extern gboolean remove_stashed_network_config(const gchar *namespace_name,
+        const char *ssid, const char *security);
 
 
 #endif /* _WIFI_SETTING_H_ */
@@ -0,0 +1,314 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wifi_tethering_acl.c
+ *
+ * @brief Maintains the allow and deny lists of stations for WiFi tethering
+ *
+ * Both lists share a single hash table which maps the binary MAC address of
+ * a station to the list it is on, so checking a station takes one lookup.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "wifi_tethering_acl.h"
+
+#define MAC_ADDRESS_LEN         6
+#define MAC_ADDRESS_HEX_LEN     (MAC_ADDRESS_LEN * 2)
+
+static GHashTable *station_table = NULL;
+static guint allowed_count = 0;
+static guint rejected_count = 0;
+
+static GHashTable *get_station_table(void)
+{
+	if (NULL == station_table)
+	{
+		station_table = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free,
+		                                      NULL);
+	}
+
+	return station_table;
+}
+
+/**
+ * Parse a MAC address into its binary form (see header for API details)
+ */
+
+gboolean tethering_acl_parse_address(const gchar *address, guint64 *mac)
+{
+	guint64 value = 0;
+	gsize n;
+
+	if (NULL == address || NULL == mac ||
+	        strlen(address) != MAC_ADDRESS_HEX_LEN + MAC_ADDRESS_LEN - 1)
+	{
+		return FALSE;
+	}
+
+	for (n = 0; n < MAC_ADDRESS_LEN; n++)
+	{
+		const gchar *octet = address + n * 3;
+		gint high = g_ascii_xdigit_value(octet[0]);
+		gint low = g_ascii_xdigit_value(octet[1]);
+
+		if (high < 0 || low < 0 ||
+		        (n < MAC_ADDRESS_LEN - 1 && octet[2] != ':'))
+		{
+			return FALSE;
+		}
+
+		value = (value << 8) | (high << 4) | low;
+	}
+
+	*mac = value;
+	return TRUE;
+}
+
+static gchar *format_address(guint64 mac)
+{
+	return g_strdup_printf("%02x:%02x:%02x:%02x:%02x:%02x",
+	                       (guint)(mac >> 40) & 0xff, (guint)(mac >> 32) & 0xff,
+	                       (guint)(mac >> 24) & 0xff, (guint)(mac >> 16) & 0xff,
+	                       (guint)(mac >> 8) & 0xff, (guint) mac & 0xff);
+}
+
+static void add_station(tethering_acl_list_t list, guint64 mac)
+{
+	GHashTable *table = get_station_table();
+	tethering_acl_list_t current = GPOINTER_TO_INT(g_hash_table_lookup(table,
+	                               &mac));
+
+	if (current == TETHERING_ACL_ALLOW)
+	{
+		allowed_count--;
+	}
+
+	if (list == TETHERING_ACL_ALLOW)
+	{
+		allowed_count++;
+	}
+
+	guint64 *key = g_new(guint64, 1);
+	*key = mac;
+	g_hash_table_replace(table, key, GINT_TO_POINTER(list));
+}
+
+/**
+ * Add a station to an access control list (see header for API details)
+ */
+
+gboolean tethering_acl_add(tethering_acl_list_t list, const gchar *address)
+{
+	guint64 mac;
+
+	if (list != TETHERING_ACL_ALLOW && list != TETHERING_ACL_DENY)
+	{
+		return FALSE;
+	}
+
+	if (!tethering_acl_parse_address(address, &mac))
+	{
+		return FALSE;
+	}
+
+	add_station(list, mac);
+	return TRUE;
+}
+
+/**
+ * Remove a station from an access control list (see header for API details)
+ */
+
+gboolean tethering_acl_remove(tethering_acl_list_t list, const gchar *address)
+{
+	guint64 mac;
+
+	if (NULL == station_table || !tethering_acl_parse_address(address, &mac))
+	{
+		return FALSE;
+	}
+
+	if (GPOINTER_TO_INT(g_hash_table_lookup(station_table, &mac)) != list)
+	{
+		return FALSE;
+	}
+
+	if (list == TETHERING_ACL_ALLOW)
+	{
+		allowed_count--;
+	}
+
+	return g_hash_table_remove(station_table, &mac);
+}
+
+/**
+ * Remove all stations from the access control lists (see header for API details)
+ */
+
+void tethering_acl_clear(void)
+{
+	if (NULL != station_table)
+	{
+		g_hash_table_remove_all(station_table);
+	}
+
+	allowed_count = 0;
+}
+
+/**
+ * Get the stations on an access control list (see header for API details)
+ */
+
+GSList *tethering_acl_get_addresses(tethering_acl_list_t list)
+{
+	GSList *addresses = NULL;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	if (NULL == station_table)
+	{
+		return NULL;
+	}
+
+	g_hash_table_iter_init(&iter, station_table);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		if (GPOINTER_TO_INT(value) == list)
+		{
+			addresses = g_slist_prepend(addresses, format_address(*(guint64 *) key));
+		}
+	}
+
+	return addresses;
+}
+
+/**
+ * Check if a station is permitted (see header for API details)
+ */
+
+gboolean tethering_acl_is_permitted(const gchar *address)
+{
+	tethering_acl_list_t list = TETHERING_ACL_NONE;
+	guint64 mac;
+
+	if (NULL != station_table && tethering_acl_parse_address(address, &mac))
+	{
+		list = GPOINTER_TO_INT(g_hash_table_lookup(station_table, &mac));
+	}
+
+	return !(list == TETHERING_ACL_DENY ||
+	         (list == TETHERING_ACL_NONE && allowed_count > 0));
+}
+
+/**
+ * Check if a station is permitted and count rejections (see header for API details)
+ */
+
+gboolean tethering_acl_check_station(const gchar *address)
+{
+	if (!tethering_acl_is_permitted(address))
+	{
+		rejected_count++;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Get the number of rejected stations (see header for API details)
+ */
+
+guint tethering_acl_get_rejected_count(void)
+{
+	return rejected_count;
+}
+
+/**
+ * Serialize an access control list (see header for API details)
+ */
+
+gchar *tethering_acl_serialize(tethering_acl_list_t list)
+{
+	GString *str = g_string_new(NULL);
+	GHashTableIter iter;
+	gpointer key, value;
+
+	if (NULL == station_table)
+	{
+		return g_string_free(str, FALSE);
+	}
+
+	g_hash_table_iter_init(&iter, station_table);
+
+	while (g_hash_table_iter_next(&iter, &key, &value))
+	{
+		if (GPOINTER_TO_INT(value) == list)
+		{
+			g_string_append_printf(str, "%012" G_GINT64_MODIFIER "x",
+			                       *(guint64 *) key);
+		}
+	}
+
+	return g_string_free(str, FALSE);
+}
+
+/**
+ * Deserialize an access control list (see header for API details)
+ */
+
+gboolean tethering_acl_deserialize(tethering_acl_list_t list, const gchar *str)
+{
+	gsize n, len;
+
+	if (NULL == str)
+	{
+		return FALSE;
+	}
+
+	len = strlen(str);
+
+	if (len % MAC_ADDRESS_HEX_LEN != 0)
+	{
+		return FALSE;
+	}
+
+	for (n = 0; n < len; n += MAC_ADDRESS_HEX_LEN)
+	{
+		guint64 mac = 0;
+		gsize i;
+
+		for (i = 0; i < MAC_ADDRESS_HEX_LEN; i++)
+		{
+			gint digit = g_ascii_xdigit_value(str[n + i]);
+
+			if (digit < 0)
+			{
+				return FALSE;
+			}
+
+			mac = (mac << 4) | digit;
+		}
+
+		add_station(list, mac);
+	}
+
+	return TRUE;
+}
@@ -0,0 +1,133 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wifi_tethering_acl.h
+ *
+ * @brief Header file defining the station access control lists used for
+ *        WiFi tethering
+ *
+ */
+
+#ifndef _WIFI_TETHERING_ACL_H_
+#define _WIFI_TETHERING_ACL_H_
+
+#include <glib.h>
+
+typedef enum
+{
+	TETHERING_ACL_NONE = 0,
+	TETHERING_ACL_ALLOW,
+	TETHERING_ACL_DENY,
+} tethering_acl_list_t;
+
+/**
+ * Parse a MAC address of the form "aa:bb:cc:dd:ee:ff" into its binary form
+ *
+ * @param[IN]  address MAC address string
+ * @param[OUT] mac Binary MAC address in the lower 48 bits
+ *
+ * @return FALSE if the address is malformed, TRUE otherwise
+ */
+extern gboolean tethering_acl_parse_address(const gchar *address,
+        guint64 *mac);
+
+/**
+ * Add a station to one of the access control lists. A station can only be on
+ * one list, adding it to a list removes it from the other one.
+ *
+ * @param[IN]  list List to add the station to
+ * @param[IN]  address MAC address of the station
+ *
+ * @return FALSE if the address is malformed, TRUE otherwise
+ */
+extern gboolean tethering_acl_add(tethering_acl_list_t list,
+                                  const gchar *address);
+
+/**
+ * Remove a station from one of the access control lists
+ *
+ * @param[IN]  list List to remove the station from
+ * @param[IN]  address MAC address of the station
+ *
+ * @return FALSE if the station wasn't on the list, TRUE otherwise
+ */
+extern gboolean tethering_acl_remove(tethering_acl_list_t list,
+                                     const gchar *address);
+
+/**
+ * Remove all stations from both access control lists
+ */
+extern void tethering_acl_clear(void);
+
+/**
+ * Get the addresses of all stations on one of the access control lists
+ *
+ * @param[IN]  list List to get the stations for
+ *
+ * @return List of MAC address strings, free with g_slist_free_full(list, g_free)
+ */
+extern GSList *tethering_acl_get_addresses(tethering_acl_list_t list);
+
+/**
+ * Check if a station is permitted to use the tethering access point. A station
+ * is rejected when it is on the deny list or when the allow list isn't empty
+ * and the station is not on it.
+ *
+ * @param[IN]  address MAC address of the station
+ *
+ * @return TRUE if the station is permitted, FALSE otherwise
+ */
+extern gboolean tethering_acl_is_permitted(const gchar *address);
+
+/**
+ * Same as tethering_acl_is_permitted but every rejection is counted. Used
+ * when a station tries to join the tethering access point.
+ *
+ * @param[IN]  address MAC address of the station
+ *
+ * @return TRUE if the station is permitted, FALSE otherwise
+ */
+extern gboolean tethering_acl_check_station(const gchar *address);
+
+/**
+ * Get the number of stations rejected since startup
+ */
+extern guint tethering_acl_get_rejected_count(void);
+
+/**
+ * Serialize one of the access control lists into a compact string holding
+ * 12 hex digits per station
+ *
+ * @param[IN]  list List to serialize
+ *
+ * @return Newly allocated string, free with g_free
+ */
+extern gchar *tethering_acl_serialize(tethering_acl_list_t list);
+
+/**
+ * Add all stations from a string created by tethering_acl_serialize to one of
+ * the access control lists
+ *
+ * @param[IN]  list List to add the stations to
+ * @param[IN]  str Serialized list
+ *
+ * @return FALSE if the string is malformed, TRUE otherwise
+ */
+extern gboolean tethering_acl_deserialize(tethering_acl_list_t list,
+        const gchar *str);
+
+#endif /* _WIFI_TETHERING_ACL_H_ */
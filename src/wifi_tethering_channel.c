@@ -0,0 +1,246 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wifi_tethering_channel.c
+ *
+ * @brief Scores WiFi channels by their congestion to select the channel
+ *        used for WiFi tethering
+ *
+ */
+
+#include <glib.h>
+#include <stdlib.h>
+
+#include "wifi_tethering_channel.h"
+
+/* Channels in the 2.4GHz band are 5MHz apart but 20MHz wide, so a BSS
+ * interferes with all channels less than this many channels away */
+#define CHANNEL_OVERLAP_DISTANCE_2GHZ   5
+
+/* Signal range (in dBm) mapped onto the signal weight of a BSS */
+#define CHANNEL_SIGNAL_FLOOR            -95
+#define CHANNEL_SIGNAL_CEILING          -35
+
+/* Allowed channels in order of preference. The non-overlapping channels
+ * come first so they win when scores are equal. */
+static const gint allowed_channels_2_4ghz[] =
+{
+	1, 6, 11, 2, 3, 4, 5, 7, 8, 9, 10, 0
+};
+
+/* Channels requiring DFS are left out as the access point would have to
+ * listen for radar before it can come up */
+static const gint allowed_channels_5ghz[] =
+{
+	36, 40, 44, 48, 149, 153, 157, 161, 0
+};
+
+static const gint *get_allowed_channels(tethering_band_t band)
+{
+	return (band == TETHERING_BAND_5GHZ) ? allowed_channels_5ghz :
+	       allowed_channels_2_4ghz;
+}
+
+/**
+ * Convert a frequency to the corresponding channel (see header for API details)
+ */
+
+gint tethering_channel_from_frequency(gint frequency)
+{
+	if (frequency == 2484)
+	{
+		return 14;
+	}
+	else if (frequency >= 2412 && frequency <= 2472)
+	{
+		return (frequency - 2407) / 5;
+	}
+	else if (frequency >= 5170 && frequency <= 5825)
+	{
+		return (frequency - 5000) / 5;
+	}
+
+	return TETHERING_CHANNEL_NONE;
+}
+
+/**
+ * Convert a channel to the corresponding frequency (see header for API details)
+ */
+
+gint tethering_channel_to_frequency(gint channel)
+{
+	if (channel == 14)
+	{
+		return 2484;
+	}
+	else if (channel >= 1 && channel <= 13)
+	{
+		return 2407 + channel * 5;
+	}
+	else if (channel >= 34 && channel <= 165)
+	{
+		return 5000 + channel * 5;
+	}
+
+	return 0;
+}
+
+/**
+ * Get the band of a channel (see header for API details)
+ */
+
+tethering_band_t tethering_channel_get_band(gint channel)
+{
+	return (channel > 14) ? TETHERING_BAND_5GHZ : TETHERING_BAND_2_4GHZ;
+}
+
+/**
+ * Check if channel can be used for tethering (see header for API details)
+ */
+
+gboolean tethering_channel_is_allowed(tethering_band_t band, gint channel)
+{
+	const gint *channels = get_allowed_channels(band);
+	gsize n;
+
+	for (n = 0; channels[n] != 0; n++)
+	{
+		if (channels[n] == channel)
+		{
+			return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+/**
+ * Get the default channel of a band (see header for API details)
+ */
+
+gint tethering_channel_get_default(tethering_band_t band)
+{
+	return get_allowed_channels(band)[0];
+}
+
+/**
+ * @brief Return how much a BSS on bss_channel overlaps with channel, ranging from
+ * 0 (no overlap) to 1 (same channel)
+ */
+
+static gdouble channel_overlap(gint channel, gint bss_channel)
+{
+	gint distance = abs(channel - bss_channel);
+
+	if (channel <= 14 && bss_channel <= 14)
+	{
+		if (distance >= CHANNEL_OVERLAP_DISTANCE_2GHZ)
+		{
+			return 0.0;
+		}
+
+		return (gdouble)(CHANNEL_OVERLAP_DISTANCE_2GHZ - distance) /
+		       CHANNEL_OVERLAP_DISTANCE_2GHZ;
+	}
+
+	/* 5GHz channels are non-overlapping at 20MHz width */
+	return (distance == 0) ? 1.0 : 0.0;
+}
+
+/**
+ * @brief Map the signal strength of a BSS to a weight between 0 and 1
+ */
+
+static gdouble signal_weight(gint signal)
+{
+	if (signal <= CHANNEL_SIGNAL_FLOOR)
+	{
+		return 0.0;
+	}
+
+	if (signal >= CHANNEL_SIGNAL_CEILING)
+	{
+		return 1.0;
+	}
+
+	return (gdouble)(signal - CHANNEL_SIGNAL_FLOOR) /
+	       (CHANNEL_SIGNAL_CEILING - CHANNEL_SIGNAL_FLOOR);
+}
+
+/**
+ * Calculate the congestion score of a channel (see header for API details)
+ */
+
+gdouble tethering_channel_score(gint channel, const bssinfo_t *bss,
+                                guint num_bss)
+{
+	gdouble score = 0.0;
+	guint n;
+
+	if (NULL == bss)
+	{
+		return score;
+	}
+
+	for (n = 0; n < num_bss; n++)
+	{
+		gint bss_channel = tethering_channel_from_frequency(bss[n].frequency);
+
+		if (bss_channel == TETHERING_CHANNEL_NONE)
+		{
+			continue;
+		}
+
+		/* Every BSS occupies air time on the channel, a strong one more so
+		 * as we can't use the air time ourself while it is transmitting */
+		score += channel_overlap(channel, bss_channel) *
+		         (1.0 + signal_weight(bss[n].signal));
+	}
+
+	return score;
+}
+
+/**
+ * Select the least congested channel (see header for API details)
+ */
+
+gint tethering_channel_select(tethering_band_t band, const bssinfo_t *bss,
+                              guint num_bss, gdouble *score)
+{
+	const gint *channels = get_allowed_channels(band);
+	gint best_channel = channels[0];
+	gdouble best_score = tethering_channel_score(best_channel, bss, num_bss);
+	gsize n;
+
+	for (n = 1; channels[n] != 0; n++)
+	{
+		gdouble channel_score = tethering_channel_score(channels[n], bss, num_bss);
+
+		if (channel_score < best_score)
+		{
+			best_channel = channels[n];
+			best_score = channel_score;
+		}
+	}
+
+	if (NULL != score)
+	{
+		*score = best_score;
+	}
+
+	return best_channel;
+}
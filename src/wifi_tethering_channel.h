@@ -0,0 +1,120 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wifi_tethering_channel.h
+ *
+ * @brief Header file defining the channel scoring used for automatic
+ *        selection of the WiFi tethering channel
+ *
+ */
+
+#ifndef _WIFI_TETHERING_CHANNEL_H_
+#define _WIFI_TETHERING_CHANNEL_H_
+
+#include <glib.h>
+
+#include "connman_service.h"
+
+/**
+ * Value used by the channel selection when no channel could be determined
+ */
+#define TETHERING_CHANNEL_NONE          0
+
+typedef enum
+{
+	TETHERING_BAND_2_4GHZ,
+	TETHERING_BAND_5GHZ,
+} tethering_band_t;
+
+/**
+ * Convert a frequency (in MHz) to the corresponding WiFi channel number
+ *
+ * @param[IN]  frequency Frequency in MHz
+ *
+ * @return Channel number or TETHERING_CHANNEL_NONE for unknown frequencies
+ */
+extern gint tethering_channel_from_frequency(gint frequency);
+
+/**
+ * Convert a WiFi channel number to the corresponding center frequency (in MHz)
+ *
+ * @param[IN]  channel Channel number
+ *
+ * @return Frequency in MHz or 0 for unknown channels
+ */
+extern gint tethering_channel_to_frequency(gint channel);
+
+/**
+ * Get the band a channel belongs to
+ *
+ * @param[IN]  channel Channel number
+ *
+ * @return Band of the channel
+ */
+extern tethering_band_t tethering_channel_get_band(gint channel);
+
+/**
+ * Check if the given channel is one we allow for tethering in the given band.
+ * Only channels without DFS requirements are allowed in the 5GHz band.
+ *
+ * @param[IN]  band Band the channel has to be in
+ * @param[IN]  channel Channel number
+ *
+ * @return TRUE if the channel can be used for tethering, FALSE otherwise
+ */
+extern gboolean tethering_channel_is_allowed(tethering_band_t band,
+        gint channel);
+
+/**
+ * Get the channel used for tethering in the given band when no channel is
+ * selected explicitly
+ *
+ * @param[IN]  band Band to get the default channel for
+ *
+ * @return Channel number
+ */
+extern gint tethering_channel_get_default(tethering_band_t band);
+
+/**
+ * Calculate the congestion score of a channel from a set of scanned BSS entries.
+ * Every BSS contributes with the amount its channel overlaps the given one,
+ * weighted by its signal strength. Lower scores mean less congested channels.
+ *
+ * @param[IN]  channel Channel number to score
+ * @param[IN]  bss Array of scanned BSS entries
+ * @param[IN]  num_bss Number of entries in bss
+ *
+ * @return Congestion score of the channel
+ */
+extern gdouble tethering_channel_score(gint channel, const bssinfo_t *bss,
+                                       guint num_bss);
+
+/**
+ * Select the least congested allowed channel in a band from a set of scanned
+ * BSS entries
+ *
+ * @param[IN]  band Band to select the channel from
+ * @param[IN]  bss Array of scanned BSS entries
+ * @param[IN]  num_bss Number of entries in bss
+ * @param[OUT] score Score of the selected channel. May be NULL.
+ *
+ * @return Selected channel number
+ */
+extern gint tethering_channel_select(tethering_band_t band,
+                                     const bssinfo_t *bss, guint num_bss, gdouble *score);
+
+#endif /* _WIFI_TETHERING_CHANNEL_H_ */
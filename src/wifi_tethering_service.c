@@ -26,11 +26,15 @@
 
 #include <glib.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <wca-support.h>
 
 #include "wifi_tethering_service.h"
+#include "wifi_tethering_channel.h"
+#include "wifi_tethering_acl.h"
+#include "wifi_setting.h"
 #include "wifi_service.h"
 #include "connman_manager.h"
 #include "lunaservice_utils.h"
@@ -41,6 +45,7 @@
 
 #define WIFI_STATUS_TIMEOUT     1
 #define WIFI_TETHERING_USED_RX_BYTES_TRESHOLD(x)        5000*x
+#define WIFI_TETHERING_MAX_STATIONS     32
 
 LSHandle *tetheringpLSHandle = NULL;
 
@@ -48,9 +53,51 @@ static gboolean previous_wifi_legacy_powered = FALSE;
 
 static guint wifi_tethering_timeout = 5;
 static guint wifi_tethering_timeout_source = 0;
-static guint wifi_tethering_client_count = 0;
+/* Lower case MAC addresses of the stations counted as clients */
+static GHashTable *wifi_tethering_stations = NULL;
+
+static gboolean wifi_tethering_channel_auto = FALSE;
+static gdouble wifi_tethering_channel_score = 0.0;
+static tethering_band_t wifi_tethering_band = TETHERING_BAND_2_4GHZ;
 
 void start_tethering_timeout(void);
+static void sta_authorized_cb(gpointer user_data, const gchar *address);
+static void sta_deauthorized_cb(gpointer user_data, const gchar *address);
+
+/**
+ * @brief Select the least congested channel based on the BSS information of the
+ * most recent scan and configure it for the tethering access point.
+ */
+
+static void select_tethering_channel(connman_technology_t *wifi_tech)
+{
+	GArray *bss_list = g_array_new(FALSE, FALSE, sizeof(bssinfo_t));
+	GSList *iter;
+
+	for (iter = manager->wifi_services; NULL != iter; iter = iter->next)
+	{
+		connman_service_t *service = (connman_service_t *)(iter->data);
+
+		if (NULL != service->bss)
+		{
+			g_array_append_vals(bss_list, service->bss->data, service->bss->len);
+		}
+	}
+
+	gint channel = tethering_channel_select(wifi_tethering_band,
+	                                        (bssinfo_t *) bss_list->data, bss_list->len,
+	                                        &wifi_tethering_channel_score);
+
+	WCALOG_DEBUG("Selected tethering channel %d with score %.2f out of %u BSS",
+	             channel, wifi_tethering_channel_score, bss_list->len);
+
+	g_array_free(bss_list, TRUE);
+
+	/* If this fails the access point still comes up on the channel picked
+	 * by the driver so we don't treat it as fatal */
+	connman_technology_set_tethering_freq(wifi_tech,
+	                                      tethering_channel_to_frequency(channel));
+}
 
 static void support_tethering_disabled_cb(bool success, void *user_data)
 {
@@ -156,6 +203,11 @@ static void support_tethering_enabled_cb(bool success, void *user_data)
 		return;
 	}
 
+	if (wifi_tethering_channel_auto)
+	{
+		select_tethering_channel(wifi_tech);
+	}
+
 	if (!connman_technology_set_tethering(wifi_tech, TRUE))
 	{
 		/* disable tethering support again */
@@ -164,7 +216,21 @@ static void support_tethering_enabled_cb(bool success, void *user_data)
 		return;
 	}
 
-	wifi_tethering_client_count = 0;
+	if (NULL == wifi_tethering_stations)
+	{
+		wifi_tethering_stations = g_hash_table_new_full(g_str_hash, g_str_equal,
+		                          g_free, NULL);
+	}
+
+	g_hash_table_remove_all(wifi_tethering_stations);
+
+	// Make sure our handler gets registered with the WiFi technology
+	// to get known when a new STA connects
+	connman_technology_register_sta_authorized_cb(wifi_tech, sta_authorized_cb,
+	        NULL);
+	connman_technology_register_sta_deauthorized_cb(wifi_tech, sta_deauthorized_cb,
+	        NULL);
+
 	start_tethering_timeout();
 
 	if (message)
@@ -244,13 +310,54 @@ static void send_tethering_state(jvalue_ref *reply)
 
 	if (NULL != wifi_tech->tethering_identifier)
 	{
+		const gchar *security_type = NULL;
+
+		if (NULL != wifi_tech->tethering_security)
+		{
+			security_type = !g_strcmp0(wifi_tech->tethering_security,
+			                           "none") ? "open" : wifi_tech->tethering_security;
+		}
+		else
+		{
+			security_type = (NULL != wifi_tech->tethering_passphrase)
+			                && (strlen(wifi_tech->tethering_passphrase) != 0) ? "psk" : "open";
+		}
+
 		jobject_put(*reply, J_CSTR_TO_JVAL("securityType"),
-		            jstring_create((NULL != wifi_tech->tethering_passphrase)
-		                           && (strlen(wifi_tech->tethering_passphrase) != 0) ? "psk" : "open"));
+		            jstring_create(security_type));
+	}
+
+	jobject_put(*reply, J_CSTR_TO_JVAL("band"),
+	            jstring_create(wifi_tethering_band == TETHERING_BAND_5GHZ ? "5GHz" : "2.4GHz"));
+	jobject_put(*reply, J_CSTR_TO_JVAL("hidden"),
+	            jboolean_create(wifi_tech->tethering_hidden));
+
+	if (wifi_tech->tethering_max_stations > 0)
+	{
+		jobject_put(*reply, J_CSTR_TO_JVAL("maxStations"),
+		            jnumber_create_i32(wifi_tech->tethering_max_stations));
 	}
 
 	jobject_put(*reply, J_CSTR_TO_JVAL("timeout"),
 	            jnumber_create_i32(wifi_tethering_timeout));
+
+	gint channel = tethering_channel_from_frequency(wifi_tech->tethering_freq);
+
+	if (channel != TETHERING_CHANNEL_NONE)
+	{
+		gchar *channel_str = g_strdup_printf("%d", channel);
+		jobject_put(*reply, J_CSTR_TO_JVAL("channel"), jstring_create(channel_str));
+		g_free(channel_str);
+	}
+
+	jobject_put(*reply, J_CSTR_TO_JVAL("autoChannel"),
+	            jboolean_create(wifi_tethering_channel_auto));
+
+	if (wifi_tethering_channel_auto && channel != TETHERING_CHANNEL_NONE)
+	{
+		jobject_put(*reply, J_CSTR_TO_JVAL("channelScore"),
+		            jnumber_create_f64(wifi_tethering_channel_score));
+	}
 }
 
 void send_tethering_state_to_subscribers(void)
@@ -334,9 +441,23 @@ static gboolean tethering_timeout_cb(gpointer user_data)
 	return FALSE;
 }
 
-static void sta_authorized_cb(gpointer user_data)
+static void sta_authorized_cb(gpointer user_data, const gchar *address)
 {
-	wifi_tethering_client_count++;
+	if (!tethering_acl_check_station(address))
+	{
+		WCALOG_INFO(MSGID_TETHERING_STATION_REJECTED, 0,
+		            "Station not permitted by access lists, disconnecting");
+		connman_technology_disconnect_station(
+		    connman_manager_find_wifi_technology(manager), address);
+		return;
+	}
+
+	if (NULL == address || NULL == wifi_tethering_stations)
+	{
+		return;
+	}
+
+	g_hash_table_add(wifi_tethering_stations, g_ascii_strdown(address, -1));
 
 	// If timer is no longer active we don't have anything to do here
 	if (wifi_tethering_timeout_source == 0)
@@ -356,22 +477,84 @@ static void sta_authorized_cb(gpointer user_data)
 	}
 }
 
-static void sta_deauthorized_cb(gpointer user_data)
+/**
+ * @brief Stop counting a station as client, restarting the timeout once the
+ * last one is gone
+ */
+
+static void forget_tethering_station(const gchar *address)
 {
-	wifi_tethering_client_count--;
+	gchar *key;
+	gboolean counted;
+
+	if (NULL == address || NULL == wifi_tethering_stations)
+	{
+		return;
+	}
+
+	key = g_ascii_strdown(address, -1);
+	counted = g_hash_table_remove(wifi_tethering_stations, key);
+	g_free(key);
+
+	// Rejected stations were never counted
+	if (!counted)
+	{
+		return;
+	}
 
 	WCALOG_DEBUG("WiFi tethering client disconnected");
 
-	if (wifi_tethering_client_count > 0)
+	if (g_hash_table_size(wifi_tethering_stations) > 0)
 	{
-		WCALOG_DEBUG("Not restarting timeout as we have %d clients left",
-		             wifi_tethering_client_count);
+		WCALOG_DEBUG("Not restarting timeout as we have %u clients left",
+		             g_hash_table_size(wifi_tethering_stations));
 		return;
 	}
 
 	start_tethering_timeout();
 }
 
+static void sta_deauthorized_cb(gpointer user_data, const gchar *address)
+{
+	forget_tethering_station(address);
+}
+
+/**
+ * @brief Disconnect the connected stations which the access lists don't
+ * permit any more
+ */
+
+static void disconnect_denied_stations(void)
+{
+	connman_technology_t *wifi_tech;
+	GList *stations, *iter;
+
+	if (NULL == wifi_tethering_stations)
+	{
+		return;
+	}
+
+	wifi_tech = connman_manager_find_wifi_technology(manager);
+	stations = g_hash_table_get_keys(wifi_tethering_stations);
+
+	for (iter = stations; NULL != iter; iter = iter->next)
+	{
+		gchar *address = g_strdup(iter->data);
+
+		if (!tethering_acl_is_permitted(address))
+		{
+			WCALOG_INFO(MSGID_TETHERING_STATION_REJECTED, 0,
+			            "Station not permitted by access lists any more, disconnecting");
+			connman_technology_disconnect_station(wifi_tech, address);
+			forget_tethering_station(address);
+		}
+
+		g_free(address);
+	}
+
+	g_list_free(stations);
+}
+
 void start_tethering_timeout(void)
 {
 	if (wifi_tethering_timeout == 0 || wifi_tethering_timeout_source != 0)
@@ -379,23 +562,40 @@ void start_tethering_timeout(void)
 		return;
 	}
 
-	connman_technology_t *wifi_tech = connman_manager_find_wifi_technology(manager);
-
 	WCALOG_DEBUG("Setting WiFi tethering timeout to %d minutes",
 	             wifi_tethering_timeout);
 
-	// Make sure our handler gets registered with the WiFi technology
-	// to get known when a new STA connects
-	connman_technology_register_sta_authorized_cb(wifi_tech, sta_authorized_cb,
-	        NULL);
-	connman_technology_register_sta_deauthorized_cb(wifi_tech, sta_deauthorized_cb,
-	        NULL);
-
 	wifi_tethering_timeout_source = g_timeout_add_seconds(wifi_tethering_timeout *
 	                                60,
 	                                tethering_timeout_cb, NULL);
 }
 
+/**
+ * @brief Map the securityType of the API to the TetheringSecurity value of connman
+ */
+
+static const gchar *parse_security_type(jvalue_ref securityTypeObj)
+{
+	if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("open")))
+	{
+		return "none";
+	}
+	else if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("psk")))
+	{
+		return "psk";
+	}
+	else if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("sae")))
+	{
+		return "sae";
+	}
+	else if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("psk-sae")))
+	{
+		return "psk-sae";
+	}
+
+	return NULL;
+}
+
 /////////////////////////////////////////////////////////////////
 //                                                             //
 //            Start of API documentation comment block         //
@@ -415,6 +615,12 @@ Name | Required | Type | Description
 enabled | No | boolean | enable / disable tethering
 ssid | No | String | The tethering broadcasted identifier
 passPhrase | No | String | The tethering connection passphrase
+securityType | No | String | The tethering security type ("open", "psk", "sae" for WPA3 or "psk-sae" for WPA2/WPA3 transition mode)
+timeout | No | Integer | Minutes without connected clients before tethering is disabled
+channel | No | String | The tethering channel number or "auto" to select the least congested channel from the last scan results when tethering is enabled
+band | No | String | The tethering band ("2.4GHz" or "5GHz")
+hidden | No | Boolean | True to not broadcast the tethering SSID
+maxStations | No | Integer | Maximum number of stations allowed to connect (1 - 32)
 
 @par Returns(Call) for all forms
 
@@ -441,20 +647,28 @@ static bool handle_set_state_command(LSHandle *sh, LSMessage *message,
 	// To prevent memory leaks, schema should be checked before the variables will be initialized.
 	jvalue_ref parsedObj = {0};
 	if (!LSMessageValidateSchema(sh, message,
-	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_5(PROP(enabled, boolean),
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_9(PROP(enabled, boolean),
 	                                     PROP(ssid, string), PROP(passPhrase, string), PROP(securityType, string),
-	                                     PROP(timeout, integer)))), &parsedObj))
+	                                     PROP(timeout, integer), PROP(channel, string), PROP(band, string),
+	                                     PROP(hidden, boolean), PROP(maxStations, integer)))), &parsedObj))
 	{
 		return true;
 	}
 
 	jvalue_ref enabledObj = {0}, ssidObj = {0}, passPhraseObj = {0}, securityTypeObj
-	                                       = {0}, timeoutObj = {0};
+	                                       = {0}, timeoutObj = {0}, channelObj = {0}, bandObj = {0},
+	                                       hiddenObj = {0}, maxStationsObj = {0};
 	gboolean enable_tethering = FALSE, invalidArg = TRUE;
 	gchar *ssid = NULL, *passphrase = NULL;
 	int timeout = 0;
 	gboolean is_open = FALSE;
 	gboolean state_set = FALSE;
+	const gchar *security = NULL;
+	tethering_band_t band = wifi_tethering_band;
+	gboolean channel_auto = wifi_tethering_channel_auto;
+	gint channel = TETHERING_CHANNEL_NONE;
+	gboolean hidden = FALSE;
+	int max_stations = 0;
 
 	if (!connman_status_check(manager, sh, message))
 	{
@@ -466,69 +680,192 @@ static bool handle_set_state_command(LSHandle *sh, LSMessage *message,
 		return true;
 	}
 
-	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("ssid"), &ssidObj))
+	connman_technology_t *wifi_tech = connman_manager_find_wifi_technology(manager);
+
+	/* Validate the security, band and channel options first so an invalid
+	 * combination doesn't leave the access point partly configured */
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("securityType"),
+	                       &securityTypeObj))
 	{
 		if (is_wifi_tethering())
 		{
 			LSMessageReplyCustomError(sh, message,
-			                          "Not allowed to change SSID while tethering is enabled",
-			                          WCA_API_ERROR_TETHERING_SSID_FAILED);
+			                          "Not allowed to change securityType while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SEC_TYPE);
 			goto cleanup;
 		}
 
-		raw_buffer ssid_buf = jstring_get(ssidObj);
-		ssid = g_strdup(ssid_buf.m_str);
-		jstring_free_buffer(ssid_buf);
+		security = parse_security_type(securityTypeObj);
 
-		if (NULL == ssid)
+		if (NULL == security)
 		{
 			goto invalid_params;
 		}
 
-		invalidArg = FALSE;
+		is_open = !g_strcmp0(security, "none");
 
-		if (!connman_technology_set_tethering_identifier(
-		            connman_manager_find_wifi_technology(manager), ssid))
+		if (!is_open &&
+		        !jobject_get_exists(parsedObj, J_CSTR_TO_BUF("passPhrase"), &passPhraseObj) &&
+		        (NULL == wifi_tech->tethering_passphrase ||
+		         strlen(wifi_tech->tethering_passphrase) == 0))
 		{
-			LSMessageReplyCustomError(sh, message, "Error in setting tethering SSID",
-			                          WCA_API_ERROR_TETHERING_SSID_FAILED);
+			LSMessageReplyCustomError(sh, message,
+			                          "No passphrase set but required for this security type",
+			                          WCA_API_ERROR_TETHERING_NO_PASSPHRASE);
 			goto cleanup;
 		}
 	}
 
-	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("securityType"),
-	                       &securityTypeObj))
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("band"), &bandObj))
 	{
 		if (is_wifi_tethering())
 		{
 			LSMessageReplyCustomError(sh, message,
-			                          "Not allowed to change securityType while tethering is enabled",
-			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SEC_TYPE);
+			                          "Not allowed to change band while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SETTINGS);
 			goto cleanup;
 		}
 
-		if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("open")))
+		if (jstring_equal2(bandObj, J_CSTR_TO_BUF("2.4GHz")))
 		{
-			is_open = TRUE;
+			band = TETHERING_BAND_2_4GHZ;
 		}
-		else if (jstring_equal2(securityTypeObj, J_CSTR_TO_BUF("psk")))
+		else if (jstring_equal2(bandObj, J_CSTR_TO_BUF("5GHz")))
 		{
-			is_open = FALSE;
+			band = TETHERING_BAND_5GHZ;
 		}
 		else
 		{
 			goto invalid_params;
 		}
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("channel"), &channelObj))
+	{
+		if (is_wifi_tethering())
+		{
+			LSMessageReplyCustomError(sh, message,
+			                          "Not allowed to change channel while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_CHANNEL);
+			goto cleanup;
+		}
 
+		if (jstring_equal2(channelObj, J_CSTR_TO_BUF("auto")))
+		{
+			channel_auto = TRUE;
+		}
+		else
+		{
+			raw_buffer channel_buf = jstring_get(channelObj);
+			char *endptr = NULL;
+			channel = strtol(channel_buf.m_str, &endptr, 10);
+			gboolean valid = (endptr != channel_buf.m_str && *endptr == '\0');
+			jstring_free_buffer(channel_buf);
+
+			if (!bandObj)
+			{
+				band = tethering_channel_get_band(channel);
+			}
+
+			if (!valid || !tethering_channel_is_allowed(band, channel))
+			{
+				LSMessageReplyCustomError(sh, message, "Invalid tethering channel for band",
+				                          WCA_API_ERROR_TETHERING_CHANNEL_INVALID);
+				goto cleanup;
+			}
+
+			channel_auto = FALSE;
+		}
+	}
+	else if (bandObj && !channel_auto &&
+	         !tethering_channel_is_allowed(band,
+	                                       tethering_channel_from_frequency(wifi_tech->tethering_freq)))
+	{
+		/* Move a fixed channel over to the new band */
+		channel = tethering_channel_get_default(band);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("hidden"), &hiddenObj))
+	{
+		if (is_wifi_tethering())
+		{
+			LSMessageReplyCustomError(sh, message,
+			                          "Not allowed to change hidden while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SETTINGS);
+			goto cleanup;
+		}
+
+		jboolean_get(hiddenObj, &hidden);
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("maxStations"),
+	                       &maxStationsObj))
+	{
+		if (is_wifi_tethering())
+		{
+			LSMessageReplyCustomError(sh, message,
+			                          "Not allowed to change maxStations while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_NOT_ALLOWED_TO_CHANGE_SETTINGS);
+			goto cleanup;
+		}
+
+		jnumber_get_i32(maxStationsObj, &max_stations);
+
+		if (max_stations < 1 || max_stations > WIFI_TETHERING_MAX_STATIONS)
+		{
+			LSMessageReplyCustomError(sh, message, "Invalid maximum number of stations",
+			                          WCA_API_ERROR_TETHERING_MAX_STATIONS_INVALID);
+			goto cleanup;
+		}
+	}
+
+	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("ssid"), &ssidObj))
+	{
+		if (is_wifi_tethering())
+		{
+			LSMessageReplyCustomError(sh, message,
+			                          "Not allowed to change SSID while tethering is enabled",
+			                          WCA_API_ERROR_TETHERING_SSID_FAILED);
+			goto cleanup;
+		}
+
+		raw_buffer ssid_buf = jstring_get(ssidObj);
+		ssid = g_strdup(ssid_buf.m_str);
+		jstring_free_buffer(ssid_buf);
+
+		if (NULL == ssid)
+		{
+			goto invalid_params;
+		}
+
+		invalidArg = FALSE;
+
+		if (!connman_technology_set_tethering_identifier(
+		            connman_manager_find_wifi_technology(manager), ssid))
+		{
+			LSMessageReplyCustomError(sh, message, "Error in setting tethering SSID",
+			                          WCA_API_ERROR_TETHERING_SSID_FAILED);
+			goto cleanup;
+		}
+	}
+
+	if (NULL != security)
+	{
 		if (is_open &&
-		        !connman_technology_set_tethering_passphrase(
-		            connman_manager_find_wifi_technology(manager), ""))
+		        !connman_technology_set_tethering_passphrase(wifi_tech, ""))
 		{
 			LSMessageReplyCustomError(sh, message, "Error in setting tethering passphrase",
 			                          WCA_API_ERROR_TETHERING_PASSPHRASE_FAILED);
 			goto cleanup;
 		}
 
+		if (!connman_technology_set_tethering_security(wifi_tech, security))
+		{
+			LSMessageReplyCustomError(sh, message, "Error in setting tethering security",
+			                          WCA_API_ERROR_TETHERING_SETTINGS_FAILED);
+			goto cleanup;
+		}
+
 		invalidArg = FALSE;
 	}
 
@@ -615,6 +952,47 @@ static bool handle_set_state_command(LSHandle *sh, LSMessage *message,
 		invalidArg = FALSE;
 	}
 
+	if (channel != TETHERING_CHANNEL_NONE &&
+	        !connman_technology_set_tethering_freq(wifi_tech,
+	                tethering_channel_to_frequency(channel)))
+	{
+		LSMessageReplyCustomError(sh, message, "Error in setting tethering channel",
+		                          WCA_API_ERROR_TETHERING_CHANNEL_FAILED);
+		goto cleanup;
+	}
+
+	if (channelObj || bandObj)
+	{
+		wifi_tethering_channel_auto = channel_auto;
+		wifi_tethering_band = band;
+		invalidArg = FALSE;
+	}
+
+	if (hiddenObj)
+	{
+		if (!connman_technology_set_tethering_hidden(wifi_tech, hidden))
+		{
+			LSMessageReplyCustomError(sh, message, "Error in setting tethering hidden",
+			                          WCA_API_ERROR_TETHERING_SETTINGS_FAILED);
+			goto cleanup;
+		}
+
+		invalidArg = FALSE;
+	}
+
+	if (maxStationsObj)
+	{
+		if (!connman_technology_set_tethering_max_stations(wifi_tech, max_stations))
+		{
+			LSMessageReplyCustomError(sh, message,
+			                          "Error in setting tethering maximum number of stations",
+			                          WCA_API_ERROR_TETHERING_SETTINGS_FAILED);
+			goto cleanup;
+		}
+
+		invalidArg = FALSE;
+	}
+
 	if (jobject_get_exists(parsedObj, J_CSTR_TO_BUF("enabled"), &enabledObj))
 	{
 		jboolean_get(enabledObj, &enable_tethering);
@@ -698,6 +1076,13 @@ state | No | boolean | enable / disable tethering
 ssid | No | String | The tethering broadcasted identifier
 passPhrase | No | String |  The tethering connection passphrase
 securityType | No | String |  The tethering securityType
+band | No | String | The tethering band ("2.4GHz" or "5GHz")
+hidden | No | Boolean | True if the tethering SSID is not broadcasted
+maxStations | No | Integer | Maximum number of stations allowed to connect
+timeout | No | Integer | Minutes without connected clients before tethering is disabled
+channel | No | String | The channel used for the tethering access point
+autoChannel | No | Boolean | True if the channel is selected automatically
+channelScore | No | Number | Congestion score of the automatically selected channel (lower is better)
 returnValue | Yes | Boolean | True, if call was successful. False otherwise.
 errorText | No | String | Error text when call was not successful.
 errorCode | No | Integer | Error code when call was not successful.
@@ -846,6 +1231,270 @@ cleanup:
 	return true;
 }
 
+static tethering_acl_list_t parse_access_list(jvalue_ref listObj)
+{
+	if (jstring_equal2(listObj, J_CSTR_TO_BUF("allow")))
+	{
+		return TETHERING_ACL_ALLOW;
+	}
+	else if (jstring_equal2(listObj, J_CSTR_TO_BUF("deny")))
+	{
+		return TETHERING_ACL_DENY;
+	}
+
+	return TETHERING_ACL_NONE;
+}
+
+static bool handle_access_list_entry(LSHandle *sh, LSMessage *message,
+                                     gboolean add)
+{
+	// To prevent memory leaks, schema should be checked before the variables will be initialized.
+	jvalue_ref parsedObj = {0};
+	if (!LSMessageValidateSchema(sh, message,
+	                             j_cstr_to_buffer(STRICT_SCHEMA(PROPS_2(PROP(list, string),
+	                                     PROP(macAddress, string)) REQUIRED_2(list, macAddress))), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref listObj = {0}, macAddressObj = {0};
+	gchar *address = NULL;
+
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("list"), &listObj);
+	jobject_get_exists(parsedObj, J_CSTR_TO_BUF("macAddress"), &macAddressObj);
+
+	tethering_acl_list_t list = parse_access_list(listObj);
+
+	if (list == TETHERING_ACL_NONE)
+	{
+		LSMessageReplyErrorInvalidParams(sh, message);
+		goto cleanup;
+	}
+
+	raw_buffer address_buf = jstring_get(macAddressObj);
+	address = g_strdup(address_buf.m_str);
+	jstring_free_buffer(address_buf);
+
+	if (add)
+	{
+		if (!tethering_acl_add(list, address))
+		{
+			LSMessageReplyCustomError(sh, message, "Invalid MAC address",
+			                          WCA_API_ERROR_TETHERING_INVALID_MAC_ADDRESS);
+			goto cleanup;
+		}
+	}
+	else if (!tethering_acl_remove(list, address))
+	{
+		LSMessageReplyCustomError(sh, message, "Station not found in access list",
+		                          WCA_API_ERROR_TETHERING_ACCESS_ENTRY_NOT_FOUND);
+		goto cleanup;
+	}
+
+	store_wifi_setting(WIFI_TETHERING_ACL_SETTING, NULL);
+	disconnect_denied_stations();
+
+	LSMessageReplySuccess(sh, message);
+
+cleanup:
+	g_free(address);
+	j_release(&parsedObj);
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            Start of API documentation comment block         //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+/**
+@page com_webos_service_wifi com.webos.service.wifi/tethering/addAccessListEntry
+@{
+@section com_webos_service_wifi_tethering_addaccesslistentry addAccessListEntry
+
+Add a station to the allow or deny list of the tethering access point. A station
+can only be on one of the lists. Stations on the deny list are disconnected as soon
+as they join, or right away if they are connected. If the allow list isn't empty
+only stations on it are permitted.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+list | Yes | String | "allow" or "deny"
+macAddress | Yes | String | MAC address of the station
+
+@par Returns(Call) for all forms
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | Yes | Boolean | True, if call was successful. False otherwise.
+errorText | No | String | Error text when call was not successful.
+errorCode | No | Integer | Error code when call was not successful.
+
+@par Returns(Subscription)
+Not applicable.
+
+@}
+*/
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            End of API documentation comment block           //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+
+static bool handle_add_access_list_entry_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	return handle_access_list_entry(sh, message, TRUE);
+}
+
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            Start of API documentation comment block         //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+/**
+@page com_webos_service_wifi com.webos.service.wifi/tethering/removeAccessListEntry
+@{
+@section com_webos_service_wifi_tethering_removeaccesslistentry removeAccessListEntry
+
+Remove a station from the allow or deny list of the tethering access point.
+Connected stations which aren't permitted any more, e.g. as they were removed
+from an allow list which still has other stations on it, are disconnected.
+
+@par Parameters
+
+Name | Required | Type | Description
+-----|--------|------|----------
+list | Yes | String | "allow" or "deny"
+macAddress | Yes | String | MAC address of the station
+
+@par Returns(Call) for all forms
+
+Name | Required | Type | Description
+-----|--------|------|----------
+returnValue | Yes | Boolean | True, if call was successful. False otherwise.
+errorText | No | String | Error text when call was not successful.
+errorCode | No | Integer | Error code when call was not successful.
+
+@par Returns(Subscription)
+Not applicable.
+
+@}
+*/
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            End of API documentation comment block           //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+
+static bool handle_remove_access_list_entry_command(LSHandle *sh,
+        LSMessage *message, void *context)
+{
+	return handle_access_list_entry(sh, message, FALSE);
+}
+
+static jvalue_ref create_access_list_array(tethering_acl_list_t list)
+{
+	jvalue_ref addresses_j = jarray_create(NULL);
+	GSList *addresses = tethering_acl_get_addresses(list);
+	GSList *iter;
+
+	for (iter = addresses; NULL != iter; iter = iter->next)
+	{
+		jarray_append(addresses_j, jstring_create((gchar *) iter->data));
+	}
+
+	g_slist_free_full(addresses, g_free);
+
+	return addresses_j;
+}
+
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            Start of API documentation comment block         //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+/**
+@page com_webos_service_wifi com.webos.service.wifi/tethering/getAccessLists
+@{
+@section com_webos_service_wifi_tethering_getaccesslists getAccessLists
+
+List the stations on the allow and deny lists of the tethering access point.
+
+@par Parameters
+None
+
+@par Returns(Call) for all forms
+
+Name | Required | Type | Description
+-----|--------|------|----------
+allowList | Yes | Array of String | MAC addresses of the permitted stations
+denyList | Yes | Array of String | MAC addresses of the rejected stations
+rejectedCount | Yes | Integer | Number of stations rejected since startup
+returnValue | Yes | Boolean | True, if call was successful. False otherwise.
+errorText | No | String | Error text when call was not successful.
+errorCode | No | Integer | Error code when call was not successful.
+
+@par Returns(Subscription)
+Not applicable.
+
+@}
+*/
+/////////////////////////////////////////////////////////////////
+//                                                             //
+//            End of API documentation comment block           //
+//                                                             //
+/////////////////////////////////////////////////////////////////
+
+static bool handle_get_access_lists_command(LSHandle *sh, LSMessage *message,
+        void *context)
+{
+	// To prevent memory leaks, schema should be checked before the variables will be initialized.
+	jvalue_ref parsedObj = {0};
+	if (!LSMessageValidateSchema(sh, message, j_cstr_to_buffer(SCHEMA_ANY), &parsedObj))
+	{
+		return true;
+	}
+
+	jvalue_ref reply = jobject_create();
+	LSError lserror;
+	LSErrorInit(&lserror);
+
+	jobject_put(reply, J_CSTR_TO_JVAL("returnValue"), jboolean_create(true));
+	jobject_put(reply, J_CSTR_TO_JVAL("allowList"),
+	            create_access_list_array(TETHERING_ACL_ALLOW));
+	jobject_put(reply, J_CSTR_TO_JVAL("denyList"),
+	            create_access_list_array(TETHERING_ACL_DENY));
+	jobject_put(reply, J_CSTR_TO_JVAL("rejectedCount"),
+	            jnumber_create_i32(tethering_acl_get_rejected_count()));
+
+	jschema_ref response_schema = jschema_parse(j_cstr_to_buffer("{}"),
+	                              DOMOPT_NOOPT, NULL);
+
+	if (!response_schema)
+	{
+		LSMessageReplyErrorUnknown(sh, message);
+		goto cleanup;
+	}
+
+	if (!LSMessageReply(sh, message, jvalue_tostring(reply, response_schema),
+	                    &lserror))
+	{
+		LSErrorPrint(&lserror, stderr);
+		LSErrorFree(&lserror);
+	}
+
+	jschema_release(&response_schema);
+
+cleanup:
+	j_release(&parsedObj);
+	j_release(&reply);
+
+	return true;
+}
+
 /**
  * com.webos.service.wifi/tethering service Luna Method Table
  */
@@ -855,6 +1504,9 @@ static LSMethod wifi_tethering_methods[] =
 	{ LUNA_METHOD_TETHERING_SETSTATE,              handle_set_state_command },
 	{ LUNA_METHOD_TETHERING_GETSTATE,              handle_get_state_command },
 	{ LUNA_METHOD_TETHERING_GETSTACOUNT,           handle_get_station_count_command },
+	{ LUNA_METHOD_TETHERING_ADDACCESSENTRY,        handle_add_access_list_entry_command },
+	{ LUNA_METHOD_TETHERING_REMOVEACCESSENTRY,     handle_remove_access_list_entry_command },
+	{ LUNA_METHOD_TETHERING_GETACCESSLISTS,        handle_get_access_lists_command },
 	{},
 };
 
@@ -879,6 +1531,8 @@ int initialize_wifi_tethering_ls2_calls(GMainLoop *mainloop,
 		goto Exit;
 	}
 
+	load_wifi_setting(WIFI_TETHERING_ACL_SETTING, NULL);
+
 	return 0;
 Exit:
 
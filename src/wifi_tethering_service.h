@@ -34,6 +34,9 @@
 #define LUNA_METHOD_TETHERING_SETSTATE       "setState"
 #define LUNA_METHOD_TETHERING_GETSTATE       "getState"
 #define LUNA_METHOD_TETHERING_GETSTACOUNT    "getStationCount"
+#define LUNA_METHOD_TETHERING_ADDACCESSENTRY     "addAccessListEntry"
+#define LUNA_METHOD_TETHERING_REMOVEACCESSENTRY  "removeAccessListEntry"
+#define LUNA_METHOD_TETHERING_GETACCESSLISTS     "getAccessLists"
 
 extern void send_tethering_state_to_subscribers(void);
 extern void send_sta_count_to_subscribers(void);
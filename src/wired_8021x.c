@@ -0,0 +1,203 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wired_8021x.c
+ *
+ * @brief Helpers for 802.1X authentication of wired services
+ *
+ */
+
+#include <string.h>
+
+#include "wired_8021x.h"
+
+G_DEFINE_QUARK(wired-8021x-error-quark, wired_8021x_error)
+
+static gboolean is_set(const gchar *value)
+{
+	return NULL != value && '\0' != value[0];
+}
+
+/**
+ * Check the EAP settings of a wired profile (see header for API details)
+ */
+
+gboolean wired_8021x_check_settings(const gchar *eap_type,
+                                    const gchar *identity, const gchar *passphrase, const gchar *client_cert_file,
+                                    const gchar *private_key_file, GError **error)
+{
+	gboolean tls = !g_strcmp0(eap_type, "tls");
+
+	if (!tls && g_strcmp0(eap_type, "peap") && g_strcmp0(eap_type, "ttls"))
+	{
+		g_set_error(error, WIRED_8021X_ERROR, WIRED_8021X_ERROR_EAP_TYPE,
+		            "Invalid eapType");
+		return FALSE;
+	}
+
+	if (!is_set(identity))
+	{
+		g_set_error(error, WIRED_8021X_ERROR, WIRED_8021X_ERROR_IDENTITY,
+		            "An identity is required");
+		return FALSE;
+	}
+
+	if (tls && (!is_set(client_cert_file) || !is_set(private_key_file)))
+	{
+		g_set_error(error, WIRED_8021X_ERROR, WIRED_8021X_ERROR_CLIENT_CERT,
+		            "TLS requires a client certificate and its private key");
+		return FALSE;
+	}
+
+	if (!tls && !is_set(passphrase))
+	{
+		g_set_error(error, WIRED_8021X_ERROR, WIRED_8021X_ERROR_PASSPHRASE,
+		            "%s requires a passphrase", eap_type);
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/**
+ * Get the name of the provisioning file of a wired interface (see header for
+ * API details)
+ */
+
+gchar *wired_8021x_config_name(const gchar *mac)
+{
+	GString *name;
+	guint n;
+
+	if (NULL == mac || strlen(mac) != 17)
+	{
+		return NULL;
+	}
+
+	name = g_string_new("ethernet_");
+
+	for (n = 0; n < 17; n++)
+	{
+		if (2 == n % 3)
+		{
+			if (':' != mac[n])
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		if (!g_ascii_isxdigit(mac[n]))
+		{
+			break;
+		}
+
+		g_string_append_c(name, g_ascii_tolower(mac[n]));
+	}
+
+	if (n != 17)
+	{
+		g_string_free(name, TRUE);
+		return NULL;
+	}
+
+	g_string_append(name, ".config");
+	return g_string_free(name, FALSE);
+}
+
+/**
+ * Work out the authentication state of the wired service (see header for API
+ * details)
+ */
+
+wired_8021x_state_t wired_8021x_get_state(gboolean enabled,
+        const gchar *service_state, const gchar *service_error,
+        const gchar *eap_state)
+{
+	if (!enabled)
+	{
+		return WIRED_8021X_STATE_DISABLED;
+	}
+
+	if (NULL == service_state)
+	{
+		return WIRED_8021X_STATE_UNAUTHENTICATED;
+	}
+
+	/* The supplicant only completes once the authenticator accepted us */
+	if (!g_strcmp0(eap_state, "completed"))
+	{
+		return WIRED_8021X_STATE_AUTHENTICATED;
+	}
+
+	if (!g_strcmp0(eap_state, "failed") ||
+	        !g_strcmp0(service_state, "failure") ||
+	        !g_strcmp0(service_error, "invalid-key") ||
+	        !g_strcmp0(service_error, "auth-failed") ||
+	        !g_strcmp0(service_error, "login-failed"))
+	{
+		return WIRED_8021X_STATE_FAILED;
+	}
+
+	if (!g_strcmp0(eap_state, "associating") ||
+	        !g_strcmp0(eap_state, "associated") ||
+	        !g_strcmp0(eap_state, "authenticating") ||
+	        !g_strcmp0(service_state, "association"))
+	{
+		return WIRED_8021X_STATE_AUTHENTICATING;
+	}
+
+	/* An open or guest port brings the link up without any EAP exchange */
+	if (NULL == eap_state && (!g_strcmp0(service_state, "configuration") ||
+	                          !g_strcmp0(service_state, "ready") || !g_strcmp0(service_state, "online")))
+	{
+		return WIRED_8021X_STATE_UNKNOWN;
+	}
+
+	return WIRED_8021X_STATE_UNAUTHENTICATED;
+}
+
+/**
+ * Get the name of an authentication state (see header for API details)
+ */
+
+const gchar *wired_8021x_state_to_string(wired_8021x_state_t state)
+{
+	switch (state)
+	{
+		case WIRED_8021X_STATE_DISABLED:
+			return "disabled";
+
+		case WIRED_8021X_STATE_UNAUTHENTICATED:
+			return "unauthenticated";
+
+		case WIRED_8021X_STATE_AUTHENTICATING:
+			return "authenticating";
+
+		case WIRED_8021X_STATE_AUTHENTICATED:
+			return "authenticated";
+
+		case WIRED_8021X_STATE_FAILED:
+			return "failed";
+
+		case WIRED_8021X_STATE_UNKNOWN:
+			break;
+	}
+
+	return "unknown";
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wired_8021x.h
+ *
+ * @brief Header file defining the helpers for 802.1X authentication of wired
+ *        services
+ *
+ * A wired 802.1X profile is a connman provisioning file with Type=ethernet,
+ * bound to the MAC address of the wired interface and carrying the same EAP
+ * entries as an enterprise wifi profile.
+ *
+ */
+
+#ifndef _WIRED_8021X_H_
+#define _WIRED_8021X_H_
+
+#include <glib.h>
+
+#define WIRED_8021X_ERROR       wired_8021x_error_quark()
+
+typedef enum
+{
+	WIRED_8021X_ERROR_EAP_TYPE,
+	WIRED_8021X_ERROR_IDENTITY,
+	WIRED_8021X_ERROR_PASSPHRASE,
+	WIRED_8021X_ERROR_CLIENT_CERT,
+} wired_8021x_error_t;
+
+typedef enum
+{
+	WIRED_8021X_STATE_DISABLED = 0,
+	WIRED_8021X_STATE_UNAUTHENTICATED,
+	WIRED_8021X_STATE_AUTHENTICATING,
+	WIRED_8021X_STATE_AUTHENTICATED,
+	WIRED_8021X_STATE_FAILED,
+	WIRED_8021X_STATE_UNKNOWN,     /* Link up, but no EAP result to go by */
+} wired_8021x_state_t;
+
+extern GQuark wired_8021x_error_quark(void);
+
+/**
+ * Check the EAP settings of a wired profile. TLS needs an identity, a client
+ * certificate and its private key. PEAP and TTLS need an identity and a
+ * passphrase.
+ *
+ * @param[IN]  eap_type "tls", "peap" or "ttls"
+ * @param[IN]  identity Identity, can be NULL
+ * @param[IN]  passphrase Passphrase, can be NULL
+ * @param[IN]  client_cert_file Path of the client certificate, can be NULL
+ * @param[IN]  private_key_file Path of the private key, can be NULL
+ * @param[OUT] error What is missing or wrong
+ *
+ * @return TRUE if the settings are complete, FALSE otherwise
+ */
+extern gboolean wired_8021x_check_settings(const gchar *eap_type,
+        const gchar *identity, const gchar *passphrase, const gchar *client_cert_file,
+        const gchar *private_key_file, GError **error);
+
+/**
+ * Get the name of the connman provisioning file of a wired interface
+ *
+ * @param[IN]  mac MAC address of the interface, "aa:bb:cc:dd:ee:ff"
+ *
+ * @return File name, free with g_free, NULL if the address isn't valid
+ */
+extern gchar *wired_8021x_config_name(const gchar *mac);
+
+/**
+ * Work out the authentication state of the wired port from the EAP state of
+ * the supplicant. connman's state of the wired service only tells if the
+ * link is up, so without an EAP state an up link is reported as unknown.
+ *
+ * @param[IN]  enabled TRUE if a wired 802.1X profile is set up
+ * @param[IN]  service_state Connman state of the wired service, NULL if there
+ *             is none, e.g. as the cable is unplugged
+ * @param[IN]  service_error Connman error of the wired service, can be NULL
+ * @param[IN]  eap_state State of the wpa_supplicant interface of the wired
+ *             port, "failed" after a failed EAP exchange, NULL if there is
+ *             no such interface
+ *
+ * @return Authentication state
+ */
+extern wired_8021x_state_t wired_8021x_get_state(gboolean enabled,
+        const gchar *service_state, const gchar *service_error,
+        const gchar *eap_state);
+
+/**
+ * Get the name of an authentication state as used in the luna API
+ *
+ * @param[IN]  state Authentication state
+ *
+ * @return Name of the state
+ */
+extern const gchar *wired_8021x_state_to_string(wired_8021x_state_t state);
+
+#endif /* _WIRED_8021X_H_ */
@@ -0,0 +1,583 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wowlan.c
+ *
+ * @brief Wake-on-WLAN configuration, checked against the driver and applied
+ *        on suspend
+ *
+ */
+
+#include <string.h>
+
+#include "wowlan.h"
+
+G_DEFINE_QUARK(wowlan-error-quark, wowlan_error)
+
+#define PATTERN_PREFIX      "pattern:"
+
+static const struct
+{
+	guint trigger;
+	const gchar *name;
+} trigger_names[] =
+{
+	{ WOWLAN_TRIGGER_ANY, "any" },
+	{ WOWLAN_TRIGGER_DISCONNECT, "disconnect" },
+	{ WOWLAN_TRIGGER_MAGIC_PACKET, "magicPacket" },
+	{ WOWLAN_TRIGGER_GTK_REKEY_FAILURE, "gtkRekeyFailure" },
+	{ WOWLAN_TRIGGER_EAP_IDENTITY_REQUEST, "eapIdentityRequest" },
+	{ WOWLAN_TRIGGER_4WAY_HANDSHAKE, "fourWayHandshake" },
+	{ WOWLAN_TRIGGER_RFKILL_RELEASE, "rfkillRelease" },
+	{ WOWLAN_TRIGGER_PATTERN, "pattern" },
+};
+
+static const wowlan_driver_t *wowlan_driver = NULL;
+static wowlan_config_t *wowlan_config = NULL;
+static wowlan_wake_t last_wake;
+static gboolean has_last_wake = FALSE;
+static gboolean wake_reported = FALSE;
+/* A configuration of ours was handed to the driver and not cleared since */
+static gboolean driver_configured = FALSE;
+
+/**
+ * Set the driver used (see header for API details)
+ */
+
+void wowlan_init(const wowlan_driver_t *driver)
+{
+	wowlan_driver = driver;
+
+	wowlan_config_free(wowlan_config);
+	wowlan_config = NULL;
+	has_last_wake = FALSE;
+	wake_reported = FALSE;
+	driver_configured = FALSE;
+}
+
+/**
+ * Get the name of a trigger (see header for API details)
+ */
+
+const gchar *wowlan_trigger_to_string(guint trigger)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(trigger_names); i++)
+	{
+		if (trigger_names[i].trigger == trigger)
+		{
+			return trigger_names[i].name;
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Look up a trigger by its name (see header for API details)
+ */
+
+guint wowlan_trigger_from_string(const gchar *name)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(trigger_names); i++)
+	{
+		if (!g_strcmp0(trigger_names[i].name, name))
+		{
+			return trigger_names[i].trigger;
+		}
+	}
+
+	return 0;
+}
+
+static wowlan_pattern_t *pattern_new(gsize len, guint offset)
+{
+	wowlan_pattern_t *pattern = g_new0(wowlan_pattern_t, 1);
+
+	pattern->bytes = g_malloc0(len);
+	pattern->mask = g_malloc0((len + 7) / 8);
+	pattern->len = len;
+	pattern->offset = offset;
+
+	return pattern;
+}
+
+static void pattern_set_byte(wowlan_pattern_t *pattern, gsize n, guint8 value)
+{
+	pattern->bytes[n] = value;
+	pattern->mask[n / 8] |= 1 << (n % 8);
+}
+
+/**
+ * Parse a pattern (see header for API details)
+ */
+
+wowlan_pattern_t *wowlan_pattern_parse(const gchar *str, guint offset,
+                                       GError **error)
+{
+	wowlan_pattern_t *pattern;
+	gboolean matches = FALSE;
+	gsize len, n;
+
+	len = NULL != str ? strlen(str) : 0;
+
+	if (0 == len || len % 2 || len / 2 > WOWLAN_MAX_PATTERN_LEN)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+		            "A pattern needs 1 to %d bytes in hex", WOWLAN_MAX_PATTERN_LEN);
+		return NULL;
+	}
+
+	pattern = pattern_new(len / 2, offset);
+
+	for (n = 0; n < pattern->len; n++)
+	{
+		const gchar *byte = str + 2 * n;
+
+		if ('?' == byte[0] && '?' == byte[1])
+		{
+			continue;
+		}
+
+		if (!g_ascii_isxdigit(byte[0]) || !g_ascii_isxdigit(byte[1]))
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+			            "Invalid byte \"%.2s\" in pattern", byte);
+			wowlan_pattern_free(pattern);
+			return NULL;
+		}
+
+		pattern_set_byte(pattern, n, (g_ascii_xdigit_value(byte[0]) << 4) |
+		                 g_ascii_xdigit_value(byte[1]));
+		matches = TRUE;
+	}
+
+	/* A pattern of wildcards only would wake us up on every packet */
+	if (!matches)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+		            "A pattern needs at least one byte to match");
+		wowlan_pattern_free(pattern);
+		return NULL;
+	}
+
+	return pattern;
+}
+
+/**
+ * Create a pattern matching IPv4 packets to a port (see header for API
+ * details)
+ */
+
+wowlan_pattern_t *wowlan_pattern_new_port(guint8 protocol, guint16 port)
+{
+	wowlan_pattern_t *pattern = pattern_new(WOWLAN_IPV4_DPORT_OFFSET + 2, 0);
+
+	/* Ethertype IPv4, the protocol and the destination port */
+	pattern_set_byte(pattern, WOWLAN_ETHERTYPE_OFFSET, 0x08);
+	pattern_set_byte(pattern, WOWLAN_ETHERTYPE_OFFSET + 1, 0x00);
+	pattern_set_byte(pattern, WOWLAN_IPV4_PROTO_OFFSET, protocol);
+	pattern_set_byte(pattern, WOWLAN_IPV4_DPORT_OFFSET, port >> 8);
+	pattern_set_byte(pattern, WOWLAN_IPV4_DPORT_OFFSET + 1, port & 0xff);
+
+	return pattern;
+}
+
+/**
+ * Write a pattern in hex (see header for API details)
+ */
+
+gchar *wowlan_pattern_to_string(const wowlan_pattern_t *pattern)
+{
+	GString *str = g_string_sized_new(2 * pattern->len);
+	gsize n;
+
+	for (n = 0; n < pattern->len; n++)
+	{
+		if (pattern->mask[n / 8] & (1 << (n % 8)))
+		{
+			g_string_append_printf(str, "%02x", pattern->bytes[n]);
+		}
+		else
+		{
+			g_string_append(str, "??");
+		}
+	}
+
+	return g_string_free(str, FALSE);
+}
+
+void wowlan_pattern_free(wowlan_pattern_t *pattern)
+{
+	if (NULL == pattern)
+	{
+		return;
+	}
+
+	g_free(pattern->bytes);
+	g_free(pattern->mask);
+	g_free(pattern);
+}
+
+/**
+ * Create a configuration (see header for API details)
+ */
+
+wowlan_config_t *wowlan_config_new(void)
+{
+	wowlan_config_t *config = g_new0(wowlan_config_t, 1);
+
+	config->patterns = g_ptr_array_new_with_free_func((GDestroyNotify)
+	                   wowlan_pattern_free);
+
+	return config;
+}
+
+void wowlan_config_free(wowlan_config_t *config)
+{
+	if (NULL == config)
+	{
+		return;
+	}
+
+	g_ptr_array_free(config->patterns, TRUE);
+	g_free(config);
+}
+
+/**
+ * Add a pattern to a configuration (see header for API details)
+ */
+
+void wowlan_config_add_pattern(wowlan_config_t *config,
+                               wowlan_pattern_t *pattern)
+{
+	g_ptr_array_add(config->patterns, pattern);
+	config->triggers |= WOWLAN_TRIGGER_PATTERN;
+}
+
+static gboolean is_enabled(const wowlan_config_t *config)
+{
+	return NULL != config && 0 != config->triggers;
+}
+
+/**
+ * Check a configuration against the driver (see header for API details)
+ */
+
+gboolean wowlan_config_validate(const wowlan_config_t *config,
+                                const wowlan_capabilities_t *caps, GError **error)
+{
+	guint unsupported = config->triggers & ~caps->triggers & ~WOWLAN_TRIGGER_PATTERN;
+	guint i;
+
+	if (unsupported)
+	{
+		/* Name the first one, that is enough to act on */
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED,
+		            "Trigger %s is not supported",
+		            wowlan_trigger_to_string(unsupported & -unsupported));
+		return FALSE;
+	}
+
+	if ((config->triggers & WOWLAN_TRIGGER_PATTERN) && 0 == config->patterns->len)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+		            "Trigger pattern needs patterns");
+		return FALSE;
+	}
+
+	if (config->patterns->len > caps->max_patterns)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED,
+		            "At most %u patterns are supported", caps->max_patterns);
+		return FALSE;
+	}
+
+	for (i = 0; i < config->patterns->len; i++)
+	{
+		const wowlan_pattern_t *pattern = g_ptr_array_index(config->patterns, i);
+
+		if (pattern->len < caps->min_pattern_len ||
+		        pattern->len > caps->max_pattern_len)
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED,
+			            "Pattern %u has %" G_GSIZE_FORMAT " bytes, %u to %u are supported",
+			            i, pattern->len, caps->min_pattern_len, caps->max_pattern_len);
+			return FALSE;
+		}
+
+		if (pattern->offset > caps->max_pattern_offset)
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED,
+			            "Pattern %u starts at %u, at most %u is supported",
+			            i, pattern->offset, caps->max_pattern_offset);
+			return FALSE;
+		}
+	}
+
+	return TRUE;
+}
+
+/**
+ * Write a configuration to a string (see header for API details)
+ */
+
+gchar *wowlan_config_to_string(const wowlan_config_t *config)
+{
+	GString *str = g_string_new(NULL);
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(trigger_names); i++)
+	{
+		/* Patterns are written one by one */
+		if (trigger_names[i].trigger != WOWLAN_TRIGGER_PATTERN &&
+		        (config->triggers & trigger_names[i].trigger))
+		{
+			g_string_append_printf(str, "%s%s", str->len ? " " : "",
+			                       trigger_names[i].name);
+		}
+	}
+
+	for (i = 0; i < config->patterns->len; i++)
+	{
+		const wowlan_pattern_t *pattern = g_ptr_array_index(config->patterns, i);
+		gchar *hex = wowlan_pattern_to_string(pattern);
+
+		g_string_append_printf(str, "%s" PATTERN_PREFIX "%u:%s", str->len ? " " : "",
+		                       pattern->offset, hex);
+		g_free(hex);
+	}
+
+	return g_string_free(str, FALSE);
+}
+
+/**
+ * Read a configuration from a string (see header for API details)
+ */
+
+wowlan_config_t *wowlan_config_from_string(const gchar *str, GError **error)
+{
+	wowlan_config_t *config = wowlan_config_new();
+	GStrv tokens = g_strsplit(NULL != str ? str : "", " ", -1);
+	guint trigger, i;
+
+	for (i = 0; NULL != tokens[i]; i++)
+	{
+		if ('\0' == tokens[i][0])
+		{
+			continue;
+		}
+
+		if (g_str_has_prefix(tokens[i], PATTERN_PREFIX))
+		{
+			const gchar *offset_str = tokens[i] + strlen(PATTERN_PREFIX);
+			gchar *end = NULL;
+			guint64 offset = g_ascii_strtoull(offset_str, &end, 10);
+			wowlan_pattern_t *pattern;
+
+			if (end == offset_str || ':' != *end || offset > G_MAXUINT)
+			{
+				g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+				            "Invalid pattern \"%s\"", tokens[i]);
+				goto error;
+			}
+
+			pattern = wowlan_pattern_parse(end + 1, offset, error);
+
+			if (NULL == pattern)
+			{
+				goto error;
+			}
+
+			wowlan_config_add_pattern(config, pattern);
+			continue;
+		}
+
+		trigger = wowlan_trigger_from_string(tokens[i]);
+
+		if (0 == trigger || WOWLAN_TRIGGER_PATTERN == trigger)
+		{
+			g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID,
+			            "Unknown trigger \"%s\"", tokens[i]);
+			goto error;
+		}
+
+		config->triggers |= trigger;
+	}
+
+	g_strfreev(tokens);
+	return config;
+
+error:
+	g_strfreev(tokens);
+	wowlan_config_free(config);
+	return NULL;
+}
+
+/**
+ * Get what the driver supports (see header for API details)
+ */
+
+gboolean wowlan_get_capabilities(const gchar *iface,
+                                 wowlan_capabilities_t *caps, GError **error)
+{
+	if (NULL == wowlan_driver)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER,
+		            "No Wake-on-WLAN driver");
+		return FALSE;
+	}
+
+	memset(caps, 0, sizeof(wowlan_capabilities_t));
+
+	return wowlan_driver->get_capabilities(iface, caps, error);
+}
+
+/**
+ * Get the configuration used on the next suspend (see header for API
+ * details)
+ */
+
+const wowlan_config_t *wowlan_get_config(void)
+{
+	return wowlan_config;
+}
+
+/**
+ * Replace the configuration (see header for API details)
+ */
+
+gboolean wowlan_set_config(const gchar *iface, wowlan_config_t *config,
+                           GError **error)
+{
+	wowlan_capabilities_t caps;
+
+	if (is_enabled(config) &&
+	        (!wowlan_get_capabilities(iface, &caps, error) ||
+	         !wowlan_config_validate(config, &caps, error)))
+	{
+		return FALSE;
+	}
+
+	wowlan_load_config(config);
+
+	return TRUE;
+}
+
+/**
+ * Restore a stored configuration (see header for API details)
+ */
+
+void wowlan_load_config(wowlan_config_t *config)
+{
+	if (!is_enabled(config))
+	{
+		wowlan_config_free(config);
+		config = NULL;
+	}
+
+	wowlan_config_free(wowlan_config);
+	wowlan_config = config;
+}
+
+/**
+ * Apply the configuration before suspending (see header for API details)
+ */
+
+gboolean wowlan_suspend(const gchar *iface, GError **error)
+{
+	wowlan_capabilities_t caps;
+
+	wake_reported = FALSE;
+
+	if (NULL == wowlan_driver)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER,
+		            "No Wake-on-WLAN driver");
+		return FALSE;
+	}
+
+	/* Only undo what we set, the driver may have been set up by someone else */
+	if (!is_enabled(wowlan_config))
+	{
+		if (driver_configured)
+		{
+			if (!wowlan_driver->set_config(iface, NULL, error))
+			{
+				return FALSE;
+			}
+
+			driver_configured = FALSE;
+		}
+
+		return TRUE;
+	}
+
+	if (!wowlan_get_capabilities(iface, &caps, error) ||
+	        !wowlan_config_validate(wowlan_config, &caps, error))
+	{
+		return FALSE;
+	}
+
+	/* Even a failed call may have left part of it behind */
+	driver_configured = TRUE;
+
+	return wowlan_driver->set_config(iface, wowlan_config, error);
+}
+
+/**
+ * Record the resume (see header for API details)
+ */
+
+void wowlan_resume(void)
+{
+	if (!wake_reported)
+	{
+		last_wake.time = g_get_real_time() / G_USEC_PER_SEC;
+		last_wake.trigger = 0;
+		last_wake.pattern = -1;
+		has_last_wake = TRUE;
+	}
+
+	wake_reported = FALSE;
+}
+
+/**
+ * Record the wake-up reported by the driver (see header for API details)
+ */
+
+void wowlan_report_wakeup(guint trigger, gint pattern)
+{
+	/* Reports can come in before or after the resume is signalled */
+	last_wake.time = g_get_real_time() / G_USEC_PER_SEC;
+	last_wake.trigger = trigger;
+	last_wake.pattern = pattern;
+	has_last_wake = TRUE;
+	wake_reported = TRUE;
+}
+
+/**
+ * Get the last wake reason (see header for API details)
+ */
+
+const wowlan_wake_t *wowlan_get_last_wake(void)
+{
+	return has_last_wake ? &last_wake : NULL;
+}
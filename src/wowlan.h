@@ -0,0 +1,307 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wowlan.h
+ *
+ * @brief Header file defining the Wake-on-WLAN configuration
+ *
+ * The configuration holds the triggers which wake the system up from
+ * suspend: a magic packet, losing the connection, a failed GTK rekey or a
+ * packet matching one of a set of patterns. It is checked against what the
+ * wifi driver supports and handed to the driver right before suspend. The
+ * driver reports which trigger woke the system up, which is kept as the last
+ * wake reason.
+ *
+ * The driver is accessed through a wowlan_driver_t, see wowlan_nl80211.h for
+ * the nl80211 one.
+ *
+ */
+
+#ifndef _WOWLAN_H_
+#define _WOWLAN_H_
+
+#include <glib.h>
+
+/**
+ * Limits of the patterns regardless of the driver
+ */
+#define WOWLAN_MAX_PATTERNS         16
+#define WOWLAN_MAX_PATTERN_LEN      128
+
+/**
+ * Offsets within an ethernet frame carrying IPv4 without options, used for
+ * patterns matching a destination port
+ */
+#define WOWLAN_ETHERTYPE_OFFSET     12
+#define WOWLAN_IPV4_PROTO_OFFSET    23
+#define WOWLAN_IPV4_DPORT_OFFSET    36
+
+#define WOWLAN_ERROR                wowlan_error_quark()
+
+typedef enum
+{
+	WOWLAN_ERROR_INVALID,       /* Malformed trigger or pattern */
+	WOWLAN_ERROR_UNSUPPORTED,   /* Not supported by the driver */
+	WOWLAN_ERROR_DRIVER,        /* The driver call failed */
+} wowlan_error_t;
+
+typedef enum
+{
+	WOWLAN_TRIGGER_ANY                  = 1 << 0,
+	WOWLAN_TRIGGER_DISCONNECT           = 1 << 1,
+	WOWLAN_TRIGGER_MAGIC_PACKET         = 1 << 2,
+	WOWLAN_TRIGGER_GTK_REKEY_FAILURE    = 1 << 3,
+	WOWLAN_TRIGGER_EAP_IDENTITY_REQUEST = 1 << 4,
+	WOWLAN_TRIGGER_4WAY_HANDSHAKE       = 1 << 5,
+	WOWLAN_TRIGGER_RFKILL_RELEASE       = 1 << 6,
+	WOWLAN_TRIGGER_PATTERN              = 1 << 7,
+} wowlan_trigger_t;
+
+typedef struct wowlan_pattern
+{
+	guint8 *bytes;
+	guint8 *mask;       /* One bit per byte, LSB first, as used by nl80211 */
+	gsize len;
+	guint offset;       /* Where the pattern starts in the ethernet frame */
+} wowlan_pattern_t;
+
+typedef struct wowlan_config
+{
+	guint triggers;     /* wowlan_trigger_t, PATTERN if there are patterns */
+	GPtrArray *patterns;
+} wowlan_config_t;
+
+typedef struct wowlan_capabilities
+{
+	guint triggers;             /* Supported wowlan_trigger_t */
+	gboolean gtk_rekey_offload; /* The device renews the GTK while suspended */
+	guint max_patterns;
+	guint min_pattern_len;
+	guint max_pattern_len;
+	guint max_pattern_offset;
+} wowlan_capabilities_t;
+
+typedef struct wowlan_wake
+{
+	gint64 time;        /* Wall clock time of the resume, in seconds */
+	guint trigger;      /* wowlan_trigger_t, 0 if the wifi didn't wake us */
+	gint pattern;       /* Index of the matching pattern, -1 if none */
+} wowlan_wake_t;
+
+/**
+ * Access to the wifi driver
+ */
+typedef struct wowlan_driver
+{
+	/* Get what the driver of an interface supports */
+	gboolean (*get_capabilities)(const gchar *iface, wowlan_capabilities_t *caps,
+	                             GError **error);
+	/* Hand the configuration to the driver, NULL to disable Wake-on-WLAN */
+	gboolean (*set_config)(const gchar *iface, const wowlan_config_t *config,
+	                       GError **error);
+} wowlan_driver_t;
+
+extern GQuark wowlan_error_quark(void);
+
+/**
+ * Set the driver used. Drops the configuration and the last wake reason.
+ *
+ * @param[IN]  driver Driver, NULL to stop using one
+ */
+extern void wowlan_init(const wowlan_driver_t *driver);
+
+/**
+ * Get the name of a trigger as used in the luna API
+ *
+ * @param[IN]  trigger A single trigger
+ *
+ * @return Name of the trigger, NULL if unknown
+ */
+extern const gchar *wowlan_trigger_to_string(guint trigger);
+
+/**
+ * Look up a trigger by its name
+ *
+ * @param[IN]  name Name of the trigger, e.g. "magicPacket"
+ *
+ * @return Trigger, 0 if unknown
+ */
+extern guint wowlan_trigger_from_string(const gchar *name);
+
+/**
+ * Parse a pattern given in hex, with "??" for bytes which don't matter,
+ * e.g. "0800????11"
+ *
+ * @param[IN]  str Pattern
+ * @param[IN]  offset Where the pattern starts in the ethernet frame
+ * @param[OUT] error Why the pattern is invalid
+ *
+ * @return Pattern, free with wowlan_pattern_free, NULL if invalid
+ */
+extern wowlan_pattern_t *wowlan_pattern_parse(const gchar *str, guint offset,
+        GError **error);
+
+/**
+ * Create a pattern matching IPv4 packets to a port, e.g. the port of a cast
+ * protocol
+ *
+ * @param[IN]  protocol IPPROTO_UDP or IPPROTO_TCP
+ * @param[IN]  port Destination port
+ *
+ * @return Pattern, free with wowlan_pattern_free
+ */
+extern wowlan_pattern_t *wowlan_pattern_new_port(guint8 protocol, guint16 port);
+
+/**
+ * Write a pattern in the format of wowlan_pattern_parse
+ *
+ * @param[IN]  pattern Pattern
+ *
+ * @return Pattern in hex, free with g_free
+ */
+extern gchar *wowlan_pattern_to_string(const wowlan_pattern_t *pattern);
+
+extern void wowlan_pattern_free(wowlan_pattern_t *pattern);
+
+/**
+ * Create a configuration without triggers
+ *
+ * @return Configuration, free with wowlan_config_free
+ */
+extern wowlan_config_t *wowlan_config_new(void);
+
+extern void wowlan_config_free(wowlan_config_t *config);
+
+/**
+ * Add a pattern to a configuration
+ *
+ * @param[IN]  config Configuration
+ * @param[IN]  pattern Pattern, owned by the configuration afterwards
+ */
+extern void wowlan_config_add_pattern(wowlan_config_t *config,
+                                      wowlan_pattern_t *pattern);
+
+/**
+ * Check a configuration against what the driver supports
+ *
+ * @param[IN]  config Configuration
+ * @param[IN]  caps Capabilities of the driver
+ * @param[OUT] error Which trigger or pattern isn't supported
+ *
+ * @return TRUE if the driver supports the configuration, FALSE otherwise
+ */
+extern gboolean wowlan_config_validate(const wowlan_config_t *config,
+                                       const wowlan_capabilities_t *caps, GError **error);
+
+/**
+ * Write a configuration to a string for storing it. Triggers are written by
+ * name, patterns as "pattern:<offset>:<hex>", separated by spaces.
+ *
+ * @param[IN]  config Configuration
+ *
+ * @return String, free with g_free
+ */
+extern gchar *wowlan_config_to_string(const wowlan_config_t *config);
+
+/**
+ * Read a configuration written by wowlan_config_to_string
+ *
+ * @param[IN]  str String
+ * @param[OUT] error Why the string is invalid
+ *
+ * @return Configuration, free with wowlan_config_free, NULL if invalid
+ */
+extern wowlan_config_t *wowlan_config_from_string(const gchar *str,
+        GError **error);
+
+/**
+ * Get what the driver of an interface supports
+ *
+ * @param[IN]  iface Wifi interface
+ * @param[OUT] caps Capabilities
+ * @param[OUT] error Why they couldn't be read
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean wowlan_get_capabilities(const gchar *iface,
+                                        wowlan_capabilities_t *caps, GError **error);
+
+/**
+ * Get the configuration used on the next suspend
+ *
+ * @return Configuration, NULL if Wake-on-WLAN is disabled
+ */
+extern const wowlan_config_t *wowlan_get_config(void);
+
+/**
+ * Replace the configuration used on the next suspend after checking it
+ * against the driver of an interface
+ *
+ * @param[IN]  iface Wifi interface
+ * @param[IN]  config Configuration, owned by the module if accepted. NULL or
+ *                    a configuration without triggers disables Wake-on-WLAN.
+ * @param[OUT] error Why the configuration wasn't accepted
+ *
+ * @return TRUE if accepted, FALSE otherwise
+ */
+extern gboolean wowlan_set_config(const gchar *iface, wowlan_config_t *config,
+                                  GError **error);
+
+/**
+ * Restore a stored configuration without checking it, e.g. at startup when
+ * the wifi interface may not exist yet. It is checked on suspend.
+ *
+ * @param[IN]  config Configuration, owned by the module afterwards. NULL or a
+ *                    configuration without triggers disables Wake-on-WLAN.
+ */
+extern void wowlan_load_config(wowlan_config_t *config);
+
+/**
+ * Hand the configuration to the driver before the system suspends. It is
+ * checked again as the driver may have changed since it was set. Without a
+ * configuration the driver is left alone, unless a configuration was handed
+ * to it before, which is then cleared.
+ *
+ * @param[IN]  iface Wifi interface
+ * @param[OUT] error Why the configuration couldn't be applied
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean wowlan_suspend(const gchar *iface, GError **error);
+
+/**
+ * Record that the system resumed. Unless the driver reported a wake-up since
+ * the suspend, the wifi didn't wake the system.
+ */
+extern void wowlan_resume(void);
+
+/**
+ * Record the wake-up reported by the driver
+ *
+ * @param[IN]  trigger wowlan_trigger_t which woke the system, 0 if unknown
+ * @param[IN]  pattern Index of the matching pattern, -1 if none
+ */
+extern void wowlan_report_wakeup(guint trigger, gint pattern);
+
+/**
+ * Get the last wake reason
+ *
+ * @return Wake reason, NULL if the system didn't resume yet
+ */
+extern const wowlan_wake_t *wowlan_get_last_wake(void);
+
+#endif /* _WOWLAN_H_ */
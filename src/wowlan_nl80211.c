@@ -0,0 +1,409 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wowlan_nl80211.c
+ *
+ * @brief Wake-on-WLAN driver talking nl80211 over a generic netlink socket
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/genetlink.h>
+#include <linux/nl80211.h>
+
+#include "wowlan_nl80211.h"
+#include "nl80211_utils.h"
+
+#define NL_RECV_SIZE            32768
+
+/* Flag triggers and their nl80211 attributes */
+static const struct
+{
+	guint trigger;
+	guint16 attr;
+} trigger_attrs[] =
+{
+	{ WOWLAN_TRIGGER_ANY, NL80211_WOWLAN_TRIG_ANY },
+	{ WOWLAN_TRIGGER_DISCONNECT, NL80211_WOWLAN_TRIG_DISCONNECT },
+	{ WOWLAN_TRIGGER_MAGIC_PACKET, NL80211_WOWLAN_TRIG_MAGIC_PKT },
+	{ WOWLAN_TRIGGER_GTK_REKEY_FAILURE, NL80211_WOWLAN_TRIG_GTK_REKEY_FAILURE },
+	{ WOWLAN_TRIGGER_EAP_IDENTITY_REQUEST, NL80211_WOWLAN_TRIG_EAP_IDENT_REQUEST },
+	{ WOWLAN_TRIGGER_4WAY_HANDSHAKE, NL80211_WOWLAN_TRIG_4WAY_HANDSHAKE },
+	{ WOWLAN_TRIGGER_RFKILL_RELEASE, NL80211_WOWLAN_TRIG_RFKILL_RELEASE },
+};
+
+static int watch_fd = -1;
+static guint watch_id = 0;
+
+/* Pass an nl80211 error on as a wowlan one */
+static void set_driver_error(GError **error, GError *nl_error)
+{
+	g_set_error_literal(error, WOWLAN_ERROR,
+	                    g_error_matches(nl_error, NL80211_UTILS_ERROR,
+	                                    NL80211_UTILS_ERROR_UNSUPPORTED) ? WOWLAN_ERROR_UNSUPPORTED :
+	                    WOWLAN_ERROR_DRIVER, nl_error->message);
+	g_error_free(nl_error);
+}
+
+/**
+ * Write the triggers attribute (see header for API details)
+ */
+
+gsize wowlan_nl80211_put_triggers(guint8 *buf, gsize size,
+                                  const wowlan_config_t *config)
+{
+	genl_buf_t attr = { buf, size, 0, FALSE };
+	gsize triggers, patterns;
+	guint i;
+
+	triggers = genl_nest_start(&attr, NL80211_ATTR_WOWLAN_TRIGGERS);
+
+	for (i = 0; i < G_N_ELEMENTS(trigger_attrs); i++)
+	{
+		if (config->triggers & trigger_attrs[i].trigger)
+		{
+			genl_put_attr(&attr, trigger_attrs[i].attr, NULL, 0);
+		}
+	}
+
+	if (config->patterns->len)
+	{
+		patterns = genl_nest_start(&attr, NL80211_WOWLAN_TRIG_PKT_PATTERN);
+
+		for (i = 0; i < config->patterns->len; i++)
+		{
+			const wowlan_pattern_t *pattern = g_ptr_array_index(config->patterns, i);
+			/* The patterns are numbered from 1 */
+			gsize nest = genl_nest_start(&attr, i + 1);
+
+			genl_put_attr(&attr, NL80211_PKTPAT_MASK, pattern->mask, (pattern->len + 7) / 8);
+			genl_put_attr(&attr, NL80211_PKTPAT_PATTERN, pattern->bytes, pattern->len);
+			genl_put_u32(&attr, NL80211_PKTPAT_OFFSET, pattern->offset);
+			genl_nest_end(&attr, nest);
+		}
+
+		genl_nest_end(&attr, patterns);
+	}
+
+	genl_nest_end(&attr, triggers);
+
+	return attr.overflow ? 0 : attr.len;
+}
+
+/**
+ * Read the supported triggers (see header for API details)
+ */
+
+void wowlan_nl80211_parse_supported(const guint8 *data, gsize len,
+                                    wowlan_capabilities_t *caps)
+{
+	const guint8 *pos = data;
+	const struct nlattr *attr;
+	guint i;
+
+	memset(caps, 0, sizeof(wowlan_capabilities_t));
+
+	while (NULL != (attr = genl_next_attr(&pos, data + len)))
+	{
+		if (NL80211_WOWLAN_TRIG_GTK_REKEY_SUPPORTED == genl_attr_type(attr))
+		{
+			caps->gtk_rekey_offload = TRUE;
+		}
+		else if (NL80211_WOWLAN_TRIG_PKT_PATTERN == genl_attr_type(attr) &&
+		         genl_attr_len(attr) >= sizeof(struct nl80211_pattern_support))
+		{
+			struct nl80211_pattern_support support;
+
+			memcpy(&support, genl_attr_data(attr), sizeof(support));
+
+			if (support.max_patterns)
+			{
+				caps->triggers |= WOWLAN_TRIGGER_PATTERN;
+			}
+
+			caps->max_patterns = MIN(support.max_patterns, WOWLAN_MAX_PATTERNS);
+			caps->min_pattern_len = support.min_pattern_len;
+			caps->max_pattern_len = MIN(support.max_pattern_len, WOWLAN_MAX_PATTERN_LEN);
+			caps->max_pattern_offset = support.max_pkt_offset;
+		}
+		else
+		{
+			for (i = 0; i < G_N_ELEMENTS(trigger_attrs); i++)
+			{
+				if (trigger_attrs[i].attr == genl_attr_type(attr))
+				{
+					caps->triggers |= trigger_attrs[i].trigger;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Read the wake reason (see header for API details)
+ */
+
+void wowlan_nl80211_parse_wakeup(const guint8 *data, gsize len,
+                                 guint *trigger, gint *pattern)
+{
+	const guint8 *pos = data;
+	const struct nlattr *attr;
+	guint i;
+
+	*trigger = 0;
+	*pattern = -1;
+
+	while (NULL != (attr = genl_next_attr(&pos, data + len)))
+	{
+		/* When reporting, the pattern attribute holds the index */
+		if (NL80211_WOWLAN_TRIG_PKT_PATTERN == genl_attr_type(attr))
+		{
+			*trigger = WOWLAN_TRIGGER_PATTERN;
+			*pattern = genl_attr_u32(attr);
+			return;
+		}
+
+		for (i = 0; i < G_N_ELEMENTS(trigger_attrs); i++)
+		{
+			if (trigger_attrs[i].attr == genl_attr_type(attr))
+			{
+				*trigger = trigger_attrs[i].trigger;
+			}
+		}
+	}
+}
+
+static void wiphy_cb(const guint8 *attrs, gsize len, gpointer user_data)
+{
+	const guint8 *pos = attrs;
+	const struct nlattr *attr;
+
+	while (NULL != (attr = genl_next_attr(&pos, attrs + len)))
+	{
+		if (NL80211_ATTR_WOWLAN_TRIGGERS_SUPPORTED == genl_attr_type(attr))
+		{
+			wowlan_nl80211_parse_supported(genl_attr_data(attr), genl_attr_len(attr), user_data);
+		}
+	}
+}
+
+static gboolean nl80211_get_capabilities(const gchar *iface,
+        wowlan_capabilities_t *caps, GError **error)
+{
+	guint8 data[NL80211_UTILS_MSG_SIZE];
+	GError *nl_error = NULL;
+	guint32 ifindex;
+	genl_buf_t msg;
+	int fd;
+
+	if (!nl80211_get_ifindex(iface, &ifindex, &nl_error))
+	{
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	fd = nl80211_open(&nl_error);
+
+	if (fd < 0)
+	{
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	/* Without the triggers in the split dump the wiphy doesn't support any */
+	memset(caps, 0, sizeof(wowlan_capabilities_t));
+
+	nl80211_msg_init(&msg, data, NL80211_CMD_GET_WIPHY, NLM_F_DUMP);
+	genl_put_attr(&msg, NL80211_ATTR_SPLIT_WIPHY_DUMP, NULL, 0);
+	genl_put_u32(&msg, NL80211_ATTR_IFINDEX, ifindex);
+
+	if (!nl80211_request(fd, &msg, wiphy_cb, caps, &nl_error))
+	{
+		close(fd);
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	close(fd);
+	return TRUE;
+}
+
+static gboolean nl80211_set_config(const gchar *iface,
+                                   const wowlan_config_t *config, GError **error)
+{
+	guint8 data[NL80211_UTILS_MSG_SIZE];
+	GError *nl_error = NULL;
+	guint32 ifindex;
+	genl_buf_t msg;
+	gsize len;
+	int fd;
+
+	if (!nl80211_get_ifindex(iface, &ifindex, &nl_error))
+	{
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	fd = nl80211_open(&nl_error);
+
+	if (fd < 0)
+	{
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	nl80211_msg_init(&msg, data, NL80211_CMD_SET_WOWLAN, 0);
+	genl_put_u32(&msg, NL80211_ATTR_IFINDEX, ifindex);
+
+	/* Without triggers the kernel disables Wake-on-WLAN */
+	if (NULL != config)
+	{
+		len = wowlan_nl80211_put_triggers(msg.data + msg.len, msg.size - msg.len,
+		                                  config);
+		msg.overflow = 0 == len;
+		msg.len += len;
+	}
+
+	if (!nl80211_request(fd, &msg, NULL, NULL, &nl_error))
+	{
+		close(fd);
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	close(fd);
+	return TRUE;
+}
+
+const wowlan_driver_t wowlan_nl80211_driver =
+{
+	.get_capabilities = nl80211_get_capabilities,
+	.set_config = nl80211_set_config,
+};
+
+static gboolean wakeup_cb(GIOChannel *channel, GIOCondition cond,
+                          gpointer user_data)
+{
+	guint32 buf[NL_RECV_SIZE / sizeof(guint32)];
+	struct nlmsghdr *hdr;
+	ssize_t len;
+
+	if (cond & (G_IO_ERR | G_IO_HUP | G_IO_NVAL))
+	{
+		watch_id = 0;
+		return FALSE;
+	}
+
+	len = recv(watch_fd, buf, sizeof(buf), MSG_DONTWAIT);
+
+	for (hdr = (struct nlmsghdr *) buf; len > 0 && NLMSG_OK(hdr, len);
+	        hdr = NLMSG_NEXT(hdr, len))
+	{
+		const struct genlmsghdr *genl = NLMSG_DATA(hdr);
+		const guint8 *attrs = (const guint8 *) genl + GENL_HDRLEN;
+		const guint8 *pos = attrs;
+		const struct nlattr *attr;
+		guint trigger = 0;
+		gint pattern = -1;
+
+		if (hdr->nlmsg_len < NLMSG_LENGTH(GENL_HDRLEN) ||
+		        NL80211_CMD_SET_WOWLAN != genl->cmd)
+		{
+			continue;
+		}
+
+		/* Without triggers the wifi didn't cause the wake-up */
+		while (NULL != (attr = genl_next_attr(&pos,
+		                                 attrs + hdr->nlmsg_len - NLMSG_LENGTH(GENL_HDRLEN))))
+		{
+			if (NL80211_ATTR_WOWLAN_TRIGGERS == genl_attr_type(attr))
+			{
+				wowlan_nl80211_parse_wakeup(genl_attr_data(attr), genl_attr_len(attr), &trigger,
+				                            &pattern);
+			}
+		}
+
+		wowlan_report_wakeup(trigger, pattern);
+	}
+
+	return TRUE;
+}
+
+/**
+ * Start listening for wake-ups (see header for API details)
+ */
+
+gboolean wowlan_nl80211_watch_start(GError **error)
+{
+	GError *nl_error = NULL;
+	GIOChannel *channel;
+	guint32 mlme_group;
+
+	if (watch_fd >= 0)
+	{
+		return TRUE;
+	}
+
+	watch_fd = nl80211_open(&nl_error);
+
+	if (watch_fd < 0)
+	{
+		set_driver_error(error, nl_error);
+		return FALSE;
+	}
+
+	mlme_group = nl80211_get_group(NL80211_MULTICAST_GROUP_MLME);
+
+	if (0 == mlme_group ||
+	        setsockopt(watch_fd, SOL_NETLINK, NETLINK_ADD_MEMBERSHIP,
+	                   &mlme_group, sizeof(mlme_group)) < 0)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER,
+		            "Failed to join the nl80211 mlme group");
+		goto error;
+	}
+
+	channel = g_io_channel_unix_new(watch_fd);
+	watch_id = g_io_add_watch(channel, G_IO_IN | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+	                          wakeup_cb, NULL);
+	g_io_channel_unref(channel);
+
+	return TRUE;
+
+error:
+	close(watch_fd);
+	watch_fd = -1;
+	return FALSE;
+}
+
+void wowlan_nl80211_watch_stop(void)
+{
+	if (watch_id)
+	{
+		g_source_remove(watch_id);
+		watch_id = 0;
+	}
+
+	if (watch_fd >= 0)
+	{
+		close(watch_fd);
+		watch_fd = -1;
+	}
+}
@@ -0,0 +1,84 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/**
+ * @file  wowlan_nl80211.h
+ *
+ * @brief Header file defining the nl80211 Wake-on-WLAN driver
+ *
+ * Talks to cfg80211 over generic netlink: the supported triggers are read
+ * from the wiphy, the configuration is set with NL80211_CMD_SET_WOWLAN and
+ * the wake-ups the kernel reports on the "mlme" multicast group are handed
+ * to wowlan_report_wakeup.
+ *
+ */
+
+#ifndef _WOWLAN_NL80211_H_
+#define _WOWLAN_NL80211_H_
+
+#include <glib.h>
+
+#include "wowlan.h"
+
+extern const wowlan_driver_t wowlan_nl80211_driver;
+
+/**
+ * Start listening for the wake-ups reported by the kernel
+ *
+ * @param[OUT] error Why the events can't be received
+ *
+ * @return TRUE on success, FALSE otherwise
+ */
+extern gboolean wowlan_nl80211_watch_start(GError **error);
+
+extern void wowlan_nl80211_watch_stop(void);
+
+/**
+ * Write the NL80211_ATTR_WOWLAN_TRIGGERS attribute for a configuration
+ *
+ * @param[OUT] buf Buffer for the attribute
+ * @param[IN]  size Size of buf
+ * @param[IN]  config Configuration
+ *
+ * @return Length of the attribute, 0 if buf is too small
+ */
+extern gsize wowlan_nl80211_put_triggers(guint8 *buf, gsize size,
+        const wowlan_config_t *config);
+
+/**
+ * Read the capabilities from the payload of the
+ * NL80211_ATTR_WOWLAN_TRIGGERS_SUPPORTED attribute of a wiphy
+ *
+ * @param[IN]  data Payload of the attribute
+ * @param[IN]  len Length of the payload
+ * @param[OUT] caps Capabilities
+ */
+extern void wowlan_nl80211_parse_supported(const guint8 *data, gsize len,
+        wowlan_capabilities_t *caps);
+
+/**
+ * Read the wake reason from the payload of the NL80211_ATTR_WOWLAN_TRIGGERS
+ * attribute of a wake-up event
+ *
+ * @param[IN]  data Payload of the attribute
+ * @param[IN]  len Length of the payload
+ * @param[OUT] trigger wowlan_trigger_t which woke the system, 0 if unknown
+ * @param[OUT] pattern Index of the matching pattern, -1 if none
+ */
+extern void wowlan_nl80211_parse_wakeup(const guint8 *data, gsize len,
+                                        guint *trigger, gint *pattern);
+
+#endif /* _WOWLAN_NL80211_H_ */
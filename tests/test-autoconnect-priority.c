@@ -0,0 +1,216 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "autoconnect_priority.h"
+
+static void index_profiles(void)
+{
+	gchar *psk[] = { "psk", NULL };
+	gchar *open[] = { "none", NULL };
+
+	autoconnect_priority_clear_index();
+	autoconnect_priority_index("home", psk, 10);
+	autoconnect_priority_index("office", psk, 5);
+	autoconnect_priority_index("guest", open, 0);
+}
+
+static void test_select(void)
+{
+	autoconnect_network_t networks[] =
+	{
+		{ "guest", "none", 90 },
+		{ "home", "wep", 80 },
+		{ "office", "psk", 60 },
+		{ "home", "psk", 20 },
+		{ "stranger", "psk", 100 },
+	};
+
+	autoconnect_priority_reset();
+	index_profiles();
+
+	/* Weak home network, office wins right away while disconnected */
+	g_assert(&networks[2] == autoconnect_priority_select(networks, 5));
+
+	networks[3].strength = 50;
+	g_assert(&networks[3] == autoconnect_priority_select(networks, 5));
+
+	/* Unknown networks and other security types are ignored */
+	networks[3].strength = 0;
+	networks[2].strength = 0;
+	g_assert(&networks[0] == autoconnect_priority_select(networks, 5));
+	g_assert(NULL == autoconnect_priority_select(&networks[4], 1));
+
+	autoconnect_priority_reset();
+}
+
+static void test_hysteresis(void)
+{
+	autoconnect_network_t networks[] =
+	{
+		{ "guest", "none", 90, TRUE },
+		{ "office", "psk", 40 },
+		{ "home", "psk", 70 },
+	};
+	guint i;
+
+	autoconnect_priority_reset();
+	index_profiles();
+
+	/* Leaving the connected network takes confirmation */
+	for (i = 1; i < AUTOCONNECT_CONFIRM_SCANS; i++)
+	{
+		g_assert(NULL == autoconnect_priority_select(networks, 3));
+	}
+
+	/* A different winner starts over */
+	networks[2].strength = 10;
+	g_assert(NULL == autoconnect_priority_select(networks, 3));
+	networks[2].strength = 70;
+
+	for (i = 1; i < AUTOCONNECT_CONFIRM_SCANS; i++)
+	{
+		g_assert(NULL == autoconnect_priority_select(networks, 3));
+	}
+
+	g_assert(&networks[2] == autoconnect_priority_select(networks, 3));
+
+	/* Nothing to do once connected to the best */
+	networks[0].connected = FALSE;
+	networks[2].connected = TRUE;
+	g_assert(NULL == autoconnect_priority_select(networks, 3));
+
+	/* A weak connection is not left for a network of lower priority */
+	networks[2].strength = 5;
+
+	for (i = 0; i <= AUTOCONNECT_CONFIRM_SCANS; i++)
+	{
+		g_assert(NULL == autoconnect_priority_select(networks, 3));
+	}
+
+	autoconnect_priority_reset();
+}
+
+static void test_scale(void)
+{
+	autoconnect_network_t *networks = g_new0(autoconnect_network_t, 1000);
+	gchar **ssids = g_new0(gchar *, 1001);
+	guint i;
+
+	autoconnect_priority_reset();
+
+	for (i = 0; i < 1000; i++)
+	{
+		ssids[i] = g_strdup_printf("net%u", i);
+		autoconnect_priority_index(ssids[i], NULL, i % 7);
+		networks[i].ssid = ssids[i];
+		networks[i].strength = 40 + i % 50;
+	}
+
+	/* Priority 6 and strength 89, the first of equals */
+	g_assert_cmpstr(autoconnect_priority_select(networks, 1000)->ssid, ==,
+	                "net349");
+
+	autoconnect_priority_reset();
+	g_strfreev(ssids);
+	g_free(networks);
+}
+
+static void test_set_order(void)
+{
+	profile_namespace_t *device = profile_namespace_get_device();
+	wifi_profile_t profiles[] =
+	{
+		{ 1, "home" },
+		{ 2, "office" },
+		{ 3, "guest" },
+	};
+	wifi_profile_t *order[] = { &profiles[2], &profiles[0], &profiles[1] };
+	wifi_profile_t *reorder[] = { &profiles[2], &profiles[1], &profiles[2] };
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(profiles); i++)
+	{
+		device->profiles = g_slist_append(device->profiles, &profiles[i]);
+	}
+
+	autoconnect_priority_set_order(order, 3);
+	g_assert_cmpint(profiles[2].priority, ==, 3);
+	g_assert_cmpint(profiles[0].priority, ==, 2);
+	g_assert_cmpint(profiles[1].priority, ==, 1);
+
+	/* home is dropped although it comes before the last listed profile */
+	autoconnect_priority_set_order(reorder, 3);
+	g_assert_cmpint(profiles[2].priority, ==, 3);
+	g_assert_cmpint(profiles[1].priority, ==, 2);
+	g_assert_cmpint(profiles[0].priority, ==, 0);
+
+	autoconnect_priority_set_order(NULL, 0);
+
+	for (i = 0; i < G_N_ELEMENTS(profiles); i++)
+	{
+		g_assert_cmpint(profiles[i].priority, ==, 0);
+	}
+
+	profile_namespace_reset();
+}
+
+static void test_index_profiles(void)
+{
+	profile_namespace_t *user = profile_namespace_ensure("user");
+	gchar *psk[] = { "psk", NULL };
+	wifi_profile_t home = { 1, "home", FALSE, psk, FALSE, { 0 }, 2 };
+	wifi_profile_t office = { 2, "office", FALSE, psk, FALSE, { 0 }, 1 };
+	autoconnect_network_t networks[] =
+	{
+		{ "office", "psk", 90 },
+		{ "home", "psk", 50 },
+	};
+
+	autoconnect_priority_reset();
+	profile_namespace_get_device()->profiles = g_slist_append(NULL, &office);
+	user->profiles = g_slist_append(NULL, &home);
+
+	/* Only the profiles of the active and the device namespace count */
+	g_assert(autoconnect_priority_index_profiles());
+	g_assert(&networks[0] == autoconnect_priority_select(networks, 2));
+
+	profile_namespace_set_active(user);
+	g_assert(autoconnect_priority_index_profiles());
+	g_assert(&networks[1] == autoconnect_priority_select(networks, 2));
+
+	/* Without an order there is nothing to act on */
+	home.priority = 0;
+	office.priority = 0;
+	g_assert(!autoconnect_priority_index_profiles());
+
+	autoconnect_priority_reset();
+	profile_namespace_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/autoconnect_priority/select", test_select);
+	g_test_add_func("/autoconnect_priority/hysteresis", test_hysteresis);
+	g_test_add_func("/autoconnect_priority/scale", test_scale);
+	g_test_add_func("/autoconnect_priority/set_order", test_set_order);
+	g_test_add_func("/autoconnect_priority/index_profiles", test_index_profiles);
+
+	return g_test_run();
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "band_steering.h"
+
+#define AP_24       "00:11:22:33:44:01"
+#define AP_5        "00:11:22:33:44:02"
+
+static void test_band(void)
+{
+	wifi_band_t band = WIFI_BAND_ANY;
+
+	g_assert_cmpint(wifi_band_from_frequency(2412), ==, WIFI_BAND_2_4GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(2484), ==, WIFI_BAND_2_4GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(5180), ==, WIFI_BAND_5GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(5885), ==, WIFI_BAND_5GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(5935), ==, WIFI_BAND_6GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(5955), ==, WIFI_BAND_6GHZ);
+	g_assert_cmpint(wifi_band_from_frequency(0), ==, WIFI_BAND_ANY);
+
+	g_assert(wifi_band_from_string("5GHz", &band));
+	g_assert_cmpint(band, ==, WIFI_BAND_5GHZ);
+	g_assert_cmpstr(wifi_band_to_string(WIFI_BAND_2_4GHZ), ==, "2.4GHz");
+	g_assert(wifi_band_from_string("any", &band));
+	g_assert_cmpint(band, ==, WIFI_BAND_ANY);
+	g_assert(!wifi_band_from_string("5G", &band));
+	g_assert(!wifi_band_from_string(NULL, &band));
+}
+
+static void test_prefer(void)
+{
+	band_preference_t pref = { WIFI_BAND_5GHZ };
+
+	g_assert(band_preference_is_set(&pref));
+	g_assert_cmpint(band_preference_score(&pref, AP_5, 5180, -60), ==,
+	                BAND_STEERING_SCORE_BAND);
+	g_assert_cmpint(band_preference_score(&pref, AP_24, 2437, -40), ==,
+	                BAND_STEERING_SCORE_OTHER);
+
+	/* Below the floor the preferred band is just another BSS */
+	g_assert_cmpint(band_preference_score(&pref, AP_5, 5180, -80), ==,
+	                BAND_STEERING_SCORE_OTHER);
+	pref.rssi_floor = -85;
+	g_assert_cmpint(band_preference_score(&pref, AP_5, 5180, -80), ==,
+	                BAND_STEERING_SCORE_BAND);
+
+	pref.band = WIFI_BAND_ANY;
+	g_assert(!band_preference_is_set(&pref));
+}
+
+static void test_require(void)
+{
+	band_preference_t pref = { WIFI_BAND_5GHZ, TRUE };
+
+	g_assert_cmpint(band_preference_score(&pref, AP_24, 2437, -30), ==,
+	                BAND_STEERING_SCORE_EXCLUDED);
+	g_assert_cmpint(band_preference_score(&pref, AP_5, 5180, -88), ==,
+	                BAND_STEERING_SCORE_BAND);
+}
+
+static void test_pin(void)
+{
+	band_preference_t pref = { WIFI_BAND_ANY, FALSE, AP_5 };
+
+	g_assert(band_preference_is_set(&pref));
+	g_assert_cmpint(band_preference_score(&pref, "00:11:22:33:44:02", 5180, -60),
+	                ==, BAND_STEERING_SCORE_PINNED);
+	g_assert_cmpint(band_preference_score(&pref, "00:11:22:33:44:03", 5200, -40),
+	                ==, BAND_STEERING_SCORE_OTHER);
+
+	/* A weak pinned BSS is given up */
+	g_assert_cmpint(band_preference_score(&pref, AP_5, 5180, -90), ==,
+	                BAND_STEERING_SCORE_OTHER);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/band_steering/band", test_band);
+	g_test_add_func("/band_steering/prefer", test_prefer);
+	g_test_add_func("/band_steering/require", test_require);
+	g_test_add_func("/band_steering/pin", test_pin);
+
+	return g_test_run();
+}
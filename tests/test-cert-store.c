@@ -0,0 +1,386 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <openssl/evp.h>
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include <openssl/x509.h>
+#include <openssl/x509v3.h>
+
+#include "cert_store.h"
+
+#define DAY             (24 * 60 * 60)
+
+typedef struct
+{
+	EVP_PKEY *key;
+	X509 *cert;
+} test_cert_t;
+
+static gchar *store_dir = NULL;
+static gint64 now;
+
+static EVP_PKEY *make_key(void)
+{
+	EVP_PKEY_CTX *ctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL);
+	EVP_PKEY *key = NULL;
+
+	g_assert(ctx != NULL);
+	g_assert(EVP_PKEY_keygen_init(ctx) == 1);
+	g_assert(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(ctx,
+	         NID_X9_62_prime256v1) == 1);
+	g_assert(EVP_PKEY_keygen(ctx, &key) == 1);
+
+	EVP_PKEY_CTX_free(ctx);
+	return key;
+}
+
+/**
+ * @brief Generate a certificate valid from now + start to now + end, signed
+ * by issuer, or self-signed if issuer is NULL
+ */
+
+static test_cert_t make_cert(const gchar *cn, const test_cert_t *issuer,
+                             glong start, glong end, gboolean is_ca)
+{
+	static long serial = 1;
+	test_cert_t cert = { make_key(), X509_new() };
+	X509_NAME *name = X509_get_subject_name(cert.cert);
+	X509V3_CTX v3;
+	X509_EXTENSION *ext;
+
+	X509_set_version(cert.cert, 2);
+	ASN1_INTEGER_set(X509_get_serialNumber(cert.cert), serial++);
+	X509_time_adj_ex(X509_getm_notBefore(cert.cert), 0, start, NULL);
+	X509_time_adj_ex(X509_getm_notAfter(cert.cert), 0, end, NULL);
+	X509_set_pubkey(cert.cert, cert.key);
+
+	X509_NAME_add_entry_by_txt(name, "O", MBSTRING_ASC,
+	                           (const guchar *) "webOS test", -1, -1, 0);
+	X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, (const guchar *) cn, -1,
+	                           -1, 0);
+	X509_set_issuer_name(cert.cert, X509_get_subject_name(NULL != issuer ?
+	                     issuer->cert : cert.cert));
+
+	X509V3_set_ctx(&v3, NULL != issuer ? issuer->cert : cert.cert, cert.cert, NULL,
+	               NULL, 0);
+	ext = X509V3_EXT_conf_nid(NULL, &v3, NID_basic_constraints,
+	                          is_ca ? "critical,CA:TRUE" : "CA:FALSE");
+	X509_add_ext(cert.cert, ext, -1);
+	X509_EXTENSION_free(ext);
+
+	g_assert(X509_sign(cert.cert, NULL != issuer ? issuer->key : cert.key,
+	                   EVP_sha256()) > 0);
+
+	return cert;
+}
+
+static void free_cert(test_cert_t *cert)
+{
+	X509_free(cert->cert);
+	EVP_PKEY_free(cert->key);
+}
+
+static gchar *to_pem(const test_cert_t *cert, gsize *len)
+{
+	BIO *bio = BIO_new(BIO_s_mem());
+	gchar *pem;
+	char *data;
+
+	g_assert(PEM_write_bio_X509(bio, cert->cert) == 1);
+	*len = BIO_get_mem_data(bio, &data);
+	pem = g_strndup(data, *len);
+	BIO_free(bio);
+
+	return pem;
+}
+
+static const cert_info_t *import(const gchar *name, const test_cert_t *cert)
+{
+	GError *error = NULL;
+	const cert_info_t *info;
+	gsize len;
+	gchar *pem = to_pem(cert, &len);
+
+	info = cert_store_import(name, (const guchar *) pem, len, &error);
+	g_assert_no_error(error);
+	g_assert(info != NULL);
+	g_free(pem);
+
+	return info;
+}
+
+/* Write a certificate outside of the store, as a profile could refer to */
+static gchar *write_cert(const gchar *file, const test_cert_t *cert)
+{
+	gchar *path = g_build_filename(store_dir, file, NULL);
+	gsize len;
+	gchar *pem = to_pem(cert, &len);
+
+	g_assert(g_file_set_contents(path, pem, len, NULL));
+	g_free(pem);
+
+	return path;
+}
+
+static void setup(void)
+{
+	store_dir = g_dir_make_tmp("test-cert-store-XXXXXX", NULL);
+	g_assert(store_dir != NULL);
+	g_assert(cert_store_init(store_dir));
+	now = g_get_real_time() / G_USEC_PER_SEC;
+}
+
+static void teardown(void)
+{
+	GDir *dir = g_dir_open(store_dir, 0, NULL);
+	const gchar *file;
+
+	while (NULL != (file = g_dir_read_name(dir)))
+	{
+		gchar *path = g_build_filename(store_dir, file, NULL);
+
+		g_unlink(path);
+		g_free(path);
+	}
+
+	g_dir_close(dir);
+	g_rmdir(store_dir);
+	g_free(store_dir);
+	store_dir = NULL;
+	cert_store_cleanup();
+}
+
+static void assert_invalid(const gchar *ca_path, const gchar *client_path,
+                           gint64 at, gint code)
+{
+	GError *error = NULL;
+
+	g_assert(!cert_store_validate(ca_path, client_path, at, &error));
+	g_assert_error(error, CERT_STORE_ERROR, code);
+	g_error_free(error);
+}
+
+static void test_import(void)
+{
+	test_cert_t ca = make_cert("Test CA", NULL, 0, 365 * DAY, TRUE);
+	test_cert_t client = make_cert("client@example.com", &ca, 0, 30 * DAY, FALSE);
+	const cert_info_t *info;
+	GError *error = NULL;
+	GList *all;
+	guchar *der = NULL;
+	int der_len;
+
+	setup();
+
+	info = import("corp-ca", &ca);
+	g_assert_cmpstr(info->name, ==, "corp-ca");
+	g_assert_cmpstr(info->subject, ==, "CN=Test CA,O=webOS test");
+	g_assert_cmpstr(info->issuer, ==, info->subject);
+	g_assert(info->is_ca);
+	g_assert(info->count == 1);
+	g_assert(strlen(info->fingerprint) == 32 * 3 - 1);
+	g_assert(info->not_before <= now && info->not_before > now - 60);
+	g_assert(info->not_after - info->not_before == 365 * DAY);
+	g_assert(g_str_has_prefix(info->path, store_dir));
+
+	/* Parsed once, then served from the cache */
+	g_assert(cert_store_lookup("corp-ca") == info);
+	g_assert(cert_store_lookup_path(info->path, NULL) == info);
+
+	/* DER is stored as PEM */
+	der_len = i2d_X509(client.cert, &der);
+	info = cert_store_import("client", der, der_len, &error);
+	g_assert_no_error(error);
+	g_assert(!info->is_ca);
+	g_assert_cmpstr(info->issuer, ==, "CN=Test CA,O=webOS test");
+	OPENSSL_free(der);
+
+	/* Imported certificates survive a restart */
+	g_assert(cert_store_init(store_dir));
+	all = cert_store_get_all();
+	g_assert(g_list_length(all) == 2);
+	g_assert_cmpstr(((const cert_info_t *) all->data)->name, ==, "client");
+	g_assert_cmpstr(((const cert_info_t *) all->next->data)->name, ==, "corp-ca");
+	g_list_free(all);
+
+	g_assert(cert_store_remove("client", &error));
+	g_assert_no_error(error);
+	g_assert(cert_store_lookup("client") == NULL);
+	g_assert(!cert_store_remove("client", &error));
+	g_assert_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_NOT_FOUND);
+	g_clear_error(&error);
+
+	g_assert(cert_store_import("../evil", (const guchar *) "x", 1, &error) == NULL);
+	g_assert_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_INVALID_NAME);
+	g_clear_error(&error);
+
+	g_assert(cert_store_import("garbage", (const guchar *) "not a certificate",
+	                           17, &error) == NULL);
+	g_assert_error(error, CERT_STORE_ERROR, CERT_STORE_ERROR_PARSE);
+	g_clear_error(&error);
+	g_assert(cert_store_lookup("garbage") == NULL);
+
+	teardown();
+	free_cert(&client);
+	free_cert(&ca);
+}
+
+/**
+ * @brief A certificate file is parsed again once it changes.
+ */
+
+static void test_cache(void)
+{
+	test_cert_t first = make_cert("First", NULL, 0, DAY, TRUE);
+	test_cert_t second = make_cert("Second certificate", NULL, 0, DAY, TRUE);
+	const cert_info_t *info;
+	gchar *path;
+	gchar *fingerprint;
+
+	setup();
+
+	path = write_cert("profile-ca.crt", &first);
+	info = cert_store_lookup_path(path, NULL);
+	g_assert(info != NULL && info->name == NULL);
+	fingerprint = g_strdup(info->fingerprint);
+	g_assert(cert_store_lookup_path(path, NULL) == info);
+
+	g_free(write_cert("profile-ca.crt", &second));
+	info = cert_store_lookup_path(path, NULL);
+	g_assert_cmpstr(info->subject, ==, "CN=Second certificate,O=webOS test");
+	g_assert_cmpstr(info->fingerprint, !=, fingerprint);
+
+	/* Files which aren't in the store aren't listed */
+	g_assert(cert_store_get_all() == NULL);
+
+	g_unlink(path);
+	g_assert(cert_store_lookup_path(path, NULL) == NULL);
+
+	g_free(fingerprint);
+	g_free(path);
+	teardown();
+	free_cert(&second);
+	free_cert(&first);
+}
+
+/**
+ * @brief Certificates of a profile are checked before connecting.
+ */
+
+static void test_validate(void)
+{
+	test_cert_t ca = make_cert("Test CA", NULL, -DAY, 365 * DAY, TRUE);
+	test_cert_t other_ca = make_cert("Other CA", NULL, -DAY, 365 * DAY, TRUE);
+	test_cert_t client = make_cert("client", &ca, -DAY, 30 * DAY, FALSE);
+	test_cert_t expired = make_cert("expired", &ca, -30 * DAY, -DAY, FALSE);
+	test_cert_t future = make_cert("future", &ca, DAY, 30 * DAY, FALSE);
+	test_cert_t foreign = make_cert("foreign", &other_ca, -DAY, 30 * DAY, FALSE);
+	test_cert_t old_ca = make_cert("Old CA", NULL, -365 * DAY, -DAY, TRUE);
+	gchar *ca_path, *client_path, *missing;
+	GError *error = NULL;
+
+	setup();
+
+	ca_path = g_strdup(import("ca", &ca)->path);
+	client_path = g_strdup(import("client", &client)->path);
+	missing = g_build_filename(store_dir, "missing.pem", NULL);
+
+	g_assert(cert_store_validate(ca_path, client_path, now, &error));
+	g_assert_no_error(error);
+	g_assert(cert_store_validate(ca_path, NULL, now, NULL));
+	g_assert(cert_store_validate(NULL, client_path, now, NULL));
+	g_assert(cert_store_validate(NULL, NULL, now, NULL));
+	g_assert(cert_store_validate("", "", now, NULL));
+
+	/* The same certificates, checked two months later */
+	assert_invalid(ca_path, client_path, now + 60 * DAY, CERT_STORE_ERROR_EXPIRED);
+
+	assert_invalid(missing, client_path, now, CERT_STORE_ERROR_NOT_FOUND);
+	assert_invalid(ca_path, missing, now, CERT_STORE_ERROR_NOT_FOUND);
+	assert_invalid(ca_path, import("expired", &expired)->path, now,
+	               CERT_STORE_ERROR_EXPIRED);
+	assert_invalid(ca_path, import("future", &future)->path, now,
+	               CERT_STORE_ERROR_NOT_YET_VALID);
+	assert_invalid(ca_path, import("foreign", &foreign)->path, now,
+	               CERT_STORE_ERROR_UNTRUSTED);
+	assert_invalid(import("old-ca", &old_ca)->path, NULL, now,
+	               CERT_STORE_ERROR_EXPIRED);
+
+	g_free(missing);
+	g_free(client_path);
+	g_free(ca_path);
+	teardown();
+	free_cert(&old_ca);
+	free_cert(&foreign);
+	free_cert(&future);
+	free_cert(&expired);
+	free_cert(&client);
+	free_cert(&other_ca);
+	free_cert(&ca);
+}
+
+/**
+ * @brief Certificates expiring soon are reported ahead of time.
+ */
+
+static void test_expiring(void)
+{
+	test_cert_t ca = make_cert("Test CA", NULL, -DAY, 365 * DAY, TRUE);
+	test_cert_t soon = make_cert("soon", &ca, -DAY, 10 * DAY, FALSE);
+	test_cert_t expired = make_cert("expired", &ca, -30 * DAY, -DAY, FALSE);
+	GList *expiring;
+
+	setup();
+
+	import("ca", &ca);
+	import("soon", &soon);
+	import("expired", &expired);
+
+	expiring = cert_store_get_expiring(now, 30 * DAY);
+	g_assert(g_list_length(expiring) == 2);
+	g_assert_cmpstr(((const cert_info_t *) expiring->data)->name, ==, "expired");
+	g_assert_cmpstr(((const cert_info_t *) expiring->next->data)->name, ==, "soon");
+	g_list_free(expiring);
+
+	expiring = cert_store_get_expiring(now, 0);
+	g_assert(g_list_length(expiring) == 1);
+	g_list_free(expiring);
+
+	expiring = cert_store_get_expiring(now, 400 * DAY);
+	g_assert(g_list_length(expiring) == 3);
+	g_list_free(expiring);
+
+	teardown();
+	free_cert(&expired);
+	free_cert(&soon);
+	free_cert(&ca);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/cert_store/import", test_import);
+	g_test_add_func("/cert_store/cache", test_cache);
+	g_test_add_func("/cert_store/validate", test_validate);
+	g_test_add_func("/cert_store/expiring", test_expiring);
+
+	return g_test_run();
+}
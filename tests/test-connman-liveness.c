@@ -0,0 +1,359 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gio/gio.h>
+
+#include "connman_liveness.h"
+#include "runtime_params.h"
+
+typedef enum
+{
+	FAKE_HEALTHY,
+	FAKE_STALLED,    /* Never answers */
+	FAKE_DIVERGED,   /* Answers with services the model doesn't know */
+	FAKE_LATE,       /* Answers only when told to */
+} fake_mode_t;
+
+/**
+ * A fake connman answering right away, unless it is stalled
+ */
+typedef struct fake_connman
+{
+	fake_mode_t mode;
+	guint probes;
+	guint samples;
+	guint recoveries;
+	connman_liveness_level_t last_level;
+	GCancellable *pending;
+	gboolean restart_on_reattach;
+} fake_connman_t;
+
+static void fake_probe(connman_liveness_t *liveness, GCancellable *cancellable,
+                       gpointer user_data)
+{
+	fake_connman_t *fake = user_data;
+
+	fake->probes++;
+
+	switch (fake->mode)
+	{
+		case FAKE_STALLED:
+			break;
+
+		case FAKE_LATE:
+			fake->pending = g_object_ref(cancellable);
+			break;
+
+		default:
+			connman_liveness_probe_done(liveness, cancellable, TRUE);
+			break;
+	}
+}
+
+static void fake_sample(connman_liveness_t *liveness, GCancellable *cancellable,
+                        gpointer user_data)
+{
+	fake_connman_t *fake = user_data;
+	guint64 model_hash = connman_liveness_hash_add(0, "/net/connman/service/wifi_1");
+	guint64 connman_hash = model_hash;
+
+	fake->samples++;
+
+	switch (fake->mode)
+	{
+		case FAKE_STALLED:
+			break;
+
+		case FAKE_LATE:
+			fake->pending = g_object_ref(cancellable);
+			break;
+
+		case FAKE_DIVERGED:
+			connman_hash = connman_liveness_hash_add(connman_hash,
+			               "/net/connman/service/wifi_2");
+
+		/* fall through */
+		default:
+			connman_liveness_sample_done(liveness, cancellable, TRUE, connman_hash,
+			                             model_hash);
+			break;
+	}
+}
+
+static void fake_recover(connman_liveness_t *liveness,
+                         connman_liveness_level_t level, gpointer user_data)
+{
+	fake_connman_t *fake = user_data;
+
+	fake->recoveries++;
+	fake->last_level = level;
+
+	if (fake->restart_on_reattach && level == CONNMAN_LIVENESS_LEVEL_REATTACH)
+	{
+		connman_liveness_stop(liveness);
+		connman_liveness_start(liveness);
+	}
+}
+
+static const connman_liveness_ops_t fake_ops =
+{
+	.probe = fake_probe,
+	.sample = fake_sample,
+	.recover = fake_recover,
+};
+
+static gboolean timeout_cb(gpointer user_data)
+{
+	*(gboolean *) user_data = TRUE;
+	return FALSE;
+}
+
+/**
+ * @brief Iterate the main loop until the fake saw the given number of
+ * recoveries or a second has passed.
+ */
+
+static void wait_for_recoveries(fake_connman_t *fake, guint recoveries)
+{
+	gboolean timed_out = FALSE;
+	guint timeout = g_timeout_add(1000, timeout_cb, &timed_out);
+
+	while (fake->recoveries < recoveries && !timed_out)
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+
+	g_assert(!timed_out);
+	g_source_remove(timeout);
+}
+
+static void setup(void)
+{
+	runtime_params_reset();
+	g_assert(runtime_param_set(RUNTIME_PARAM_CONNMAN_PROBE_INTERVAL, 50, "test"));
+	g_assert(runtime_param_set(RUNTIME_PARAM_CONNMAN_PROBE_DEADLINE, 10, "test"));
+}
+
+static void test_hash(void)
+{
+	guint64 a = 0, b = 0;
+
+	a = connman_liveness_hash_add(a, "/net/connman/service/wifi_1");
+	a = connman_liveness_hash_add(a, "/net/connman/service/wifi_2");
+	b = connman_liveness_hash_add(b, "/net/connman/service/wifi_2");
+	b = connman_liveness_hash_add(b, "/net/connman/service/wifi_1");
+
+	g_assert(a == b);
+	g_assert(a != connman_liveness_hash_add(0, "/net/connman/service/wifi_1"));
+	g_assert(a != 0);
+}
+
+/**
+ * @brief A healthy connman is probed cheaply and sampled every now and then.
+ */
+
+static void test_healthy(void)
+{
+	fake_connman_t fake = { .mode = FAKE_HEALTHY };
+	connman_liveness_t *liveness = connman_liveness_new(&fake_ops, &fake);
+	guint n;
+
+	setup();
+
+	for (n = 0; n < 2 * CONNMAN_LIVENESS_SAMPLE_EVERY; n++)
+	{
+		connman_liveness_check_now(liveness);
+	}
+
+	g_assert(fake.samples == 2);
+	g_assert(fake.probes == 2 * CONNMAN_LIVENESS_SAMPLE_EVERY - 2);
+	g_assert(fake.recoveries == 0);
+	g_assert(connman_liveness_get_stats(liveness)->checks ==
+	         2 * CONNMAN_LIVENESS_SAMPLE_EVERY);
+	g_assert(connman_liveness_get_level(liveness) == CONNMAN_LIVENESS_LEVEL_NONE);
+
+	connman_liveness_free(liveness);
+}
+
+/**
+ * @brief Each missed deadline escalates the recovery by one level until a
+ * reattach, after which it starts over with a resync. A healthy check starts
+ * over too.
+ */
+
+static void test_escalation(void)
+{
+	static const connman_liveness_level_t expected[] =
+	{
+		CONNMAN_LIVENESS_LEVEL_RESYNC,
+		CONNMAN_LIVENESS_LEVEL_AGENT,
+		CONNMAN_LIVENESS_LEVEL_REATTACH,
+		CONNMAN_LIVENESS_LEVEL_RESYNC,
+	};
+	fake_connman_t fake = { .mode = FAKE_STALLED };
+	connman_liveness_t *liveness = connman_liveness_new(&fake_ops, &fake);
+	const connman_liveness_stats_t *stats = connman_liveness_get_stats(liveness);
+	guint n;
+
+	setup();
+
+	for (n = 0; n < G_N_ELEMENTS(expected); n++)
+	{
+		connman_liveness_check_now(liveness);
+
+		/* Only one check runs at a time */
+		connman_liveness_check_now(liveness);
+
+		wait_for_recoveries(&fake, n + 1);
+		g_assert(fake.last_level == expected[n]);
+		g_assert(connman_liveness_get_level(liveness) == expected[n]);
+	}
+
+	g_assert(stats->checks == G_N_ELEMENTS(expected));
+	g_assert(stats->stalls == G_N_ELEMENTS(expected));
+	g_assert(stats->recoveries[CONNMAN_LIVENESS_LEVEL_RESYNC] == 2);
+	g_assert(stats->recoveries[CONNMAN_LIVENESS_LEVEL_AGENT] == 1);
+	g_assert(stats->recoveries[CONNMAN_LIVENESS_LEVEL_REATTACH] == 1);
+
+	fake.mode = FAKE_HEALTHY;
+	connman_liveness_check_now(liveness);
+	g_assert(connman_liveness_get_level(liveness) == CONNMAN_LIVENESS_LEVEL_NONE);
+
+	fake.mode = FAKE_STALLED;
+	connman_liveness_check_now(liveness);
+	wait_for_recoveries(&fake, G_N_ELEMENTS(expected) + 1);
+	g_assert(fake.last_level == CONNMAN_LIVENESS_LEVEL_RESYNC);
+
+	connman_liveness_free(liveness);
+}
+
+/**
+ * @brief A divergence only counts if the next sample confirms it.
+ */
+
+static void test_divergence(void)
+{
+	fake_connman_t fake = { .mode = FAKE_HEALTHY };
+	connman_liveness_t *liveness = connman_liveness_new(&fake_ops, &fake);
+	guint n;
+
+	setup();
+
+	for (n = 0; n < CONNMAN_LIVENESS_SAMPLE_EVERY - 1; n++)
+	{
+		connman_liveness_check_now(liveness);
+	}
+
+	/* Transient, e.g. a signal was still on its way */
+	fake.mode = FAKE_DIVERGED;
+	connman_liveness_check_now(liveness);
+	g_assert(fake.samples == 1);
+	g_assert(fake.recoveries == 0);
+
+	fake.mode = FAKE_HEALTHY;
+	connman_liveness_check_now(liveness);
+	g_assert(fake.samples == 2);
+	g_assert(fake.recoveries == 0);
+
+	/* Persistent */
+	for (n = 0; n < CONNMAN_LIVENESS_SAMPLE_EVERY - 1; n++)
+	{
+		connman_liveness_check_now(liveness);
+	}
+
+	fake.mode = FAKE_DIVERGED;
+	connman_liveness_check_now(liveness);
+	connman_liveness_check_now(liveness);
+	g_assert(fake.recoveries == 1);
+	g_assert(fake.last_level == CONNMAN_LIVENESS_LEVEL_RESYNC);
+	g_assert(connman_liveness_get_stats(liveness)->divergences == 1);
+
+	connman_liveness_free(liveness);
+}
+
+/**
+ * @brief Answers arriving after the deadline are ignored.
+ */
+
+static void test_late_answer(void)
+{
+	fake_connman_t fake = { .mode = FAKE_LATE };
+	connman_liveness_t *liveness = connman_liveness_new(&fake_ops, &fake);
+	GCancellable *late;
+
+	setup();
+
+	connman_liveness_check_now(liveness);
+	late = fake.pending;
+	fake.pending = NULL;
+
+	wait_for_recoveries(&fake, 1);
+	g_assert(g_cancellable_is_cancelled(late));
+
+	connman_liveness_probe_done(liveness, late, TRUE);
+	g_assert(connman_liveness_get_level(liveness) == CONNMAN_LIVENESS_LEVEL_RESYNC);
+	g_object_unref(late);
+
+	/* An answer in time is taken */
+	connman_liveness_check_now(liveness);
+	connman_liveness_probe_done(liveness, fake.pending, TRUE);
+	g_assert(connman_liveness_get_level(liveness) == CONNMAN_LIVENESS_LEVEL_NONE);
+	g_clear_object(&fake.pending);
+
+	connman_liveness_free(liveness);
+}
+
+/**
+ * @brief A started prober checks periodically and keeps going, at twice the
+ * interval, after a reattach restarted it.
+ */
+
+static void test_periodic(void)
+{
+	fake_connman_t fake = { .mode = FAKE_STALLED, .restart_on_reattach = TRUE };
+	connman_liveness_t *liveness = connman_liveness_new(&fake_ops, &fake);
+	gint64 reattached;
+
+	setup();
+
+	connman_liveness_start(liveness);
+	wait_for_recoveries(&fake, 3);
+	g_assert(fake.last_level == CONNMAN_LIVENESS_LEVEL_REATTACH);
+	reattached = g_get_monotonic_time();
+
+	wait_for_recoveries(&fake, 4);
+	g_assert(fake.last_level == CONNMAN_LIVENESS_LEVEL_RESYNC);
+	g_assert(g_get_monotonic_time() - reattached >= 100 * 1000);
+
+	connman_liveness_stop(liveness);
+	g_assert(connman_liveness_get_stats(liveness)->checks == 4);
+
+	connman_liveness_free(liveness);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/connman_liveness/hash", test_hash);
+	g_test_add_func("/connman_liveness/healthy", test_healthy);
+	g_test_add_func("/connman_liveness/escalation", test_escalation);
+	g_test_add_func("/connman_liveness/divergence", test_divergence);
+	g_test_add_func("/connman_liveness/late_answer", test_late_answer);
+	g_test_add_func("/connman_liveness/periodic", test_periodic);
+
+	return g_test_run();
+}
@@ -0,0 +1,348 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gio/gio.h>
+#include <sys/socket.h>
+
+#include "dbus_call.h"
+
+/* Slower than any read deadline, but short enough to not hold up the tests */
+#define SLOW_DELAY_MS   3000
+
+static const gchar introspection_xml[] =
+    "<node>"
+    "  <interface name='net.connman.Manager'>"
+    "    <method name='GetProperties'>"
+    "      <arg type='a{sv}' name='properties' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
+/**
+ * A fake connman answering GetProperties after a delay. It runs in a thread
+ * of its own, as synchronous calls block the thread they are made in.
+ */
+typedef struct fake_connman
+{
+	GMainContext *context;
+	GMainLoop *loop;
+	GThread *thread;
+	GSocketConnection *stream;
+	GDBusConnection *connection;
+	GDBusNodeInfo *node;
+	gint delay; /* ms, accessed atomically */
+
+	/* Client side */
+	GDBusConnection *client;
+	GDBusProxy *proxy;
+} fake_connman_t;
+
+static gboolean reply_cb(gpointer user_data)
+{
+	GDBusMethodInvocation *invocation = user_data;
+
+	g_dbus_method_invocation_return_value(invocation,
+	                                      g_variant_new("(@a{sv})", g_variant_new_array(G_VARIANT_TYPE("{sv}"),
+	                                              NULL, 0)));
+	return FALSE;
+}
+
+static void method_call_cb(GDBusConnection *connection, const gchar *sender,
+                           const gchar *object_path, const gchar *interface_name,
+                           const gchar *method_name, GVariant *parameters,
+                           GDBusMethodInvocation *invocation, gpointer user_data)
+{
+	fake_connman_t *fake = user_data;
+	gint delay = g_atomic_int_get(&fake->delay);
+	GSource *source;
+
+	if (0 == delay)
+	{
+		reply_cb(invocation);
+		return;
+	}
+
+	source = g_timeout_source_new(delay);
+	g_source_set_callback(source, reply_cb, invocation, NULL);
+	g_source_attach(source, fake->context);
+	g_source_unref(source);
+}
+
+static const GDBusInterfaceVTable vtable =
+{
+	method_call_cb,
+	NULL,
+	NULL,
+};
+
+static gpointer fake_connman_thread(gpointer user_data)
+{
+	fake_connman_t *fake = user_data;
+	gchar *guid = g_dbus_generate_guid();
+
+	g_main_context_push_thread_default(fake->context);
+
+	fake->connection = g_dbus_connection_new_sync(G_IO_STREAM(fake->stream), guid,
+	                   G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_SERVER, NULL, NULL, NULL);
+	g_assert(fake->connection != NULL);
+
+	g_dbus_connection_register_object(fake->connection, "/",
+	                                  fake->node->interfaces[0], &vtable, fake, NULL, NULL);
+
+	g_main_loop_run(fake->loop);
+
+	g_dbus_connection_close_sync(fake->connection, NULL, NULL);
+	g_object_unref(fake->connection);
+	g_main_context_pop_thread_default(fake->context);
+	g_free(guid);
+
+	return NULL;
+}
+
+static GSocketConnection *stream_new(int fd)
+{
+	GSocket *socket = g_socket_new_from_fd(fd, NULL);
+	GSocketConnection *stream;
+
+	g_assert(socket != NULL);
+	stream = g_socket_connection_factory_create_connection(socket);
+	g_object_unref(socket);
+
+	return stream;
+}
+
+static fake_connman_t *fake_connman_new(gint delay)
+{
+	fake_connman_t *fake = g_new0(fake_connman_t, 1);
+	GSocketConnection *client_stream;
+	int fds[2];
+
+	g_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+
+	fake->delay = delay;
+	fake->node = g_dbus_node_info_new_for_xml(introspection_xml, NULL);
+	fake->context = g_main_context_new();
+	fake->loop = g_main_loop_new(fake->context, FALSE);
+	fake->stream = stream_new(fds[0]);
+	fake->thread = g_thread_new("fake-connman", fake_connman_thread, fake);
+
+	client_stream = stream_new(fds[1]);
+	fake->client = g_dbus_connection_new_sync(G_IO_STREAM(client_stream), NULL,
+	               G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT, NULL, NULL, NULL);
+	g_assert(fake->client != NULL);
+	g_object_unref(client_stream);
+
+	fake->proxy = g_dbus_proxy_new_sync(fake->client,
+	                                    G_DBUS_PROXY_FLAGS_DO_NOT_LOAD_PROPERTIES |
+	                                    G_DBUS_PROXY_FLAGS_DO_NOT_CONNECT_SIGNALS,
+	                                    NULL, NULL, "/", "net.connman.Manager", NULL, NULL);
+	g_assert(fake->proxy != NULL);
+
+	dbus_call_reset_stats();
+
+	return fake;
+}
+
+static gboolean quit_cb(gpointer user_data)
+{
+	g_main_loop_quit(user_data);
+	return FALSE;
+}
+
+static void fake_connman_free(fake_connman_t *fake)
+{
+	g_object_unref(fake->proxy);
+	g_dbus_connection_close_sync(fake->client, NULL, NULL);
+	g_object_unref(fake->client);
+
+	g_main_context_invoke(fake->context, quit_cb, fake->loop);
+	g_thread_join(fake->thread);
+
+	g_main_loop_unref(fake->loop);
+	g_main_context_unref(fake->context);
+	g_object_unref(fake->stream);
+	g_dbus_node_info_unref(fake->node);
+	g_free(fake);
+}
+
+/**
+ * @brief Make a synchronous GetProperties call the way the adapter does
+ */
+
+static gboolean get_properties(fake_connman_t *fake, GError **error)
+{
+	GVariant *ret;
+	gboolean timed_out;
+
+	dbus_call_begin(fake->proxy, DBUS_CALL_PROPERTY_READ);
+	ret = g_dbus_proxy_call_sync(fake->proxy, "GetProperties", NULL,
+	                             G_DBUS_CALL_FLAGS_NONE, -1, NULL, error);
+	timed_out = dbus_call_end(DBUS_CALL_PROPERTY_READ, *error);
+
+	if (NULL != ret)
+	{
+		g_variant_unref(ret);
+	}
+
+	return timed_out;
+}
+
+static guint num_timeouts = 0;
+
+static void timed_out(dbus_call_t call, const dbus_call_stats_t *stats,
+                      gpointer user_data)
+{
+	g_assert(call == DBUS_CALL_PROPERTY_READ);
+	num_timeouts++;
+}
+
+static void test_deadlines(void)
+{
+	dbus_call_t call;
+
+	for (call = 0; call < DBUS_CALL_LAST; call++)
+	{
+		g_assert(dbus_call_get_name(call) != NULL);
+		g_assert(dbus_call_get_deadline(call) > 0);
+
+		/* Everything must be bounded more tightly than the D-Bus default */
+		g_assert(dbus_call_get_deadline(call) <= 25000);
+	}
+
+	g_assert(dbus_call_get_deadline(DBUS_CALL_PROPERTY_READ) == 500);
+	g_assert(dbus_call_get_deadline(DBUS_CALL_PROPERTY_READ) <
+	         dbus_call_get_deadline(DBUS_CALL_CONNECT));
+}
+
+static void test_fast(void)
+{
+	fake_connman_t *fake = fake_connman_new(0);
+	GError *error = NULL;
+
+	g_assert(!get_properties(fake, &error));
+	g_assert(error == NULL);
+	g_assert(dbus_call_get_stats(DBUS_CALL_PROPERTY_READ)->calls == 1);
+	g_assert(dbus_call_get_stats(DBUS_CALL_PROPERTY_READ)->timeouts == 0);
+
+	fake_connman_free(fake);
+}
+
+/**
+ * @brief A slow connman blocks a synchronous call no longer than the deadline.
+ */
+
+static void test_slow(void)
+{
+	fake_connman_t *fake = fake_connman_new(SLOW_DELAY_MS);
+	GError *error = NULL;
+	gint64 start = g_get_monotonic_time();
+
+	num_timeouts = 0;
+	dbus_call_set_timeout_callback(timed_out, NULL);
+
+	g_assert(get_properties(fake, &error));
+	g_assert(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT));
+	g_clear_error(&error);
+
+	g_assert(g_get_monotonic_time() - start < SLOW_DELAY_MS * 1000 / 2);
+	g_assert(dbus_call_get_stats(DBUS_CALL_PROPERTY_READ)->timeouts == 1);
+	g_assert(num_timeouts == 1);
+
+	/* Once connman is fast again the call succeeds */
+	g_atomic_int_set(&fake->delay, 0);
+	g_assert(!get_properties(fake, &error));
+	g_assert(error == NULL);
+	g_assert(dbus_call_get_stats(DBUS_CALL_PROPERTY_READ)->calls == 2);
+	g_assert(dbus_call_get_stats(DBUS_CALL_PROPERTY_READ)->timeouts == 1);
+
+	dbus_call_set_timeout_callback(NULL, NULL);
+	fake_connman_free(fake);
+}
+
+static void call_done_cb(GObject *source_object, GAsyncResult *res,
+                         gpointer user_data)
+{
+	GError **error = user_data;
+	GVariant *ret = g_dbus_proxy_call_finish(G_DBUS_PROXY(source_object), res,
+	                error);
+
+	if (NULL != ret)
+	{
+		g_variant_unref(ret);
+	}
+
+	dbus_call_end(DBUS_CALL_CONNECT, *error);
+	g_assert(*error != NULL);
+}
+
+/**
+ * @brief Cancelling a scope, e.g. when a luna caller went away, cancels the
+ * pending calls of that scope only.
+ */
+
+static void test_scope_cancel(void)
+{
+	fake_connman_t *fake = fake_connman_new(SLOW_DELAY_MS);
+	GCancellable *cancellable = g_cancellable_new();
+	GCancellable *other = g_cancellable_new();
+	GError *error = NULL;
+
+	dbus_call_scope_add("com.webos.app.1.42", cancellable);
+	dbus_call_scope_add("com.webos.app.2.7", other);
+
+	dbus_call_begin(fake->proxy, DBUS_CALL_CONNECT);
+	g_dbus_proxy_call(fake->proxy, "GetProperties", NULL, G_DBUS_CALL_FLAGS_NONE,
+	                  -1, cancellable, call_done_cb, &error);
+
+	dbus_call_scope_cancel("com.webos.app.1.42");
+	g_assert(g_cancellable_is_cancelled(cancellable));
+	g_assert(!g_cancellable_is_cancelled(other));
+
+	while (NULL == error)
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+
+	g_assert(g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED));
+	g_clear_error(&error);
+	g_assert(dbus_call_get_stats(DBUS_CALL_CONNECT)->cancelled == 1);
+	g_assert(dbus_call_get_stats(DBUS_CALL_CONNECT)->timeouts == 0);
+
+	/* The scope is gone once cancelled */
+	dbus_call_scope_remove("com.webos.app.1.42", cancellable);
+	dbus_call_scope_cancel("com.webos.app.1.42");
+
+	/* A removed cancellable is left alone */
+	dbus_call_scope_remove("com.webos.app.2.7", other);
+	dbus_call_scope_cancel("com.webos.app.2.7");
+	g_assert(!g_cancellable_is_cancelled(other));
+
+	g_object_unref(other);
+	g_object_unref(cancellable);
+	fake_connman_free(fake);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/dbus_call/deadlines", test_deadlines);
+	g_test_add_func("/dbus_call/fast", test_fast);
+	g_test_add_func("/dbus_call/slow", test_slow);
+	g_test_add_func("/dbus_call/scope_cancel", test_scope_cancel);
+
+	return g_test_run();
+}
@@ -0,0 +1,311 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <glib.h>
+
+#include "dns_probe.h"
+
+#define TIMEOUT_MS      300
+
+/* Stub nameserver answering every query after a delay, or never if the delay
+ * is negative */
+typedef struct responder
+{
+	int fd;
+	guint watch;
+	gint delay_ms;
+	guint8 answer[512];
+	gsize answer_len;
+	struct sockaddr_in client;
+} responder_t;
+
+typedef struct result
+{
+	GMainLoop *loop;
+	gint latencies[3];
+	guint calls;
+} result_t;
+
+static gboolean send_answer_cb(gpointer user_data)
+{
+	responder_t *responder = user_data;
+
+	sendto(responder->fd, responder->answer, responder->answer_len, 0,
+	       (struct sockaddr *) &responder->client, sizeof(responder->client));
+
+	return FALSE;
+}
+
+static gboolean query_cb(GIOChannel *channel, GIOCondition cond,
+                         gpointer user_data)
+{
+	responder_t *responder = user_data;
+	socklen_t addr_len = sizeof(responder->client);
+	ssize_t len;
+
+	len = recvfrom(responder->fd, responder->answer, sizeof(responder->answer), 0,
+	               (struct sockaddr *) &responder->client, &addr_len);
+
+	if (len < 12 || responder->delay_ms < 0)
+	{
+		return TRUE;
+	}
+
+	/* Echo the query back as an empty answer */
+	responder->answer[2] |= 0x80;
+	responder->answer_len = len;
+	g_timeout_add(responder->delay_ms, send_answer_cb, responder);
+
+	return TRUE;
+}
+
+static void responder_start(responder_t *responder, const gchar *address,
+                            guint16 *port, gint delay_ms)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	GIOChannel *channel;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(*port);
+	inet_pton(AF_INET, address, &addr.sin_addr);
+
+	responder->delay_ms = delay_ms;
+	responder->fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, 0);
+	g_assert(responder->fd >= 0);
+	g_assert(bind(responder->fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+
+	/* The first responder picks the port all of them listen on */
+	getsockname(responder->fd, (struct sockaddr *) &addr, &addr_len);
+	*port = ntohs(addr.sin_port);
+
+	channel = g_io_channel_unix_new(responder->fd);
+	responder->watch = g_io_add_watch(channel, G_IO_IN, query_cb, responder);
+	g_io_channel_unref(channel);
+}
+
+static void responder_stop(responder_t *responder)
+{
+	g_source_remove(responder->watch);
+	close(responder->fd);
+}
+
+static void probe_done(GStrv servers, const gint *latencies,
+                       gpointer user_data)
+{
+	result_t *result = user_data;
+
+	g_assert_cmpuint(g_strv_length(servers), ==, 3);
+	memcpy(result->latencies, latencies, sizeof(result->latencies));
+	result->calls++;
+	g_main_loop_quit(result->loop);
+}
+
+static void test_query(void)
+{
+	guint8 buf[DNS_PROBE_QUERY_LEN];
+	const guint8 expected[DNS_PROBE_QUERY_LEN] =
+	{
+		0x12, 0x34, 0x01, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x02, 0x00, 0x01
+	};
+
+	g_assert_cmpuint(dns_probe_build_query(buf, 0x1234), ==, DNS_PROBE_QUERY_LEN);
+	g_assert(memcmp(buf, expected, DNS_PROBE_QUERY_LEN) == 0);
+
+	/* The query itself isn't an answer */
+	g_assert(!dns_probe_is_answer(buf, sizeof(buf), 0x1234));
+
+	buf[2] |= 0x80;
+	g_assert(dns_probe_is_answer(buf, sizeof(buf), 0x1234));
+	g_assert(!dns_probe_is_answer(buf, sizeof(buf), 0x1235));
+	g_assert(!dns_probe_is_answer(buf, 11, 0x1234));
+
+	/* NXDOMAIN is an answer, SERVFAIL and REFUSED are not */
+	buf[3] = 3;
+	g_assert(dns_probe_is_answer(buf, sizeof(buf), 0x1234));
+	buf[3] = 2;
+	g_assert(!dns_probe_is_answer(buf, sizeof(buf), 0x1234));
+	buf[3] = 5;
+	g_assert(!dns_probe_is_answer(buf, sizeof(buf), 0x1234));
+}
+
+static void test_ewma(void)
+{
+	dns_server_health_t health = { 0 };
+
+	health.latency = -1;
+
+	dns_probe_health_add_sample(&health, 100);
+	g_assert_cmpfloat(health.latency, ==, 100);
+	g_assert_cmpfloat(health.failure_rate, ==, 0);
+
+	dns_probe_health_add_sample(&health, 200);
+	g_assert_cmpfloat(health.latency, ==, 100 + DNS_PROBE_EWMA_WEIGHT * 100);
+
+	/* A lost query only moves the failure rate */
+	dns_probe_health_add_sample(&health, -1);
+	g_assert_cmpfloat(health.latency, ==, 100 + DNS_PROBE_EWMA_WEIGHT * 100);
+	g_assert_cmpfloat(health.failure_rate, ==, DNS_PROBE_EWMA_WEIGHT);
+	g_assert_cmpuint(health.probes, ==, 3);
+	g_assert_cmpuint(health.failures, ==, 1);
+
+	/* A server which always fails scores the timeout */
+	dns_server_health_t dead = { 0 };
+	dead.latency = -1;
+	dns_probe_health_add_sample(&dead, -1);
+	g_assert_cmpfloat(dns_probe_health_score(&dead, TIMEOUT_MS), ==, TIMEOUT_MS);
+}
+
+static void test_sync(void)
+{
+	gchar *first[] = { "10.0.0.1", "10.0.0.2", NULL };
+	gchar *second[] = { "10.0.0.3", "10.0.0.2", "10.0.0.2", NULL };
+	GList *health = NULL;
+	dns_server_health_t *server;
+
+	health = dns_probe_health_sync(health, first);
+	g_assert_cmpuint(g_list_length(health), ==, 2);
+
+	server = dns_probe_health_find(health, "10.0.0.2");
+	dns_probe_health_add_sample(server, 20);
+
+	/* Known servers keep their averages, gone ones are dropped */
+	health = dns_probe_health_sync(health, second);
+	g_assert_cmpuint(g_list_length(health), ==, 2);
+	g_assert_cmpstr(((dns_server_health_t *) health->data)->address, ==,
+	                "10.0.0.3");
+	g_assert(dns_probe_health_find(health, "10.0.0.2") == server);
+	g_assert_cmpuint(server->probes, ==, 1);
+	g_assert(NULL == dns_probe_health_find(health, "10.0.0.1"));
+
+	dns_probe_health_free(health);
+}
+
+static void test_reorder(void)
+{
+	gchar *servers[] = { "10.0.0.1", "10.0.0.2", "10.0.0.3", NULL };
+	GList *health = dns_probe_health_sync(NULL, servers);
+	dns_server_health_t *slow = dns_probe_health_find(health, "10.0.0.1");
+	dns_server_health_t *fast = dns_probe_health_find(health, "10.0.0.2");
+	dns_server_health_t *dead = dns_probe_health_find(health, "10.0.0.3");
+	GStrv order = NULL;
+	guint round;
+
+	/* A single fast answer isn't enough */
+	for (round = 1; round < DNS_PROBE_REORDER_ROUNDS; round++)
+	{
+		dns_probe_health_add_sample(slow, 120);
+		dns_probe_health_add_sample(fast, 10);
+		dns_probe_health_add_sample(dead, -1);
+		g_assert(NULL == dns_probe_health_reorder(health, TIMEOUT_MS));
+	}
+
+	/* A round where the first server keeps up restarts the count */
+	slow->latency = 10;
+	g_assert(NULL == dns_probe_health_reorder(health, TIMEOUT_MS));
+	g_assert_cmpuint(fast->better_rounds, ==, 0);
+	slow->latency = 120;
+
+	for (round = 1; round <= DNS_PROBE_REORDER_ROUNDS; round++)
+	{
+		g_assert(NULL == order);
+		order = dns_probe_health_reorder(health, TIMEOUT_MS);
+	}
+
+	g_assert(NULL != order);
+	g_assert_cmpstr(order[0], ==, "10.0.0.2");
+	g_assert_cmpstr(order[1], ==, "10.0.0.1");
+	g_assert_cmpstr(order[2], ==, "10.0.0.3");
+	g_strfreev(order);
+
+	/* Differences within the margin don't reorder */
+	health = dns_probe_health_sync(health, (GStrv) servers);
+	slow->latency = 12;
+	fast->latency = 10;
+
+	for (round = 0; round < 2 * DNS_PROBE_REORDER_ROUNDS; round++)
+	{
+		g_assert(NULL == dns_probe_health_reorder(health, TIMEOUT_MS));
+	}
+
+	dns_probe_health_free(health);
+}
+
+static void test_probe(void)
+{
+	responder_t responders[3];
+	result_t result = { 0 };
+	gchar *servers[] = { "127.0.0.1", "127.0.0.2", "127.0.0.3", NULL };
+	guint16 port = 0;
+	dns_probe_t *probe;
+
+	/* Slow, fast and dead stub servers on the same port */
+	responder_start(&responders[0], servers[0], &port, 100);
+	responder_start(&responders[1], servers[1], &port, 5);
+	responder_start(&responders[2], servers[2], &port, -1);
+
+	result.loop = g_main_loop_new(NULL, FALSE);
+
+	probe = dns_probe_start(NULL, servers, port, TIMEOUT_MS, probe_done, &result);
+	g_assert(NULL != probe);
+	g_main_loop_run(result.loop);
+
+	g_assert_cmpuint(result.calls, ==, 1);
+	g_assert_cmpint(result.latencies[0], >=, 100);
+	g_assert_cmpint(result.latencies[0], <, TIMEOUT_MS);
+	g_assert_cmpint(result.latencies[1], >=, 0);
+	g_assert_cmpint(result.latencies[1], <, 100);
+	g_assert_cmpint(result.latencies[2], ==, -1);
+
+	/* Nothing to probe */
+	g_assert(NULL == dns_probe_start(NULL, NULL, port, TIMEOUT_MS, probe_done,
+	                                 &result));
+
+	/* A cancelled probe never calls back */
+	responders[2].delay_ms = 0;
+	probe = dns_probe_start(NULL, servers, port, TIMEOUT_MS, probe_done, &result);
+	g_assert(NULL != probe);
+	dns_probe_cancel(probe);
+
+	while (g_main_context_iteration(NULL, FALSE));
+
+	g_assert_cmpuint(result.calls, ==, 1);
+
+	responder_stop(&responders[0]);
+	responder_stop(&responders[1]);
+	responder_stop(&responders[2]);
+	g_main_loop_unref(result.loop);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/dns_probe/query", test_query);
+	g_test_add_func("/dns_probe/ewma", test_ewma);
+	g_test_add_func("/dns_probe/sync", test_sync);
+	g_test_add_func("/dns_probe/reorder", test_reorder);
+	g_test_add_func("/dns_probe/probe", test_probe);
+
+	return g_test_run();
+}
@@ -0,0 +1,170 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <net/if_arp.h>
+#include <netinet/icmp6.h>
+
+#include "gateway_probe.h"
+
+static const guint8 local_mac[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+
+/**
+ * @brief The ARP request has to carry our addresses and ask for the gateway.
+ */
+
+static void test_arp_request(void)
+{
+	struct in_addr src, gateway;
+	guint8 buf[GATEWAY_PROBE_ARP_LEN];
+
+	inet_pton(AF_INET, "192.168.0.10", &src);
+	inet_pton(AF_INET, "192.168.0.1", &gateway);
+
+	g_assert(gateway_probe_build_arp_request(buf, local_mac, &src,
+	         &gateway) == GATEWAY_PROBE_ARP_LEN);
+
+	struct arphdr *hdr = (struct arphdr *) buf;
+	g_assert(ntohs(hdr->ar_op) == ARPOP_REQUEST);
+	g_assert(memcmp(buf + 8, local_mac, 6) == 0);
+	g_assert(memcmp(buf + 14, &src.s_addr, 4) == 0);
+	g_assert(memcmp(buf + 24, &gateway.s_addr, 4) == 0);
+
+	/* Our own request must not be taken for a reply */
+	g_assert(!gateway_probe_is_arp_reply(buf, sizeof(buf), &gateway));
+}
+
+/**
+ * @brief Only replies sent by the gateway are accepted.
+ */
+
+static void test_arp_reply(void)
+{
+	struct in_addr local, gateway, other;
+	guint8 buf[GATEWAY_PROBE_ARP_LEN];
+
+	inet_pton(AF_INET, "192.168.0.10", &local);
+	inet_pton(AF_INET, "192.168.0.1", &gateway);
+	inet_pton(AF_INET, "192.168.0.2", &other);
+
+	/* A reply is a request with swapped addresses */
+	gateway_probe_build_arp_request(buf, local_mac, &gateway, &local);
+	((struct arphdr *) buf)->ar_op = htons(ARPOP_REPLY);
+
+	g_assert(gateway_probe_is_arp_reply(buf, sizeof(buf), &gateway));
+	g_assert(!gateway_probe_is_arp_reply(buf, sizeof(buf), &other));
+	g_assert(!gateway_probe_is_arp_reply(buf, sizeof(buf) - 1, &gateway));
+}
+
+/**
+ * @brief Check the solicited-node multicast address and the neighbor
+ * solicitation layout.
+ */
+
+static void test_neighbor_solicit(void)
+{
+	struct in6_addr router, snm, expected;
+	guint8 buf[GATEWAY_PROBE_NS_LEN];
+
+	inet_pton(AF_INET6, "fe80::1234:5678:9abc:def0", &router);
+	inet_pton(AF_INET6, "ff02::1:ffbc:def0", &expected);
+
+	gateway_probe_solicited_node(&router, &snm);
+	g_assert(memcmp(&snm, &expected, sizeof(snm)) == 0);
+
+	g_assert(gateway_probe_build_neighbor_solicit(buf, local_mac,
+	         &router) == GATEWAY_PROBE_NS_LEN);
+	g_assert(buf[0] == ND_NEIGHBOR_SOLICIT);
+	g_assert(memcmp(buf + 8, &router, sizeof(router)) == 0);
+	g_assert(buf[24] == ND_OPT_SOURCE_LINKADDR);
+	g_assert(memcmp(buf + 26, local_mac, 6) == 0);
+
+	g_assert(gateway_probe_build_neighbor_solicit(buf, NULL,
+	         &router) == sizeof(struct nd_neighbor_solicit));
+}
+
+/**
+ * @brief Only advertisements for the router are accepted.
+ */
+
+static void test_neighbor_advert(void)
+{
+	struct in6_addr router, other;
+	struct nd_neighbor_advert na;
+
+	inet_pton(AF_INET6, "fe80::1", &router);
+	inet_pton(AF_INET6, "fe80::2", &other);
+
+	memset(&na, 0, sizeof(na));
+	na.nd_na_type = ND_NEIGHBOR_ADVERT;
+	na.nd_na_target = router;
+
+	g_assert(gateway_probe_is_neighbor_advert((guint8 *) &na, sizeof(na), &router));
+	g_assert(!gateway_probe_is_neighbor_advert((guint8 *) &na, sizeof(na), &other));
+	g_assert(!gateway_probe_is_neighbor_advert((guint8 *) &na, 8, &router));
+
+	na.nd_na_type = ND_NEIGHBOR_SOLICIT;
+	g_assert(!gateway_probe_is_neighbor_advert((guint8 *) &na, sizeof(na), &router));
+}
+
+/**
+ * @brief The hardware address of the router is taken from the target
+ * link-layer address option.
+ */
+
+static void test_target_link_address(void)
+{
+	guint8 buf[GATEWAY_PROBE_NS_LEN];
+	struct in6_addr router;
+	const guint8 *mac;
+
+	inet_pton(AF_INET6, "fe80::1", &router);
+
+	/* An advertisement has the same layout as a solicitation */
+	gateway_probe_build_neighbor_solicit(buf, local_mac, &router);
+	buf[0] = ND_NEIGHBOR_ADVERT;
+
+	/* Only the source link-layer address option is present */
+	g_assert(gateway_probe_get_target_link_address(buf, sizeof(buf)) == NULL);
+
+	buf[24] = ND_OPT_TARGET_LINKADDR;
+	mac = gateway_probe_get_target_link_address(buf, sizeof(buf));
+	g_assert(mac != NULL);
+	g_assert(memcmp(mac, local_mac, 6) == 0);
+
+	/* Truncated option */
+	g_assert(gateway_probe_get_target_link_address(buf, sizeof(buf) - 1) == NULL);
+
+	/* Options with a length of zero are invalid */
+	buf[25] = 0;
+	g_assert(gateway_probe_get_target_link_address(buf, sizeof(buf)) == NULL);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/gateway_probe/arp_request", test_arp_request);
+	g_test_add_func("/gateway_probe/arp_reply", test_arp_reply);
+	g_test_add_func("/gateway_probe/neighbor_solicit", test_neighbor_solicit);
+	g_test_add_func("/gateway_probe/neighbor_advert", test_neighbor_advert);
+	g_test_add_func("/gateway_probe/target_link_address",
+	                test_target_link_address);
+
+	return g_test_run();
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <glib.h>
+#include <string.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/if_addr.h>
+
+#include "ipv6_addresses.h"
+
+#define IFINDEX         3
+
+/**
+ * Append an address message to buf, like the kernel sends them
+ */
+
+static gsize put_address(guint8 *buf, gsize offset, guint16 type,
+                         const gchar *address, guint8 scope, guint32 flags,
+                         guint32 preferred, guint32 valid)
+{
+	struct nlmsghdr *nlh = (struct nlmsghdr *)(buf + offset);
+	struct ifaddrmsg *ifa;
+	struct rtattr *rta;
+	struct ifa_cacheinfo cacheinfo = { 0 };
+
+	memset(nlh, 0, NLMSG_SPACE(sizeof(*ifa)));
+	nlh->nlmsg_type = type;
+	nlh->nlmsg_len = NLMSG_LENGTH(sizeof(*ifa));
+
+	ifa = NLMSG_DATA(nlh);
+	ifa->ifa_family = AF_INET6;
+	ifa->ifa_prefixlen = 64;
+	ifa->ifa_flags = flags & 0xff;
+	ifa->ifa_scope = scope;
+	ifa->ifa_index = IFINDEX;
+
+	rta = (struct rtattr *)((guint8 *) nlh + NLMSG_ALIGN(nlh->nlmsg_len));
+	rta->rta_type = IFA_ADDRESS;
+	rta->rta_len = RTA_LENGTH(16);
+	g_assert(1 == inet_pton(AF_INET6, address, RTA_DATA(rta)));
+	nlh->nlmsg_len = NLMSG_ALIGN(nlh->nlmsg_len) + RTA_ALIGN(rta->rta_len);
+
+	rta = (struct rtattr *)((guint8 *) nlh + nlh->nlmsg_len);
+	rta->rta_type = IFA_CACHEINFO;
+	rta->rta_len = RTA_LENGTH(sizeof(cacheinfo));
+	cacheinfo.ifa_prefered = preferred;
+	cacheinfo.ifa_valid = valid;
+	memcpy(RTA_DATA(rta), &cacheinfo, sizeof(cacheinfo));
+	nlh->nlmsg_len += RTA_ALIGN(rta->rta_len);
+
+	rta = (struct rtattr *)((guint8 *) nlh + nlh->nlmsg_len);
+	rta->rta_type = IFA_FLAGS;
+	rta->rta_len = RTA_LENGTH(sizeof(guint32));
+	memcpy(RTA_DATA(rta), &flags, sizeof(guint32));
+	nlh->nlmsg_len += RTA_ALIGN(rta->rta_len);
+
+	return offset + NLMSG_ALIGN(nlh->nlmsg_len);
+}
+
+static const gchar *nth_address(GList *addresses, guint n)
+{
+	return ((ipv6_address_t *) g_list_nth_data(addresses, n))->address;
+}
+
+static void test_parse(void)
+{
+	guint8 buf[1024];
+	gsize len = 0;
+	GList *addresses;
+	const ipv6_address_t *address;
+	const gchar **names;
+	gint64 now = g_get_monotonic_time() / G_USEC_PER_SEC;
+
+	ipv6_addresses_reset();
+
+	len = put_address(buf, len, RTM_NEWADDR, "fe80::1", RT_SCOPE_LINK,
+	                  IFA_F_PERMANENT, 0xffffffff, 0xffffffff);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::abcd", RT_SCOPE_UNIVERSE,
+	                  IFA_F_MANAGETEMPADDR | 0x800, 3600, 7200);
+	g_assert(ipv6_addresses_parse(buf, len, now));
+
+	addresses = ipv6_addresses_get(IFINDEX, TRUE);
+	g_assert_cmpuint(g_list_length(addresses), ==, 2);
+	address = addresses->data;
+	g_assert_cmpstr(address->address, ==, "2001:db8::abcd");
+	g_assert_cmpuint(address->prefix_length, ==, 64);
+	g_assert_cmpint(ipv6_address_get_lifetime(address, FALSE, now + 600), ==, 3000);
+	g_assert_cmpint(ipv6_address_get_lifetime(address, TRUE, now + 8000), ==, 0);
+	g_assert_cmpstr(ipv6_address_scope_to_string(address->scope), ==, "global");
+
+	/* The upper flags only come with IFA_FLAGS */
+	names = ipv6_address_get_flag_names(address);
+	g_assert_cmpuint(g_strv_length((gchar **) names), ==, 2);
+	g_assert_cmpstr(names[0], ==, "stablePrivacy");
+	g_assert_cmpstr(names[1], ==, "manageTempAddr");
+	g_free(names);
+
+	address = g_list_nth_data(addresses, 1);
+	g_assert_cmpint(ipv6_address_get_lifetime(address, TRUE, now + 8000), ==,
+	                IPV6_ADDRESS_LIFETIME_INFINITE);
+	g_list_free(addresses);
+
+	/* Refreshed lifetimes aren't a change */
+	len = put_address(buf, 0, RTM_NEWADDR, "2001:db8::abcd", RT_SCOPE_UNIVERSE,
+	                  IFA_F_MANAGETEMPADDR | 0x800, 1800, 7200);
+	g_assert(!ipv6_addresses_parse(buf, len, now));
+	addresses = ipv6_addresses_get(IFINDEX, TRUE);
+	g_assert_cmpint(ipv6_address_get_lifetime(addresses->data, FALSE, now), ==, 1800);
+	g_list_free(addresses);
+
+	/* Other interfaces and families aren't mixed in */
+	g_assert(NULL == ipv6_addresses_get(IFINDEX + 1, TRUE));
+
+	len = put_address(buf, 0, RTM_DELADDR, "fe80::1", RT_SCOPE_LINK, 0, 0, 0);
+	g_assert(ipv6_addresses_parse(buf, len, now));
+	g_assert(!ipv6_addresses_parse(buf, len, now));
+	addresses = ipv6_addresses_get(IFINDEX, TRUE);
+	g_assert_cmpuint(g_list_length(addresses), ==, 1);
+	g_list_free(addresses);
+
+	/* Truncated messages are ignored */
+	len = put_address(buf, 0, RTM_NEWADDR, "2001:db8::2", RT_SCOPE_UNIVERSE, 0, 10,
+	                  10);
+	g_assert(!ipv6_addresses_parse(buf, len - 40, now));
+
+	ipv6_addresses_reset();
+	g_assert(NULL == ipv6_addresses_get(IFINDEX, TRUE));
+}
+
+static void test_order(void)
+{
+	guint8 buf[2048];
+	gsize len = 0;
+	GList *addresses;
+	gint64 now = g_get_monotonic_time() / G_USEC_PER_SEC;
+
+	ipv6_addresses_reset();
+
+	len = put_address(buf, len, RTM_NEWADDR, "fe80::1", RT_SCOPE_LINK,
+	                  IFA_F_PERMANENT, 0xffffffff, 0xffffffff);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::1", RT_SCOPE_UNIVERSE,
+	                  IFA_F_MANAGETEMPADDR, 86400, 86400);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::a", RT_SCOPE_UNIVERSE,
+	                  IFA_F_TEMPORARY, 3600, 86400);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::b", RT_SCOPE_UNIVERSE,
+	                  IFA_F_TEMPORARY, 7200, 86400);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::c", RT_SCOPE_UNIVERSE,
+	                  IFA_F_TEMPORARY | IFA_F_DEPRECATED, 0, 600);
+	len = put_address(buf, len, RTM_NEWADDR, "2001:db8::d", RT_SCOPE_UNIVERSE,
+	                  IFA_F_TEMPORARY | IFA_F_TENTATIVE, 9000, 86400);
+	g_assert(ipv6_addresses_parse(buf, len, now));
+
+	/* The newest temporary address first */
+	addresses = ipv6_addresses_get(IFINDEX, FALSE);
+	g_assert_cmpuint(g_list_length(addresses), ==, 6);
+	g_assert_cmpstr(nth_address(addresses, 0), ==, "2001:db8::b");
+	g_assert_cmpstr(nth_address(addresses, 1), ==, "2001:db8::a");
+	g_assert_cmpstr(nth_address(addresses, 2), ==, "2001:db8::1");
+	g_assert_cmpstr(nth_address(addresses, 3), ==, "fe80::1");
+	g_assert_cmpstr(nth_address(addresses, 4), ==, "2001:db8::c");
+	g_assert_cmpstr(nth_address(addresses, 5), ==, "2001:db8::d");
+	g_list_free(addresses);
+
+	addresses = ipv6_addresses_get(IFINDEX, TRUE);
+	g_assert_cmpstr(nth_address(addresses, 0), ==, "2001:db8::1");
+	g_assert_cmpstr(nth_address(addresses, 1), ==, "2001:db8::b");
+	g_list_free(addresses);
+
+	/* An address running out of preferred lifetime is deprecated */
+	len = put_address(buf, 0, RTM_NEWADDR, "2001:db8::1", RT_SCOPE_UNIVERSE,
+	                  IFA_F_MANAGETEMPADDR, 0, 86400);
+	g_assert(!ipv6_addresses_parse(buf, len, now));
+	addresses = ipv6_addresses_get(IFINDEX, TRUE);
+	g_assert_cmpstr(nth_address(addresses, 0), ==, "2001:db8::b");
+	g_list_free(addresses);
+
+	ipv6_addresses_reset();
+}
+
+static void test_privacy(void)
+{
+	gboolean privacy = FALSE, prefer_stable = FALSE;
+
+	g_assert_cmpstr(ipv6_privacy_to_connman(FALSE, FALSE), ==, "disabled");
+	g_assert_cmpstr(ipv6_privacy_to_connman(TRUE, TRUE), ==, "enabled");
+	g_assert_cmpstr(ipv6_privacy_to_connman(TRUE, FALSE), ==, "prefered");
+
+	g_assert(ipv6_privacy_from_connman("prefered", &privacy, &prefer_stable));
+	g_assert(privacy);
+	g_assert(!prefer_stable);
+	g_assert(ipv6_privacy_from_connman("enabled", &privacy, &prefer_stable));
+	g_assert(privacy);
+	g_assert(prefer_stable);
+	g_assert(ipv6_privacy_from_connman("disabled", &privacy, &prefer_stable));
+	g_assert(!privacy);
+	g_assert(!ipv6_privacy_from_connman("always", &privacy, &prefer_stable));
+	g_assert(!ipv6_privacy_from_connman(NULL, &privacy, &prefer_stable));
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ipv6_addresses/parse", test_parse);
+	g_test_add_func("/ipv6_addresses/order", test_order);
+	g_test_add_func("/ipv6_addresses/privacy", test_privacy);
+
+	return g_test_run();
+}
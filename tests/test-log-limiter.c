@@ -0,0 +1,223 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdio.h>
+#include <glib.h>
+
+#include "log_limiter.h"
+
+#define HOT_ID      "CONNECTION_INFO"
+#define OTHER_ID    "WIFI_CONNECT_SERVICE"
+
+/* Replay of a scan storm: events per second over the replayed seconds */
+#define REPLAY_EVENTS_PER_S     2000
+#define REPLAY_SECONDS          30
+
+static guint dropped_total = 0;
+
+static void count_dropped(const gchar *id, guint count, gpointer user_data)
+{
+	GHashTable *counts = user_data;
+
+	g_hash_table_insert(counts, g_strdup(id), GUINT_TO_POINTER(count));
+	dropped_total += count;
+}
+
+static guint allowed_within(const gchar *id, guint messages, gint64 start_ms,
+                            gint64 step_ms)
+{
+	guint allowed = 0;
+	guint i;
+
+	for (i = 0; i < messages; i++)
+	{
+		if (log_limiter_allow(id, start_ms + i * step_ms))
+		{
+			allowed++;
+		}
+	}
+
+	return allowed;
+}
+
+static void test_burst_refill(void)
+{
+	log_limiter_reset();
+	log_limiter_set_default_budget(10, 20);
+
+	/* The burst goes through at once, then nothing */
+	g_assert_cmpuint(allowed_within(HOT_ID, 50, 0, 0), ==, 20);
+
+	/* 10 messages/s refill */
+	g_assert_cmpuint(allowed_within(HOT_ID, 5, 500, 0), ==, 5);
+	g_assert(!log_limiter_allow(HOT_ID, 500));
+	g_assert(!log_limiter_allow(HOT_ID, 599));
+	g_assert(log_limiter_allow(HOT_ID, 600));
+
+	/* Other ids have their own bucket */
+	g_assert_cmpuint(allowed_within(OTHER_ID, 50, 600, 0), ==, 20);
+
+	/* The bucket doesn't fill beyond the burst */
+	g_assert_cmpuint(allowed_within(HOT_ID, 100, 1000000, 0), ==, 20);
+
+	log_limiter_reset();
+}
+
+static void test_budgets(void)
+{
+	log_limiter_reset();
+	log_limiter_set_budget(HOT_ID, 1, 2);
+	log_limiter_set_budget(OTHER_ID, 0, 0);
+
+	g_assert_cmpuint(allowed_within(HOT_ID, 10, 0, 0), ==, 2);
+	g_assert_cmpuint(allowed_within(OTHER_ID, 1000, 0, 0), ==, 1000);
+
+	/* Own budgets survive changes of the default */
+	log_limiter_set_default_budget(100, 100);
+	g_assert_cmpuint(allowed_within(HOT_ID, 10, 1000, 0), ==, 1);
+
+	/* Lifting the limits lets everything through */
+	log_limiter_set_default_budget(0, 100);
+	g_assert_cmpuint(allowed_within(HOT_ID, 1000, 1000, 0), ==, 1000);
+
+	log_limiter_reset();
+}
+
+static void test_flush(void)
+{
+	GHashTable *counts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+	                     NULL);
+
+	log_limiter_reset();
+	log_limiter_set_default_budget(10, 5);
+	dropped_total = 0;
+
+	allowed_within(HOT_ID, 12, 0, 0);
+	allowed_within(OTHER_ID, 5, 0, 0);
+
+	log_limiter_flush(count_dropped, counts);
+	g_assert_cmpuint(g_hash_table_size(counts), ==, 1);
+	g_assert_cmpuint(GPOINTER_TO_UINT(g_hash_table_lookup(counts, HOT_ID)), ==, 7);
+
+	/* Counts restart after a flush */
+	g_hash_table_remove_all(counts);
+	log_limiter_flush(count_dropped, counts);
+	g_assert_cmpuint(g_hash_table_size(counts), ==, 0);
+
+	g_hash_table_unref(counts);
+	log_limiter_reset();
+}
+
+static void test_max_ids(void)
+{
+	gchar id[32];
+	guint i;
+
+	log_limiter_reset();
+	log_limiter_set_default_budget(1, 1);
+
+	for (i = 0; i < LOG_LIMITER_MAX_IDS; i++)
+	{
+		g_snprintf(id, sizeof(id), "ID_%u", i);
+		g_assert(log_limiter_allow(id, 0));
+		g_assert(!log_limiter_allow(id, 0));
+	}
+
+	/* Ids beyond the table aren't limited */
+	g_assert_cmpuint(allowed_within("ONE_TOO_MANY", 10, 0, 0), ==, 10);
+
+	log_limiter_reset();
+}
+
+/* Stand-in for PmLog: format the message and write it out */
+static void sink(FILE *out, const gchar *id, guint n)
+{
+	gchar line[256];
+
+	g_snprintf(line, sizeof(line), "%s {} needed: %u service /net/connman/service/"
+	           "wifi_%012x_managed_psk state changed", id, n, n);
+	fputs(line, out);
+	fflush(out);
+}
+
+static gdouble replay(FILE *out, gboolean limit, guint *logged)
+{
+	static const gchar *ids[] = { HOT_ID, OTHER_ID, "WIFI_SCAN", "CM_GETINFO" };
+	guint events = REPLAY_EVENTS_PER_S * REPLAY_SECONDS;
+	guint i;
+
+	log_limiter_reset();
+	log_limiter_set_default_budget(limit ? LOG_LIMITER_RATE : 0,
+	                               LOG_LIMITER_BURST);
+	*logged = 0;
+
+	g_test_timer_start();
+
+	for (i = 0; i < events; i++)
+	{
+		const gchar *id = ids[i % G_N_ELEMENTS(ids)];
+
+		if (log_limiter_allow(id, (gint64) i * 1000 / REPLAY_EVENTS_PER_S))
+		{
+			sink(out, id, i);
+			(*logged)++;
+		}
+	}
+
+	return g_test_timer_elapsed();
+}
+
+static void test_replay_benchmark(void)
+{
+	FILE *out = fopen("/dev/null", "w");
+	guint logged_unlimited, logged_limited;
+	gdouble unlimited, limited;
+
+	g_assert(NULL != out);
+
+	unlimited = replay(out, FALSE, &logged_unlimited);
+	limited = replay(out, TRUE, &logged_limited);
+
+	g_assert_cmpuint(logged_unlimited, ==, REPLAY_EVENTS_PER_S * REPLAY_SECONDS);
+	g_assert_cmpuint(logged_limited, <=,
+	                 4 * (LOG_LIMITER_BURST + LOG_LIMITER_RATE * REPLAY_SECONDS));
+
+	g_test_message("replay of %u events: %u logged in %.3f s without limits, "
+	               "%u logged in %.3f s with limits", REPLAY_EVENTS_PER_S * REPLAY_SECONDS,
+	               logged_unlimited, unlimited, logged_limited, limited);
+	g_test_minimized_result(limited, "limited replay %.3f s", limited);
+
+	fclose(out);
+	log_limiter_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/log_limiter/burst_refill", test_burst_refill);
+	g_test_add_func("/log_limiter/budgets", test_budgets);
+	g_test_add_func("/log_limiter/flush", test_flush);
+	g_test_add_func("/log_limiter/max_ids", test_max_ids);
+
+	/* Run with -m perf */
+	if (g_test_perf())
+	{
+		g_test_add_func("/log_limiter/replay_benchmark", test_replay_benchmark);
+	}
+
+	return g_test_run();
+}
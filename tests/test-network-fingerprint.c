@@ -0,0 +1,252 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+#include <string.h>
+
+#include "network_fingerprint.h"
+
+static const guint8 gateway_mac[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+static const guint8 other_mac[] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x56 };
+
+static void set_bss(bssinfo_t *bss, const gchar *bssid)
+{
+	memset(bss, 0, sizeof(*bss));
+	g_strlcpy(bss->bssid, bssid, sizeof(bss->bssid));
+}
+
+/**
+ * @brief The order of the access points must not change the fingerprint.
+ */
+
+static void test_bss_order(void)
+{
+	bssinfo_t bss[3];
+	guint64 first, second;
+
+	set_bss(&bss[0], "20:AA:4B:DB:C5:A8");
+	set_bss(&bss[1], "00:1A:2B:01:02:03");
+	set_bss(&bss[2], "20:AA:4B:00:00:01");
+
+	g_assert(network_fingerprint_compute("home", gateway_mac, bss, 3, &first));
+
+	set_bss(&bss[0], "00:1A:2B:01:02:03");
+	set_bss(&bss[1], "20:aa:4b:00:00:01");
+	set_bss(&bss[2], "20:AA:4B:DB:C5:A8");
+
+	g_assert(network_fingerprint_compute("home", gateway_mac, bss, 3, &second));
+	g_assert(first == second);
+
+	/* Access points of the same vendor only count once */
+	g_assert(network_fingerprint_compute("home", gateway_mac, bss, 2, &second));
+	g_assert(first == second);
+}
+
+/**
+ * @brief Locally administered BSSIDs don't carry a vendor OUI and are ignored.
+ */
+
+static void test_local_bssid(void)
+{
+	bssinfo_t bss[2];
+	guint64 first, second;
+
+	set_bss(&bss[0], "20:AA:4B:DB:C5:A8");
+	set_bss(&bss[1], "22:AA:4B:DB:C5:A9");
+
+	g_assert(network_fingerprint_compute("home", gateway_mac, bss, 1, &first));
+	g_assert(network_fingerprint_compute("home", gateway_mac, bss, 2, &second));
+	g_assert(first == second);
+}
+
+/**
+ * @brief Networks sharing a SSID are told apart by their gateway, and the
+ * SSID, gateway and access points all change the fingerprint.
+ */
+
+static void test_distinct(void)
+{
+	bssinfo_t bss;
+	guint64 base, fingerprint;
+
+	set_bss(&bss, "20:AA:4B:DB:C5:A8");
+
+	g_assert(network_fingerprint_compute("home", gateway_mac, &bss, 1, &base));
+
+	g_assert(network_fingerprint_compute("home", other_mac, &bss, 1,
+	                                     &fingerprint));
+	g_assert(base != fingerprint);
+
+	g_assert(network_fingerprint_compute("office", gateway_mac, &bss, 1,
+	                                     &fingerprint));
+	g_assert(base != fingerprint);
+
+	g_assert(network_fingerprint_compute("home", gateway_mac, NULL, 0,
+	                                     &fingerprint));
+	g_assert(base != fingerprint);
+
+	/* Wired networks have no SSID */
+	g_assert(network_fingerprint_compute(NULL, gateway_mac, NULL, 0,
+	                                     &fingerprint));
+	g_assert(!network_fingerprint_compute("home", NULL, &bss, 1, &fingerprint));
+}
+
+static void test_string(void)
+{
+	guint64 fingerprint = G_GUINT64_CONSTANT(0x0123456789abcdef), parsed = 0;
+	gchar *str = network_fingerprint_to_string(fingerprint);
+
+	g_assert_cmpstr(str, ==, "0123456789abcdef");
+	g_assert(network_fingerprint_from_string(str, &parsed));
+	g_assert(parsed == fingerprint);
+	g_free(str);
+
+	g_assert(network_fingerprint_from_string("FFFFFFFFFFFFFFFF", &parsed));
+	g_assert(parsed == G_MAXUINT64);
+
+	g_assert(!network_fingerprint_from_string("0123456789abcde", &parsed));
+	g_assert(!network_fingerprint_from_string("0123456789abcdeg", &parsed));
+	g_assert(!network_fingerprint_from_string(NULL, &parsed));
+}
+
+static void test_binding(void)
+{
+	gchar *dns[] = { "8.8.8.8", "8.8.4.4", NULL };
+	ipv4info_t ipv4 =
+	{
+		.method = "manual",
+		.address = "192.168.0.10",
+		.netmask = "255.255.255.0",
+		.gateway = "192.168.0.1",
+	};
+	network_binding_t *binding;
+	GList *list;
+
+	network_binding_clear();
+	g_assert(network_binding_lookup(1) == NULL);
+
+	network_binding_set_ipv4(1, &ipv4);
+	network_binding_set_dns(1, dns);
+	network_binding_set_dns(2, dns);
+
+	binding = network_binding_lookup(1);
+	g_assert(binding != NULL);
+	g_assert(binding->fingerprint == 1);
+	g_assert_cmpstr(binding->ipv4.address, ==, "192.168.0.10");
+	g_assert(g_strv_length(binding->dns) == 2);
+	g_assert(binding->proxy.method == NULL);
+
+	/* Only the DNS servers are bound to the second network */
+	binding = network_binding_lookup(2);
+	g_assert(binding != NULL);
+	g_assert(binding->ipv4.method == NULL);
+
+	list = network_binding_get_all();
+	g_assert(g_list_length(list) == 2);
+	g_list_free(list);
+
+	g_assert(network_binding_remove(1));
+	g_assert(!network_binding_remove(1));
+	g_assert(network_binding_lookup(1) == NULL);
+	g_assert(network_binding_lookup(2) != NULL);
+
+	network_binding_clear();
+	g_assert(network_binding_lookup(2) == NULL);
+}
+
+/**
+ * @brief The site only depends on the SSID and the gateway.
+ */
+
+static void test_site(void)
+{
+	bssinfo_t bss;
+	guint64 site, other, fingerprint, drifted;
+
+	set_bss(&bss, "20:AA:4B:DB:C5:A8");
+
+	g_assert(network_fingerprint_compute_site("home", gateway_mac, &site));
+	g_assert(network_fingerprint_compute("home", gateway_mac, &bss, 1,
+	                                     &fingerprint));
+	g_assert(network_fingerprint_compute("home", gateway_mac, NULL, 0, &drifted));
+	g_assert(fingerprint != drifted);
+
+	/* Without access points the fingerprint is the site */
+	g_assert(network_fingerprint_compute_site("home", gateway_mac, &other));
+	g_assert(site == other);
+	g_assert(site == drifted);
+
+	g_assert(network_fingerprint_compute_site("home", other_mac, &other));
+	g_assert(site != other);
+	g_assert(network_fingerprint_compute_site("office", gateway_mac, &other));
+	g_assert(site != other);
+	g_assert(!network_fingerprint_compute_site("home", NULL, &other));
+}
+
+static void test_applied(void)
+{
+	gchar *dns[] = { "8.8.8.8", NULL };
+	ipv4info_t ipv4 = { .method = "manual", .address = "192.168.0.10" };
+	ipv4info_t dhcp = { .method = "dhcp" };
+	network_applied_t *applied;
+	GList *list;
+
+	network_binding_clear();
+
+	applied = network_binding_set_applied("wifi_1", 1);
+	g_assert(applied != NULL);
+	network_binding_copy_ipv4(&applied->written.ipv4, &ipv4);
+	network_binding_copy_ipv4(&applied->previous.ipv4, &dhcp);
+	applied->written.dns = g_strdupv(dns);
+
+	/* Applying again keeps what was replaced */
+	g_assert(applied == network_binding_set_applied("wifi_1", 2));
+	g_assert(applied->site == 2);
+	g_assert_cmpstr(applied->previous.ipv4.method, ==, "dhcp");
+
+	g_assert(network_binding_set_applied("ethernet_1", 3) != NULL);
+	g_assert(network_binding_set_applied(NULL, 3) == NULL);
+	g_assert(network_binding_is_applied("wifi_1"));
+	g_assert(network_binding_get_applied_to("wifi_1") == applied);
+
+	list = network_binding_get_applied();
+	g_assert(g_list_length(list) == 2);
+	g_list_free(list);
+
+	network_binding_forget_applied("wifi_1");
+	g_assert(!network_binding_is_applied("wifi_1"));
+	g_assert(network_binding_get_applied_to("wifi_1") == NULL);
+	g_assert(network_binding_is_applied("ethernet_1"));
+	g_assert(!network_binding_is_applied(NULL));
+
+	network_binding_clear();
+	g_assert(!network_binding_is_applied("ethernet_1"));
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/network_fingerprint/bss_order", test_bss_order);
+	g_test_add_func("/network_fingerprint/local_bssid", test_local_bssid);
+	g_test_add_func("/network_fingerprint/distinct", test_distinct);
+	g_test_add_func("/network_fingerprint/string", test_string);
+	g_test_add_func("/network_fingerprint/binding", test_binding);
+	g_test_add_func("/network_fingerprint/site", test_site);
+	g_test_add_func("/network_fingerprint/applied", test_applied);
+
+	return g_test_run();
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "p2p_group_cache.h"
+
+#define SINK        "02:11:22:aa:bb:cc"
+#define PHONE       "02:11:22:DD:EE:FF"
+
+static void test_update(void)
+{
+	const p2p_cached_group_t *group;
+
+	p2p_group_cache_reset();
+
+	p2p_group_cache_update(SINK, P2P_GROUP_ROLE_OWNER, 2437, "DIRECT-ab", 100);
+	group = p2p_group_cache_lookup("02:11:22:AA:BB:CC");
+	g_assert(NULL != group);
+	g_assert_cmpstr(group->peer_address, ==, "02:11:22:AA:BB:CC");
+	g_assert_cmpint(group->role, ==, P2P_GROUP_ROLE_OWNER);
+	g_assert_cmpint(group->freq, ==, 2437);
+	g_assert_cmpstr(group->group_name, ==, "DIRECT-ab");
+
+	/* Refreshed in place */
+	p2p_group_cache_update(SINK, P2P_GROUP_ROLE_CLIENT, 5180, "DIRECT-cd", 200);
+	g_assert(group == p2p_group_cache_lookup(SINK));
+	g_assert_cmpint(group->role, ==, P2P_GROUP_ROLE_CLIENT);
+	g_assert_cmpint(group->freq, ==, 5180);
+	g_assert_cmpstr(group->group_name, ==, "DIRECT-cd");
+	g_assert_cmpint(group->last_used, ==, 200);
+	g_assert_cmpuint(g_list_length((GList *) p2p_group_cache_get_groups()), ==, 1);
+
+	g_assert(p2p_group_cache_remove(SINK));
+	g_assert(!p2p_group_cache_remove(SINK));
+	g_assert(NULL == p2p_group_cache_lookup(SINK));
+
+	p2p_group_cache_reset();
+}
+
+static void test_order(void)
+{
+	gchar address[18];
+	const GList *groups;
+	guint i;
+
+	p2p_group_cache_reset();
+
+	/* Loaded out of order, kept most recently used first */
+	p2p_group_cache_update(SINK, P2P_GROUP_ROLE_OWNER, 0, "a", 100);
+	p2p_group_cache_update(PHONE, P2P_GROUP_ROLE_CLIENT, 0, "b", 300);
+	groups = p2p_group_cache_get_groups();
+	g_assert_cmpstr(((p2p_cached_group_t *) groups->data)->peer_address, ==, PHONE);
+
+	/* The least recently used group is dropped */
+	for (i = 0; i < P2P_GROUP_CACHE_MAX - 1; i++)
+	{
+		g_snprintf(address, sizeof(address), "02:00:00:00:00:%02X", i);
+		p2p_group_cache_update(address, P2P_GROUP_ROLE_OWNER, 0, "c", 1000 + i);
+	}
+
+	g_assert_cmpuint(g_list_length((GList *) p2p_group_cache_get_groups()), ==,
+	                 P2P_GROUP_CACHE_MAX);
+	g_assert(NULL == p2p_group_cache_lookup(SINK));
+	g_assert(NULL != p2p_group_cache_lookup(PHONE));
+
+	p2p_group_cache_reset();
+}
+
+static void test_latency(void)
+{
+	const p2p_connect_latency_t *cached, *negotiated;
+
+	p2p_group_cache_reset();
+
+	cached = p2p_group_cache_get_latency(TRUE);
+	negotiated = p2p_group_cache_get_latency(FALSE);
+
+	p2p_group_cache_record_latency(FALSE, 4200);
+	p2p_group_cache_record_latency(FALSE, 3800);
+	p2p_group_cache_record_latency(TRUE, 900);
+	p2p_group_cache_record_latency(TRUE, -1);
+
+	g_assert_cmpuint(negotiated->count, ==, 2);
+	g_assert_cmpint(negotiated->min_ms, ==, 3800);
+	g_assert_cmpint(negotiated->max_ms, ==, 4200);
+	g_assert_cmpint(negotiated->last_ms, ==, 3800);
+	g_assert_cmpint(negotiated->total_ms, ==, 8000);
+
+	g_assert_cmpuint(cached->count, ==, 1);
+	g_assert_cmpint(cached->min_ms, ==, 900);
+	g_assert_cmpint(cached->max_ms, ==, 900);
+
+	p2p_group_cache_reset();
+	g_assert_cmpuint(negotiated->count, ==, 0);
+}
+
+static void test_role(void)
+{
+	p2p_group_role_t role = P2P_GROUP_ROLE_CLIENT;
+
+	g_assert(p2p_group_role_from_string("owner", &role));
+	g_assert_cmpint(role, ==, P2P_GROUP_ROLE_OWNER);
+	g_assert_cmpstr(p2p_group_role_to_string(role), ==, "owner");
+	g_assert(p2p_group_role_from_string("client", &role));
+	g_assert_cmpint(role, ==, P2P_GROUP_ROLE_CLIENT);
+	g_assert(!p2p_group_role_from_string("go", &role));
+	g_assert(!p2p_group_role_from_string(NULL, &role));
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/p2p_group_cache/update", test_update);
+	g_test_add_func("/p2p_group_cache/order", test_order);
+	g_test_add_func("/p2p_group_cache/latency", test_latency);
+	g_test_add_func("/p2p_group_cache/role", test_role);
+
+	return g_test_run();
+}
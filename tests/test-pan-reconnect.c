@@ -0,0 +1,148 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "pan_reconnect.h"
+
+#define PHONE       "00:11:22:AA:BB:CC"
+#define OTHER       "00:11:22:DD:EE:FF"
+
+static void setup(void)
+{
+	pan_reconnect_reset();
+	pan_reconnect_set_policy(1000, 5000, 5);
+	pan_reconnect_set_jitter(0);
+}
+
+static void test_backoff(void)
+{
+	const pan_nap_t *nap;
+
+	setup();
+
+	/* Unknown NAPs aren't reconnected */
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 0), ==, -1);
+
+	pan_reconnect_connected("00:11:22:aa:bb:cc");
+	nap = pan_reconnect_get(PHONE);
+	g_assert(NULL != nap);
+	g_assert_cmpstr(nap->address, ==, PHONE);
+
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 0), ==, 1000);
+	g_assert_cmpint(nap->retry_at_ms, ==, 1000);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 1000), ==, 2000);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 3000), ==, 4000);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 7000), ==, 5000);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 12000), ==, 5000);
+	g_assert_cmpuint(nap->attempts, ==, 5);
+
+	/* Bounded by the maximum number of attempts */
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 17000), ==, -1);
+	g_assert(!nap->auto_reconnect);
+	g_assert_cmpint(nap->retry_at_ms, ==, -1);
+
+	/* Connecting again starts over */
+	pan_reconnect_connected(PHONE);
+	g_assert(nap->auto_reconnect);
+	g_assert_cmpuint(nap->attempts, ==, 0);
+	g_assert_cmpuint(nap->total_attempts, ==, 5);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 0), ==, 1000);
+
+	pan_reconnect_reset();
+}
+
+static void test_stop(void)
+{
+	setup();
+
+	pan_reconnect_connected(PHONE);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 0), ==, 1000);
+
+	/* Explicit disconnect */
+	pan_reconnect_stop(PHONE);
+	g_assert_cmpint(pan_reconnect_get(PHONE)->retry_at_ms, ==, -1);
+	g_assert_cmpint(pan_reconnect_schedule(PHONE, 0), ==, -1);
+
+	/* No attempts at all */
+	pan_reconnect_set_policy(1000, 5000, 0);
+	pan_reconnect_connected(OTHER);
+	g_assert_cmpint(pan_reconnect_schedule(OTHER, 0), ==, -1);
+
+	pan_reconnect_reset();
+}
+
+static void test_jitter(void)
+{
+	guint i;
+
+	setup();
+	pan_reconnect_set_policy(10000, 10000, 1000);
+	pan_reconnect_set_jitter(20);
+	pan_reconnect_connected(PHONE);
+
+	for (i = 0; i < 200; i++)
+	{
+		gint64 wait = pan_reconnect_schedule(PHONE, 0);
+
+		g_assert_cmpint(wait, >=, 8000);
+		g_assert_cmpint(wait, <=, 12000);
+	}
+
+	pan_reconnect_reset();
+}
+
+static void test_remembered(void)
+{
+	gchar address[18];
+	const GList *naps;
+	guint i;
+
+	setup();
+
+	for (i = 0; i < PAN_RECONNECT_MAX_NAPS + 2; i++)
+	{
+		g_snprintf(address, sizeof(address), "00:00:00:00:00:%02X", i);
+		pan_reconnect_connected(address);
+	}
+
+	/* Most recently connected first, the oldest are forgotten */
+	naps = pan_reconnect_get_naps();
+	g_assert_cmpuint(g_list_length((GList *) naps), ==, PAN_RECONNECT_MAX_NAPS);
+	g_assert_cmpstr(((pan_nap_t *) naps->data)->address, ==, address);
+	g_assert(NULL == pan_reconnect_get("00:00:00:00:00:00"));
+	g_assert(NULL == pan_reconnect_get("00:00:00:00:00:01"));
+
+	/* Reconnecting moves a NAP to the front */
+	pan_reconnect_connected("00:00:00:00:00:02");
+	naps = pan_reconnect_get_naps();
+	g_assert_cmpstr(((pan_nap_t *) naps->data)->address, ==, "00:00:00:00:00:02");
+	g_assert_cmpuint(g_list_length((GList *) naps), ==, PAN_RECONNECT_MAX_NAPS);
+
+	pan_reconnect_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/pan_reconnect/backoff", test_backoff);
+	g_test_add_func("/pan_reconnect/stop", test_stop);
+	g_test_add_func("/pan_reconnect/jitter", test_jitter);
+	g_test_add_func("/pan_reconnect/remembered", test_remembered);
+
+	return g_test_run();
+}
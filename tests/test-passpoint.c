@@ -0,0 +1,254 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "passpoint.h"
+
+static passpoint_credential_t *credential_new(const gchar *id,
+        const gchar *realm, const gchar *domain, const gchar *oi, gint priority)
+{
+	passpoint_credential_t *credential = passpoint_credential_new(id);
+
+	credential->realm = g_strdup(realm);
+	credential->domain = g_strdup(domain);
+	credential->eap_type = g_strdup("ttls");
+	credential->priority = priority;
+
+	if (NULL != oi)
+	{
+		credential->roaming_consortiums = g_strsplit(oi, ",", -1);
+	}
+
+	return credential;
+}
+
+static passpoint_bss_t *bss_new(const gchar *ssid, gint signal,
+                                const gchar *ois, const gchar *realms, const gchar *domains)
+{
+	passpoint_bss_t *bss = passpoint_bss_new();
+
+	bss->ssid = g_strdup(ssid);
+	bss->signal = signal;
+	bss->anqp.roaming_consortiums = NULL != ois ? g_strsplit(ois, ",", -1) : NULL;
+	bss->anqp.nai_realms = NULL != realms ? g_strsplit(realms, ",", -1) : NULL;
+	bss->anqp.domains = NULL != domains ? g_strsplit(domains, ",", -1) : NULL;
+
+	return bss;
+}
+
+static void test_valid(void)
+{
+	passpoint_credential_t *credential = credential_new("a", "example.com", NULL,
+	                                     "001bc504bd", 0);
+
+	g_assert(passpoint_oi_is_valid("506F9A"));
+	g_assert(passpoint_oi_is_valid("001bc504bd"));
+	g_assert(!passpoint_oi_is_valid("506F9"));
+	g_assert(!passpoint_oi_is_valid("506F9G"));
+	g_assert(!passpoint_oi_is_valid(NULL));
+
+	g_assert(passpoint_credential_is_valid(credential));
+
+	g_free(credential->realm);
+	credential->realm = NULL;
+	g_assert(!passpoint_credential_is_valid(credential));
+
+	credential->realm = g_strdup("example.com");
+	g_strfreev(credential->roaming_consortiums);
+	credential->roaming_consortiums = g_strsplit("001bc504bd,12", ",", -1);
+	g_assert(!passpoint_credential_is_valid(credential));
+
+	passpoint_credential_free(credential);
+}
+
+static void test_match(void)
+{
+	const passpoint_credential_t *credential;
+	passpoint_anqp_t anqp = { NULL };
+	gchar *none[] = { NULL };
+	gchar *ois[] = { "506f9a", "001BC504BD", NULL };
+	gchar *realms[] = { "other.net", "Example.COM", NULL };
+	gchar *domains[] = { "wlan.operator.org", NULL };
+	gchar *unrelated[] = { "operator.org.evil", NULL };
+
+	passpoint_reset();
+
+	passpoint_add_credential(credential_new("home", "example.com",
+	                                        "Operator.org", NULL, 0));
+	passpoint_add_credential(credential_new("roam", "roam.net", NULL,
+	                                        "001bc504bd", 5));
+
+	g_assert_cmpint(passpoint_match(&anqp, &credential), ==, PASSPOINT_MATCH_NONE);
+	g_assert(NULL == credential);
+
+	anqp.roaming_consortiums = ois;
+	g_assert_cmpint(passpoint_match(&anqp, &credential), ==,
+	                PASSPOINT_MATCH_ROAMING);
+	g_assert_cmpstr(credential->id, ==, "roam");
+
+	/* Both match by roaming, the priority decides */
+	anqp.nai_realms = realms;
+	g_assert_cmpint(passpoint_match(&anqp, &credential), ==,
+	                PASSPOINT_MATCH_ROAMING);
+	g_assert_cmpstr(credential->id, ==, "roam");
+
+	/* A home network wins over a higher priority */
+	anqp.domains = domains;
+	g_assert_cmpint(passpoint_match(&anqp, &credential), ==, PASSPOINT_MATCH_HOME);
+	g_assert_cmpstr(credential->id, ==, "home");
+
+	anqp.roaming_consortiums = none;
+	anqp.nai_realms = none;
+	anqp.domains = unrelated;
+	g_assert_cmpint(passpoint_match(&anqp, NULL), ==, PASSPOINT_MATCH_NONE);
+
+	/* Replacing a credential updates the index */
+	passpoint_add_credential(credential_new("roam", "roam.net", NULL, "506F9A",
+	                                        5));
+	anqp.roaming_consortiums = ois;
+	g_assert_cmpint(passpoint_match(&anqp, &credential), ==,
+	                PASSPOINT_MATCH_ROAMING);
+	g_assert_cmpstr(credential->id, ==, "roam");
+	g_assert_cmpstr(credential->roaming_consortiums[0], ==, "506F9A");
+	g_assert_cmpuint(g_list_length((GList *) passpoint_get_credentials()), ==, 2);
+
+	g_assert(passpoint_remove_credential("roam"));
+	g_assert(!passpoint_remove_credential("roam"));
+	g_assert_cmpint(passpoint_match(&anqp, NULL), ==, PASSPOINT_MATCH_NONE);
+
+	passpoint_reset();
+}
+
+static void test_parse_ies(void)
+{
+	static const guint8 ies[] =
+	{
+		/* SSID */
+		0, 4, 'h', 's', '2', '0',
+		/* Interworking */
+		107, 1, 0x02,
+		/* Roaming consortium: 3 octet OI, 5 octet OI, 3 octet OI */
+		111, 13, 0x00, 0x53, 0x50, 0x6f, 0x9a, 0x00, 0x1b, 0xc5, 0x04, 0xbd,
+		0x5a, 0x03, 0xba,
+		/* Hotspot 2.0 indication */
+		221, 5, 0x50, 0x6f, 0x9a, 0x10, 0x10,
+	};
+	passpoint_bss_t *bss = passpoint_bss_new();
+
+	g_assert(passpoint_parse_ies(ies, sizeof(ies), bss));
+	g_assert_cmpstr(bss->ssid, ==, "hs20");
+	g_assert(NULL != bss->anqp.roaming_consortiums);
+	g_assert_cmpuint(g_strv_length(bss->anqp.roaming_consortiums), ==, 3);
+	g_assert_cmpstr(bss->anqp.roaming_consortiums[0], ==, "506F9A");
+	g_assert_cmpstr(bss->anqp.roaming_consortiums[1], ==, "001BC504BD");
+	g_assert_cmpstr(bss->anqp.roaming_consortiums[2], ==, "5A03BA");
+	passpoint_bss_free(bss);
+
+	/* Truncated elements and no indication */
+	bss = passpoint_bss_new();
+	g_assert(!passpoint_parse_ies(ies, 20, bss));
+	g_assert_cmpstr(bss->ssid, ==, "hs20");
+	g_assert(NULL == bss->anqp.roaming_consortiums);
+	passpoint_bss_free(bss);
+}
+
+static void test_rank(void)
+{
+	GList *bsses = NULL, *ranked;
+	guint i;
+
+	passpoint_reset();
+
+	passpoint_add_credential(credential_new("home", "example.com",
+	                                        "example.com", NULL, 0));
+	passpoint_add_credential(credential_new("roam", "roam.net", NULL, "5A03BA",
+	                                        0));
+	passpoint_add_credential(credential_new("preferred", "pref.net", NULL,
+	                                        "506F9A", 10));
+
+	bsses = g_list_append(bsses, bss_new("weak-roam", -80, "5a03ba", NULL, NULL));
+	bsses = g_list_append(bsses, bss_new("strong-roam", -40, "5A03BA", NULL,
+	                                     NULL));
+	bsses = g_list_append(bsses, bss_new("preferred", -70, "506F9A", NULL, NULL));
+	bsses = g_list_append(bsses, bss_new("home", -85, NULL, NULL,
+	                                     "hotspot.example.com"));
+
+	/* Many unrelated BSSes, all dropped */
+	for (i = 0; i < 300; i++)
+	{
+		bsses = g_list_append(bsses, bss_new("other", -50, "000000", "other.net",
+		                                     "other.net"));
+	}
+
+	ranked = passpoint_rank(bsses);
+	g_assert_cmpuint(g_list_length(ranked), ==, 4);
+	g_assert_cmpstr(((passpoint_bss_t *) g_list_nth_data(ranked, 0))->ssid, ==,
+	                "home");
+	g_assert_cmpint(((passpoint_bss_t *) g_list_nth_data(ranked, 0))->match, ==,
+	                PASSPOINT_MATCH_HOME);
+	g_assert_cmpstr(((passpoint_bss_t *) g_list_nth_data(ranked, 1))->ssid, ==,
+	                "preferred");
+	g_assert_cmpstr(((passpoint_bss_t *) g_list_nth_data(ranked, 2))->ssid, ==,
+	                "strong-roam");
+	g_assert_cmpstr(((passpoint_bss_t *) g_list_nth_data(ranked, 3))->ssid, ==,
+	                "weak-roam");
+	g_assert_cmpstr(((passpoint_bss_t *) g_list_nth_data(ranked,
+	                 3))->credential->id, ==, "roam");
+
+	g_list_free_full(ranked, passpoint_bss_free);
+	passpoint_reset();
+}
+
+static void test_provisioned(void)
+{
+	GList *ssids;
+
+	passpoint_reset();
+
+	passpoint_set_provisioned("hs20", "a");
+	passpoint_set_provisioned("other", "b");
+	passpoint_set_provisioned("third", "a");
+	g_assert_cmpstr(passpoint_get_provisioned("hs20"), ==, "a");
+
+	ssids = passpoint_get_provisioned_ssids("a");
+	g_assert_cmpuint(g_list_length(ssids), ==, 2);
+	g_assert(NULL != g_list_find_custom(ssids, "third", (GCompareFunc) g_strcmp0));
+	g_list_free(ssids);
+
+	ssids = passpoint_get_provisioned_ssids(NULL);
+	g_assert_cmpuint(g_list_length(ssids), ==, 3);
+	g_list_free(ssids);
+
+	passpoint_set_provisioned("hs20", NULL);
+	g_assert(NULL == passpoint_get_provisioned("hs20"));
+
+	passpoint_reset();
+	g_assert(NULL == passpoint_get_provisioned("other"));
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/passpoint/valid", test_valid);
+	g_test_add_func("/passpoint/match", test_match);
+	g_test_add_func("/passpoint/parse_ies", test_parse_ies);
+	g_test_add_func("/passpoint/rank", test_rank);
+	g_test_add_func("/passpoint/provisioned", test_provisioned);
+
+	return g_test_run();
+}
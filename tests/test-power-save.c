@@ -0,0 +1,129 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "power_save.h"
+
+#define BUSY_BYTES      100000
+#define BUSY_PACKETS    100
+#define IDLE_HOLD_MS    3000
+
+static void test_modes(void)
+{
+	power_save_mode_t mode;
+
+	for (mode = 0; mode < POWER_SAVE_MODE_LAST; mode++)
+	{
+		g_assert_cmpint(power_save_mode_from_string(power_save_mode_to_string(mode)),
+		                ==, mode);
+	}
+
+	g_assert_cmpstr(power_save_mode_to_string(POWER_SAVE_MODE_ADAPTIVE), ==,
+	                "adaptive");
+	g_assert_cmpint(power_save_mode_from_string("sometimes"), ==,
+	                POWER_SAVE_MODE_LAST);
+	g_assert_cmpint(power_save_mode_from_string(NULL), ==, POWER_SAVE_MODE_LAST);
+}
+
+static void test_busy_idle(void)
+{
+	power_save_policy_t policy;
+
+	power_save_policy_init(&policy, BUSY_BYTES, BUSY_PACKETS, IDLE_HOLD_MS);
+	g_assert(policy.enabled);
+
+	/* The first sample is only the baseline */
+	g_assert(!power_save_policy_update(&policy, 5000000, 5000, 0));
+	g_assert(policy.enabled);
+
+	/* Below both thresholds */
+	g_assert(!power_save_policy_update(&policy, 5050000, 5050, 1000));
+	g_assert_cmpuint(policy.byte_rate, ==, 50000);
+	g_assert_cmpuint(policy.packet_rate, ==, 50);
+	g_assert(policy.enabled);
+
+	/* Byte rate above the threshold */
+	g_assert(power_save_policy_update(&policy, 5250000, 5100, 2000));
+	g_assert(!policy.enabled);
+	g_assert_cmpuint(policy.disable_count, ==, 1);
+
+	/* Staying busy doesn't count again */
+	g_assert(!power_save_policy_update(&policy, 5450000, 5150, 3000));
+
+	/* Idle, but not for long enough yet */
+	g_assert(!power_save_policy_update(&policy, 5450000, 5150, 4000));
+	g_assert(!power_save_policy_update(&policy, 5450000, 5150, 5000));
+	g_assert(!policy.enabled);
+
+	/* A burst restarts the hold time */
+	g_assert(!power_save_policy_update(&policy, 5450000, 5350, 6000));
+	g_assert(!power_save_policy_update(&policy, 5450000, 5350, 7000));
+	g_assert(!power_save_policy_update(&policy, 5450000, 5350, 8000));
+	g_assert(power_save_policy_update(&policy, 5450000, 5350, 9000));
+	g_assert(policy.enabled);
+
+	g_assert_cmpuint(policy.disable_count, ==, 1);
+	g_assert_cmpuint(policy.enable_count, ==, 1);
+}
+
+static void test_packet_rate(void)
+{
+	power_save_policy_t policy;
+
+	power_save_policy_init(&policy, BUSY_BYTES, BUSY_PACKETS, IDLE_HOLD_MS);
+
+	power_save_policy_update(&policy, 0, 0, 0);
+
+	/* Small packets, e.g. a game or a voice call, over 500 ms */
+	g_assert(power_save_policy_update(&policy, 6000, 60, 500));
+	g_assert_cmpuint(policy.byte_rate, ==, 12000);
+	g_assert_cmpuint(policy.packet_rate, ==, 120);
+	g_assert(!policy.enabled);
+}
+
+static void test_reset(void)
+{
+	power_save_policy_t policy;
+
+	power_save_policy_init(&policy, BUSY_BYTES, BUSY_PACKETS, IDLE_HOLD_MS);
+
+	power_save_policy_update(&policy, 1000000, 1000, 0);
+
+	/* Totals restart after a reconnect: no rate from that sample */
+	g_assert(!power_save_policy_update(&policy, 10, 1, 1000));
+	g_assert_cmpuint(policy.byte_rate, ==, 0);
+	g_assert(policy.enabled);
+
+	/* Samples without time passing are ignored */
+	g_assert(!power_save_policy_update(&policy, 500000, 500, 1000));
+	g_assert(policy.enabled);
+
+	g_assert(power_save_policy_update(&policy, 900000, 600, 2000));
+	g_assert(!policy.enabled);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/power_save/modes", test_modes);
+	g_test_add_func("/power_save/busy_idle", test_busy_idle);
+	g_test_add_func("/power_save/packet_rate", test_packet_rate);
+	g_test_add_func("/power_save/reset", test_reset);
+
+	return g_test_run();
+}
@@ -0,0 +1,286 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <glib.h>
+
+#include "profile_crypto.h"
+
+#define KEY             "com.webos.service.wifi"
+#define PROFILE         "{\"ssid\":\"Home network\",\"security\":[\"psk\"]," \
+                        "\"wasCreatedWithJoinOther\":false,\"configured\":true}"
+
+/* Size of a store with many profiles, as seen on long running devices */
+#define BENCH_PROFILES  500
+#define BENCH_ROUNDS    20
+
+static void test_roundtrip(void)
+{
+	gchar *blob = profile_crypto_encrypt(PROFILE, KEY);
+	gchar *other = profile_crypto_encrypt(PROFILE, KEY);
+	gchar *plaintext;
+	gboolean legacy = TRUE;
+	GError *error = NULL;
+
+	g_assert(blob != NULL);
+	g_assert(blob[0] == PROFILE_CRYPTO_PREFIX);
+	g_assert(!profile_crypto_is_legacy(blob));
+
+	/* A fresh nonce each time */
+	g_assert_cmpstr(blob, !=, other);
+
+	plaintext = profile_crypto_decrypt(blob, KEY, &legacy, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(plaintext, ==, PROFILE);
+	g_assert(!legacy);
+
+	g_free(plaintext);
+	g_free(other);
+	g_free(blob);
+}
+
+/**
+ * @brief Profiles stored by older versions still decrypt, and are flagged
+ * for migration.
+ */
+
+static void test_legacy(void)
+{
+	gchar *blob = profile_crypto_encrypt_legacy(PROFILE, KEY);
+	gchar *plaintext, *migrated;
+	gboolean legacy = FALSE;
+	GError *error = NULL;
+
+	g_assert(profile_crypto_is_legacy(blob));
+	g_assert(strchr(blob, PROFILE_CRYPTO_PREFIX) == NULL);
+
+	plaintext = profile_crypto_decrypt(blob, KEY, &legacy, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(plaintext, ==, PROFILE);
+	g_assert(legacy);
+
+	migrated = profile_crypto_encrypt(plaintext, KEY);
+	g_free(plaintext);
+
+	plaintext = profile_crypto_decrypt(migrated, KEY, &legacy, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(plaintext, ==, PROFILE);
+	g_assert(!legacy);
+
+	g_free(plaintext);
+	g_free(migrated);
+	g_free(blob);
+}
+
+static void assert_rejected(const gchar *blob, const gchar *key, gint code)
+{
+	GError *error = NULL;
+	gchar *plaintext = profile_crypto_decrypt(blob, key, NULL, &error);
+
+	g_assert(plaintext == NULL);
+	g_assert_error(error, PROFILE_CRYPTO_ERROR, code);
+	g_error_free(error);
+}
+
+static gchar *reencode(const guchar *buf, gsize len)
+{
+	gchar *encoded = g_base64_encode(buf, len);
+	gchar *blob = g_strdup_printf("%c%s", PROFILE_CRYPTO_PREFIX, encoded);
+
+	g_free(encoded);
+	return blob;
+}
+
+/**
+ * @brief Tampered or corrupt profiles are rejected instead of being handed
+ * on as garbage.
+ */
+
+static void test_tampered(void)
+{
+	gchar *blob = profile_crypto_encrypt(PROFILE, KEY);
+	guchar *buf;
+	gsize len, n;
+	gchar *tampered;
+
+	buf = g_base64_decode(blob + 1, &len);
+
+	/* Any flipped bit, in the header, nonce, ciphertext or tag */
+	for (n = 0; n < len; n++)
+	{
+		buf[n] ^= 0x01;
+		tampered = reencode(buf, len);
+		assert_rejected(tampered, KEY, n == 0 ? PROFILE_CRYPTO_ERROR_VERSION :
+		                PROFILE_CRYPTO_ERROR_AUTH);
+		g_free(tampered);
+		buf[n] ^= 0x01;
+	}
+
+	/* Truncated */
+	tampered = reencode(buf, len - 1);
+	assert_rejected(tampered, KEY, PROFILE_CRYPTO_ERROR_AUTH);
+	g_free(tampered);
+
+	tampered = reencode(buf, 8);
+	assert_rejected(tampered, KEY, PROFILE_CRYPTO_ERROR_FORMAT);
+	g_free(tampered);
+
+	/* Written by a newer version */
+	buf[0] = PROFILE_CRYPTO_VERSION + 1;
+	tampered = reencode(buf, len);
+	assert_rejected(tampered, KEY, PROFILE_CRYPTO_ERROR_VERSION);
+	g_free(tampered);
+
+	/* Wrong key */
+	assert_rejected(blob, "com.webos.service.other", PROFILE_CRYPTO_ERROR_AUTH);
+
+	assert_rejected("$", KEY, PROFILE_CRYPTO_ERROR_FORMAT);
+	assert_rejected("$!!!!", KEY, PROFILE_CRYPTO_ERROR_FORMAT);
+
+	g_free(buf);
+	g_free(blob);
+}
+
+/**
+ * @brief Legacy profiles which don't decrypt to text are rejected.
+ */
+
+static void test_legacy_corrupt(void)
+{
+	static const guchar garbage[] = { 0x00, 0x13, 0x37, 0xff, 0xfe, 0x01, 0x02, 0x03 };
+	gchar *blob = profile_crypto_encrypt_legacy(PROFILE, KEY);
+	gchar *corrupt = g_base64_encode(garbage, sizeof(garbage));
+
+	assert_rejected(corrupt, KEY, PROFILE_CRYPTO_ERROR_LEGACY);
+	assert_rejected("", KEY, PROFILE_CRYPTO_ERROR_FORMAT);
+
+	/* The legacy format decrypts to garbage with the wrong key */
+	assert_rejected(blob, "com.webos.service.other", PROFILE_CRYPTO_ERROR_LEGACY);
+
+	g_free(corrupt);
+	g_free(blob);
+}
+
+static gdouble bench(gboolean legacy, gboolean decrypt, gchar **profiles,
+                     gsize *bytes)
+{
+	gchar *blobs[BENCH_PROFILES];
+	GTimer *timer = g_timer_new();
+	gdouble elapsed = 0;
+	guint round, n;
+
+	*bytes = 0;
+
+	for (round = 0; round < BENCH_ROUNDS; round++)
+	{
+		g_timer_start(timer);
+
+		for (n = 0; n < BENCH_PROFILES; n++)
+		{
+			blobs[n] = legacy ? profile_crypto_encrypt_legacy(profiles[n], KEY) :
+			           profile_crypto_encrypt(profiles[n], KEY);
+		}
+
+		if (decrypt)
+		{
+			g_timer_start(timer);
+
+			for (n = 0; n < BENCH_PROFILES; n++)
+			{
+				gchar *plaintext = profile_crypto_decrypt(blobs[n], KEY, NULL, NULL);
+
+				g_assert(plaintext != NULL);
+				g_free(plaintext);
+			}
+		}
+
+		elapsed += g_timer_elapsed(timer, NULL);
+
+		for (n = 0; n < BENCH_PROFILES; n++)
+		{
+			*bytes += strlen(profiles[n]);
+			g_free(blobs[n]);
+		}
+	}
+
+	g_timer_destroy(timer);
+	return elapsed;
+}
+
+/**
+ * @brief Throughput of storing and loading a store of 500 profiles, in the
+ * current and the legacy format. Only run with -m perf.
+ */
+
+static void test_benchmark(void)
+{
+	static const struct
+	{
+		const gchar *name;
+		gboolean legacy;
+		gboolean decrypt;
+	} runs[] =
+	{
+		{ "AES-256-GCM encrypt", FALSE, FALSE },
+		{ "AES-256-GCM decrypt", FALSE, TRUE },
+		{ "Blowfish CFB64 encrypt", TRUE, FALSE },
+		{ "Blowfish CFB64 decrypt", TRUE, TRUE },
+	};
+	gchar *profiles[BENCH_PROFILES];
+	guint n;
+
+	if (!g_test_perf())
+	{
+		g_test_skip("Run with -m perf");
+		return;
+	}
+
+	for (n = 0; n < BENCH_PROFILES; n++)
+	{
+		profiles[n] = g_strdup_printf("{\"ssid\":\"Network %u\",\"security\":[\"psk\"],"
+		                              "\"wasCreatedWithJoinOther\":false,\"configured\":true,"
+		                              "\"passphrase\":\"passphrase-of-network-%u\"}", n, n);
+	}
+
+	for (n = 0; n < G_N_ELEMENTS(runs); n++)
+	{
+		gsize bytes;
+		gdouble elapsed = bench(runs[n].legacy, runs[n].decrypt, profiles, &bytes);
+
+		g_test_minimized_result(elapsed * 1000 / BENCH_ROUNDS,
+		                        "%s: %.3f ms per %u profiles, %.1f MB/s", runs[n].name,
+		                        elapsed * 1000 / BENCH_ROUNDS, BENCH_PROFILES,
+		                        bytes / elapsed / (1024 * 1024));
+	}
+
+	for (n = 0; n < BENCH_PROFILES; n++)
+	{
+		g_free(profiles[n]);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/profile_crypto/roundtrip", test_roundtrip);
+	g_test_add_func("/profile_crypto/legacy", test_legacy);
+	g_test_add_func("/profile_crypto/tampered", test_tampered);
+	g_test_add_func("/profile_crypto/legacy_corrupt", test_legacy_corrupt);
+	g_test_add_func("/profile_crypto/benchmark", test_benchmark);
+
+	return g_test_run();
+}
@@ -0,0 +1,261 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <glib.h>
+
+#include "profile_namespace.h"
+
+/* Profiles are opaque to the namespaces, .config keys will do */
+static gchar *key_cb(gpointer profile)
+{
+	const gchar *key = profile;
+
+	/* Profiles starting with '-' have no .config file */
+	return '-' == key[0] ? NULL : g_strdup(key);
+}
+
+static void add(profile_namespace_t *ns, const gchar *key)
+{
+	ns->profiles = g_slist_append(ns->profiles, (gpointer) key);
+}
+
+static gboolean contains(GSList *keys, const gchar *key)
+{
+	return NULL != g_slist_find_custom(keys, key, (GCompareFunc) g_strcmp0);
+}
+
+static void test_names(void)
+{
+	g_assert(profile_namespace_is_valid_name("device"));
+	g_assert(profile_namespace_is_valid_name("user.name@example.com"));
+	g_assert(profile_namespace_is_valid_name("account_1-2"));
+
+	g_assert(!profile_namespace_is_valid_name(NULL));
+	g_assert(!profile_namespace_is_valid_name(""));
+	g_assert(!profile_namespace_is_valid_name("."));
+	g_assert(!profile_namespace_is_valid_name(".."));
+	g_assert(!profile_namespace_is_valid_name("../etc"));
+	g_assert(!profile_namespace_is_valid_name("a/b"));
+	g_assert(!profile_namespace_is_valid_name("a b"));
+	g_assert(!profile_namespace_is_valid_name(
+	             "0123456789012345678901234567890123456789012345678901234567890123456789"));
+}
+
+static void test_lifecycle(void)
+{
+	profile_namespace_t *device, *alice;
+	GList *all;
+
+	profile_namespace_reset();
+
+	device = profile_namespace_get_device();
+	g_assert_cmpstr(device->name, ==, PROFILE_NAMESPACE_DEVICE);
+	g_assert(profile_namespace_get_active() == device);
+	g_assert(profile_namespace_lookup("alice") == NULL);
+	g_assert(profile_namespace_ensure("a/b") == NULL);
+
+	alice = profile_namespace_ensure("alice");
+	g_assert(alice != NULL);
+	g_assert(profile_namespace_ensure("alice") == alice);
+	g_assert(profile_namespace_lookup("alice") == alice);
+
+	all = profile_namespace_get_all();
+	g_assert(g_list_length(all) == 2);
+	g_assert(all->data == alice);
+	g_list_free(all);
+
+	g_assert(profile_namespace_set_active(alice) == device);
+	g_assert(profile_namespace_get_active() == alice);
+
+	/* Only empty namespaces other than the device one can be removed */
+	g_assert(!profile_namespace_remove(device));
+	add(alice, "home");
+	g_assert(!profile_namespace_remove(alice));
+	g_slist_free(alice->profiles);
+	alice->profiles = NULL;
+
+	g_assert(profile_namespace_remove(alice));
+	g_assert(profile_namespace_lookup("alice") == NULL);
+	g_assert(profile_namespace_get_active() == device);
+}
+
+/**
+ * @brief The profiles of the active namespace are visible in front of the
+ * shared ones, and switching changes what is visible.
+ */
+
+static void test_visible(void)
+{
+	profile_namespace_t *device, *alice, *bob;
+	gpointer profile;
+
+	profile_namespace_reset();
+	device = profile_namespace_get_device();
+	alice = profile_namespace_ensure("alice");
+	bob = profile_namespace_ensure("bob");
+
+	/* Nothing visible */
+	g_assert(profile_namespace_next_visible(NULL) == NULL);
+
+	add(device, "lobby");
+	add(device, "guest");
+	add(alice, "alice-home");
+	add(bob, "bob-home");
+	add(bob, "bob-work");
+
+	profile = profile_namespace_next_visible(NULL);
+	g_assert_cmpstr(profile, ==, "lobby");
+	profile = profile_namespace_next_visible(profile);
+	g_assert_cmpstr(profile, ==, "guest");
+	g_assert(profile_namespace_next_visible(profile) == NULL);
+
+	profile_namespace_set_active(bob);
+	profile = profile_namespace_next_visible(NULL);
+	g_assert_cmpstr(profile, ==, "bob-home");
+	profile = profile_namespace_next_visible(profile);
+	g_assert_cmpstr(profile, ==, "bob-work");
+	profile = profile_namespace_next_visible(profile);
+	g_assert_cmpstr(profile, ==, "lobby");
+	profile = profile_namespace_next_visible(profile);
+	g_assert_cmpstr(profile, ==, "guest");
+	g_assert(profile_namespace_next_visible(profile) == NULL);
+
+	/* Profiles of other namespaces aren't visible */
+	g_assert(profile_namespace_next_visible(alice->profiles->data) == NULL);
+	g_assert(profile_namespace_find(alice->profiles->data) == alice);
+	g_assert(profile_namespace_find(bob->profiles->data) == bob);
+	g_assert(profile_namespace_find("unknown") == NULL);
+
+	/* An empty active namespace shows the shared profiles only */
+	profile_namespace_set_active(profile_namespace_ensure("carol"));
+	profile = profile_namespace_next_visible(NULL);
+	g_assert_cmpstr(profile, ==, "lobby");
+
+	g_slist_free(device->profiles);
+	device->profiles = NULL;
+	g_slist_free(alice->profiles);
+	alice->profiles = NULL;
+	g_slist_free(bob->profiles);
+	bob->profiles = NULL;
+}
+
+/**
+ * @brief Only the .config files which differ between two namespaces are
+ * moved on a switch.
+ */
+
+static void test_diff(void)
+{
+	profile_namespace_t *device, *alice, *bob;
+	GSList *stash, *restore, *both;
+
+	profile_namespace_reset();
+	device = profile_namespace_get_device();
+	alice = profile_namespace_ensure("alice");
+	bob = profile_namespace_ensure("bob");
+
+	add(device, "lobby");
+	add(device, "-open");
+	add(alice, "alice-home");
+	add(alice, "office");
+	add(alice, "lobby");        /* Shadowed by the device namespace */
+	add(alice, "-cafe");
+	add(bob, "bob-home");
+	add(bob, "office");
+
+	profile_namespace_diff(alice, bob, key_cb, &stash, &restore, &both);
+	g_assert(g_slist_length(stash) == 1 && contains(stash, "alice-home"));
+	g_assert(g_slist_length(restore) == 1 && contains(restore, "bob-home"));
+	g_assert(g_slist_length(both) == 1 && contains(both, "office"));
+	g_slist_free_full(stash, g_free);
+	g_slist_free_full(restore, g_free);
+	g_slist_free_full(both, g_free);
+
+	/* From the device namespace, the user's files are restored */
+	profile_namespace_diff(device, alice, key_cb, &stash, &restore, &both);
+	g_assert(stash == NULL && both == NULL);
+	g_assert(g_slist_length(restore) == 2);
+	g_assert(contains(restore, "alice-home") && contains(restore, "office"));
+	g_slist_free_full(restore, g_free);
+
+	/* Back to the device namespace, they are stashed */
+	profile_namespace_diff(bob, device, key_cb, &stash, &restore, &both);
+	g_assert(restore == NULL && both == NULL);
+	g_assert(g_slist_length(stash) == 2);
+	g_slist_free_full(stash, g_free);
+
+	profile_namespace_diff(bob, bob, key_cb, &stash, &restore, &both);
+	g_assert(stash == NULL && restore == NULL && both == NULL);
+
+	g_slist_free(device->profiles);
+	device->profiles = NULL;
+	g_slist_free(alice->profiles);
+	alice->profiles = NULL;
+	g_slist_free(bob->profiles);
+	bob->profiles = NULL;
+}
+
+/**
+ * @brief Switching is independent of the number of stored profiles.
+ */
+
+static void test_switch_cost(void)
+{
+	profile_namespace_t *alice, *bob;
+	gint64 start;
+	guint n;
+
+	profile_namespace_reset();
+	alice = profile_namespace_ensure("alice");
+	bob = profile_namespace_ensure("bob");
+
+	for (n = 0; n < 10000; n++)
+	{
+		alice->profiles = g_slist_prepend(alice->profiles, "alice");
+		bob->profiles = g_slist_prepend(bob->profiles, "bob");
+	}
+
+	start = g_get_monotonic_time();
+
+	for (n = 0; n < 100000; n++)
+	{
+		profile_namespace_set_active(n % 2 ? bob : alice);
+	}
+
+	g_assert_cmpstr(profile_namespace_next_visible(NULL), ==, "bob");
+
+	/* A reload would walk 20000 profiles per switch */
+	g_assert(g_get_monotonic_time() - start < G_USEC_PER_SEC);
+
+	g_slist_free(alice->profiles);
+	alice->profiles = NULL;
+	g_slist_free(bob->profiles);
+	bob->profiles = NULL;
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/profile_namespace/names", test_names);
+	g_test_add_func("/profile_namespace/lifecycle", test_lifecycle);
+	g_test_add_func("/profile_namespace/visible", test_visible);
+	g_test_add_func("/profile_namespace/diff", test_diff);
+	g_test_add_func("/profile_namespace/switch_cost", test_switch_cost);
+
+	return g_test_run();
+}
@@ -0,0 +1,175 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "regulatory.h"
+
+/* One scan with a BSS per radio of each country listed */
+static const gchar *scan(const gchar *countries)
+{
+	gchar **codes = g_strsplit(countries, ",", -1);
+	gchar bssid[18];
+	guint i;
+
+	for (i = 0; NULL != codes[i]; i++)
+	{
+		g_snprintf(bssid, sizeof(bssid), "00:11:22:33:%02X:01", i);
+		regulatory_add_bss(bssid, codes[i]);
+	}
+
+	g_strfreev(codes);
+	return regulatory_end_scan();
+}
+
+static void test_parse(void)
+{
+	static const guint8 ies[] =
+	{
+		0, 2, 'a', 'p',
+		7, 6, 'd', 'e', ' ', 1, 13, 20,
+	};
+	static const guint8 placeholder[] = { 7, 3, 'X', 'X', ' ' };
+	gchar country[3];
+
+	g_assert(regulatory_parse_country_ie(ies, sizeof(ies), country));
+	g_assert_cmpstr(country, ==, "DE");
+
+	g_assert(!regulatory_parse_country_ie(ies, 4, country));
+	g_assert(!regulatory_parse_country_ie(ies, sizeof(ies) - 1, country));
+	g_assert(!regulatory_parse_country_ie(placeholder, sizeof(placeholder),
+	                                      country));
+}
+
+static void test_confirm(void)
+{
+	const regulatory_status_t *status = regulatory_get_status();
+
+	regulatory_reset();
+	g_assert_cmpstr(status->applied, ==, REGULATORY_WORLD);
+
+	g_assert(NULL == scan("US,US,US,DE"));
+	g_assert_cmpstr(status->inferred, ==, "US");
+	g_assert_cmpuint(status->confidence, ==, 75);
+	g_assert_cmpuint(status->votes, ==, 4);
+
+	/* Too few votes neither confirm nor reset the proposal */
+	g_assert(NULL == scan("US,US"));
+	g_assert_cmpstr(status->inferred, ==, "");
+	g_assert(NULL == scan("us,US,US"));
+	g_assert_cmpuint(status->confirmations, ==, 2);
+	g_assert_cmpstr(scan("US,US,US"), ==, "US");
+
+	/* Proposed until the caller managed to apply it */
+	g_assert_cmpstr(status->applied, ==, REGULATORY_WORLD);
+	g_assert_cmpstr(scan("US,US,US"), ==, "US");
+	regulatory_confirm_applied("US");
+	g_assert_cmpstr(status->applied, ==, "US");
+
+	/* Nothing to do while the applied country keeps winning */
+	g_assert(NULL == scan("US,US,US,US"));
+	g_assert_cmpuint(status->confirmations, ==, 0);
+
+	regulatory_reset();
+}
+
+static void test_rogue(void)
+{
+	const regulatory_status_t *status = regulatory_get_status();
+	const gchar *country = NULL;
+	gchar bssid[18];
+	guint i, round;
+
+	regulatory_reset();
+
+	for (round = 0; round < REGULATORY_CONFIRM_SCANS; round++)
+	{
+		regulatory_add_bss("00:11:22:33:00:01", "FR");
+		regulatory_add_bss("00:11:22:33:01:01", "FR");
+		regulatory_add_bss("00:11:22:33:02:01", "FR");
+
+		/* A rogue access point with many virtual BSSes votes once */
+		for (i = 0; i < 16; i++)
+		{
+			g_snprintf(bssid, sizeof(bssid), "%02X:AA:BB:CC:DD:%02X", 0x02 | (i << 4), i);
+			regulatory_add_bss(bssid, "JP");
+		}
+
+		country = regulatory_end_scan();
+		g_assert_cmpuint(status->votes, ==, 4);
+	}
+
+	g_assert_cmpstr(country, ==, "FR");
+	regulatory_confirm_applied(country);
+	g_assert_cmpstr(status->applied, ==, "FR");
+
+	/* A single scan elsewhere doesn't move the domain */
+	g_assert(NULL == scan("JP,JP,JP,JP"));
+	g_assert(NULL == scan("FR,FR,FR"));
+	g_assert_cmpuint(status->confirmations, ==, 0);
+	g_assert_cmpstr(status->applied, ==, "FR");
+
+	regulatory_reset();
+}
+
+static void test_fallback(void)
+{
+	const regulatory_status_t *status = regulatory_get_status();
+	guint i;
+
+	regulatory_reset();
+
+	for (i = 0; i < REGULATORY_CONFIRM_SCANS; i++)
+	{
+		scan("GB,GB,GB");
+	}
+
+	regulatory_confirm_applied("GB");
+	g_assert_cmpstr(status->applied, ==, "GB");
+
+	/* Scans disagreeing without a clear winner */
+	for (i = 0; i < REGULATORY_FALLBACK_SCANS - 1; i++)
+	{
+		g_assert(NULL == scan("GB,GB,IE,IE"));
+		g_assert_cmpuint(status->confidence, ==, 50);
+	}
+
+	g_assert_cmpstr(scan("GB,IE,IE,GB"), ==, REGULATORY_WORLD);
+	g_assert_cmpstr(status->applied, ==, "GB");
+	g_assert_cmpstr(scan("GB,IE,IE,GB"), ==, REGULATORY_WORLD);
+	regulatory_confirm_applied(REGULATORY_WORLD);
+	g_assert_cmpstr(status->applied, ==, REGULATORY_WORLD);
+
+	/* No fallback from the world domain */
+	for (i = 0; i < REGULATORY_FALLBACK_SCANS; i++)
+	{
+		g_assert(NULL == scan("GB,IE,XX,,GBR"));
+	}
+
+	regulatory_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/regulatory/parse", test_parse);
+	g_test_add_func("/regulatory/confirm", test_confirm);
+	g_test_add_func("/regulatory/rogue", test_rogue);
+	g_test_add_func("/regulatory/fallback", test_fallback);
+
+	return g_test_run();
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+#include <string.h>
+
+#include "runtime_params.h"
+
+static guint num_changes = 0;
+
+static void changed(const runtime_param_change_t *change, gpointer user_data)
+{
+	num_changes++;
+}
+
+static void test_defaults(void)
+{
+	runtime_param_t param;
+	guint default_value, min, max;
+
+	runtime_params_reset();
+
+	for (param = 0; param < RUNTIME_PARAM_LAST; param++)
+	{
+		runtime_param_t found;
+
+		runtime_param_get_limits(param, &default_value, &min, &max);
+		g_assert(runtime_param_get(param) == default_value);
+		g_assert(min <= default_value && default_value <= max);
+
+		g_assert(runtime_param_lookup(runtime_param_get_name(param), &found));
+		g_assert(found == param);
+	}
+
+	g_assert(runtime_param_get(RUNTIME_PARAM_SCAN_MIN_INTERVAL) == 1000);
+	g_assert_cmpstr(runtime_param_get_unit(RUNTIME_PARAM_SCAN_MIN_INTERVAL), ==,
+	                "ms");
+	g_assert(!runtime_param_lookup("noSuchParameter", &param));
+}
+
+/**
+ * @brief Values out of range are rejected and only actual changes are logged.
+ */
+
+static void test_set(void)
+{
+	guint min, max;
+	GList *log;
+
+	runtime_params_reset();
+	num_changes = 0;
+	runtime_params_set_changed_callback(changed, NULL);
+
+	runtime_param_get_limits(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL, NULL, &min, &max);
+
+	g_assert(!runtime_param_set(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL, max + 1,
+	                            "test"));
+	g_assert(!runtime_param_set(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL, -1, "test"));
+	g_assert(runtime_param_get(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL) == 3);
+
+	g_assert(runtime_param_set(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL, 10, "test"));
+	g_assert(runtime_param_set(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL, 10, "test"));
+	g_assert(runtime_param_get(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL) == 10);
+	g_assert(num_changes == 1);
+
+	log = runtime_params_get_change_log();
+	g_assert(g_list_length(log) == 1);
+
+	runtime_param_change_t *change = log->data;
+	g_assert(change->param == RUNTIME_PARAM_SIGNAL_POLL_INTERVAL);
+	g_assert(change->old_value == 3);
+	g_assert(change->new_value == 10);
+	g_assert_cmpstr(change->source, ==, "test");
+
+	runtime_params_set_changed_callback(NULL, NULL);
+}
+
+/**
+ * @brief The change log keeps the latest changes only.
+ */
+
+static void test_change_log(void)
+{
+	guint n;
+	GList *log;
+
+	runtime_params_reset();
+
+	for (n = 0; n < RUNTIME_PARAMS_CHANGE_LOG_LEN + 5; n++)
+	{
+		g_assert(runtime_param_set(RUNTIME_PARAM_SCAN_MIN_INTERVAL, 2000 + n,
+		                           "test"));
+	}
+
+	log = runtime_params_get_change_log();
+	g_assert(g_list_length(log) == RUNTIME_PARAMS_CHANGE_LOG_LEN);
+	g_assert(((runtime_param_change_t *) log->data)->new_value == 2005);
+	g_assert(((runtime_param_change_t *) g_list_last(log)->data)->new_value ==
+	         2000 + RUNTIME_PARAMS_CHANGE_LOG_LEN + 4);
+
+	runtime_params_reset();
+	g_assert(runtime_params_get_change_log() == NULL);
+	g_assert(runtime_param_get(RUNTIME_PARAM_SCAN_MIN_INTERVAL) == 1000);
+}
+
+/**
+ * @brief Valid entries of a config file are applied even if others are invalid.
+ */
+
+static void test_load(void)
+{
+	const gchar *config =
+	    "[Parameters]\n"
+	    "scanMinInterval=5000\n"
+	    "profileDeleteDelay=10\n";
+	const gchar *invalid =
+	    "[Parameters]\n"
+	    "signalPollInterval=1000\n"
+	    "noSuchParameter=1\n"
+	    "internetStatusTimeout=abc\n"
+	    "gatewayProbeTimeout=200\n";
+	GError *error = NULL;
+
+	runtime_params_reset();
+
+	g_assert(runtime_params_load_data(config, strlen(config), "test", &error));
+	g_assert(error == NULL);
+	g_assert(runtime_param_get(RUNTIME_PARAM_SCAN_MIN_INTERVAL) == 5000);
+	g_assert(runtime_param_get(RUNTIME_PARAM_PROFILE_DELETE_DELAY) == 10);
+
+	g_assert(!runtime_params_load_data(invalid, strlen(invalid), "test", &error));
+	g_assert(error != NULL);
+	g_assert(error->domain == RUNTIME_PARAMS_ERROR);
+	g_clear_error(&error);
+
+	/* Parameters not mentioned keep their value */
+	g_assert(runtime_param_get(RUNTIME_PARAM_SCAN_MIN_INTERVAL) == 5000);
+	g_assert(runtime_param_get(RUNTIME_PARAM_SIGNAL_POLL_INTERVAL) == 3);
+	g_assert(runtime_param_get(RUNTIME_PARAM_INTERNET_STATUS_TIMEOUT) == 1);
+	g_assert(runtime_param_get(RUNTIME_PARAM_GATEWAY_PROBE_TIMEOUT) == 200);
+
+	g_assert(!runtime_params_load_data("no key file", 11, "test", &error));
+	g_clear_error(&error);
+
+	runtime_params_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/runtime_params/defaults", test_defaults);
+	g_test_add_func("/runtime_params/set", test_set);
+	g_test_add_func("/runtime_params/change_log", test_change_log);
+	g_test_add_func("/runtime_params/load", test_load);
+
+	return g_test_run();
+}
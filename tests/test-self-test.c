@@ -0,0 +1,325 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <glib.h>
+
+#include "self_test.h"
+
+#define DURATION_MS     300
+
+/* Loopback chargen, discard or echo server running in a thread */
+typedef struct server
+{
+	int fd;
+	int type;
+	guint16 port;
+	gint stop;
+	GThread *thread;
+} server_t;
+
+typedef struct result
+{
+	GMainLoop *loop;
+	self_test_result_t result;
+	gchar *error;
+	guint calls;
+} result_t;
+
+static void serve_stream(server_t *server, int fd, gboolean chargen)
+{
+	guint8 buf[16384];
+
+	memset(buf, 'x', sizeof(buf));
+
+	while (!g_atomic_int_get(&server->stop))
+	{
+		ssize_t len = chargen ? send(fd, buf, sizeof(buf), MSG_NOSIGNAL) :
+		              recv(fd, buf, sizeof(buf), 0);
+
+		/* The receive timeout is inherited from the listening socket */
+		if (len < 0 && EAGAIN == errno)
+		{
+			continue;
+		}
+
+		if (len <= 0)
+		{
+			break;
+		}
+	}
+}
+
+static gpointer server_thread(gpointer user_data)
+{
+	server_t *server = user_data;
+	struct sockaddr_in peer;
+	socklen_t peer_len;
+	guint8 buf[512];
+	ssize_t len;
+	int fd;
+
+	while (!g_atomic_int_get(&server->stop))
+	{
+		peer_len = sizeof(peer);
+
+		if (SOCK_DGRAM == server->type)
+		{
+			len = recvfrom(server->fd, buf, sizeof(buf), 0, (struct sockaddr *) &peer,
+			               &peer_len);
+
+			if (len > 0)
+			{
+				sendto(server->fd, buf, len, 0, (struct sockaddr *) &peer, peer_len);
+			}
+
+			continue;
+		}
+
+		fd = accept(server->fd, (struct sockaddr *) &peer, &peer_len);
+
+		if (fd < 0 && EAGAIN == errno)
+		{
+			continue;
+		}
+
+		if (fd < 0)
+		{
+			break;
+		}
+
+		serve_stream(server, fd, SELF_TEST_CHARGEN_PORT == server->port);
+		close(fd);
+	}
+
+	return NULL;
+}
+
+static guint16 server_start(server_t *server, int type, guint16 service)
+{
+	struct sockaddr_in addr;
+	socklen_t addr_len = sizeof(addr);
+	struct timeval timeout = { 0, 50000 };
+
+	memset(server, 0, sizeof(*server));
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	server->type = type;
+	server->fd = socket(AF_INET, type, 0);
+	g_assert(server->fd >= 0);
+	g_assert(bind(server->fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+	g_assert(SOCK_DGRAM == type || listen(server->fd, 1) == 0);
+	setsockopt(server->fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	/* The service is told apart by the well known port it stands in for */
+	server->port = service;
+	server->thread = g_thread_new("server", server_thread, server);
+
+	getsockname(server->fd, (struct sockaddr *) &addr, &addr_len);
+	return ntohs(addr.sin_port);
+}
+
+static void server_stop(server_t *server)
+{
+	g_atomic_int_set(&server->stop, TRUE);
+	shutdown(server->fd, SHUT_RDWR);
+	g_thread_join(server->thread);
+	close(server->fd);
+}
+
+static void test_done(const self_test_result_t *test_result, gpointer user_data)
+{
+	result_t *result = user_data;
+
+	result->result = *test_result;
+	result->error = g_strdup(test_result->error);
+	result->calls++;
+	g_main_loop_quit(result->loop);
+}
+
+static void test_stats(void)
+{
+	gdouble samples[] = { 50, 10, 40, 20, 30 };
+	gdouble rtts[] = { 10, 12, 11, 15 };
+	gdouble one[] = { 7 };
+
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 50), ==, 30);
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 10), ==, 10);
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 90), ==, 50);
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 40), ==, 20);
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 0), ==, 10);
+	g_assert_cmpfloat(self_test_percentile(samples, 5, 100), ==, 50);
+	g_assert_cmpfloat(self_test_percentile(one, 1, 90), ==, 7);
+	g_assert_cmpfloat(self_test_percentile(NULL, 0, 50), ==, 0);
+
+	/* (2 + 1 + 4) / 3 */
+	g_assert_cmpfloat(self_test_jitter(rtts, 4), ==, 7.0 / 3);
+	g_assert_cmpfloat(self_test_jitter(rtts, 1), ==, 0);
+}
+
+static void test_run(void)
+{
+	server_t chargen, discard, echo;
+	self_test_params_t params = { 0 };
+	result_t result = { 0 };
+	const self_test_throughput_t *throughput;
+
+	params.host = "127.0.0.1";
+	params.download_port = server_start(&chargen, SOCK_STREAM, SELF_TEST_CHARGEN_PORT);
+	params.upload_port = server_start(&discard, SOCK_STREAM, SELF_TEST_DISCARD_PORT);
+	params.latency_port = server_start(&echo, SOCK_DGRAM, SELF_TEST_ECHO_PORT);
+	params.duration_ms = DURATION_MS;
+	/* Loopback is fast enough to hit the default limit before the time is up */
+	params.max_bytes = G_GUINT64_CONSTANT(1) << 40;
+	params.latency_probes = 5;
+
+	result.loop = g_main_loop_new(NULL, FALSE);
+	g_assert(NULL != self_test_start(&params, test_done, &result));
+	g_main_loop_run(result.loop);
+
+	g_assert_cmpuint(result.calls, ==, 1);
+	g_assert(NULL == result.error);
+
+	throughput = &result.result.download;
+	g_assert(throughput->done);
+	g_assert_cmpuint(throughput->bytes, >, 0);
+	g_assert_cmpint(throughput->duration_ms, >=, DURATION_MS);
+	g_assert_cmpuint(throughput->samples, >=, DURATION_MS / SELF_TEST_SAMPLE_MS - 1);
+	g_assert_cmpfloat(throughput->average_kbps, >, 0);
+	g_assert_cmpfloat(throughput->p10_kbps, <=, throughput->median_kbps);
+	g_assert_cmpfloat(throughput->median_kbps, <=, throughput->p90_kbps);
+
+	throughput = &result.result.upload;
+	g_assert(throughput->done);
+	g_assert_cmpuint(throughput->bytes, >, 0);
+	g_assert_cmpfloat(throughput->p10_kbps, <=, throughput->p90_kbps);
+
+	g_assert(result.result.latency.done);
+	g_assert_cmpuint(result.result.latency.sent, ==, 5);
+	g_assert_cmpuint(result.result.latency.received, ==, 5);
+	g_assert_cmpfloat(result.result.latency.min_ms, <=,
+	                  result.result.latency.median_ms);
+	g_assert_cmpfloat(result.result.latency.median_ms, <=,
+	                  result.result.latency.max_ms);
+	g_assert_cmpfloat(result.result.latency.max_ms, <, SELF_TEST_LATENCY_TIMEOUT_MS);
+	g_assert_cmpfloat(result.result.latency.jitter_ms, >=, 0);
+
+	/* The download stops at the byte limit */
+	params.upload_port = 0;
+	params.latency_port = 0;
+	params.max_bytes = 100000;
+	g_assert(NULL != self_test_start(&params, test_done, &result));
+	g_main_loop_run(result.loop);
+
+	g_assert_cmpuint(result.calls, ==, 2);
+	g_assert_cmpuint(result.result.download.bytes, ==, 100000);
+	g_assert(!result.result.upload.done);
+	g_assert(!result.result.latency.done);
+
+	server_stop(&chargen);
+	server_stop(&discard);
+	server_stop(&echo);
+	g_main_loop_unref(result.loop);
+}
+
+static void test_refused(void)
+{
+	server_t closed;
+	self_test_params_t params = { 0 };
+	result_t result = { 0 };
+
+	/* Nothing listens on the port once the server is gone */
+	params.host = "127.0.0.1";
+	params.download_port = server_start(&closed, SOCK_STREAM, SELF_TEST_CHARGEN_PORT);
+	params.upload_port = params.download_port;
+	server_stop(&closed);
+
+	result.loop = g_main_loop_new(NULL, FALSE);
+	g_assert(NULL != self_test_start(&params, test_done, &result));
+	g_main_loop_run(result.loop);
+
+	g_assert_cmpuint(result.calls, ==, 1);
+	g_assert(NULL != result.error);
+	g_assert(NULL != strstr(result.error, "Can't connect"));
+	g_assert(!result.result.download.done);
+	g_assert(!result.result.upload.done);
+
+	g_free(result.error);
+	g_main_loop_unref(result.loop);
+}
+
+static gboolean cancel_cb(gpointer user_data)
+{
+	self_test_cancel(user_data);
+	return FALSE;
+}
+
+static gboolean quit_cb(gpointer user_data)
+{
+	g_main_loop_quit(user_data);
+	return FALSE;
+}
+
+static void test_cancel(void)
+{
+	server_t chargen;
+	self_test_params_t params = { 0 };
+	result_t result = { 0 };
+	self_test_t *test;
+	gint64 start;
+
+	params.host = "127.0.0.1";
+	params.download_port = server_start(&chargen, SOCK_STREAM, SELF_TEST_CHARGEN_PORT);
+	params.duration_ms = SELF_TEST_MAX_DURATION_MS;
+	params.max_bytes = G_GUINT64_CONSTANT(1) << 40;
+
+	result.loop = g_main_loop_new(NULL, FALSE);
+	test = self_test_start(&params, test_done, &result);
+	g_assert(NULL != test);
+
+	/* A cancelled test never calls back and ends quickly */
+	start = g_get_monotonic_time();
+	g_timeout_add(100, cancel_cb, test);
+	g_timeout_add(500, quit_cb, result.loop);
+	g_main_loop_run(result.loop);
+
+	g_assert_cmpuint(result.calls, ==, 0);
+	g_assert_cmpint(g_get_monotonic_time() - start, <, 1000 * 1000);
+
+	server_stop(&chargen);
+	g_main_loop_unref(result.loop);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/self_test/stats", test_stats);
+	g_test_add_func("/self_test/run", test_run);
+	g_test_add_func("/self_test/refused", test_refused);
+	g_test_add_func("/self_test/cancel", test_cancel);
+
+	return g_test_run();
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+#include <string.h>
+
+#include "wifi_tethering_acl.h"
+
+#define STATION_A   "00:11:22:33:44:55"
+#define STATION_B   "AA:BB:CC:DD:EE:FF"
+#define STATION_C   "12:34:56:78:9a:bc"
+
+/**
+ * @brief Check parsing of valid and malformed MAC addresses.
+ */
+
+static void test_parse_address(void)
+{
+	guint64 mac = 0;
+
+	g_assert(tethering_acl_parse_address(STATION_A, &mac));
+	g_assert(mac == G_GUINT64_CONSTANT(0x001122334455));
+	g_assert(tethering_acl_parse_address(STATION_B, &mac));
+	g_assert(mac == G_GUINT64_CONSTANT(0xaabbccddeeff));
+
+	g_assert(!tethering_acl_parse_address(NULL, &mac));
+	g_assert(!tethering_acl_parse_address("", &mac));
+	g_assert(!tethering_acl_parse_address("00:11:22:33:44", &mac));
+	g_assert(!tethering_acl_parse_address("00-11-22-33-44-55", &mac));
+	g_assert(!tethering_acl_parse_address("00:11:22:33:44:5g", &mac));
+}
+
+/**
+ * @brief Without any entries every station authorizing has to be permitted.
+ */
+
+static void test_empty_lists(void)
+{
+	tethering_acl_clear();
+	guint rejected = tethering_acl_get_rejected_count();
+
+	g_assert(tethering_acl_check_station(STATION_A));
+	g_assert(tethering_acl_check_station(STATION_B));
+	g_assert(tethering_acl_get_rejected_count() == rejected);
+}
+
+/**
+ * @brief Stations on the deny list have to be rejected on every authorize
+ * while others are still permitted.
+ */
+
+static void test_deny_list(void)
+{
+	tethering_acl_clear();
+	guint rejected = tethering_acl_get_rejected_count();
+
+	g_assert(tethering_acl_add(TETHERING_ACL_DENY, STATION_B));
+
+	/* Address case must not matter */
+	g_assert(!tethering_acl_check_station("aa:bb:cc:dd:ee:ff"));
+	g_assert(!tethering_acl_check_station(STATION_B));
+	g_assert(tethering_acl_check_station(STATION_A));
+	g_assert(tethering_acl_get_rejected_count() == rejected + 2);
+
+	g_assert(tethering_acl_remove(TETHERING_ACL_DENY, STATION_B));
+	g_assert(tethering_acl_check_station(STATION_B));
+}
+
+/**
+ * @brief Once the allow list has entries only those stations are permitted.
+ */
+
+static void test_allow_list(void)
+{
+	tethering_acl_clear();
+
+	g_assert(tethering_acl_add(TETHERING_ACL_ALLOW, STATION_A));
+
+	g_assert(tethering_acl_check_station(STATION_A));
+	g_assert(!tethering_acl_check_station(STATION_B));
+	g_assert(!tethering_acl_check_station(STATION_C));
+
+	/* Moving the only allowed station to the deny list makes the allow list
+	 * empty again */
+	g_assert(tethering_acl_add(TETHERING_ACL_DENY, STATION_A));
+	g_assert(!tethering_acl_remove(TETHERING_ACL_ALLOW, STATION_A));
+	g_assert(!tethering_acl_check_station(STATION_A));
+	g_assert(tethering_acl_check_station(STATION_B));
+}
+
+/**
+ * @brief Lists have to survive a serialize / deserialize round trip.
+ */
+
+static void test_serialize(void)
+{
+	tethering_acl_clear();
+
+	g_assert(tethering_acl_add(TETHERING_ACL_ALLOW, STATION_A));
+	g_assert(tethering_acl_add(TETHERING_ACL_ALLOW, STATION_C));
+	g_assert(tethering_acl_add(TETHERING_ACL_DENY, STATION_B));
+
+	gchar *allow_str = tethering_acl_serialize(TETHERING_ACL_ALLOW);
+	gchar *deny_str = tethering_acl_serialize(TETHERING_ACL_DENY);
+
+	g_assert(strlen(allow_str) == 24);
+	g_assert(g_strcmp0(deny_str, "aabbccddeeff") == 0);
+
+	tethering_acl_clear();
+
+	g_assert(tethering_acl_deserialize(TETHERING_ACL_ALLOW, allow_str));
+	g_assert(tethering_acl_deserialize(TETHERING_ACL_DENY, deny_str));
+
+	g_assert(tethering_acl_check_station(STATION_A));
+	g_assert(tethering_acl_check_station(STATION_C));
+	g_assert(!tethering_acl_check_station(STATION_B));
+
+	GSList *addresses = tethering_acl_get_addresses(TETHERING_ACL_DENY);
+	g_assert(g_slist_length(addresses) == 1);
+	g_assert(g_strcmp0(addresses->data, "aa:bb:cc:dd:ee:ff") == 0);
+	g_slist_free_full(addresses, g_free);
+
+	g_assert(!tethering_acl_deserialize(TETHERING_ACL_DENY, "aabbcc"));
+	g_assert(!tethering_acl_deserialize(TETHERING_ACL_DENY, "aabbccddeefg"));
+
+	g_free(allow_str);
+	g_free(deny_str);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/tethering_acl/parse_address", test_parse_address);
+	g_test_add_func("/tethering_acl/empty_lists", test_empty_lists);
+	g_test_add_func("/tethering_acl/deny_list", test_deny_list);
+	g_test_add_func("/tethering_acl/allow_list", test_allow_list);
+	g_test_add_func("/tethering_acl/serialize", test_serialize);
+
+	return g_test_run();
+}
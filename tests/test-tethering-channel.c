@@ -0,0 +1,173 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "wifi_tethering_channel.h"
+
+/**
+ * @brief Check the conversion between channels and frequencies.
+ */
+
+static void test_frequency_conversion(void)
+{
+	g_assert(tethering_channel_from_frequency(2412) == 1);
+	g_assert(tethering_channel_from_frequency(2437) == 6);
+	g_assert(tethering_channel_from_frequency(2462) == 11);
+	g_assert(tethering_channel_from_frequency(2484) == 14);
+	g_assert(tethering_channel_from_frequency(5180) == 36);
+	g_assert(tethering_channel_from_frequency(5745) == 149);
+	g_assert(tethering_channel_from_frequency(0) == TETHERING_CHANNEL_NONE);
+
+	g_assert(tethering_channel_to_frequency(1) == 2412);
+	g_assert(tethering_channel_to_frequency(11) == 2462);
+	g_assert(tethering_channel_to_frequency(36) == 5180);
+	g_assert(tethering_channel_to_frequency(0) == 0);
+}
+
+/**
+ * @brief Without any scan results all channels are free and the first
+ * non-overlapping channel should be selected.
+ */
+
+static void test_select_without_bss(void)
+{
+	gdouble score = -1.0;
+
+	g_assert(tethering_channel_select(TETHERING_BAND_2_4GHZ, NULL, 0, &score) == 1);
+	g_assert(score == 0.0);
+}
+
+/**
+ * @brief Neighbouring BSS have to contribute less than a BSS on the same
+ * channel and BSS five or more channels away must not contribute at all.
+ */
+
+static void test_score_overlap(void)
+{
+	bssinfo_t same = { "00:00:00:00:00:01", -60, 2437 };
+	bssinfo_t adjacent = { "00:00:00:00:00:02", -60, 2442 };
+	bssinfo_t distant = { "00:00:00:00:00:03", -60, 2462 };
+
+	gdouble same_score = tethering_channel_score(6, &same, 1);
+	gdouble adjacent_score = tethering_channel_score(6, &adjacent, 1);
+
+	g_assert(same_score > adjacent_score);
+	g_assert(adjacent_score > 0.0);
+	g_assert(tethering_channel_score(6, &distant, 1) == 0.0);
+}
+
+/**
+ * @brief A strong BSS has to contribute more than a weak one on the same channel.
+ */
+
+static void test_score_signal(void)
+{
+	bssinfo_t strong = { "00:00:00:00:00:01", -40, 2412 };
+	bssinfo_t weak = { "00:00:00:00:00:02", -90, 2412 };
+
+	g_assert(tethering_channel_score(1, &strong, 1) >
+	         tethering_channel_score(1, &weak, 1));
+}
+
+/**
+ * @brief A typical crowded 2.4GHz environment where channel 1 and 6 are busy
+ * should lead to channel 11 being selected.
+ */
+
+static void test_select_crowded(void)
+{
+	bssinfo_t bss[] =
+	{
+		{ "00:00:00:00:00:01", -45, 2412 },
+		{ "00:00:00:00:00:02", -50, 2412 },
+		{ "00:00:00:00:00:03", -70, 2417 },
+		{ "00:00:00:00:00:04", -55, 2437 },
+		{ "00:00:00:00:00:05", -60, 2437 },
+		{ "00:00:00:00:00:06", -85, 2462 },
+	};
+	gdouble score = 0.0;
+
+	g_assert(tethering_channel_select(TETHERING_BAND_2_4GHZ, bss, G_N_ELEMENTS(bss),
+	                                  &score) == 11);
+	g_assert(score == tethering_channel_score(11, bss, G_N_ELEMENTS(bss)));
+}
+
+/**
+ * @brief BSS on 5GHz must not influence the selection of a 2.4GHz channel.
+ */
+
+static void test_select_ignores_other_band(void)
+{
+	bssinfo_t bss[] =
+	{
+		{ "00:00:00:00:00:01", -40, 5180 },
+		{ "00:00:00:00:00:02", -40, 5745 },
+		{ "00:00:00:00:00:03", -60, 2412 },
+	};
+
+	g_assert(tethering_channel_select(TETHERING_BAND_2_4GHZ, bss, G_N_ELEMENTS(bss),
+	                                  NULL) == 6);
+}
+
+/**
+ * @brief In the 5GHz band the least used non-DFS channel has to be selected
+ * and DFS channels must not be allowed.
+ */
+
+static void test_select_5ghz(void)
+{
+	bssinfo_t bss[] =
+	{
+		{ "00:00:00:00:00:01", -50, 5180 },
+		{ "00:00:00:00:00:02", -60, 5200 },
+		{ "00:00:00:00:00:03", -70, 5220 },
+		{ "00:00:00:00:00:04", -80, 5240 },
+		{ "00:00:00:00:00:05", -40, 2412 },
+	};
+
+	g_assert(tethering_channel_select(TETHERING_BAND_5GHZ, bss, G_N_ELEMENTS(bss),
+	                                  NULL) == 149);
+	g_assert(tethering_channel_get_default(TETHERING_BAND_5GHZ) == 36);
+	g_assert(tethering_channel_is_allowed(TETHERING_BAND_5GHZ, 44));
+	g_assert(!tethering_channel_is_allowed(TETHERING_BAND_5GHZ, 100));
+	g_assert(!tethering_channel_is_allowed(TETHERING_BAND_5GHZ, 6));
+	g_assert(!tethering_channel_is_allowed(TETHERING_BAND_2_4GHZ, 36));
+	g_assert(tethering_channel_get_band(149) == TETHERING_BAND_5GHZ);
+	g_assert(tethering_channel_get_band(11) == TETHERING_BAND_2_4GHZ);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/tethering_channel/frequency_conversion",
+	                test_frequency_conversion);
+	g_test_add_func("/tethering_channel/select_without_bss",
+	                test_select_without_bss);
+	g_test_add_func("/tethering_channel/score_overlap",
+	                test_score_overlap);
+	g_test_add_func("/tethering_channel/score_signal",
+	                test_score_signal);
+	g_test_add_func("/tethering_channel/select_crowded",
+	                test_select_crowded);
+	g_test_add_func("/tethering_channel/select_ignores_other_band",
+	                test_select_ignores_other_band);
+	g_test_add_func("/tethering_channel/select_5ghz",
+	                test_select_5ghz);
+
+	return g_test_run();
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <glib.h>
+
+#include "wan_failover.h"
+
+#define BACKOFF_MS      1000
+#define MAX_BACKOFF_MS  5000
+
+static const gchar *preferences[] = { "internet", "ims", "backup", NULL };
+
+static void setup(void)
+{
+	wan_failover_reset();
+	wan_failover_set_backoff(BACKOFF_MS, MAX_BACKOFF_MS);
+	wan_failover_set_preferences(preferences);
+}
+
+static void test_preferences(void)
+{
+	const gchar *changed[] = { "backup", "internet", "backup", "new", NULL };
+	const GPtrArray *contexts;
+
+	setup();
+
+	wan_failover_failed("internet", 0);
+	g_assert_cmpuint(wan_failover_get_health("internet")->failures, ==, 1);
+
+	/* Health is kept, duplicates are dropped */
+	wan_failover_set_preferences(changed);
+	contexts = wan_failover_get_contexts();
+	g_assert_cmpuint(contexts->len, ==, 3);
+	g_assert_cmpstr(((wan_context_health_t *) g_ptr_array_index(contexts, 0))->name,
+	                ==, "backup");
+	g_assert_cmpuint(wan_failover_get_health("internet")->failures, ==, 1);
+	g_assert_cmpint(wan_failover_get_health("new")->time_to_ip_ms, ==, -1);
+	g_assert(NULL == wan_failover_get_health("ims"));
+
+	/* Empty list disables failover */
+	wan_failover_set_preferences(NULL);
+	g_assert_cmpuint(wan_failover_get_contexts()->len, ==, 0);
+	g_assert(NULL == wan_failover_next(NULL, 0));
+
+	wan_failover_reset();
+}
+
+static void test_failover(void)
+{
+	setup();
+
+	/* Nothing connected: most preferred first */
+	g_assert_cmpstr(wan_failover_next(NULL, 0), ==, "internet");
+
+	/* Nothing else while an attempt runs */
+	wan_failover_attempt("internet", 0);
+	g_assert(NULL == wan_failover_next(NULL, 100));
+	g_assert_cmpint(wan_failover_next_retry(NULL, 100), ==, -1);
+
+	wan_failover_failed("internet", 200);
+	g_assert_cmpstr(wan_failover_next(NULL, 200), ==, "ims");
+
+	wan_failover_attempt("ims", 200);
+	wan_failover_succeeded("ims", 1700);
+	g_assert_cmpint(wan_failover_get_health("ims")->time_to_ip_ms, ==, 1500);
+
+	/* Nothing to do while the preferred context backs off */
+	g_assert(NULL == wan_failover_next("ims", 1000));
+	g_assert_cmpint(wan_failover_next_retry("ims", 1000), ==, 200);
+
+	/* Return to the preferred context once the backoff expired */
+	g_assert_cmpstr(wan_failover_next("ims", 1200), ==, "internet");
+
+	/* Less preferred contexts aren't tried while a better one is active */
+	g_assert(NULL == wan_failover_next("internet", 1200));
+	g_assert_cmpint(wan_failover_next_retry("internet", 1200), ==, -1);
+
+	/* Unmanaged contexts are left alone */
+	g_assert(NULL == wan_failover_next("other", 1200));
+
+	wan_failover_reset();
+}
+
+static void test_backoff(void)
+{
+	const wan_context_health_t *health;
+
+	setup();
+	health = wan_failover_get_health("internet");
+
+	wan_failover_failed("internet", 0);
+	g_assert_cmpint(health->retry_after_ms, ==, 1000);
+	wan_failover_failed("internet", 0);
+	g_assert_cmpint(health->retry_after_ms, ==, 2000);
+	wan_failover_failed("internet", 0);
+	g_assert_cmpint(health->retry_after_ms, ==, 4000);
+	wan_failover_failed("internet", 0);
+	g_assert_cmpint(health->retry_after_ms, ==, MAX_BACKOFF_MS);
+
+	while (health->failures < 40)
+	{
+		wan_failover_failed("internet", 0);
+	}
+
+	g_assert_cmpint(health->retry_after_ms, ==, MAX_BACKOFF_MS);
+
+	wan_failover_succeeded("internet", 100);
+	g_assert_cmpuint(health->failures, ==, 0);
+	g_assert_cmpuint(health->total_failures, ==, 40);
+	g_assert_cmpuint(health->connects, ==, 1);
+	g_assert_cmpint(health->retry_after_ms, ==, 0);
+
+	wan_failover_failed("internet", 100);
+	g_assert_cmpint(health->retry_after_ms, ==, 1100);
+
+	wan_failover_reset();
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/wan_failover/preferences", test_preferences);
+	g_test_add_func("/wan_failover/failover", test_failover);
+	g_test_add_func("/wan_failover/backoff", test_backoff);
+
+	return g_test_run();
+}
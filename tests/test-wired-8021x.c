@@ -0,0 +1,318 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+
+#include "wired_8021x.h"
+
+static void check_error(const gchar *eap_type, const gchar *identity,
+                        const gchar *passphrase, const gchar *client_cert_file,
+                        const gchar *private_key_file, gint code)
+{
+	GError *error = NULL;
+
+	g_assert(!wired_8021x_check_settings(eap_type, identity, passphrase,
+	                                     client_cert_file, private_key_file, &error));
+	g_assert_error(error, WIRED_8021X_ERROR, code);
+	g_error_free(error);
+}
+
+static void test_settings(void)
+{
+	g_assert(wired_8021x_check_settings("tls", "host/dev", NULL,
+	                                    "/certs/client.pem", "/certs/client.key", NULL));
+	g_assert(wired_8021x_check_settings("peap", "user", "secret", NULL, NULL,
+	                                    NULL));
+	g_assert(wired_8021x_check_settings("ttls", "user", "secret", NULL, NULL,
+	                                    NULL));
+
+	check_error(NULL, "user", "secret", NULL, NULL, WIRED_8021X_ERROR_EAP_TYPE);
+	check_error("wpa", "user", "secret", NULL, NULL, WIRED_8021X_ERROR_EAP_TYPE);
+	check_error("peap", NULL, "secret", NULL, NULL, WIRED_8021X_ERROR_IDENTITY);
+	check_error("ttls", "", "secret", NULL, NULL, WIRED_8021X_ERROR_IDENTITY);
+	check_error("peap", "user", NULL, NULL, NULL, WIRED_8021X_ERROR_PASSPHRASE);
+	check_error("tls", "host/dev", NULL, NULL, "/certs/client.key",
+	            WIRED_8021X_ERROR_CLIENT_CERT);
+	check_error("tls", "host/dev", NULL, "/certs/client.pem", "",
+	            WIRED_8021X_ERROR_CLIENT_CERT);
+}
+
+static void test_config_name(void)
+{
+	gchar *name = wired_8021x_config_name("00:1A:2b:3c:4D:5e");
+
+	g_assert_cmpstr(name, ==, "ethernet_001a2b3c4d5e.config");
+	g_free(name);
+
+	g_assert(NULL == wired_8021x_config_name(NULL));
+	g_assert(NULL == wired_8021x_config_name(""));
+	g_assert(NULL == wired_8021x_config_name("00:1a:2b:3c:4d"));
+	g_assert(NULL == wired_8021x_config_name("00-1a-2b-3c-4d-5e"));
+	g_assert(NULL == wired_8021x_config_name("00:1a:2b:3c:4d:5g"));
+	g_assert(NULL == wired_8021x_config_name("../../etc/passwd"));
+}
+
+static void test_state(void)
+{
+	/* Without a profile the port is never authenticated */
+	g_assert_cmpint(wired_8021x_get_state(FALSE, "online", NULL, "completed"), ==,
+	                WIRED_8021X_STATE_DISABLED);
+
+	g_assert_cmpint(wired_8021x_get_state(TRUE, NULL, NULL, NULL), ==,
+	                WIRED_8021X_STATE_UNAUTHENTICATED);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "idle", NULL, NULL), ==,
+	                WIRED_8021X_STATE_UNAUTHENTICATED);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "association", NULL, NULL), ==,
+	                WIRED_8021X_STATE_AUTHENTICATING);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "failure", NULL, NULL), ==,
+	                WIRED_8021X_STATE_FAILED);
+
+	/* An up link alone says nothing about 802.1X, e.g. on an open port */
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "configuration", NULL, NULL), ==,
+	                WIRED_8021X_STATE_UNKNOWN);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "ready", NULL, NULL), ==,
+	                WIRED_8021X_STATE_UNKNOWN);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "online", NULL, NULL), ==,
+	                WIRED_8021X_STATE_UNKNOWN);
+
+	/* Only the supplicant knows how EAP went */
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "ready", NULL, "authenticating"),
+	                ==, WIRED_8021X_STATE_AUTHENTICATING);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "ready", NULL, "completed"), ==,
+	                WIRED_8021X_STATE_AUTHENTICATED);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "online", NULL, "failed"), ==,
+	                WIRED_8021X_STATE_FAILED);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, NULL, NULL, "completed"), ==,
+	                WIRED_8021X_STATE_UNAUTHENTICATED);
+
+	/* A rejected EAP attempt drops the service back to idle with an error */
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "idle", "invalid-key", NULL), ==,
+	                WIRED_8021X_STATE_FAILED);
+	g_assert_cmpint(wired_8021x_get_state(TRUE, "disconnect", "auth-failed", NULL),
+	                ==, WIRED_8021X_STATE_FAILED);
+
+	g_assert_cmpstr(wired_8021x_state_to_string(WIRED_8021X_STATE_AUTHENTICATED),
+	                ==, "authenticated");
+	g_assert_cmpstr(wired_8021x_state_to_string(WIRED_8021X_STATE_DISABLED), ==,
+	                "disabled");
+	g_assert_cmpstr(wired_8021x_state_to_string(WIRED_8021X_STATE_UNKNOWN), ==,
+	                "unknown");
+}
+
+#define AUTH_NETNS      "wca-8021x-auth"
+#define SUPPLICANT_IF   "wca-8021x-sup"
+#define AUTH_IF         "wca-8021x-auth"
+
+static gboolean run(const gchar *command)
+{
+	gint status = -1;
+
+	return g_spawn_command_line_sync(command, NULL, NULL, &status, NULL) &&
+	       g_spawn_check_exit_status(status, NULL);
+}
+
+static gboolean run_printf(const gchar *format, ...)
+{
+	gchar *command;
+	gboolean ret;
+	va_list args;
+
+	va_start(args, format);
+	command = g_strdup_vprintf(format, args);
+	va_end(args);
+
+	ret = run(command);
+	g_free(command);
+	return ret;
+}
+
+static void write_file(const gchar *dir, const gchar *name,
+                       const gchar *contents)
+{
+	gchar *path = g_build_filename(dir, name, NULL);
+
+	g_assert(g_file_set_contents(path, contents, -1, NULL));
+	g_free(path);
+}
+
+/**
+ * @brief Get the EAP state of the supplicant in the form its D-Bus interface
+ * uses, e.g. "completed"
+ */
+
+static gchar *get_eap_state(const gchar *dir)
+{
+	gchar *command, *output = NULL, *state = NULL, **lines;
+	guint i;
+
+	command = g_strdup_printf("wpa_cli -p %s/ctrl -i " SUPPLICANT_IF " status",
+	                          dir);
+	g_spawn_command_line_sync(command, &output, NULL, NULL, NULL);
+	g_free(command);
+
+	lines = g_strsplit(output ? output : "", "\n", -1);
+
+	for (i = 0; NULL != lines[i] && NULL == state; i++)
+	{
+		if (g_str_has_prefix(lines[i], "wpa_state="))
+		{
+			state = g_ascii_strdown(lines[i] + strlen("wpa_state="), -1);
+		}
+	}
+
+	g_strfreev(lines);
+	g_free(output);
+	return state;
+}
+
+/**
+ * @brief Authenticate with the given PEAP password against the EAP server of
+ * hostapd, and wait up to the given time for the supplicant to complete
+ */
+
+static wired_8021x_state_t authenticate(const gchar *dir,
+                                        const gchar *passphrase, guint seconds)
+{
+	wired_8021x_state_t state = WIRED_8021X_STATE_UNAUTHENTICATED;
+	gchar *config;
+	guint n;
+
+	g_assert(wired_8021x_check_settings("peap", "user", passphrase, NULL, NULL,
+	                                    NULL));
+
+	config = g_strdup_printf("ctrl_interface=%s/ctrl\n"
+	                         "ap_scan=0\n"
+	                         "network={\n"
+	                         "\tkey_mgmt=IEEE8021X\n"
+	                         "\teap=PEAP\n"
+	                         "\tidentity=\"user\"\n"
+	                         "\tpassword=\"%s\"\n"
+	                         "\tphase2=\"auth=MSCHAPV2\"\n"
+	                         "\teapol_flags=0\n"
+	                         "}\n", dir, passphrase);
+	write_file(dir, "wpa_supplicant.conf", config);
+	g_free(config);
+
+	g_assert(run_printf("wpa_supplicant -B -D wired -i " SUPPLICANT_IF
+	                    " -c %s/wpa_supplicant.conf -P %s/wpa_supplicant.pid", dir, dir));
+
+	for (n = 0; n < seconds * 10; n++)
+	{
+		gchar *eap_state = get_eap_state(dir);
+
+		state = wired_8021x_get_state(TRUE, "ready", NULL, eap_state);
+		g_free(eap_state);
+
+		if (WIRED_8021X_STATE_AUTHENTICATED == state)
+		{
+			break;
+		}
+
+		g_usleep(100 * 1000);
+	}
+
+	run_printf("sh -c 'kill $(cat %s/wpa_supplicant.pid)'", dir);
+	g_usleep(200 * 1000);
+	return state;
+}
+
+/**
+ * @brief Run a real 802.1X exchange against hostapd's wired driver across a
+ * veth pair, the authenticator living in its own network namespace. Needs
+ * root, hostapd, wpa_supplicant and openssl, and is skipped otherwise.
+ */
+
+static void test_hostapd(void)
+{
+	static const gchar *tools[] = { "hostapd", "wpa_supplicant", "wpa_cli", "ip", "openssl" };
+	gchar *dir, *config;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(tools); i++)
+	{
+		gchar *path = g_find_program_in_path(tools[i]);
+
+		if (NULL == path)
+		{
+			g_test_skip("Tools for the 802.1X exchange are missing");
+			return;
+		}
+
+		g_free(path);
+	}
+
+	if (0 != geteuid())
+	{
+		g_test_skip("Network namespaces need root");
+		return;
+	}
+
+	dir = g_dir_make_tmp("test-wired-8021x-XXXXXX", NULL);
+	g_assert(NULL != dir);
+
+	g_assert(run_printf("openssl req -x509 -newkey rsa:2048 -nodes -days 1 "
+	                    "-subj /CN=auth -keyout %s/server.key -out %s/server.pem", dir, dir));
+	write_file(dir, "eap_users", "* PEAP\n\"user\" MSCHAPV2 \"secret\" [2]\n");
+
+	config = g_strdup_printf("interface=" AUTH_IF "\n"
+	                         "driver=wired\n"
+	                         "ieee8021x=1\n"
+	                         "eap_server=1\n"
+	                         "eap_user_file=%s/eap_users\n"
+	                         "ca_cert=%s/server.pem\n"
+	                         "server_cert=%s/server.pem\n"
+	                         "private_key=%s/server.key\n", dir, dir, dir, dir);
+	write_file(dir, "hostapd.conf", config);
+	g_free(config);
+
+	/* Left over by an earlier run which failed */
+	run("ip link del " SUPPLICANT_IF);
+	run("ip netns del " AUTH_NETNS);
+
+	g_assert(run("ip netns add " AUTH_NETNS));
+	g_assert(run("ip link add " SUPPLICANT_IF " type veth peer name " AUTH_IF));
+	g_assert(run("ip link set " AUTH_IF " netns " AUTH_NETNS));
+	g_assert(run("ip link set " SUPPLICANT_IF " up"));
+	g_assert(run("ip netns exec " AUTH_NETNS " ip link set " AUTH_IF " up"));
+	g_assert(run_printf("ip netns exec " AUTH_NETNS
+	                    " hostapd -B -P %s/hostapd.pid %s/hostapd.conf", dir, dir));
+
+	g_assert_cmpint(authenticate(dir, "secret", 10), ==,
+	                WIRED_8021X_STATE_AUTHENTICATED);
+	g_assert_cmpint(authenticate(dir, "wrong", 3), !=,
+	                WIRED_8021X_STATE_AUTHENTICATED);
+
+	run_printf("sh -c 'kill $(cat %s/hostapd.pid)'", dir);
+	run("ip link del " SUPPLICANT_IF);
+	run("ip netns del " AUTH_NETNS);
+	run_printf("rm -rf %s", dir);
+	g_free(dir);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/wired_8021x/settings", test_settings);
+	g_test_add_func("/wired_8021x/config_name", test_config_name);
+	g_test_add_func("/wired_8021x/state", test_state);
+	g_test_add_func("/wired_8021x/hostapd", test_hostapd);
+
+	return g_test_run();
+}
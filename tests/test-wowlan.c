@@ -0,0 +1,475 @@
+// Copyright (c) 2018 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <string.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/nl80211.h>
+#include <glib.h>
+
+#include "wowlan.h"
+#include "wowlan_nl80211.h"
+
+#define IFACE       "wlan0"
+
+/* Mocked driver: reports mock_caps and records what it is given */
+static wowlan_capabilities_t mock_caps;
+static gboolean mock_fail = FALSE;
+static guint mock_set_calls = 0;
+static gchar *mock_applied = NULL;
+
+static gboolean mock_get_capabilities(const gchar *iface,
+                                      wowlan_capabilities_t *caps, GError **error)
+{
+	g_assert_cmpstr(iface, ==, IFACE);
+	*caps = mock_caps;
+	return TRUE;
+}
+
+static gboolean mock_set_config(const gchar *iface,
+                                const wowlan_config_t *config, GError **error)
+{
+	g_assert_cmpstr(iface, ==, IFACE);
+
+	if (mock_fail)
+	{
+		g_set_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER, "Mock failure");
+		return FALSE;
+	}
+
+	mock_set_calls++;
+	g_free(mock_applied);
+	mock_applied = NULL != config ? wowlan_config_to_string(config) : NULL;
+
+	return TRUE;
+}
+
+static const wowlan_driver_t mock_driver =
+{
+	.get_capabilities = mock_get_capabilities,
+	.set_config = mock_set_config,
+};
+
+static void mock_reset(void)
+{
+	memset(&mock_caps, 0, sizeof(mock_caps));
+	mock_caps.triggers = WOWLAN_TRIGGER_DISCONNECT | WOWLAN_TRIGGER_MAGIC_PACKET |
+	                     WOWLAN_TRIGGER_GTK_REKEY_FAILURE | WOWLAN_TRIGGER_PATTERN;
+	mock_caps.max_patterns = 2;
+	mock_caps.min_pattern_len = 1;
+	mock_caps.max_pattern_len = 64;
+	mock_caps.max_pattern_offset = 32;
+	mock_fail = FALSE;
+	mock_set_calls = 0;
+	g_free(mock_applied);
+	mock_applied = NULL;
+
+	wowlan_init(&mock_driver);
+}
+
+static wowlan_config_t *config_parse(const gchar *str)
+{
+	GError *error = NULL;
+	wowlan_config_t *config = wowlan_config_from_string(str, &error);
+
+	g_assert_no_error(error);
+	g_assert(NULL != config);
+
+	return config;
+}
+
+static void test_triggers(void)
+{
+	g_assert_cmpstr(wowlan_trigger_to_string(WOWLAN_TRIGGER_MAGIC_PACKET), ==,
+	                "magicPacket");
+	g_assert_cmpuint(wowlan_trigger_from_string("gtkRekeyFailure"), ==,
+	                 WOWLAN_TRIGGER_GTK_REKEY_FAILURE);
+	g_assert_cmpuint(wowlan_trigger_from_string("bogus"), ==, 0);
+	g_assert(NULL == wowlan_trigger_to_string(0));
+}
+
+static void test_pattern(void)
+{
+	GError *error = NULL;
+	wowlan_pattern_t *pattern;
+	gchar *str;
+
+	pattern = wowlan_pattern_parse("0800??11", 12, &error);
+	g_assert_no_error(error);
+	g_assert_cmpuint(pattern->len, ==, 4);
+	g_assert_cmpuint(pattern->offset, ==, 12);
+	g_assert_cmpuint(pattern->bytes[0], ==, 0x08);
+	g_assert_cmpuint(pattern->bytes[3], ==, 0x11);
+	g_assert_cmpuint(pattern->mask[0], ==, 0x0b);
+
+	str = wowlan_pattern_to_string(pattern);
+	g_assert_cmpstr(str, ==, "0800??11");
+	g_free(str);
+	wowlan_pattern_free(pattern);
+
+	/* Odd length, bad hex, wildcards only and empty patterns */
+	g_assert(NULL == wowlan_pattern_parse("080", 0, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID);
+	g_clear_error(&error);
+	g_assert(NULL == wowlan_pattern_parse("08zz", 0, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID);
+	g_clear_error(&error);
+	g_assert(NULL == wowlan_pattern_parse("????", 0, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID);
+	g_clear_error(&error);
+	g_assert(NULL == wowlan_pattern_parse("", 0, &error));
+	g_clear_error(&error);
+}
+
+static void test_port_pattern(void)
+{
+	wowlan_pattern_t *pattern = wowlan_pattern_new_port(IPPROTO_UDP, 8009);
+	gchar *str = wowlan_pattern_to_string(pattern);
+
+	g_assert_cmpuint(pattern->len, ==, WOWLAN_IPV4_DPORT_OFFSET + 2);
+	g_assert_cmpstr(str, ==,
+	                "????????????????????????0800??????????????????11"
+	                "????????????????????????1f49");
+
+	g_free(str);
+	wowlan_pattern_free(pattern);
+}
+
+static void test_serialize(void)
+{
+	GError *error = NULL;
+	wowlan_config_t *config;
+	gchar *str;
+
+	config = config_parse("magicPacket pattern:12:0800??11 disconnect");
+	g_assert_cmpuint(config->triggers, ==, WOWLAN_TRIGGER_MAGIC_PACKET |
+	                 WOWLAN_TRIGGER_DISCONNECT | WOWLAN_TRIGGER_PATTERN);
+	g_assert_cmpuint(config->patterns->len, ==, 1);
+
+	str = wowlan_config_to_string(config);
+	g_assert_cmpstr(str, ==, "disconnect magicPacket pattern:12:0800??11");
+	g_free(str);
+	wowlan_config_free(config);
+
+	config = config_parse("");
+	g_assert_cmpuint(config->triggers, ==, 0);
+	wowlan_config_free(config);
+
+	g_assert(NULL == wowlan_config_from_string("pattern", &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID);
+	g_clear_error(&error);
+	g_assert(NULL == wowlan_config_from_string("pattern:x:08", &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_INVALID);
+	g_clear_error(&error);
+}
+
+static void test_validate(void)
+{
+	GError *error = NULL;
+	wowlan_config_t *config;
+
+	mock_reset();
+
+	config = config_parse("magicPacket pattern:0:08 pattern:32:0800");
+	g_assert(wowlan_config_validate(config, &mock_caps, &error));
+	g_assert_no_error(error);
+	wowlan_config_free(config);
+
+	/* Trigger the driver doesn't have */
+	config = config_parse("magicPacket rfkillRelease");
+	g_assert(!wowlan_config_validate(config, &mock_caps, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_assert(NULL != strstr(error->message, "rfkillRelease"));
+	g_clear_error(&error);
+	wowlan_config_free(config);
+
+	/* Too many patterns, offset too large, pattern too short */
+	config = config_parse("pattern:0:08 pattern:0:09 pattern:0:0a");
+	g_assert(!wowlan_config_validate(config, &mock_caps, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_clear_error(&error);
+	wowlan_config_free(config);
+
+	config = config_parse("pattern:33:08");
+	g_assert(!wowlan_config_validate(config, &mock_caps, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_clear_error(&error);
+	wowlan_config_free(config);
+
+	mock_caps.min_pattern_len = 2;
+	config = config_parse("pattern:0:08");
+	g_assert(!wowlan_config_validate(config, &mock_caps, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_clear_error(&error);
+	wowlan_config_free(config);
+
+	/* No pattern support at all */
+	mock_caps.max_patterns = 0;
+	config = config_parse("pattern:0:0800");
+	g_assert(!wowlan_config_validate(config, &mock_caps, &error));
+	g_clear_error(&error);
+	wowlan_config_free(config);
+}
+
+static void test_set_config(void)
+{
+	GError *error = NULL;
+	wowlan_config_t *config;
+
+	mock_reset();
+
+	g_assert(wowlan_set_config(IFACE, config_parse("magicPacket"), &error));
+	g_assert_no_error(error);
+	g_assert_cmpuint(wowlan_get_config()->triggers, ==,
+	                 WOWLAN_TRIGGER_MAGIC_PACKET);
+
+	/* A refused configuration keeps the current one */
+	config = config_parse("eapIdentityRequest");
+	g_assert(!wowlan_set_config(IFACE, config, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_clear_error(&error);
+	wowlan_config_free(config);
+	g_assert_cmpuint(wowlan_get_config()->triggers, ==,
+	                 WOWLAN_TRIGGER_MAGIC_PACKET);
+
+	/* Nothing to wake up on disables it */
+	g_assert(wowlan_set_config(IFACE, config_parse(""), &error));
+	g_assert(NULL == wowlan_get_config());
+
+	/* A stored configuration is restored without asking the driver */
+	wowlan_load_config(config_parse("rfkillRelease"));
+	g_assert_cmpuint(wowlan_get_config()->triggers, ==,
+	                 WOWLAN_TRIGGER_RFKILL_RELEASE);
+	wowlan_load_config(NULL);
+	g_assert(NULL == wowlan_get_config());
+
+	/* Setting it doesn't touch the driver until the suspend */
+	g_assert_cmpuint(mock_set_calls, ==, 0);
+}
+
+static void test_suspend_resume(void)
+{
+	GError *error = NULL;
+	const wowlan_wake_t *wake;
+
+	mock_reset();
+	g_assert(NULL == wowlan_get_last_wake());
+
+	/* Never configured, the driver is left alone */
+	g_assert(wowlan_suspend(IFACE, &error));
+	g_assert_cmpuint(mock_set_calls, ==, 0);
+
+	g_assert(wowlan_set_config(IFACE, config_parse("magicPacket"), &error));
+	g_assert(wowlan_suspend(IFACE, &error));
+	g_assert_cmpuint(mock_set_calls, ==, 1);
+
+	/* Disabled after it was handed over, the driver is cleared once */
+	g_assert(wowlan_set_config(IFACE, config_parse(""), &error));
+	g_assert(wowlan_suspend(IFACE, &error));
+	g_assert_cmpuint(mock_set_calls, ==, 2);
+	g_assert(NULL == mock_applied);
+	g_assert(wowlan_suspend(IFACE, &error));
+	g_assert_cmpuint(mock_set_calls, ==, 2);
+
+	g_assert(wowlan_set_config(IFACE,
+	                           config_parse("disconnect pattern:0:0800"), &error));
+	g_assert(wowlan_suspend(IFACE, &error));
+	g_assert_no_error(error);
+	g_assert_cmpuint(mock_set_calls, ==, 3);
+	g_assert_cmpstr(mock_applied, ==, "disconnect pattern:0:0800");
+
+	/* Woken up by the pattern */
+	wowlan_report_wakeup(WOWLAN_TRIGGER_PATTERN, 0);
+	wowlan_resume();
+	wake = wowlan_get_last_wake();
+	g_assert(NULL != wake);
+	g_assert_cmpuint(wake->trigger, ==, WOWLAN_TRIGGER_PATTERN);
+	g_assert_cmpint(wake->pattern, ==, 0);
+	g_assert_cmpint(wake->time, >, 0);
+
+	/* Without a report the wifi didn't wake us */
+	g_assert(wowlan_suspend(IFACE, &error));
+	wowlan_resume();
+	wake = wowlan_get_last_wake();
+	g_assert_cmpuint(wake->trigger, ==, 0);
+	g_assert_cmpint(wake->pattern, ==, -1);
+
+	/* A report coming in after the resume still counts */
+	wowlan_report_wakeup(WOWLAN_TRIGGER_DISCONNECT, -1);
+	g_assert_cmpuint(wowlan_get_last_wake()->trigger, ==,
+	                 WOWLAN_TRIGGER_DISCONNECT);
+
+	/* The driver lost pattern support since the configuration was set */
+	mock_caps.max_patterns = 0;
+	g_assert(!wowlan_suspend(IFACE, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_UNSUPPORTED);
+	g_clear_error(&error);
+	g_assert_cmpuint(mock_set_calls, ==, 4);
+
+	/* Driver failures are passed on */
+	mock_caps.max_patterns = 2;
+	mock_fail = TRUE;
+	g_assert(!wowlan_suspend(IFACE, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER);
+	g_clear_error(&error);
+
+	/* No driver */
+	wowlan_init(NULL);
+	g_assert(!wowlan_suspend(IFACE, &error));
+	g_assert_error(error, WOWLAN_ERROR, WOWLAN_ERROR_DRIVER);
+	g_clear_error(&error);
+}
+
+static const struct nlattr *find_attr(const guint8 *data, gsize len,
+                                      guint16 type)
+{
+	gsize pos = 0;
+
+	while (pos + NLA_HDRLEN <= len)
+	{
+		const struct nlattr *attr = (const struct nlattr *)(data + pos);
+
+		if ((attr->nla_type & NLA_TYPE_MASK) == type)
+		{
+			return attr;
+		}
+
+		pos += NLA_ALIGN(attr->nla_len);
+	}
+
+	return NULL;
+}
+
+static void test_nl80211_triggers(void)
+{
+	guint32 buf[256];
+	const guint8 *data = (const guint8 *) buf;
+	const struct nlattr *triggers, *patterns, *pattern, *attr;
+	wowlan_config_t *config = config_parse("magicPacket pattern:14:08??ff");
+	gsize len;
+
+	len = wowlan_nl80211_put_triggers((guint8 *) buf, sizeof(buf), config);
+	g_assert_cmpuint(len, >, 0);
+
+	triggers = (const struct nlattr *) data;
+	g_assert_cmpuint(triggers->nla_type & NLA_TYPE_MASK, ==,
+	                 NL80211_ATTR_WOWLAN_TRIGGERS);
+	g_assert_cmpuint(triggers->nla_len, ==, len);
+
+	data = (const guint8 *) triggers + NLA_HDRLEN;
+	len = triggers->nla_len - NLA_HDRLEN;
+	g_assert(NULL != find_attr(data, len, NL80211_WOWLAN_TRIG_MAGIC_PKT));
+	g_assert(NULL == find_attr(data, len, NL80211_WOWLAN_TRIG_DISCONNECT));
+
+	patterns = find_attr(data, len, NL80211_WOWLAN_TRIG_PKT_PATTERN);
+	g_assert(NULL != patterns);
+	pattern = find_attr((const guint8 *) patterns + NLA_HDRLEN,
+	                    patterns->nla_len - NLA_HDRLEN, 1);
+	g_assert(NULL != pattern);
+
+	data = (const guint8 *) pattern + NLA_HDRLEN;
+	len = pattern->nla_len - NLA_HDRLEN;
+	attr = find_attr(data, len, NL80211_PKTPAT_PATTERN);
+	g_assert_cmpuint(attr->nla_len - NLA_HDRLEN, ==, 3);
+	g_assert_cmpuint(((const guint8 *) attr)[NLA_HDRLEN + 2], ==, 0xff);
+	attr = find_attr(data, len, NL80211_PKTPAT_MASK);
+	g_assert_cmpuint(((const guint8 *) attr)[NLA_HDRLEN], ==, 0x05);
+	attr = find_attr(data, len, NL80211_PKTPAT_OFFSET);
+	g_assert_cmpuint(*(const guint32 *)((const guint8 *) attr + NLA_HDRLEN), ==,
+	                 14);
+
+	/* Too small a buffer */
+	g_assert_cmpuint(wowlan_nl80211_put_triggers((guint8 *) buf, 16, config), ==,
+	                 0);
+
+	wowlan_config_free(config);
+}
+
+static gsize put_test_attr(guint8 *buf, guint16 type, const void *data,
+                           gsize len)
+{
+	struct nlattr *attr = (struct nlattr *) buf;
+
+	attr->nla_type = type;
+	attr->nla_len = NLA_HDRLEN + len;
+
+	if (len)
+	{
+		memcpy(buf + NLA_HDRLEN, data, len);
+	}
+
+	return NLA_ALIGN(attr->nla_len);
+}
+
+static void test_nl80211_parse(void)
+{
+	struct nl80211_pattern_support support = { 40, 1, 256, 64 };
+	guint32 buf[64];
+	guint8 *data = (guint8 *) buf;
+	wowlan_capabilities_t caps;
+	guint32 index = 3;
+	guint trigger;
+	gint pattern;
+	gsize len = 0;
+
+	len += put_test_attr(data + len, NL80211_WOWLAN_TRIG_MAGIC_PKT, NULL, 0);
+	len += put_test_attr(data + len, NL80211_WOWLAN_TRIG_GTK_REKEY_SUPPORTED,
+	                     NULL, 0);
+	len += put_test_attr(data + len, NL80211_WOWLAN_TRIG_PKT_PATTERN, &support,
+	                     sizeof(support));
+
+	wowlan_nl80211_parse_supported(data, len, &caps);
+	g_assert_cmpuint(caps.triggers, ==,
+	                 WOWLAN_TRIGGER_MAGIC_PACKET | WOWLAN_TRIGGER_PATTERN);
+	g_assert(caps.gtk_rekey_offload);
+	/* Clamped to our own limits */
+	g_assert_cmpuint(caps.max_patterns, ==, WOWLAN_MAX_PATTERNS);
+	g_assert_cmpuint(caps.max_pattern_len, ==, WOWLAN_MAX_PATTERN_LEN);
+	g_assert_cmpuint(caps.max_pattern_offset, ==, 64);
+
+	/* Wake-up by the fourth pattern */
+	len = put_test_attr(data, NL80211_WOWLAN_TRIG_PKT_PATTERN, &index,
+	                    sizeof(index));
+	wowlan_nl80211_parse_wakeup(data, len, &trigger, &pattern);
+	g_assert_cmpuint(trigger, ==, WOWLAN_TRIGGER_PATTERN);
+	g_assert_cmpint(pattern, ==, 3);
+
+	len = put_test_attr(data, NL80211_WOWLAN_TRIG_DISCONNECT, NULL, 0);
+	wowlan_nl80211_parse_wakeup(data, len, &trigger, &pattern);
+	g_assert_cmpuint(trigger, ==, WOWLAN_TRIGGER_DISCONNECT);
+	g_assert_cmpint(pattern, ==, -1);
+
+	/* A truncated attribute is ignored */
+	wowlan_nl80211_parse_wakeup(data, 2, &trigger, &pattern);
+	g_assert_cmpuint(trigger, ==, 0);
+}
+
+int main(int argc, char **argv)
+{
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/wowlan/triggers", test_triggers);
+	g_test_add_func("/wowlan/pattern", test_pattern);
+	g_test_add_func("/wowlan/port_pattern", test_port_pattern);
+	g_test_add_func("/wowlan/serialize", test_serialize);
+	g_test_add_func("/wowlan/validate", test_validate);
+	g_test_add_func("/wowlan/set_config", test_set_config);
+	g_test_add_func("/wowlan/suspend_resume", test_suspend_resume);
+	g_test_add_func("/wowlan/nl80211_triggers", test_nl80211_triggers);
+	g_test_add_func("/wowlan/nl80211_parse", test_nl80211_parse);
+
+	return g_test_run();
+}